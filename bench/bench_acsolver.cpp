@@ -0,0 +1,54 @@
+/**
+ * @file bench_acsolver.cpp
+ * @brief AC solver benchmarks: ABCD ladder path vs. nodal analysis
+ */
+
+#include "benchharness.h"
+#include "../src/data/acsolver.h"
+
+namespace SmithTool {
+namespace {
+
+void runAcSolverBenchmarks()
+{
+    // Four-element ladder, typical of an interactive design
+    std::vector<SweepElement> ladder = {
+        SweepElement(ComponentType::Inductor, ConnectionType::Series, 3e-9),
+        SweepElement(ComponentType::Capacitor, ConnectionType::Shunt, 1.2e-12),
+        SweepElement(ComponentType::Inductor, ConnectionType::Series, 2e-9),
+        SweepElement(ComponentType::Capacitor, ConnectionType::Shunt, 0.8e-12)
+    };
+    const AcNetlist netlist = AcNetlist::fromLadder(ladder);
+    
+    // 20-section LC filter as a larger general netlist
+    std::vector<SweepElement> filter;
+    for (int i = 0; i < 20; ++i) {
+        filter.emplace_back(ComponentType::Inductor, ConnectionType::Series, 4e-9);
+        filter.emplace_back(ComponentType::Capacitor, ConnectionType::Shunt, 1.6e-12);
+    }
+    const AcNetlist filterNetlist = AcNetlist::fromLadder(filter);
+    
+    AcSolver solver;
+    solver.setThreadCount(1);
+    for (int points : {201, 2001}) {
+        std::vector<double> freqs = FrequencySweep::linearFrequencies(1e8, 4e9, points);
+        
+        Bench::measure(QString("acsolver/ladder4/abcd/%1").arg(points), points, [&]() {
+            SParamData data = solver.solveLadder(ladder, freqs);
+            Bench::consume(data.numPoints());
+        });
+        Bench::measure(QString("acsolver/ladder4/mna/%1").arg(points), points, [&]() {
+            SParamData data = solver.solve(netlist, freqs);
+            Bench::consume(data.numPoints());
+        });
+        Bench::measure(QString("acsolver/lc40/mna/%1").arg(points), points, [&]() {
+            SParamData data = solver.solve(filterNetlist, freqs);
+            Bench::consume(data.numPoints());
+        });
+    }
+}
+
+Bench::Registrar s_registrar("acsolver", &runAcSolverBenchmarks);
+
+} // namespace
+} // namespace SmithTool
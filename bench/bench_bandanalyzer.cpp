@@ -0,0 +1,69 @@
+/**
+ * @file bench_bandanalyzer.cpp
+ * @brief Band analysis benchmarks: index build and queries on 1601 to 1M points
+ */
+
+#include "benchharness.h"
+#include "../src/data/bandanalyzer.h"
+
+#include <cmath>
+
+namespace SmithTool {
+namespace {
+
+// A multi-resonant antenna: several return-loss dips across the sweep
+std::shared_ptr<const SParamData> makeFixture(int points)
+{
+    std::vector<double> freqs(points);
+    std::vector<std::vector<Complex>> params(1, std::vector<Complex>(points));
+    for (int i = 0; i < points; ++i) {
+        freqs[i] = 100e6 + i * (6e9 - 100e6) / (points - 1);
+        const double x = freqs[i] / 1e9;
+        const double dip = 0.9 - 0.8 * std::exp(-std::pow(std::sin(1.7 * x), 2) * 40.0);
+        params[0][i] = std::polar(dip, -2.0 * x);
+    }
+    auto data = std::make_shared<SParamData>();
+    data->assignPoints(std::move(freqs), std::move(params));
+    return data;
+}
+
+void runBandAnalyzerBenchmarks()
+{
+    for (int points : {1601, 1 << 20}) {
+        std::shared_ptr<const SParamData> fixture = makeFixture(points);
+        
+        Bench::measure(QString("band/build/%1").arg(points), points, [&]() {
+            ReflectionIndex index = ReflectionIndex::build(*fixture, 0);
+            Bench::consume(index.memoryBytes());
+        });
+        
+        // What one band-limit edit costs: every readout of the panel
+        ReflectionIndex index = ReflectionIndex::build(*fixture, 0);
+        double start = 500e6;
+        Bench::measure(QString("band/readouts/%1").arg(points), 1, [&]() {
+            start = (start > 2e9) ? 500e6 : start + 1.3e6;
+            const double stop = start + 2.5e9;
+            BandExtreme best = index.minimum(start, stop);
+            BandExtreme worst = index.maximum(start, stop);
+            BandEdges band = index.bandAround(best.frequency, -10.0);
+            std::vector<ThresholdCrossing> crossings = index.crossings(-10.0, start, stop, 5);
+            Bench::consume(static_cast<std::size_t>(best.index + worst.index + band.valid) +
+                           crossings.size());
+        });
+        
+        // The linear scan the index replaces
+        Bench::measure(QString("band/scan/%1").arg(points), points, [&]() {
+            const std::vector<Complex>& s11 = fixture->sData(0, 0);
+            std::size_t best = 0;
+            for (std::size_t i = 1; i < s11.size(); ++i) {
+                if (std::norm(s11[i]) < std::norm(s11[best])) best = i;
+            }
+            Bench::consume(best);
+        });
+    }
+}
+
+Bench::Registrar s_registrar("band", &runBandAnalyzerBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,46 @@
+/**
+ * @file bench_decimation.cpp
+ * @brief Trace LOD benchmarks: cost of rebuilding a decimated polyline
+ */
+
+#include "benchharness.h"
+#include "../src/core/decimation.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace SmithTool {
+namespace {
+
+void runDecimationBenchmarks()
+{
+    const QPointF center(400.0, 300.0);
+    const double radius = 250.0;
+    
+    for (int count : {1000, 1000000}) {
+        // Resonator-like spiral, several turns around the chart
+        std::vector<Complex> gamma(count);
+        for (int i = 0; i < count; ++i) {
+            double t = static_cast<double>(i) / count;
+            gamma[i] = std::polar(0.9 - 0.5 * t, 40.0 * t);
+        }
+        
+        std::vector<QPointF> scratch;
+        std::vector<QPointF> polyline;
+        QString suffix = (count >= 1000000) ? QString("%1M").arg(count / 1000000)
+                                            : QString("%1k").arg(count / 1000);
+        Bench::measure(QString("decimation/gammaTrace/%1").arg(suffix), count, [&]() {
+            PolylineDecimator::gammaTrace(gamma.data(), gamma.size(), center, radius,
+                                          scratch, polyline);
+            Bench::consume(polyline.size());
+        });
+        
+        std::printf("  %s: %zu points -> %zu drawn\n", suffix.toUtf8().constData(),
+                    gamma.size(), polyline.size());
+    }
+}
+
+Bench::Registrar s_registrar("decimation", &runDecimationBenchmarks);
+
+} // namespace
+} // namespace SmithTool
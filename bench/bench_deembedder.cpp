@@ -0,0 +1,73 @@
+/**
+ * @file bench_deembedder.cpp
+ * @brief De-embedding benchmarks: fixture removal, port extension and renormalization
+ */
+
+#include "benchharness.h"
+#include "../src/core/smithmath.h"
+#include "../src/data/deembedder.h"
+
+#include <cmath>
+
+namespace SmithTool {
+namespace {
+
+// A lossy, nearly matched line on evenly spaced points
+SParamData makeNetwork(int points, double loss, double delay)
+{
+    std::vector<double> freqs(points);
+    std::vector<std::vector<Complex>> params(4, std::vector<Complex>(points));
+    for (int i = 0; i < points; ++i) {
+        const double t = static_cast<double>(i) / (points - 1);
+        freqs[i] = 100e6 + t * (10e9 - 100e6);
+        const double phase = -SmithMath::TWO_PI * freqs[i] * delay;
+        params[0][i] = std::polar(0.05 + 0.05 * t, 0.3 + 2.0 * phase);
+        params[1][i] = std::polar(1.0 - loss * t, phase);
+        params[2][i] = params[1][i];
+        params[3][i] = std::polar(0.04 + 0.06 * t, -0.2 + 2.0 * phase);
+    }
+    SParamData data;
+    data.setNumPorts(2);
+    data.assignPoints(std::move(freqs), std::move(params));
+    return data;
+}
+
+void runDeembedderBenchmarks()
+{
+    Deembedder deembedder;
+    for (int points : {1601, 1 << 20}) {
+        const SParamData measured = makeNetwork(points, 0.3, 1.2e-9);
+        const SParamData fixture = makeNetwork(points, 0.05, 80e-12);
+        const SParamData sparseFixture = makeNetwork(801, 0.05, 80e-12);
+        SParamData result;
+        QString error;
+        
+        // Fixtures on the same sweep are used in place
+        Bench::measure(QString("deembed/both/%1").arg(points), points, [&]() {
+            deembedder.deembed(measured, &fixture, &fixture, result, error);
+            Bench::consume(static_cast<std::size_t>(result.numPoints()));
+        });
+        
+        // A coarser fixture is interpolated onto the measurement first
+        Bench::measure(QString("deembed/interpolated/%1").arg(points), points, [&]() {
+            deembedder.deembed(measured, &sparseFixture, nullptr, result, error);
+            Bench::consume(static_cast<std::size_t>(result.numPoints()));
+        });
+        
+        const std::vector<double> delays = {35e-12, 40e-12};
+        Bench::measure(QString("deembed/extension/%1").arg(points), points, [&]() {
+            deembedder.extendPorts(measured, delays, result, error);
+            Bench::consume(static_cast<std::size_t>(result.numPoints()));
+        });
+        
+        Bench::measure(QString("deembed/renormalize/%1").arg(points), points, [&]() {
+            deembedder.renormalize(measured, 75.0, result, error);
+            Bench::consume(static_cast<std::size_t>(result.numPoints()));
+        });
+    }
+}
+
+Bench::Registrar s_registrar("deembed", &runDeembedderBenchmarks);
+
+} // namespace
+} // namespace SmithTool
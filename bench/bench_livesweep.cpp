@@ -0,0 +1,99 @@
+/**
+ * @file bench_livesweep.cpp
+ * @brief Live VNA input benchmarks: frame parsing and the sweep hand-off
+ */
+
+#include "benchharness.h"
+#include "../src/data/livesweepsource.h"
+#include <thread>
+
+namespace SmithTool {
+namespace {
+
+const int POINTS = 1601;
+
+void runLiveSweepBenchmarks()
+{
+    // One RI frame and one SCPI reply as an instrument would send them
+    std::vector<QByteArray> riLines;
+    QByteArray scpiReply;
+    for (int i = 0; i < POINTS; ++i) {
+        double f = 1e9 + 1e6 * i;
+        Complex s11 = std::polar(0.5, -1e-9 * f);
+        riLines.push_back(QByteArray::number(f, 'g', 12) + ' ' + QByteArray::number(s11.real(), 'e', 9) +
+                          ' ' + QByteArray::number(s11.imag(), 'e', 9));
+        if (i > 0) scpiReply += ',';
+        scpiReply += QByteArray::number(s11.real(), 'e', 9) + ',' + QByteArray::number(s11.imag(), 'e', 9);
+    }
+    riLines.push_back(QByteArray());
+    
+    LiveSweepParser parser(POINTS);
+    Bench::measure("livesweep/parse-ri/1601", POINTS, [&]() {
+        for (const QByteArray& line : riLines) {
+            if (parser.parseRiLine(line.constData(), line.constData() + line.size())) {
+                Bench::consume(static_cast<std::size_t>(parser.sweep().points));
+            }
+        }
+    });
+    
+    std::vector<double> pairs(2 * POINTS);
+    Bench::measure("livesweep/parse-scpi/1601", POINTS, [&]() {
+        int n = LiveSweepParser::parseList(scpiReply.constData(), scpiReply.constData() + scpiReply.size(),
+                                           pairs.data(), 2 * POINTS);
+        Bench::consume(static_cast<std::size_t>(n));
+    });
+    
+    // Reader thread pushing sweeps while this thread keeps the newest one
+    // in a pair of SParamData buffers, as the chart side does
+    const int sweeps = 1000;
+    LiveSweep source;
+    source.resize(POINTS);
+    source.points = POINTS;
+    for (int i = 0; i < POINTS; ++i) {
+        source.frequencies[i] = 1e9 + 1e6 * i;
+        source.values[i] = std::polar(0.5, 0.001 * i);
+    }
+    SParamData buffers[2];
+    Bench::measure("livesweep/handoff/1601x1000", sweeps, [&]() {
+        SpscRing<LiveSweep> ring(LiveSweepSource::RING_SLOTS);
+        for (std::size_t i = 0; i < ring.capacity(); ++i) {
+            ring.slot(i).resize(POINTS);
+        }
+        
+        std::thread producer([&]() {
+            for (int sent = 0; sent < sweeps; ) {
+                LiveSweep* slot = ring.beginWrite();
+                if (!slot) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::copy_n(source.frequencies.data(), POINTS, slot->frequencies.data());
+                std::copy_n(source.values.data(), POINTS, slot->values.data());
+                slot->points = POINTS;
+                ring.endWrite();
+                ++sent;
+            }
+        });
+        
+        int front = 0;
+        for (int received = 0; received < sweeps; ) {
+            const LiveSweep* sweep = ring.beginRead();
+            if (!sweep) {
+                std::this_thread::yield();
+                continue;
+            }
+            const Complex* values = sweep->values.data();
+            buffers[front].copyPoints(sweep->frequencies.data(), &values, sweep->points);
+            ring.endRead();
+            front = 1 - front;
+            ++received;
+        }
+        producer.join();
+        Bench::consume(static_cast<std::size_t>(buffers[0].numPoints()));
+    });
+}
+
+Bench::Registrar s_registrar("livesweep", &runLiveSweepBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,41 @@
+/**
+ * @file bench_main.cpp
+ * @brief Benchmark runner entry point
+ * 
+ * Usage: smithtool_bench [--json <file>] [suite-filter...]
+ */
+
+#include "benchharness.h"
+#include <cstdio>
+
+int main(int argc, char* argv[])
+{
+    QStringList filters;
+    QString jsonPath;
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--json") {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "--json needs a file name.\n");
+                return 1;
+            }
+            jsonPath = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg.startsWith("--json=")) {
+            jsonPath = arg.mid(7);
+        } else {
+            filters << arg;
+        }
+    }
+    
+    int count = SmithTool::Bench::runSuites(filters);
+    if (count == 0) {
+        std::fprintf(stderr, "No benchmark suite matched.\n");
+        return 1;
+    }
+    
+    if (!jsonPath.isEmpty() && !SmithTool::Bench::writeJson(jsonPath)) {
+        std::fprintf(stderr, "Cannot write %s\n", jsonPath.toLocal8Bit().constData());
+        return 1;
+    }
+    return 0;
+}
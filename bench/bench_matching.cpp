@@ -0,0 +1,53 @@
+/**
+ * @file bench_matching.cpp
+ * @brief MatchingCalculator synthesis benchmarks (result cache disabled)
+ */
+
+#include "benchharness.h"
+#include "../src/core/matching.h"
+#include <vector>
+
+namespace SmithTool {
+namespace {
+
+void runMatchingBenchmarks()
+{
+    // Fixed pseudo-random loads across the right half plane
+    const int numLoads = 1000;
+    std::vector<Complex> loads(numLoads);
+    unsigned state = 12345u;
+    for (Complex& load : loads) {
+        state = state * 1664525u + 1013904223u;
+        double r = 2.0 + 498.0 * (state >> 8) / 16777216.0;
+        state = state * 1664525u + 1013904223u;
+        double x = -300.0 + 600.0 * (state >> 8) / 16777216.0;
+        load = Complex(r, x);
+    }
+    
+    MatchingCalculator calc;
+    calc.setCache(nullptr);
+    calc.setFrequency(2.4e9);
+    
+    Bench::measure("matching/calculateAll/1k-loads", numLoads, [&]() {
+        std::size_t count = 0;
+        for (const Complex& load : loads) {
+            calc.setLoadImpedance(load);
+            count += calc.calculateAll().size();
+        }
+        Bench::consume(count);
+    });
+    
+    Bench::measure("matching/calculateSingleStub/1k-loads", numLoads, [&]() {
+        std::size_t count = 0;
+        for (const Complex& load : loads) {
+            calc.setLoadImpedance(load);
+            count += calc.calculateSingleStub().size();
+        }
+        Bench::consume(count);
+    });
+}
+
+Bench::Registrar s_registrar("matching", &runMatchingBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,48 @@
+/**
+ * @file bench_matchingcache.cpp
+ * @brief Matching calculator with and without the result cache
+ */
+
+#include "benchharness.h"
+#include "../src/core/matchingcache.h"
+#include <memory>
+#include <vector>
+
+namespace SmithTool {
+namespace {
+
+void runMatchingCacheBenchmarks()
+{
+    // A handful of loads revisited over and over, as in interactive use
+    const std::vector<Complex> loads = {
+        Complex(12.0, -30.0), Complex(25.0, 15.0), Complex(100.0, -50.0),
+        Complex(8.0, 4.0), Complex(200.0, 80.0), Complex(35.0, -5.0),
+    };
+    
+    auto run = [&loads](const std::shared_ptr<MatchingResultCache>& cache) {
+        MatchingCalculator calc;
+        calc.setCache(cache);
+        calc.setFrequency(900e6);
+        
+        std::size_t count = 0;
+        for (const Complex& load : loads) {
+            calc.setLoadImpedance(load);
+            count += calc.calculateAll().size();
+            count += calc.calculateSingleStub().size();
+            count += calc.calculateQuarterWave().size();
+        }
+        Bench::consume(count);
+    };
+    
+    const long long items = static_cast<long long>(loads.size());
+    
+    Bench::measure("matchingcache/uncached", items, [&]() { run(nullptr); });
+    
+    auto cache = std::make_shared<MatchingResultCache>();
+    Bench::measure("matchingcache/cached", items, [&]() { run(cache); });
+}
+
+Bench::Registrar s_registrar("matchingcache", &runMatchingCacheBenchmarks);
+
+} // namespace
+} // namespace SmithTool
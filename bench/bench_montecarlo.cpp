@@ -0,0 +1,45 @@
+/**
+ * @file bench_montecarlo.cpp
+ * @brief Monte Carlo yield benchmarks: single thread vs. worker threads
+ */
+
+#include "benchharness.h"
+#include "../src/core/montecarlo.h"
+
+namespace SmithTool {
+namespace {
+
+void runMonteCarloBenchmarks()
+{
+    // Same four-element ladder as the sweep benchmarks
+    MonteCarloAnalysis analysis;
+    analysis.setLoadImpedance(Complex(20.0, -30.0));
+    analysis.setElements({
+        SweepElement(ComponentType::Inductor, ConnectionType::Series, 3e-9),
+        SweepElement(ComponentType::Capacitor, ConnectionType::Shunt, 1.2e-12),
+        SweepElement(ComponentType::Inductor, ConnectionType::Series, 2e-9),
+        SweepElement(ComponentType::Capacitor, ConnectionType::Shunt, 0.8e-12)
+    });
+    
+    MonteCarloSettings settings;
+    settings.frequencies = FrequencySweep::linearFrequencies(1.8e9, 2.2e9, 201);
+    
+    for (int samples : {10000, 100000}) {
+        settings.samples = samples;
+        QString suffix = QString("%1k").arg(samples / 1000);
+        
+        for (int threads : {1, 0}) {
+            settings.threadCount = threads;
+            Bench::measure(QString("montecarlo/ladder4x201/%1/%2").arg(threads == 1 ? "1-thread" : "all-threads").arg(suffix),
+                           samples, [&]() {
+                MonteCarloResult result = analysis.run(settings);
+                Bench::consume(result.passed);
+            });
+        }
+    }
+}
+
+Bench::Registrar s_registrar("montecarlo", &runMonteCarloBenchmarks);
+
+} // namespace
+} // namespace SmithTool
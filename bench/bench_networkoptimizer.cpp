@@ -0,0 +1,51 @@
+/**
+ * @file bench_networkoptimizer.cpp
+ * @brief Ladder optimizer benchmarks (multi-start BFGS, 2.4-2.5 GHz)
+ */
+
+#include "benchharness.h"
+#include "../src/core/networkoptimizer.h"
+#include <vector>
+
+namespace SmithTool {
+namespace {
+
+std::vector<OptimizerElement> lcLadder(int count)
+{
+    // Alternating shunt C / series L, from the load
+    std::vector<OptimizerElement> elements;
+    for (int i = 0; i < count; ++i) {
+        bool series = (i % 2) == 1;
+        elements.emplace_back(SweepElement(series ? ComponentType::Inductor : ComponentType::Capacitor,
+                                           series ? ConnectionType::Series : ConnectionType::Shunt,
+                                           series ? 2e-9 : 1e-12));
+    }
+    return elements;
+}
+
+void runNetworkOptimizerBenchmarks()
+{
+    const int sizes[] = {2, 4, 8};
+    
+    for (int size : sizes) {
+        NetworkOptimizer optimizer;
+        optimizer.setTopology(lcLadder(size));
+        optimizer.setSourceImpedance(Complex(50.0, 0.0));
+        optimizer.setLoadImpedance(Complex(12.0, -30.0));
+        
+        OptimizerSettings settings;
+        settings.startFrequency = 2.4e9;
+        settings.stopFrequency = 2.5e9;
+        optimizer.setSettings(settings);
+        
+        Bench::measure(QString("networkoptimizer/lc-ladder-%1/16-starts").arg(size), 1, [&]() {
+            OptimizerResult result = optimizer.run();
+            Bench::consume(static_cast<std::size_t>(result.evaluations));
+        });
+    }
+}
+
+Bench::Registrar s_registrar("networkoptimizer", &runNetworkOptimizerBenchmarks);
+
+} // namespace
+} // namespace SmithTool
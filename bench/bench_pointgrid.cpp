@@ -0,0 +1,69 @@
+/**
+ * @file bench_pointgrid.cpp
+ * @brief Hit-testing benchmarks: linear scan vs. PointGrid
+ */
+
+#include "benchharness.h"
+#include "../src/core/pointgrid.h"
+#include <random>
+#include <vector>
+
+namespace SmithTool {
+namespace {
+
+void runPointGridBenchmarks()
+{
+    const int count = 1000000;
+    const int queries = 1000;
+    const double radius = 12.0;
+    
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> coord(100.0, 700.0);
+    
+    std::vector<QPointF> points(count);
+    for (QPointF& p : points) {
+        p = QPointF(coord(rng), coord(rng));
+    }
+    std::vector<QPointF> cursor(queries);
+    for (QPointF& p : cursor) {
+        p = QPointF(coord(rng), coord(rng));
+    }
+    
+    Bench::measure("pointgrid/linear-nearest/1M", queries, [&]() {
+        std::size_t found = 0;
+        for (const QPointF& q : cursor) {
+            int best = -1;
+            double bestDist2 = radius * radius;
+            for (int i = 0; i < count; ++i) {
+                double dx = points[i].x() - q.x();
+                double dy = points[i].y() - q.y();
+                double d2 = dx * dx + dy * dy;
+                if (d2 < bestDist2) {
+                    bestDist2 = d2;
+                    best = i;
+                }
+            }
+            found += (best >= 0);
+        }
+        Bench::consume(found);
+    });
+    
+    PointGrid grid;
+    Bench::measure("pointgrid/build/1M", count, [&]() {
+        grid.build(points.data(), points.size(), radius);
+        Bench::consume(static_cast<std::size_t>(grid.size()));
+    });
+    
+    Bench::measure("pointgrid/nearest/1M", queries, [&]() {
+        std::size_t found = 0;
+        for (const QPointF& q : cursor) {
+            found += (grid.nearest(q, radius) >= 0);
+        }
+        Bench::consume(found);
+    });
+}
+
+Bench::Registrar s_registrar("pointgrid", &runPointGridBenchmarks);
+
+} // namespace
+} // namespace SmithTool
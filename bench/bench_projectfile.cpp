@@ -0,0 +1,94 @@
+/**
+ * @file bench_projectfile.cpp
+ * @brief Project file benchmarks: open with lazy datasets vs. decoding all
+ */
+
+#include "benchharness.h"
+#include "../src/data/projectfile.h"
+#include <QTemporaryDir>
+#include <cmath>
+#include <cstdio>
+
+namespace SmithTool {
+namespace {
+
+// Project with a short network and a lot of synthetic two-port DUTs
+ProjectState makeProject(int datasets, int numPoints)
+{
+    ProjectState state;
+    state.loadZ = {25.0, -15.0};
+    state.elements = {{ComponentType::Capacitor, ConnectionType::Shunt, 2.2e-12},
+                      {ComponentType::Inductor, ConnectionType::Series, 4.7e-9}};
+    state.settings["labels"] = true;
+    state.settings["sweepPoints"] = 2001;
+    
+    for (int d = 0; d < datasets; ++d) {
+        std::vector<double> frequencies(numPoints);
+        std::vector<std::vector<Complex>> params(4, std::vector<Complex>(numPoints));
+        for (int i = 0; i < numPoints; ++i) {
+            double f = 1e8 + 9.9e9 * i / (numPoints - 1);
+            frequencies[i] = f;
+            double ph = f * 1e-9 + 0.01 * d;
+            params[0][i] = std::polar(0.3 + 0.001 * d, ph);
+            params[1][i] = std::polar(0.9, -ph);
+            params[2][i] = std::polar(0.9, -ph);
+            params[3][i] = std::polar(0.4, 0.5 * ph);
+        }
+        
+        auto data = std::make_shared<SParamData>();
+        data->setNumPorts(2);
+        data->assignPoints(std::move(frequencies), std::move(params));
+        
+        ProjectDataset dataset;
+        dataset.name = QString("dut_%1.s2p").arg(d);
+        dataset.role = d == 0 ? ProjectDataset::Role::Current : ProjectDataset::Role::Overlay;
+        dataset.data = std::move(data);
+        state.datasets.push_back(std::move(dataset));
+    }
+    return state;
+}
+
+void runProjectFileBenchmarks()
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::fprintf(stderr, "Cannot create temporary directory\n");
+        return;
+    }
+    
+    const int datasets = 200;
+    const QString path = dir.filePath("lot.smtproj");
+    QString error;
+    if (!ProjectFile::write(path, makeProject(datasets, 1001), error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return;
+    }
+    
+    // What opening costs before anything is drawn: network, settings, index
+    Bench::measure("projectfile/open/200x1001", datasets, [&]() {
+        ProjectFile project;
+        project.open(path, error);
+        Bench::consume(static_cast<std::size_t>(project.datasetCount()));
+    });
+    
+    // Open plus the main dataset, as the window does
+    Bench::measure("projectfile/open+current/200x1001", datasets, [&]() {
+        ProjectFile project;
+        project.open(path, error);
+        Bench::consume(static_cast<std::size_t>(project.loadDataset(0, error)->numPoints()));
+    });
+    
+    // Every overlay decoded, e.g. for the lot envelope
+    Bench::measure("projectfile/open+all/200x1001", datasets, [&]() {
+        ProjectFile project;
+        project.open(path, error);
+        for (int i = 0; i < project.datasetCount(); ++i) {
+            Bench::consume(static_cast<std::size_t>(project.loadDataset(i, error)->numPoints()));
+        }
+    });
+}
+
+Bench::Registrar s_registrar("projectfile", &runProjectFileBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,119 @@
+/**
+ * @file bench_render.cpp
+ * @brief Offscreen SmithChartWidget frame time and allocations per frame,
+ *        and ChartExporter report images with and without the grid cache
+ *
+ * Runs on the "offscreen" Qt platform unless QT_QPA_PLATFORM is set, so
+ * no display is needed.
+ */
+
+#include "benchharness.h"
+#include "../src/ui/smithchartwidget.h"
+#include "../src/ui/chartexporter.h"
+#include <QApplication>
+#include <QDir>
+#include <QImage>
+#include <cmath>
+#include <memory>
+
+namespace SmithTool {
+namespace {
+
+std::shared_ptr<const SParamData> makeSweep(int numPoints)
+{
+    auto data = std::make_shared<SParamData>();
+    data->setNumPorts(1);
+    data->reserve(numPoints);
+    for (int i = 0; i < numPoints; ++i) {
+        double t = static_cast<double>(i) / numPoints;
+        Complex s11 = std::polar(0.2 + 0.7 * t, -40.0 * t);
+        data->addPoint(1e8 + 1e10 * t, &s11);
+    }
+    return data;
+}
+
+std::shared_ptr<const MatchingTrace> makeTrace()
+{
+    auto trace = std::make_shared<MatchingTrace>();
+    trace->setFrequency(1e9);
+    trace->setLoadImpedance(Complex(12.0, -30.0));
+    trace->addSegment(trace->calculateSeriesElement(ComponentType::Inductor, 3e-9));
+    trace->addSegment(trace->calculateShuntElement(ComponentType::Capacitor, 1.5e-12));
+    trace->addSegment(trace->calculateSeriesElement(ComponentType::Capacitor, 4e-12));
+    trace->addSegment(trace->calculateShuntElement(ComponentType::Inductor, 8e-9));
+    return trace;
+}
+
+void runRenderBenchmarks()
+{
+    // Widgets need an application object; keep it for the rest of the run
+    static int argc = 1;
+    static char name[] = "smithtool_bench";
+    static char* argv[] = {name, nullptr};
+    static std::unique_ptr<QApplication> app;
+    if (!QCoreApplication::instance()) {
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+        app = std::make_unique<QApplication>(argc, argv);
+    }
+    
+    auto trace = makeTrace();
+    
+    for (int numPoints : {1000, 100000}) {
+        QString suffix = QString("%1k").arg(numPoints / 1000);
+        auto data = makeSweep(numPoints);
+        
+        for (bool layered : {false, true}) {
+            SmithChartWidget widget;
+            widget.resize(800, 800);
+            widget.setLayeredRendering(layered);
+            widget.setSParamData(data);
+            widget.setMatchingTrace(trace);
+            
+            QImage image(widget.size(), QImage::Format_ARGB32_Premultiplied);
+            Bench::measure(QString("render/frame/%1/%2").arg(layered ? "layered" : "direct")
+                               .arg(suffix), 1, [&]() {
+                widget.render(&image);
+                Bench::consume(static_cast<std::size_t>(image.pixel(400, 400)));
+            });
+        }
+    }
+    
+    // Report images: one 2400 x 2400 chart per dataset, grid cached or not
+    auto data = makeSweep(100000);
+    ChartScene scene;
+    scene.data = data;
+    scene.matchingTrace = trace;
+    trace->segments();
+    ChartExportSettings settings;
+    for (bool cached : {false, true}) {
+        ChartExporter exporter;
+        Bench::measure(QString("render/export/%1/2400px").arg(cached ? "cached-grid" : "cold-grid"), 1, [&]() {
+            if (!cached) exporter.clearCache();
+            QImage image = exporter.renderImage(scene, settings);
+            Bench::consume(static_cast<std::size_t>(image.pixel(1200, 1200)));
+        });
+    }
+    
+    // A batch of eight on the thread pool shares one grid layer
+    ChartExporter exporter;
+    const QString directory = QDir::temp().filePath("smithtool_bench_export");
+    QDir().mkpath(directory);
+    std::vector<ChartExportJob> jobs(8);
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        jobs[i].scene = scene;
+        jobs[i].filename = QDir(directory).filePath(QString("chart%1.png").arg(i));
+    }
+    Bench::measure("render/export/batch8/png", static_cast<qint64>(jobs.size()), [&]() {
+        QFuture<ChartExportResult> future = exporter.exportAll(jobs, settings);
+        future.waitForFinished();
+        Bench::consume(static_cast<std::size_t>(future.resultCount()));
+    });
+    QDir(directory).removeRecursively();
+}
+
+Bench::Registrar s_registrar("render", &runRenderBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,85 @@
+/**
+ * @file bench_smithmath.cpp
+ * @brief SmithMath benchmarks: scalar loops vs. batch (SIMD) conversions
+ */
+
+#include "benchharness.h"
+#include "../src/core/smithmath.h"
+#include <random>
+#include <vector>
+
+namespace SmithTool {
+namespace {
+
+void runSmithMathBenchmarks()
+{
+    const int count = 1000000;
+    const QString backend = QString::fromLatin1(SmithMath::simdBackend());
+    
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> resistance(0.0, 500.0);
+    std::uniform_real_distribution<double> reactance(-500.0, 500.0);
+    std::uniform_real_distribution<double> unit(-0.7, 0.7);
+    
+    std::vector<Complex> z(count);
+    std::vector<Complex> gamma(count);
+    for (int i = 0; i < count; ++i) {
+        z[i] = Complex(resistance(rng), reactance(rng));
+        gamma[i] = Complex(unit(rng), unit(rng));
+    }
+    
+    std::vector<Complex> out(count);
+    std::vector<QPointF> points(count);
+    std::vector<double> vswr(count);
+    const QPointF center(400.0, 300.0);
+    const double radius = 250.0;
+    
+    Bench::measure("smithmath/impedanceToGamma/scalar/1M", count, [&]() {
+        for (int i = 0; i < count; ++i) {
+            out[i] = SmithMath::impedanceToGamma(z[i], 50.0);
+        }
+        Bench::consume(static_cast<std::size_t>(out[count / 2].real() * 1e6));
+    });
+    Bench::measure(QString("smithmath/impedanceToGamma/%1/1M").arg(backend), count, [&]() {
+        SmithMath::impedanceToGamma(z.data(), out.data(), count, 50.0);
+        Bench::consume(static_cast<std::size_t>(out[count / 2].real() * 1e6));
+    });
+    
+    Bench::measure("smithmath/gammaToImpedance/scalar/1M", count, [&]() {
+        for (int i = 0; i < count; ++i) {
+            out[i] = SmithMath::gammaToImpedance(gamma[i], 50.0);
+        }
+        Bench::consume(static_cast<std::size_t>(out[count / 2].real()));
+    });
+    Bench::measure(QString("smithmath/gammaToImpedance/%1/1M").arg(backend), count, [&]() {
+        SmithMath::gammaToImpedance(gamma.data(), out.data(), count, 50.0);
+        Bench::consume(static_cast<std::size_t>(out[count / 2].real()));
+    });
+    
+    Bench::measure("smithmath/gammaToScreen/scalar/1M", count, [&]() {
+        for (int i = 0; i < count; ++i) {
+            points[i] = SmithMath::gammaToScreen(gamma[i], center, radius);
+        }
+        Bench::consume(static_cast<std::size_t>(points[count / 2].x()));
+    });
+    Bench::measure(QString("smithmath/gammaToScreen/%1/1M").arg(backend), count, [&]() {
+        SmithMath::gammaToScreen(gamma.data(), points.data(), count, center, radius);
+        Bench::consume(static_cast<std::size_t>(points[count / 2].x()));
+    });
+    
+    Bench::measure("smithmath/gammaToVSWR/scalar/1M", count, [&]() {
+        for (int i = 0; i < count; ++i) {
+            vswr[i] = SmithMath::gammaToVSWR(std::abs(gamma[i]));
+        }
+        Bench::consume(static_cast<std::size_t>(vswr[count / 2] * 1e3));
+    });
+    Bench::measure(QString("smithmath/gammaToVSWR/%1/1M").arg(backend), count, [&]() {
+        SmithMath::gammaToVSWR(gamma.data(), vswr.data(), count);
+        Bench::consume(static_cast<std::size_t>(vswr[count / 2] * 1e3));
+    });
+}
+
+Bench::Registrar s_registrar("smithmath", &runSmithMathBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,76 @@
+/**
+ * @file bench_sparamdata.cpp
+ * @brief SParamData lookup benchmarks: per-frequency vs. batched interpolation
+ */
+
+#include "benchharness.h"
+#include "../src/data/sparamdata.h"
+#include <cmath>
+#include <vector>
+
+namespace SmithTool {
+namespace {
+
+// Two-port sweep with optionally jittered (non-uniform) frequencies
+SParamData makeData(int numPoints, bool uniform)
+{
+    SParamData data;
+    data.setNumPorts(2);
+    data.reserve(numPoints);
+    
+    for (int i = 0; i < numPoints; ++i) {
+        double f = 1e8 + 1e6 * i;
+        if (!uniform) {
+            f += 3e5 * std::sin(i * 0.7);
+        }
+        Complex m[4] = {
+            std::polar(0.5, 0.01 * i), std::polar(0.05, -0.02 * i),
+            std::polar(0.8, -0.01 * i), std::polar(0.4, 0.015 * i)
+        };
+        data.addPoint(f, m);
+    }
+    return data;
+}
+
+void runSParamDataBenchmarks()
+{
+    const int numPoints = 10000;
+    const int numQueries = 2000;
+    
+    for (bool uniform : {true, false}) {
+        SParamData data = makeData(numPoints, uniform);
+        const char* grid = uniform ? "uniform" : "jittered";
+        
+        std::vector<double> freqs(numQueries);
+        double span = data.maxFrequency() - data.minFrequency();
+        for (int i = 0; i < numQueries; ++i) {
+            freqs[i] = data.minFrequency() + span * i / (numQueries - 1);
+        }
+        
+        Bench::measure(QString("sparamdata/s11At/%1/2k-of-10k").arg(grid), numQueries, [&]() {
+            Complex sum(0, 0);
+            for (double f : freqs) {
+                sum += data.s11At(f);
+            }
+            Bench::consume(static_cast<std::size_t>(std::abs(sum)));
+        });
+        
+        Bench::measure(QString("sparamdata/s21At/%1/2k-of-10k").arg(grid), numQueries, [&]() {
+            Complex sum(0, 0);
+            for (double f : freqs) {
+                sum += data.s21At(f);
+            }
+            Bench::consume(static_cast<std::size_t>(std::abs(sum)));
+        });
+        
+        Bench::measure(QString("sparamdata/interpolate/%1/2k-of-10k").arg(grid), numQueries, [&]() {
+            std::vector<Complex> values = data.interpolate(freqs, 1, 0);
+            Bench::consume(values.size());
+        });
+    }
+}
+
+Bench::Registrar s_registrar("sparamdata", &runSParamDataBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,63 @@
+/**
+ * @file bench_sparamstatistics.cpp
+ * @brief Lot envelope benchmarks: 1000 files × 2001 points
+ */
+
+#include "benchharness.h"
+#include "../src/data/sparamstatistics.h"
+
+#include <cmath>
+
+namespace SmithTool {
+namespace {
+
+// One S11 file per unit: a resonance whose depth and phase vary per unit
+std::vector<std::shared_ptr<const SParamData>> makeLot(int units, int points, bool sameSweep)
+{
+    std::vector<std::shared_ptr<const SParamData>> lot;
+    FrequencyAxisPool pool;
+    for (int u = 0; u < units; ++u) {
+        // Every other unit is measured half a step off the shared sweep
+        const double offset = sameSweep ? 0.0 : (u % 2) * 0.5e6;
+        std::vector<double> freqs(points);
+        std::vector<std::vector<Complex>> params(1, std::vector<Complex>(points));
+        for (int i = 0; i < points; ++i) {
+            freqs[i] = 1e9 + i * 1e6 + offset;
+            double depth = 0.2 + 0.1 * std::sin(u * 0.7);
+            params[0][i] = std::polar(depth + 0.5 * std::abs(std::sin(i * 0.002)), i * 0.004 + u * 1e-3);
+        }
+        
+        auto data = std::make_shared<SParamData>();
+        data->assignPoints(std::move(freqs), std::move(params));
+        pool.intern(*data);
+        lot.push_back(std::move(data));
+    }
+    return lot;
+}
+
+void runStatisticsBenchmarks()
+{
+    const int units = 1000;
+    const int points = 2001;
+    
+    for (bool sameSweep : {true, false}) {
+        const auto lot = makeLot(units, points, sameSweep);
+        const char* axis = sameSweep ? "shared-axis" : "resampled";
+        
+        SParamStatistics statistics;
+        for (int threads : {1, 0}) {
+            statistics.setThreadCount(threads);
+            Bench::measure(QString("statistics/%1/%2/1000x2001")
+                               .arg(axis).arg(threads == 1 ? "1-thread" : "all-threads"),
+                           units * points, [&]() {
+                SParamEnvelope envelope = statistics.compute(lot, 0, 0);
+                Bench::consume(envelope.size());
+            });
+        }
+    }
+}
+
+Bench::Registrar s_registrar("statistics", &runStatisticsBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,43 @@
+/**
+ * @file bench_spiceexporter.cpp
+ * @brief SPICE batch export benchmarks: tolerance corner libraries
+ */
+
+#include "benchharness.h"
+#include "../src/data/spiceexporter.h"
+
+namespace SmithTool {
+namespace {
+
+void runSpiceExporterBenchmarks()
+{
+    // Twelve toleranced elements: 4096 corners
+    SpiceNetwork nominal;
+    nominal.name = "ladder12";
+    nominal.loadZ = {20.0, -30.0};
+    std::vector<ToleranceSpec> tolerances;
+    for (int i = 0; i < 12; ++i) {
+        if (i % 2 == 0) {
+            nominal.elements.emplace_back(ComponentType::Inductor, ConnectionType::Series, 2e-9 + 0.1e-9 * i);
+            tolerances.emplace_back(0.02);
+        } else {
+            nominal.elements.emplace_back(ComponentType::Capacitor, ConnectionType::Shunt, 1e-12 + 0.1e-12 * i);
+            tolerances.emplace_back(0.0, 0.25e-12);
+        }
+    }
+    const std::vector<SpiceNetwork> corners = SpiceExporter::toleranceCorners(nominal, tolerances);
+    
+    SpiceExporter exporter;
+    for (int threads : {1, 0}) {
+        exporter.setThreadCount(threads);
+        Bench::measure(QString("spiceexporter/library/4096corners/%1").arg(threads == 1 ? "1-thread" : "all-threads"),
+                       static_cast<int>(corners.size()), [&]() {
+            Bench::consume(static_cast<std::size_t>(exporter.generateLibrary(corners).size()));
+        });
+    }
+}
+
+Bench::Registrar s_registrar("spiceexporter", &runSpiceExporterBenchmarks);
+
+} // namespace
+} // namespace SmithTool
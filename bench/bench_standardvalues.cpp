@@ -0,0 +1,54 @@
+/**
+ * @file bench_standardvalues.cpp
+ * @brief Standard-value search benchmarks (3-element networks)
+ */
+
+#include "benchharness.h"
+#include "../src/core/standardvalues.h"
+#include <vector>
+
+namespace SmithTool {
+namespace {
+
+void runStandardValueBenchmarks()
+{
+    MatchingCalculator calc;
+    calc.setSourceImpedance(Complex(50.0, 0.0));
+    calc.setLoadImpedance(Complex(12.0, -30.0));
+    calc.setFrequency(900e6);
+    
+    std::vector<MatchingSolution> networks = calc.calculatePiNetwork();
+    std::vector<MatchingSolution> tNetworks = calc.calculateTNetwork();
+    networks.insert(networks.end(), tNetworks.begin(), tNetworks.end());
+    
+    struct Case {
+        const char* name;
+        ESeries series;
+        int window;
+    };
+    const Case cases[] = {
+        {"standardvalues/pi-t/E24", ESeries::E24, 2},
+        {"standardvalues/pi-t/E96", ESeries::E96, 6},
+        {"standardvalues/pi-t/E96-wide", ESeries::E96, 12},
+    };
+    
+    for (const Case& c : cases) {
+        StandardValueOptimizer optimizer;
+        optimizer.setSeries(c.series);
+        optimizer.setSearchWindow(c.window);
+        optimizer.setBand(0.1, 21);
+        
+        Bench::measure(c.name, static_cast<long long>(networks.size()), [&]() {
+            std::size_t evaluated = 0;
+            for (const MatchingSolution& network : networks) {
+                evaluated += static_cast<std::size_t>(optimizer.optimize(network).evaluated);
+            }
+            Bench::consume(evaluated);
+        });
+    }
+}
+
+Bench::Registrar s_registrar("standardvalues", &runStandardValueBenchmarks);
+
+} // namespace
+} // namespace SmithTool
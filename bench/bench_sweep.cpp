@@ -0,0 +1,56 @@
+/**
+ * @file bench_sweep.cpp
+ * @brief Frequency-sweep benchmarks: single thread vs. worker threads
+ */
+
+#include "benchharness.h"
+#include "../src/core/sweep.h"
+
+namespace SmithTool {
+namespace {
+
+void runSweepBenchmarks()
+{
+    // Four-element ladder, typical of an interactive design
+    FrequencySweep sweep;
+    sweep.setLoadImpedance(Complex(20.0, -30.0));
+    sweep.setElements({
+        SweepElement(ComponentType::Inductor, ConnectionType::Series, 3e-9),
+        SweepElement(ComponentType::Capacitor, ConnectionType::Shunt, 1.2e-12),
+        SweepElement(ComponentType::Inductor, ConnectionType::Series, 2e-9),
+        SweepElement(ComponentType::Capacitor, ConnectionType::Shunt, 0.8e-12)
+    });
+    
+    for (int points : {10000, 100000}) {
+        std::vector<double> freqs = FrequencySweep::linearFrequencies(1e9, 3e9, points);
+        QString suffix = QString("%1k").arg(points / 1000);
+        
+        for (int threads : {1, 0}) {
+            sweep.setThreadCount(threads);
+            Bench::measure(QString("sweep/ladder4/%1/%2").arg(threads == 1 ? "1-thread" : "all-threads").arg(suffix),
+                           points, [&]() {
+                SweepResult result = sweep.run(freqs);
+                Bench::consume(result.gamma.size());
+            });
+        }
+    }
+    
+    // Measured-load locus as redrawn on every drag step (1k-5k points)
+    sweep.setThreadCount(0);
+    for (int points : {1000, 5000}) {
+        std::vector<double> freqs = FrequencySweep::linearFrequencies(1e9, 3e9, points);
+        std::vector<Complex> loads(points);
+        for (int i = 0; i < points; ++i) {
+            loads[i] = Complex(20.0 + 0.01 * i, -30.0 + 0.02 * i);
+        }
+        Bench::measure(QString("sweep/measured-load/%1").arg(points), points, [&]() {
+            SweepResult result = sweep.run(freqs, loads);
+            Bench::consume(result.gamma.size());
+        });
+    }
+}
+
+Bench::Registrar s_registrar("sweep", &runSweepBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,69 @@
+/**
+ * @file bench_tdr.cpp
+ * @brief TDR benchmarks: FFT plans and responses of 1601 to 64k points
+ */
+
+#include "benchharness.h"
+#include "../src/core/fft.h"
+#include "../src/core/smithmath.h"
+#include "../src/data/tdranalyzer.h"
+
+#include <cmath>
+
+namespace SmithTool {
+namespace {
+
+// A fixture: a 40 Ω section 0.5 ns in, then a resistive load at 3 ns
+std::shared_ptr<const SParamData> makeFixture(int points)
+{
+    std::vector<double> freqs(points);
+    std::vector<std::vector<Complex>> params(1, std::vector<Complex>(points));
+    for (int i = 0; i < points; ++i) {
+        freqs[i] = 10e6 + i * (20e9 - 10e6) / (points - 1);
+        const double w = SmithMath::TWO_PI * freqs[i];
+        params[0][i] = -0.11 * std::polar(1.0, -w * 1.0e-9) + 0.11 * std::polar(1.0, -w * 1.5e-9)
+                     + 0.3 * std::polar(1.0, -w * 6.0e-9);
+    }
+    auto data = std::make_shared<SParamData>();
+    data->assignPoints(std::move(freqs), std::move(params));
+    return data;
+}
+
+void runTdrBenchmarks()
+{
+    for (int size : {4096, 1 << 20}) {
+        std::shared_ptr<const FftPlan> plan = FftPlan::forSize(size);
+        std::vector<Complex> data(size, Complex(1.0, 0.0));
+        Bench::measure(QString("tdr/fft/%1").arg(size), size, [&]() {
+            plan->forward(data.data());
+            plan->inverse(data.data());
+            Bench::consume(static_cast<std::size_t>(data[1].real()));
+        });
+    }
+    
+    for (int points : {1601, 65536}) {
+        std::shared_ptr<const SParamData> fixture = makeFixture(points);
+        TdrSettings settings;
+        
+        Bench::measure(QString("tdr/compute/%1").arg(points), points, [&]() {
+            TdrResult result = TdrAnalyzer::compute(*fixture, settings);
+            Bench::consume(static_cast<std::size_t>(result.size()));
+        });
+        
+        // What toggling back to a window already shown costs
+        TdrAnalyzer analyzer;
+        for (TdrWindow window : {TdrWindow::Rectangular, TdrWindow::Hann, TdrWindow::Kaiser}) {
+            settings.window = window;
+            analyzer.insert(fixture, std::make_shared<const TdrResult>(TdrAnalyzer::compute(*fixture, settings)));
+        }
+        settings.window = TdrWindow::Hann;
+        Bench::measure(QString("tdr/cached/%1").arg(points), 1, [&]() {
+            Bench::consume(static_cast<std::size_t>(analyzer.cached(fixture, settings)->size()));
+        });
+    }
+}
+
+Bench::Registrar s_registrar("tdr", &runTdrBenchmarks);
+
+} // namespace
+} // namespace SmithTool
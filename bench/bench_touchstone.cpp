@@ -0,0 +1,71 @@
+/**
+ * @file bench_touchstone.cpp
+ * @brief Touchstone parser benchmarks: text path vs. memory-mapped path
+ */
+
+#include "benchharness.h"
+#include "../src/data/touchstone.h"
+#include <QTemporaryDir>
+#include <QFile>
+#include <QTextStream>
+#include <cmath>
+#include <cstdio>
+
+namespace SmithTool {
+namespace {
+
+// Write a synthetic two-port sweep in MA format
+QString writeS2P(const QTemporaryDir& dir, int numPoints)
+{
+    QString path = dir.filePath(QString("bench_%1.s2p").arg(numPoints));
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return QString();
+    }
+    
+    QTextStream out(&file);
+    out << "! Synthetic benchmark data\n";
+    out << "# GHz S MA R 50\n";
+    for (int i = 0; i < numPoints; ++i) {
+        double f = 0.1 + 9.9 * i / (numPoints - 1);
+        double ph = std::fmod(f * 123.4, 360.0) - 180.0;
+        out << QString::number(f, 'f', 6)
+            << " " << QString::number(0.5 + 0.3 * std::sin(f), 'e', 6) << " " << QString::number(ph, 'f', 3)
+            << " " << QString::number(0.8, 'e', 6) << " " << QString::number(-ph, 'f', 3)
+            << " " << QString::number(0.05, 'e', 6) << " " << QString::number(ph * 0.5, 'f', 3)
+            << " " << QString::number(0.4 + 0.2 * std::cos(f), 'e', 6) << " " << QString::number(ph * 0.25, 'f', 3)
+            << "\n";
+    }
+    return path;
+}
+
+void runTouchstoneBenchmarks()
+{
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::fprintf(stderr, "Cannot create temporary directory\n");
+        return;
+    }
+    
+    for (int numPoints : {1000, 100000, 1000000}) {
+        QString path = writeS2P(dir, numPoints);
+        QString suffix = (numPoints >= 1000000) ? QString("%1M").arg(numPoints / 1000000)
+                       : (numPoints >= 1000) ? QString("%1k").arg(numPoints / 1000)
+                                             : QString::number(numPoints);
+        
+        for (bool fast : {false, true}) {
+            TouchstoneParser parser;
+            parser.setFastPathEnabled(fast);
+            Bench::measure(QString("touchstone/parse/%1/%2").arg(fast ? "fast" : "text").arg(suffix),
+                           numPoints, [&]() {
+                parser.parse(path);
+                Bench::consume(static_cast<std::size_t>(parser.data().numPoints()));
+            });
+        }
+    }
+}
+
+Bench::Registrar s_registrar("touchstone", &runTouchstoneBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,88 @@
+/**
+ * @file bench_trace.cpp
+ * @brief MatchingTrace element edits for lumped and stub ladders of 1-16 segments
+ */
+
+#include "benchharness.h"
+#include "../src/core/trace.h"
+
+namespace SmithTool {
+namespace {
+
+// Alternating series L / shunt C ladder, as built interactively
+MatchingTrace makeLadder(int numSegments)
+{
+    MatchingTrace trace;
+    trace.setFrequency(1e9);
+    trace.setLoadImpedance(Complex(12.0, -30.0));
+    
+    for (int i = 0; i < numSegments; ++i) {
+        if (i % 2 == 0) {
+            trace.addSegment(trace.calculateSeriesElement(ComponentType::Inductor, 3e-9));
+        } else {
+            trace.addSegment(trace.calculateShuntElement(ComponentType::Capacitor, 1.5e-12));
+        }
+    }
+    return trace;
+}
+
+// Series line / shunt open stub ladder (single-stub sections)
+MatchingTrace makeStubLadder(int numSegments)
+{
+    MatchingTrace trace;
+    trace.setFrequency(1e9);
+    trace.setLoadImpedance(Complex(12.0, -30.0));
+    
+    for (int i = 0; i < numSegments; ++i) {
+        if (i % 2 == 0) {
+            trace.addSegment(trace.calculateSeriesElement(ComponentType::TransmissionLine, 0.04));
+        } else {
+            trace.addSegment(trace.calculateShuntElement(ComponentType::OpenStub, 0.02));
+        }
+    }
+    return trace;
+}
+
+void runTraceBenchmarks()
+{
+    const int edits = 1000;
+    
+    for (int numSegments : {1, 2, 4, 8, 16}) {
+        MatchingTrace trace = makeLadder(numSegments);
+        const double base = trace.segment(0).componentValue;
+        
+        // Editing the first element invalidates everything downstream
+        Bench::measure(QString("trace/updateSegmentValue/%1").arg(numSegments), edits, [&]() {
+            for (int i = 0; i < edits; ++i) {
+                trace.updateSegmentValue(0, base * (1.0 + 0.001 * (i % 100)));
+            }
+            Bench::consume(static_cast<std::size_t>(std::abs(trace.currentImpedance())));
+        });
+        
+        // Same edit followed by the point regeneration a repaint triggers
+        Bench::measure(QString("trace/updateSegmentValue+points/%1").arg(numSegments), edits, [&]() {
+            std::size_t points = 0;
+            for (int i = 0; i < edits; ++i) {
+                trace.updateSegmentValue(0, base * (1.0 + 0.001 * (i % 100)));
+                points += trace.segments().back().points.size();
+            }
+            Bench::consume(points);
+        });
+        
+        // Line drag: solve the length for a target, then apply it
+        MatchingTrace stubs = makeStubLadder(numSegments);
+        const Complex target = stubs.segment(0).endImpedance;
+        Bench::measure(QString("trace/lineLengthFor+update/%1").arg(numSegments), edits, [&]() {
+            for (int i = 0; i < edits; ++i) {
+                Complex z = target * Complex(1.0, 0.001 * (i % 100));
+                stubs.updateSegmentValue(0, stubs.lineLengthFor(0, z));
+            }
+            Bench::consume(static_cast<std::size_t>(std::abs(stubs.currentImpedance())));
+        });
+    }
+}
+
+Bench::Registrar s_registrar("trace", &runTraceBenchmarks);
+
+} // namespace
+} // namespace SmithTool
@@ -0,0 +1,85 @@
+/**
+ * @file bench_twoport.cpp
+ * @brief Two-port analysis benchmarks: stability and circles of 1601 to 1M points
+ */
+
+#include "benchharness.h"
+#include "../src/core/smithmath.h"
+#include "../src/data/twoportanalyzer.h"
+
+#include <cmath>
+
+namespace SmithTool {
+namespace {
+
+// A transistor-like two-port, potentially unstable at the low end
+std::shared_ptr<const SParamData> makeFixture(int points)
+{
+    std::vector<double> freqs(points);
+    std::vector<std::vector<Complex>> params(4, std::vector<Complex>(points));
+    for (int i = 0; i < points; ++i) {
+        const double t = static_cast<double>(i) / (points - 1);
+        freqs[i] = 100e6 + t * (10e9 - 100e6);
+        params[0][i] = std::polar(0.8 - 0.3 * t, -1.0 - 2.0 * t);
+        params[1][i] = std::polar(0.08 + 0.05 * t, 1.2 - 0.8 * t);
+        params[2][i] = std::polar(6.0 - 4.5 * t, 2.0 - 1.5 * t);
+        params[3][i] = std::polar(0.7 - 0.2 * t, -0.5 - 1.0 * t);
+    }
+    auto data = std::make_shared<SParamData>();
+    data->setNumPorts(2);
+    data->assignPoints(std::move(freqs), std::move(params));
+    
+    auto noise = std::make_shared<NoiseParameters>();
+    for (int k = 0; k <= 10; ++k) {
+        noise->frequencies.push_back(1e9 + k * 0.8e9);
+        noise->fMinDb.push_back(0.4 + 0.1 * k);
+        noise->gammaOpt.push_back(std::polar(0.5, 0.3 * k));
+        noise->rn.push_back(0.2);
+    }
+    data->setNoiseParameters(std::move(noise));
+    return data;
+}
+
+void runTwoPortBenchmarks()
+{
+    for (int points : {1601, 1 << 20}) {
+        std::shared_ptr<const SParamData> fixture = makeFixture(points);
+        const std::size_t n = static_cast<std::size_t>(points);
+        
+        // The stability kernel alone, then everything the panel needs
+        std::vector<double> out(10 * n);
+        SmithMath::TwoPortStabilityArrays arrays;
+        double** columns[] = {&arrays.k, &arrays.mu, &arrays.muSource, &arrays.maxGain,
+                          &arrays.sourceCenterRe, &arrays.sourceCenterIm, &arrays.sourceRadius,
+                          &arrays.loadCenterRe, &arrays.loadCenterIm, &arrays.loadRadius};
+        for (std::size_t k = 0; k < 10; ++k) {
+            *columns[k] = out.data() + k * n;
+        }
+        Bench::measure(QString("twoport/stability/%1").arg(points), points, [&]() {
+            SmithMath::twoPortStability(fixture->sData(0, 0).data(), fixture->sData(1, 0).data(),
+                                        fixture->sData(0, 1).data(), fixture->sData(1, 1).data(),
+                                        n, arrays);
+            Bench::consume(static_cast<std::size_t>(out[n / 2] > 1.0));
+        });
+        
+        Bench::measure(QString("twoport/compute/%1").arg(points), points, [&]() {
+            TwoPortAnalysis analysis = TwoPortAnalyzer::compute(*fixture);
+            Bench::consume(static_cast<std::size_t>(analysis.size()));
+        });
+        
+        // What scrubbing to another frequency costs once the analysis exists
+        TwoPortAnalyzer analyzer;
+        analyzer.insert(fixture, std::make_shared<const TwoPortAnalysis>(TwoPortAnalyzer::compute(*fixture)));
+        int index = 0;
+        Bench::measure(QString("twoport/select/%1").arg(points), 1, [&]() {
+            std::shared_ptr<const TwoPortAnalysis> analysis = analyzer.cached(fixture);
+            index = (index + 7919) % points;
+            Bench::consume(static_cast<std::size_t>(analysis->gainCircle(0, index).radius > 0.0));
+        });
+    }
+}
+
+Bench::Registrar s_registrar("twoport", &runTwoPortBenchmarks);
+
+} // namespace
+} // namespace SmithTool
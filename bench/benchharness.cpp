@@ -0,0 +1,230 @@
+/**
+ * @file benchharness.cpp
+ * @brief Minimal benchmark harness implementation
+ */
+
+#include "benchharness.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<long long> g_allocations(0);
+
+inline void countAllocation()
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+// Interpose malloc so allocations made inside Qt are counted as well;
+// operator new goes through malloc in libstdc++
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+
+void* malloc(std::size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size)
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, std::size_t size)
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+}
+#else
+// Elsewhere only C++ allocations are seen; the other forms forward here
+void* operator new(std::size_t size)
+{
+    countAllocation();
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+namespace SmithTool {
+namespace Bench {
+
+namespace {
+
+struct Suite {
+    const char* name;
+    SuiteFunction fn;
+};
+
+std::vector<Suite>& suites()
+{
+    static std::vector<Suite> s_suites;
+    return s_suites;
+}
+
+std::vector<Result>& results()
+{
+    static std::vector<Result> s_results;
+    return s_results;
+}
+
+volatile std::size_t g_sink = 0;
+
+const qint64 MIN_ITERATIONS = 3;
+const qint64 MIN_TIME_NS = 200000000;  // 200 ms per case
+
+} // namespace
+
+Result measure(const QString& name, qint64 itemsPerIteration,
+               const std::function<void()>& fn)
+{
+    // Warm-up run (page cache, allocator, branch predictors)
+    fn();
+    
+    const qint64 allocationsBefore = allocationCount();
+    QElapsedTimer timer;
+    timer.start();
+    qint64 iterations = 0;
+    qint64 elapsed = 0;
+    do {
+        fn();
+        ++iterations;
+        elapsed = timer.nsecsElapsed();
+    } while (iterations < MIN_ITERATIONS || elapsed < MIN_TIME_NS);
+    const qint64 allocations = allocationCount() - allocationsBefore;
+    
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.nsPerIteration = static_cast<double>(elapsed) / iterations;
+    result.itemsPerSecond = (itemsPerIteration > 0)
+        ? itemsPerIteration * 1e9 / result.nsPerIteration : 0.0;
+    result.allocationsPerIteration = static_cast<double>(allocations) / iterations;
+    
+    std::printf("%-48s %10lld it %14.1f ns/it",
+                name.toUtf8().constData(),
+                static_cast<long long>(iterations),
+                result.nsPerIteration);
+    if (itemsPerIteration > 0) {
+        std::printf(" %14.3e items/s", result.itemsPerSecond);
+    }
+    std::printf(" %10.1f allocs/it", result.allocationsPerIteration);
+    std::printf("\n");
+    std::fflush(stdout);
+    
+    results().push_back(result);
+    return result;
+}
+
+qint64 allocationCount()
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+void consume(std::size_t value)
+{
+    g_sink = g_sink + value;
+}
+
+Registrar::Registrar(const char* suiteName, SuiteFunction fn)
+{
+    suites().push_back({suiteName, fn});
+}
+
+int runSuites(const QStringList& filters)
+{
+    int count = 0;
+    for (const Suite& suite : suites()) {
+        bool selected = filters.isEmpty();
+        for (const QString& filter : filters) {
+            if (QString(suite.name).contains(filter)) {
+                selected = true;
+                break;
+            }
+        }
+        if (!selected) continue;
+        
+        std::printf("== %s ==\n", suite.name);
+        suite.fn();
+        ++count;
+    }
+    return count;
+}
+
+bool writeJson(const QString& path)
+{
+    QJsonObject context;
+    context["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    context["host_name"] = QSysInfo::machineHostName();
+    context["cpu"] = QSysInfo::currentCpuArchitecture();
+    context["num_cpus"] = static_cast<int>(std::thread::hardware_concurrency());
+    context["os"] = QSysInfo::prettyProductName();
+    context["qt_version"] = QString(qVersion());
+    context["executable"] = QString("smithtool_bench");
+#ifdef NDEBUG
+    context["library_build_type"] = QString("release");
+#else
+    context["library_build_type"] = QString("debug");
+#endif
+
+    QJsonArray benchmarks;
+    for (const Result& result : results()) {
+        QJsonObject entry;
+        entry["name"] = result.name;
+        entry["run_type"] = QString("iteration");
+        entry["iterations"] = result.iterations;
+        entry["real_time"] = result.nsPerIteration;
+        entry["time_unit"] = QString("ns");
+        if (result.itemsPerSecond > 0.0) {
+            entry["items_per_second"] = result.itemsPerSecond;
+        }
+        // Google Benchmark's memory manager field
+        entry["allocs_per_iter"] = result.allocationsPerIteration;
+        benchmarks.append(entry);
+    }
+    
+    QJsonObject root;
+    root["context"] = context;
+    root["benchmarks"] = benchmarks;
+    
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    return file.write(json) == json.size();
+}
+
+} // namespace Bench
+} // namespace SmithTool
@@ -0,0 +1,85 @@
+/**
+ * @file benchharness.h
+ * @brief Minimal benchmark harness for SmithTool hot paths
+ */
+
+#ifndef SMITHTOOL_BENCHHARNESS_H
+#define SMITHTOOL_BENCHHARNESS_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <cstddef>
+
+namespace SmithTool {
+namespace Bench {
+
+/**
+ * @brief Timing result of one benchmark case
+ */
+struct Result {
+    QString name;
+    qint64 iterations;
+    double nsPerIteration;
+    double itemsPerSecond;
+    double allocationsPerIteration;     // Heap allocations, all threads
+};
+
+/**
+ * @brief Run a callable repeatedly and report its mean time
+ * 
+ * The callable is run at least three times and until the minimum
+ * measuring time has elapsed.
+ * 
+ * @param name Case name, e.g. "touchstone/fast/100k"
+ * @param itemsPerIteration Items processed per call (0 = not reported)
+ * @param fn Work to time
+ * @return Timing result (also printed)
+ */
+Result measure(const QString& name, qint64 itemsPerIteration,
+               const std::function<void()>& fn);
+
+/**
+ * @brief Heap allocations made so far by every thread
+ * 
+ * Counted by the harness's replacement of the global allocation
+ * functions (malloc itself on glibc, so Qt containers count too).
+ */
+qint64 allocationCount();
+
+/**
+ * @brief Keep a value alive so the optimizer cannot drop the work
+ */
+void consume(std::size_t value);
+
+/**
+ * @brief Registers a benchmark suite at static-initialization time
+ */
+using SuiteFunction = void (*)();
+
+struct Registrar {
+    Registrar(const char* suiteName, SuiteFunction fn);
+};
+
+/**
+ * @brief Run all suites whose name contains one of the filters
+ * @param filters Substrings to match (empty = run everything)
+ * @return Number of suites run
+ */
+int runSuites(const QStringList& filters);
+
+/**
+ * @brief Write every result measured so far as JSON
+ * 
+ * The layout follows Google Benchmark's (a "context" object and a
+ * "benchmarks" array with real_time in ns), so the same tooling can
+ * compare runs between releases.
+ * 
+ * @return false if the file cannot be written
+ */
+bool writeJson(const QString& path);
+
+} // namespace Bench
+} // namespace SmithTool
+
+#endif // SMITHTOOL_BENCHHARNESS_H
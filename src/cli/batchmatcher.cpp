@@ -0,0 +1,414 @@
+/**
+ * @file batchmatcher.cpp
+ * @brief Headless batch matching implementation
+ */
+
+#include "batchmatcher.h"
+#include "../core/parallel.h"
+#include "../core/smithmath.h"
+#include "../data/touchstone.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace SmithTool {
+
+namespace {
+
+const QRegularExpression& touchstoneSuffix()
+{
+    static const QRegularExpression re("\\.s\\d+p$", QRegularExpression::CaseInsensitiveOption);
+    return re;
+}
+
+const char* topologyName(MatchingTopology topology)
+{
+    switch (topology) {
+        case MatchingTopology::LSection: return "L";
+        case MatchingTopology::LSection_Reversed: return "L-reversed";
+        case MatchingTopology::PiNetwork: return "Pi";
+        case MatchingTopology::TNetwork: return "T";
+        case MatchingTopology::SingleStubOpen: return "open-stub";
+        case MatchingTopology::SingleStubShort: return "short-stub";
+        case MatchingTopology::QuarterWave: return "quarter-wave";
+    }
+    return "unknown";
+}
+
+const char* typeName(ComponentType type)
+{
+    switch (type) {
+        case ComponentType::Resistor: return "R";
+        case ComponentType::Inductor: return "L";
+        case ComponentType::Capacitor: return "C";
+        case ComponentType::TransmissionLine: return "TL";
+        case ComponentType::OpenStub: return "open-stub";
+        case ComponentType::ShortStub: return "short-stub";
+        default: return "none";
+    }
+}
+
+const char* connectionName(ConnectionType connection)
+{
+    return (connection == ConnectionType::Series) ? "series" : "shunt";
+}
+
+// Quote for CSV (RFC 4180) or JSON string content
+std::string csvField(const QString& text)
+{
+    std::string s = text.toStdString();
+    if (s.find_first_of(",\"\n") == std::string::npos) return s;
+    
+    std::string quoted = "\"";
+    for (char c : s) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+std::string jsonString(const QString& text)
+{
+    std::string quoted = "\"";
+    for (char c : text.toStdString()) {
+        switch (c) {
+            case '"': quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\t': quoted += "\\t"; break;
+            default: quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+void appendNumber(std::string& out, double value)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    out += buffer;
+}
+
+} // namespace
+
+BatchMatcher::BatchMatcher(const BatchOptions& options)
+    : m_options(options)
+{
+}
+
+bool BatchMatcher::addInput(const QString& path)
+{
+    QFileInfo info(path);
+    if (!info.exists()) return false;
+    
+    if (!info.isDir()) {
+        m_inputs.append(path);
+        return true;
+    }
+    
+    QDir dir(path);
+    const QStringList files = dir.entryList(QStringList() << "*.s*p" << "*.csv" << "*.txt",
+                                            QDir::Files, QDir::Name);
+    for (const QString& file : files) {
+        m_inputs.append(dir.filePath(file));
+    }
+    return true;
+}
+
+bool BatchMatcher::loadInput(int index, std::vector<BatchLoad>& loads, QString& error) const
+{
+    if (touchstoneSuffix().match(m_inputs[index]).hasMatch()) {
+        return loadTouchstone(index, loads, error);
+    }
+    return loadImpedanceList(index, loads, error);
+}
+
+bool BatchMatcher::loadTouchstone(int index, std::vector<BatchLoad>& loads, QString& error) const
+{
+    TouchstoneParser parser;
+    if (!parser.parse(m_inputs[index])) {
+        error = parser.lastError();
+        return false;
+    }
+    
+    // Every measured frequency becomes one load (from S11)
+    const SParamData& data = parser.data();
+    const std::vector<Complex>& s11 = data.sData(0, 0);
+    loads.reserve(loads.size() + s11.size());
+    for (int i = 0; i < data.numPoints(); ++i) {
+        BatchLoad load;
+        load.source = index;
+        load.frequency = data.frequency(i);
+        load.impedance = SmithMath::gammaToImpedance(s11[i], data.referenceImpedance());
+        loads.push_back(load);
+    }
+    return true;
+}
+
+bool BatchMatcher::loadImpedanceList(int index, std::vector<BatchLoad>& loads, QString& error) const
+{
+    QFile file(m_inputs[index]);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        error = QString("Cannot open file: %1").arg(m_inputs[index]);
+        return false;
+    }
+    
+    static const QRegularExpression separators("[\\s,;]+");
+    QTextStream in(&file);
+    int lineNumber = 0;
+    
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty() || line.startsWith('#') || line.startsWith('!')) continue;
+        
+        QStringList parts = line.split(separators, Qt::SkipEmptyParts);
+        std::vector<double> values;
+        bool numeric = true;
+        for (const QString& part : parts) {
+            bool ok;
+            values.push_back(part.toDouble(&ok));
+            numeric = numeric && ok;
+        }
+        if (!numeric) {
+            if (loads.empty()) continue;   // Header line
+            error = QString("%1:%2: not a number").arg(m_inputs[index]).arg(lineNumber);
+            return false;
+        }
+        
+        BatchLoad load;
+        load.source = index;
+        if (values.size() >= 3) {
+            load.frequency = values[0];
+            load.impedance = Complex(values[1], values[2]);
+        } else if (values.size() == 2 && m_options.defaultFrequency > 0.0) {
+            load.frequency = m_options.defaultFrequency;
+            load.impedance = Complex(values[0], values[1]);
+        } else {
+            error = QString("%1:%2: expected \"f R X\" (or \"R X\" with a frequency option)")
+                .arg(m_inputs[index]).arg(lineNumber);
+            return false;
+        }
+        loads.push_back(load);
+    }
+    return true;
+}
+
+std::vector<MatchingSolution> BatchMatcher::synthesize(const BatchLoad& load) const
+{
+    // Every load is a new design; a shared cache would only add locking
+    MatchingCalculator calc;
+    calc.setCache(nullptr);
+    calc.setSourceImpedance(m_options.sourceZ);
+    calc.setLoadImpedance(load.impedance);
+    calc.setFrequency(load.frequency);
+    calc.setZ0(m_options.z0);
+    
+    std::vector<MatchingSolution> all;
+    auto append = [&all](const std::vector<MatchingSolution>& solutions) {
+        all.insert(all.end(), solutions.begin(), solutions.end());
+    };
+    
+    const unsigned topologies = m_options.topologies;
+    if (topologies & TopologyL) append(calc.calculateLSection());
+    if (topologies & TopologyPi) append(calc.calculatePiNetwork(m_options.targetQ));
+    if (topologies & TopologyT) append(calc.calculateTNetwork(m_options.targetQ));
+    if (topologies & TopologyStub) append(calc.calculateSingleStub());
+    if (topologies & TopologyQuarterWave) append(calc.calculateQuarterWave());
+    return all;
+}
+
+std::string BatchMatcher::header() const
+{
+    if (m_options.format == BatchFormat::Json) return "[\n";
+    return "source,frequency_hz,load_re,load_im,topology,solution,network_q,elements\n";
+}
+
+std::string BatchMatcher::footer() const
+{
+    return (m_options.format == BatchFormat::Json) ? "\n]\n" : std::string();
+}
+
+std::string BatchMatcher::formatChunk(const std::vector<BatchLoad>& loads, size_t begin,
+                                      size_t end) const
+{
+    std::string out;
+    
+    for (size_t i = begin; i < end; ++i) {
+        const BatchLoad& load = loads[i];
+        const std::vector<MatchingSolution> solutions = synthesize(load);
+        const QString& source = m_inputs[load.source];
+        
+        int number = 0;
+        for (const MatchingSolution& sol : solutions) {
+            if (!sol.valid) continue;
+            ++number;
+            
+            if (m_options.format == BatchFormat::Csv) {
+                out += csvField(source);
+                out += ',';
+                appendNumber(out, load.frequency);
+                out += ',';
+                appendNumber(out, load.impedance.real());
+                out += ',';
+                appendNumber(out, load.impedance.imag());
+                out += ',';
+                out += topologyName(sol.topology);
+                out += ',';
+                out += std::to_string(number);
+                out += ',';
+                appendNumber(out, sol.networkQ());
+                out += ',';
+                
+                // "series L 3.3e-09; shunt C 1.2e-12" in base units
+                QString elements;
+                for (size_t e = 0; e < sol.elements.size(); ++e) {
+                    const MatchingElement& elem = sol.elements[e];
+                    if (e > 0) elements += "; ";
+                    elements += QString("%1 %2 %3").arg(connectionName(elem.connection),
+                                                        typeName(elem.type))
+                                                   .arg(elem.value, 0, 'g', 9);
+                }
+                out += csvField(elements);
+                out += '\n';
+            } else {
+                // Every record is prefixed by its separator; run() drops the
+                // one in front of the first record of the stream
+                out += ",\n  ";
+                out += "{\"source\":" + jsonString(source);
+                out += ",\"frequency_hz\":";
+                appendNumber(out, load.frequency);
+                out += ",\"load\":[";
+                appendNumber(out, load.impedance.real());
+                out += ',';
+                appendNumber(out, load.impedance.imag());
+                out += "],\"topology\":\"";
+                out += topologyName(sol.topology);
+                out += "\",\"solution\":" + std::to_string(number);
+                out += ",\"network_q\":";
+                appendNumber(out, sol.networkQ());
+                out += ",\"elements\":[";
+                for (size_t e = 0; e < sol.elements.size(); ++e) {
+                    const MatchingElement& elem = sol.elements[e];
+                    if (e > 0) out += ',';
+                    out += "{\"connection\":\"";
+                    out += connectionName(elem.connection);
+                    out += "\",\"type\":\"";
+                    out += typeName(elem.type);
+                    out += "\",\"value\":";
+                    appendNumber(out, elem.value);
+                    out += '}';
+                }
+                out += "]}";
+            }
+        }
+    }
+    return out;
+}
+
+int BatchMatcher::run(std::FILE* out)
+{
+    m_errors.clear();
+    const int inputCount = m_inputs.size();
+    
+    // Stage 1: read every input in parallel
+    std::vector<std::vector<BatchLoad>> perInput(inputCount);
+    std::vector<QString> inputErrors(inputCount);
+    {
+        const int threads = Parallel::workerCount(m_options.threads, inputCount, 1);
+        std::atomic<int> next(0);
+        auto worker = [&]() {
+            for (int i = next++; i < inputCount; i = next++) {
+                if (!loadInput(i, perInput[i], inputErrors[i])) {
+                    perInput[i].clear();
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+    }
+    
+    std::vector<BatchLoad> loads;
+    for (int i = 0; i < inputCount; ++i) {
+        if (!inputErrors[i].isEmpty()) {
+            m_errors.append(inputErrors[i]);
+        }
+        loads.insert(loads.end(), perInput[i].begin(), perInput[i].end());
+        std::vector<BatchLoad>().swap(perInput[i]);
+    }
+    
+    // Stage 2: synthesize chunks in parallel, write them in input order
+    // as soon as each one (and everything before it) is done
+    const size_t chunkCount = (loads.size() + LOADS_PER_CHUNK - 1) / LOADS_PER_CHUNK;
+    std::vector<std::string> chunks(chunkCount);
+    std::vector<char> ready(chunkCount, 0);
+    std::mutex mutex;
+    std::condition_variable chunkDone;
+    std::atomic<size_t> nextChunk(0);
+    
+    auto worker = [&]() {
+        for (size_t c = nextChunk++; c < chunkCount; c = nextChunk++) {
+            size_t begin = c * LOADS_PER_CHUNK;
+            size_t end = std::min(loads.size(), begin + LOADS_PER_CHUNK);
+            std::string text = formatChunk(loads, begin, end);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                chunks[c].swap(text);
+                ready[c] = 1;
+            }
+            chunkDone.notify_all();
+        }
+    };
+    
+    const int threads = Parallel::workerCount(m_options.threads, static_cast<long long>(chunkCount), 1);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    
+    std::string head = header();
+    std::fwrite(head.data(), 1, head.size(), out);
+    
+    bool wroteRecord = false;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        std::string text;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunkDone.wait(lock, [&]() { return ready[c] != 0; });
+            text.swap(chunks[c]);
+        }
+        if (text.empty()) continue;
+        
+        if (m_options.format == BatchFormat::Json && !wroteRecord) {
+            text.erase(0, 2);   // Drop ",\n" before the very first record
+        }
+        wroteRecord = true;
+        std::fwrite(text.data(), 1, text.size(), out);
+        std::fflush(out);
+    }
+    
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    
+    std::string tail = footer();
+    std::fwrite(tail.data(), 1, tail.size(), out);
+    std::fflush(out);
+    
+    return static_cast<int>(m_errors.size());
+}
+
+} // namespace SmithTool
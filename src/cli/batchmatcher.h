@@ -0,0 +1,126 @@
+/**
+ * @file batchmatcher.h
+ * @brief Headless matching-network synthesis over many loads
+ *
+ * Reads Touchstone files (S11 of every frequency point) and impedance
+ * lists, runs the selected synthesis methods for every load on all cores
+ * and streams the solutions as CSV or JSON in input order.
+ */
+
+#ifndef SMITHTOOL_BATCHMATCHER_H
+#define SMITHTOOL_BATCHMATCHER_H
+
+#include <complex>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <QString>
+#include <QStringList>
+#include "../core/matching.h"
+
+namespace SmithTool {
+
+using Complex = std::complex<double>;
+
+/**
+ * @brief One load to match
+ */
+struct BatchLoad {
+    int source;             // Index into BatchMatcher::inputs()
+    double frequency;       // Hz
+    Complex impedance;      // Ohms
+};
+
+/**
+ * @brief Output format of BatchMatcher
+ */
+enum class BatchFormat {
+    Csv,
+    Json
+};
+
+/**
+ * @brief Synthesis methods to run (bit flags)
+ */
+enum BatchTopology : unsigned {
+    TopologyL = 1u << 0,
+    TopologyPi = 1u << 1,
+    TopologyT = 1u << 2,
+    TopologyStub = 1u << 3,
+    TopologyQuarterWave = 1u << 4,
+    TopologyAll = 0x1f
+};
+
+/**
+ * @brief Settings shared by every load of a batch run
+ */
+struct BatchOptions {
+    Complex sourceZ;
+    double z0;
+    double defaultFrequency;    // For impedance lists without a frequency column
+    double targetQ;             // Pi/T networks
+    unsigned topologies;        // BatchTopology flags
+    int threads;                // 0 = one per hardware thread
+    BatchFormat format;
+    
+    BatchOptions()
+        : sourceZ(50.0, 0.0)
+        , z0(50.0)
+        , defaultFrequency(0.0)
+        , targetQ(2.0)
+        , topologies(TopologyAll)
+        , threads(0)
+        , format(BatchFormat::Csv) {}
+};
+
+/**
+ * @brief Batch matching engine
+ */
+class BatchMatcher {
+public:
+    explicit BatchMatcher(const BatchOptions& options);
+    
+    /**
+     * @brief Add an input file or a directory of files
+     *
+     * Directories contribute every .sNp, .csv and .txt file directly inside
+     * them. Files ending in .sNp are read as Touchstone; anything else as
+     * an impedance list with "f R X" or "R X" per line.
+     *
+     * @return false if the path does not exist
+     */
+    bool addInput(const QString& path);
+    
+    const QStringList& inputs() const { return m_inputs; }
+    
+    /**
+     * @brief Load all inputs and stream the solutions to out
+     * @return Number of inputs that could not be read
+     */
+    int run(std::FILE* out);
+    
+    /**
+     * @brief Errors collected by run(), one per failed input
+     */
+    const QStringList& errors() const { return m_errors; }
+
+private:
+    BatchOptions m_options;
+    QStringList m_inputs;
+    QStringList m_errors;
+    
+    static constexpr int LOADS_PER_CHUNK = 64;
+    
+    bool loadInput(int index, std::vector<BatchLoad>& loads, QString& error) const;
+    bool loadTouchstone(int index, std::vector<BatchLoad>& loads, QString& error) const;
+    bool loadImpedanceList(int index, std::vector<BatchLoad>& loads, QString& error) const;
+    
+    std::vector<MatchingSolution> synthesize(const BatchLoad& load) const;
+    std::string formatChunk(const std::vector<BatchLoad>& loads, size_t begin, size_t end) const;
+    std::string header() const;
+    std::string footer() const;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_BATCHMATCHER_H
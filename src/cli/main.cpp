@@ -0,0 +1,140 @@
+/**
+ * @file main.cpp
+ * @brief SmithToolCli entry point - headless batch matching
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <cstdio>
+#include "batchmatcher.h"
+
+using namespace SmithTool;
+
+namespace {
+
+bool parseComplex(const QString& text, Complex& value)
+{
+    QStringList parts = text.split(',');
+    if (parts.isEmpty() || parts.size() > 2) return false;
+    
+    bool okRe = true, okIm = true;
+    double re = parts[0].toDouble(&okRe);
+    double im = (parts.size() == 2) ? parts[1].toDouble(&okIm) : 0.0;
+    if (!okRe || !okIm) return false;
+    
+    value = Complex(re, im);
+    return true;
+}
+
+bool parseTopologies(const QString& text, unsigned& topologies)
+{
+    topologies = 0;
+    for (const QString& name : text.toLower().split(',', Qt::SkipEmptyParts)) {
+        if (name == "l") topologies |= TopologyL;
+        else if (name == "pi") topologies |= TopologyPi;
+        else if (name == "t") topologies |= TopologyT;
+        else if (name == "stub") topologies |= TopologyStub;
+        else if (name == "qw") topologies |= TopologyQuarterWave;
+        else if (name == "all") topologies |= TopologyAll;
+        else return false;
+    }
+    return topologies != 0;
+}
+
+int fail(const QString& message)
+{
+    std::fprintf(stderr, "SmithToolCli: %s\n", message.toUtf8().constData());
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("SmithToolCli");
+    QCoreApplication::setApplicationVersion("1.5.0");
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Synthesize matching networks for every load in the given Touchstone "
+        "files and impedance lists (\"f R X\" or \"R X\" per line).");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("inputs", "Input files or directories.", "<inputs...>");
+    
+    QCommandLineOption z0Option("z0", "Characteristic impedance (default 50).", "ohms", "50");
+    QCommandLineOption sourceOption("source", "Source impedance as R[,X] (default 50).",
+                                    "R,X", "50");
+    QCommandLineOption freqOption("freq", "Frequency for lists without a frequency column.",
+                                  "Hz");
+    QCommandLineOption topologyOption("topology",
+        "Comma-separated methods: l, pi, t, stub, qw, all (default all).", "list", "all");
+    QCommandLineOption qOption("q", "Target Q of Pi/T networks (default 2).", "Q", "2");
+    QCommandLineOption formatOption("format", "Output format: csv or json (default csv).",
+                                    "format", "csv");
+    QCommandLineOption threadsOption("threads", "Worker threads (default: all cores).", "n", "0");
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                    "Write to file instead of stdout.", "file");
+    
+    parser.addOptions({z0Option, sourceOption, freqOption, topologyOption, qOption,
+                       formatOption, threadsOption, outputOption});
+    parser.process(app);
+    
+    BatchOptions options;
+    bool ok;
+    
+    options.z0 = parser.value(z0Option).toDouble(&ok);
+    if (!ok || options.z0 <= 0.0) return fail("invalid --z0");
+    
+    if (!parseComplex(parser.value(sourceOption), options.sourceZ)) {
+        return fail("invalid --source, expected R or R,X");
+    }
+    
+    if (parser.isSet(freqOption)) {
+        options.defaultFrequency = parser.value(freqOption).toDouble(&ok);
+        if (!ok || options.defaultFrequency <= 0.0) return fail("invalid --freq");
+    }
+    
+    if (!parseTopologies(parser.value(topologyOption), options.topologies)) {
+        return fail("invalid --topology");
+    }
+    
+    options.targetQ = parser.value(qOption).toDouble(&ok);
+    if (!ok || options.targetQ <= 0.0) return fail("invalid --q");
+    
+    QString format = parser.value(formatOption).toLower();
+    if (format == "csv") options.format = BatchFormat::Csv;
+    else if (format == "json") options.format = BatchFormat::Json;
+    else return fail("invalid --format, expected csv or json");
+    
+    options.threads = parser.value(threadsOption).toInt(&ok);
+    if (!ok || options.threads < 0) return fail("invalid --threads");
+    
+    BatchMatcher matcher(options);
+    const QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty()) {
+        parser.showHelp(2);
+    }
+    for (const QString& input : inputs) {
+        if (!matcher.addInput(input)) {
+            return fail(QString("no such file or directory: %1").arg(input));
+        }
+    }
+    
+    std::FILE* out = stdout;
+    if (parser.isSet(outputOption)) {
+        out = std::fopen(parser.value(outputOption).toLocal8Bit().constData(), "wb");
+        if (!out) return fail(QString("cannot write %1").arg(parser.value(outputOption)));
+    }
+    
+    int failed = matcher.run(out);
+    
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    for (const QString& error : matcher.errors()) {
+        std::fprintf(stderr, "SmithToolCli: %s\n", error.toUtf8().constData());
+    }
+    return (failed > 0) ? 1 : 0;
+}
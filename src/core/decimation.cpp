@@ -0,0 +1,69 @@
+/**
+ * @file decimation.cpp
+ * @brief Screen-space polyline decimation implementation
+ */
+
+#include "decimation.h"
+#include "smithmath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SmithTool {
+
+void PolylineDecimator::minMaxPerColumn(const QPointF* points, std::size_t count,
+                                        std::vector<QPointF>& out,
+                                        double devicePixelRatio)
+{
+    out.clear();
+    if (count == 0) return;
+    
+    std::size_t runStart = 0;
+    std::size_t minIndex = 0;
+    std::size_t maxIndex = 0;
+    double column = std::floor(points[0].x() * devicePixelRatio);
+    
+    // Emit first, min, max, last of [runStart, runEnd] in path order
+    auto flush = [&](std::size_t runEnd) {
+        out.push_back(points[runStart]);
+        std::size_t lo = std::min(minIndex, maxIndex);
+        std::size_t hi = std::max(minIndex, maxIndex);
+        if (lo != runStart && lo != runEnd) out.push_back(points[lo]);
+        if (hi != lo && hi != runStart && hi != runEnd) out.push_back(points[hi]);
+        if (runEnd != runStart) out.push_back(points[runEnd]);
+    };
+    
+    for (std::size_t i = 1; i < count; ++i) {
+        double c = std::floor(points[i].x() * devicePixelRatio);
+        if (c != column) {
+            flush(i - 1);
+            runStart = minIndex = maxIndex = i;
+            column = c;
+            continue;
+        }
+        if (points[i].y() < points[minIndex].y()) minIndex = i;
+        if (points[i].y() > points[maxIndex].y()) maxIndex = i;
+    }
+    flush(count - 1);
+}
+
+void PolylineDecimator::gammaTrace(const Complex* gamma, std::size_t count,
+                                   const QPointF& center, double radius,
+                                   std::vector<QPointF>& scratch,
+                                   std::vector<QPointF>& out,
+                                   double devicePixelRatio)
+{
+    scratch.resize(count);
+    SmithMath::gammaToScreen(gamma, scratch.data(), count, center, radius);
+    
+    // Compact the visible points in place
+    std::size_t visible = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (SmithMath::isInsideUnitCircle(gamma[i])) {
+            scratch[visible++] = scratch[i];
+        }
+    }
+    
+    minMaxPerColumn(scratch.data(), visible, out, devicePixelRatio);
+}
+
+} // namespace SmithTool
@@ -0,0 +1,67 @@
+/**
+ * @file decimation.h
+ * @brief Screen-space level-of-detail reduction for dense polylines
+ *
+ * A trace with far more points than the chart has pixels is reduced to
+ * the few points per pixel column that change what is actually drawn.
+ */
+
+#ifndef SMITHTOOL_DECIMATION_H
+#define SMITHTOOL_DECIMATION_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include <QPointF>
+
+namespace SmithTool {
+
+using Complex = std::complex<double>;
+
+/**
+ * @brief Polyline decimation in screen space
+ */
+class PolylineDecimator {
+public:
+    /**
+     * @brief Keep the extremes of every run of points within one pixel column
+     *
+     * Consecutive points whose x falls into the same device pixel column
+     * are replaced by the first, the lowest, the highest and the last of
+     * them, in path order. Everything dropped lies inside the vertical
+     * span that is still drawn, so the stroked result is identical at
+     * pixel resolution.
+     *
+     * @param points Polyline in screen coordinates
+     * @param count Number of points
+     * @param out Decimated polyline (replaced)
+     * @param devicePixelRatio Device pixels per logical pixel
+     */
+    static void minMaxPerColumn(const QPointF* points, std::size_t count,
+                                std::vector<QPointF>& out,
+                                double devicePixelRatio = 1.0);
+    
+    /**
+     * @brief Map a Gamma trace to a decimated screen polyline
+     *
+     * Points outside the unit circle are skipped (the path joins their
+     * neighbours), matching how traces are drawn on the chart.
+     *
+     * @param gamma Reflection coefficients in path order
+     * @param count Number of points
+     * @param center Chart center (pixels)
+     * @param radius Chart radius (pixels)
+     * @param scratch Reused buffer for the full-resolution points
+     * @param out Decimated polyline (replaced)
+     * @param devicePixelRatio Device pixels per logical pixel
+     */
+    static void gammaTrace(const Complex* gamma, std::size_t count,
+                           const QPointF& center, double radius,
+                           std::vector<QPointF>& scratch,
+                           std::vector<QPointF>& out,
+                           double devicePixelRatio = 1.0);
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_DECIMATION_H
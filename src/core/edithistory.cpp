@@ -0,0 +1,196 @@
+/**
+ * @file edithistory.cpp
+ * @brief Undo/redo history implementation
+ */
+
+#include "edithistory.h"
+#include "trace.h"
+#include <algorithm>
+
+namespace SmithTool {
+
+EditHistory::EditHistory(int limit)
+    : m_cursor(0)
+    , m_limit(std::max(1, limit))
+    , m_editIndex(-1)
+    , m_editStartValue(0.0)
+{
+}
+
+void EditHistory::setLimit(int limit)
+{
+    m_limit = std::max(1, limit);
+    while (m_commands.size() > static_cast<std::size_t>(m_limit)) {
+        m_commands.pop_front();
+        if (m_cursor > 0) --m_cursor;
+    }
+}
+
+void EditHistory::push(EditCommand command)
+{
+    // A new edit discards the redo branch
+    m_commands.erase(m_commands.begin() + m_cursor, m_commands.end());
+    m_commands.push_back(std::move(command));
+    if (m_commands.size() > static_cast<std::size_t>(m_limit)) {
+        m_commands.pop_front();
+    }
+    m_cursor = m_commands.size();
+}
+
+ElementList EditHistory::share(const std::vector<ElementSpec>& elements)
+{
+    if (m_lastSnapshot && *m_lastSnapshot == elements) {
+        return m_lastSnapshot;
+    }
+    return std::make_shared<const std::vector<ElementSpec>>(elements);
+}
+
+void EditHistory::recordAdd(int index, const ElementSpec& element)
+{
+    EditCommand command;
+    command.kind = EditCommand::Kind::Add;
+    command.index = index;
+    command.element = element;
+    push(std::move(command));
+}
+
+void EditHistory::recordRemove(int index, const ElementSpec& element)
+{
+    EditCommand command;
+    command.kind = EditCommand::Kind::Remove;
+    command.index = index;
+    command.element = element;
+    push(std::move(command));
+}
+
+void EditHistory::recordValueChange(int index, double oldValue, double newValue)
+{
+    if (oldValue == newValue) return;
+    
+    EditCommand command;
+    command.kind = EditCommand::Kind::ChangeValue;
+    command.index = index;
+    command.element.value = newValue;
+    command.oldValue = oldValue;
+    push(std::move(command));
+}
+
+void EditHistory::recordReplace(const std::vector<ElementSpec>& before,
+                                const std::vector<ElementSpec>& after)
+{
+    if (before == after) return;
+    
+    EditCommand command;
+    command.kind = EditCommand::Kind::Replace;
+    command.before = share(before);
+    command.after = std::make_shared<const std::vector<ElementSpec>>(after);
+    m_lastSnapshot = command.after;
+    push(std::move(command));
+}
+
+void EditHistory::beginValueEdit(int index, double value)
+{
+    m_editIndex = index;
+    m_editStartValue = value;
+}
+
+void EditHistory::endValueEdit(const MatchingTrace& trace)
+{
+    if (m_editIndex < 0) return;
+    if (m_editIndex < trace.numSegments()) {
+        recordValueChange(m_editIndex, m_editStartValue, trace.segment(m_editIndex).componentValue);
+    }
+    m_editIndex = -1;
+}
+
+bool EditHistory::undo(MatchingTrace& trace)
+{
+    if (!canUndo()) return false;
+    
+    const EditCommand& command = m_commands[--m_cursor];
+    switch (command.kind) {
+        case EditCommand::Kind::Add:
+            trace.removeSegment(command.index);
+            break;
+        case EditCommand::Kind::Remove:
+            trace.insertElement(command.index, command.element.type, command.element.connection,
+                                command.element.value, command.element.color);
+            break;
+        case EditCommand::Kind::ChangeValue:
+            trace.updateSegmentValue(command.index, command.oldValue);
+            break;
+        case EditCommand::Kind::Replace:
+            assign(trace, *command.before);
+            break;
+    }
+    return true;
+}
+
+bool EditHistory::redo(MatchingTrace& trace)
+{
+    if (!canRedo()) return false;
+    
+    const EditCommand& command = m_commands[m_cursor++];
+    switch (command.kind) {
+        case EditCommand::Kind::Add:
+            trace.insertElement(command.index, command.element.type, command.element.connection,
+                                command.element.value, command.element.color);
+            break;
+        case EditCommand::Kind::Remove:
+            trace.removeSegment(command.index);
+            break;
+        case EditCommand::Kind::ChangeValue:
+            trace.updateSegmentValue(command.index, command.element.value);
+            break;
+        case EditCommand::Kind::Replace:
+            assign(trace, *command.after);
+            break;
+    }
+    return true;
+}
+
+void EditHistory::clear()
+{
+    m_commands.clear();
+    m_cursor = 0;
+    m_lastSnapshot.reset();
+    m_editIndex = -1;
+}
+
+std::size_t EditHistory::memoryBytes() const
+{
+    std::size_t bytes = m_commands.size() * sizeof(EditCommand);
+    
+    // Count each shared snapshot once
+    std::vector<const std::vector<ElementSpec>*> seen;
+    for (const EditCommand& command : m_commands) {
+        for (const ElementList& list : {command.before, command.after}) {
+            if (!list || std::find(seen.begin(), seen.end(), list.get()) != seen.end()) continue;
+            seen.push_back(list.get());
+            bytes += sizeof(*list) + list->capacity() * sizeof(ElementSpec);
+        }
+    }
+    return bytes;
+}
+
+std::vector<ElementSpec> EditHistory::elementsOf(const MatchingTrace& trace)
+{
+    std::vector<ElementSpec> elements;
+    elements.reserve(trace.numSegments());
+    for (int i = 0; i < trace.numSegments(); ++i) {
+        const TraceSegment& seg = trace.segment(i);
+        elements.emplace_back(seg.componentType, seg.connectionType, seg.componentValue, seg.color);
+    }
+    return elements;
+}
+
+void EditHistory::assign(MatchingTrace& trace, const std::vector<ElementSpec>& elements)
+{
+    trace.clear();
+    for (std::size_t i = 0; i < elements.size(); ++i) {
+        trace.insertElement(static_cast<int>(i), elements[i].type, elements[i].connection,
+                            elements[i].value, elements[i].color);
+    }
+}
+
+} // namespace SmithTool
@@ -0,0 +1,141 @@
+/**
+ * @file edithistory.h
+ * @brief Undo/redo history of matching network edits
+ *
+ * The history records edit commands, not copies of the trace: a command
+ * holds the element it added or removed, or the (index, old value, new
+ * value) of a value change. Only edits that replace the whole network
+ * keep a snapshot, as an immutable element list (no point lists) shared
+ * between the commands that refer to the same network.
+ */
+
+#ifndef SMITHTOOL_EDITHISTORY_H
+#define SMITHTOOL_EDITHISTORY_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <QColor>
+#include "component.h"
+
+namespace SmithTool {
+
+class MatchingTrace;
+
+/**
+ * @brief Element of a network without its trace geometry
+ */
+struct ElementSpec {
+    ComponentType type;
+    ConnectionType connection;
+    double value;
+    QColor color;       // Trace segment color; invalid = next palette color
+    
+    ElementSpec(ComponentType t = ComponentType::None,
+                ConnectionType c = ConnectionType::Series, double v = 0.0,
+                const QColor& col = QColor())
+        : type(t), connection(c), value(v), color(col) {}
+    
+    bool operator==(const ElementSpec& other) const {
+        return type == other.type && connection == other.connection && value == other.value &&
+               color == other.color;
+    }
+};
+
+using ElementList = std::shared_ptr<const std::vector<ElementSpec>>;
+
+/**
+ * @brief One undoable edit
+ */
+struct EditCommand {
+    enum class Kind {
+        Add,            // element inserted at index
+        Remove,         // element removed from index
+        ChangeValue,    // value of index changed from oldValue to element.value
+        Replace         // whole network changed from before to after
+    };
+    
+    Kind kind;
+    int index;
+    ElementSpec element;
+    double oldValue;
+    ElementList before;
+    ElementList after;
+    
+    EditCommand() : kind(Kind::Add), index(0), oldValue(0.0) {}
+};
+
+/**
+ * @brief Linear undo/redo stack for a MatchingTrace
+ *
+ * Drags are coalesced per gesture: beginValueEdit() notes the value when
+ * the drag starts and endValueEdit() records a single ChangeValue when it
+ * ends, however many frames the drag took. Undo and redo edit the trace
+ * in place, so only the segments from the edited one onwards are
+ * recomputed.
+ */
+class EditHistory {
+public:
+    explicit EditHistory(int limit = 1000);
+    
+    // Oldest commands are dropped beyond this many
+    void setLimit(int limit);
+    int limit() const { return m_limit; }
+    
+    // Record an edit that was already applied to the trace
+    void recordAdd(int index, const ElementSpec& element);
+    void recordRemove(int index, const ElementSpec& element);
+    void recordValueChange(int index, double oldValue, double newValue);
+    void recordReplace(const std::vector<ElementSpec>& before,
+                       const std::vector<ElementSpec>& after);
+    
+    // Drag gestures
+    void beginValueEdit(int index, double value);
+    void endValueEdit(const MatchingTrace& trace);     // Records the segment's value now
+    void cancelValueEdit() { m_editIndex = -1; }
+    bool isValueEditActive() const { return m_editIndex >= 0; }
+    
+    bool canUndo() const { return m_cursor > 0; }
+    bool canRedo() const { return m_cursor < m_commands.size(); }
+    
+    /**
+     * @brief Revert the last command on the trace
+     * @return false if there is nothing to undo
+     */
+    bool undo(MatchingTrace& trace);
+    
+    /**
+     * @brief Re-apply the last undone command
+     * @return false if there is nothing to redo
+     */
+    bool redo(MatchingTrace& trace);
+    
+    void clear();
+    int size() const { return static_cast<int>(m_commands.size()); }
+    
+    // Approximate heap use of the recorded history
+    std::size_t memoryBytes() const;
+    
+    // Elements of a trace, and a trace rebuilt from elements
+    static std::vector<ElementSpec> elementsOf(const MatchingTrace& trace);
+    static void assign(MatchingTrace& trace, const std::vector<ElementSpec>& elements);
+
+private:
+    std::deque<EditCommand> m_commands;
+    std::size_t m_cursor;       // Commands before it are applied
+    int m_limit;
+    
+    // Network of the newest Replace, reused when the next one starts from it
+    ElementList m_lastSnapshot;
+    
+    int m_editIndex;
+    double m_editStartValue;
+    
+    void push(EditCommand command);
+    ElementList share(const std::vector<ElementSpec>& elements);
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_EDITHISTORY_H
@@ -0,0 +1,106 @@
+/**
+ * @file fft.cpp
+ * @brief Radix-2 complex FFT implementation
+ */
+
+#include "fft.h"
+#include "smithmath.h"
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace SmithTool {
+
+namespace {
+
+// Plans stay alive for the whole run; there are only a few sizes in use
+std::mutex g_planMutex;
+std::map<int, std::shared_ptr<const FftPlan>> g_plans;
+
+} // namespace
+
+std::shared_ptr<const FftPlan> FftPlan::forSize(int size)
+{
+    if (size < 1 || (size & (size - 1)) != 0) return nullptr;
+    
+    std::lock_guard<std::mutex> lock(g_planMutex);
+    std::shared_ptr<const FftPlan>& plan = g_plans[size];
+    if (!plan) {
+        plan = std::make_shared<const FftPlan>(size);
+    }
+    return plan;
+}
+
+int FftPlan::nextPowerOfTwo(int n)
+{
+    int size = 1;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+FftPlan::FftPlan(int size)
+    : m_size(size)
+{
+    const int half = size / 2;
+    m_twiddles.resize(half);
+    for (int k = 0; k < half; ++k) {
+        double angle = -SmithMath::TWO_PI * k / size;
+        m_twiddles[k] = Complex(std::cos(angle), std::sin(angle));
+    }
+    
+    int bits = 0;
+    while ((1 << bits) < size) ++bits;
+    for (int i = 0; i < size; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) reversed |= 1 << (bits - 1 - b);
+        }
+        if (i < reversed) {
+            m_swaps.push_back(i);
+            m_swaps.push_back(reversed);
+        }
+    }
+}
+
+void FftPlan::forward(Complex* data) const
+{
+    transform(data, false);
+}
+
+void FftPlan::inverse(Complex* data) const
+{
+    transform(data, true);
+    const double scale = 1.0 / m_size;
+    for (int i = 0; i < m_size; ++i) {
+        data[i] *= scale;
+    }
+}
+
+void FftPlan::transform(Complex* data, bool inverse) const
+{
+    for (std::size_t i = 0; i < m_swaps.size(); i += 2) {
+        std::swap(data[m_swaps[i]], data[m_swaps[i + 1]]);
+    }
+    
+    // Iterative Cooley-Tukey butterflies; the twiddle stride halves per stage
+    for (int length = 2; length <= m_size; length <<= 1) {
+        const int half = length / 2;
+        const int stride = m_size / length;
+        for (int start = 0; start < m_size; start += length) {
+            for (int k = 0; k < half; ++k) {
+                const Complex w = m_twiddles[k * stride];
+                const double wr = w.real();
+                const double wi = inverse ? -w.imag() : w.imag();
+                Complex& a = data[start + k];
+                Complex& b = data[start + k + half];
+                // Written out: operator* on std::complex checks for NaN/inf
+                const Complex t(wr * b.real() - wi * b.imag(), wr * b.imag() + wi * b.real());
+                b = a - t;
+                a += t;
+            }
+        }
+    }
+}
+
+} // namespace SmithTool
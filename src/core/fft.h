@@ -0,0 +1,61 @@
+/**
+ * @file fft.h
+ * @brief Radix-2 complex FFT with cached plans
+ */
+
+#ifndef SMITHTOOL_FFT_H
+#define SMITHTOOL_FFT_H
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+namespace SmithTool {
+
+using Complex = std::complex<double>;
+
+/**
+ * @brief Precomputed twiddles and bit-reversal order for one FFT size
+ * 
+ * Plans are immutable once built, so one plan can transform on any
+ * number of threads at once. forSize() hands out the same plan for
+ * every request of a size.
+ */
+class FftPlan {
+public:
+    /**
+     * @brief Shared plan for a transform length
+     * @param size Power of two, at least 1
+     * @return Null if size is not a power of two
+     */
+    static std::shared_ptr<const FftPlan> forSize(int size);
+    
+    // Smallest power of two that is at least n
+    static int nextPowerOfTwo(int n);
+    
+    int size() const { return m_size; }
+    
+    /**
+     * @brief Transform in place
+     * 
+     * Forward is X[k] = sum x[n] e^(-j2πkn/N); inverse uses e^(+j2πkn/N)
+     * and divides by N.
+     * 
+     * @param data size() values
+     */
+    void forward(Complex* data) const;
+    void inverse(Complex* data) const;
+    
+    explicit FftPlan(int size);
+
+private:
+    void transform(Complex* data, bool inverse) const;
+    
+    int m_size;
+    std::vector<Complex> m_twiddles;    // e^(-j2πk/N), k < N/2
+    std::vector<int> m_swaps;           // Index pairs to exchange for bit reversal
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_FFT_H
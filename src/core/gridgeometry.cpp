@@ -0,0 +1,386 @@
+/**
+ * @file gridgeometry.cpp
+ * @brief Smith chart grid lines as arcs clipped to the unit circle
+ */
+
+#include "gridgeometry.h"
+#include "smithmath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SmithTool {
+
+namespace {
+
+const double PI = SmithMath::PI;
+
+// Tolerance for circles tangent to the unit circle (all r and g circles)
+const double TANGENT_EPS = 1e-12;
+
+// Rotate an arc by 180° about the origin (impedance -> admittance grid)
+GridArc rotateHalfTurn(const GridArc& arc)
+{
+    GridArc rotated = arc;
+    rotated.center = -arc.center;
+    rotated.startAngle = arc.startAngle + PI;
+    return rotated;
+}
+
+template <typename Build>
+std::vector<GridArc> buildArcs(const std::vector<double>& values, bool mirrored, Build build)
+{
+    std::vector<GridArc> arcs;
+    GridArc arc;
+    for (double v : values) {
+        if (build(v, arc)) arcs.push_back(arc);
+        if (mirrored && build(-v, arc)) arcs.push_back(arc);
+    }
+    return arcs;
+}
+
+// Largest 1-2-5 × 10^k step not above d
+double niceStep(double d)
+{
+    const double decade = std::pow(10.0, std::floor(std::log10(d)));
+    const double m = d / decade;
+    return (m >= 5.0 ? 5.0 : m >= 2.0 ? 2.0 : 1.0) * decade;
+}
+
+/*
+ * |dGamma / dr| = |dGamma / dx| = 2 / |z + 1|^2, so lines of one family
+ * are 2 / ((1 + r)^2 + x^2) apart per unit value. The other coordinate's
+ * term is passed in as a power of two, 2^bucket (2^0 standing for
+ * anything up to 1 when it is x^2).
+ */
+double valuesPerGamma(double v, bool reactance, int bucket)
+{
+    const double other = std::ldexp(1.0, bucket);
+    return reactance ? (other + v * v) / 2.0
+                     : ((1.0 + v) * (1.0 + v) + (bucket > 0 ? other : 0.0)) / 2.0;
+}
+
+int bucketFor(double value)
+{
+    return value > 1.0 ? static_cast<int>(std::lround(std::log2(value))) : 0;
+}
+
+struct ValueRange {
+    double rMin = 0.0;
+    double rMax = 0.0;
+    double xMin = 0.0;
+    double xMax = 0.0;
+    double rCenter = 0.0;
+    double xCenter = 0.0;
+};
+
+// Normalized impedance of a point, taken on the rim if outside
+void valueAt(Complex gamma, double& r, double& x)
+{
+    const double mag = std::abs(gamma);
+    if (mag > 1.0) gamma /= mag;
+    
+    const Complex denom = 1.0 - gamma;
+    if (std::abs(denom) < 1e-12) {
+        r = AdaptiveGrid::VALUE_LIMIT;
+        x = 0.0;
+        return;
+    }
+    const Complex z = (1.0 + gamma) / denom;
+    r = std::clamp(z.real(), 0.0, AdaptiveGrid::VALUE_LIMIT);
+    x = std::clamp(z.imag(), -AdaptiveGrid::VALUE_LIMIT, AdaptiveGrid::VALUE_LIMIT);
+}
+
+/*
+ * r and x over the viewport part of the unit disk. Both are harmonic, so
+ * their extremes lie on its boundary, which is sampled; sampled points
+ * outside the disk stand for the rim. sign = -1 gives g and b instead.
+ */
+ValueRange valueRange(const GridViewport& viewport, double sign)
+{
+    const int SAMPLES = 32;
+    const double re0 = std::max(viewport.minRe, -1.0);
+    const double re1 = std::min(viewport.maxRe, 1.0);
+    const double im0 = std::max(viewport.minIm, -1.0);
+    const double im1 = std::min(viewport.maxIm, 1.0);
+    
+    ValueRange range;
+    valueAt(sign * Complex((re0 + re1) / 2, (im0 + im1) / 2), range.rCenter, range.xCenter);
+    range.rMin = range.rMax = range.rCenter;
+    range.xMin = range.xMax = range.xCenter;
+    
+    auto add = [&](double re, double im) {
+        double r, x;
+        valueAt(sign * Complex(re, im), r, x);
+        range.rMin = std::min(range.rMin, r);
+        range.rMax = std::max(range.rMax, r);
+        range.xMin = std::min(range.xMin, x);
+        range.xMax = std::max(range.xMax, x);
+    };
+    for (int i = 0; i <= SAMPLES; ++i) {
+        const double t = static_cast<double>(i) / SAMPLES;
+        const double re = re0 + (re1 - re0) * t;
+        const double im = im0 + (im1 - im0) * t;
+        add(re, im0);
+        add(re, im1);
+        add(re0, im);
+        add(re1, im);
+    }
+    
+    // The open circuit point: every r and x meets there
+    const double pole = sign;
+    if (re0 <= pole && pole <= re1 && im0 <= 0.0 && 0.0 <= im1) {
+        range.rMax = AdaptiveGrid::VALUE_LIMIT;
+        range.xMin = -AdaptiveGrid::VALUE_LIMIT;
+        range.xMax = AdaptiveGrid::VALUE_LIMIT;
+    }
+    return range;
+}
+
+bool isStandardValue(double v, const std::vector<double>& standard)
+{
+    const double a = std::abs(v);
+    for (double s : standard) {
+        if (std::abs(a - s) <= 1e-9 * std::max(1.0, s)) return true;
+    }
+    return false;
+}
+
+/*
+ * Lattice values within [lo, hi] (one more on each side, since the range
+ * is sampled), times sign, minus the standard values and zero.
+ */
+void selectValues(const std::vector<double>& lattice, double lo, double hi, double sign,
+                  const std::vector<double>& standard, std::vector<double>& out)
+{
+    if (hi < lo) return;
+    auto first = std::lower_bound(lattice.begin(), lattice.end(), lo);
+    auto last = std::upper_bound(lattice.begin(), lattice.end(), hi);
+    if (first != lattice.begin()) --first;
+    if (last != lattice.end()) ++last;
+    for (auto it = first; it != last; ++it) {
+        if (*it == 0.0 || isStandardValue(*it, standard)) continue;
+        out.push_back(sign * *it);
+    }
+}
+
+// Keep the MAX_LINES values nearest center, in ascending order
+void capLines(std::vector<double>& values, double center)
+{
+    if (static_cast<int>(values.size()) > AdaptiveGrid::MAX_LINES) {
+        std::nth_element(values.begin(), values.begin() + AdaptiveGrid::MAX_LINES, values.end(),
+                         [center](double a, double b) {
+                             return std::abs(a - center) < std::abs(b - center);
+                         });
+        values.resize(AdaptiveGrid::MAX_LINES);
+    }
+    std::sort(values.begin(), values.end());
+}
+
+} // namespace
+
+bool GridArc::isFullCircle() const
+{
+    return std::abs(spanAngle) >= 2 * PI - 1e-12;
+}
+
+bool GridGeometry::clipToUnitCircle(const Complex& center, double radius, GridArc& arc)
+{
+    if (!(radius > 0)) {
+        return false;
+    }
+    
+    arc.center = center;
+    arc.radius = radius;
+    
+    const double d = std::abs(center);
+    if (d + radius <= 1.0 + TANGENT_EPS) {
+        arc.startAngle = 0.0;
+        arc.spanAngle = 2 * PI;
+        return true;
+    }
+    if (d >= 1.0 + radius || radius >= d + 1.0) {
+        return false;   // Disjoint, or the unit circle lies inside
+    }
+    
+    // Intersections lie on the chord perpendicular to the center direction
+    const Complex u = center / d;
+    const double a = (1.0 + d * d - radius * radius) / (2.0 * d);
+    const double h = std::sqrt(std::max(0.0, 1.0 - a * a));
+    const Complex p1 = u * Complex(a, h);
+    const Complex p2 = u * Complex(a, -h);
+    
+    const double a1 = std::arg(p1 - center);
+    double span = std::arg(p2 - center) - a1;
+    if (span < 0) span += 2 * PI;
+    
+    // Of the two arcs between p1 and p2, keep the one inside
+    arc.startAngle = a1;
+    arc.spanAngle = span;
+    if (std::abs(arc.pointAt(a1 + span / 2)) > 1.0) {
+        arc.spanAngle = span - 2 * PI;
+    }
+    return true;
+}
+
+GridArc GridGeometry::resistanceCircle(double r)
+{
+    // Center r/(1+r), radius 1/(1+r): tangent to the unit circle at Gamma = 1
+    GridArc arc;
+    arc.center = Complex(r / (1.0 + r), 0.0);
+    arc.radius = 1.0 / (1.0 + r);
+    arc.startAngle = 0.0;
+    arc.spanAngle = 2 * PI;
+    return arc;
+}
+
+GridArc GridGeometry::conductanceCircle(double g)
+{
+    return rotateHalfTurn(resistanceCircle(g));
+}
+
+bool GridGeometry::reactanceArc(double x, GridArc& arc)
+{
+    if (x == 0.0) {
+        return false;
+    }
+    // Center 1 + j/x, radius 1/|x|; runs from Gamma = 1 to the rim point of jx
+    return clipToUnitCircle(Complex(1.0, 1.0 / x), 1.0 / std::abs(x), arc);
+}
+
+bool GridGeometry::susceptanceArc(double b, GridArc& arc)
+{
+    GridArc reactance;
+    if (!reactanceArc(b, reactance)) {
+        return false;
+    }
+    arc = rotateHalfTurn(reactance);
+    return true;
+}
+
+bool GridGeometry::qArc(double q, bool upper, GridArc& arc)
+{
+    if (!(q > 0)) {
+        return false;
+    }
+    
+    // Circles through Gamma = ±1; the arc above the real axis belongs to
+    // the circle centered below it, and vice versa
+    const double invQ = 1.0 / q;
+    const Complex center(0.0, upper ? -invQ : invQ);
+    return clipToUnitCircle(center, std::sqrt(1.0 + invQ * invQ), arc);
+}
+
+const std::vector<double>& GridGeometry::resistanceValues()
+{
+    static const std::vector<double> values = {0, 0.2, 0.5, 1.0, 2.0, 5.0};
+    return values;
+}
+
+const std::vector<double>& GridGeometry::reactanceValues()
+{
+    static const std::vector<double> values = {0.2, 0.5, 1.0, 2.0, 5.0};
+    return values;
+}
+
+const std::vector<GridArc>& GridGeometry::resistanceArcs()
+{
+    static const std::vector<GridArc> arcs = buildArcs(resistanceValues(), false,
+        [](double r, GridArc& arc) { arc = resistanceCircle(r); return true; });
+    return arcs;
+}
+
+const std::vector<GridArc>& GridGeometry::reactanceArcs()
+{
+    static const std::vector<GridArc> arcs = buildArcs(reactanceValues(), true, reactanceArc);
+    return arcs;
+}
+
+const std::vector<GridArc>& GridGeometry::conductanceArcs()
+{
+    static const std::vector<GridArc> arcs = buildArcs(resistanceValues(), false,
+        [](double g, GridArc& arc) { arc = conductanceCircle(g); return true; });
+    return arcs;
+}
+
+const std::vector<GridArc>& GridGeometry::susceptanceArcs()
+{
+    static const std::vector<GridArc> arcs = buildArcs(reactanceValues(), true, susceptanceArc);
+    return arcs;
+}
+
+void GridLines::clear()
+{
+    resistances.clear();
+    reactances.clear();
+    conductances.clear();
+    susceptances.clear();
+}
+
+int GridLines::size() const
+{
+    return static_cast<int>(resistances.size() + reactances.size() +
+                            conductances.size() + susceptances.size());
+}
+
+int AdaptiveGrid::levelForZoom(double zoom)
+{
+    if (!(zoom >= 2.0)) {
+        return 0;
+    }
+    return std::min(MAX_LEVEL, static_cast<int>(std::floor(std::log2(zoom))));
+}
+
+const std::vector<double>& AdaptiveGrid::lattice(int level, bool reactance, int bucket)
+{
+    std::vector<double>& values = m_lattices[std::make_tuple(level, reactance, bucket)];
+    if (!values.empty()) {
+        return values;
+    }
+    
+    // Each value is the next multiple of the local step, so the lattice
+    // only depends on its key and not on where it is viewed from
+    const double spacing = BASE_SPACING / std::ldexp(1.0, level);
+    double v = 0.0;
+    values.push_back(v);
+    while (true) {
+        const double step = niceStep(spacing * valuesPerGamma(v, reactance, bucket));
+        v = (std::floor(v / step + 1e-6) + 1.0) * step;
+        if (v > VALUE_LIMIT) break;
+        values.push_back(v);
+    }
+    return values;
+}
+
+void AdaptiveGrid::linesFor(const GridViewport& viewport, int level, GridLines& lines)
+{
+    lines.clear();
+    if (level <= 0) {
+        return;
+    }
+    level = std::min(level, MAX_LEVEL);
+    
+    const std::vector<double>& rStandard = GridGeometry::resistanceValues();
+    const std::vector<double>& xStandard = GridGeometry::reactanceValues();
+    
+    // Impedance lines from the viewport, admittance lines from its mirror
+    const ValueRange z = valueRange(viewport, 1.0);
+    const std::vector<double>* rLattice = &lattice(level, false, bucketFor(z.xCenter * z.xCenter));
+    const std::vector<double>* xLattice = &lattice(level, true,
+        bucketFor((1.0 + z.rCenter) * (1.0 + z.rCenter)));
+    selectValues(*rLattice, z.rMin, z.rMax, 1.0, rStandard, lines.resistances);
+    selectValues(*xLattice, std::max(0.0, -z.xMax), -z.xMin, -1.0, xStandard, lines.reactances);
+    selectValues(*xLattice, std::max(0.0, z.xMin), z.xMax, 1.0, xStandard, lines.reactances);
+    capLines(lines.resistances, z.rCenter);
+    capLines(lines.reactances, z.xCenter);
+    
+    const ValueRange y = valueRange(viewport, -1.0);
+    rLattice = &lattice(level, false, bucketFor(y.xCenter * y.xCenter));
+    xLattice = &lattice(level, true, bucketFor((1.0 + y.rCenter) * (1.0 + y.rCenter)));
+    selectValues(*rLattice, y.rMin, y.rMax, 1.0, rStandard, lines.conductances);
+    selectValues(*xLattice, std::max(0.0, -y.xMax), -y.xMin, -1.0, xStandard, lines.susceptances);
+    selectValues(*xLattice, std::max(0.0, y.xMin), y.xMax, 1.0, xStandard, lines.susceptances);
+    capLines(lines.conductances, y.rCenter);
+    capLines(lines.susceptances, y.xCenter);
+}
+
+} // namespace SmithTool
@@ -0,0 +1,168 @@
+/**
+ * @file gridgeometry.h
+ * @brief Smith chart grid lines as arcs clipped to the unit circle
+ *
+ * Grid circles are clipped analytically in the Gamma plane, so drawing
+ * the grid needs only the chart's center/radius transform and no
+ * QPainterPath boolean operations.
+ */
+
+#ifndef SMITHTOOL_GRIDGEOMETRY_H
+#define SMITHTOOL_GRIDGEOMETRY_H
+
+#include <complex>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace SmithTool {
+
+using Complex = std::complex<double>;
+
+/**
+ * @brief Circular arc in the Gamma plane
+ *
+ * Angles are in radians, counterclockwise from the positive real axis
+ * (with the imaginary axis up, as on the chart).
+ */
+struct GridArc {
+    Complex center;
+    double radius;
+    double startAngle;
+    double spanAngle;       // Signed; ±2π for a full circle
+    
+    GridArc() : center(0, 0), radius(0), startAngle(0), spanAngle(0) {}
+    
+    bool isFullCircle() const;
+    Complex pointAt(double angle) const { return center + std::polar(radius, angle); }
+    Complex startPoint() const { return pointAt(startAngle); }
+    Complex endPoint() const { return pointAt(startAngle + spanAngle); }
+};
+
+/**
+ * @brief Grid line geometry of the impedance and admittance charts
+ */
+class GridGeometry {
+public:
+    /**
+     * @brief Part of a circle inside the unit circle, |Gamma| <= 1
+     *
+     * Circles inside (or tangent from inside to) the unit circle are kept
+     * whole.
+     *
+     * @return false if no arc of the circle lies inside
+     */
+    static bool clipToUnitCircle(const Complex& center, double radius, GridArc& arc);
+    
+    // Constant normalized resistance/conductance circles (always whole)
+    static GridArc resistanceCircle(double r);
+    static GridArc conductanceCircle(double g);
+    
+    /**
+     * @brief Constant normalized reactance/susceptance arc (x, b != 0)
+     * @return false for 0, which is the real axis rather than an arc
+     */
+    static bool reactanceArc(double x, GridArc& arc);
+    static bool susceptanceArc(double b, GridArc& arc);
+    
+    /**
+     * @brief Constant-Q arc of |X|/R = q
+     * @param upper Positive reactance half (else its mirror image below)
+     */
+    static bool qArc(double q, bool upper, GridArc& arc);
+    
+    /**
+     * @brief Standard grid values, normalized to Z0
+     */
+    static const std::vector<double>& resistanceValues();
+    static const std::vector<double>& reactanceValues();
+    
+    /**
+     * @brief Clipped arcs of the standard grid, built once on first use
+     *
+     * Reactance and susceptance tables hold the arc of +x followed by
+     * that of -x for each value.
+     */
+    static const std::vector<GridArc>& resistanceArcs();
+    static const std::vector<GridArc>& reactanceArcs();
+    static const std::vector<GridArc>& conductanceArcs();
+    static const std::vector<GridArc>& susceptanceArcs();
+};
+
+/**
+ * @brief Visible rectangle of the Gamma plane
+ */
+struct GridViewport {
+    double minRe;
+    double maxRe;
+    double minIm;
+    double maxIm;
+    
+    GridViewport() : minRe(-1), maxRe(1), minIm(-1), maxIm(1) {}
+    GridViewport(double re0, double re1, double im0, double im1)
+        : minRe(re0), maxRe(re1), minIm(im0), maxIm(im1) {}
+};
+
+/**
+ * @brief Normalized values of the grid lines to draw
+ */
+struct GridLines {
+    std::vector<double> resistances;
+    std::vector<double> reactances;     // Both signs
+    std::vector<double> conductances;
+    std::vector<double> susceptances;   // Both signs
+    
+    void clear();
+    int size() const;
+};
+
+/**
+ * @brief Zoom-dependent minor grid, refined level by level
+ *
+ * Each zoom level doubles the grid density, like the levels of a map
+ * tile pyramid. The line values of a level form a fixed lattice of
+ * 1-2-5 steps, spaced so that neighbouring lines are about
+ * BASE_SPACING / 2^level apart in the Gamma plane. Line spacing also
+ * depends on the other coordinate (x lines crowd at low r), which is
+ * taken from the viewport center rounded to a power of two; each
+ * (level, bucket) lattice is built once and cached. For a viewport only
+ * the lines whose circles cross it are returned, so the cost follows the
+ * visible line count, not the lattice size.
+ */
+class AdaptiveGrid {
+public:
+    AdaptiveGrid() = default;
+    
+    /**
+     * @brief Level for a zoom factor (0 at 1x: the standard grid only)
+     */
+    static int levelForZoom(double zoom);
+    
+    /**
+     * @brief Minor lines crossing the viewport at a level
+     *
+     * Standard grid values (see GridGeometry) are left out, since they
+     * are drawn as major lines. Each family is capped at MAX_LINES,
+     * keeping the lines nearest the viewport center.
+     */
+    void linesFor(const GridViewport& viewport, int level, GridLines& lines);
+    
+    // Number of lattices built so far
+    int cachedLattices() const { return static_cast<int>(m_lattices.size()); }
+    void clear() { m_lattices.clear(); }
+    
+    static constexpr int MAX_LEVEL = 8;
+    static constexpr int MAX_LINES = 200;
+    static constexpr double BASE_SPACING = 0.1;
+    static constexpr double VALUE_LIMIT = 1e4;
+
+private:
+    // (level, reactance, bucket) -> ascending values >= 0
+    std::map<std::tuple<int, bool, int>, std::vector<double>> m_lattices;
+    
+    const std::vector<double>& lattice(int level, bool reactance, int bucket);
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_GRIDGEOMETRY_H
@@ -4,6 +4,8 @@
  */
 
 #include "matching.h"
+#include "matchingcache.h"
+#include "profiler.h"
 #include "smithmath.h"
 #include <cmath>
 
@@ -154,6 +156,7 @@ MatchingCalculator::MatchingCalculator()
     , m_loadZ(50.0, 0.0)
     , m_frequency(1e9)
     , m_z0(50.0)
+    , m_cache(MatchingResultCache::shared())
 {
 }
 
@@ -202,6 +205,16 @@ double MatchingCalculator::susceptanceToInductance(double b, double freq)
 }
 
 std::vector<MatchingSolution> MatchingCalculator::calculateLSection() const
+{
+    std::vector<MatchingSolution> solutions;
+    if (lookupCache(MatchingTopology::LSection, 0.0, solutions)) return solutions;
+    
+    solutions = computeLSection();
+    storeCache(MatchingTopology::LSection, 0.0, solutions);
+    return solutions;
+}
+
+std::vector<MatchingSolution> MatchingCalculator::computeLSection() const
 {
     std::vector<MatchingSolution> solutions;
     
@@ -320,6 +333,16 @@ MatchingSolution MatchingCalculator::createLSectionSolution(
 }
 
 std::vector<MatchingSolution> MatchingCalculator::calculatePiNetwork(double targetQ) const
+{
+    std::vector<MatchingSolution> solutions;
+    if (lookupCache(MatchingTopology::PiNetwork, targetQ, solutions)) return solutions;
+    
+    solutions = computePiNetwork(targetQ);
+    storeCache(MatchingTopology::PiNetwork, targetQ, solutions);
+    return solutions;
+}
+
+std::vector<MatchingSolution> MatchingCalculator::computePiNetwork(double targetQ) const
 {
     std::vector<MatchingSolution> solutions;
     
@@ -379,6 +402,16 @@ std::vector<MatchingSolution> MatchingCalculator::calculatePiNetwork(double targ
 }
 
 std::vector<MatchingSolution> MatchingCalculator::calculateTNetwork(double targetQ) const
+{
+    std::vector<MatchingSolution> solutions;
+    if (lookupCache(MatchingTopology::TNetwork, targetQ, solutions)) return solutions;
+    
+    solutions = computeTNetwork(targetQ);
+    storeCache(MatchingTopology::TNetwork, targetQ, solutions);
+    return solutions;
+}
+
+std::vector<MatchingSolution> MatchingCalculator::computeTNetwork(double targetQ) const
 {
     std::vector<MatchingSolution> solutions;
     
@@ -435,6 +468,16 @@ std::vector<MatchingSolution> MatchingCalculator::calculateTNetwork(double targe
 }
 
 std::vector<MatchingSolution> MatchingCalculator::calculateSingleStub() const
+{
+    std::vector<MatchingSolution> solutions;
+    if (lookupCache(MatchingTopology::SingleStubOpen, 0.0, solutions)) return solutions;
+    
+    solutions = computeSingleStub();
+    storeCache(MatchingTopology::SingleStubOpen, 0.0, solutions);
+    return solutions;
+}
+
+std::vector<MatchingSolution> MatchingCalculator::computeSingleStub() const
 {
     std::vector<MatchingSolution> solutions;
     
@@ -451,7 +494,7 @@ std::vector<MatchingSolution> MatchingCalculator::calculateSingleStub() const
     // For single stub matching, we need g <= 1
     // If g > 1, we need to use series stub or different approach
     if (g > 0) {
-        double lambda = 3e8 / m_frequency;  // Wavelength
+        double lambda = SmithMath::SPEED_OF_LIGHT / m_frequency;  // Wavelength
         double beta = 2.0 * M_PI / lambda;  // Propagation constant
         
         // Calculate distance to stub (two solutions)
@@ -569,6 +612,16 @@ std::vector<MatchingSolution> MatchingCalculator::calculateSingleStub() const
 }
 
 std::vector<MatchingSolution> MatchingCalculator::calculateQuarterWave() const
+{
+    std::vector<MatchingSolution> solutions;
+    if (lookupCache(MatchingTopology::QuarterWave, 0.0, solutions)) return solutions;
+    
+    solutions = computeQuarterWave();
+    storeCache(MatchingTopology::QuarterWave, 0.0, solutions);
+    return solutions;
+}
+
+std::vector<MatchingSolution> MatchingCalculator::computeQuarterWave() const
 {
     std::vector<MatchingSolution> solutions;
     
@@ -582,7 +635,7 @@ std::vector<MatchingSolution> MatchingCalculator::calculateQuarterWave() const
     if (std::abs(Xl) < 1e-10 && Rl > 0 && Rs > 0) {
         // Characteristic impedance of quarter-wave section
         double Zqw = std::sqrt(Rs * Rl);
-        double lambda = 3e8 / m_frequency;
+        double lambda = SmithMath::SPEED_OF_LIGHT / m_frequency;
         double length = lambda / 4.0;
         
         MatchingSolution sol;
@@ -650,8 +703,31 @@ std::vector<MatchingSolution> MatchingCalculator::calculateQuarterWave() const
     return solutions;
 }
 
+bool MatchingCalculator::lookupCache(MatchingTopology topology, double targetQ,
+                                     std::vector<MatchingSolution>& solutions) const
+{
+    MatchingResultCache::Key key;
+    if (!m_cache || !MatchingResultCache::makeKey(m_sourceZ, m_loadZ, m_frequency, m_z0,
+                                                  topology, targetQ, key)) {
+        return false;
+    }
+    return m_cache->lookup(key, solutions);
+}
+
+void MatchingCalculator::storeCache(MatchingTopology topology, double targetQ,
+                                    const std::vector<MatchingSolution>& solutions) const
+{
+    MatchingResultCache::Key key;
+    if (m_cache && MatchingResultCache::makeKey(m_sourceZ, m_loadZ, m_frequency, m_z0,
+                                                topology, targetQ, key)) {
+        m_cache->insert(key, solutions);
+    }
+}
+
 std::vector<MatchingSolution> MatchingCalculator::calculateAll() const
 {
+    SMITHTOOL_PROFILE_SCOPE("MatchingCalculator::calculateAll");
+    
     std::vector<MatchingSolution> all;
     
     auto lSec = calculateLSection();
@@ -7,6 +7,7 @@
 #define SMITHTOOL_MATCHING_H
 
 #include <complex>
+#include <memory>
 #include <vector>
 #include <QString>
 #include "component.h"
@@ -72,8 +73,14 @@ struct MatchingSolution {
     QString toDescription() const;
 };
 
+class MatchingResultCache;
+
 /**
  * @brief Matching network calculator
+ *
+ * Results of the calculate*() methods are memoized in a MatchingResultCache,
+ * by default the process-wide MatchingResultCache::shared(). Copies of a
+ * calculator share its cache.
  */
 class MatchingCalculator {
 public:
@@ -102,6 +109,10 @@ public:
     // Calculate all possible solutions
     std::vector<MatchingSolution> calculateAll() const;
     
+    // Result cache (nullptr disables caching)
+    void setCache(std::shared_ptr<MatchingResultCache> cache) { m_cache = std::move(cache); }
+    const std::shared_ptr<MatchingResultCache>& cache() const { return m_cache; }
+    
     // Utility functions
     static double reactanceToInductance(double x, double freq);
     static double reactanceToCapacitance(double x, double freq);
@@ -113,6 +124,19 @@ private:
     Complex m_loadZ;
     double m_frequency;
     double m_z0;
+    std::shared_ptr<MatchingResultCache> m_cache;
+    
+    // Uncached implementations of the calculate*() methods
+    std::vector<MatchingSolution> computeLSection() const;
+    std::vector<MatchingSolution> computePiNetwork(double targetQ) const;
+    std::vector<MatchingSolution> computeTNetwork(double targetQ) const;
+    std::vector<MatchingSolution> computeSingleStub() const;
+    std::vector<MatchingSolution> computeQuarterWave() const;
+    
+    bool lookupCache(MatchingTopology topology, double targetQ,
+                     std::vector<MatchingSolution>& solutions) const;
+    void storeCache(MatchingTopology topology, double targetQ,
+                    const std::vector<MatchingSolution>& solutions) const;
     
     // Internal calculation helpers
     MatchingSolution createLSectionSolution(
@@ -0,0 +1,155 @@
+/**
+ * @file matchingcache.cpp
+ * @brief LRU cache of matching network solutions
+ */
+
+#include "matchingcache.h"
+#include <cmath>
+#include <tuple>
+
+namespace SmithTool {
+
+namespace {
+
+// Mantissa bits kept when quantizing key values
+constexpr int KEY_MANTISSA_BITS = 40;
+
+double quantize(double v)
+{
+    if (v == 0.0) return 0.0;  // Also folds -0.0
+    int exponent;
+    double mantissa = std::frexp(v, &exponent);
+    return std::ldexp(std::round(std::ldexp(mantissa, KEY_MANTISSA_BITS)),
+                      exponent - KEY_MANTISSA_BITS);
+}
+
+} // namespace
+
+bool MatchingResultCache::Key::operator<(const Key& other) const
+{
+    return std::tie(sourceR, sourceX, loadR, loadX, frequency, z0, topology, targetQ) <
+           std::tie(other.sourceR, other.sourceX, other.loadR, other.loadX,
+                    other.frequency, other.z0, other.topology, other.targetQ);
+}
+
+MatchingResultCache::MatchingResultCache(int capacity)
+    : m_capacity(capacity > 0 ? capacity : 0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_evictions(0)
+{
+}
+
+bool MatchingResultCache::makeKey(const Complex& zs, const Complex& zl, double frequency,
+                                  double z0, MatchingTopology topology, double targetQ,
+                                  Key& key)
+{
+    const double values[] = {zs.real(), zs.imag(), zl.real(), zl.imag(),
+                             frequency, z0, targetQ};
+    for (double v : values) {
+        if (!std::isfinite(v)) return false;
+    }
+    
+    key.sourceR = quantize(zs.real());
+    key.sourceX = quantize(zs.imag());
+    key.loadR = quantize(zl.real());
+    key.loadX = quantize(zl.imag());
+    key.frequency = quantize(frequency);
+    key.z0 = quantize(z0);
+    key.topology = static_cast<int>(topology);
+    key.targetQ = quantize(targetQ);
+    return true;
+}
+
+bool MatchingResultCache::lookup(const Key& key, std::vector<MatchingSolution>& solutions)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        ++m_misses;
+        return false;
+    }
+    
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    solutions = it->second->second;
+    ++m_hits;
+    return true;
+}
+
+void MatchingResultCache::insert(const Key& key, const std::vector<MatchingSolution>& solutions)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_capacity == 0) return;
+    
+    // Another thread may have computed the same design meanwhile
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        it->second->second = solutions;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return;
+    }
+    
+    m_entries.emplace_front(key, solutions);
+    m_index.emplace(key, m_entries.begin());
+    evict();
+}
+
+void MatchingResultCache::setCapacity(int capacity)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity > 0 ? capacity : 0;
+    evict();
+}
+
+int MatchingResultCache::capacity() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity;
+}
+
+void MatchingResultCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+}
+
+MatchingCacheStats MatchingResultCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    MatchingCacheStats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.size = static_cast<int>(m_index.size());
+    stats.capacity = m_capacity;
+    return stats;
+}
+
+void MatchingResultCache::resetStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hits = 0;
+    m_misses = 0;
+    m_evictions = 0;
+}
+
+std::shared_ptr<MatchingResultCache> MatchingResultCache::shared()
+{
+    static std::shared_ptr<MatchingResultCache> cache = std::make_shared<MatchingResultCache>();
+    return cache;
+}
+
+void MatchingResultCache::evict()
+{
+    // Caller holds m_mutex
+    while (static_cast<int>(m_index.size()) > m_capacity) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+        ++m_evictions;
+    }
+}
+
+} // namespace SmithTool
@@ -0,0 +1,112 @@
+/**
+ * @file matchingcache.h
+ * @brief LRU cache of matching network solutions
+ *
+ * Interactive edits (toggling the topology, reopening the matching
+ * wizard) ask MatchingCalculator for the same designs over and over; this
+ * keeps the most recent results so repeats are a lookup.
+ */
+
+#ifndef SMITHTOOL_MATCHINGCACHE_H
+#define SMITHTOOL_MATCHINGCACHE_H
+
+#include <complex>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "matching.h"
+
+namespace SmithTool {
+
+using Complex = std::complex<double>;
+
+/**
+ * @brief Cache counters since construction or the last resetStats()
+ */
+struct MatchingCacheStats {
+    long long hits;
+    long long misses;
+    long long evictions;
+    int size;
+    int capacity;
+    
+    MatchingCacheStats() : hits(0), misses(0), evictions(0), size(0), capacity(0) {}
+    
+    double hitRate() const {
+        return (hits + misses > 0) ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    }
+};
+
+/**
+ * @brief Thread-safe least-recently-used map from design inputs to solutions
+ *
+ * Keys are (Zs, ZL, f, Z0, topology, target Q). Doubles are quantized to
+ * a 40-bit mantissa before comparing, so values that differ only by
+ * rounding noise (e.g. after a unit conversion) share an entry while any
+ * real edit misses. Inputs that are not finite are never cached.
+ */
+class MatchingResultCache {
+public:
+    explicit MatchingResultCache(int capacity = DEFAULT_CAPACITY);
+    
+    struct Key {
+        double sourceR, sourceX;
+        double loadR, loadX;
+        double frequency;
+        double z0;
+        int topology;
+        double targetQ;
+        
+        bool operator<(const Key& other) const;
+    };
+    
+    /**
+     * @brief Quantized key, or false if an input is NaN or infinite
+     */
+    static bool makeKey(const Complex& zs, const Complex& zl, double frequency, double z0,
+                        MatchingTopology topology, double targetQ, Key& key);
+    
+    /**
+     * @brief Copy out a cached result and mark it most recently used
+     * @return false on a miss
+     */
+    bool lookup(const Key& key, std::vector<MatchingSolution>& solutions);
+    void insert(const Key& key, const std::vector<MatchingSolution>& solutions);
+    
+    /**
+     * @brief Change the capacity, evicting the oldest entries if needed
+     *        (0 disables caching)
+     */
+    void setCapacity(int capacity);
+    int capacity() const;
+    
+    void clear();
+    MatchingCacheStats stats() const;
+    void resetStats();
+    
+    /**
+     * @brief Process-wide cache used by default by every MatchingCalculator
+     */
+    static std::shared_ptr<MatchingResultCache> shared();
+    
+    static constexpr int DEFAULT_CAPACITY = 256;
+
+private:
+    using Entry = std::pair<Key, std::vector<MatchingSolution>>;
+    
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_entries;     // Most recently used first
+    std::map<Key, std::list<Entry>::iterator> m_index;
+    int m_capacity;
+    long long m_hits;
+    long long m_misses;
+    long long m_evictions;
+    
+    void evict();
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_MATCHINGCACHE_H
@@ -0,0 +1,253 @@
+/**
+ * @file montecarlo.cpp
+ * @brief Monte Carlo tolerance and yield analysis implementation
+ */
+
+#include "montecarlo.h"
+#include "smithmath.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace SmithTool {
+
+namespace {
+
+// SplitMix64 finalizer: decorrelates the per-block seeds
+std::uint64_t mixSeed(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// z = 1 / (1 / z + y) with y = g + j b(f), for all frequencies; a short
+// or a resonant admittance is clamped so no inf or NaN reaches the yield
+template <typename Susceptance>
+inline void addShunt(double* zr, double* zi, int n, double g, Susceptance b)
+{
+    for (int f = 0; f < n; ++f) {
+        double d = SmithMath::safeDivisor(zr[f] * zr[f] + zi[f] * zi[f]);
+        double yr = zr[f] / d + g;
+        double yi = -zi[f] / d + b(f);
+        double d2 = SmithMath::safeDivisor(yr * yr + yi * yi);
+        zr[f] = yr / d2;
+        zi[f] = -yi / d2;
+    }
+}
+
+} // namespace
+
+// Per-frequency constants shared by all samples; the design frequency
+// is the extra last entry
+struct MonteCarloAnalysis::Evaluation {
+    std::vector<double> omega;
+    std::vector<double> inverseOmega;
+    std::vector<double> beta;           // rad/m
+    int bandPoints = 0;
+    double gammaLimitSq = 0.0;          // |Gamma|² allowed by the mask
+};
+
+MonteCarloAnalysis::MonteCarloAnalysis()
+    : m_loadZ(50.0, 0.0)
+    , m_z0(50.0)
+{
+}
+
+void MonteCarloAnalysis::setNetwork(const MatchingTrace& trace)
+{
+    FrequencySweep sweep;
+    sweep.setNetwork(trace);
+    m_elements = sweep.elements();
+    m_loadZ = sweep.loadImpedance();
+    m_z0 = sweep.z0();
+}
+
+void MonteCarloAnalysis::setNetwork(const MatchingSolution& solution, double z0)
+{
+    FrequencySweep sweep;
+    sweep.setNetwork(solution, z0);
+    m_elements = sweep.elements();
+    m_loadZ = sweep.loadImpedance();
+    m_z0 = z0;
+}
+
+MonteCarloResult MonteCarloAnalysis::run(const MonteCarloSettings& settings) const
+{
+    MonteCarloResult result;
+    if (settings.samples <= 0 || settings.frequencies.empty()) {
+        return result;
+    }
+    
+    Evaluation evaluation;
+    evaluation.bandPoints = static_cast<int>(settings.frequencies.size());
+    evaluation.gammaLimitSq = std::pow(10.0, -std::abs(settings.returnLossMask) / 10.0);
+    
+    double design = settings.designFrequency;
+    if (design <= 0.0) {
+        design = 0.5 * (settings.frequencies.front() + settings.frequencies.back());
+    }
+    std::vector<double> freqs = settings.frequencies;
+    freqs.push_back(design);
+    for (double f : freqs) {
+        const double omega = 2.0 * SmithMath::PI * f;
+        evaluation.omega.push_back(omega);
+        evaluation.inverseOmega.push_back(omega > 0.0 ? 1.0 / omega : 0.0);
+        evaluation.beta.push_back(omega / SmithMath::SPEED_OF_LIGHT);
+    }
+    
+    result.samples = settings.samples;
+    result.returnLossMask = std::abs(settings.returnLossMask);
+    result.designFrequency = design;
+    result.endGamma.resize(settings.samples);
+    result.worstGamma.resize(settings.samples);
+    result.pass.resize(settings.samples);
+    
+    const int blocks = (settings.samples + BLOCK_SAMPLES - 1) / BLOCK_SAMPLES;
+    const int threads = Parallel::workerCount(settings.threadCount, blocks, 1);
+    
+    // Blocks are handed out dynamically; each writes only its own slice
+    std::atomic<int> nextBlock(0);
+    auto worker = [&]() {
+        for (int block = nextBlock++; block < blocks; block = nextBlock++) {
+            evaluateBlock(settings, evaluation, block, result);
+        }
+    };
+    
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    
+    result.passed = static_cast<int>(std::count(result.pass.begin(), result.pass.end(), 1));
+    return result;
+}
+
+void MonteCarloAnalysis::evaluateBlock(const MonteCarloSettings& settings,
+                                       const Evaluation& evaluation, int block,
+                                       MonteCarloResult& result) const
+{
+    const int begin = block * BLOCK_SAMPLES;
+    const int end = std::min(settings.samples, begin + BLOCK_SAMPLES);
+    const int n = static_cast<int>(evaluation.omega.size());
+    const int band = evaluation.bandPoints;
+    const double* omega = evaluation.omega.data();
+    const double* inverseOmega = evaluation.inverseOmega.data();
+    const double* beta = evaluation.beta.data();
+    
+    std::mt19937_64 rng(mixSeed(settings.seed ^ mixSeed(static_cast<std::uint64_t>(block))));
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    std::normal_distribution<double> normal(0.0, 1.0 / 3.0);
+    
+    auto spread = [&](double nominal, const ToleranceSpec& spec) {
+        if (spec.isZero()) return nominal;
+        const double halfWidth = spec.relative * std::abs(nominal) + spec.absolute;
+        const double draw = (spec.distribution == ToleranceDistribution::Gaussian)
+            ? normal(rng) : uniform(rng);
+        // Keep parts physical even for wide tolerances
+        return std::max(nominal + halfWidth * draw, 1e-3 * nominal);
+    };
+    
+    std::vector<double> zr(n);
+    std::vector<double> zi(n);
+    for (int sample = begin; sample < end; ++sample) {
+        std::fill(zr.begin(), zr.end(), m_loadZ.real());
+        std::fill(zi.begin(), zi.end(), m_loadZ.imag());
+        
+        for (const SweepElement& element : m_elements) {
+            const bool series = (element.connection == ConnectionType::Series);
+            switch (element.type) {
+                case ComponentType::Resistor: {
+                    const double r = spread(element.value, settings.resistor);
+                    if (series) {
+                        for (int f = 0; f < n; ++f) zr[f] += r;
+                    } else if (r > 1e-12) {
+                        addShunt(zr.data(), zi.data(), n, 1.0 / r, [](int) { return 0.0; });
+                    }
+                    break;
+                }
+                case ComponentType::Inductor: {
+                    const double l = spread(element.value, settings.inductor);
+                    if (series) {
+                        for (int f = 0; f < n; ++f) zi[f] += l * omega[f];
+                    } else if (l > 1e-18) {
+                        const double invL = 1.0 / l;
+                        addShunt(zr.data(), zi.data(), n, 0.0,
+                                 [&](int f) { return -inverseOmega[f] * invL; });
+                    }
+                    break;
+                }
+                case ComponentType::Capacitor: {
+                    const double c = spread(element.value, settings.capacitor);
+                    if (!series) {
+                        addShunt(zr.data(), zi.data(), n, 0.0, [&](int f) { return c * omega[f]; });
+                    } else if (c > 1e-18) {
+                        const double invC = 1.0 / c;
+                        for (int f = 0; f < n; ++f) zi[f] -= inverseOmega[f] * invC;
+                    }
+                    break;
+                }
+                case ComponentType::TransmissionLine: {
+                    const double length = spread(element.length, settings.lineLength);
+                    const double zc = element.lineZ0;
+                    for (int f = 0; f < n; ++f) {
+                        // Zin = Zc (Z + j Zc t) / (Zc + j Z t)
+                        const double t = std::tan(beta[f] * length);
+                        const double nr = zr[f];
+                        const double ni = zi[f] + zc * t;
+                        const double dr = zc - zi[f] * t;
+                        const double di = zr[f] * t;
+                        const double d = dr * dr + di * di;
+                        zr[f] = zc * (nr * dr + ni * di) / d;
+                        zi[f] = zc * (ni * dr - nr * di) / d;
+                    }
+                    break;
+                }
+                case ComponentType::OpenStub:
+                case ComponentType::ShortStub: {
+                    const double length = spread(element.length, settings.lineLength);
+                    const double zc = element.lineZ0;
+                    const bool open = (element.type == ComponentType::OpenStub);
+                    auto reactance = [&](int f) {
+                        // Open: -j Zc cot(θ), shorted: j Zc tan(θ)
+                        const double t = SmithMath::safeDivisor(std::tan(beta[f] * length));
+                        return open ? -zc / t : zc * t;
+                    };
+                    if (series) {
+                        for (int f = 0; f < n; ++f) zi[f] += reactance(f);
+                    } else {
+                        addShunt(zr.data(), zi.data(), n, 0.0,
+                                 [&](int f) { return -1.0 / SmithMath::safeDivisor(reactance(f)); });
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        
+        // |Gamma|² over the band, compared without square roots
+        double worstSq = 0.0;
+        for (int f = 0; f < band; ++f) {
+            const double num = (zr[f] - m_z0) * (zr[f] - m_z0) + zi[f] * zi[f];
+            const double den = (zr[f] + m_z0) * (zr[f] + m_z0) + zi[f] * zi[f];
+            worstSq = std::max(worstSq, num / den);
+        }
+        
+        const Complex zDesign(zr[band], zi[band]);
+        result.endGamma[sample] = (zDesign - m_z0) / (zDesign + m_z0);
+        result.worstGamma[sample] = std::sqrt(worstSq);
+        result.pass[sample] = (worstSq <= evaluation.gammaLimitSq) ? 1 : 0;
+    }
+}
+
+} // namespace SmithTool
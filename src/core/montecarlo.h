@@ -0,0 +1,137 @@
+/**
+ * @file montecarlo.h
+ * @brief Monte Carlo tolerance and yield analysis of matching networks
+ *
+ * Element values are perturbed within their tolerances, every sample is
+ * evaluated over a frequency band, and the fraction of samples meeting a
+ * return-loss mask across the whole band is reported as the yield.
+ */
+
+#ifndef SMITHTOOL_MONTECARLO_H
+#define SMITHTOOL_MONTECARLO_H
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+#include "sweep.h"
+
+namespace SmithTool {
+
+using Complex = std::complex<double>;
+
+class MatchingTrace;
+struct MatchingSolution;
+
+/**
+ * @brief Distribution of a value within its tolerance
+ */
+enum class ToleranceDistribution {
+    Uniform,        // Flat over ±tolerance
+    Gaussian        // Normal with the tolerance at 3 sigma
+};
+
+/**
+ * @brief Tolerance of one kind of element
+ *
+ * The half-width of the spread is relative · value + absolute, so ±2 %
+ * is {0.02, 0} and ±0.25 pF is {0, 0.25e-12}.
+ */
+struct ToleranceSpec {
+    double relative;
+    double absolute;                // Base units (H, F, ohms, meters)
+    ToleranceDistribution distribution;
+    
+    ToleranceSpec(double rel = 0.0, double abs = 0.0,
+                  ToleranceDistribution dist = ToleranceDistribution::Uniform)
+        : relative(rel), absolute(abs), distribution(dist) {}
+    
+    bool isZero() const { return relative == 0.0 && absolute == 0.0; }
+};
+
+/**
+ * @brief Monte Carlo run parameters
+ */
+struct MonteCarloSettings {
+    int samples;
+    std::vector<double> frequencies;    // Band the mask applies to (Hz)
+    double designFrequency;             // Where end points are taken (0 = band center)
+    double returnLossMask;              // Required return loss over the band (dB, e.g. 10)
+    
+    ToleranceSpec inductor;
+    ToleranceSpec capacitor;
+    ToleranceSpec resistor;
+    ToleranceSpec lineLength;           // Lines and stubs
+    
+    std::uint64_t seed;
+    int threadCount;                    // 0 = one per hardware thread
+    
+    MonteCarloSettings()
+        : samples(10000)
+        , designFrequency(0.0)
+        , returnLossMask(10.0)
+        , inductor(0.02)
+        , capacitor(0.0, 0.25e-12)
+        , resistor(0.01)
+        , seed(1)
+        , threadCount(0) {}
+};
+
+/**
+ * @brief Outcome of a Monte Carlo run (per-sample arrays by sample index)
+ */
+struct MonteCarloResult {
+    int samples = 0;
+    int passed = 0;
+    double returnLossMask = 0.0;
+    double designFrequency = 0.0;
+    std::vector<Complex> endGamma;          // Input Gamma at the design frequency
+    std::vector<double> worstGamma;         // Largest |Gamma| over the band
+    std::vector<std::uint8_t> pass;         // 1 if the mask holds over the band
+    
+    bool isEmpty() const { return samples == 0; }
+    double yield() const { return samples > 0 ? static_cast<double>(passed) / samples : 0.0; }
+};
+
+/**
+ * @brief Monte Carlo engine
+ *
+ * Samples are evaluated in blocks of BLOCK_SAMPLES; each block draws its
+ * values from its own RNG stream seeded from (seed, block), so results do
+ * not depend on the thread count. Per sample, the impedance is carried
+ * from the load towards the source for all frequencies at once in plain
+ * real/imaginary arrays, which the compiler vectorizes.
+ */
+class MonteCarloAnalysis {
+public:
+    MonteCarloAnalysis();
+    
+    // Network, as for FrequencySweep
+    void setNetwork(const MatchingTrace& trace);
+    void setNetwork(const MatchingSolution& solution, double z0);
+    void setElements(const std::vector<SweepElement>& elements) { m_elements = elements; }
+    const std::vector<SweepElement>& elements() const { return m_elements; }
+    
+    void setLoadImpedance(const Complex& zl) { m_loadZ = zl; }
+    void setZ0(double z0) { m_z0 = z0; }
+    
+    /**
+     * @brief Run the analysis
+     * @return Result (empty if there are no samples or frequencies)
+     */
+    MonteCarloResult run(const MonteCarloSettings& settings) const;
+    
+    static constexpr int BLOCK_SAMPLES = 1024;
+
+private:
+    std::vector<SweepElement> m_elements;
+    Complex m_loadZ;
+    double m_z0;
+    
+    struct Evaluation;
+    void evaluateBlock(const MonteCarloSettings& settings, const Evaluation& evaluation,
+                       int block, MonteCarloResult& result) const;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_MONTECARLO_H
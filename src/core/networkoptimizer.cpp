@@ -0,0 +1,585 @@
+/**
+ * @file networkoptimizer.cpp
+ * @brief Ladder network optimizer implementation
+ */
+
+#include "networkoptimizer.h"
+#include "trace.h"
+#include "smithmath.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace SmithTool {
+
+namespace {
+
+// Convergence: projected gradient (log-scale variables) or stalled progress
+const double GRADIENT_TOLERANCE = 1e-7;
+const double COST_TOLERANCE = 1e-12;
+const double MAX_LOG_STEP = 1.0;    // At most a factor e per iteration
+
+bool isLine(ComponentType type)
+{
+    return type == ComponentType::TransmissionLine ||
+           type == ComponentType::OpenStub ||
+           type == ComponentType::ShortStub;
+}
+
+double& tuned(SweepElement& e)
+{
+    return isLine(e.type) ? e.length : e.value;
+}
+
+double tuned(const SweepElement& e)
+{
+    return isLine(e.type) ? e.length : e.value;
+}
+
+AbcdMatrix zeroMatrix()
+{
+    return AbcdMatrix(Complex(0, 0), Complex(0, 0), Complex(0, 0), Complex(0, 0));
+}
+
+AbcdMatrix seriesDerivative(const Complex& dz)
+{
+    AbcdMatrix m = zeroMatrix();
+    m.b = dz;
+    return m;
+}
+
+AbcdMatrix shuntDerivative(const Complex& dy)
+{
+    AbcdMatrix m = zeroMatrix();
+    m.c = dy;
+    return m;
+}
+
+/**
+ * @brief d(ABCD)/dq for the tuned quantity q of one element
+ *
+ * Mirrors FrequencySweep::elementAbcd.
+ */
+AbcdMatrix elementDerivative(const SweepElement& e, double freq)
+{
+    const double omega = 2.0 * SmithMath::PI * freq;
+    const bool series = (e.connection == ConnectionType::Series);
+    const double beta = omega / SmithMath::SPEED_OF_LIGHT;
+    
+    switch (e.type) {
+        case ComponentType::Resistor:
+            if (series) return seriesDerivative(Complex(1.0, 0.0));
+            return (e.value > 1e-12) ? shuntDerivative(Complex(-1.0 / (e.value * e.value), 0.0))
+                                     : zeroMatrix();
+        
+        case ComponentType::Inductor:
+            if (series) return seriesDerivative(Complex(0.0, omega));
+            return (e.value > 1e-18) ? shuntDerivative(Complex(0.0, 1.0 / (omega * e.value * e.value)))
+                                     : zeroMatrix();
+        
+        case ComponentType::Capacitor:
+            if (series) {
+                return (e.value > 1e-18) ? seriesDerivative(Complex(0.0, 1.0 / (omega * e.value * e.value)))
+                                         : zeroMatrix();
+            }
+            return shuntDerivative(Complex(0.0, omega));
+        
+        case ComponentType::TransmissionLine: {
+            double theta = beta * e.length;
+            double zc = e.lineZ0;
+            double c = std::cos(theta);
+            double s = std::sin(theta);
+            return AbcdMatrix(Complex(-s * beta, 0.0), Complex(0.0, zc * c * beta),
+                              Complex(0.0, c * beta / zc), Complex(-s * beta, 0.0));
+        }
+        
+        case ComponentType::OpenStub: {
+            // Z = -j Zc / tan(θ), Y = j tan(θ) / Zc; d tan = (1 + tan²) dθ
+            double t = SmithMath::safeDivisor(std::tan(beta * e.length));
+            double sec2 = 1.0 + t * t;
+            if (series) return seriesDerivative(Complex(0.0, e.lineZ0 * sec2 / (t * t) * beta));
+            return shuntDerivative(Complex(0.0, sec2 / e.lineZ0 * beta));
+        }
+        
+        case ComponentType::ShortStub: {
+            // Z = j Zc tan(θ), Y = -j / (Zc tan(θ))
+            double t = SmithMath::safeDivisor(std::tan(beta * e.length));
+            double sec2 = 1.0 + t * t;
+            if (series) return seriesDerivative(Complex(0.0, e.lineZ0 * sec2 * beta));
+            return shuntDerivative(Complex(0.0, sec2 / (e.lineZ0 * t * t) * beta));
+        }
+        
+        default:
+            return zeroMatrix();
+    }
+}
+
+void defaultBounds(const SweepElement& e, double centerFreq, double& lo, double& hi)
+{
+    const double omega = 2.0 * SmithMath::PI * centerFreq;
+    const double xMin = 0.5, xMax = 5000.0;
+    switch (e.type) {
+        case ComponentType::Resistor: lo = 0.1; hi = 1e4; break;
+        case ComponentType::Inductor: lo = xMin / omega; hi = xMax / omega; break;
+        case ComponentType::Capacitor: lo = 1.0 / (omega * xMax); hi = 1.0 / (omega * xMin); break;
+        default: {
+            double lambda = SmithMath::SPEED_OF_LIGHT / centerFreq;
+            lo = lambda / 360.0;
+            hi = lambda / 2.0;
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Band, loads and the free variables of one run
+ */
+struct NetworkOptimizer::Problem {
+    std::vector<SweepElement> elements;
+    std::vector<int> freeIndex;         // Element of each variable
+    std::vector<double> lower;          // Log bounds per variable
+    std::vector<double> upper;
+    std::vector<double> frequencies;
+    std::vector<Complex> loads;         // One per frequency
+    Complex sourceZ;
+    OptimizerGoal goal;
+    
+    /**
+     * @brief Goal and d(goal)/dq for every element
+     *
+     * Forward pass: impedance after each element, from the load. Reverse
+     * pass: the adjoint of |Gamma|^2 is carried back through each
+     * bilinear transform, picking up every element's derivative on the way.
+     */
+    double evaluateElements(const std::vector<SweepElement>& e, std::vector<double>* gradQ,
+                            double* worst = nullptr, double* mean = nullptr) const
+    {
+        const int n = static_cast<int>(e.size());
+        const int nf = static_cast<int>(frequencies.size());
+        std::vector<AbcdMatrix> m(n);
+        std::vector<Complex> z(n + 1);
+        if (gradQ) gradQ->assign(n, 0.0);
+        
+        double sum = 0.0;
+        double maxG2 = 0.0;
+        double sumG2 = 0.0;
+        const double p = WORST_CASE_NORM;
+        
+        for (int i = 0; i < nf; ++i) {
+            const double f = frequencies[i];
+            z[0] = loads[i];
+            for (int k = 0; k < n; ++k) {
+                m[k] = FrequencySweep::elementAbcd(e[k], f);
+                z[k + 1] = m[k].inputImpedance(z[k]);
+            }
+            
+            const Complex den = z[n] + sourceZ;
+            const Complex gamma = (z[n] - std::conj(sourceZ)) / den;
+            const double g2 = std::norm(gamma);
+            maxG2 = std::max(maxG2, g2);
+            sumG2 += g2;
+            
+            // Weight of this frequency in d(goal)
+            double weight = 1.0;
+            if (goal == OptimizerGoal::WorstCase) {
+                weight = std::pow(g2, p - 1.0);
+                sum += weight * g2;
+            } else {
+                sum += g2;
+            }
+            if (!gradQ) continue;
+            
+            // d|Gamma|^2 = 2 Re(conj(Gamma) dGamma), dGamma/dZ = 2 Rs / (Z + Zs)^2
+            Complex w = std::conj(gamma) * (2.0 * sourceZ.real()) / (den * den);
+            for (int k = n - 1; k >= 0; --k) {
+                const AbcdMatrix& a = m[k];
+                const AbcdMatrix da = elementDerivative(e[k], f);
+                const Complex zk = z[k];
+                const Complex q = a.c * zk + a.d;
+                const Complex dz = ((da.a * zk + da.b) * q - (a.a * zk + a.b) * (da.c * zk + da.d))
+                                   / (q * q);
+                (*gradQ)[k] += weight * 2.0 * std::real(w * dz);
+                w *= (a.a * a.d - a.b * a.c) / (q * q);
+            }
+        }
+        
+        if (worst) *worst = std::sqrt(maxG2);
+        if (mean) *mean = (nf > 0) ? sumG2 / nf : 0.0;
+        if (nf == 0) return 0.0;
+        
+        if (goal == OptimizerGoal::Average) {
+            if (gradQ) {
+                for (double& g : *gradQ) g /= nf;
+            }
+            return sum / nf;
+        }
+        
+        // (mean g^p)^(1/p); its gradient is S^(1/p - 1) mean(g^(p-1) dg)
+        const double s = sum / nf;
+        if (s <= 0.0) {
+            if (gradQ) std::fill(gradQ->begin(), gradQ->end(), 0.0);
+            return 0.0;
+        }
+        const double cost = std::pow(s, 1.0 / p);
+        if (gradQ) {
+            const double scale = cost / s / nf;
+            for (double& g : *gradQ) g *= scale;
+        }
+        return cost;
+    }
+    
+    // Goal and gradient w.r.t. the log-scale variables
+    double cost(const std::vector<double>& x, std::vector<double>* grad) const
+    {
+        std::vector<SweepElement> e = elements;
+        for (size_t j = 0; j < x.size(); ++j) {
+            tuned(e[freeIndex[j]]) = std::exp(x[j]);
+        }
+        
+        std::vector<double> gradQ;
+        double c = evaluateElements(e, grad ? &gradQ : nullptr);
+        if (grad) {
+            grad->resize(x.size());
+            for (size_t j = 0; j < x.size(); ++j) {
+                (*grad)[j] = gradQ[freeIndex[j]] * tuned(e[freeIndex[j]]);
+            }
+        }
+        return c;
+    }
+};
+
+struct NetworkOptimizer::StartResult {
+    std::vector<double> x;
+    double cost;
+    int iterations;
+    long long evaluations;
+    bool converged;
+};
+
+NetworkOptimizer::NetworkOptimizer()
+    : m_sourceZ(50.0, 0.0)
+    , m_loadZ(50.0, 0.0)
+{
+}
+
+void NetworkOptimizer::setMeasuredLoad(const std::vector<double>& frequencies,
+                                       const std::vector<Complex>& loads)
+{
+    if (frequencies.size() != loads.size()) {
+        m_measuredFreqs.clear();
+        m_measuredLoads.clear();
+        return;
+    }
+    m_measuredFreqs = frequencies;
+    m_measuredLoads = loads;
+}
+
+NetworkOptimizer::StartResult NetworkOptimizer::minimize(const Problem& problem,
+                                                         std::vector<double> x,
+                                                         int maxIterations)
+{
+    const int n = static_cast<int>(x.size());
+    StartResult result;
+    result.iterations = 0;
+    result.evaluations = 0;
+    result.converged = false;
+    
+    auto clampToBounds = [&problem, n](std::vector<double>& v) {
+        for (int j = 0; j < n; ++j) {
+            v[j] = std::clamp(v[j], problem.lower[j], problem.upper[j]);
+        }
+    };
+    clampToBounds(x);
+    
+    std::vector<double> g, gNew, d(n), xNew(n), s(n), y(n);
+    double f = problem.cost(x, &g);
+    ++result.evaluations;
+    
+    // Inverse Hessian approximation, row-major
+    std::vector<double> h(static_cast<size_t>(n) * n, 0.0);
+    auto resetHessian = [&h, n]() {
+        std::fill(h.begin(), h.end(), 0.0);
+        for (int j = 0; j < n; ++j) h[j * n + j] = 1.0;
+    };
+    resetHessian();
+    bool identity = true;
+    std::vector<char> active(n, 0);
+    
+    for (int iter = 0; iter < maxIterations; ++iter) {
+        result.iterations = iter + 1;
+        
+        // Variables held at a bound by the gradient leave the step
+        bool activeChanged = false;
+        double projected = 0.0;
+        for (int j = 0; j < n; ++j) {
+            char isActive = (x[j] <= problem.lower[j] && g[j] > 0.0) ||
+                            (x[j] >= problem.upper[j] && g[j] < 0.0);
+            activeChanged = activeChanged || (isActive != active[j]);
+            active[j] = isActive;
+            if (!isActive) projected = std::max(projected, std::abs(g[j]));
+        }
+        if (projected < GRADIENT_TOLERANCE || f < 1e-14) {
+            result.converged = true;
+            break;
+        }
+        if (activeChanged && !identity) {
+            resetHessian();
+            identity = true;
+        }
+        
+        double slope = 0.0;
+        double maxStep = 0.0;
+        for (int j = 0; j < n; ++j) {
+            d[j] = 0.0;
+            if (active[j]) continue;
+            for (int l = 0; l < n; ++l) {
+                if (!active[l]) d[j] -= h[j * n + l] * g[l];
+            }
+            slope += d[j] * g[j];
+            maxStep = std::max(maxStep, std::abs(d[j]));
+        }
+        if (slope >= 0.0) {
+            // Not a descent direction: fall back to steepest descent
+            resetHessian();
+            identity = true;
+            slope = 0.0;
+            maxStep = 0.0;
+            for (int j = 0; j < n; ++j) {
+                d[j] = active[j] ? 0.0 : -g[j];
+                slope += d[j] * g[j];
+                maxStep = std::max(maxStep, std::abs(d[j]));
+            }
+        }
+        if (maxStep > MAX_LOG_STEP) {
+            for (double& v : d) v *= MAX_LOG_STEP / maxStep;
+        }
+        
+        // Backtracking (Armijo) line search on the projected path
+        double alpha = 1.0;
+        double fNew = f;
+        bool accepted = false;
+        for (int trial = 0; trial < 30; ++trial) {
+            double decrease = 0.0;
+            for (int j = 0; j < n; ++j) {
+                xNew[j] = x[j] + alpha * d[j];
+            }
+            clampToBounds(xNew);
+            for (int j = 0; j < n; ++j) {
+                decrease += g[j] * (xNew[j] - x[j]);
+            }
+            fNew = problem.cost(xNew, &gNew);
+            ++result.evaluations;
+            if (fNew <= f + 1e-4 * decrease) {
+                accepted = true;
+                break;
+            }
+            alpha *= 0.5;
+        }
+        
+        if (!accepted) {
+            if (identity) break;    // Stalled even along the gradient
+            resetHessian();
+            identity = true;
+            continue;
+        }
+        
+        double sy = 0.0, yy = 0.0, ss = 0.0;
+        for (int j = 0; j < n; ++j) {
+            s[j] = xNew[j] - x[j];
+            y[j] = gNew[j] - g[j];
+            sy += s[j] * y[j];
+            yy += y[j] * y[j];
+            ss += s[j] * s[j];
+        }
+        const bool stalled = (f - fNew) <= COST_TOLERANCE * (1.0 + f) && ss < 1e-16;
+        
+        x.swap(xNew);
+        g.swap(gNew);
+        f = fNew;
+        if (stalled) {
+            result.converged = true;
+            break;
+        }
+        
+        // BFGS update of the inverse Hessian (skipped without curvature)
+        if (sy > 1e-12 * std::sqrt(ss * yy)) {
+            if (identity) {
+                const double scale = sy / yy;
+                for (int j = 0; j < n; ++j) h[j * n + j] = scale;
+            }
+            const double rho = 1.0 / sy;
+            std::vector<double> hy(n, 0.0);
+            for (int j = 0; j < n; ++j) {
+                for (int l = 0; l < n; ++l) hy[j] += h[j * n + l] * y[l];
+            }
+            double yhy = 0.0;
+            for (int j = 0; j < n; ++j) yhy += y[j] * hy[j];
+            for (int j = 0; j < n; ++j) {
+                for (int l = 0; l < n; ++l) {
+                    h[j * n + l] += rho * ((1.0 + rho * yhy) * s[j] * s[l]
+                                           - hy[j] * s[l] - s[j] * hy[l]);
+                }
+            }
+            identity = false;
+        }
+    }
+    
+    result.x = std::move(x);
+    result.cost = f;
+    return result;
+}
+
+double NetworkOptimizer::evaluate(std::vector<double>* gradient) const
+{
+    Problem problem;
+    problem.sourceZ = m_sourceZ;
+    problem.goal = m_settings.goal;
+    if (!m_measuredFreqs.empty()) {
+        problem.frequencies = m_measuredFreqs;
+        problem.loads = m_measuredLoads;
+    } else {
+        problem.frequencies = FrequencySweep::linearFrequencies(
+            m_settings.startFrequency, m_settings.stopFrequency, m_settings.points);
+        problem.loads.assign(problem.frequencies.size(), m_loadZ);
+    }
+    for (const OptimizerElement& e : m_elements) {
+        problem.elements.push_back(e.element);
+    }
+    return problem.evaluateElements(problem.elements, gradient);
+}
+
+OptimizerResult NetworkOptimizer::run() const
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    OptimizerResult result;
+    if (m_elements.empty()) return result;
+    
+    Problem problem;
+    problem.sourceZ = m_sourceZ;
+    problem.goal = m_settings.goal;
+    if (!m_measuredFreqs.empty()) {
+        problem.frequencies = m_measuredFreqs;
+        problem.loads = m_measuredLoads;
+    } else {
+        if (m_settings.startFrequency <= 0.0 || m_settings.stopFrequency < m_settings.startFrequency) {
+            return result;
+        }
+        problem.frequencies = FrequencySweep::linearFrequencies(
+            m_settings.startFrequency, m_settings.stopFrequency, std::max(1, m_settings.points));
+        problem.loads.assign(problem.frequencies.size(), m_loadZ);
+    }
+    const double centerFreq = 0.5 * (problem.frequencies.front() + problem.frequencies.back());
+    
+    std::vector<double> x0;
+    for (size_t k = 0; k < m_elements.size(); ++k) {
+        const OptimizerElement& e = m_elements[k];
+        problem.elements.push_back(e.element);
+        if (e.fixed || e.element.type == ComponentType::None) continue;
+        
+        double lo = e.minValue, hi = e.maxValue;
+        if (lo <= 0.0 || hi <= lo) defaultBounds(e.element, centerFreq, lo, hi);
+        double v = tuned(e.element);
+        problem.freeIndex.push_back(static_cast<int>(k));
+        problem.lower.push_back(std::log(lo));
+        problem.upper.push_back(std::log(hi));
+        x0.push_back(std::log(v > 0.0 ? v : std::sqrt(lo * hi)));
+    }
+    
+    // Starts: the given values, then log-uniform random points
+    const int starts = problem.freeIndex.empty() ? 1 : std::max(1, m_settings.starts);
+    std::vector<StartResult> outcomes(starts);
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int s = next++; s < starts; s = next++) {
+            std::vector<double> x = x0;
+            if (s > 0) {
+                std::mt19937 rng(m_settings.seed + 7919u * static_cast<unsigned>(s));
+                for (size_t j = 0; j < x.size(); ++j) {
+                    x[j] = std::uniform_real_distribution<double>(problem.lower[j], problem.upper[j])(rng);
+                }
+            }
+            outcomes[s] = minimize(problem, x, m_settings.maxIterations);
+        }
+    };
+    
+    const int threads = Parallel::workerCount(m_settings.threads, starts, 1);
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    
+    // Lowest cost wins; ties go to the earlier start (deterministic)
+    int best = 0;
+    for (int s = 0; s < starts; ++s) {
+        result.evaluations += outcomes[s].evaluations;
+        if (outcomes[s].converged) ++result.startsConverged;
+        if (outcomes[s].cost < outcomes[best].cost) best = s;
+    }
+    result.startsRun = starts;
+    
+    const StartResult& winner = outcomes[best];
+    result.elements = m_elements;
+    for (size_t j = 0; j < winner.x.size(); ++j) {
+        double v = std::exp(winner.x[j]);
+        tuned(result.elements[problem.freeIndex[j]].element) = v;
+        tuned(problem.elements[problem.freeIndex[j]]) = v;
+    }
+    result.cost = problem.evaluateElements(problem.elements, nullptr,
+                                           &result.worstGamma, &result.meanGamma2);
+    result.worstReturnLoss = SmithMath::gammaToReturnLoss(Complex(result.worstGamma, 0.0));
+    result.iterations = winner.iterations;
+    result.converged = winner.converged;
+    result.elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - startTime).count();
+    result.valid = true;
+    return result;
+}
+
+std::vector<OptimizerElement> NetworkOptimizer::topologyFromTrace(const MatchingTrace& trace)
+{
+    FrequencySweep sweep;
+    sweep.setNetwork(trace);
+    
+    std::vector<OptimizerElement> elements;
+    for (const SweepElement& e : sweep.elements()) {
+        elements.emplace_back(e);
+    }
+    return elements;
+}
+
+bool NetworkOptimizer::applyToTrace(const std::vector<OptimizerElement>& elements,
+                                    MatchingTrace& trace)
+{
+    // Same skipping of empty segments as FrequencySweep::setNetwork
+    std::vector<int> segmentIndex;
+    for (int i = 0; i < trace.numSegments(); ++i) {
+        if (trace.segment(i).componentType != ComponentType::None) {
+            segmentIndex.push_back(i);
+        }
+    }
+    if (segmentIndex.size() != elements.size()) return false;
+    
+    for (size_t k = 0; k < elements.size(); ++k) {
+        const TraceSegment& seg = trace.segment(segmentIndex[k]);
+        if (seg.componentType != elements[k].element.type ||
+            seg.connectionType != elements[k].element.connection) {
+            return false;
+        }
+    }
+    
+    for (size_t k = 0; k < elements.size(); ++k) {
+        trace.updateSegmentValue(segmentIndex[k], tuned(elements[k].element));
+    }
+    return true;
+}
+
+} // namespace SmithTool
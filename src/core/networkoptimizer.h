@@ -0,0 +1,168 @@
+/**
+ * @file networkoptimizer.h
+ * @brief Gradient-based optimization of arbitrary ladder networks
+ *
+ * Tunes the element values of a series/shunt ladder (R, L, C, lines and
+ * stubs, as in MatchingTrace) for a band goal. Derivatives of the ABCD
+ * cascade are analytic; the search is a bounded quasi-Newton (BFGS)
+ * method run from several starting points in parallel.
+ */
+
+#ifndef SMITHTOOL_NETWORKOPTIMIZER_H
+#define SMITHTOOL_NETWORKOPTIMIZER_H
+
+#include <complex>
+#include <vector>
+#include "sweep.h"
+
+namespace SmithTool {
+
+using Complex = std::complex<double>;
+
+class MatchingTrace;
+
+/**
+ * @brief One element of the ladder to optimize
+ *
+ * The tuned quantity is element.value for R/L/C and element.length for
+ * lines and stubs (lineZ0 stays fixed). Bounds of 0 are chosen from the
+ * band center: 0.5 Ω - 5 kΩ reactance, 0.1 Ω - 10 kΩ resistance and
+ * λ/360 - λ/2 line length.
+ */
+struct OptimizerElement {
+    SweepElement element;
+    double minValue;
+    double maxValue;
+    bool fixed;
+    
+    OptimizerElement() : minValue(0.0), maxValue(0.0), fixed(false) {}
+    explicit OptimizerElement(const SweepElement& e)
+        : element(e), minValue(0.0), maxValue(0.0), fixed(false) {}
+};
+
+/**
+ * @brief What to minimize over the band
+ */
+enum class OptimizerGoal {
+    WorstCase,      // max |Gamma| (smoothed as a p-norm of |Gamma|^2)
+    Average         // mean |Gamma|^2
+};
+
+/**
+ * @brief Optimizer settings
+ */
+struct OptimizerSettings {
+    OptimizerGoal goal;
+    double startFrequency;      // Hz
+    double stopFrequency;       // Hz
+    int points;                 // Frequencies in the band
+    int starts;                 // Start 0 is the given values, the rest random
+    int maxIterations;          // Per start
+    int threads;                // 0 = one per hardware thread
+    unsigned seed;
+    
+    OptimizerSettings()
+        : goal(OptimizerGoal::WorstCase)
+        , startFrequency(2.4e9)
+        , stopFrequency(2.5e9)
+        , points(21)
+        , starts(16)
+        , maxIterations(200)
+        , threads(0)
+        , seed(1) {}
+};
+
+/**
+ * @brief Best network found and how the search went
+ */
+struct OptimizerResult {
+    std::vector<OptimizerElement> elements;     // Optimized values
+    double cost;                // Goal value
+    double worstGamma;          // max |Gamma| over the band
+    double worstReturnLoss;     // dB, negative (as gammaToReturnLoss)
+    double meanGamma2;          // mean |Gamma|^2 over the band
+    int iterations;             // Of the winning start
+    bool converged;             // Winning start met the tolerance
+    int startsRun;
+    int startsConverged;
+    long long evaluations;      // Cost/gradient evaluations, all starts
+    double elapsedMs;
+    bool valid;
+    
+    OptimizerResult()
+        : cost(0.0), worstGamma(1.0), worstReturnLoss(0.0), meanGamma2(1.0)
+        , iterations(0), converged(false), startsRun(0), startsConverged(0)
+        , evaluations(0), elapsedMs(0.0), valid(false) {}
+};
+
+/**
+ * @brief Multi-start quasi-Newton ladder optimizer
+ *
+ * Elements are ordered from the load towards the source, as in
+ * MatchingTrace and FrequencySweep. Values are optimized on a log scale,
+ * which keeps them positive and makes pF and nH steps comparable.
+ * Reflection is taken against the source, (Zin - Zs*) / (Zin + Zs).
+ */
+class NetworkOptimizer {
+public:
+    NetworkOptimizer();
+    
+    void setTopology(const std::vector<OptimizerElement>& elements) { m_elements = elements; }
+    const std::vector<OptimizerElement>& topology() const { return m_elements; }
+    
+    void setSourceImpedance(const Complex& zs) { m_sourceZ = zs; }
+    void setLoadImpedance(const Complex& zl) { m_loadZ = zl; }
+    
+    /**
+     * @brief Use a frequency-dependent (measured) load instead
+     *
+     * The given frequencies replace the settings' band. Pass empty
+     * vectors to go back to the fixed load.
+     */
+    void setMeasuredLoad(const std::vector<double>& frequencies,
+                         const std::vector<Complex>& loads);
+    
+    void setSettings(const OptimizerSettings& settings) { m_settings = settings; }
+    const OptimizerSettings& settings() const { return m_settings; }
+    
+    OptimizerResult run() const;
+    
+    /**
+     * @brief Goal value and its gradient at the current topology values
+     * @param gradient Derivative w.r.t. each element's tuned quantity
+     *                 (fixed elements included), or nullptr
+     */
+    double evaluate(std::vector<double>* gradient = nullptr) const;
+    
+    /**
+     * @brief Topology and current values of a trace
+     */
+    static std::vector<OptimizerElement> topologyFromTrace(const MatchingTrace& trace);
+    
+    /**
+     * @brief Write optimized values back into the trace segments
+     * @return false if the trace does not have the same elements
+     */
+    static bool applyToTrace(const std::vector<OptimizerElement>& elements,
+                             MatchingTrace& trace);
+
+private:
+    std::vector<OptimizerElement> m_elements;
+    Complex m_sourceZ;
+    Complex m_loadZ;
+    std::vector<double> m_measuredFreqs;
+    std::vector<Complex> m_measuredLoads;
+    OptimizerSettings m_settings;
+    
+    // Exponent of the worst-case p-norm (on |Gamma|^2)
+    static constexpr double WORST_CASE_NORM = 16.0;
+    
+    struct Problem;
+    struct StartResult;
+    static StartResult minimize(const Problem& problem, std::vector<double> x,
+                                int maxIterations);
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_NETWORKOPTIMIZER_H
@@ -0,0 +1,65 @@
+/**
+ * @file parallel.h
+ * @brief Range splitting across worker threads for batch computations
+ */
+
+#ifndef SMITHTOOL_PARALLEL_H
+#define SMITHTOOL_PARALLEL_H
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace SmithTool {
+namespace Parallel {
+
+/**
+ * @brief Threads worth starting for a batch
+ * @param requested Thread count setting (0 or less = one per hardware thread)
+ * @param work Work items in the batch
+ * @param minPerThread Items below which another thread is not worth starting
+ */
+inline int workerCount(int requested, long long work, long long minPerThread)
+{
+    long long threads = requested;
+    if (threads <= 0) {
+        threads = static_cast<long long>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    return static_cast<int>(std::max(1LL, std::min(threads, work / minPerThread)));
+}
+
+/**
+ * @brief Run fn(begin, end) over [0, count) split into one range per thread
+ *
+ * The calling thread runs the first range. Each worker gets its own
+ * contiguous slice, so fn must not write outside it.
+ */
+template <typename Fn>
+void parallelRanges(int count, int threads, Fn fn)
+{
+    threads = std::max(1, std::min(threads, count));
+    if (threads == 1) {
+        fn(0, count);
+        return;
+    }
+    
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    const int chunk = (count + threads - 1) / threads;
+    for (int t = 1; t < threads; ++t) {
+        int begin = t * chunk;
+        int end = std::min(count, begin + chunk);
+        if (begin >= end) break;
+        workers.emplace_back([&fn, begin, end]() { fn(begin, end); });
+    }
+    fn(0, std::min(count, chunk));
+    
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace Parallel
+} // namespace SmithTool
+
+#endif // SMITHTOOL_PARALLEL_H
@@ -0,0 +1,153 @@
+/**
+ * @file pointgrid.cpp
+ * @brief Uniform-grid spatial index implementation
+ */
+
+#include "pointgrid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SmithTool {
+
+PointGrid::PointGrid()
+    : m_origin(0, 0)
+    , m_cellSize(16.0)
+    , m_cols(0)
+    , m_rows(0)
+{
+}
+
+void PointGrid::clear()
+{
+    m_points.clear();
+    m_cellStart.clear();
+    m_cellItems.clear();
+    m_cols = 0;
+    m_rows = 0;
+}
+
+void PointGrid::build(const QPointF* points, std::size_t count, double cellSize)
+{
+    clear();
+    if (count == 0) return;
+    
+    m_points.assign(points, points + count);
+    
+    double minX = points[0].x(), maxX = minX;
+    double minY = points[0].y(), maxY = minY;
+    for (std::size_t i = 1; i < count; ++i) {
+        minX = std::min(minX, points[i].x());
+        maxX = std::max(maxX, points[i].x());
+        minY = std::min(minY, points[i].y());
+        maxY = std::max(maxY, points[i].y());
+    }
+    
+    // Coarsen the cells when the points cover a huge (zoomed-in) area
+    m_cellSize = std::max(cellSize, 1.0);
+    double width = maxX - minX;
+    double height = maxY - minY;
+    if (!std::isfinite(width) || !std::isfinite(height)) {
+        clear();
+        return;
+    }
+    while ((width / m_cellSize + 1.0) * (height / m_cellSize + 1.0) > MAX_CELLS) {
+        m_cellSize *= 2.0;
+    }
+    
+    m_origin = QPointF(minX, minY);
+    m_cols = static_cast<int>(width / m_cellSize) + 1;
+    m_rows = static_cast<int>(height / m_cellSize) + 1;
+    
+    // Counting sort by cell
+    std::vector<int> cellOf(count);
+    m_cellStart.assign(static_cast<std::size_t>(m_cols) * m_rows + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        int cell = cellRow(points[i].y()) * m_cols + cellColumn(points[i].x());
+        cellOf[i] = cell;
+        ++m_cellStart[cell + 1];
+    }
+    for (std::size_t c = 1; c < m_cellStart.size(); ++c) {
+        m_cellStart[c] += m_cellStart[c - 1];
+    }
+    
+    m_cellItems.resize(count);
+    std::vector<int> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        m_cellItems[fill[cellOf[i]]++] = static_cast<int>(i);
+    }
+}
+
+int PointGrid::cellColumn(double x) const
+{
+    int c = static_cast<int>(std::floor((x - m_origin.x()) / m_cellSize));
+    return std::clamp(c, 0, m_cols - 1);
+}
+
+int PointGrid::cellRow(double y) const
+{
+    int r = static_cast<int>(std::floor((y - m_origin.y()) / m_cellSize));
+    return std::clamp(r, 0, m_rows - 1);
+}
+
+template<class Visitor>
+void PointGrid::visitCandidates(const QPointF& pos, double maxDistance, Visitor visit) const
+{
+    if (m_points.empty()) return;
+    
+    // Reject queries entirely outside the grid bounds
+    const double right = m_origin.x() + m_cols * m_cellSize;
+    const double bottom = m_origin.y() + m_rows * m_cellSize;
+    if (pos.x() + maxDistance < m_origin.x() || pos.x() - maxDistance > right ||
+        pos.y() + maxDistance < m_origin.y() || pos.y() - maxDistance > bottom) {
+        return;
+    }
+    
+    const int c0 = cellColumn(pos.x() - maxDistance);
+    const int c1 = cellColumn(pos.x() + maxDistance);
+    const int r0 = cellRow(pos.y() - maxDistance);
+    const int r1 = cellRow(pos.y() + maxDistance);
+    
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const int cell = r * m_cols + c;
+            for (int k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k) {
+                visit(m_cellItems[k]);
+            }
+        }
+    }
+}
+
+int PointGrid::nearest(const QPointF& pos, double maxDistance) const
+{
+    int best = -1;
+    double bestDist2 = maxDistance * maxDistance;
+    
+    visitCandidates(pos, maxDistance, [&](int index) {
+        double dx = m_points[index].x() - pos.x();
+        double dy = m_points[index].y() - pos.y();
+        double d2 = dx * dx + dy * dy;
+        if (d2 < bestDist2 || (d2 == bestDist2 && best < 0)) {
+            bestDist2 = d2;
+            best = index;
+        }
+    });
+    return best;
+}
+
+int PointGrid::firstWithin(const QPointF& pos, double maxDistance) const
+{
+    int first = std::numeric_limits<int>::max();
+    const double maxDist2 = maxDistance * maxDistance;
+    
+    visitCandidates(pos, maxDistance, [&](int index) {
+        double dx = m_points[index].x() - pos.x();
+        double dy = m_points[index].y() - pos.y();
+        if (index < first && dx * dx + dy * dy <= maxDist2) {
+            first = index;
+        }
+    });
+    return (first == std::numeric_limits<int>::max()) ? -1 : first;
+}
+
+} // namespace SmithTool
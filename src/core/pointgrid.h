@@ -0,0 +1,78 @@
+/**
+ * @file pointgrid.h
+ * @brief Uniform-grid spatial index for screen-space point queries
+ *
+ * Used for mouse hit testing: drag-handle lookup and the nearest point of
+ * a dense trace under the cursor.
+ */
+
+#ifndef SMITHTOOL_POINTGRID_H
+#define SMITHTOOL_POINTGRID_H
+
+#include <cstddef>
+#include <vector>
+#include <QPointF>
+
+namespace SmithTool {
+
+/**
+ * @brief Bucketed point set answering "nearest point within r" queries
+ *
+ * Points are sorted into square cells (counting sort, O(n) build). A
+ * query only visits the cells overlapping the search circle, so its cost
+ * depends on the local point density, not on the total count.
+ */
+class PointGrid {
+public:
+    PointGrid();
+    
+    /**
+     * @brief Build the index
+     * @param points Points in screen coordinates (copied)
+     * @param count Number of points
+     * @param cellSize Preferred cell edge in pixels; grown if the points
+     *                 spread so far that the grid would get too large
+     */
+    void build(const QPointF* points, std::size_t count, double cellSize = 16.0);
+    void clear();
+    
+    bool isEmpty() const { return m_points.empty(); }
+    int size() const { return static_cast<int>(m_points.size()); }
+    
+    /**
+     * @brief Find the closest point no farther than maxDistance
+     * @return Index into the points passed to build(), or -1
+     */
+    int nearest(const QPointF& pos, double maxDistance) const;
+    
+    /**
+     * @brief Find the first point (lowest index) within maxDistance
+     *
+     * Matches a linear "first hit" scan, which is what handle hit
+     * testing expects when handles overlap.
+     *
+     * @return Index into the points passed to build(), or -1
+     */
+    int firstWithin(const QPointF& pos, double maxDistance) const;
+
+private:
+    std::vector<QPointF> m_points;
+    std::vector<int> m_cellStart;   // CSR offsets, m_cols * m_rows + 1 entries
+    std::vector<int> m_cellItems;   // Point indices grouped by cell
+    QPointF m_origin;
+    double m_cellSize;
+    int m_cols;
+    int m_rows;
+    
+    static constexpr int MAX_CELLS = 1 << 20;
+    
+    int cellColumn(double x) const;
+    int cellRow(double y) const;
+    
+    template<class Visitor>
+    void visitCandidates(const QPointF& pos, double maxDistance, Visitor visit) const;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_POINTGRID_H
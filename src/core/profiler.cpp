@@ -0,0 +1,169 @@
+/**
+ * @file profiler.cpp
+ * @brief Scoped hot-path timers and Chrome trace export
+ */
+
+#include "profiler.h"
+#include <QFile>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+namespace SmithTool {
+
+std::atomic<bool> Profiler::s_enabled(false);
+
+namespace {
+
+struct Event {
+    const char* name;
+    long long startNs;
+    long long durationNs;
+    int thread;
+};
+
+struct State {
+    std::mutex mutex;
+    std::vector<Event> events;      // Ring buffer once MAX_EVENTS is reached
+    std::size_t next = 0;           // Oldest event when the ring is full
+    std::vector<Profiler::Stat> stats;
+};
+
+State& state()
+{
+    static State s_state;
+    return s_state;
+}
+
+// Small, stable thread numbers for the trace viewer
+int currentThread()
+{
+    static std::atomic<int> s_nextThread(1);
+    thread_local int t_thread = s_nextThread.fetch_add(1);
+    return t_thread;
+}
+
+Profiler::Stat& statFor(std::vector<Profiler::Stat>& stats, const char* name)
+{
+    // Few distinct names; pointers usually match, strcmp covers duplicates
+    for (Profiler::Stat& stat : stats) {
+        if (stat.name == name || std::strcmp(stat.name, name) == 0) return stat;
+    }
+    stats.push_back({name, 0, 0.0, 0.0, 0.0});
+    return stats.back();
+}
+
+void appendEscaped(QByteArray& out, const char* text)
+{
+    for (const char* p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') out += '\\';
+        out += *p;
+    }
+}
+
+} // namespace
+
+void Profiler::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+long long Profiler::nowNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char* name, long long startNs, long long durationNs)
+{
+    const int thread = currentThread();
+    const double ms = durationNs / 1e6;
+    
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    
+    Event event = {name, startNs, durationNs, thread};
+    if (s.events.size() < static_cast<std::size_t>(MAX_EVENTS)) {
+        s.events.push_back(event);
+    } else {
+        s.events[s.next] = event;
+        s.next = (s.next + 1) % s.events.size();
+    }
+    
+    Stat& stat = statFor(s.stats, name);
+    ++stat.count;
+    stat.totalMs += ms;
+    stat.maxMs = std::max(stat.maxMs, ms);
+    stat.lastMs = ms;
+}
+
+std::vector<Profiler::Stat> Profiler::stats()
+{
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.stats;
+}
+
+void Profiler::reset()
+{
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.events.clear();
+    s.next = 0;
+    s.stats.clear();
+}
+
+int Profiler::eventCount()
+{
+    State& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return static_cast<int>(s.events.size());
+}
+
+bool Profiler::writeChromeTrace(const QString& path)
+{
+    // Copy out so recording threads are not blocked by the file write
+    std::vector<Event> events;
+    {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        events.reserve(s.events.size());
+        events.insert(events.end(), s.events.begin() + s.next, s.events.end());
+        events.insert(events.end(), s.events.begin(), s.events.begin() + s.next);
+    }
+    
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    
+    // Timestamps in µs relative to the first event
+    const long long origin = events.empty() ? 0 : events.front().startNs;
+    QByteArray out;
+    out.reserve(1 << 16);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        out += (i == 0) ? "\n" : ",\n";
+        out += "{\"name\":\"";
+        appendEscaped(out, e.name);
+        out += "\",\"cat\":\"smithtool\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+        out += QByteArray::number(e.thread);
+        out += ",\"ts\":";
+        out += QByteArray::number((e.startNs - origin) / 1e3, 'f', 3);
+        out += ",\"dur\":";
+        out += QByteArray::number(e.durationNs / 1e3, 'f', 3);
+        out += "}";
+        
+        if (out.size() > (1 << 16)) {
+            if (file.write(out) != out.size()) return false;
+            out.clear();
+        }
+    }
+    out += "\n]}\n";
+    return file.write(out) == out.size();
+}
+
+} // namespace SmithTool
@@ -0,0 +1,115 @@
+/**
+ * @file profiler.h
+ * @brief Scoped hot-path timers and Chrome trace export
+ *
+ * Disabled by default; a disabled scope costs one relaxed atomic load.
+ * When enabled, every scope adds one event to a bounded in-memory log
+ * and updates per-name counters.
+ */
+
+#ifndef SMITHTOOL_PROFILER_H
+#define SMITHTOOL_PROFILER_H
+
+#include <atomic>
+#include <vector>
+#include <QString>
+
+namespace SmithTool {
+
+/**
+ * @brief Process-wide profiler
+ *
+ * Scope names must be string literals (or otherwise outlive the
+ * profiler); they are stored by pointer.
+ */
+class Profiler {
+public:
+    /**
+     * @brief Aggregated timings of one scope name
+     */
+    struct Stat {
+        const char* name;
+        long long count;
+        double totalMs;
+        double maxMs;
+        double lastMs;
+        
+        double averageMs() const { return count > 0 ? totalMs / count : 0.0; }
+    };
+    
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+    
+    /**
+     * @brief Monotonic time in ns (the time base of all events)
+     */
+    static long long nowNs();
+    
+    /**
+     * @brief Record a finished scope (normally done by Scope)
+     */
+    static void record(const char* name, long long startNs, long long durationNs);
+    
+    /**
+     * @brief Counters of every name recorded since the last reset()
+     */
+    static std::vector<Stat> stats();
+    
+    /**
+     * @brief Drop all events and counters
+     */
+    static void reset();
+    
+    /**
+     * @brief Number of events in the log (oldest are dropped beyond MAX_EVENTS)
+     */
+    static int eventCount();
+    
+    /**
+     * @brief Write the event log in Chrome trace format
+     *
+     * The file opens in chrome://tracing or Perfetto. Events are complete
+     * ("X") events with one track per thread.
+     *
+     * @return false if the file cannot be written
+     */
+    static bool writeChromeTrace(const QString& path);
+    
+    static constexpr int MAX_EVENTS = 1 << 20;
+    
+    /**
+     * @brief RAII timer; use SMITHTOOL_PROFILE_SCOPE
+     */
+    class Scope {
+    public:
+        explicit Scope(const char* name)
+            : m_name(isEnabled() ? name : nullptr)
+            , m_start(m_name ? nowNs() : 0) {}
+        ~Scope() {
+            if (m_name) record(m_name, m_start, nowNs() - m_start);
+        }
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    
+    private:
+        const char* m_name;
+        long long m_start;
+    };
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+} // namespace SmithTool
+
+#define SMITHTOOL_PROFILE_CONCAT2(a, b) a##b
+#define SMITHTOOL_PROFILE_CONCAT(a, b) SMITHTOOL_PROFILE_CONCAT2(a, b)
+
+/**
+ * @brief Time the enclosing scope under the given literal name
+ */
+#define SMITHTOOL_PROFILE_SCOPE(name) \
+    ::SmithTool::Profiler::Scope SMITHTOOL_PROFILE_CONCAT(profileScope_, __LINE__)(name)
+
+#endif // SMITHTOOL_PROFILER_H
@@ -11,6 +11,7 @@
 
 #include <complex>
 #include <cmath>
+#include <cstddef>
 #include <QPointF>
 #include <QRectF>
 
@@ -154,9 +155,210 @@ public:
      */
     static double gammaPhaseDegrees(const Complex& gamma);
     
+    // Batch conversions
+    //
+    // The batch functions process whole arrays with SIMD (AVX2, SSE2 or
+    // NEON, chosen at compile time; see simdBackend()) and a scalar loop
+    // for the remainder. Input and output may be the same array. The
+    // interleaved forms take std::complex arrays; the split forms take
+    // separate real and imaginary arrays.
+    
+    /**
+     * @brief Convert impedances to reflection coefficients
+     * @param z Input impedances
+     * @param gamma Output reflection coefficients
+     * @param count Number of values
+     * @param z0 Reference impedance
+     */
+    static void impedanceToGamma(const Complex* z, Complex* gamma,
+                                 std::size_t count, double z0 = 50.0);
+    static void impedanceToGamma(const double* zRe, const double* zIm,
+                                 double* gammaRe, double* gammaIm,
+                                 std::size_t count, double z0 = 50.0);
+    
+    /**
+     * @brief Convert reflection coefficients to impedances
+     * @param gamma Input reflection coefficients
+     * @param z Output impedances
+     * @param count Number of values
+     * @param z0 Reference impedance
+     */
+    static void gammaToImpedance(const Complex* gamma, Complex* z,
+                                 std::size_t count, double z0 = 50.0);
+    static void gammaToImpedance(const double* gammaRe, const double* gammaIm,
+                                 double* zRe, double* zIm,
+                                 std::size_t count, double z0 = 50.0);
+    
+    /**
+     * @brief Convert reflection coefficients to screen coordinates
+     * @param gamma Input reflection coefficients
+     * @param points Output screen coordinates
+     * @param count Number of values
+     * @param center Center point of the chart
+     * @param radius Radius of the chart
+     */
+    static void gammaToScreen(const Complex* gamma, QPointF* points,
+                              std::size_t count,
+                              const QPointF& center, double radius);
+    
+    /**
+     * @brief Calculate |Γ| of reflection coefficients
+     * @param gamma Input reflection coefficients
+     * @param magnitude Output magnitudes
+     * @param count Number of values
+     */
+    static void gammaMagnitude(const Complex* gamma, double* magnitude, std::size_t count);
+    
+    /**
+     * @brief Calculate VSWR from reflection coefficients
+     * @param gamma Input reflection coefficients
+     * @param vswr Output VSWR values
+     * @param count Number of values
+     */
+    static void gammaToVSWR(const Complex* gamma, double* vswr, std::size_t count);
+    static void gammaToVSWR(const double* gammaRe, const double* gammaIm,
+                            double* vswr, std::size_t count);
+    
+    /**
+     * @brief Output arrays of twoPortStability(), count values each
+     * 
+     * Stability circle radii are signed: positive if the stable
+     * terminations lie inside the circle, negative if they lie outside.
+     */
+    struct TwoPortStabilityArrays {
+        double* k;              // Rollett stability factor
+        double* mu;             // Edwards-Sinsky mu (load plane)
+        double* muSource;       // mu' (source plane)
+        double* maxGain;        // MAG if K > 1, else MSG (linear)
+        double* sourceCenterRe;
+        double* sourceCenterIm;
+        double* sourceRadius;
+        double* loadCenterRe;
+        double* loadCenterIm;
+        double* loadRadius;
+    };
+    
+    /**
+     * @brief Stability factors and stability circles of a two-port
+     * @param s11 S11 per point (likewise s21, s12, s22)
+     * @param count Number of points
+     * @param out Output arrays
+     */
+    static void twoPortStability(const Complex* s11, const Complex* s21,
+                                 const Complex* s12, const Complex* s22,
+                                 std::size_t count, const TwoPortStabilityArrays& out);
+    
+    /**
+     * @brief Constant available-gain circles in the source plane
+     * @param gain Available gain per point (linear)
+     * @param radius Output radius, -1 where no source reaches the gain
+     */
+    static void availableGainCircles(const Complex* s11, const Complex* s21,
+                                     const Complex* s12, const Complex* s22,
+                                     const double* gain, std::size_t count,
+                                     double* centerRe, double* centerIm, double* radius);
+    
+    /**
+     * @brief Constant noise-figure circles in the source plane
+     * @param fMin Minimum noise factor per point (linear)
+     * @param gammaOptRe Real part of the optimum source reflection (likewise Im)
+     * @param rn Noise resistance normalized to the reference impedance
+     * @param factor Noise factor of the circle per point (linear)
+     * @param radius Output radius, -1 where factor is below fMin
+     */
+    static void noiseCircles(const double* fMin, const double* gammaOptRe,
+                             const double* gammaOptIm, const double* rn,
+                             const double* factor, std::size_t count,
+                             double* centerRe, double* centerIm, double* radius);
+    
+    /**
+     * @brief One network of a two-port cascade, count values per array
+     */
+    struct TwoPortNetwork {
+        const Complex* s11;
+        const Complex* s21;
+        const Complex* s12;
+        const Complex* s22;
+        bool inverse;           // Enter as the inverse network, i.e. remove it
+    };
+    
+    // Output arrays of the two-port network functions, count values each
+    struct TwoPortOutputArrays {
+        Complex* s11;
+        Complex* s21;
+        Complex* s12;
+        Complex* s22;
+    };
+    
+    static constexpr int MAX_CASCADE = 4;
+    
+    /**
+     * @brief Cascade two-ports point by point through T-parameters
+     * 
+     * Port 2 of each network connects to port 1 of the next. Removing
+     * fixtures L and R from a measurement M is the cascade
+     * {L inverse, M, R inverse}.
+     * 
+     * @param networkCount 1 to MAX_CASCADE
+     * @param out Output arrays (may alias an input)
+     */
+    static void cascadeTwoPorts(const TwoPortNetwork* networks, int networkCount,
+                                std::size_t count, const TwoPortOutputArrays& out);
+    
+    /**
+     * @brief Reflection at port 1 of a cascade with port 2 terminated
+     * @param load Reflection of the termination per point
+     * @param gamma Output reflection (may alias load)
+     */
+    static void terminateTwoPorts(const TwoPortNetwork* networks, int networkCount,
+                                  const Complex* load, Complex* gamma, std::size_t count);
+    
+    /**
+     * @brief Renormalize reflections to a new real reference impedance
+     * @param r (z0new - z0) / (z0new + z0)
+     */
+    static void renormalizeReflections(const Complex* gamma, Complex* out,
+                                       std::size_t count, double r);
+    
+    /**
+     * @brief Renormalize two-port S-parameters, both ports to the same new z0
+     * @param r (z0new - z0) / (z0new + z0)
+     */
+    static void renormalizeTwoPorts(const Complex* s11, const Complex* s21,
+                                    const Complex* s12, const Complex* s22,
+                                    std::size_t count, double r,
+                                    const TwoPortOutputArrays& out);
+    
+    /**
+     * @brief Multiply complex arrays element-wise, out = a b
+     */
+    static void multiplyComplex(const Complex* a, const Complex* b, Complex* out,
+                                std::size_t count);
+    
+    /**
+     * @brief Name of the SIMD instruction set used by the batch functions
+     * @return "AVX2", "SSE2", "NEON" or "scalar"
+     */
+    static const char* simdBackend();
+    
+    /**
+     * @brief v, or ±DIVISOR_EPSILON if it is smaller in magnitude
+     * 
+     * Keeps tan/cot/csc of line and stub lengths finite at resonance.
+     */
+    static double safeDivisor(double v)
+    {
+        if (std::abs(v) >= DIVISOR_EPSILON) return v;
+        return (v < 0.0) ? -DIVISOR_EPSILON : DIVISOR_EPSILON;
+    }
+    
     // Mathematical constants
     static constexpr double PI = 3.14159265358979323846;
     static constexpr double TWO_PI = 2.0 * PI;
+    
+    // Free-space propagation used for every line and stub length
+    static constexpr double SPEED_OF_LIGHT = 3e8;
+    static constexpr double DIVISOR_EPSILON = 1e-12;
 };
 
 } // namespace SmithTool
@@ -0,0 +1,892 @@
+/**
+ * @file smithmathbatch.cpp
+ * @brief Vectorized batch conversions for SmithMath
+ *
+ * Every kernel is written once against a small set of vector operations
+ * (Ops) and instantiated for the SIMD instruction set selected at compile
+ * time plus a scalar version that handles the remainder of each array.
+ */
+
+#include "smithmath.h"
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SMITHTOOL_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SMITHTOOL_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SMITHTOOL_SIMD_NEON
+#endif
+
+namespace SmithTool {
+
+namespace {
+
+// Scalar operations; also used for array tails
+struct ScalarOps {
+    using V = double;
+    using M = bool;
+    static constexpr std::size_t W = 1;
+    
+    static V set1(double v) { return v; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+    static V div(V a, V b) { return a / b; }
+    static V sqrt(V a) { return std::sqrt(a); }
+    static M less(V a, V b) { return a < b; }
+    static V select(M m, V a, V b) { return m ? a : b; }
+    
+    static V load(const double* p) { return *p; }
+    static void store(double* p, V v) { *p = v; }
+    static void loadInterleaved(const double* p, V& re, V& im) { re = p[0]; im = p[1]; }
+    static void storeInterleaved(double* p, V re, V im) { p[0] = re; p[1] = im; }
+};
+
+#if defined(SMITHTOOL_SIMD_AVX2)
+
+struct SimdOps {
+    using V = __m256d;
+    using M = __m256d;
+    static constexpr std::size_t W = 4;
+    
+    static V set1(double v) { return _mm256_set1_pd(v); }
+    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm256_div_pd(a, b); }
+    static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+    static M less(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static V select(M m, V a, V b) { return _mm256_blendv_pd(b, a, m); }
+    
+    static V load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+    
+    static void loadInterleaved(const double* p, V& re, V& im)
+    {
+        V a = _mm256_loadu_pd(p);       // r0 i0 r1 i1
+        V b = _mm256_loadu_pd(p + 4);   // r2 i2 r3 i3
+        re = _mm256_permute4x64_pd(_mm256_unpacklo_pd(a, b), 0xD8);
+        im = _mm256_permute4x64_pd(_mm256_unpackhi_pd(a, b), 0xD8);
+    }
+    
+    static void storeInterleaved(double* p, V re, V im)
+    {
+        V lo = _mm256_permute4x64_pd(re, 0xD8);  // r0 r2 r1 r3
+        V hi = _mm256_permute4x64_pd(im, 0xD8);
+        _mm256_storeu_pd(p, _mm256_unpacklo_pd(lo, hi));
+        _mm256_storeu_pd(p + 4, _mm256_unpackhi_pd(lo, hi));
+    }
+};
+
+const char* const SIMD_NAME = "AVX2";
+
+#elif defined(SMITHTOOL_SIMD_SSE2)
+
+struct SimdOps {
+    using V = __m128d;
+    using M = __m128d;
+    static constexpr std::size_t W = 2;
+    
+    static V set1(double v) { return _mm_set1_pd(v); }
+    static V add(V a, V b) { return _mm_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm_div_pd(a, b); }
+    static V sqrt(V a) { return _mm_sqrt_pd(a); }
+    static M less(V a, V b) { return _mm_cmplt_pd(a, b); }
+    static V select(M m, V a, V b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+    
+    static V load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+    
+    static void loadInterleaved(const double* p, V& re, V& im)
+    {
+        V a = _mm_loadu_pd(p);          // r0 i0
+        V b = _mm_loadu_pd(p + 2);      // r1 i1
+        re = _mm_unpacklo_pd(a, b);
+        im = _mm_unpackhi_pd(a, b);
+    }
+    
+    static void storeInterleaved(double* p, V re, V im)
+    {
+        _mm_storeu_pd(p, _mm_unpacklo_pd(re, im));
+        _mm_storeu_pd(p + 2, _mm_unpackhi_pd(re, im));
+    }
+};
+
+const char* const SIMD_NAME = "SSE2";
+
+#elif defined(SMITHTOOL_SIMD_NEON)
+
+struct SimdOps {
+    using V = float64x2_t;
+    using M = uint64x2_t;
+    static constexpr std::size_t W = 2;
+    
+    static V set1(double v) { return vdupq_n_f64(v); }
+    static V add(V a, V b) { return vaddq_f64(a, b); }
+    static V sub(V a, V b) { return vsubq_f64(a, b); }
+    static V mul(V a, V b) { return vmulq_f64(a, b); }
+    static V div(V a, V b) { return vdivq_f64(a, b); }
+    static V sqrt(V a) { return vsqrtq_f64(a); }
+    static M less(V a, V b) { return vcltq_f64(a, b); }
+    static V select(M m, V a, V b) { return vbslq_f64(m, a, b); }
+    
+    static V load(const double* p) { return vld1q_f64(p); }
+    static void store(double* p, V v) { vst1q_f64(p, v); }
+    
+    static void loadInterleaved(const double* p, V& re, V& im)
+    {
+        float64x2x2_t v = vld2q_f64(p);
+        re = v.val[0];
+        im = v.val[1];
+    }
+    
+    static void storeInterleaved(double* p, V re, V im)
+    {
+        float64x2x2_t v;
+        v.val[0] = re;
+        v.val[1] = im;
+        vst2q_f64(p, v);
+    }
+};
+
+const char* const SIMD_NAME = "NEON";
+
+#else
+
+using SimdOps = ScalarOps;
+const char* const SIMD_NAME = "scalar";
+
+#endif
+
+// Kernels: one value per lane
+
+// Γ = (z - z0) / (z + z0) with z = r + jx
+struct ImpedanceToGamma {
+    double z0;
+    
+    template <class Ops, class V = typename Ops::V>
+    void apply(V r, V x, V& gRe, V& gIm) const
+    {
+        V z0v = Ops::set1(z0);
+        V rp = Ops::add(r, z0v);
+        V d = Ops::add(Ops::mul(rp, rp), Ops::mul(x, x));
+        V n = Ops::sub(Ops::add(Ops::mul(r, r), Ops::mul(x, x)), Ops::mul(z0v, z0v));
+        gRe = Ops::div(n, d);
+        gIm = Ops::div(Ops::mul(Ops::set1(2.0 * z0), x), d);
+    }
+};
+
+// z = z0 (1 + Γ) / (1 - Γ); |1 - Γ| < 1e-12 maps to 1e12 as in the scalar API
+struct GammaToImpedance {
+    double z0;
+    
+    template <class Ops, class V = typename Ops::V>
+    void apply(V u, V v, V& zRe, V& zIm) const
+    {
+        V one = Ops::set1(1.0);
+        V um = Ops::sub(one, u);
+        V d = Ops::add(Ops::mul(um, um), Ops::mul(v, v));
+        V n = Ops::sub(Ops::sub(one, Ops::mul(u, u)), Ops::mul(v, v));
+        V re = Ops::div(Ops::mul(Ops::set1(z0), n), d);
+        V im = Ops::div(Ops::mul(Ops::set1(2.0 * z0), v), d);
+        
+        auto finite = Ops::less(Ops::set1(1e-24), d);
+        zRe = Ops::select(finite, re, Ops::set1(1e12));
+        zIm = Ops::select(finite, im, Ops::set1(0.0));
+    }
+};
+
+// Screen x = cx + Re(Γ)·R, y = cy - Im(Γ)·R
+struct GammaToScreen {
+    double cx;
+    double cy;
+    double radius;
+    
+    template <class Ops, class V = typename Ops::V>
+    void apply(V u, V v, V& x, V& y) const
+    {
+        x = Ops::add(Ops::set1(cx), Ops::mul(u, Ops::set1(radius)));
+        y = Ops::sub(Ops::set1(cy), Ops::mul(v, Ops::set1(radius)));
+    }
+};
+
+// |Γ|
+struct GammaMagnitude {
+    template <class Ops, class V = typename Ops::V>
+    void apply(V u, V v, V& mag) const
+    {
+        mag = Ops::sqrt(Ops::add(Ops::mul(u, u), Ops::mul(v, v)));
+    }
+};
+
+// VSWR = (1 + |Γ|) / (1 - |Γ|), 1e6 for |Γ| >= 1 as in the scalar API
+struct GammaToVSWR {
+    template <class Ops, class V = typename Ops::V>
+    void apply(V u, V v, V& vswr) const
+    {
+        V one = Ops::set1(1.0);
+        V mag = Ops::sqrt(Ops::add(Ops::mul(u, u), Ops::mul(v, v)));
+        V ratio = Ops::div(Ops::add(one, mag), Ops::sub(one, mag));
+        vswr = Ops::select(Ops::less(mag, one), ratio, Ops::set1(1e6));
+    }
+};
+
+// Two-port kernels, written on split complex lanes
+
+template <class Ops, class V = typename Ops::V>
+inline void complexMul(V ar, V ai, V br, V bi, V& re, V& im)
+{
+    re = Ops::sub(Ops::mul(ar, br), Ops::mul(ai, bi));
+    im = Ops::add(Ops::mul(ar, bi), Ops::mul(ai, br));
+}
+
+template <class Ops, class V = typename Ops::V>
+inline V norm(V re, V im)
+{
+    return Ops::add(Ops::mul(re, re), Ops::mul(im, im));
+}
+
+template <class Ops, class V = typename Ops::V>
+inline V absolute(V a)
+{
+    return Ops::sqrt(Ops::mul(a, a));
+}
+
+// Lanes of S11, S21, S12, S22 and the quantities every two-port kernel needs
+template <class Ops>
+struct TwoPortLanes {
+    using V = typename Ops::V;
+    
+    V s11Re, s11Im, s21Re, s21Im, s12Re, s12Im, s22Re, s22Im;
+    V dRe, dIm;     // Δ = S11 S22 - S12 S21
+    V p;            // |S12 S21|
+    V s11Sq, s22Sq, dSq;
+    V c1Re, c1Im;   // S11 - Δ S22*
+    V c2Re, c2Im;   // S22 - Δ S11*
+    
+    void derive()
+    {
+        V aRe, aIm, bRe, bIm;
+        complexMul<Ops>(s11Re, s11Im, s22Re, s22Im, aRe, aIm);
+        complexMul<Ops>(s12Re, s12Im, s21Re, s21Im, bRe, bIm);
+        dRe = Ops::sub(aRe, bRe);
+        dIm = Ops::sub(aIm, bIm);
+        p = Ops::sqrt(norm<Ops>(bRe, bIm));
+        s11Sq = norm<Ops>(s11Re, s11Im);
+        s22Sq = norm<Ops>(s22Re, s22Im);
+        dSq = norm<Ops>(dRe, dIm);
+        
+        V zero = Ops::set1(0.0);
+        complexMul<Ops>(dRe, dIm, s22Re, Ops::sub(zero, s22Im), aRe, aIm);
+        c1Re = Ops::sub(s11Re, aRe);
+        c1Im = Ops::sub(s11Im, aIm);
+        complexMul<Ops>(dRe, dIm, s11Re, Ops::sub(zero, s11Im), aRe, aIm);
+        c2Re = Ops::sub(s22Re, aRe);
+        c2Im = Ops::sub(s22Im, aIm);
+    }
+};
+
+// Circle of center cRe + j cIm and radius r, radius negated when the
+// stable side (the side of Γ = 0 if |S| < 1 there) is the outside
+template <class Ops, class V = typename Ops::V>
+inline V signedStabilityRadius(V cRe, V cIm, V r, V oppositeSq)
+{
+    V zero = Ops::set1(0.0);
+    V originOutside = Ops::sub(norm<Ops>(cRe, cIm), Ops::mul(r, r));
+    V originStable = Ops::sub(Ops::set1(1.0), oppositeSq);
+    return Ops::select(Ops::less(Ops::mul(originOutside, originStable), zero), r, Ops::sub(zero, r));
+}
+
+struct TwoPortStabilityKernel {
+    template <class Ops, class V = typename Ops::V>
+    void apply(TwoPortLanes<Ops>& s, V* out) const
+    {
+        s.derive();
+        V one = Ops::set1(1.0);
+        V zero = Ops::set1(0.0);
+        
+        V k = Ops::div(Ops::add(Ops::sub(Ops::sub(one, s.s11Sq), s.s22Sq), s.dSq),
+                       Ops::mul(Ops::set1(2.0), s.p));
+        V mu = Ops::div(Ops::sub(one, s.s11Sq), Ops::add(Ops::sqrt(norm<Ops>(s.c2Re, s.c2Im)), s.p));
+        V muSource = Ops::div(Ops::sub(one, s.s22Sq), Ops::add(Ops::sqrt(norm<Ops>(s.c1Re, s.c1Im)), s.p));
+        
+        // MAG = |S21/S12| (K - sqrt(K² - 1)) for K > 1, else MSG = |S21/S12|
+        V ratio = Ops::sqrt(Ops::div(norm<Ops>(s.s21Re, s.s21Im), norm<Ops>(s.s12Re, s.s12Im)));
+        V k2 = Ops::sub(Ops::mul(k, k), one);
+        V mag = Ops::mul(ratio, Ops::sub(k, Ops::sqrt(Ops::select(Ops::less(zero, k2), k2, zero))));
+        V maxGain = Ops::select(Ops::less(one, k), mag, ratio);
+        
+        // Source plane: C = (S11 - Δ S22*)* / (|S11|² - |Δ|²), r = |S12 S21| / ||S11|² - |Δ|²|
+        V sDen = Ops::sub(s.s11Sq, s.dSq);
+        V sRe = Ops::div(s.c1Re, sDen);
+        V sIm = Ops::div(Ops::sub(zero, s.c1Im), sDen);
+        V sR = Ops::div(s.p, absolute<Ops>(sDen));
+        
+        V lDen = Ops::sub(s.s22Sq, s.dSq);
+        V lRe = Ops::div(s.c2Re, lDen);
+        V lIm = Ops::div(Ops::sub(zero, s.c2Im), lDen);
+        V lR = Ops::div(s.p, absolute<Ops>(lDen));
+        
+        out[0] = k;
+        out[1] = mu;
+        out[2] = muSource;
+        out[3] = maxGain;
+        out[4] = sRe;
+        out[5] = sIm;
+        out[6] = signedStabilityRadius<Ops>(sRe, sIm, sR, s.s22Sq);
+        out[7] = lRe;
+        out[8] = lIm;
+        out[9] = signedStabilityRadius<Ops>(lRe, lIm, lR, s.s11Sq);
+    }
+};
+
+// g = G / |S21|²; C = g C1* / D, r = sqrt(1 - 2K|S12 S21| g + |S12 S21|² g²) / |D|
+// with D = 1 + g (|S11|² - |Δ|²)
+struct AvailableGainKernel {
+    template <class Ops, class V = typename Ops::V>
+    void apply(TwoPortLanes<Ops>& s, V gain, V* out) const
+    {
+        s.derive();
+        V one = Ops::set1(1.0);
+        V zero = Ops::set1(0.0);
+        
+        V g = Ops::div(gain, norm<Ops>(s.s21Re, s.s21Im));
+        V den = Ops::add(one, Ops::mul(g, Ops::sub(s.s11Sq, s.dSq)));
+        V twoKp = Ops::add(Ops::sub(Ops::sub(one, s.s11Sq), s.s22Sq), s.dSq);
+        V pg = Ops::mul(s.p, g);
+        V n = Ops::add(Ops::sub(one, Ops::mul(twoKp, g)), Ops::mul(pg, pg));
+        
+        out[0] = Ops::div(Ops::mul(g, s.c1Re), den);
+        out[1] = Ops::div(Ops::mul(g, Ops::sub(zero, s.c1Im)), den);
+        V r = Ops::div(Ops::sqrt(Ops::select(Ops::less(n, zero), zero, n)), absolute<Ops>(den));
+        out[2] = Ops::select(Ops::less(n, zero), Ops::set1(-1.0), r);
+    }
+};
+
+// N = (F - Fmin) |1 + Γopt|² / (4 rn); C = Γopt / (1 + N),
+// r = sqrt(N (N + 1 - |Γopt|²)) / (1 + N)
+struct NoiseCircleKernel {
+    template <class Ops, class V = typename Ops::V>
+    void apply(V fMin, V gRe, V gIm, V rn, V factor, V* out) const
+    {
+        V one = Ops::set1(1.0);
+        V zero = Ops::set1(0.0);
+        
+        V opt1 = Ops::add(one, gRe);
+        V n = Ops::div(Ops::mul(Ops::sub(factor, fMin), norm<Ops>(opt1, gIm)),
+                       Ops::mul(Ops::set1(4.0), rn));
+        V n1 = Ops::add(n, one);
+        V r2 = Ops::mul(n, Ops::sub(n1, norm<Ops>(gRe, gIm)));
+        
+        out[0] = Ops::div(gRe, n1);
+        out[1] = Ops::div(gIm, n1);
+        V r = Ops::div(Ops::sqrt(Ops::select(Ops::less(r2, zero), zero, r2)), n1);
+        out[2] = Ops::select(Ops::less(n, zero), Ops::set1(-1.0), r);
+    }
+};
+
+// Complex lanes for the T-parameter kernels
+template <class Ops>
+struct ComplexLanes {
+    typename Ops::V re, im;
+};
+
+template <class Ops>
+inline ComplexLanes<Ops> cAdd(ComplexLanes<Ops> a, ComplexLanes<Ops> b)
+{
+    return {Ops::add(a.re, b.re), Ops::add(a.im, b.im)};
+}
+
+template <class Ops>
+inline ComplexLanes<Ops> cSub(ComplexLanes<Ops> a, ComplexLanes<Ops> b)
+{
+    return {Ops::sub(a.re, b.re), Ops::sub(a.im, b.im)};
+}
+
+template <class Ops>
+inline ComplexLanes<Ops> cNeg(ComplexLanes<Ops> a)
+{
+    typename Ops::V zero = Ops::set1(0.0);
+    return {Ops::sub(zero, a.re), Ops::sub(zero, a.im)};
+}
+
+template <class Ops>
+inline ComplexLanes<Ops> cMul(ComplexLanes<Ops> a, ComplexLanes<Ops> b)
+{
+    ComplexLanes<Ops> c;
+    complexMul<Ops>(a.re, a.im, b.re, b.im, c.re, c.im);
+    return c;
+}
+
+template <class Ops>
+inline ComplexLanes<Ops> cScale(ComplexLanes<Ops> a, typename Ops::V k)
+{
+    return {Ops::mul(a.re, k), Ops::mul(a.im, k)};
+}
+
+template <class Ops>
+inline ComplexLanes<Ops> cInverse(ComplexLanes<Ops> a)
+{
+    typename Ops::V n = norm<Ops>(a.re, a.im);
+    return {Ops::div(a.re, n), Ops::div(Ops::sub(Ops::set1(0.0), a.im), n)};
+}
+
+template <class Ops>
+inline ComplexLanes<Ops> cDiv(ComplexLanes<Ops> a, ComplexLanes<Ops> b)
+{
+    return cMul(a, cInverse(b));
+}
+
+// [b1 a1]ᵀ = T [a2 b2]ᵀ, so a cascade is the product of the T matrices
+template <class Ops>
+struct TMatrix {
+    ComplexLanes<Ops> t11, t12, t21, t22;
+    
+    // T = [-Δ S11; -S22 1] / S21; the inverse network is [1 -S11; S22 -Δ] / S12
+    static TMatrix fromS(ComplexLanes<Ops> s11, ComplexLanes<Ops> s21,
+                         ComplexLanes<Ops> s12, ComplexLanes<Ops> s22, bool inverse)
+    {
+        ComplexLanes<Ops> u = cInverse(inverse ? s12 : s21);
+        ComplexLanes<Ops> d = cSub(cMul(s11, s22), cMul(s12, s21));
+        TMatrix t;
+        if (inverse) {
+            t = {u, cNeg(cMul(s11, u)), cMul(s22, u), cNeg(cMul(d, u))};
+        } else {
+            t = {cNeg(cMul(d, u)), cMul(s11, u), cNeg(cMul(s22, u)), u};
+        }
+        return t;
+    }
+    
+    TMatrix operator*(const TMatrix& b) const
+    {
+        return {cAdd(cMul(t11, b.t11), cMul(t12, b.t21)), cAdd(cMul(t11, b.t12), cMul(t12, b.t22)),
+                cAdd(cMul(t21, b.t11), cMul(t22, b.t21)), cAdd(cMul(t21, b.t12), cMul(t22, b.t22))};
+    }
+    
+    // S21 = 1 / T22, S11 = T12 S21, S22 = -T21 S21, S12 = T11 + T12 S22
+    void toS(ComplexLanes<Ops>& s11, ComplexLanes<Ops>& s21,
+             ComplexLanes<Ops>& s12, ComplexLanes<Ops>& s22) const
+    {
+        s21 = cInverse(t22);
+        s11 = cMul(t12, s21);
+        s22 = cNeg(cMul(t21, s21));
+        s12 = cAdd(t11, cMul(t12, s22));
+    }
+    
+    // Input reflection with port 2 terminated by gamma
+    ComplexLanes<Ops> terminate(ComplexLanes<Ops> gamma) const
+    {
+        return cDiv(cAdd(cMul(t11, gamma), t12), cAdd(cMul(t21, gamma), t22));
+    }
+};
+
+// Γ' = (Γ - r) / (1 - r Γ)
+struct RenormalizeReflection {
+    double r;
+    
+    template <class Ops, class V = typename Ops::V>
+    void apply(V re, V im, V& outRe, V& outIm) const
+    {
+        V rv = Ops::set1(r);
+        ComplexLanes<Ops> num = {Ops::sub(re, rv), im};
+        ComplexLanes<Ops> den = {Ops::sub(Ops::set1(1.0), Ops::mul(rv, re)),
+                                 Ops::sub(Ops::set1(0.0), Ops::mul(rv, im))};
+        ComplexLanes<Ops> g = cDiv(num, den);
+        outRe = g.re;
+        outIm = g.im;
+    }
+};
+
+// S' = (S - r I)(I - r S)⁻¹ with equal real references on both ports;
+// D = (1 - r S11)(1 - r S22) - r² S12 S21,
+// S'11 = ((S11 - r)(1 - r S22) + r S12 S21) / D, S'21 = (1 - r²) S21 / D
+struct RenormalizeTwoPort {
+    double r;
+    
+    template <class Ops, class V = typename Ops::V>
+    void apply(ComplexLanes<Ops>* s) const
+    {
+        V rv = Ops::set1(r);
+        ComplexLanes<Ops> one = {Ops::set1(1.0), Ops::set1(0.0)};
+        ComplexLanes<Ops> rc = {rv, Ops::set1(0.0)};
+        ComplexLanes<Ops> a = cSub(one, cScale(s[0], rv));     // 1 - r S11
+        ComplexLanes<Ops> b = cSub(one, cScale(s[3], rv));     // 1 - r S22
+        ComplexLanes<Ops> p = cScale(cMul(s[1], s[2]), rv);    // r S12 S21
+        ComplexLanes<Ops> inv = cInverse(cSub(cMul(a, b), cScale(p, rv)));
+        ComplexLanes<Ops> through = cScale(inv, Ops::set1(1.0 - r * r));
+        
+        ComplexLanes<Ops> s11 = cMul(cAdd(cMul(cSub(s[0], rc), b), p), inv);
+        ComplexLanes<Ops> s22 = cMul(cAdd(cMul(cSub(s[3], rc), a), p), inv);
+        s[1] = cMul(s[1], through);
+        s[2] = cMul(s[2], through);
+        s[0] = s11;
+        s[3] = s22;
+    }
+};
+
+// Drivers: SIMD body, scalar tail
+
+template <class K>
+void mapInterleaved(const K& kernel, const double* in, double* out, std::size_t count)
+{
+    using V = typename SimdOps::V;
+    std::size_t i = 0;
+    for (; i + SimdOps::W <= count; i += SimdOps::W) {
+        V re, im, outRe, outIm;
+        SimdOps::loadInterleaved(in + 2 * i, re, im);
+        kernel.template apply<SimdOps>(re, im, outRe, outIm);
+        SimdOps::storeInterleaved(out + 2 * i, outRe, outIm);
+    }
+    for (; i < count; ++i) {
+        double outRe, outIm;
+        kernel.template apply<ScalarOps>(in[2 * i], in[2 * i + 1], outRe, outIm);
+        out[2 * i] = outRe;
+        out[2 * i + 1] = outIm;
+    }
+}
+
+template <class K>
+void mapSplit(const K& kernel, const double* inRe, const double* inIm,
+              double* outRe, double* outIm, std::size_t count)
+{
+    using V = typename SimdOps::V;
+    std::size_t i = 0;
+    for (; i + SimdOps::W <= count; i += SimdOps::W) {
+        V re, im;
+        kernel.template apply<SimdOps>(SimdOps::load(inRe + i), SimdOps::load(inIm + i), re, im);
+        SimdOps::store(outRe + i, re);
+        SimdOps::store(outIm + i, im);
+    }
+    for (; i < count; ++i) {
+        kernel.template apply<ScalarOps>(inRe[i], inIm[i], outRe[i], outIm[i]);
+    }
+}
+
+template <class K>
+void reduceInterleaved(const K& kernel, const double* in, double* out, std::size_t count)
+{
+    using V = typename SimdOps::V;
+    std::size_t i = 0;
+    for (; i + SimdOps::W <= count; i += SimdOps::W) {
+        V re, im, result;
+        SimdOps::loadInterleaved(in + 2 * i, re, im);
+        kernel.template apply<SimdOps>(re, im, result);
+        SimdOps::store(out + i, result);
+    }
+    for (; i < count; ++i) {
+        kernel.template apply<ScalarOps>(in[2 * i], in[2 * i + 1], out[i]);
+    }
+}
+
+template <class K>
+void reduceSplit(const K& kernel, const double* inRe, const double* inIm,
+                 double* out, std::size_t count)
+{
+    using V = typename SimdOps::V;
+    std::size_t i = 0;
+    for (; i + SimdOps::W <= count; i += SimdOps::W) {
+        V result;
+        kernel.template apply<SimdOps>(SimdOps::load(inRe + i), SimdOps::load(inIm + i), result);
+        SimdOps::store(out + i, result);
+    }
+    for (; i < count; ++i) {
+        kernel.template apply<ScalarOps>(inRe[i], inIm[i], out[i]);
+    }
+}
+
+// std::complex<double> is guaranteed to be layout-compatible with double[2]
+inline const double* asDoubles(const Complex* p) { return reinterpret_cast<const double*>(p); }
+inline double* asDoubles(Complex* p) { return reinterpret_cast<double*>(p); }
+
+template <class Ops>
+inline void loadTwoPort(TwoPortLanes<Ops>& s, const double* s11, const double* s21,
+                        const double* s12, const double* s22, std::size_t i)
+{
+    Ops::loadInterleaved(s11 + 2 * i, s.s11Re, s.s11Im);
+    Ops::loadInterleaved(s21 + 2 * i, s.s21Re, s.s21Im);
+    Ops::loadInterleaved(s12 + 2 * i, s.s12Re, s.s12Im);
+    Ops::loadInterleaved(s22 + 2 * i, s.s22Re, s.s22Im);
+}
+
+// Four interleaved S-parameter arrays in, `Outputs` split arrays out
+template <std::size_t Outputs, class K>
+void mapTwoPort(const K& kernel, const Complex* s11, const Complex* s21,
+                const Complex* s12, const Complex* s22, const double* gain,
+                double* const* out, std::size_t count)
+{
+    const double* p11 = asDoubles(s11);
+    const double* p21 = asDoubles(s21);
+    const double* p12 = asDoubles(s12);
+    const double* p22 = asDoubles(s22);
+    
+    using V = typename SimdOps::V;
+    std::size_t i = 0;
+    for (; i + SimdOps::W <= count; i += SimdOps::W) {
+        TwoPortLanes<SimdOps> lanes;
+        V result[Outputs];
+        loadTwoPort(lanes, p11, p21, p12, p22, i);
+        if constexpr (std::is_same<K, AvailableGainKernel>::value) {
+            kernel.template apply<SimdOps>(lanes, SimdOps::load(gain + i), result);
+        } else {
+            kernel.template apply<SimdOps>(lanes, result);
+        }
+        for (std::size_t o = 0; o < Outputs; ++o) {
+            SimdOps::store(out[o] + i, result[o]);
+        }
+    }
+    for (; i < count; ++i) {
+        TwoPortLanes<ScalarOps> lanes;
+        double result[Outputs];
+        loadTwoPort(lanes, p11, p21, p12, p22, i);
+        if constexpr (std::is_same<K, AvailableGainKernel>::value) {
+            kernel.template apply<ScalarOps>(lanes, gain[i], result);
+        } else {
+            kernel.template apply<ScalarOps>(lanes, result);
+        }
+        for (std::size_t o = 0; o < Outputs; ++o) {
+            out[o][i] = result[o];
+        }
+    }
+}
+
+// Cascade of T matrices at points [i, i + W)
+template <class Ops>
+TMatrix<Ops> loadCascade(const SmithMath::TwoPortNetwork* networks, int networkCount, std::size_t i)
+{
+    TMatrix<Ops> product;
+    for (int k = 0; k < networkCount; ++k) {
+        const SmithMath::TwoPortNetwork& net = networks[k];
+        ComplexLanes<Ops> s[4];
+        Ops::loadInterleaved(asDoubles(net.s11) + 2 * i, s[0].re, s[0].im);
+        Ops::loadInterleaved(asDoubles(net.s21) + 2 * i, s[1].re, s[1].im);
+        Ops::loadInterleaved(asDoubles(net.s12) + 2 * i, s[2].re, s[2].im);
+        Ops::loadInterleaved(asDoubles(net.s22) + 2 * i, s[3].re, s[3].im);
+        TMatrix<Ops> t = TMatrix<Ops>::fromS(s[0], s[1], s[2], s[3], net.inverse);
+        product = k == 0 ? t : product * t;
+    }
+    return product;
+}
+
+template <class Ops>
+inline void storeTwoPort(const SmithMath::TwoPortOutputArrays& out, std::size_t i,
+                         const ComplexLanes<Ops>* s)
+{
+    Ops::storeInterleaved(asDoubles(out.s11) + 2 * i, s[0].re, s[0].im);
+    Ops::storeInterleaved(asDoubles(out.s21) + 2 * i, s[1].re, s[1].im);
+    Ops::storeInterleaved(asDoubles(out.s12) + 2 * i, s[2].re, s[2].im);
+    Ops::storeInterleaved(asDoubles(out.s22) + 2 * i, s[3].re, s[3].im);
+}
+
+template <class Ops>
+void cascadeRange(const SmithMath::TwoPortNetwork* networks, int networkCount,
+                  std::size_t& i, std::size_t count, const SmithMath::TwoPortOutputArrays& out)
+{
+    for (; i + Ops::W <= count; i += Ops::W) {
+        ComplexLanes<Ops> s[4];
+        loadCascade<Ops>(networks, networkCount, i).toS(s[0], s[1], s[2], s[3]);
+        storeTwoPort(out, i, s);
+    }
+}
+
+template <class Ops>
+void terminateRange(const SmithMath::TwoPortNetwork* networks, int networkCount,
+                    const Complex* load, Complex* gamma, std::size_t& i, std::size_t count)
+{
+    for (; i + Ops::W <= count; i += Ops::W) {
+        ComplexLanes<Ops> g;
+        Ops::loadInterleaved(asDoubles(load) + 2 * i, g.re, g.im);
+        g = loadCascade<Ops>(networks, networkCount, i).terminate(g);
+        Ops::storeInterleaved(asDoubles(gamma) + 2 * i, g.re, g.im);
+    }
+}
+
+template <class Ops>
+void renormalizeRange(const Complex* const* in, double r, std::size_t& i, std::size_t count,
+                      const SmithMath::TwoPortOutputArrays& out)
+{
+    RenormalizeTwoPort kernel{r};
+    for (; i + Ops::W <= count; i += Ops::W) {
+        ComplexLanes<Ops> s[4];
+        for (int p = 0; p < 4; ++p) {
+            Ops::loadInterleaved(asDoubles(in[p]) + 2 * i, s[p].re, s[p].im);
+        }
+        kernel.template apply<Ops>(s);
+        storeTwoPort(out, i, s);
+    }
+}
+
+} // namespace
+
+void SmithMath::impedanceToGamma(const Complex* z, Complex* gamma,
+                                 std::size_t count, double z0)
+{
+    mapInterleaved(ImpedanceToGamma{z0}, asDoubles(z), asDoubles(gamma), count);
+}
+
+void SmithMath::impedanceToGamma(const double* zRe, const double* zIm,
+                                 double* gammaRe, double* gammaIm,
+                                 std::size_t count, double z0)
+{
+    mapSplit(ImpedanceToGamma{z0}, zRe, zIm, gammaRe, gammaIm, count);
+}
+
+void SmithMath::gammaToImpedance(const Complex* gamma, Complex* z,
+                                 std::size_t count, double z0)
+{
+    mapInterleaved(GammaToImpedance{z0}, asDoubles(gamma), asDoubles(z), count);
+}
+
+void SmithMath::gammaToImpedance(const double* gammaRe, const double* gammaIm,
+                                 double* zRe, double* zIm,
+                                 std::size_t count, double z0)
+{
+    mapSplit(GammaToImpedance{z0}, gammaRe, gammaIm, zRe, zIm, count);
+}
+
+void SmithMath::gammaToScreen(const Complex* gamma, QPointF* points,
+                              std::size_t count,
+                              const QPointF& center, double radius)
+{
+    GammaToScreen kernel{center.x(), center.y(), radius};
+    
+    // QPointF is a pair of qreal; write it directly when qreal is double
+    if (std::is_same<qreal, double>::value && sizeof(QPointF) == 2 * sizeof(double)) {
+        mapInterleaved(kernel, asDoubles(gamma), reinterpret_cast<double*>(points), count);
+        return;
+    }
+    
+    for (std::size_t i = 0; i < count; ++i) {
+        points[i] = gammaToScreen(gamma[i], center, radius);
+    }
+}
+
+void SmithMath::gammaMagnitude(const Complex* gamma, double* magnitude, std::size_t count)
+{
+    reduceInterleaved(GammaMagnitude{}, asDoubles(gamma), magnitude, count);
+}
+
+void SmithMath::gammaToVSWR(const Complex* gamma, double* vswr, std::size_t count)
+{
+    reduceInterleaved(GammaToVSWR{}, asDoubles(gamma), vswr, count);
+}
+
+void SmithMath::gammaToVSWR(const double* gammaRe, const double* gammaIm,
+                            double* vswr, std::size_t count)
+{
+    reduceSplit(GammaToVSWR{}, gammaRe, gammaIm, vswr, count);
+}
+
+void SmithMath::twoPortStability(const Complex* s11, const Complex* s21,
+                                 const Complex* s12, const Complex* s22,
+                                 std::size_t count, const TwoPortStabilityArrays& out)
+{
+    double* const arrays[] = {out.k, out.mu, out.muSource, out.maxGain,
+                              out.sourceCenterRe, out.sourceCenterIm, out.sourceRadius,
+                              out.loadCenterRe, out.loadCenterIm, out.loadRadius};
+    mapTwoPort<10>(TwoPortStabilityKernel{}, s11, s21, s12, s22, nullptr, arrays, count);
+}
+
+void SmithMath::availableGainCircles(const Complex* s11, const Complex* s21,
+                                     const Complex* s12, const Complex* s22,
+                                     const double* gain, std::size_t count,
+                                     double* centerRe, double* centerIm, double* radius)
+{
+    double* const arrays[] = {centerRe, centerIm, radius};
+    mapTwoPort<3>(AvailableGainKernel{}, s11, s21, s12, s22, gain, arrays, count);
+}
+
+void SmithMath::noiseCircles(const double* fMin, const double* gammaOptRe,
+                             const double* gammaOptIm, const double* rn,
+                             const double* factor, std::size_t count,
+                             double* centerRe, double* centerIm, double* radius)
+{
+    NoiseCircleKernel kernel;
+    using V = typename SimdOps::V;
+    std::size_t i = 0;
+    for (; i + SimdOps::W <= count; i += SimdOps::W) {
+        V result[3];
+        kernel.apply<SimdOps>(SimdOps::load(fMin + i), SimdOps::load(gammaOptRe + i),
+                              SimdOps::load(gammaOptIm + i), SimdOps::load(rn + i),
+                              SimdOps::load(factor + i), result);
+        SimdOps::store(centerRe + i, result[0]);
+        SimdOps::store(centerIm + i, result[1]);
+        SimdOps::store(radius + i, result[2]);
+    }
+    for (; i < count; ++i) {
+        double result[3];
+        kernel.apply<ScalarOps>(fMin[i], gammaOptRe[i], gammaOptIm[i], rn[i], factor[i], result);
+        centerRe[i] = result[0];
+        centerIm[i] = result[1];
+        radius[i] = result[2];
+    }
+}
+
+void SmithMath::cascadeTwoPorts(const TwoPortNetwork* networks, int networkCount,
+                                std::size_t count, const TwoPortOutputArrays& out)
+{
+    if (networkCount < 1 || networkCount > MAX_CASCADE) return;
+    std::size_t i = 0;
+    cascadeRange<SimdOps>(networks, networkCount, i, count, out);
+    cascadeRange<ScalarOps>(networks, networkCount, i, count, out);
+}
+
+void SmithMath::terminateTwoPorts(const TwoPortNetwork* networks, int networkCount,
+                                  const Complex* load, Complex* gamma, std::size_t count)
+{
+    if (networkCount < 1 || networkCount > MAX_CASCADE) return;
+    std::size_t i = 0;
+    terminateRange<SimdOps>(networks, networkCount, load, gamma, i, count);
+    terminateRange<ScalarOps>(networks, networkCount, load, gamma, i, count);
+}
+
+void SmithMath::renormalizeReflections(const Complex* gamma, Complex* out,
+                                       std::size_t count, double r)
+{
+    mapInterleaved(RenormalizeReflection{r}, asDoubles(gamma), asDoubles(out), count);
+}
+
+void SmithMath::renormalizeTwoPorts(const Complex* s11, const Complex* s21,
+                                    const Complex* s12, const Complex* s22,
+                                    std::size_t count, double r,
+                                    const TwoPortOutputArrays& out)
+{
+    const Complex* const in[] = {s11, s21, s12, s22};
+    std::size_t i = 0;
+    renormalizeRange<SimdOps>(in, r, i, count, out);
+    renormalizeRange<ScalarOps>(in, r, i, count, out);
+}
+
+void SmithMath::multiplyComplex(const Complex* a, const Complex* b, Complex* out,
+                                std::size_t count)
+{
+    const double* pa = asDoubles(a);
+    const double* pb = asDoubles(b);
+    double* po = asDoubles(out);
+    
+    using V = typename SimdOps::V;
+    std::size_t i = 0;
+    for (; i + SimdOps::W <= count; i += SimdOps::W) {
+        V ar, ai, br, bi, re, im;
+        SimdOps::loadInterleaved(pa + 2 * i, ar, ai);
+        SimdOps::loadInterleaved(pb + 2 * i, br, bi);
+        complexMul<SimdOps>(ar, ai, br, bi, re, im);
+        SimdOps::storeInterleaved(po + 2 * i, re, im);
+    }
+    for (; i < count; ++i) {
+        complexMul<ScalarOps>(pa[2 * i], pa[2 * i + 1], pb[2 * i], pb[2 * i + 1],
+                              po[2 * i], po[2 * i + 1]);
+    }
+}
+
+const char* SmithMath::simdBackend()
+{
+    return SIMD_NAME;
+}
+
+} // namespace SmithTool
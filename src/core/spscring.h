@@ -0,0 +1,95 @@
+/**
+ * @file spscring.h
+ * @brief Lock-free single-producer/single-consumer ring of reusable slots
+ */
+
+#ifndef SMITHTOOL_SPSCRING_H
+#define SMITHTOOL_SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief Fixed ring of preallocated slots handed between two threads
+ *
+ * The producer fills a slot in place (beginWrite/endWrite) and the
+ * consumer reads it in place (beginRead/endRead), so nothing is copied
+ * or allocated per item once the slots have been sized. One thread may
+ * produce and one other thread consume; neither ever blocks.
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @param capacity Number of slots, rounded up to a power of two
+     */
+    explicit SpscRing(std::size_t capacity)
+        : m_head(0), m_tail(0)
+    {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_slots.resize(size);
+        m_mask = size - 1;
+    }
+    
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    
+    std::size_t capacity() const { return m_slots.size(); }
+    
+    // Direct slot access for sizing before either thread starts
+    T& slot(std::size_t index) { return m_slots[index]; }
+    
+    // Producer: the next free slot, or null when the ring is full
+    T* beginWrite()
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= m_slots.size()) {
+            return nullptr;
+        }
+        return &m_slots[head & m_mask];
+    }
+    
+    // Producer: publish the slot returned by beginWrite()
+    void endWrite()
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    
+    // Consumer: number of published slots not yet released
+    std::size_t readable() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed);
+    }
+    
+    // Consumer: the oldest published slot, or null when the ring is empty
+    T* beginRead()
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &m_slots[tail & m_mask];
+    }
+    
+    // Consumer: release the count oldest slots back to the producer
+    void endRead(std::size_t count = 1)
+    {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+private:
+    std::vector<T> m_slots;
+    std::size_t m_mask;
+    
+    // Separate cache lines so the two threads do not share one
+    alignas(64) std::atomic<std::size_t> m_head;    // Next slot to write
+    alignas(64) std::atomic<std::size_t> m_tail;    // Next slot to read
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_SPSCRING_H
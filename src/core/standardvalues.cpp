@@ -0,0 +1,522 @@
+/**
+ * @file standardvalues.cpp
+ * @brief Standard-value snapping and search implementation
+ */
+
+#include "standardvalues.h"
+#include "sweep.h"
+#include "smithmath.h"
+#include "parallel.h"
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace SmithTool {
+
+namespace {
+
+// IEC 60063 base values; the E6-E24 values deviate from the geometric
+// series, E48/E96 follow it at three significant digits
+const double E6_VALUES[] = {1.0, 1.5, 2.2, 3.3, 4.7, 6.8};
+const double E12_VALUES[] = {1.0, 1.2, 1.5, 1.8, 2.2, 2.7, 3.3, 3.9, 4.7, 5.6, 6.8, 8.2};
+const double E24_VALUES[] = {
+    1.0, 1.1, 1.2, 1.3, 1.5, 1.6, 1.8, 2.0, 2.2, 2.4, 2.7, 3.0,
+    3.3, 3.6, 3.9, 4.3, 4.7, 5.1, 5.6, 6.2, 6.8, 7.5, 8.2, 9.1
+};
+
+std::vector<double> baseValues(ESeries series)
+{
+    switch (series) {
+        case ESeries::E6: return std::vector<double>(std::begin(E6_VALUES), std::end(E6_VALUES));
+        case ESeries::E12: return std::vector<double>(std::begin(E12_VALUES), std::end(E12_VALUES));
+        case ESeries::E24: return std::vector<double>(std::begin(E24_VALUES), std::end(E24_VALUES));
+        case ESeries::E48:
+        case ESeries::E96: {
+            const int n = (series == ESeries::E48) ? 48 : 96;
+            std::vector<double> values(n);
+            for (int i = 0; i < n; ++i) {
+                values[i] = std::round(std::pow(10.0, static_cast<double>(i) / n) * 100.0) / 100.0;
+            }
+            return values;
+        }
+    }
+    return std::vector<double>();
+}
+
+// Reflection against the source, (Zin - Zs*) / (Zin + Zs), squared
+inline double mismatch2(const Complex& zin, const Complex& zs)
+{
+    Complex den = zin + zs;
+    double d2 = std::norm(den);
+    if (d2 < 1e-300) return 1.0;
+    return std::norm(zin - std::conj(zs)) / d2;
+}
+
+double siMultiplier(QChar prefix, bool& ok)
+{
+    ok = true;
+    switch (prefix.unicode()) {
+        case 'f': return 1e-15;
+        case 'p': return 1e-12;
+        case 'n': return 1e-9;
+        case 'u': case 0x00B5: case 0x03BC: return 1e-6;
+        case 'm': return 1e-3;
+        case 'k': return 1e3;
+        case 'M': return 1e6;
+        default: ok = false; return 1.0;
+    }
+}
+
+/**
+ * @brief Depth-first search state shared by the worker threads
+ */
+struct SearchContext {
+    int elementCount;
+    int freqCount;
+    Complex sourceZ;
+    std::vector<std::vector<double>> candidates;    // Per element, nearest first
+    std::vector<std::vector<AbcdMatrix>> abcd;      // [element][candidate * freqCount + f]
+    std::vector<int> freqOrder;                     // Worst frequency of the ideal first
+    std::vector<long long> stride;                  // Mixed-radix combination index
+    std::atomic<double> bound;                      // Best worst-case |Gamma|^2 so far
+    std::function<bool()> canceled;
+    std::atomic<bool> stopped;
+    
+    SearchContext() : elementCount(0), freqCount(0), bound(0.0), stopped(false) {}
+    
+    // Branches between cancellation polls, per worker
+    static constexpr int POLL_INTERVAL = 256;
+    
+    void lowerBound(double value)
+    {
+        double current = bound.load(std::memory_order_relaxed);
+        while (value < current &&
+               !bound.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+/**
+ * @brief One worker's branch of the search
+ */
+struct SearchWorker {
+    SearchContext& ctx;
+    std::vector<std::vector<Complex>> z;    // [depth][f]: impedance towards the load
+    double bestGamma2;
+    long long bestIndex;
+    long long evaluated;
+    int untilPoll;
+    
+    SearchWorker(SearchContext& context, const Complex& loadZ)
+        : ctx(context)
+        , z(context.elementCount, std::vector<Complex>(context.freqCount, loadZ))
+        , bestGamma2(std::numeric_limits<double>::infinity())
+        , bestIndex(-1)
+        , evaluated(0)
+        , untilPoll(SearchContext::POLL_INTERVAL) {}
+    
+    // Whether to abandon the search; the callback is only polled now and then
+    bool stopRequested()
+    {
+        if (ctx.stopped.load(std::memory_order_relaxed)) return true;
+        if (!ctx.canceled || --untilPoll > 0) return false;
+        untilPoll = SearchContext::POLL_INTERVAL;
+        if (!ctx.canceled()) return false;
+        ctx.stopped.store(true, std::memory_order_relaxed);
+        return true;
+    }
+    
+    void search(int depth, long long index)
+    {
+        const int f = ctx.freqCount;
+        const int last = ctx.elementCount - 1;
+        const int count = static_cast<int>(ctx.candidates[depth].size());
+        
+        for (int c = 0; c < count; ++c) {
+            const AbcdMatrix* m = &ctx.abcd[depth][static_cast<size_t>(c) * f];
+            const long long combo = index + c * ctx.stride[depth];
+            
+            if (depth < last) {
+                if (stopRequested()) return;
+                std::vector<Complex>& next = z[depth + 1];
+                for (int i = 0; i < f; ++i) {
+                    next[i] = m[i].inputImpedance(z[depth][i]);
+                }
+                search(depth + 1, combo);
+                continue;
+            }
+            
+            // Leaf: abandon at the first frequency that is worse than the bound
+            const double bound = std::min(bestGamma2, ctx.bound.load(std::memory_order_relaxed));
+            double worst = 0.0;
+            bool pruned = false;
+            for (int k = 0; k < f; ++k) {
+                const int i = ctx.freqOrder[k];
+                double g2 = mismatch2(m[i].inputImpedance(z[depth][i]), ctx.sourceZ);
+                if (g2 > bound) {
+                    pruned = true;
+                    break;
+                }
+                worst = std::max(worst, g2);
+            }
+            if (pruned) continue;
+            
+            ++evaluated;
+            if (worst < bestGamma2 || (worst == bestGamma2 && combo < bestIndex)) {
+                bestGamma2 = worst;
+                bestIndex = combo;
+                ctx.lowerBound(worst);
+            }
+        }
+    }
+    
+    // Restricted to the top-level candidates c = first, first + step, ...
+    void searchTop(int first, int step)
+    {
+        const int f = ctx.freqCount;
+        const int count = static_cast<int>(ctx.candidates[0].size());
+        
+        for (int c = first; c < count; c += step) {
+            if (stopRequested()) return;
+            const AbcdMatrix* m = &ctx.abcd[0][static_cast<size_t>(c) * f];
+            const long long combo = c * ctx.stride[0];
+            if (ctx.elementCount == 1) {
+                evaluateLeaf(m, combo);
+                continue;
+            }
+            for (int i = 0; i < f; ++i) {
+                z[1][i] = m[i].inputImpedance(z[0][i]);
+            }
+            search(1, combo);
+        }
+    }
+    
+    void evaluateLeaf(const AbcdMatrix* m, long long combo)
+    {
+        double worst = 0.0;
+        for (int i = 0; i < ctx.freqCount; ++i) {
+            worst = std::max(worst, mismatch2(m[i].inputImpedance(z[0][i]), ctx.sourceZ));
+        }
+        ++evaluated;
+        if (worst < bestGamma2 || (worst == bestGamma2 && combo < bestIndex)) {
+            bestGamma2 = worst;
+            bestIndex = combo;
+            ctx.lowerBound(worst);
+        }
+    }
+};
+
+} // namespace
+
+// PartCatalog
+
+PartCatalog PartCatalog::eSeries(ESeries series, double minValue, double maxValue)
+{
+    std::vector<double> base = baseValues(series);
+    std::vector<double> values;
+    
+    if (minValue <= 0.0 || maxValue < minValue) return PartCatalog();
+    
+    int firstDecade = static_cast<int>(std::floor(std::log10(minValue))) - 1;
+    int lastDecade = static_cast<int>(std::ceil(std::log10(maxValue)));
+    for (int decade = firstDecade; decade <= lastDecade; ++decade) {
+        double scale = std::pow(10.0, decade);
+        for (double b : base) {
+            double v = b * scale;
+            // Relative tolerance so range limits equal to a value are kept
+            if (v >= minValue * (1.0 - 1e-9) && v <= maxValue * (1.0 + 1e-9)) {
+                values.push_back(v);
+            }
+        }
+    }
+    return fromValues(std::move(values));
+}
+
+PartCatalog PartCatalog::fromValues(std::vector<double> values)
+{
+    values.erase(std::remove_if(values.begin(), values.end(),
+                                [](double v) { return !(v > 0.0) || !std::isfinite(v); }),
+                 values.end());
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end(),
+                             [](double a, double b) { return std::abs(a - b) <= 1e-9 * b; }),
+                 values.end());
+    
+    PartCatalog catalog;
+    catalog.m_values = std::move(values);
+    return catalog;
+}
+
+PartCatalog PartCatalog::inductors(ESeries series)
+{
+    return eSeries(series, 0.1e-9, 100e-6);
+}
+
+PartCatalog PartCatalog::capacitors(ESeries series)
+{
+    return eSeries(series, 0.1e-12, 10e-6);
+}
+
+QString PartCatalog::seriesName(ESeries series)
+{
+    switch (series) {
+        case ESeries::E6: return "E6";
+        case ESeries::E12: return "E12";
+        case ESeries::E24: return "E24";
+        case ESeries::E48: return "E48";
+        case ESeries::E96: return "E96";
+    }
+    return QString();
+}
+
+bool PartCatalog::parseVendorList(const QString& text, PartCatalog& inductors,
+                                  PartCatalog& capacitors, QString& error)
+{
+    static const QRegularExpression separators("[\\s,;]+");
+    static const QRegularExpression token(
+        "^([0-9]*\\.?[0-9]+(?:[eE][-+]?[0-9]+)?)(.?)([HhFf]?)$");
+    
+    std::vector<double> lValues;
+    std::vector<double> cValues;
+    int lineNumber = 0;
+    
+    for (QString line : text.split('\n')) {
+        ++lineNumber;
+        int comment = line.indexOf(QRegularExpression("[#!]"));
+        if (comment >= 0) line.truncate(comment);
+        
+        for (const QString& word : line.split(separators, Qt::SkipEmptyParts)) {
+            QRegularExpressionMatch match = token.match(word);
+            if (!match.hasMatch()) {
+                error = QString("Line %1: cannot read \"%2\"").arg(lineNumber).arg(word);
+                return false;
+            }
+            
+            double value = match.captured(1).toDouble();
+            QString prefix = match.captured(2);
+            QString unit = match.captured(3).toUpper();
+            
+            // "4.7nH" / "4.7n" / "4.7H" / "1f" (femto without a unit is ambiguous
+            // with farads; a lone trailing F or H is read as the unit)
+            if (!prefix.isEmpty()) {
+                QChar p = prefix[0];
+                if (unit.isEmpty() && (p == 'H' || p == 'h' || p == 'F' || p == 'f')) {
+                    unit = prefix.toUpper();
+                } else {
+                    bool ok;
+                    value *= siMultiplier(p, ok);
+                    if (!ok) {
+                        error = QString("Line %1: unknown prefix in \"%2\"").arg(lineNumber).arg(word);
+                        return false;
+                    }
+                }
+            }
+            
+            if (unit != "F") lValues.push_back(value);
+            if (unit != "H") cValues.push_back(value);
+        }
+    }
+    
+    inductors = fromValues(std::move(lValues));
+    capacitors = fromValues(std::move(cValues));
+    return true;
+}
+
+int PartCatalog::nearestIndex(double v) const
+{
+    if (m_values.empty() || !(v > 0.0)) return -1;
+    
+    auto it = std::lower_bound(m_values.begin(), m_values.end(), v);
+    if (it == m_values.end()) return size() - 1;
+    if (it == m_values.begin()) return 0;
+    
+    // Compare on a log scale (ratio), as the series are geometric
+    int hi = static_cast<int>(it - m_values.begin());
+    return (m_values[hi] / v < v / m_values[hi - 1]) ? hi : hi - 1;
+}
+
+std::vector<double> PartCatalog::neighbors(double v, int window) const
+{
+    std::vector<double> result;
+    int center = nearestIndex(v);
+    if (center < 0) return result;
+    
+    int lo = std::max(0, center - window);
+    int hi = std::min(size() - 1, center + window);
+    result.assign(m_values.begin() + lo, m_values.begin() + hi + 1);
+    
+    std::stable_sort(result.begin(), result.end(), [v](double a, double b) {
+        return std::abs(std::log(a / v)) < std::abs(std::log(b / v));
+    });
+    return result;
+}
+
+// StandardValueOptimizer
+
+StandardValueOptimizer::StandardValueOptimizer()
+    : m_bandwidth(0.1)
+    , m_bandPoints(21)
+    , m_window(3)
+    , m_z0(50.0)
+    , m_threadCount(0)
+{
+    setSeries(ESeries::E24);
+}
+
+void StandardValueOptimizer::setSeries(ESeries series)
+{
+    m_inductors = PartCatalog::inductors(series);
+    m_capacitors = PartCatalog::capacitors(series);
+}
+
+void StandardValueOptimizer::setBand(double fractionalBandwidth, int points)
+{
+    m_bandwidth = std::max(0.0, fractionalBandwidth);
+    m_bandPoints = std::max(1, points);
+}
+
+std::vector<double> StandardValueOptimizer::bandFrequencies(double center) const
+{
+    if (m_bandwidth <= 0.0 || m_bandPoints == 1) {
+        return std::vector<double>(1, center);
+    }
+    double half = 0.5 * m_bandwidth * center;
+    return FrequencySweep::linearFrequencies(std::max(center - half, center * 1e-3),
+                                             center + half, m_bandPoints);
+}
+
+StandardValueResult StandardValueOptimizer::optimize(const MatchingSolution& ideal,
+                                                     const std::function<bool()>& canceled) const
+{
+    StandardValueResult result;
+    if (!ideal.valid || ideal.elements.empty()) return result;
+    
+    FrequencySweep sweep;
+    sweep.setNetwork(ideal, m_z0);
+    const std::vector<SweepElement> elements = sweep.elements();
+    const std::vector<double> freqs = bandFrequencies(ideal.frequency);
+    
+    SearchContext ctx;
+    ctx.elementCount = static_cast<int>(elements.size());
+    ctx.freqCount = static_cast<int>(freqs.size());
+    ctx.sourceZ = ideal.sourceZ;
+    ctx.canceled = canceled;
+    
+    // Candidate values, nearest to the ideal first
+    result.combinations = 1;
+    for (const SweepElement& e : elements) {
+        std::vector<double> values;
+        if (e.type == ComponentType::Inductor) {
+            values = m_inductors.neighbors(e.value, m_window);
+        } else if (e.type == ComponentType::Capacitor) {
+            values = m_capacitors.neighbors(e.value, m_window);
+        }
+        if (values.empty()) values.push_back(e.value);
+        result.combinations *= static_cast<long long>(values.size());
+        ctx.candidates.push_back(std::move(values));
+    }
+    
+    ctx.stride.assign(ctx.elementCount, 1);
+    for (int p = ctx.elementCount - 2; p >= 0; --p) {
+        ctx.stride[p] = ctx.stride[p + 1] * static_cast<long long>(ctx.candidates[p + 1].size());
+    }
+    
+    // Element matrices for every candidate and frequency
+    ctx.abcd.resize(ctx.elementCount);
+    for (int p = 0; p < ctx.elementCount; ++p) {
+        SweepElement e = elements[p];
+        ctx.abcd[p].resize(ctx.candidates[p].size() * freqs.size());
+        for (size_t c = 0; c < ctx.candidates[p].size(); ++c) {
+            e.value = ctx.candidates[p][c];
+            for (int i = 0; i < ctx.freqCount; ++i) {
+                ctx.abcd[p][c * freqs.size() + i] = FrequencySweep::elementAbcd(e, freqs[i]);
+            }
+        }
+    }
+    
+    // Ideal network: reference result and worst-first frequency order
+    std::vector<double> idealGamma2(freqs.size());
+    double idealWorst = 0.0;
+    for (int i = 0; i < ctx.freqCount; ++i) {
+        Complex z = ideal.loadZ;
+        for (const SweepElement& e : elements) {
+            z = FrequencySweep::elementAbcd(e, freqs[i]).inputImpedance(z);
+        }
+        idealGamma2[i] = mismatch2(z, ideal.sourceZ);
+        idealWorst = std::max(idealWorst, idealGamma2[i]);
+    }
+    result.idealWorstReturnLoss = SmithMath::gammaToReturnLoss(Complex(std::sqrt(idealWorst), 0.0));
+    
+    ctx.freqOrder.resize(freqs.size());
+    for (int i = 0; i < ctx.freqCount; ++i) ctx.freqOrder[i] = i;
+    std::sort(ctx.freqOrder.begin(), ctx.freqOrder.end(),
+              [&idealGamma2](int a, int b) { return idealGamma2[a] > idealGamma2[b]; });
+    
+    // Seed the bound with the plain snapped network (combination 0)
+    {
+        double worst = 0.0;
+        for (int i = 0; i < ctx.freqCount; ++i) {
+            Complex z = ideal.loadZ;
+            for (int p = 0; p < ctx.elementCount; ++p) {
+                z = ctx.abcd[p][i].inputImpedance(z);
+            }
+            worst = std::max(worst, mismatch2(z, ideal.sourceZ));
+        }
+        ctx.bound.store(worst);
+    }
+    
+    // Split the first element's candidates across the workers
+    const int topCount = static_cast<int>(ctx.candidates[0].size());
+    const int threads = std::max(1, std::min(topCount,
+        Parallel::workerCount(m_threadCount, result.combinations, MIN_COMBINATIONS_PER_THREAD)));
+    
+    std::vector<SearchWorker> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(ctx, ideal.loadZ);
+    }
+    
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back([&workers, t, threads]() { workers[t].searchTop(t, threads); });
+    }
+    workers[0].searchTop(0, threads);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    if (ctx.stopped.load()) return result;
+    
+    // Lowest worst case wins; ties go to the combination closest to ideal
+    const SearchWorker* best = nullptr;
+    for (const SearchWorker& w : workers) {
+        result.evaluated += w.evaluated;
+        if (w.bestIndex < 0) continue;
+        if (!best || w.bestGamma2 < best->bestGamma2 ||
+            (w.bestGamma2 == best->bestGamma2 && w.bestIndex < best->bestIndex)) {
+            best = &w;
+        }
+    }
+    if (!best) return result;
+    
+    result.solution = ideal;
+    long long index = best->bestIndex;
+    for (int p = 0; p < ctx.elementCount; ++p) {
+        int c = static_cast<int>(index / ctx.stride[p]);
+        index %= ctx.stride[p];
+        MatchingElement& elem = result.solution.elements[p];
+        if (elem.type == ComponentType::Inductor || elem.type == ComponentType::Capacitor) {
+            elem.value = ctx.candidates[p][c];
+        }
+    }
+    
+    result.worstGamma = std::sqrt(best->bestGamma2);
+    result.worstReturnLoss = SmithMath::gammaToReturnLoss(Complex(result.worstGamma, 0.0));
+    result.valid = true;
+    return result;
+}
+
+} // namespace SmithTool
@@ -0,0 +1,182 @@
+/**
+ * @file standardvalues.h
+ * @brief Snapping matching networks to purchasable component values
+ *
+ * Ideal L/Pi/T solutions are rounded to an E-series (IEC 60063) or to a
+ * vendor part list, then the neighbouring value combinations are searched
+ * for the lowest worst-case reflection over a frequency band.
+ */
+
+#ifndef SMITHTOOL_STANDARDVALUES_H
+#define SMITHTOOL_STANDARDVALUES_H
+
+#include <complex>
+#include <functional>
+#include <vector>
+#include <QString>
+#include "matching.h"
+
+namespace SmithTool {
+
+using Complex = std::complex<double>;
+
+/**
+ * @brief Preferred-number series
+ */
+enum class ESeries {
+    E6,
+    E12,
+    E24,
+    E48,
+    E96
+};
+
+/**
+ * @brief Sorted set of available values for one component type
+ */
+class PartCatalog {
+public:
+    PartCatalog() = default;
+    
+    /**
+     * @brief All decades of an E-series between minValue and maxValue
+     */
+    static PartCatalog eSeries(ESeries series, double minValue, double maxValue);
+    
+    /**
+     * @brief Catalog from arbitrary values (sorted, duplicates and
+     *        non-positive values removed)
+     */
+    static PartCatalog fromValues(std::vector<double> values);
+    
+    /**
+     * @brief Default E-series catalogs for inductors (0.1 nH - 100 µH)
+     *        and capacitors (0.1 pF - 10 µF)
+     */
+    static PartCatalog inductors(ESeries series);
+    static PartCatalog capacitors(ESeries series);
+    
+    /**
+     * @brief Parse a vendor part list
+     *
+     * Values are separated by whitespace, commas or semicolons and may
+     * carry an SI prefix and unit without a space ("4.7nH", "2.2p",
+     * "1.5e-9").
+     * Values ending in H go to inductors, values ending in F to capacitors,
+     * unit-less values to both. Text after '#' or '!' is a comment.
+     *
+     * @return false (with error set) on an unparsable token
+     */
+    static bool parseVendorList(const QString& text, PartCatalog& inductors,
+                                PartCatalog& capacitors, QString& error);
+    
+    static QString seriesName(ESeries series);
+    
+    bool isEmpty() const { return m_values.empty(); }
+    int size() const { return static_cast<int>(m_values.size()); }
+    const std::vector<double>& values() const { return m_values; }
+    
+    /**
+     * @brief Index of the value closest to v on a log scale (-1 if empty)
+     */
+    int nearestIndex(double v) const;
+    
+    /**
+     * @brief Catalog values within ±window steps of the nearest value,
+     *        ordered by distance from v
+     */
+    std::vector<double> neighbors(double v, int window) const;
+
+private:
+    std::vector<double> m_values;   // Ascending
+};
+
+/**
+ * @brief Outcome of snapping one solution to catalog values
+ */
+struct StandardValueResult {
+    MatchingSolution solution;      // Catalog values
+    double worstGamma;              // Max |Gamma| over the band
+    double worstReturnLoss;         // dB, negative (as gammaToReturnLoss)
+    double idealWorstReturnLoss;    // Same for the ideal values
+    long long combinations;         // Size of the search space
+    long long evaluated;            // Combinations evaluated to the end
+    bool valid;
+    
+    StandardValueResult()
+        : worstGamma(1.0), worstReturnLoss(0.0), idealWorstReturnLoss(0.0)
+        , combinations(0), evaluated(0), valid(false) {}
+};
+
+/**
+ * @brief Branch-and-bound search over neighbouring catalog values
+ *
+ * The network is evaluated element by element from the load, caching the
+ * partial impedance at every band frequency, so every leaf only costs its
+ * last element. The best worst-case |Gamma| found so far (shared by all
+ * worker threads) bounds the search: a combination is dropped at the
+ * first frequency where it is already worse, and frequencies are visited
+ * worst-first so that happens early.
+ */
+class StandardValueOptimizer {
+public:
+    StandardValueOptimizer();
+    
+    void setInductorCatalog(const PartCatalog& catalog) { m_inductors = catalog; }
+    void setCapacitorCatalog(const PartCatalog& catalog) { m_capacitors = catalog; }
+    void setSeries(ESeries series);
+    
+    /**
+     * @brief Band to optimize over
+     * @param fractionalBandwidth Total width relative to the design
+     *                            frequency (0.1 = ±5 %); 0 = single point
+     * @param points Frequencies across the band
+     */
+    void setBand(double fractionalBandwidth, int points = 21);
+    double fractionalBandwidth() const { return m_bandwidth; }
+    
+    /**
+     * @brief Catalog steps searched on each side of the snapped value
+     */
+    void setSearchWindow(int steps) { m_window = steps; }
+    int searchWindow() const { return m_window; }
+    
+    void setZ0(double z0) { m_z0 = z0; }
+    
+    /**
+     * @brief Limit the number of worker threads (0 = hardware threads)
+     */
+    void setThreadCount(int count) { m_threadCount = count; }
+    
+    /**
+     * @brief Snap one ideal solution
+     *
+     * Inductors and capacitors are replaced by catalog values; resistors,
+     * lines and stubs are kept. Reflection is taken against the source
+     * impedance, (Zin - Zs*) / (Zin + Zs).
+     *
+     * @param canceled Polled from the search threads while it runs; once
+     *                 it returns true the search stops and an invalid
+     *                 result is returned (null = never canceled)
+     */
+    StandardValueResult optimize(const MatchingSolution& ideal,
+                                 const std::function<bool()>& canceled = nullptr) const;
+
+private:
+    PartCatalog m_inductors;
+    PartCatalog m_capacitors;
+    double m_bandwidth;
+    int m_bandPoints;
+    int m_window;
+    double m_z0;
+    int m_threadCount;
+    
+    // Smaller searches run on the calling thread
+    static constexpr long long MIN_COMBINATIONS_PER_THREAD = 4096;
+    
+    std::vector<double> bandFrequencies(double center) const;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_STANDARDVALUES_H
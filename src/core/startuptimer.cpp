@@ -0,0 +1,84 @@
+/**
+ * @file startuptimer.cpp
+ * @brief Wall-clock phases of application startup
+ */
+
+#include "startuptimer.h"
+#include "profiler.h"
+
+namespace SmithTool {
+
+namespace {
+
+struct State {
+    long long startNs = 0;
+    long long lastNs = 0;
+    bool running = false;
+    bool finished = false;
+    std::vector<StartupTimer::Phase> phases;
+};
+
+State& state()
+{
+    static State s_state;
+    return s_state;
+}
+
+} // namespace
+
+void StartupTimer::start()
+{
+    State& s = state();
+    s.startNs = Profiler::nowNs();
+    s.lastNs = s.startNs;
+    s.running = true;
+    s.finished = false;
+    s.phases.clear();
+}
+
+void StartupTimer::mark(const char* phase)
+{
+    State& s = state();
+    if (!s.running || s.finished) return;
+    
+    const long long now = Profiler::nowNs();
+    s.phases.push_back({phase, (now - s.lastNs) / 1e6});
+    if (Profiler::isEnabled()) {
+        Profiler::record(phase, s.lastNs, now - s.lastNs);
+    }
+    s.lastNs = now;
+}
+
+void StartupTimer::finish(const char* phase)
+{
+    mark(phase);
+    state().finished = true;
+}
+
+bool StartupTimer::isFinished()
+{
+    return state().finished;
+}
+
+double StartupTimer::totalMs()
+{
+    const State& s = state();
+    return (s.lastNs - s.startNs) / 1e6;
+}
+
+std::vector<StartupTimer::Phase> StartupTimer::phases()
+{
+    return state().phases;
+}
+
+QString StartupTimer::report()
+{
+    QString text;
+    for (const Phase& phase : state().phases) {
+        text += QString("%1 %2 ms\n").arg(QString(phase.name), -24).arg(phase.ms, 8, 'f', 1);
+    }
+    text += QString("%1 %2 ms\n").arg(QString("total"), -24).arg(totalMs(), 8, 'f', 1);
+    return text;
+}
+
+} // namespace SmithTool
@@ -0,0 +1,48 @@
+/**
+ * @file startuptimer.h
+ * @brief Wall-clock phases of application startup
+ */
+
+#ifndef SMITHTOOL_STARTUPTIMER_H
+#define SMITHTOOL_STARTUPTIMER_H
+
+#include <QString>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief Startup phase timer, from main() to the first painted frame
+ *
+ * main() starts the clock and each mark() closes the phase that ran
+ * since the previous one. finish() closes the last phase and freezes
+ * the report. Phases are also recorded in the Profiler when it is
+ * enabled. GUI thread only; phase names must be string literals.
+ */
+class StartupTimer {
+public:
+    struct Phase {
+        const char* name;
+        double ms;              // Duration of the phase
+    };
+    
+    static void start();
+    static void mark(const char* phase);
+    static void finish(const char* phase);
+    
+    static bool isFinished();
+    
+    // Time from start() to the last mark (the first paint once finished)
+    static double totalMs();
+    
+    static std::vector<Phase> phases();
+    
+    /**
+     * @brief One line per phase and the total, e.g. for --startup-report
+     */
+    static QString report();
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_STARTUPTIMER_H
@@ -0,0 +1,213 @@
+/**
+ * @file sweep.cpp
+ * @brief Frequency-sweep evaluation implementation
+ */
+
+#include "sweep.h"
+#include "trace.h"
+#include "matching.h"
+#include "smithmath.h"
+#include "parallel.h"
+#include <algorithm>
+
+namespace SmithTool {
+
+namespace {
+
+AbcdMatrix seriesImpedance(const Complex& z)
+{
+    return AbcdMatrix(Complex(1, 0), z, Complex(0, 0), Complex(1, 0));
+}
+
+AbcdMatrix shuntAdmittance(const Complex& y)
+{
+    return AbcdMatrix(Complex(1, 0), Complex(0, 0), y, Complex(1, 0));
+}
+
+} // namespace
+
+FrequencySweep::FrequencySweep()
+    : m_loadZ(50.0, 0.0)
+    , m_z0(50.0)
+    , m_threadCount(0)
+{
+}
+
+void FrequencySweep::setNetwork(const MatchingTrace& trace)
+{
+    m_elements.clear();
+    m_loadZ = trace.loadImpedance();
+    m_z0 = trace.z0();
+    
+    for (int i = 0; i < trace.numSegments(); ++i) {
+        const TraceSegment& seg = trace.segment(i);
+        if (seg.componentType == ComponentType::None) continue;
+        SweepElement e(seg.componentType, seg.connectionType, seg.componentValue);
+        if (MatchingTrace::isDistributed(seg.componentType)) {
+            // Trace lines and stubs are z0 lines, valued by length
+            e.lineZ0 = trace.z0();
+            e.length = seg.componentValue;
+        }
+        m_elements.push_back(e);
+    }
+}
+
+void FrequencySweep::setNetwork(const MatchingSolution& solution, double z0)
+{
+    m_elements.clear();
+    m_loadZ = solution.loadZ;
+    m_z0 = z0;
+    
+    for (const MatchingElement& elem : solution.elements) {
+        SweepElement e(elem.type, elem.connection, elem.value);
+        
+        if (elem.type == ComponentType::TransmissionLine ||
+            elem.type == ComponentType::OpenStub ||
+            elem.type == ComponentType::ShortStub) {
+            if (solution.topology == MatchingTopology::QuarterWave &&
+                elem.type == ComponentType::TransmissionLine) {
+                // Quarter-wave sections store their impedance; length is λ/4
+                e.lineZ0 = elem.value;
+                e.length = SmithMath::SPEED_OF_LIGHT / solution.frequency / 4.0;
+            } else {
+                // Stub solutions store the length in meters
+                e.lineZ0 = z0;
+                e.length = elem.value;
+            }
+        }
+        m_elements.push_back(e);
+    }
+}
+
+AbcdMatrix FrequencySweep::elementAbcd(const SweepElement& element, double freq)
+{
+    const double omega = 2.0 * SmithMath::PI * freq;
+    const double value = element.value;
+    const bool series = (element.connection == ConnectionType::Series);
+    
+    switch (element.type) {
+        case ComponentType::Resistor:
+            if (series) return seriesImpedance(Complex(value, 0.0));
+            return (value > 1e-12) ? shuntAdmittance(Complex(1.0 / value, 0.0)) : AbcdMatrix();
+        
+        case ComponentType::Inductor:
+            if (series) return seriesImpedance(Complex(0.0, omega * value));
+            return (value > 1e-18) ? shuntAdmittance(Complex(0.0, -1.0 / (omega * value))) : AbcdMatrix();
+        
+        case ComponentType::Capacitor:
+            if (series) {
+                return (value > 1e-18) ? seriesImpedance(Complex(0.0, -1.0 / (omega * value))) : AbcdMatrix();
+            }
+            return shuntAdmittance(Complex(0.0, omega * value));
+        
+        case ComponentType::TransmissionLine: {
+            double theta = omega * element.length / SmithMath::SPEED_OF_LIGHT;
+            double zc = element.lineZ0;
+            double c = std::cos(theta);
+            double s = std::sin(theta);
+            return AbcdMatrix(Complex(c, 0.0), Complex(0.0, zc * s),
+                              Complex(0.0, s / zc), Complex(c, 0.0));
+        }
+        
+        case ComponentType::OpenStub: {
+            // Input impedance of an open stub: -j Zc cot(θ)
+            double theta = omega * element.length / SmithMath::SPEED_OF_LIGHT;
+            double t = SmithMath::safeDivisor(std::tan(theta));
+            if (series) return seriesImpedance(Complex(0.0, -element.lineZ0 / t));
+            return shuntAdmittance(Complex(0.0, t / element.lineZ0));
+        }
+        
+        case ComponentType::ShortStub: {
+            // Input impedance of a shorted stub: j Zc tan(θ)
+            double theta = omega * element.length / SmithMath::SPEED_OF_LIGHT;
+            double t = SmithMath::safeDivisor(std::tan(theta));
+            if (series) return seriesImpedance(Complex(0.0, element.lineZ0 * t));
+            return shuntAdmittance(Complex(0.0, -1.0 / (element.lineZ0 * t)));
+        }
+        
+        default:
+            return AbcdMatrix();
+    }
+}
+
+AbcdMatrix FrequencySweep::networkAbcd(double freq) const
+{
+    // Chain from the source side: the last element is nearest the source
+    AbcdMatrix total;
+    for (auto it = m_elements.rbegin(); it != m_elements.rend(); ++it) {
+        total = total * elementAbcd(*it, freq);
+    }
+    return total;
+}
+
+void FrequencySweep::evaluateRange(SweepResult& result, const Complex* loads,
+                                   int begin, int end) const
+{
+    for (int i = begin; i < end; ++i) {
+        const Complex& zl = loads ? loads[i] : m_loadZ;
+        result.inputImpedance[i] = networkAbcd(result.frequencies[i]).inputImpedance(zl);
+    }
+    
+    // Derived quantities for the whole range at once
+    const std::size_t count = static_cast<std::size_t>(end - begin);
+    SmithMath::impedanceToGamma(result.inputImpedance.data() + begin,
+                                result.gamma.data() + begin, count, m_z0);
+    SmithMath::gammaToVSWR(result.gamma.data() + begin, result.vswr.data() + begin, count);
+    for (int i = begin; i < end; ++i) {
+        result.returnLoss[i] = SmithMath::gammaToReturnLoss(result.gamma[i]);
+    }
+}
+
+SweepResult FrequencySweep::run(const std::vector<double>& frequencies) const
+{
+    return runWithLoads(frequencies, nullptr);
+}
+
+SweepResult FrequencySweep::run(const std::vector<double>& frequencies,
+                                const std::vector<Complex>& loads) const
+{
+    if (loads.size() != frequencies.size()) {
+        return SweepResult();
+    }
+    return runWithLoads(frequencies, loads.data());
+}
+
+SweepResult FrequencySweep::runWithLoads(const std::vector<double>& frequencies,
+                                         const Complex* loads) const
+{
+    SweepResult result;
+    result.frequencies = frequencies;
+    
+    const int n = static_cast<int>(frequencies.size());
+    result.inputImpedance.resize(n);
+    result.gamma.resize(n);
+    result.vswr.resize(n);
+    result.returnLoss.resize(n);
+    
+    // Each worker fills its own contiguous slice; no shared writes
+    const int threads = Parallel::workerCount(m_threadCount, n, MIN_POINTS_PER_THREAD);
+    Parallel::parallelRanges(n, threads, [&](int begin, int end) {
+        evaluateRange(result, loads, begin, end);
+    });
+    return result;
+}
+
+std::vector<double> FrequencySweep::linearFrequencies(double start, double stop, int count)
+{
+    std::vector<double> freqs;
+    if (count <= 0) return freqs;
+    
+    freqs.resize(count);
+    if (count == 1) {
+        freqs[0] = start;
+        return freqs;
+    }
+    
+    double step = (stop - start) / (count - 1);
+    for (int i = 0; i < count; ++i) {
+        freqs[i] = start + step * i;
+    }
+    return freqs;
+}
+
+} // namespace SmithTool
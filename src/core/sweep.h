@@ -0,0 +1,180 @@
+/**
+ * @file sweep.h
+ * @brief Frequency-sweep evaluation of matching networks
+ *
+ * Evaluates a matching network over a frequency vector using ABCD
+ * cascade math and reports input impedance, Gamma, VSWR and return loss
+ * at every frequency.
+ */
+
+#ifndef SMITHTOOL_SWEEP_H
+#define SMITHTOOL_SWEEP_H
+
+#include <complex>
+#include <vector>
+#include "component.h"
+
+namespace SmithTool {
+
+using Complex = std::complex<double>;
+
+class MatchingTrace;
+struct MatchingSolution;
+
+/**
+ * @brief One element of a network to sweep
+ *
+ * Lumped elements use value in base units (ohms/henries/farads).
+ * Transmission lines and stubs use lineZ0 and length (meters, free-space
+ * propagation).
+ */
+struct SweepElement {
+    ComponentType type;
+    ConnectionType connection;
+    double value;
+    double lineZ0;
+    double length;
+    
+    SweepElement()
+        : type(ComponentType::None)
+        , connection(ConnectionType::Series)
+        , value(0.0)
+        , lineZ0(50.0)
+        , length(0.0) {}
+    
+    SweepElement(ComponentType t, ConnectionType c, double v)
+        : type(t), connection(c), value(v), lineZ0(50.0), length(0.0) {}
+};
+
+/**
+ * @brief ABCD (chain) matrix of a two-port
+ */
+struct AbcdMatrix {
+    Complex a, b, c, d;
+    
+    AbcdMatrix() : a(1, 0), b(0, 0), c(0, 0), d(1, 0) {}
+    AbcdMatrix(const Complex& a_, const Complex& b_, const Complex& c_, const Complex& d_)
+        : a(a_), b(b_), c(c_), d(d_) {}
+    
+    AbcdMatrix operator*(const AbcdMatrix& m) const {
+        return AbcdMatrix(a * m.a + b * m.c, a * m.b + b * m.d,
+                          c * m.a + d * m.c, c * m.b + d * m.d);
+    }
+    
+    // Input impedance with the output terminated in zl
+    Complex inputImpedance(const Complex& zl) const {
+        return (a * zl + b) / (c * zl + d);
+    }
+};
+
+/**
+ * @brief Result of a frequency sweep (one entry per frequency)
+ */
+struct SweepResult {
+    std::vector<double> frequencies;
+    std::vector<Complex> inputImpedance;
+    std::vector<Complex> gamma;         // Referenced to the sweep Z0
+    std::vector<double> vswr;
+    std::vector<double> returnLoss;     // dB (negative, as gammaToReturnLoss)
+    
+    int size() const { return static_cast<int>(frequencies.size()); }
+    bool isEmpty() const { return frequencies.empty(); }
+};
+
+/**
+ * @brief Frequency-sweep engine
+ *
+ * Elements are ordered from the load towards the source, as in
+ * MatchingTrace and MatchingSolution. Large sweeps are split across
+ * worker threads.
+ */
+class FrequencySweep {
+public:
+    FrequencySweep();
+    ~FrequencySweep() = default;
+    
+    // Network
+    void setElements(const std::vector<SweepElement>& elements) { m_elements = elements; }
+    const std::vector<SweepElement>& elements() const { return m_elements; }
+    
+    /**
+     * @brief Take elements, load and Z0 from a matching trace
+     */
+    void setNetwork(const MatchingTrace& trace);
+    
+    /**
+     * @brief Take elements and load from a matching solution
+     * @param solution Matching solution
+     * @param z0 Reference impedance of the chart and of the lines
+     */
+    void setNetwork(const MatchingSolution& solution, double z0);
+    
+    void setLoadImpedance(const Complex& zl) { m_loadZ = zl; }
+    Complex loadImpedance() const { return m_loadZ; }
+    
+    void setZ0(double z0) { m_z0 = z0; }
+    double z0() const { return m_z0; }
+    
+    /**
+     * @brief Limit the number of worker threads
+     * @param count Thread count (0 = one per hardware thread)
+     */
+    void setThreadCount(int count) { m_threadCount = count; }
+    int threadCount() const { return m_threadCount; }
+    
+    /**
+     * @brief Evaluate the network at every frequency
+     * @param frequencies Frequencies in Hz
+     * @return Sweep result
+     */
+    SweepResult run(const std::vector<double>& frequencies) const;
+    
+    /**
+     * @brief Evaluate the network against a frequency-dependent load
+     * 
+     * Used for measured loads (e.g. S11 of an antenna converted to
+     * impedance), so the network transforms every measured point.
+     * 
+     * @param frequencies Frequencies in Hz
+     * @param loads Load impedance at each frequency (same size)
+     * @return Sweep result (empty if the sizes differ)
+     */
+    SweepResult run(const std::vector<double>& frequencies,
+                    const std::vector<Complex>& loads) const;
+    
+    /**
+     * @brief ABCD matrix of the whole network at one frequency
+     */
+    AbcdMatrix networkAbcd(double freq) const;
+    
+    /**
+     * @brief ABCD matrix of a single element at one frequency
+     */
+    static AbcdMatrix elementAbcd(const SweepElement& element, double freq);
+    
+    /**
+     * @brief Evenly spaced frequency vector
+     * @param start First frequency (Hz)
+     * @param stop Last frequency (Hz)
+     * @param count Number of points
+     */
+    static std::vector<double> linearFrequencies(double start, double stop, int count);
+
+private:
+    std::vector<SweepElement> m_elements;
+    Complex m_loadZ;
+    double m_z0;
+    int m_threadCount;
+    
+    // Minimum points per worker thread; smaller sweeps run inline
+    static constexpr int MIN_POINTS_PER_THREAD = 1024;
+    
+    SweepResult runWithLoads(const std::vector<double>& frequencies,
+                             const Complex* loads) const;
+    void evaluateRange(SweepResult& result, const Complex* loads,
+                       int begin, int end) const;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_SWEEP_H
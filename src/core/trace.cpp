@@ -4,11 +4,24 @@
  */
 
 #include "trace.h"
+#include "profiler.h"
 #include "smithmath.h"
+#include <algorithm>
 #include <cmath>
 
 namespace SmithTool {
 
+namespace {
+
+// angle + k * period closest to reference, kept positive
+double nearestPeriod(double angle, double period, double reference)
+{
+    double result = angle + std::round((reference - angle) / period) * period;
+    return (result > 0.0) ? result : result + period;
+}
+
+} // namespace
+
 // Color palette for trace segments
 const std::vector<QColor> MatchingTrace::s_colors = {
     QColor(0, 100, 200),    // Blue
@@ -21,12 +34,144 @@ const std::vector<QColor> MatchingTrace::s_colors = {
     QColor(100, 100, 100)   // Gray
 };
 
+void TracePointArena::truncate(int size)
+{
+    // resize() never shrinks the capacity
+    m_real.resize(size);
+    m_imag.resize(size);
+}
+
+int TracePointArena::append(int count)
+{
+    int offset = size();
+    m_real.resize(offset + count);
+    m_imag.resize(offset + count);
+    return offset;
+}
+
+std::size_t TracePointArena::memoryBytes() const
+{
+    return (m_real.capacity() + m_imag.capacity()) * sizeof(double);
+}
+
+Complex TracePointView::impedance(int index) const
+{
+    return SmithMath::gammaToImpedance(gamma(index), m_arena->z0());
+}
+
+TracePoint TracePointView::operator[](int index) const
+{
+    Complex g = gamma(index);
+    return TracePoint(g, SmithMath::gammaToImpedance(g, m_arena->z0()), m_arena->frequency());
+}
+
+bool TraceSegment::arcGeometry(double z0, Complex& center, double& radius,
+                               double& startAngle, double& sweepAngle) const
+{
+    // Circles with a radius this large are practically straight lines
+    const double maxRadius = 50.0;
+    
+    Complex zn = startImpedance / z0;
+    Complex yn = Complex(1.0, 0.0) / zn;
+    Complex singular;   // Point the circle family converges to
+    
+    if (type == TraceType::ConstantVSWR) {
+        // Toward the generator: clockwise by twice the electrical length
+        Complex g0 = SmithMath::normalizedZToGamma(zn);
+        center = Complex(0.0, 0.0);
+        radius = std::abs(g0);
+        if (!(radius > 0.0) || radius > maxRadius) return false;
+        startAngle = std::arg(g0);
+        sweepAngle = -2.0 * electricalLength;
+        return true;
+    }
+    
+    switch (type) {
+        case TraceType::ConstantR:
+            center = SmithMath::constantRCircleCenter(zn.real());
+            radius = SmithMath::constantRCircleRadius(zn.real());
+            singular = Complex(1.0, 0.0);
+            break;
+        case TraceType::ConstantX:
+            if (std::abs(zn.imag()) < 1.0 / maxRadius) return false;
+            center = SmithMath::constantXArcCenter(zn.imag());
+            radius = SmithMath::constantXArcRadius(zn.imag());
+            singular = Complex(1.0, 0.0);
+            break;
+        case TraceType::ConstantG:
+            // Admittance circles are impedance circles rotated by 180°
+            center = -SmithMath::constantRCircleCenter(yn.real());
+            radius = SmithMath::constantRCircleRadius(yn.real());
+            singular = Complex(-1.0, 0.0);
+            break;
+        case TraceType::ConstantB:
+            if (std::abs(yn.imag()) < 1.0 / maxRadius) return false;
+            center = -SmithMath::constantXArcCenter(yn.imag());
+            radius = SmithMath::constantXArcRadius(yn.imag());
+            singular = Complex(-1.0, 0.0);
+            break;
+        default:
+            return false;
+    }
+    
+    if (!(radius > 0.0) || radius > maxRadius) return false;
+    
+    Complex g0 = SmithMath::normalizedZToGamma(zn);
+    Complex g1 = SmithMath::normalizedZToGamma(endImpedance / z0);
+    
+    // Angles relative to the singular point lie in (0, 2π), so their
+    // difference is the sweep that does not cross it
+    double ref = std::arg(singular - center);
+    auto relAngle = [&](const Complex& g) {
+        double a = std::arg(g - center) - ref;
+        while (a <= 0.0) a += SmithMath::TWO_PI;
+        while (a > SmithMath::TWO_PI) a -= SmithMath::TWO_PI;
+        return a;
+    };
+    
+    startAngle = std::arg(g0 - center);
+    sweepAngle = relAngle(g1) - relAngle(g0);
+    return true;
+}
+
 MatchingTrace::MatchingTrace()
     : m_sourceZ(50.0, 0.0)
     , m_loadZ(50.0, 0.0)
     , m_z0(50.0)
     , m_frequency(1e9)
+    , m_firstStaleSegment(0)
+{
+}
+
+MatchingTrace::MatchingTrace(const MatchingTrace& other)
+    : m_sourceZ(other.m_sourceZ)
+    , m_loadZ(other.m_loadZ)
+    , m_z0(other.m_z0)
+    , m_frequency(other.m_frequency)
+    , m_segments(other.m_segments)
+    , m_firstStaleSegment(other.m_firstStaleSegment)
+    , m_points(other.m_points)
 {
+    for (TraceSegment& seg : m_segments) {
+        seg.points.rebind(&m_points);
+    }
+}
+
+MatchingTrace& MatchingTrace::operator=(const MatchingTrace& other)
+{
+    if (this != &other) {
+        m_sourceZ = other.m_sourceZ;
+        m_loadZ = other.m_loadZ;
+        m_z0 = other.m_z0;
+        m_frequency = other.m_frequency;
+        m_segments = other.m_segments;
+        m_firstStaleSegment = other.m_firstStaleSegment;
+        m_points = other.m_points;
+        for (TraceSegment& seg : m_segments) {
+            seg.points.rebind(&m_points);
+        }
+    }
+    return *this;
 }
 
 void MatchingTrace::setSourceImpedance(const Complex& zs)
@@ -41,17 +186,32 @@ void MatchingTrace::setLoadImpedance(const Complex& zl)
 
 void MatchingTrace::setZ0(double z0)
 {
-    m_z0 = z0;
+    if (z0 != m_z0) {
+        m_z0 = z0;
+        markStale(0);  // Gamma of every point depends on z0
+        recalculate(0);  // Lines and stubs are z0 lines
+    }
 }
 
 void MatchingTrace::setFrequency(double freq)
 {
-    m_frequency = freq;
+    if (freq != m_frequency) {
+        m_frequency = freq;
+        m_points.setFrequency(freq);
+        for (TraceSegment& seg : m_segments) {
+            seg.label = segmentLabel(seg);  // Lines show their electrical length
+        }
+        markStale(0);  // Every reactance depends on the frequency
+        recalculate(0);
+    }
 }
 
 void MatchingTrace::addSegment(const TraceSegment& segment)
 {
+    // Points of a segment built elsewhere live in no arena of ours
     m_segments.push_back(segment);
+    m_segments.back().points = TracePointView();
+    markStale(numSegments() - 1);
 }
 
 void MatchingTrace::removeLastSegment()
@@ -61,9 +221,38 @@ void MatchingTrace::removeLastSegment()
     }
 }
 
+void MatchingTrace::insertElement(int index, ComponentType type, ConnectionType conn, double value,
+                                  const QColor& color)
+{
+    index = std::clamp(index, 0, numSegments());
+    
+    TraceSegment seg;
+    seg.componentType = type;
+    seg.connectionType = conn;
+    seg.componentValue = value;
+    seg.color = color.isValid() ? color : nextColor();
+    seg.type = traceTypeFor(type, conn);
+    seg.label = segmentLabel(seg);
+    m_segments.insert(m_segments.begin() + index, seg);
+    
+    recalculate(index);
+}
+
+void MatchingTrace::removeSegment(int index)
+{
+    if (index < 0 || index >= numSegments()) {
+        return;
+    }
+    
+    m_segments.erase(m_segments.begin() + index);
+    recalculate(index);
+}
+
 void MatchingTrace::clear()
 {
     m_segments.clear();
+    m_points.clear();
+    m_firstStaleSegment = 0;
 }
 
 const TraceSegment& MatchingTrace::segment(int index) const
@@ -72,6 +261,7 @@ const TraceSegment& MatchingTrace::segment(int index) const
     if (index < 0 || index >= static_cast<int>(m_segments.size())) {
         return empty;
     }
+    ensurePoints();
     return m_segments[index];
 }
 
@@ -81,156 +271,121 @@ TraceSegment& MatchingTrace::segmentRef(int index)
     if (index < 0 || index >= static_cast<int>(m_segments.size())) {
         return empty;
     }
+    ensurePoints();
     return m_segments[index];
 }
 
+const std::vector<TraceSegment>& MatchingTrace::segments() const
+{
+    ensurePoints();
+    return m_segments;
+}
+
 void MatchingTrace::updateSegmentValue(int index, double newValue)
 {
+    SMITHTOOL_PROFILE_SCOPE("MatchingTrace::updateSegmentValue");
+    
     if (index < 0 || index >= static_cast<int>(m_segments.size())) {
         return;
     }
     
     TraceSegment& seg = m_segments[index];
     seg.componentValue = newValue;
+    seg.label = segmentLabel(seg);
     
-    // Get the starting impedance for this segment
-    Complex startZ;
-    if (index == 0) {
-        startZ = m_loadZ;
-    } else {
-        startZ = m_segments[index - 1].endPoint().impedance;
-    }
+    recalculate(index);
+}
+
+double MatchingTrace::lineLengthFor(int index, const Complex& targetZ) const
+{
+    if (index < 0 || index >= numSegments()) return 0.0;
     
-    // Recalculate the points for this segment
-    if (seg.connectionType == ConnectionType::Series) {
-        switch (seg.componentType) {
-            case ComponentType::Inductor:
-                {
-                    double deltaX = 2.0 * SmithMath::PI * m_frequency * newValue;
-                    seg.label = QString("L = %1").arg(newValue * 1e9, 0, 'f', 2) + " nH";
-                    seg.points = generateConstantRArc(startZ, deltaX);
-                }
-                break;
-            case ComponentType::Capacitor:
-                {
-                    double deltaX = 0.0;
-                    if (newValue > 1e-18) {
-                        deltaX = -1.0 / (2.0 * SmithMath::PI * m_frequency * newValue);
-                    }
-                    seg.label = QString("C = %1").arg(newValue * 1e12, 0, 'f', 2) + " pF";
-                    seg.points = generateConstantRArc(startZ, deltaX);
-                }
-                break;
-            case ComponentType::Resistor:
-                {
-                    double deltaR = newValue;
-                    seg.label = QString("R = %1").arg(newValue, 0, 'f', 1) + " \u03a9";
-                    seg.points = generateConstantXArc(startZ, deltaR);
-                }
-                break;
-            default:
-                break;
-        }
+    const TraceSegment& seg = m_segments[index];
+    const double beta = 2.0 * SmithMath::PI * m_frequency / SmithMath::SPEED_OF_LIGHT;
+    if (!isDistributed(seg.componentType) || !(beta > 0.0)) return 0.0;
+    
+    double theta;
+    if (seg.componentType == ComponentType::TransmissionLine) {
+        // Clockwise rotation from the start to the target's angle is 2βl
+        Complex g0 = SmithMath::impedanceToGamma(seg.startImpedance, m_z0);
+        Complex g1 = SmithMath::impedanceToGamma(targetZ, m_z0);
+        theta = (std::arg(g0) - std::arg(g1)) / 2.0;
     } else {
-        Complex startY = Complex(1.0, 0.0) / startZ;
-        switch (seg.componentType) {
-            case ComponentType::Capacitor:
-                {
-                    double deltaB = 2.0 * SmithMath::PI * m_frequency * newValue;
-                    seg.label = QString("C = %1").arg(newValue * 1e12, 0, 'f', 2) + " pF (shunt)";
-                    seg.points = generateConstantGArc(startY, deltaB);
-                }
-                break;
-            case ComponentType::Inductor:
-                {
-                    double deltaB = 0.0;
-                    if (newValue > 1e-18) {
-                        deltaB = -1.0 / (2.0 * SmithMath::PI * m_frequency * newValue);
-                    }
-                    seg.label = QString("L = %1").arg(newValue * 1e9, 0, 'f', 2) + " nH (shunt)";
-                    seg.points = generateConstantGArc(startY, deltaB);
-                }
-                break;
-            case ComponentType::Resistor:
-                {
-                    double deltaG = 1.0 / newValue;
-                    seg.label = QString("R = %1").arg(newValue, 0, 'f', 1) + " \u03a9 (shunt)";
-                    seg.points = generateConstantBArc(startY, deltaG);
-                }
-                break;
-            default:
-                break;
+        // tan(βl) for the reactance or susceptance the stub must add
+        const bool open = (seg.componentType == ComponentType::OpenStub);
+        double t;
+        if (seg.connectionType == ConnectionType::Series) {
+            double x = targetZ.imag() - seg.startImpedance.imag();
+            t = open ? -m_z0 / SmithMath::safeDivisor(x) : x / m_z0;               // X = -Z0 cot, Z0 tan
+        } else {
+            double b = (1.0 / targetZ).imag() - (1.0 / seg.startImpedance).imag();
+            t = open ? b * m_z0 : -1.0 / (m_z0 * SmithMath::safeDivisor(b));       // B = tan / Z0, -cot / Z0
         }
+        theta = std::atan(t);
+    }
+    return nearestPeriod(theta, SmithMath::PI, seg.electricalLength) / beta;
+}
+
+bool MatchingTrace::isDistributed(ComponentType type)
+{
+    return type == ComponentType::TransmissionLine ||
+           type == ComponentType::OpenStub ||
+           type == ComponentType::ShortStub;
+}
+
+void MatchingTrace::recalculate(int fromIndex)
+{
+    if (fromIndex < 0) fromIndex = 0;
+    
+    int n = static_cast<int>(m_segments.size());
+    if (fromIndex >= n) return;
+    
+    // Every downstream segment starts where its predecessor ends, so walk
+    // the cached end impedances. This is O(1) per segment with no points.
+    Complex startZ = (fromIndex == 0) ? m_loadZ : m_segments[fromIndex - 1].endImpedance;
+    for (int i = fromIndex; i < n; ++i) {
+        applyElement(m_segments[i], startZ);
+        startZ = m_segments[i].endImpedance;
     }
     
-    // Recalculate all subsequent segments since their starting point changed
-    for (int i = index + 1; i < static_cast<int>(m_segments.size()); ++i) {
-        TraceSegment& nextSeg = m_segments[i];
-        Complex nextStartZ = m_segments[i - 1].endPoint().impedance;
-        
-        if (nextSeg.connectionType == ConnectionType::Series) {
-            switch (nextSeg.componentType) {
-                case ComponentType::Inductor:
-                    {
-                        double deltaX = 2.0 * SmithMath::PI * m_frequency * nextSeg.componentValue;
-                        nextSeg.points = generateConstantRArc(nextStartZ, deltaX);
-                    }
-                    break;
-                case ComponentType::Capacitor:
-                    {
-                        double deltaX = 0.0;
-                        if (nextSeg.componentValue > 1e-18) {
-                            deltaX = -1.0 / (2.0 * SmithMath::PI * m_frequency * nextSeg.componentValue);
-                        }
-                        nextSeg.points = generateConstantRArc(nextStartZ, deltaX);
-                    }
-                    break;
-                case ComponentType::Resistor:
-                    {
-                        double deltaR = nextSeg.componentValue;
-                        nextSeg.points = generateConstantXArc(nextStartZ, deltaR);
-                    }
-                    break;
-                default:
-                    break;
-            }
-        } else {
-            Complex nextStartY = Complex(1.0, 0.0) / nextStartZ;
-            switch (nextSeg.componentType) {
-                case ComponentType::Capacitor:
-                    {
-                        double deltaB = 2.0 * SmithMath::PI * m_frequency * nextSeg.componentValue;
-                        nextSeg.points = generateConstantGArc(nextStartY, deltaB);
-                    }
-                    break;
-                case ComponentType::Inductor:
-                    {
-                        double deltaB = 0.0;
-                        if (nextSeg.componentValue > 1e-18) {
-                            deltaB = -1.0 / (2.0 * SmithMath::PI * m_frequency * nextSeg.componentValue);
-                        }
-                        nextSeg.points = generateConstantGArc(nextStartY, deltaB);
-                    }
-                    break;
-                case ComponentType::Resistor:
-                    {
-                        double deltaG = 1.0 / nextSeg.componentValue;
-                        nextSeg.points = generateConstantBArc(nextStartY, deltaG);
-                    }
-                    break;
-                default:
-                    break;
-            }
-        }
+    markStale(fromIndex);
+}
+
+void MatchingTrace::markStale(int fromIndex)
+{
+    if (fromIndex < m_firstStaleSegment) {
+        m_firstStaleSegment = fromIndex;
     }
 }
 
+void MatchingTrace::ensurePoints() const
+{
+    int n = static_cast<int>(m_segments.size());
+    if (m_firstStaleSegment >= n) return;
+    
+    // Segments are laid out in order, so everything from the first stale
+    // one is rewritten in place after the points that are still valid
+    int keep = 0;
+    if (m_firstStaleSegment > 0) {
+        const TracePointView& last = m_segments[m_firstStaleSegment - 1].points;
+        keep = last.offset() + last.size();
+    }
+    m_points.truncate(keep);
+    m_points.setZ0(m_z0);
+    m_points.setFrequency(m_frequency);
+    
+    for (int i = m_firstStaleSegment; i < n; ++i) {
+        generatePoints(m_segments[i]);
+    }
+    m_firstStaleSegment = n;
+}
+
 Complex MatchingTrace::currentImpedance() const
 {
     if (m_segments.empty()) {
         return m_loadZ;
     }
-    return m_segments.back().endPoint().impedance;
+    return m_segments.back().endImpedance;
 }
 
 Complex MatchingTrace::currentGamma() const
@@ -244,95 +399,210 @@ QColor MatchingTrace::nextColor() const
     return s_colors[idx];
 }
 
-TraceSegment MatchingTrace::calculateSeriesElement(ComponentType type, double value) const
+TraceType MatchingTrace::traceTypeFor(ComponentType type, ConnectionType conn)
 {
-    TraceSegment seg;
-    seg.componentType = type;
-    seg.connectionType = ConnectionType::Series;
-    seg.componentValue = value;
-    seg.color = nextColor();
+    // A line section is always in series; stubs act like L/C
+    if (type == ComponentType::TransmissionLine) {
+        return TraceType::ConstantVSWR;
+    }
+    if (conn == ConnectionType::Series) {
+        // Series L/C change X only, series R changes R only
+        return (type == ComponentType::Resistor) ? TraceType::ConstantX : TraceType::ConstantR;
+    }
+    // Shunt L/C change B only, shunt R changes G only
+    return (type == ComponentType::Resistor) ? TraceType::ConstantB : TraceType::ConstantG;
+}
+
+QString MatchingTrace::segmentLabel(const TraceSegment& seg) const
+{
+    QString suffix = (seg.connectionType == ConnectionType::Shunt) ? " (shunt)" : "";
+    const double value = seg.componentValue;
     
-    Complex startZ = currentImpedance();
+    // Lines and stubs also show the electrical length at the trace frequency
+    const QString mm = QString("%1 mm (%2\u00b0)")
+        .arg(value * 1e3, 0, 'f', 2)
+        .arg(electricalLengthOf(seg) * 180.0 / SmithMath::PI, 0, 'f', 1);
     
-    switch (type) {
+    switch (seg.componentType) {
+        case ComponentType::Inductor:
+            return QString("L = %1").arg(value * 1e9, 0, 'f', 2) + " nH" + suffix;
+        case ComponentType::Capacitor:
+            return QString("C = %1").arg(value * 1e12, 0, 'f', 2) + " pF" + suffix;
+        case ComponentType::Resistor:
+            return QString("R = %1").arg(value, 0, 'f', 1) + " \u03a9" + suffix;
+        case ComponentType::TransmissionLine:
+            return "TL = " + mm;
+        case ComponentType::OpenStub:
+            return "Open stub = " + mm + suffix;
+        case ComponentType::ShortStub:
+            return "Short stub = " + mm + suffix;
+        default:
+            return QString();
+    }
+}
+
+double MatchingTrace::electricalLengthOf(const TraceSegment& seg) const
+{
+    if (!isDistributed(seg.componentType)) return 0.0;
+    return 2.0 * SmithMath::PI * m_frequency * seg.componentValue / SmithMath::SPEED_OF_LIGHT;
+}
+
+double MatchingTrace::elementDelta(const TraceSegment& seg) const
+{
+    double omega = 2.0 * SmithMath::PI * m_frequency;
+    double value = seg.componentValue;
+    
+    if (seg.connectionType == ConnectionType::Series) {
+        switch (seg.componentType) {
+            case ComponentType::Inductor:
+                return omega * value;                           // X = 2πfL
+            case ComponentType::Capacitor:
+                return (value > 1e-18) ? -1.0 / (omega * value) : 0.0;  // X = -1/(2πfC)
+            case ComponentType::Resistor:
+                return value;                                   // ΔR
+            case ComponentType::TransmissionLine:
+                return seg.electricalLength;                    // βl
+            case ComponentType::OpenStub:
+                return -m_z0 / SmithMath::safeDivisor(std::tan(seg.electricalLength));     // X = -Z0 cot(βl)
+            case ComponentType::ShortStub:
+                return m_z0 * std::tan(seg.electricalLength);                   // X = Z0 tan(βl)
+            default:
+                return 0.0;
+        }
+    }
+    
+    switch (seg.componentType) {
+        case ComponentType::Capacitor:
+            return omega * value;                               // B = 2πfC
         case ComponentType::Inductor:
+            return (value > 1e-18) ? -1.0 / (omega * value) : 0.0;      // B = -1/(2πfL)
+        case ComponentType::Resistor:
+            return 1.0 / value;                                 // ΔG = 1/R
+        case ComponentType::TransmissionLine:
+            return seg.electricalLength;                        // A line is always in series
+        case ComponentType::OpenStub:
+            return std::tan(seg.electricalLength) / m_z0;                       // B = tan(βl)/Z0
+        case ComponentType::ShortStub:
+            return -1.0 / (m_z0 * SmithMath::safeDivisor(std::tan(seg.electricalLength))); // B = -cot(βl)/Z0
+        default:
+            return 0.0;
+    }
+}
+
+void MatchingTrace::applyElement(TraceSegment& seg, const Complex& startZ) const
+{
+    seg.startImpedance = startZ;
+    seg.electricalLength = electricalLengthOf(seg);
+    double delta = elementDelta(seg);
+    
+    switch (seg.type) {
+        case TraceType::ConstantR:
+            seg.endImpedance = startZ + Complex(0.0, delta);
+            break;
+        case TraceType::ConstantX:
+            seg.endImpedance = Complex(std::max(startZ.real() + delta, 0.001), startZ.imag());
+            break;
+        case TraceType::ConstantG:
             {
-                // X = 2πfL, series inductor moves along constant R circle
-                seg.type = TraceType::ConstantR;
-                double deltaX = 2.0 * SmithMath::PI * m_frequency * value;
-                seg.label = QString("L = %1").arg(value * 1e9, 0, 'f', 2) + " nH";
-                seg.points = generateConstantRArc(startZ, deltaX);
+                Complex y = Complex(1.0, 0.0) / startZ + Complex(0.0, delta);
+                seg.endImpedance = Complex(1.0, 0.0) / y;
             }
             break;
-        case ComponentType::Capacitor:
+        case TraceType::ConstantB:
             {
-                // X = -1/(2πfC), series capacitor moves along constant R circle
-                seg.type = TraceType::ConstantR;
-                double deltaX = 0.0;
-                if (value > 1e-18) {
-                    deltaX = -1.0 / (2.0 * SmithMath::PI * m_frequency * value);
-                }
-                seg.label = QString("C = %1").arg(value * 1e12, 0, 'f', 2) + " pF";
-                seg.points = generateConstantRArc(startZ, deltaX);
+                Complex y = Complex(1.0, 0.0) / startZ;
+                y = Complex(std::max(y.real() + delta, 0.001), y.imag());
+                seg.endImpedance = Complex(1.0, 0.0) / y;
             }
             break;
-        case ComponentType::Resistor:
+        case TraceType::ConstantVSWR:
             {
-                // Series resistor moves along constant X arc (changes R only)
-                seg.type = TraceType::ConstantX;
-                double deltaR = value;  // Add resistance
-                seg.label = QString("R = %1").arg(value, 0, 'f', 1) + " \u03a9";
-                seg.points = generateConstantXArc(startZ, deltaR);
+                // Zin = Z0 (Z cos βl + j Z0 sin βl) / (Z0 cos βl + j Z sin βl)
+                const double c = std::cos(delta);
+                const double s = std::sin(delta);
+                seg.endImpedance = m_z0 * (startZ * c + Complex(0.0, m_z0 * s)) /
+                                   (Complex(m_z0 * c, 0.0) + Complex(0.0, s) * startZ);
             }
             break;
         default:
+            seg.endImpedance = startZ;
             break;
     }
+}
+
+int MatchingTrace::arcPointCount(const TraceSegment& seg) const
+{
+    Complex center;
+    double radius, startAngle, sweepAngle;
+    if (!seg.arcGeometry(m_z0, center, radius, startAngle, sweepAngle)) {
+        return DEFAULT_ARC_POINTS;
+    }
     
-    return seg;
+    double arcLength = radius * std::abs(sweepAngle);
+    int count = static_cast<int>(std::ceil(arcLength / MAX_CHORD_GAMMA)) + 1;
+    return std::clamp(count, MIN_ARC_POINTS, MAX_ARC_POINTS);
 }
 
-TraceSegment MatchingTrace::calculateShuntElement(ComponentType type, double value) const
+void MatchingTrace::generatePoints(TraceSegment& seg) const
+{
+    switch (seg.type) {
+        case TraceType::ConstantR:
+        case TraceType::ConstantX:
+        case TraceType::ConstantG:
+        case TraceType::ConstantB:
+        case TraceType::ConstantVSWR:
+            break;
+        default:
+            // Nothing to sample; keep the view empty at the arena end
+            seg.points = TracePointView(&m_points, m_points.size(), 0);
+            return;
+    }
+    
+    double delta = elementDelta(seg);
+    int numPoints = arcPointCount(seg);
+    int offset = m_points.append(numPoints);
+    double* re = m_points.real(offset);
+    double* im = m_points.imag(offset);
+    
+    switch (seg.type) {
+        case TraceType::ConstantR:
+            generateConstantRArc(seg.startImpedance, delta, numPoints, re, im);
+            break;
+        case TraceType::ConstantX:
+            generateConstantXArc(seg.startImpedance, delta, numPoints, re, im);
+            break;
+        case TraceType::ConstantG:
+            generateConstantGArc(Complex(1.0, 0.0) / seg.startImpedance, delta, numPoints, re, im);
+            break;
+        case TraceType::ConstantVSWR:
+            generateLineArc(seg.startImpedance, delta, numPoints, re, im);
+            break;
+        default:
+            generateConstantBArc(Complex(1.0, 0.0) / seg.startImpedance, delta, numPoints, re, im);
+            break;
+    }
+    seg.points = TracePointView(&m_points, offset, numPoints);
+}
+
+TraceSegment MatchingTrace::makeSegment(ComponentType type, ConnectionType conn, double value) const
 {
     TraceSegment seg;
     seg.componentType = type;
-    seg.connectionType = ConnectionType::Shunt;
+    seg.connectionType = conn;
     seg.componentValue = value;
     seg.color = nextColor();
     
-    Complex startZ = currentImpedance();
-    Complex startY = Complex(1.0, 0.0) / startZ;
-    
     switch (type) {
-        case ComponentType::Capacitor:
-            {
-                // B = 2πfC, shunt capacitor moves along constant G circle
-                seg.type = TraceType::ConstantG;
-                double deltaB = 2.0 * SmithMath::PI * m_frequency * value;
-                seg.label = QString("C = %1").arg(value * 1e12, 0, 'f', 2) + " pF (shunt)";
-                seg.points = generateConstantGArc(startY, deltaB);
-            }
-            break;
         case ComponentType::Inductor:
-            {
-                // B = -1/(2πfL), shunt inductor moves along constant G circle
-                seg.type = TraceType::ConstantG;
-                double deltaB = 0.0;
-                if (value > 1e-18) {
-                    deltaB = -1.0 / (2.0 * SmithMath::PI * m_frequency * value);
-                }
-                seg.label = QString("L = %1").arg(value * 1e9, 0, 'f', 2) + " nH (shunt)";
-                seg.points = generateConstantGArc(startY, deltaB);
-            }
-            break;
+        case ComponentType::Capacitor:
         case ComponentType::Resistor:
-            {
-                // Shunt resistor moves along constant B arc (changes G only)
-                seg.type = TraceType::ConstantB;
-                double deltaG = 1.0 / value;  // G = 1/R
-                seg.label = QString("R = %1").arg(value, 0, 'f', 1) + " \u03a9 (shunt)";
-                seg.points = generateConstantBArc(startY, deltaG);
-            }
+        case ComponentType::TransmissionLine:
+        case ComponentType::OpenStub:
+        case ComponentType::ShortStub:
+            seg.type = traceTypeFor(type, conn);
+            seg.label = segmentLabel(seg);
+            // Points are generated once the segment is added to a trace
+            applyElement(seg, currentImpedance());
             break;
         default:
             break;
@@ -341,12 +611,19 @@ TraceSegment MatchingTrace::calculateShuntElement(ComponentType type, double val
     return seg;
 }
 
-std::vector<TracePoint> MatchingTrace::generateConstantRArc(
-    const Complex& startZ, double deltaX, int numPoints) const
+TraceSegment MatchingTrace::calculateSeriesElement(ComponentType type, double value) const
+{
+    return makeSegment(type, ConnectionType::Series, value);
+}
+
+TraceSegment MatchingTrace::calculateShuntElement(ComponentType type, double value) const
+{
+    return makeSegment(type, ConnectionType::Shunt, value);
+}
+
+void MatchingTrace::generateConstantRArc(const Complex& startZ, double deltaX, int numPoints,
+                                         double* re, double* im) const
 {
-    std::vector<TracePoint> points;
-    points.reserve(numPoints);
-    
     double r = startZ.real();
     double startX = startZ.imag();
     
@@ -355,18 +632,14 @@ std::vector<TracePoint> MatchingTrace::generateConstantRArc(
         double x = startX + t * deltaX;
         Complex z(r, x);
         Complex gamma = SmithMath::impedanceToGamma(z, m_z0);
-        points.emplace_back(gamma, z, m_frequency);
+        re[i] = gamma.real();
+        im[i] = gamma.imag();
     }
-    
-    return points;
 }
 
-std::vector<TracePoint> MatchingTrace::generateConstantGArc(
-    const Complex& startY, double deltaB, int numPoints) const
+void MatchingTrace::generateConstantGArc(const Complex& startY, double deltaB, int numPoints,
+                                         double* re, double* im) const
 {
-    std::vector<TracePoint> points;
-    points.reserve(numPoints);
-    
     double g = startY.real();
     double startB = startY.imag();
     
@@ -376,18 +649,14 @@ std::vector<TracePoint> MatchingTrace::generateConstantGArc(
         Complex y(g, b);
         Complex z = Complex(1.0, 0.0) / y;
         Complex gamma = SmithMath::impedanceToGamma(z, m_z0);
-        points.emplace_back(gamma, z, m_frequency);
+        re[i] = gamma.real();
+        im[i] = gamma.imag();
     }
-    
-    return points;
 }
 
-std::vector<TracePoint> MatchingTrace::generateConstantXArc(
-    const Complex& startZ, double deltaR, int numPoints) const
+void MatchingTrace::generateConstantXArc(const Complex& startZ, double deltaR, int numPoints,
+                                         double* re, double* im) const
 {
-    std::vector<TracePoint> points;
-    points.reserve(numPoints);
-    
     double x = startZ.imag();  // Keep reactance constant
     double startR = startZ.real();
     
@@ -397,18 +666,14 @@ std::vector<TracePoint> MatchingTrace::generateConstantXArc(
         if (r < 0.001) r = 0.001;  // Avoid zero or negative resistance
         Complex z(r, x);
         Complex gamma = SmithMath::impedanceToGamma(z, m_z0);
-        points.emplace_back(gamma, z, m_frequency);
+        re[i] = gamma.real();
+        im[i] = gamma.imag();
     }
-    
-    return points;
 }
 
-std::vector<TracePoint> MatchingTrace::generateConstantBArc(
-    const Complex& startY, double deltaG, int numPoints) const
+void MatchingTrace::generateConstantBArc(const Complex& startY, double deltaG, int numPoints,
+                                         double* re, double* im) const
 {
-    std::vector<TracePoint> points;
-    points.reserve(numPoints);
-    
     double b = startY.imag();  // Keep susceptance constant
     double startG = startY.real();
     
@@ -419,10 +684,23 @@ std::vector<TracePoint> MatchingTrace::generateConstantBArc(
         Complex y(g, b);
         Complex z = Complex(1.0, 0.0) / y;
         Complex gamma = SmithMath::impedanceToGamma(z, m_z0);
-        points.emplace_back(gamma, z, m_frequency);
+        re[i] = gamma.real();
+        im[i] = gamma.imag();
+    }
+}
+
+void MatchingTrace::generateLineArc(const Complex& startZ, double theta, int numPoints,
+                                    double* re, double* im) const
+{
+    // Constant |Gamma|, turning clockwise by 2θ; one rotation step per point
+    const Complex g0 = SmithMath::impedanceToGamma(startZ, m_z0);
+    const Complex step = std::polar(1.0, -2.0 * theta / (numPoints - 1));
+    Complex gamma = g0;
+    for (int i = 0; i < numPoints; ++i) {
+        re[i] = gamma.real();
+        im[i] = gamma.imag();
+        gamma *= step;
     }
-    
-    return points;
 }
 
 } // namespace SmithTool
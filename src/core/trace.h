@@ -29,6 +29,91 @@ struct TracePoint {
         : gamma(g), impedance(z), frequency(f) {}
 };
 
+/**
+ * @brief Pooled Gamma samples of all segments of one MatchingTrace
+ * 
+ * Real and imaginary parts are kept in separate arrays and segments own
+ * consecutive ranges of them. Impedance is not stored; it follows from
+ * Gamma and the reference impedance. Truncating and refilling keeps the
+ * capacity, so regenerating edited segments does not allocate.
+ */
+class TracePointArena {
+public:
+    TracePointArena() : m_z0(50.0), m_frequency(1e9) {}
+    
+    int size() const { return static_cast<int>(m_real.size()); }
+    void clear() { truncate(0); }
+    void truncate(int size);
+    
+    // Append count uninitialized points and return the offset of the first
+    int append(int count);
+    
+    double* real(int offset) { return m_real.data() + offset; }
+    double* imag(int offset) { return m_imag.data() + offset; }
+    Complex gamma(int index) const { return Complex(m_real[index], m_imag[index]); }
+    
+    // Reference impedance and frequency the points were generated for
+    void setZ0(double z0) { m_z0 = z0; }
+    void setFrequency(double freq) { m_frequency = freq; }
+    double z0() const { return m_z0; }
+    double frequency() const { return m_frequency; }
+    
+    std::size_t memoryBytes() const;
+
+private:
+    std::vector<double> m_real;
+    std::vector<double> m_imag;
+    double m_z0;
+    double m_frequency;
+};
+
+/**
+ * @brief Read-only view of one segment's points in a TracePointArena
+ * 
+ * Indexing and iteration yield TracePoint values with the impedance
+ * computed on demand.
+ */
+class TracePointView {
+public:
+    class const_iterator {
+    public:
+        const_iterator(const TracePointView* view, int index) : m_view(view), m_index(index) {}
+        TracePoint operator*() const { return (*m_view)[m_index]; }
+        const_iterator& operator++() { ++m_index; return *this; }
+        bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+        bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+    
+    private:
+        const TracePointView* m_view;
+        int m_index;
+    };
+    
+    TracePointView() : m_arena(nullptr), m_offset(0), m_count(0) {}
+    TracePointView(const TracePointArena* arena, int offset, int count)
+        : m_arena(arena), m_offset(offset), m_count(count) {}
+    
+    int size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    int offset() const { return m_offset; }
+    
+    Complex gamma(int index) const { return m_arena->gamma(m_offset + index); }
+    Complex impedance(int index) const;
+    TracePoint operator[](int index) const;
+    TracePoint front() const { return (*this)[0]; }
+    TracePoint back() const { return (*this)[m_count - 1]; }
+    
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_count); }
+    
+    // Point the view at another arena holding the same layout (trace copies)
+    void rebind(const TracePointArena* arena) { m_arena = arena; }
+
+private:
+    const TracePointArena* m_arena;
+    int m_offset;
+    int m_count;
+};
+
 /**
  * @brief Type of trace segment
  */
@@ -37,6 +122,7 @@ enum class TraceType {
     ConstantX,      // Along constant reactance arc
     ConstantG,      // Along constant conductance circle (Y chart)
     ConstantB,      // Along constant susceptance arc (Y chart)
+    ConstantVSWR,   // Rotation about the chart center (series line section)
     SParam,         // S-parameter trace from file
     Custom          // Arbitrary points
 };
@@ -45,7 +131,7 @@ enum class TraceType {
  * @brief A single trace segment representing one component effect
  */
 struct TraceSegment {
-    std::vector<TracePoint> points;
+    TracePointView points;      // Filled by the owning MatchingTrace
     TraceType type;
     QColor color;
     QString label;
@@ -55,12 +141,21 @@ struct TraceSegment {
     ConnectionType connectionType;
     double componentValue;
     
+    // Cached impedances before and after this element (closed form,
+    // valid even while the point list is waiting to be regenerated)
+    Complex startImpedance;
+    Complex endImpedance;
+    double electricalLength;    // βl of a line or stub (radians), else 0
+    
     TraceSegment()
         : type(TraceType::Custom)
         , color(Qt::blue)
         , componentType(ComponentType::None)
         , connectionType(ConnectionType::Series)
         , componentValue(0.0)
+        , startImpedance(50.0, 0.0)
+        , endImpedance(50.0, 0.0)
+        , electricalLength(0.0)
     {}
     
     bool isEmpty() const { return points.empty(); }
@@ -72,14 +167,40 @@ struct TraceSegment {
     TracePoint endPoint() const {
         return points.empty() ? TracePoint() : points.back();
     }
+    
+    /**
+     * @brief Exact circle arc this segment travels along in the Gamma plane
+     * 
+     * Constant R/X/G/B segments are arcs of a circle. The sweep is measured
+     * so the arc never passes through the open/short point that the
+     * circle family converges to. Line sections turn clockwise about the
+     * center by 2βl, which may be more than one full circle.
+     * 
+     * @param z0 Reference impedance the trace is normalized to
+     * @param center Circle center in the Gamma plane
+     * @param radius Circle radius in the Gamma plane
+     * @param startAngle Angle of the start point about the center (radians)
+     * @param sweepAngle Signed angle from start to end point (radians)
+     * @return false if the segment is not a (finite radius) circle arc
+     */
+    bool arcGeometry(double z0, Complex& center, double& radius,
+                     double& startAngle, double& sweepAngle) const;
 };
 
 /**
  * @brief Complete matching network trace from source to load
+ * 
+ * Besides lumped R/L/C, segments may be transmission line sections
+ * (always in series) and open or shorted stubs (series or shunt). Their
+ * value is the physical length in meters, with the trace's z0 as the
+ * characteristic impedance and free-space propagation, as in the stub
+ * solutions of MatchingCalculator.
  */
 class MatchingTrace {
 public:
     MatchingTrace();
+    MatchingTrace(const MatchingTrace& other);
+    MatchingTrace& operator=(const MatchingTrace& other);
     ~MatchingTrace() = default;
     
     // Source and load
@@ -98,8 +219,50 @@ public:
     void addSegment(const TraceSegment& segment);
     void removeLastSegment();
     void clear();
+    
+    /**
+     * @brief Insert an element before segment index (0 = next to the load)
+     * 
+     * Downstream segments keep their values; as for updateSegmentValue(),
+     * only their cached impedances are walked and their point lists are
+     * regenerated lazily. An invalid color takes the next palette color.
+     */
+    void insertElement(int index, ComponentType type, ConnectionType conn, double value,
+                       const QColor& color = QColor());
+    void removeSegment(int index);
+    
+    /**
+     * @brief Change the value of one element
+     * 
+     * Only the edited segment and the cached end impedances of the
+     * downstream segments are recomputed (closed form, no allocation).
+     * Point lists of affected segments are regenerated lazily the next
+     * time segments are read.
+     */
     void updateSegmentValue(int index, double newValue);
     
+    /**
+     * @brief Length that puts the end of a line or stub segment at targetZ
+     * 
+     * The closed-form counterpart of the lumped values computed while
+     * dragging: a line takes the rotation about the chart center to the
+     * target's angle, a stub the reactance (series) or susceptance
+     * (shunt) that reaches the target's. Lengths repeat every λ/2; the
+     * one nearest the current length is returned, so drags stay
+     * continuous across the wrap.
+     * 
+     * @return Length in meters, or 0 if the segment is not a line or stub
+     */
+    double lineLengthFor(int index, const Complex& targetZ) const;
+    
+    static bool isDistributed(ComponentType type);
+    
+    /**
+     * @brief Recompute cached impedances from a segment onwards
+     * @param fromIndex First segment to recompute (0 = whole trace)
+     */
+    void recalculate(int fromIndex = 0);
+    
     int numSegments() const { return static_cast<int>(m_segments.size()); }
     const TraceSegment& segment(int index) const;
     TraceSegment& segmentRef(int index);
@@ -114,29 +277,56 @@ public:
     // Calculate trace for adding a shunt element
     TraceSegment calculateShuntElement(ComponentType type, double value) const;
     
-    // Get all segments
-    const std::vector<TraceSegment>& segments() const { return m_segments; }
+    // Get all segments (regenerates stale point lists first)
+    const std::vector<TraceSegment>& segments() const;
     
+    // Heap bytes held by the point arena (capacity, not size)
+    std::size_t pointMemoryBytes() const { return m_points.memoryBytes(); }
+
 private:
     Complex m_sourceZ;
     Complex m_loadZ;
     double m_z0;
     double m_frequency;
-    std::vector<TraceSegment> m_segments;
+    
+    // Point lists are generated on demand, so const readers may fill them
+    mutable std::vector<TraceSegment> m_segments;
+    mutable int m_firstStaleSegment;    // Segments from here on need new points
+    mutable TracePointArena m_points;    // Gamma of every segment, in segment order
     
     // Color palette for segments
     static const std::vector<QColor> s_colors;
     QColor nextColor() const;
     
-    // Generate arc points
-    std::vector<TracePoint> generateConstantRArc(
-        const Complex& startZ, double deltaX, int numPoints = 50) const;
-    std::vector<TracePoint> generateConstantXArc(
-        const Complex& startZ, double deltaR, int numPoints = 50) const;
-    std::vector<TracePoint> generateConstantGArc(
-        const Complex& startY, double deltaB, int numPoints = 50) const;
-    std::vector<TracePoint> generateConstantBArc(
-        const Complex& startY, double deltaG, int numPoints = 50) const;
+    // Adaptive tessellation: points per arc follow the arc length in Gamma
+    static constexpr double MAX_CHORD_GAMMA = 0.02;
+    static constexpr int MIN_ARC_POINTS = 3;
+    static constexpr int MAX_ARC_POINTS = 200;
+    static constexpr int DEFAULT_ARC_POINTS = 50;
+    int arcPointCount(const TraceSegment& seg) const;
+    
+    // Element math shared by creation and editing
+    static TraceType traceTypeFor(ComponentType type, ConnectionType conn);
+    QString segmentLabel(const TraceSegment& seg) const;
+    double electricalLengthOf(const TraceSegment& seg) const;
+    double elementDelta(const TraceSegment& seg) const;
+    void applyElement(TraceSegment& seg, const Complex& startZ) const;
+    void generatePoints(TraceSegment& seg) const;
+    void ensurePoints() const;
+    void markStale(int fromIndex);
+    TraceSegment makeSegment(ComponentType type, ConnectionType conn, double value) const;
+    
+    // Generate arc points into the arena at re/im
+    void generateConstantRArc(const Complex& startZ, double deltaX, int numPoints,
+                              double* re, double* im) const;
+    void generateConstantXArc(const Complex& startZ, double deltaR, int numPoints,
+                              double* re, double* im) const;
+    void generateConstantGArc(const Complex& startY, double deltaB, int numPoints,
+                              double* re, double* im) const;
+    void generateConstantBArc(const Complex& startY, double deltaG, int numPoints,
+                              double* re, double* im) const;
+    void generateLineArc(const Complex& startZ, double theta, int numPoints,
+                         double* re, double* im) const;
 };
 
 /**
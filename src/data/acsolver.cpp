@@ -0,0 +1,348 @@
+/**
+ * @file acsolver.cpp
+ * @brief In-process linear AC solver implementation
+ */
+
+#include "acsolver.h"
+#include "../core/parallel.h"
+#include "../core/trace.h"
+#include "../core/smithmath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SmithTool {
+
+namespace {
+
+const double SHORT_OHMS = 1e-6;     // Zero-ohm elements are stamped as this
+const double GMIN = 1e-12;          // Node-to-ground leakage, as SPICE's gmin
+
+// Admittance of a two-terminal element at angular frequency omega
+Complex elementAdmittance(const AcElement& element, double omega)
+{
+    const Complex shortCircuit(1.0 / SHORT_OHMS, 0.0);
+    switch (element.type) {
+        case ComponentType::Resistor:
+            return Complex(1.0 / std::max(element.value, SHORT_OHMS), 0.0);
+        
+        case ComponentType::Inductor: {
+            double x = omega * element.value;
+            return (x > SHORT_OHMS) ? Complex(0.0, -1.0 / x) : shortCircuit;
+        }
+        
+        case ComponentType::Capacitor:
+            return Complex(0.0, omega * element.value);
+        
+        case ComponentType::OpenStub:
+        case ComponentType::ShortStub: {
+            // Open: -j Zc cot(θ), shorted: j Zc tan(θ)
+            double t = SmithMath::safeDivisor(std::tan(omega * element.length / SmithMath::SPEED_OF_LIGHT));
+            double x = (element.type == ComponentType::OpenStub)
+                ? -element.lineZ0 / t : element.lineZ0 * t;
+            return (std::abs(x) > SHORT_OHMS) ? Complex(0.0, -1.0 / x) : shortCircuit;
+        }
+        
+        default:
+            return Complex(0.0, 0.0);
+    }
+}
+
+/**
+ * @brief Banded complex system with several right-hand sides
+ *
+ * Row i holds columns [i - k, i + 2k]: the symmetric band of half-width
+ * k plus room for the fill that row exchanges create.
+ */
+class BandSystem {
+public:
+    BandSystem(int n, int k, int rhsCount)
+        : m_n(n), m_k(k), m_width(3 * k + 1), m_rhsCount(rhsCount)
+        , m_band(static_cast<std::size_t>(n) * m_width)
+        , m_rhs(static_cast<std::size_t>(n) * rhsCount) {}
+    
+    void clear()
+    {
+        std::fill(m_band.begin(), m_band.end(), Complex(0.0, 0.0));
+        std::fill(m_rhs.begin(), m_rhs.end(), Complex(0.0, 0.0));
+    }
+    
+    Complex& at(int row, int col) { return m_band[static_cast<std::size_t>(row) * m_width + (col - row + m_k)]; }
+    Complex& rhs(int row, int column) { return m_rhs[static_cast<std::size_t>(row) * m_rhsCount + column]; }
+    
+    // Stamp admittance y between rows a and b (-1 = ground)
+    void stamp(int a, int b, const Complex& y)
+    {
+        if (a >= 0) at(a, a) += y;
+        if (b >= 0) at(b, b) += y;
+        if (a >= 0 && b >= 0) {
+            at(a, b) -= y;
+            at(b, a) -= y;
+        }
+    }
+    
+    // Gaussian elimination with partial pivoting; solutions replace the
+    // right-hand sides
+    void solve()
+    {
+        for (int c = 0; c < m_n; ++c) {
+            const int lastRow = std::min(m_n - 1, c + m_k);
+            const int lastCol = std::min(m_n - 1, c + 2 * m_k);
+            
+            int pivot = c;
+            for (int r = c + 1; r <= lastRow; ++r) {
+                if (std::norm(at(r, c)) > std::norm(at(pivot, c))) pivot = r;
+            }
+            if (pivot != c) {
+                for (int j = c; j <= lastCol; ++j) std::swap(at(c, j), at(pivot, j));
+                for (int p = 0; p < m_rhsCount; ++p) std::swap(rhs(c, p), rhs(pivot, p));
+            }
+            
+            const Complex diagonal = at(c, c);
+            for (int r = c + 1; r <= lastRow; ++r) {
+                if (at(r, c) == Complex(0.0, 0.0)) continue;
+                const Complex factor = at(r, c) / diagonal;
+                for (int j = c + 1; j <= lastCol; ++j) at(r, j) -= factor * at(c, j);
+                for (int p = 0; p < m_rhsCount; ++p) rhs(r, p) -= factor * rhs(c, p);
+            }
+        }
+        
+        for (int i = m_n - 1; i >= 0; --i) {
+            const int lastCol = std::min(m_n - 1, i + 2 * m_k);
+            for (int p = 0; p < m_rhsCount; ++p) {
+                Complex x = rhs(i, p);
+                for (int j = i + 1; j <= lastCol; ++j) x -= at(i, j) * rhs(j, p);
+                rhs(i, p) = x / at(i, i);
+            }
+        }
+    }
+
+private:
+    int m_n;
+    int m_k;
+    int m_width;
+    int m_rhsCount;
+    std::vector<Complex> m_band;
+    std::vector<Complex> m_rhs;
+};
+
+/**
+ * @brief Reverse Cuthill-McKee ordering of nodes 1..n
+ * @return Row of each node, indexed by node - 1
+ */
+std::vector<int> bandOrdering(int n, const std::vector<std::vector<int>>& adjacency)
+{
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<bool> visited(n, false);
+    auto byDegree = [&](int a, int b) { return adjacency[a].size() < adjacency[b].size(); };
+    
+    while (static_cast<int>(order.size()) < n) {
+        // Start each connected component at a node of lowest degree
+        int start = -1;
+        for (int v = 0; v < n; ++v) {
+            if (!visited[v] && (start < 0 || byDegree(v, start))) start = v;
+        }
+        visited[start] = true;
+        std::size_t head = order.size();
+        order.push_back(start);
+        while (head < order.size()) {
+            std::vector<int> next;
+            for (int w : adjacency[order[head++]]) {
+                if (!visited[w]) {
+                    visited[w] = true;
+                    next.push_back(w);
+                }
+            }
+            std::sort(next.begin(), next.end(), byDegree);
+            order.insert(order.end(), next.begin(), next.end());
+        }
+    }
+    
+    std::vector<int> row(n);
+    for (int i = 0; i < n; ++i) {
+        row[order[n - 1 - i]] = i;
+    }
+    return row;
+}
+
+} // namespace
+
+int AcNetlist::nodeCount() const
+{
+    int count = 0;
+    for (const AcElement& element : elements) {
+        count = std::max({count, element.node1, element.node2});
+    }
+    for (int port : ports) {
+        count = std::max(count, port);
+    }
+    return count;
+}
+
+AcNetlist AcNetlist::fromLadder(const std::vector<SweepElement>& elements)
+{
+    AcNetlist netlist;
+    int node = 1;
+    
+    // Walk from the source, so node numbers grow towards the load
+    for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
+        if (it->type == ComponentType::None) continue;
+        
+        // Lines always cascade; everything else follows its connection
+        const bool series = (it->type == ComponentType::TransmissionLine ||
+                             it->connection == ConnectionType::Series);
+        AcElement element(it->type, node, series ? node + 1 : 0, it->value);
+        element.lineZ0 = it->lineZ0;
+        element.length = it->length;
+        netlist.elements.push_back(element);
+        if (series) ++node;
+    }
+    
+    netlist.ports = {1, node};
+    return netlist;
+}
+
+AcNetlist AcNetlist::fromTrace(const MatchingTrace& trace)
+{
+    FrequencySweep sweep;
+    sweep.setNetwork(trace);
+    return fromLadder(sweep.elements());
+}
+
+AcSolver::AcSolver()
+    : m_z0(50.0)
+    , m_threadCount(0)
+{
+}
+
+SParamData AcSolver::solveLadder(const std::vector<SweepElement>& elements,
+                                 const std::vector<double>& frequencies) const
+{
+    SParamData data;
+    data.setNumPorts(2);
+    data.setReferenceImpedance(m_z0);
+    if (frequencies.empty()) return data;
+    
+    FrequencySweep sweep;
+    sweep.setElements(elements);
+    
+    const int count = static_cast<int>(frequencies.size());
+    std::vector<std::vector<Complex>> params(4, std::vector<Complex>(count));
+    const double z0 = m_z0;
+    const int threads = Parallel::workerCount(m_threadCount, count, MIN_POINTS_PER_THREAD);
+    Parallel::parallelRanges(count, threads, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const AbcdMatrix m = sweep.networkAbcd(frequencies[i]);
+            const Complex b = m.b / z0;
+            const Complex c = m.c * z0;
+            const Complex delta = m.a + b + c + m.d;
+            params[0][i] = (m.a + b - c - m.d) / delta;                 // S11
+            params[1][i] = 2.0 * (m.a * m.d - m.b * m.c) / delta;       // S12
+            params[2][i] = 2.0 / delta;                                 // S21
+            params[3][i] = (-m.a + b - c + m.d) / delta;                // S22
+        }
+    });
+    
+    data.assignPoints(frequencies, std::move(params));
+    return data;
+}
+
+SParamData AcSolver::solve(const MatchingTrace& trace, const std::vector<double>& frequencies) const
+{
+    FrequencySweep sweep;
+    sweep.setNetwork(trace);
+    return solveLadder(sweep.elements(), frequencies);
+}
+
+SParamData AcSolver::solve(const AcNetlist& netlist, const std::vector<double>& frequencies) const
+{
+    const int portCount = static_cast<int>(netlist.ports.size());
+    const int n = netlist.nodeCount();
+    
+    SParamData data;
+    data.setNumPorts(std::max(1, portCount));
+    data.setReferenceImpedance(m_z0);
+    if (portCount == 0 || frequencies.empty()) return data;
+    for (int port : netlist.ports) {
+        if (port <= 0) return data;
+    }
+    
+    // Symbolic stage, shared by all frequencies: node order and bandwidth
+    std::vector<std::vector<int>> adjacency(n);
+    for (const AcElement& element : netlist.elements) {
+        int a = element.node1 - 1;
+        int b = element.node2 - 1;
+        if (a >= 0 && b >= 0 && a != b) {
+            adjacency[a].push_back(b);
+            adjacency[b].push_back(a);
+        }
+    }
+    const std::vector<int> row = bandOrdering(n, adjacency);
+    auto rowOf = [&row](int node) { return node > 0 ? row[node - 1] : -1; };
+    
+    int bandwidth = 0;
+    for (const AcElement& element : netlist.elements) {
+        if (element.node1 > 0 && element.node2 > 0) {
+            bandwidth = std::max(bandwidth, std::abs(rowOf(element.node1) - rowOf(element.node2)));
+        }
+    }
+    
+    const int count = static_cast<int>(frequencies.size());
+    std::vector<std::vector<Complex>> params(static_cast<std::size_t>(portCount) * portCount,
+                                             std::vector<Complex>(count));
+    const double y0 = 1.0 / m_z0;
+    const int threads = Parallel::workerCount(m_threadCount, count, MIN_POINTS_PER_THREAD);
+    Parallel::parallelRanges(count, threads, [&](int begin, int end) {
+        BandSystem system(n, bandwidth, portCount);
+        for (int i = begin; i < end; ++i) {
+            const double omega = 2.0 * SmithMath::PI * frequencies[i];
+            system.clear();
+            
+            for (int v = 0; v < n; ++v) {
+                system.at(v, v) += GMIN;
+            }
+            for (const AcElement& element : netlist.elements) {
+                const int a = rowOf(element.node1);
+                const int b = rowOf(element.node2);
+                if (element.type != ComponentType::TransmissionLine) {
+                    system.stamp(a, b, elementAdmittance(element, omega));
+                    continue;
+                }
+                
+                // Line Y matrix: y11 = y22 = -j cot(θ) / Zc, y12 = y21 = j / (Zc sin θ)
+                const double theta = omega * element.length / SmithMath::SPEED_OF_LIGHT;
+                const double s = SmithMath::safeDivisor(std::sin(theta));
+                const Complex self(0.0, -std::cos(theta) / (element.lineZ0 * s));
+                const Complex mutual(0.0, 1.0 / (element.lineZ0 * s));
+                if (a >= 0) system.at(a, a) += self;
+                if (b >= 0) system.at(b, b) += self;
+                if (a >= 0 && b >= 0) {
+                    system.at(a, b) += mutual;
+                    system.at(b, a) += mutual;
+                }
+            }
+            
+            // Ports are Z0 terminations; port p is driven by a 2 V source
+            // behind its termination, so the incident wave is 1 V
+            for (int p = 0; p < portCount; ++p) {
+                const int r = rowOf(netlist.ports[p]);
+                system.at(r, r) += y0;
+                system.rhs(r, p) += 2.0 * y0;
+            }
+            
+            system.solve();
+            for (int r = 0; r < portCount; ++r) {
+                const int node = rowOf(netlist.ports[r]);
+                for (int c = 0; c < portCount; ++c) {
+                    Complex v = system.rhs(node, c);
+                    params[static_cast<std::size_t>(r) * portCount + c][i] = (r == c) ? v - 1.0 : v;
+                }
+            }
+        }
+    });
+    
+    data.assignPoints(frequencies, std::move(params));
+    return data;
+}
+
+} // namespace SmithTool
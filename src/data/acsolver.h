@@ -0,0 +1,112 @@
+/**
+ * @file acsolver.h
+ * @brief In-process linear AC solver producing S-parameters
+ *
+ * Replaces the round trip through an external SPICE run for checking a
+ * network over frequency: ladder networks are solved by ABCD cascade,
+ * general netlists by nodal analysis with a banded LU factorization.
+ */
+
+#ifndef SMITHTOOL_ACSOLVER_H
+#define SMITHTOOL_ACSOLVER_H
+
+#include "sparamdata.h"
+#include "../core/sweep.h"
+#include <complex>
+#include <vector>
+
+namespace SmithTool {
+
+class MatchingTrace;
+
+/**
+ * @brief One element of an AC netlist
+ *
+ * Two-terminal elements (R, L, C, stubs) connect node1 and node2.
+ * A transmission line is a two-port from node1 to node2, both referenced
+ * to ground. Node 0 is ground. Units as in SweepElement.
+ */
+struct AcElement {
+    ComponentType type;
+    int node1;
+    int node2;
+    double value;
+    double lineZ0;
+    double length;
+    
+    AcElement(ComponentType t = ComponentType::None, int n1 = 0, int n2 = 0, double v = 0.0)
+        : type(t), node1(n1), node2(n2), value(v), lineZ0(50.0), length(0.0) {}
+};
+
+/**
+ * @brief Netlist with numbered nodes and ground-referenced ports
+ */
+struct AcNetlist {
+    std::vector<AcElement> elements;
+    std::vector<int> ports;         // Port nodes, port 1 first
+    
+    // Highest node number in use
+    int nodeCount() const;
+    
+    /**
+     * @brief Netlist of a ladder, elements ordered from the load
+     *
+     * Port 1 is the source side (node 1) and port 2 the load side, the
+     * nodes SpiceExporter places the source and load at.
+     */
+    static AcNetlist fromLadder(const std::vector<SweepElement>& elements);
+    static AcNetlist fromTrace(const MatchingTrace& trace);
+};
+
+/**
+ * @brief Linear AC solver
+ *
+ * Results are S-parameters referenced to z0() at every port, as an
+ * SParamData that can be shown, overlaid or saved like a measured file.
+ * Frequencies must be ascending. Large sweeps are split across worker
+ * threads.
+ */
+class AcSolver {
+public:
+    AcSolver();
+    
+    void setZ0(double z0) { m_z0 = z0; }
+    double z0() const { return m_z0; }
+    
+    /**
+     * @brief Limit the number of worker threads
+     * @param count Thread count (0 = one per hardware thread)
+     */
+    void setThreadCount(int count) { m_threadCount = count; }
+    int threadCount() const { return m_threadCount; }
+    
+    /**
+     * @brief Two-port S-parameters of a ladder by ABCD cascade
+     * @param elements Elements ordered from the load (port 2) towards the source (port 1)
+     * @return Empty data if frequencies is empty or unsorted
+     */
+    SParamData solveLadder(const std::vector<SweepElement>& elements,
+                           const std::vector<double>& frequencies) const;
+    
+    // Network of a matching trace, as solveLadder()
+    SParamData solve(const MatchingTrace& trace, const std::vector<double>& frequencies) const;
+    
+    /**
+     * @brief N-port S-parameters of a general netlist by nodal analysis
+     * @return Empty data if there are no ports, a port is ground, or the
+     *         frequencies are empty or unsorted
+     */
+    SParamData solve(const AcNetlist& netlist, const std::vector<double>& frequencies) const;
+    
+    // Minimum frequencies per worker thread; smaller sweeps run inline
+    static constexpr int MIN_POINTS_PER_THREAD = 256;
+
+private:
+    double m_z0;
+    int m_threadCount;
+    
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_ACSOLVER_H
@@ -0,0 +1,303 @@
+/**
+ * @file bandanalyzer.cpp
+ * @brief Marker search and bandwidth query implementation
+ */
+
+#include "bandanalyzer.h"
+#include "../core/profiler.h"
+#include "../core/smithmath.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SmithTool {
+
+namespace {
+
+const double INF = std::numeric_limits<double>::infinity();
+
+// |Γ| threshold of a return loss in negative dB
+inline double thresholdMagnitude(double returnLossDb)
+{
+    return std::pow(10.0, returnLossDb / 20.0);
+}
+
+inline double magnitudeDb(double magnitude)
+{
+    return 20.0 * std::log10(std::max(magnitude, 1e-10));
+}
+
+} // namespace
+
+double BandExtreme::returnLossDb() const
+{
+    return SmithMath::gammaToReturnLoss(Complex(magnitude, 0.0));
+}
+
+double BandExtreme::vswr() const
+{
+    return SmithMath::gammaToVSWR(magnitude);
+}
+
+ReflectionIndex ReflectionIndex::build(const SParamData& data, int port)
+{
+    SMITHTOOL_PROFILE_SCOPE("ReflectionIndex::build");
+    
+    ReflectionIndex index;
+    if (port < 0 || port >= data.numPorts() || data.isEmpty()) {
+        return index;
+    }
+    
+    const std::vector<Complex>& values = data.sData(port, port);
+    const int n = static_cast<int>(values.size());
+    index.m_port = port;
+    index.m_frequencies = data.frequencyAxis();
+    index.m_magnitude.resize(n);
+    SmithMath::gammaMagnitude(values.data(), index.m_magnitude.data(), values.size());
+    
+    // Internal nodes bottom-up; node v covers leaves 2v and 2v + 1
+    int leaves = 1;
+    while (leaves < n) leaves <<= 1;
+    index.m_leaves = leaves;
+    index.m_minTree.assign(leaves, INF);
+    index.m_maxTree.assign(leaves, -INF);
+    const double* mag = index.m_magnitude.data();
+    for (int v = leaves - 1; v >= 1; --v) {
+        const int left = 2 * v;
+        const int right = left + 1;
+        if (left >= leaves) {
+            const int i = left - leaves;
+            index.m_minTree[v] = std::min(i < n ? mag[i] : INF, i + 1 < n ? mag[i + 1] : INF);
+            index.m_maxTree[v] = std::max(i < n ? mag[i] : -INF, i + 1 < n ? mag[i + 1] : -INF);
+        } else {
+            index.m_minTree[v] = std::min(index.m_minTree[left], index.m_minTree[right]);
+            index.m_maxTree[v] = std::max(index.m_maxTree[left], index.m_maxTree[right]);
+        }
+    }
+    return index;
+}
+
+std::size_t ReflectionIndex::memoryBytes() const
+{
+    return (m_magnitude.capacity() + m_minTree.capacity() + m_maxTree.capacity()) * sizeof(double);
+}
+
+void ReflectionIndex::indexRange(double fLow, double fHigh, int& first, int& last) const
+{
+    if (isEmpty()) {
+        first = last = 0;
+        return;
+    }
+    const std::vector<double>& freqs = *m_frequencies;
+    first = static_cast<int>(std::lower_bound(freqs.begin(), freqs.end(), fLow) - freqs.begin());
+    last = static_cast<int>(std::upper_bound(freqs.begin(), freqs.end(), fHigh) - freqs.begin());
+    last = std::max(first, last);
+}
+
+double ReflectionIndex::rangeMin(int first, int last) const
+{
+    double result = INF;
+    int l = first + m_leaves;
+    int r = last + m_leaves;
+    while (l < r) {
+        if (l & 1) {
+            result = std::min(result, l >= m_leaves ? m_magnitude[l - m_leaves] : m_minTree[l]);
+            ++l;
+        }
+        if (r & 1) {
+            --r;
+            result = std::min(result, r >= m_leaves ? m_magnitude[r - m_leaves] : m_minTree[r]);
+        }
+        l >>= 1;
+        r >>= 1;
+    }
+    return result;
+}
+
+double ReflectionIndex::rangeMax(int first, int last) const
+{
+    double result = -INF;
+    int l = first + m_leaves;
+    int r = last + m_leaves;
+    while (l < r) {
+        if (l & 1) {
+            result = std::max(result, l >= m_leaves ? m_magnitude[l - m_leaves] : m_maxTree[l]);
+            ++l;
+        }
+        if (r & 1) {
+            --r;
+            result = std::max(result, r >= m_leaves ? m_magnitude[r - m_leaves] : m_maxTree[r]);
+        }
+        l >>= 1;
+        r >>= 1;
+    }
+    return result;
+}
+
+template <class Pred>
+int ReflectionIndex::findForward(const std::vector<double>& tree, double pad, int from,
+                                 Pred pred) const
+{
+    const int n = size();
+    if (from >= n) return n;
+    
+    // Padding leaves hold pad, which never satisfies pred
+    auto value = [&](int node) {
+        if (node < m_leaves) return tree[node];
+        const int i = node - m_leaves;
+        return i < n ? m_magnitude[i] : pad;
+    };
+    
+    int node = std::max(from, 0) + m_leaves;
+    while (true) {
+        if (pred(value(node))) {
+            while (node < m_leaves) {
+                node = 2 * node;
+                if (!pred(value(node))) ++node;
+            }
+            return node - m_leaves;
+        }
+        // Up past every subtree this one is the right half of, then right
+        while (node > 1 && (node & 1)) node >>= 1;
+        if (node == 1) return n;
+        ++node;
+    }
+}
+
+template <class Pred>
+int ReflectionIndex::findBackward(const std::vector<double>& tree, double pad, int before,
+                                  Pred pred) const
+{
+    const int n = size();
+    if (before <= 0) return -1;
+    
+    auto value = [&](int node) {
+        if (node < m_leaves) return tree[node];
+        const int i = node - m_leaves;
+        return i < n ? m_magnitude[i] : pad;
+    };
+    
+    int node = std::min(before, n) - 1 + m_leaves;
+    while (true) {
+        if (pred(value(node))) {
+            while (node < m_leaves) {
+                node = 2 * node + 1;
+                if (!pred(value(node))) --node;
+            }
+            return node - m_leaves;
+        }
+        while (node > 1 && !(node & 1)) node >>= 1;
+        if (node == 1) return -1;
+        --node;
+    }
+}
+
+double ReflectionIndex::crossingFrequency(int index, double threshold) const
+{
+    // Linear in dB, as the reflection is plotted
+    const double a = magnitudeDb(m_magnitude[index]);
+    const double b = magnitudeDb(m_magnitude[index + 1]);
+    const double f1 = frequency(index);
+    const double f2 = frequency(index + 1);
+    if (a == b) return f1;
+    const double t = std::clamp((magnitudeDb(threshold) - a) / (b - a), 0.0, 1.0);
+    return f1 + t * (f2 - f1);
+}
+
+BandExtreme ReflectionIndex::minimum(double fLow, double fHigh) const
+{
+    BandExtreme result;
+    int first, last;
+    indexRange(fLow, fHigh, first, last);
+    if (first >= last) return result;
+    
+    const double lowest = rangeMin(first, last);
+    result.index = findForward(m_minTree, INF, first, [lowest](double v) { return v <= lowest; });
+    result.frequency = frequency(result.index);
+    result.magnitude = m_magnitude[result.index];
+    return result;
+}
+
+BandExtreme ReflectionIndex::maximum(double fLow, double fHigh) const
+{
+    BandExtreme result;
+    int first, last;
+    indexRange(fLow, fHigh, first, last);
+    if (first >= last) return result;
+    
+    const double highest = rangeMax(first, last);
+    result.index = findForward(m_maxTree, -INF, first, [highest](double v) { return v >= highest; });
+    result.frequency = frequency(result.index);
+    result.magnitude = m_magnitude[result.index];
+    return result;
+}
+
+BandEdges ReflectionIndex::bandAround(double frequency, double returnLossDb) const
+{
+    BandEdges band;
+    if (isEmpty()) return band;
+    
+    const std::vector<double>& freqs = *m_frequencies;
+    const int n = size();
+    int center = static_cast<int>(std::lower_bound(freqs.begin(), freqs.end(), frequency) - freqs.begin());
+    if (center == n || (center > 0 && frequency - freqs[center - 1] < freqs[center] - frequency)) {
+        --center;
+    }
+    
+    const double threshold = thresholdMagnitude(returnLossDb);
+    if (m_magnitude[center] > threshold) return band;
+    
+    auto above = [threshold](double v) { return v > threshold; };
+    const int left = findBackward(m_maxTree, -INF, center, above);
+    const int right = findForward(m_maxTree, -INF, center + 1, above);
+    
+    band.lowOpen = left < 0;
+    band.highOpen = right >= n;
+    band.low = band.lowOpen ? freqs.front() : crossingFrequency(left, threshold);
+    band.high = band.highOpen ? freqs.back() : crossingFrequency(right - 1, threshold);
+    band.valid = true;
+    return band;
+}
+
+std::vector<ThresholdCrossing> ReflectionIndex::crossings(double returnLossDb, double fLow,
+                                                          double fHigh, int maxCount) const
+{
+    std::vector<ThresholdCrossing> result;
+    int first, last;
+    indexRange(fLow, fHigh, first, last);
+    if (last - first < 2) return result;
+    
+    // Alternate between the next point above and the next one back below
+    const double threshold = thresholdMagnitude(returnLossDb);
+    bool above = m_magnitude[first] > threshold;
+    int pos = first;
+    while (static_cast<int>(result.size()) < maxCount) {
+        const int next = above
+            ? findForward(m_minTree, INF, pos, [threshold](double v) { return v <= threshold; })
+            : findForward(m_maxTree, -INF, pos, [threshold](double v) { return v > threshold; });
+        if (next >= last) break;
+        
+        ThresholdCrossing crossing;
+        crossing.frequency = crossingFrequency(next - 1, threshold);
+        crossing.rising = !above;
+        result.push_back(crossing);
+        above = !above;
+        pos = next;
+    }
+    return result;
+}
+
+std::shared_ptr<const ReflectionIndex> BandAnalyzer::cached(const std::shared_ptr<const SParamData>& data,
+                                                            int port) const
+{
+    return m_cache.find(data, port);
+}
+
+void BandAnalyzer::insert(const std::shared_ptr<const SParamData>& data,
+                          std::shared_ptr<const ReflectionIndex> index)
+{
+    const int port = index->port();
+    m_cache.insert(data, port, std::move(index));
+}
+
+} // namespace SmithTool
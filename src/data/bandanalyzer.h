@@ -0,0 +1,150 @@
+/**
+ * @file bandanalyzer.h
+ * @brief Marker search and bandwidth queries over measured reflections
+ */
+
+#ifndef SMITHTOOL_BANDANALYZER_H
+#define SMITHTOOL_BANDANALYZER_H
+
+#include "datasetcache.h"
+#include "sparamdata.h"
+#include <memory>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief A measured point found by a range query
+ */
+struct BandExtreme {
+    int index = -1;
+    double frequency = 0.0;
+    double magnitude = 0.0;     // |Γ|
+    
+    bool isValid() const { return index >= 0; }
+    double returnLossDb() const;    // Negative dB, as in SmithMath
+    double vswr() const;
+};
+
+/**
+ * @brief Frequency span over which a reflection stays below a threshold
+ *
+ * Edges are interpolated between the measured points around each
+ * crossing. An edge that reaches the end of the data is open: the band
+ * may extend beyond what was measured.
+ */
+struct BandEdges {
+    double low = 0.0;
+    double high = 0.0;
+    bool lowOpen = false;
+    bool highOpen = false;
+    bool valid = false;
+    
+    double width() const { return high - low; }
+    double center() const { return 0.5 * (low + high); }
+};
+
+/**
+ * @brief Point where |Γ| crosses a threshold, interpolated
+ */
+struct ThresholdCrossing {
+    double frequency = 0.0;
+    bool rising = false;        // |Γ| goes above the threshold here
+};
+
+/**
+ * @brief Range-query index over |Γ| of one reflection
+ *
+ * |Γ| is computed for all points in one batch pass; return loss and VSWR
+ * are monotonic in it, so every query is answered on |Γ| alone and
+ * converted at the end. Minimum and maximum trees (the leaves are the
+ * magnitudes themselves) give range extremes and the next threshold
+ * crossing in O(log n), so moving band limits never rescans the data.
+ *
+ * Immutable once built; may be shared between threads.
+ */
+class ReflectionIndex {
+public:
+    /**
+     * @brief Index |Sii| of a dataset
+     * @return Empty index if the data has no such port
+     */
+    static ReflectionIndex build(const SParamData& data, int port);
+    
+    int size() const { return static_cast<int>(m_magnitude.size()); }
+    bool isEmpty() const { return m_magnitude.empty(); }
+    int port() const { return m_port; }
+    
+    double frequency(int index) const { return (*m_frequencies)[index]; }
+    double magnitude(int index) const { return m_magnitude[index]; }
+    double minFrequency() const { return isEmpty() ? 0.0 : m_frequencies->front(); }
+    double maxFrequency() const { return isEmpty() ? 0.0 : m_frequencies->back(); }
+    
+    // Best (lowest |Γ|) and worst measured points in [fLow, fHigh]
+    BandExtreme minimum(double fLow, double fHigh) const;
+    BandExtreme maximum(double fLow, double fHigh) const;
+    
+    /**
+     * @brief Band around a frequency where return loss meets a threshold
+     * @param frequency Frequency inside the band, usually the best match
+     * @param returnLossDb Threshold as SmithMath::gammaToReturnLoss()
+     *                     gives it (negative dB, e.g. -10)
+     * @return Invalid if the point nearest frequency misses the threshold
+     */
+    BandEdges bandAround(double frequency, double returnLossDb) const;
+    
+    /**
+     * @brief All threshold crossings in [fLow, fHigh], in frequency order
+     * @param maxCount Stop after this many
+     */
+    std::vector<ThresholdCrossing> crossings(double returnLossDb, double fLow, double fHigh,
+                                             int maxCount = 256) const;
+    
+    // Bytes held by the magnitudes and trees
+    std::size_t memoryBytes() const;
+
+private:
+    std::shared_ptr<const std::vector<double>> m_frequencies;  // Shared with the data
+    std::vector<double> m_magnitude;
+    std::vector<double> m_minTree;      // Internal nodes [1, m_leaves); 0 unused
+    std::vector<double> m_maxTree;
+    int m_leaves = 0;                   // Power of two >= size()
+    int m_port = 0;
+    
+    // Points with f in [fLow, fHigh] as [first, last)
+    void indexRange(double fLow, double fHigh, int& first, int& last) const;
+    double rangeMin(int first, int last) const;
+    double rangeMax(int first, int last) const;
+    
+    // First index >= from (last index < before) whose |Γ| satisfies
+    // pred, using the tree that bounds it; size() (-1) if none
+    template <class Pred>
+    int findForward(const std::vector<double>& tree, double pad, int from, Pred pred) const;
+    template <class Pred>
+    int findBackward(const std::vector<double>& tree, double pad, int before, Pred pred) const;
+    
+    // Interpolated frequency where |Γ| reaches threshold between index and index + 1
+    double crossingFrequency(int index, double threshold) const;
+};
+
+/**
+ * @brief Builds and caches reflection indexes of datasets
+ *
+ * Indexes are cached per dataset object and port in a DatasetCache.
+ */
+class BandAnalyzer {
+public:
+    // Cached index of this dataset object and port, or null
+    std::shared_ptr<const ReflectionIndex> cached(const std::shared_ptr<const SParamData>& data,
+                                                  int port) const;
+    void insert(const std::shared_ptr<const SParamData>& data,
+                std::shared_ptr<const ReflectionIndex> index);
+    void clear() { m_cache.clear(); }
+
+private:
+    DatasetCache<int, ReflectionIndex> m_cache;     // Keyed by port
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_BANDANALYZER_H
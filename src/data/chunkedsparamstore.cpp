@@ -0,0 +1,149 @@
+/**
+ * @file chunkedsparamstore.cpp
+ * @brief Append-only chunked S-parameter storage implementation
+ */
+
+#include "chunkedsparamstore.h"
+#include <algorithm>
+
+namespace SmithTool {
+
+ChunkedSParamStore::ChunkedSParamStore(int numPorts, Precision precision)
+    : m_numPoints(0)
+    , m_numPorts(numPorts > 0 ? numPorts : 1)
+    , m_precision(precision)
+    , m_z0(50.0)
+    , m_ascending(true)
+{
+}
+
+void ChunkedSParamStore::reset(int numPorts, Precision precision)
+{
+    m_chunks.clear();
+    m_numPoints = 0;
+    m_numPorts = numPorts > 0 ? numPorts : 1;
+    m_precision = precision;
+    m_ascending = true;
+}
+
+void ChunkedSParamStore::addChunk()
+{
+    const int n = matrixSize();
+    m_chunks.emplace_back();
+    Chunk& chunk = m_chunks.back();
+    chunk.frequencies.reserve(CHUNK_POINTS);
+    if (m_precision == Precision::Float) {
+        chunk.valuesF.resize(n);
+        for (auto& values : chunk.valuesF) values.reserve(CHUNK_POINTS);
+    } else {
+        chunk.values.resize(n);
+        for (auto& values : chunk.values) values.reserve(CHUNK_POINTS);
+    }
+}
+
+void ChunkedSParamStore::append(double frequency, const Complex* matrix)
+{
+    if (m_numPoints > 0 && frequency <= this->frequency(m_numPoints - 1)) {
+        m_ascending = false;
+    }
+    if (m_numPoints % CHUNK_POINTS == 0) {
+        addChunk();
+    }
+    
+    Chunk& chunk = m_chunks.back();
+    chunk.frequencies.push_back(frequency);
+    const int n = matrixSize();
+    if (m_precision == Precision::Float) {
+        for (int k = 0; k < n; ++k) {
+            chunk.valuesF[k].emplace_back(static_cast<float>(matrix[k].real()),
+                                          static_cast<float>(matrix[k].imag()));
+        }
+    } else {
+        for (int k = 0; k < n; ++k) {
+            chunk.values[k].push_back(matrix[k]);
+        }
+    }
+    ++m_numPoints;
+}
+
+double ChunkedSParamStore::frequency(qint64 index) const
+{
+    if (index < 0 || index >= m_numPoints) return 0.0;
+    return m_chunks[index / CHUNK_POINTS].frequencies[index % CHUNK_POINTS];
+}
+
+Complex ChunkedSParamStore::s(qint64 index, int row, int col) const
+{
+    if (index < 0 || index >= m_numPoints ||
+        row < 0 || row >= m_numPorts || col < 0 || col >= m_numPorts) {
+        return Complex(0, 0);
+    }
+    
+    const Chunk& chunk = m_chunks[index / CHUNK_POINTS];
+    const int k = row * m_numPorts + col;
+    const qint64 i = index % CHUNK_POINTS;
+    if (m_precision == Precision::Float) {
+        const ComplexF& v = chunk.valuesF[k][i];
+        return Complex(v.real(), v.imag());
+    }
+    return chunk.values[k][i];
+}
+
+qint64 ChunkedSParamStore::memoryBytes() const
+{
+    const qint64 valueBytes = (m_precision == Precision::Float) ? sizeof(ComplexF) : sizeof(Complex);
+    const qint64 perPoint = sizeof(double) + matrixSize() * valueBytes;
+    return static_cast<qint64>(m_chunks.size()) * CHUNK_POINTS * perPoint;
+}
+
+SParamData ChunkedSParamStore::toSParamData(qint64 maxPoints) const
+{
+    SParamData data;
+    data.setNumPorts(m_numPorts);
+    data.setReferenceImpedance(m_z0);
+    if (m_numPoints == 0) {
+        return data;
+    }
+    
+    // Stride so that the sampled indices plus the last point fit maxPoints
+    qint64 stride = 1;
+    if (maxPoints > 0 && m_numPoints > maxPoints) {
+        const qint64 steps = std::max<qint64>(maxPoints - 2, 1);
+        stride = (m_numPoints - 1 + steps - 1) / steps;
+    }
+    
+    std::vector<qint64> indices;
+    indices.reserve(static_cast<size_t>(m_numPoints / stride + 1));
+    for (qint64 i = 0; i < m_numPoints; i += stride) {
+        indices.push_back(i);
+    }
+    if (indices.back() != m_numPoints - 1) {
+        indices.push_back(m_numPoints - 1);
+    }
+    
+    const int n = matrixSize();
+    std::vector<Complex> matrix(n);
+    if (!m_ascending) {
+        // addPoint() keeps the data sorted
+        data.reserve(static_cast<int>(indices.size()));
+        for (qint64 i : indices) {
+            for (int k = 0; k < n; ++k) matrix[k] = s(i, k / m_numPorts, k % m_numPorts);
+            data.addPoint(frequency(i), matrix.data());
+        }
+        return data;
+    }
+    
+    std::vector<double> frequencies(indices.size());
+    std::vector<std::vector<Complex>> params(n, std::vector<Complex>(indices.size()));
+    for (size_t j = 0; j < indices.size(); ++j) {
+        const qint64 i = indices[j];
+        frequencies[j] = frequency(i);
+        for (int k = 0; k < n; ++k) {
+            params[k][j] = s(i, k / m_numPorts, k % m_numPorts);
+        }
+    }
+    data.assignPoints(std::move(frequencies), std::move(params));
+    return data;
+}
+
+} // namespace SmithTool
@@ -0,0 +1,99 @@
+/**
+ * @file chunkedsparamstore.h
+ * @brief Append-only chunked S-parameter storage for streaming ingest
+ */
+
+#ifndef SMITHTOOL_CHUNKEDSPARAMSTORE_H
+#define SMITHTOOL_CHUNKEDSPARAMSTORE_H
+
+#include "sparamdata.h"
+#include <QtGlobal>
+#include <complex>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief Structure-of-arrays store that grows in fixed-size chunks
+ *
+ * Same layout as SParamData (a frequency array plus one array per Sij)
+ * but split into CHUNK_POINTS blocks, so appending never reallocates or
+ * copies the points already stored. Values can be kept in single
+ * precision, which halves their memory; frequencies always stay double.
+ */
+class ChunkedSParamStore {
+public:
+    enum class Precision {
+        Double,     // 16 bytes per complex value
+        Float       // 8 bytes per complex value
+    };
+    
+    explicit ChunkedSParamStore(int numPorts = 1, Precision precision = Precision::Double);
+    
+    /**
+     * @brief Drop all points and change the layout
+     */
+    void reset(int numPorts, Precision precision);
+    
+    int numPorts() const { return m_numPorts; }
+    int matrixSize() const { return m_numPorts * m_numPorts; }
+    Precision precision() const { return m_precision; }
+    
+    qint64 numPoints() const { return m_numPoints; }
+    bool isEmpty() const { return m_numPoints == 0; }
+    
+    // Whether every frequency appended so far was above the previous one
+    bool isAscending() const { return m_ascending; }
+    
+    /**
+     * @brief Append one point from a row-major N×N matrix
+     */
+    void append(double frequency, const Complex* matrix);
+    
+    double frequency(qint64 index) const;
+    Complex s(qint64 index, int row, int col) const;
+    
+    /**
+     * @brief Bytes held by the point arrays (capacity, not just size)
+     */
+    qint64 memoryBytes() const;
+    
+    /**
+     * @brief Copy the points into an SParamData
+     *
+     * With maxPoints > 0 and more points stored, every k-th point is taken
+     * (always including the last one) so the result has at most maxPoints
+     * points; this bounds the cost of progress previews and of handing
+     * huge files to the UI.
+     *
+     * @param maxPoints Point limit, 0 for all points
+     */
+    SParamData toSParamData(qint64 maxPoints = 0) const;
+    
+    double referenceImpedance() const { return m_z0; }
+    void setReferenceImpedance(double z0) { m_z0 = z0; }
+    
+    static constexpr int CHUNK_POINTS = 1 << 16;
+
+private:
+    using ComplexF = std::complex<float>;
+    
+    struct Chunk {
+        std::vector<double> frequencies;
+        std::vector<std::vector<Complex>> values;     // Precision::Double
+        std::vector<std::vector<ComplexF>> valuesF;   // Precision::Float
+    };
+    
+    std::vector<Chunk> m_chunks;
+    qint64 m_numPoints;
+    int m_numPorts;
+    Precision m_precision;
+    double m_z0;
+    bool m_ascending;
+    
+    void addChunk();
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_CHUNKEDSPARAMSTORE_H
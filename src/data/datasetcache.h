@@ -0,0 +1,94 @@
+/**
+ * @file datasetcache.h
+ * @brief Small LRU cache of results keyed by dataset identity
+ */
+
+#ifndef SMITHTOOL_DATASETCACHE_H
+#define SMITHTOOL_DATASETCACHE_H
+
+#include "sparamdata.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief Key for results that depend on nothing but the dataset
+ */
+struct NoCacheKey {
+    bool operator==(const NoCacheKey&) const { return true; }
+};
+
+/**
+ * @brief Results computed from datasets, keyed by the dataset object
+ *        and the settings used
+ *
+ * Datasets are identified by their shared_ptr owner, not their contents,
+ * and held weakly: results of destroyed datasets are never returned and
+ * are dropped on the next insert. At most Capacity entries are kept,
+ * least recently used evicted first.
+ *
+ * Not synchronized; a cache belongs to the thread that uses it. find()
+ * is const but reorders the entries.
+ */
+template <class Key, class Value, int Capacity = 4>
+class DatasetCache {
+public:
+    // Cached result for this dataset object and key, or null
+    std::shared_ptr<const Value> find(const std::shared_ptr<const SParamData>& data,
+                                      const Key& key) const
+    {
+        auto it = locate(data, key);
+        if (it == m_entries.end()) return nullptr;
+        std::rotate(m_entries.begin(), it, it + 1);
+        return m_entries.front().value;
+    }
+    
+    // Replaces any result for the same dataset and key
+    void insert(const std::shared_ptr<const SParamData>& data, const Key& key,
+                std::shared_ptr<const Value> value)
+    {
+        m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                                       [&](const Entry& entry) {
+                                           return entry.data.expired() ||
+                                                  (sameDataset(entry.data, data) && entry.key == key);
+                                       }),
+                        m_entries.end());
+        m_entries.insert(m_entries.begin(), Entry{data, key, std::move(value)});
+        if (m_entries.size() > static_cast<std::size_t>(Capacity)) {
+            m_entries.resize(Capacity);
+        }
+    }
+    
+    void clear() { m_entries.clear(); }
+    int size() const { return static_cast<int>(m_entries.size()); }
+    
+    static constexpr int CAPACITY = Capacity;
+
+private:
+    struct Entry {
+        std::weak_ptr<const SParamData> data;
+        Key key;
+        std::shared_ptr<const Value> value;
+    };
+    mutable std::vector<Entry> m_entries;   // Most recently used first
+    
+    static bool sameDataset(const std::weak_ptr<const SParamData>& a,
+                            const std::shared_ptr<const SParamData>& b)
+    {
+        return !a.owner_before(b) && !b.owner_before(a);
+    }
+    
+    typename std::vector<Entry>::iterator locate(const std::shared_ptr<const SParamData>& data,
+                                                 const Key& key) const
+    {
+        return std::find_if(m_entries.begin(), m_entries.end(), [&](const Entry& entry) {
+            return !entry.data.expired() && sameDataset(entry.data, data) && entry.key == key;
+        });
+    }
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_DATASETCACHE_H
@@ -0,0 +1,366 @@
+/**
+ * @file deembedder.cpp
+ * @brief Fixture de-embedding, port extension and z0 renormalization implementation
+ */
+
+#include "deembedder.h"
+#include "../core/parallel.h"
+#include "../core/profiler.h"
+#include "../core/smithmath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SmithTool {
+
+namespace {
+
+// Relative slack when checking that a fixture covers the device sweep
+const double COVERAGE_TOLERANCE = 1e-9;
+
+// S-parameters of a fixture on the device axis: its own arrays when it
+// was measured on the same sweep, else interpolated copies
+struct AlignedFixture {
+    std::vector<Complex> storage[4];
+    const Complex* s[4] = {nullptr, nullptr, nullptr, nullptr};   // S11, S21, S12, S22
+    
+    SmithMath::TwoPortNetwork network(bool inverse) const
+    {
+        return {s[0], s[1], s[2], s[3], inverse};
+    }
+};
+
+bool sameAxis(const SParamData& a, const SParamData& b)
+{
+    return a.frequencyAxis() == b.frequencyAxis() || a.frequencyData() == b.frequencyData();
+}
+
+// Interpolation clamps outside the measured range, which would silently
+// extrapolate the network
+bool checkCoverage(const SParamData& device, const SParamData& network, const char* name,
+                   QString& error)
+{
+    const double span = std::max(std::abs(network.maxFrequency()), 1.0) * COVERAGE_TOLERANCE;
+    if (device.minFrequency() < network.minFrequency() - span ||
+        device.maxFrequency() > network.maxFrequency() + span) {
+        error = QString("The %1 network covers %2 to %3 Hz, the data %4 to %5 Hz")
+            .arg(name)
+            .arg(network.minFrequency(), 0, 'g', 10).arg(network.maxFrequency(), 0, 'g', 10)
+            .arg(device.minFrequency(), 0, 'g', 10).arg(device.maxFrequency(), 0, 'g', 10);
+        return false;
+    }
+    return true;
+}
+
+bool checkFixture(const SParamData& device, const SParamData& fixture, const char* name,
+                  QString& error)
+{
+    if (fixture.numPorts() != 2 || fixture.isEmpty()) {
+        error = QString("The %1 fixture must be a two-port with data").arg(name);
+        return false;
+    }
+    if (fixture.referenceImpedance() != device.referenceImpedance()) {
+        error = QString("The %1 fixture is referenced to %2 ohm, the data to %3 ohm; "
+                        "renormalize one of them first")
+            .arg(name).arg(fixture.referenceImpedance()).arg(device.referenceImpedance());
+        return false;
+    }
+    
+    return checkCoverage(device, fixture, name, error);
+}
+
+// Result dataset with the ports, reference and name of source
+SParamData emptyLike(const SParamData& source, int ports)
+{
+    SParamData result;
+    result.setNumPorts(ports);
+    result.setReferenceImpedance(source.referenceImpedance());
+    result.setFilename(source.filename());
+    return result;
+}
+
+std::vector<std::vector<Complex>> allocateParams(int ports, int points)
+{
+    return std::vector<std::vector<Complex>>(static_cast<size_t>(ports) * ports,
+                                             std::vector<Complex>(points));
+}
+
+// X = (I - rS)⁻¹ (S - rI) for one n×n row-major matrix; both factors are
+// functions of S, so they commute. a holds n × 2n workspace values.
+void renormalizeMatrix(const Complex* s, int n, double r, Complex* x, Complex* a)
+{
+    const int w = 2 * n;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            const Complex v = s[i * n + j];
+            a[i * w + j] = (i == j ? 1.0 : 0.0) - r * v;
+            a[i * w + n + j] = v - (i == j ? r : 0.0);
+        }
+    }
+    
+    // Gauss-Jordan with partial pivoting on [I - rS | S - rI]
+    for (int c = 0; c < n; ++c) {
+        int pivot = c;
+        for (int i = c + 1; i < n; ++i) {
+            if (std::norm(a[i * w + c]) > std::norm(a[pivot * w + c])) pivot = i;
+        }
+        if (pivot != c) {
+            std::swap_ranges(a + pivot * w, a + pivot * w + w, a + c * w);
+        }
+        const Complex inv = 1.0 / a[c * w + c];
+        for (int j = c; j < w; ++j) a[c * w + j] *= inv;
+        for (int i = 0; i < n; ++i) {
+            if (i == c) continue;
+            const Complex f = a[i * w + c];
+            if (f == Complex(0, 0)) continue;
+            for (int j = c; j < w; ++j) a[i * w + j] -= f * a[c * w + j];
+        }
+    }
+    
+    for (int i = 0; i < n; ++i) {
+        std::copy(a + i * w + n, a + i * w + w, x + i * n);
+    }
+}
+
+// Noise parameters seen with reference impedance z0 instead of z0old
+std::shared_ptr<const NoiseParameters> renormalizeNoise(const NoiseParameters& noise,
+                                                        double z0old, double z0)
+{
+    auto result = std::make_shared<NoiseParameters>(noise);
+    const double r = (z0 - z0old) / (z0 + z0old);
+    SmithMath::renormalizeReflections(noise.gammaOpt.data(), result->gammaOpt.data(),
+                                      noise.gammaOpt.size(), r);
+    for (double& rn : result->rn) {
+        rn *= z0old / z0;
+    }
+    return result;
+}
+
+} // namespace
+
+Deembedder::Deembedder()
+    : m_threadCount(0)
+{
+}
+
+bool Deembedder::deembed(const SParamData& measured, const SParamData* left,
+                         const SParamData* right, SParamData& result, QString& error) const
+{
+    return applyFixtures(measured, left, right, true, result, error);
+}
+
+bool Deembedder::embed(const SParamData& device, const SParamData* left,
+                       const SParamData* right, SParamData& result, QString& error) const
+{
+    return applyFixtures(device, left, right, false, result, error);
+}
+
+bool Deembedder::cascade(const SParamData& first, const SParamData& second,
+                         SParamData& result, QString& error) const
+{
+    if (first.numPorts() != 2) {
+        error = QString("Only a two-port can be followed by another network");
+        return false;
+    }
+    if (first.isEmpty() || second.isEmpty()) {
+        error = QString("No data");
+        return false;
+    }
+    if (!checkCoverage(first, second, "second", error)) return false;
+    
+    // first is the left fixture of second, once second is on first's axis
+    const SParamData* device = &second;
+    SParamData resampled;
+    if (!sameAxis(first, second)) {
+        resampled = second.resample(first.frequencyData());
+        resampled.shareFrequencyAxis(first.frequencyAxis());
+        device = &resampled;
+    }
+    if (!applyFixtures(*device, &first, nullptr, false, result, error)) return false;
+    result.setFilename(first.filename());
+    return true;
+}
+
+bool Deembedder::applyFixtures(const SParamData& device, const SParamData* left,
+                               const SParamData* right, bool remove,
+                               SParamData& result, QString& error) const
+{
+    SMITHTOOL_PROFILE_SCOPE("Deembedder::applyFixtures");
+    
+    const int ports = device.numPorts();
+    if (device.isEmpty()) {
+        error = QString("No data");
+        return false;
+    }
+    if (ports > 2) {
+        error = QString("Fixtures can only be applied to one- and two-port data");
+        return false;
+    }
+    if (ports == 1 && right) {
+        error = QString("A one-port has no port 2 for a right fixture");
+        return false;
+    }
+    if (left && !checkFixture(device, *left, "left", error)) return false;
+    if (right && !checkFixture(device, *right, "right", error)) return false;
+    
+    // Align fixtures to the device axis, interpolating Sij in parallel
+    const std::vector<double>& freqs = device.frequencyData();
+    const int n = device.numPoints();
+    AlignedFixture aligned[2];
+    const SParamData* fixtures[2] = {left, right};
+    std::vector<std::pair<int, int>> jobs;     // (fixture, S index)
+    for (int f = 0; f < 2; ++f) {
+        if (!fixtures[f]) continue;
+        const bool shared = sameAxis(device, *fixtures[f]);
+        for (int k = 0; k < 4; ++k) {
+            // S11, S21, S12, S22 as (row, col) = (k & 1, k >> 1)
+            if (shared) {
+                aligned[f].s[k] = fixtures[f]->sData(k & 1, k >> 1).data();
+            } else {
+                jobs.emplace_back(f, k);
+            }
+        }
+    }
+    const int jobCount = static_cast<int>(jobs.size());
+    const int alignThreads = Parallel::workerCount(m_threadCount, static_cast<long long>(n) * jobCount,
+                                                   MIN_POINTS_PER_THREAD);
+    Parallel::parallelRanges(jobCount, alignThreads, [&](int begin, int end) {
+        for (int j = begin; j < end; ++j) {
+            const int f = jobs[j].first;
+            const int k = jobs[j].second;
+            aligned[f].storage[k] = fixtures[f]->interpolate(freqs, k & 1, k >> 1);
+        }
+    });
+    for (const auto& job : jobs) {
+        aligned[job.first].s[job.second] = aligned[job.first].storage[job.second].data();
+    }
+    
+    // Removal cascades the inverse fixtures around the measurement
+    std::vector<SmithMath::TwoPortNetwork> chain;
+    if (left) chain.push_back(aligned[0].network(remove));
+    if (ports == 2) {
+        chain.push_back({device.sData(0, 0).data(), device.sData(1, 0).data(),
+                         device.sData(0, 1).data(), device.sData(1, 1).data(), false});
+    }
+    if (right) chain.push_back(aligned[1].network(remove));
+    
+    std::vector<std::vector<Complex>> params = allocateParams(ports, n);
+    const int chainLength = static_cast<int>(chain.size());
+    const int threads = Parallel::workerCount(m_threadCount, static_cast<long long>(n) * chainLength,
+                                              MIN_POINTS_PER_THREAD);
+    Parallel::parallelRanges(n, threads, [&](int begin, int end) {
+        // The same chain, offset to this range
+        SmithMath::TwoPortNetwork local[SmithMath::MAX_CASCADE];
+        for (int k = 0; k < chainLength; ++k) {
+            local[k] = {chain[k].s11 + begin, chain[k].s21 + begin,
+                        chain[k].s12 + begin, chain[k].s22 + begin, chain[k].inverse};
+        }
+        const std::size_t count = static_cast<std::size_t>(end - begin);
+        if (ports == 1) {
+            // A one-port terminates the chain; removal walks it back
+            const Complex* load = device.sData(0, 0).data() + begin;
+            Complex* gamma = params[0].data() + begin;
+            if (chainLength == 0) {
+                std::copy(load, load + count, gamma);
+            } else {
+                SmithMath::terminateTwoPorts(local, chainLength, load, gamma, count);
+            }
+            return;
+        }
+        SmithMath::TwoPortOutputArrays out = {params[0].data() + begin, params[2].data() + begin,
+                                              params[1].data() + begin, params[3].data() + begin};
+        SmithMath::cascadeTwoPorts(local, chainLength, count, out);
+    });
+    
+    result = emptyLike(device, ports);
+    return result.assignPoints(device.frequencyAxis(), std::move(params));
+}
+
+bool Deembedder::extendPorts(const SParamData& data, const std::vector<double>& delays,
+                             SParamData& result, QString& error) const
+{
+    SMITHTOOL_PROFILE_SCOPE("Deembedder::extendPorts");
+    
+    const int ports = data.numPorts();
+    if (static_cast<int>(delays.size()) != ports) {
+        error = QString("Expected %1 port delays, got %2").arg(ports).arg(static_cast<int>(delays.size()));
+        return false;
+    }
+    
+    const std::vector<double>& freqs = data.frequencyData();
+    const int n = data.numPoints();
+    std::vector<std::vector<Complex>> params = allocateParams(ports, n);
+    const int threads = Parallel::workerCount(m_threadCount, static_cast<long long>(n) * ports * ports,
+                                              MIN_POINTS_PER_THREAD);
+    Parallel::parallelRanges(n, threads, [&](int begin, int end) {
+        // exp(j 2πf τi) per port; the pair rotation is the product of two
+        const int count = end - begin;
+        std::vector<std::vector<Complex>> phasors(ports, std::vector<Complex>(count));
+        for (int p = 0; p < ports; ++p) {
+            const double w = SmithMath::TWO_PI * delays[p];
+            for (int k = 0; k < count; ++k) {
+                phasors[p][k] = std::polar(1.0, w * freqs[begin + k]);
+            }
+        }
+        for (int row = 0; row < ports; ++row) {
+            for (int col = 0; col < ports; ++col) {
+                const Complex* in = data.sData(row, col).data() + begin;
+                Complex* out = params[row * ports + col].data() + begin;
+                SmithMath::multiplyComplex(in, phasors[row].data(), out, count);
+                SmithMath::multiplyComplex(out, phasors[col].data(), out, count);
+            }
+        }
+    });
+    
+    result = emptyLike(data, ports);
+    return result.assignPoints(data.frequencyAxis(), std::move(params));
+}
+
+bool Deembedder::renormalize(const SParamData& data, double z0, SParamData& result,
+                             QString& error) const
+{
+    SMITHTOOL_PROFILE_SCOPE("Deembedder::renormalize");
+    
+    const double z0old = data.referenceImpedance();
+    if (!(z0 > 0.0) || !(z0old > 0.0)) {
+        error = QString("Reference impedances must be positive");
+        return false;
+    }
+    const double r = (z0 - z0old) / (z0 + z0old);
+    
+    const int ports = data.numPorts();
+    const int n = data.numPoints();
+    std::vector<std::vector<Complex>> params = allocateParams(ports, n);
+    const int threads = Parallel::workerCount(m_threadCount, static_cast<long long>(n) * ports * ports,
+                                              MIN_POINTS_PER_THREAD);
+    Parallel::parallelRanges(n, threads, [&](int begin, int end) {
+        const std::size_t count = static_cast<std::size_t>(end - begin);
+        if (ports == 1) {
+            SmithMath::renormalizeReflections(data.sData(0, 0).data() + begin,
+                                              params[0].data() + begin, count, r);
+        } else if (ports == 2) {
+            SmithMath::TwoPortOutputArrays out = {params[0].data() + begin, params[2].data() + begin,
+                                                  params[1].data() + begin, params[3].data() + begin};
+            SmithMath::renormalizeTwoPorts(data.sData(0, 0).data() + begin, data.sData(1, 0).data() + begin,
+                                           data.sData(0, 1).data() + begin, data.sData(1, 1).data() + begin,
+                                           count, r, out);
+        } else {
+            // Larger networks: one small linear solve per point
+            const int m = ports * ports;
+            std::vector<Complex> s(m), x(m), work(2 * m);
+            for (int k = begin; k < end; ++k) {
+                for (int p = 0; p < m; ++p) s[p] = data.sData(p / ports, p % ports)[k];
+                renormalizeMatrix(s.data(), ports, r, x.data(), work.data());
+                for (int p = 0; p < m; ++p) params[p][k] = x[p];
+            }
+        }
+    });
+    
+    result = emptyLike(data, ports);
+    result.setReferenceImpedance(z0);
+    if (data.hasNoiseParameters()) {
+        result.setNoiseParameters(renormalizeNoise(*data.noiseParameters(), z0old, z0));
+    }
+    return result.assignPoints(data.frequencyAxis(), std::move(params));
+}
+
+} // namespace SmithTool
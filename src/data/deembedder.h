@@ -0,0 +1,103 @@
+/**
+ * @file deembedder.h
+ * @brief Fixture de-embedding, port extension and z0 renormalization
+ */
+
+#ifndef SMITHTOOL_DEEMBEDDER_H
+#define SMITHTOOL_DEEMBEDDER_H
+
+#include "sparamdata.h"
+#include <QString>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief Network operations that produce new datasets from measured ones
+ *
+ * Results are computed on the frequency axis of the dataset being
+ * corrected and share that axis instead of copying it. Fixtures measured
+ * on another sweep are interpolated onto it first (one batched merge
+ * walk per Sij); fixtures on the same sweep are used in place. Every
+ * operation is a vectorized pass over the per-Sij arrays (see SmithMath),
+ * split across threads by frequency range for large files.
+ *
+ * Fixtures are two-ports oriented along the measurement chain: port 2 of
+ * the left fixture faces port 1 of the device, port 1 of the right
+ * fixture faces port 2 of the device.
+ *
+ * Noise parameters describe the original reference planes, so results
+ * of fixture and port-extension operations carry none.
+ */
+class Deembedder {
+public:
+    Deembedder();
+    
+    /**
+     * @brief Limit the number of worker threads
+     * @param count Thread count (0 = one per hardware thread)
+     */
+    void setThreadCount(int count) { m_threadCount = count; }
+    int threadCount() const { return m_threadCount; }
+    
+    /**
+     * @brief Remove fixtures from a measurement
+     * @param measured One- or two-port measurement
+     * @param left Fixture in front of port 1, or null
+     * @param right Fixture behind port 2, or null (two-port measurements only)
+     * @return false with error set if the inputs do not fit together
+     */
+    bool deembed(const SParamData& measured, const SParamData* left, const SParamData* right,
+                 SParamData& result, QString& error) const;
+    
+    /**
+     * @brief Add fixtures to a device: what it would measure through them
+     */
+    bool embed(const SParamData& device, const SParamData* left, const SParamData* right,
+               SParamData& result, QString& error) const;
+    
+    /**
+     * @brief Connect port 2 of a two-port to port 1 of another network
+     * @param first Two-port; the result is on its frequency axis
+     * @param second Two-port, or a one-port terminating first
+     */
+    bool cascade(const SParamData& first, const SParamData& second,
+                 SParamData& result, QString& error) const;
+    
+    /**
+     * @brief Move the reference plane of each port by an electrical delay
+     *
+     * A positive delay moves the plane towards the device, removing a
+     * matched lossless line of that one-way delay: Sij is rotated by
+     * exp(+j 2πf (τi + τj)).
+     *
+     * @param delays One delay per port in seconds
+     */
+    bool extendPorts(const SParamData& data, const std::vector<double>& delays,
+                     SParamData& result, QString& error) const;
+    
+    /**
+     * @brief Convert the data to a new reference impedance on every port
+     *
+     * Unlike SParamData::setReferenceImpedance(), which only relabels,
+     * this recomputes S = (S - rI)(I - rS)⁻¹ with r = (z0 - z0old) /
+     * (z0 + z0old). Noise parameters are converted along.
+     *
+     * @param z0 New reference impedance in ohms (real, positive)
+     */
+    bool renormalize(const SParamData& data, double z0, SParamData& result,
+                     QString& error) const;
+    
+    static constexpr int MIN_POINTS_PER_THREAD = 16384;
+
+private:
+    int m_threadCount;
+    
+    bool applyFixtures(const SParamData& device, const SParamData* left,
+                       const SParamData* right, bool remove,
+                       SParamData& result, QString& error) const;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_DEEMBEDDER_H
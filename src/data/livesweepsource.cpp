@@ -0,0 +1,397 @@
+/**
+ * @file livesweepsource.cpp
+ * @brief Live one-port sweeps streamed from a VNA over TCP
+ */
+
+#include "livesweepsource.h"
+#include <QTcpSocket>
+#include <algorithm>
+#include <charconv>
+#include <string>
+
+namespace SmithTool {
+
+namespace {
+
+const int WAIT_SLICE_MS = 100;          // Reader checks for stop() this often
+const int MAX_AXIS_RETRIES = 3;         // Data/stimulus size mismatches in a row
+const std::size_t CHUNK_BYTES = 64 * 1024;
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Parse one number starting at p (after blanks), advancing p past it
+inline bool readNumber(const char*& p, const char* end, double& value)
+{
+    while (p < end && isBlank(*p)) ++p;
+    if (p >= end) return false;
+    
+    // std::from_chars does not accept a leading '+'
+    if (*p == '+') ++p;
+    
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+/**
+ * @brief Splits socket data into lines, reusing its buffers
+ */
+class LineReader {
+public:
+    enum class Status {
+        Data,
+        Idle,           // Nothing arrived within the wait
+        Closed
+    };
+    
+    LineReader() : m_chunk(CHUNK_BYTES), m_pos(0), m_scanned(0) {}
+    
+    // Next complete line, without the line ending
+    bool next(const char*& begin, const char*& end)
+    {
+        std::size_t eol = m_buffer.find('\n', std::max(m_pos, m_scanned));
+        if (eol == std::string::npos) {
+            m_scanned = m_buffer.size();
+            return false;
+        }
+        begin = m_buffer.data() + m_pos;
+        end = m_buffer.data() + eol;
+        if (end > begin && end[-1] == '\r') --end;
+        m_pos = eol + 1;
+        return true;
+    }
+    
+    // Append whatever the socket has, waiting up to waitMs for it
+    Status fill(QTcpSocket& socket, int waitMs)
+    {
+        if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(waitMs)) {
+            return socket.state() == QAbstractSocket::ConnectedState ? Status::Idle : Status::Closed;
+        }
+        
+        // Drop the lines already handed out; the capacity stays
+        m_buffer.erase(0, m_pos);
+        m_scanned -= std::min(m_scanned, m_pos);
+        m_pos = 0;
+        
+        qint64 n;
+        while ((n = socket.read(m_chunk.data(), static_cast<qint64>(m_chunk.size()))) > 0) {
+            m_buffer.append(m_chunk.data(), static_cast<std::size_t>(n));
+        }
+        return Status::Data;
+    }
+
+private:
+    std::string m_buffer;
+    std::vector<char> m_chunk;
+    std::size_t m_pos;          // Start of the first unread line
+    std::size_t m_scanned;      // No newline before this offset
+};
+
+} // namespace
+
+void LiveSweep::resize(int maxPoints)
+{
+    frequencies.resize(maxPoints);
+    values.resize(maxPoints);
+    points = 0;
+}
+
+// LiveSweepParser implementation
+
+LiveSweepParser::LiveSweepParser(int maxPoints)
+    : m_maxPoints(maxPoints)
+    , m_pending(0)
+    , m_frameBroken(false)
+    , m_errors(0)
+{
+    m_sweep.resize(maxPoints);
+}
+
+bool LiveSweepParser::parseRiLine(const char* begin, const char* end)
+{
+    const char* p = begin;
+    while (p < end && isBlank(*p)) ++p;
+    
+    // A blank line ends the sweep
+    if (p == end) {
+        bool complete = m_pending > 0 && !m_frameBroken;
+        if (complete) m_sweep.points = m_pending;
+        m_pending = 0;
+        m_frameBroken = false;
+        return complete;
+    }
+    
+    // Comments and Touchstone-style option lines
+    if (*p == '!' || *p == '#') return false;
+    if (m_frameBroken) return false;
+    
+    double freq, re, im;
+    if (m_pending >= m_maxPoints || !readNumber(p, end, freq) ||
+        !readNumber(p, end, re) || !readNumber(p, end, im)) {
+        // Drop the whole sweep rather than show a partial one
+        m_frameBroken = true;
+        ++m_errors;
+        return false;
+    }
+    m_sweep.frequencies[m_pending] = freq;
+    m_sweep.values[m_pending] = Complex(re, im);
+    ++m_pending;
+    return false;
+}
+
+int LiveSweepParser::parseList(const char* begin, const char* end, double* out, int maxValues)
+{
+    const char* p = begin;
+    int count = 0;
+    while (true) {
+        while (p < end && isBlank(*p)) ++p;
+        if (p == end) return count;
+        if (count == maxValues || !readNumber(p, end, out[count])) return -1;
+        ++count;
+        
+        while (p < end && isBlank(*p)) ++p;
+        if (p == end) return count;
+        if (*p != ',') return -1;
+        ++p;
+    }
+}
+
+// LiveSweepSource implementation
+
+LiveSweepSource::LiveSweepSource(QObject* parent)
+    : QObject(parent)
+    , m_running(false)
+    , m_stopRequested(false)
+    , m_received(0)
+    , m_dropped(0)
+    , m_front(0)
+{
+    m_poll.setInterval(POLL_INTERVAL_MS);
+    connect(&m_poll, &QTimer::timeout, this, [this]() {
+        if (m_ring && m_ring->readable() > 0) {
+            emit sweepAvailable();
+        }
+    });
+    
+    // The reader has returned; reap it before anyone else hears of it
+    connect(this, &LiveSweepSource::failed, this, [this]() {
+        m_poll.stop();
+        if (m_thread) m_thread->wait();
+    });
+}
+
+LiveSweepSource::~LiveSweepSource()
+{
+    stop();
+}
+
+bool LiveSweepSource::start(const LiveSweepSettings& settings, QString& error)
+{
+    if (isRunning()) {
+        error = tr("Live input is already running");
+        return false;
+    }
+    if (settings.host.isEmpty() || settings.port == 0 || settings.maxPoints < 1) {
+        error = tr("Invalid live input settings");
+        return false;
+    }
+    if (m_thread) {
+        m_thread->wait();
+    }
+    
+    // Slots are sized once here; the reader only writes into them
+    m_ring = std::make_unique<SpscRing<LiveSweep>>(RING_SLOTS);
+    for (std::size_t i = 0; i < m_ring->capacity(); ++i) {
+        m_ring->slot(i).resize(settings.maxPoints);
+    }
+    m_buffers[0].reset();
+    m_buffers[1].reset();
+    m_front = 0;
+    m_name = QString("%1:%2").arg(settings.host).arg(settings.port);
+    
+    m_stopRequested.store(false);
+    m_received.store(0);
+    m_dropped.store(0);
+    m_running.store(true, std::memory_order_release);
+    
+    // A QThread (not std::thread) so the socket has an event dispatcher
+    m_thread.reset(QThread::create([this, settings]() { run(settings); }));
+    m_thread->start();
+    m_poll.start();
+    return true;
+}
+
+void LiveSweepSource::stop()
+{
+    m_stopRequested.store(true);
+    m_poll.stop();
+    if (m_thread) {
+        m_thread->wait();
+        m_thread.reset();
+    }
+}
+
+std::shared_ptr<const SParamData> LiveSweepSource::takeLatest()
+{
+    if (!m_ring) return nullptr;
+    const std::size_t ready = m_ring->readable();
+    if (ready == 0) return nullptr;
+    
+    // Only the newest sweep is worth drawing
+    m_ring->endRead(ready - 1);
+    const LiveSweep* sweep = m_ring->beginRead();
+    
+    // Refill the buffer the chart is not drawing, unless it is still held
+    std::shared_ptr<SParamData>& back = m_buffers[1 - m_front];
+    if (!back || back.use_count() > 1) {
+        back = std::make_shared<SParamData>();
+        back->setFilename(m_name);
+    }
+    const Complex* values = sweep->values.data();
+    bool ok = back->copyPoints(sweep->frequencies.data(), &values, sweep->points);
+    m_ring->endRead();
+    if (!ok) return nullptr;
+    
+    m_front = 1 - m_front;
+    return back;
+}
+
+void LiveSweepSource::publish(const LiveSweep& sweep)
+{
+    LiveSweep* slot = m_ring->beginWrite();
+    if (!slot) {
+        // The GUI is behind; it only wants the newest sweep anyway
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::copy_n(sweep.frequencies.data(), sweep.points, slot->frequencies.data());
+    std::copy_n(sweep.values.data(), sweep.points, slot->values.data());
+    slot->points = sweep.points;
+    m_ring->endWrite();
+    m_received.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LiveSweepSource::run(const LiveSweepSettings& settings)
+{
+    QString error;
+    {
+        QTcpSocket socket;
+        socket.connectToHost(settings.host, settings.port);
+        if (!socket.waitForConnected(settings.timeoutMs)) {
+            error = tr("Cannot connect to %1: %2").arg(m_name, socket.errorString());
+        } else {
+            emit connected();
+            error = settings.protocol == LiveSweepSettings::Protocol::Scpi
+                ? readScpi(socket, settings) : readRiFrames(socket, settings);
+        }
+    }
+    
+    m_running.store(false, std::memory_order_release);
+    if (!error.isEmpty() && !m_stopRequested.load()) {
+        emit failed(error);
+    }
+}
+
+QString LiveSweepSource::readScpi(QTcpSocket& socket, const LiveSweepSettings& settings)
+{
+    LineReader reader;
+    LiveSweep sweep;
+    sweep.resize(settings.maxPoints);
+    std::vector<double> pairs(2 * static_cast<std::size_t>(settings.maxPoints));
+    
+    auto send = [&](const QByteArray& command) {
+        socket.write(command);
+        socket.write("\n", 1);
+        return socket.waitForBytesWritten(settings.timeoutMs);
+    };
+    
+    // One reply line; empty error means stop() was called
+    QString error;
+    auto reply = [&](const char*& begin, const char*& end) {
+        int waited = 0;
+        while (!reader.next(begin, end)) {
+            if (m_stopRequested.load(std::memory_order_relaxed)) return false;
+            LineReader::Status status = reader.fill(socket, WAIT_SLICE_MS);
+            if (status == LineReader::Status::Closed) {
+                error = tr("%1 closed the connection").arg(m_name);
+                return false;
+            }
+            if (status == LineReader::Status::Idle && (waited += WAIT_SLICE_MS) >= settings.timeoutMs) {
+                error = tr("No reply from %1").arg(m_name);
+                return false;
+            }
+        }
+        return true;
+    };
+    
+    if (!send(":FORM:DATA ASC")) {
+        return tr("Cannot write to %1: %2").arg(m_name, socket.errorString());
+    }
+    
+    const char* begin;
+    const char* end;
+    bool needAxis = true;
+    int mismatches = 0;
+    while (!m_stopRequested.load(std::memory_order_relaxed)) {
+        // The stimulus is read again whenever the point count changes
+        if (needAxis) {
+            if (!send(settings.frequencyQuery) || !reply(begin, end)) break;
+            int n = LiveSweepParser::parseList(begin, end, sweep.frequencies.data(), settings.maxPoints);
+            if (n <= 0) {
+                return tr("Unexpected frequency list from %1").arg(m_name);
+            }
+            sweep.points = n;
+            needAxis = false;
+        }
+        
+        if (!send(settings.dataQuery) || !reply(begin, end)) break;
+        int n = LiveSweepParser::parseList(begin, end, pairs.data(), 2 * settings.maxPoints);
+        if (n != 2 * sweep.points) {
+            // The sweep may have been reconfigured; give up if rereading does not help
+            if (++mismatches > MAX_AXIS_RETRIES) {
+                return tr("%1 returned %2 numbers for %3 frequencies")
+                    .arg(m_name).arg(n).arg(sweep.points);
+            }
+            needAxis = true;
+            continue;
+        }
+        mismatches = 0;
+        for (int i = 0; i < sweep.points; ++i) {
+            sweep.values[i] = Complex(pairs[2 * i], pairs[2 * i + 1]);
+        }
+        publish(sweep);
+    }
+    
+    if (error.isEmpty() && socket.state() != QAbstractSocket::ConnectedState &&
+        !m_stopRequested.load()) {
+        error = tr("Lost connection to %1: %2").arg(m_name, socket.errorString());
+    }
+    return error;
+}
+
+QString LiveSweepSource::readRiFrames(QTcpSocket& socket, const LiveSweepSettings& settings)
+{
+    LineReader reader;
+    LiveSweepParser parser(settings.maxPoints);
+    
+    // The instrument sets the pace; a quiet stream is not an error
+    while (!m_stopRequested.load(std::memory_order_relaxed)) {
+        const char* begin;
+        const char* end;
+        while (reader.next(begin, end)) {
+            if (parser.parseRiLine(begin, end)) {
+                publish(parser.sweep());
+            }
+        }
+        if (reader.fill(socket, WAIT_SLICE_MS) == LineReader::Status::Closed) {
+            return tr("%1 closed the connection").arg(m_name);
+        }
+    }
+    return QString();
+}
+
+} // namespace SmithTool
@@ -0,0 +1,181 @@
+/**
+ * @file livesweepsource.h
+ * @brief Live one-port sweeps streamed from a VNA over TCP
+ */
+
+#ifndef SMITHTOOL_LIVESWEEPSOURCE_H
+#define SMITHTOOL_LIVESWEEPSOURCE_H
+
+#include "sparamdata.h"
+#include "../core/spscring.h"
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QTcpSocket;
+
+namespace SmithTool {
+
+/**
+ * @brief Where and how live sweeps are read
+ */
+struct LiveSweepSettings {
+    enum class Protocol {
+        Scpi,           // Query the instrument for each sweep
+        RiFrames        // Instrument pushes "<Hz> <re> <im>" lines; a blank line ends a sweep
+    };
+    
+    Protocol protocol;
+    QString host;
+    quint16 port;                   // 5025 is the usual SCPI raw socket
+    QByteArray frequencyQuery;      // SCPI: stimulus values, comma separated
+    QByteArray dataQuery;           // SCPI: re,im pairs of the measured trace
+    int maxPoints;                  // Longest sweep accepted (buffers are sized once)
+    int timeoutMs;                  // Connect and SCPI reply timeout
+    
+    LiveSweepSettings()
+        : protocol(Protocol::Scpi)
+        , host("localhost")
+        , port(5025)
+        , frequencyQuery(":SENS1:FREQ:DATA?")
+        , dataQuery(":CALC1:DATA:SDAT?")
+        , maxPoints(20001)
+        , timeoutMs(3000) {}
+};
+
+/**
+ * @brief One sweep in flight between the reader thread and the GUI
+ */
+struct LiveSweep {
+    std::vector<double> frequencies;    // Sized for the longest sweep
+    std::vector<Complex> values;
+    int points = 0;                     // Valid entries
+    
+    void resize(int maxPoints);
+};
+
+/**
+ * @brief Parser for the text the instrument sends
+ *
+ * Works on complete lines in place (std::from_chars, locale
+ * independent) and fills a sweep sized up front, so parsing allocates
+ * nothing.
+ */
+class LiveSweepParser {
+public:
+    explicit LiveSweepParser(int maxPoints);
+    
+    /**
+     * @brief Feed one RI frame line (without the newline)
+     * @return true when the line completed a sweep, available in sweep()
+     *         until the next line is fed
+     */
+    bool parseRiLine(const char* begin, const char* end);
+    
+    /**
+     * @brief Parse a comma separated list of numbers
+     * @return Number of values, or -1 on a syntax error or more than maxValues
+     */
+    static int parseList(const char* begin, const char* end, double* out, int maxValues);
+    
+    const LiveSweep& sweep() const { return m_sweep; }
+    
+    // Points of the sweep being read (for RI frames)
+    int pendingPoints() const { return m_pending; }
+    
+    // Lines that could not be parsed, and sweeps dropped for them
+    quint64 errors() const { return m_errors; }
+
+private:
+    LiveSweep m_sweep;
+    int m_maxPoints;
+    int m_pending;
+    bool m_frameBroken;
+    quint64 m_errors;
+};
+
+/**
+ * @brief Reads sweeps on its own thread and hands them to the GUI
+ *
+ * The reader thread parses each sweep and pushes it through a lock-free
+ * single-producer/single-consumer ring of preallocated slots; a full
+ * ring drops the new sweep rather than waiting. The GUI side polls the
+ * ring once per frame interval and emits sweepAvailable(), so the
+ * reader never posts events however fast the instrument sweeps.
+ * takeLatest() skips to the newest sweep and copies it into one of two
+ * SParamData buffers in turn: the chart draws one while the other is
+ * being refilled. Once the buffers have grown, nothing is allocated
+ * per sweep on either thread.
+ */
+class LiveSweepSource : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LiveSweepSource(QObject* parent = nullptr);
+    ~LiveSweepSource() override;
+    
+    /**
+     * @brief Connect and start reading in the background
+     * @return false (error set) if already running or the settings are invalid
+     */
+    bool start(const LiveSweepSettings& settings, QString& error);
+    
+    /**
+     * @brief Stop reading and close the connection (waits for the reader)
+     */
+    void stop();
+    
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief The newest sweep since the last call, or null if none arrived
+     *
+     * GUI thread only. A buffer is rewritten in place only when nothing
+     * else still holds it, so the returned data stays valid as long as
+     * it is referenced.
+     */
+    std::shared_ptr<const SParamData> takeLatest();
+    
+    quint64 sweepsReceived() const { return m_received.load(std::memory_order_relaxed); }
+    quint64 sweepsDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    
+    static constexpr int RING_SLOTS = 4;
+    static constexpr int POLL_INTERVAL_MS = 15;     // GUI-side check, ~60 Hz
+
+signals:
+    void sweepAvailable();
+    void connected();
+    
+    /**
+     * @brief The reader stopped on an error (not emitted by stop())
+     */
+    void failed(const QString& error);
+
+private:
+    std::unique_ptr<QThread> m_thread;
+    QTimer m_poll;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_stopRequested;
+    std::atomic<quint64> m_received;
+    std::atomic<quint64> m_dropped;
+    std::unique_ptr<SpscRing<LiveSweep>> m_ring;
+    
+    // Double buffer on the GUI side
+    std::shared_ptr<SParamData> m_buffers[2];
+    int m_front;
+    QString m_name;
+    
+    void run(const LiveSweepSettings& settings);
+    QString readScpi(QTcpSocket& socket, const LiveSweepSettings& settings);
+    QString readRiFrames(QTcpSocket& socket, const LiveSweepSettings& settings);
+    void publish(const LiveSweep& sweep);
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_LIVESWEEPSOURCE_H
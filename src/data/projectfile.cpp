@@ -0,0 +1,417 @@
+/**
+ * @file projectfile.cpp
+ * @brief Binary project/session file implementation
+ */
+
+#include "projectfile.h"
+#include "sparamcache.h"
+#include <QDataStream>
+#include <QSaveFile>
+#include <cstring>
+
+namespace SmithTool {
+
+namespace {
+
+const char MAGIC[8] = {'S', 'M', 'T', 'P', 'R', 'O', 'J', '\0'};
+const quint32 VERSION = 1;
+
+// Sanity limit on the section table; far above any real project
+const quint32 MAX_SECTIONS = 1u << 20;
+
+enum SectionType : quint32 {
+    TraceSection = 1,
+    SettingsSection = 2,
+    DatasetIndexSection = 3,
+    DatasetSection = 4
+};
+
+struct Header {
+    char magic[8];
+    quint32 version;
+    quint32 headerSize;
+    quint32 sectionCount;
+    quint32 reserved;
+    quint64 tableOffset;
+};
+
+struct TableEntry {
+    quint32 type;
+    quint32 index;
+    quint64 offset;
+    quint64 size;
+    quint64 hash;           // Zero for datasets, which carry their own
+};
+
+static_assert(sizeof(Header) == 32, "project header must stay 32 bytes");
+static_assert(sizeof(TableEntry) == 32, "section entries must stay 32 bytes");
+
+quint64 align8(quint64 offset)
+{
+    return (offset + 7) & ~quint64(7);
+}
+
+void prepareStream(QDataStream& stream)
+{
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.setByteOrder(QDataStream::LittleEndian);
+}
+
+QByteArray encodeTrace(const ProjectState& state)
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    prepareStream(stream);
+    stream << state.sourceZ.real() << state.sourceZ.imag()
+           << state.loadZ.real() << state.loadZ.imag()
+           << state.z0 << state.frequency
+           << static_cast<quint32>(state.elements.size());
+    for (const ElementSpec& element : state.elements) {
+        stream << static_cast<qint32>(element.type)
+               << static_cast<qint32>(element.connection)
+               << element.value;
+    }
+    return bytes;
+}
+
+bool decodeTrace(const QByteArray& bytes, ProjectState& state)
+{
+    QDataStream stream(bytes);
+    prepareStream(stream);
+    
+    double sr, si, lr, li;
+    quint32 count;
+    stream >> sr >> si >> lr >> li >> state.z0 >> state.frequency >> count;
+    if (stream.status() != QDataStream::Ok) return false;
+    state.sourceZ = {sr, si};
+    state.loadZ = {lr, li};
+    
+    // Each element takes 16 bytes; reject counts the section cannot hold
+    if (count > static_cast<quint32>(bytes.size() / 16)) return false;
+    state.elements.clear();
+    state.elements.reserve(count);
+    for (quint32 i = 0; i < count; ++i) {
+        qint32 type, connection;
+        double value;
+        stream >> type >> connection >> value;
+        if (type < 0 || type >= static_cast<qint32>(ComponentType::None) ||
+            connection < 0 || connection > static_cast<qint32>(ConnectionType::Shunt)) {
+            return false;
+        }
+        state.elements.emplace_back(static_cast<ComponentType>(type),
+                                    static_cast<ConnectionType>(connection), value);
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+QByteArray encodeSettings(const ProjectState& state)
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    prepareStream(stream);
+    stream << state.settings;
+    return bytes;
+}
+
+bool decodeSettings(const QByteArray& bytes, ProjectState& state)
+{
+    QDataStream stream(bytes);
+    prepareStream(stream);
+    stream >> state.settings;
+    return stream.status() == QDataStream::Ok;
+}
+
+QByteArray encodeDatasetIndex(const ProjectState& state)
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    prepareStream(stream);
+    stream << static_cast<quint32>(state.datasets.size());
+    for (const ProjectDataset& dataset : state.datasets) {
+        stream << dataset.name
+               << static_cast<quint32>(dataset.role)
+               << static_cast<quint32>(dataset.color.rgba())
+               << dataset.visible
+               << static_cast<qint32>(dataset.data->numPorts())
+               << static_cast<qint64>(dataset.data->numPoints());
+    }
+    return bytes;
+}
+
+bool decodeDatasetIndex(const QByteArray& bytes, ProjectState& state)
+{
+    QDataStream stream(bytes);
+    prepareStream(stream);
+    
+    quint32 count;
+    stream >> count;
+    if (stream.status() != QDataStream::Ok || count > static_cast<quint32>(bytes.size())) {
+        return false;
+    }
+    state.datasets.clear();
+    state.datasets.resize(count);
+    for (ProjectDataset& dataset : state.datasets) {
+        quint32 role, rgba;
+        qint32 ports;
+        qint64 points;
+        stream >> dataset.name >> role >> rgba >> dataset.visible >> ports >> points;
+        if (role > static_cast<quint32>(ProjectDataset::Role::Overlay)) return false;
+        dataset.role = static_cast<ProjectDataset::Role>(role);
+        dataset.color = QColor::fromRgba(rgba);
+        dataset.numPorts = ports;
+        dataset.numPoints = points;
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+} // namespace
+
+ProjectFile::ProjectFile()
+    : m_bytes(nullptr)
+    , m_size(0)
+{
+}
+
+ProjectFile::~ProjectFile() = default;
+
+bool ProjectFile::write(const QString& path, const ProjectState& state, QString& error)
+{
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    error = QString("Project files are only supported on little-endian hosts");
+    return false;
+#endif
+
+    for (const ProjectDataset& dataset : state.datasets) {
+        if (!dataset.data) {
+            error = QString("Dataset %1 has no data").arg(dataset.name);
+            return false;
+        }
+    }
+    
+    // Small sections are encoded up front; datasets are streamed later
+    const QByteArray encoded[] = {encodeTrace(state), encodeSettings(state), encodeDatasetIndex(state)};
+    const quint32 encodedTypes[] = {TraceSection, SettingsSection, DatasetIndexSection};
+    const quint32 encodedCount = 3;
+    
+    const quint32 sectionCount = encodedCount + static_cast<quint32>(state.datasets.size());
+    std::vector<TableEntry> table(sectionCount);
+    quint64 offset = align8(sizeof(Header) + sectionCount * sizeof(TableEntry));
+    for (quint32 i = 0; i < sectionCount; ++i) {
+        TableEntry& entry = table[i];
+        if (i < encodedCount) {
+            entry.type = encodedTypes[i];
+            entry.index = 0;
+            entry.size = static_cast<quint64>(encoded[i].size());
+            entry.hash = SParamCache::hashBytes(
+                reinterpret_cast<const uchar*>(encoded[i].constData()), encoded[i].size());
+        } else {
+            entry.type = DatasetSection;
+            entry.index = i - encodedCount;
+            entry.size = static_cast<quint64>(SParamCache::encodedSize(*state.datasets[entry.index].data));
+            entry.hash = 0;
+        }
+        entry.offset = offset;
+        offset = align8(offset + entry.size);
+    }
+    
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(Header);
+    header.sectionCount = sectionCount;
+    header.tableOffset = sizeof(Header);
+    
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = QString("Cannot create file: %1").arg(path);
+        return false;
+    }
+    
+    const qint64 tableSize = static_cast<qint64>(table.size() * sizeof(TableEntry));
+    bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+    ok = ok && file.write(reinterpret_cast<const char*>(table.data()), tableSize) == tableSize;
+    
+    const char padding[8] = {};
+    for (quint32 i = 0; ok && i < sectionCount; ++i) {
+        const TableEntry& entry = table[i];
+        const qint64 gap = static_cast<qint64>(entry.offset) - file.pos();
+        ok = gap >= 0 && gap < 8 && file.write(padding, gap) == gap;
+        if (!ok) break;
+        
+        if (i < encodedCount) {
+            ok = file.write(encoded[i]) == encoded[i].size();
+        } else {
+            SParamCacheInfo info;
+            if (!SParamCache::writeTo(file, *state.datasets[entry.index].data, info, error)) {
+                return false;
+            }
+        }
+    }
+    
+    if (!ok || !file.commit()) {
+        error = QString("Cannot write file: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+bool ProjectFile::open(const QString& path, QString& error)
+{
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    error = QString("Project files are only supported on little-endian hosts");
+    return false;
+#endif
+
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_buffer.clear();
+    m_bytes = nullptr;
+    m_size = 0;
+    m_path = path;
+    m_state = ProjectState();
+    m_datasetSections.clear();
+    
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        error = QString("Cannot open file: %1").arg(path);
+        return false;
+    }
+    
+    const qint64 size = m_file.size();
+    if (size < static_cast<qint64>(sizeof(Header))) {
+        error = QString("Not a SmithTool project: %1").arg(path);
+        return false;
+    }
+    
+    // Map when possible; otherwise read into memory
+    const uchar* bytes = m_file.map(0, size);
+    if (!bytes) {
+        m_buffer = m_file.readAll();
+        if (m_buffer.size() != size) {
+            error = QString("Cannot read file: %1").arg(path);
+            return false;
+        }
+        bytes = reinterpret_cast<const uchar*>(m_buffer.constData());
+    }
+    
+    Header header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = QString("Not a SmithTool project: %1").arg(path);
+        return false;
+    }
+    if (header.version != VERSION || header.headerSize != sizeof(Header)) {
+        error = QString("Unsupported project version %1").arg(header.version);
+        return false;
+    }
+    if (header.sectionCount > MAX_SECTIONS || header.tableOffset > static_cast<quint64>(size) ||
+        header.sectionCount * sizeof(TableEntry) > static_cast<quint64>(size) - header.tableOffset) {
+        error = QString("Corrupt project header: %1").arg(path);
+        return false;
+    }
+    
+    std::vector<TableEntry> table(header.sectionCount);
+    std::memcpy(table.data(), bytes + header.tableOffset, table.size() * sizeof(TableEntry));
+    
+    ProjectState state;
+    bool haveTrace = false;
+    bool haveIndex = false;
+    std::vector<Section> datasetSections;
+    for (const TableEntry& entry : table) {
+        if (entry.offset > static_cast<quint64>(size) ||
+            entry.size > static_cast<quint64>(size) - entry.offset) {
+            error = QString("Truncated project file: %1").arg(path);
+            return false;
+        }
+        
+        if (entry.type == DatasetSection) {
+            if (datasetSections.size() <= entry.index) {
+                datasetSections.resize(static_cast<std::size_t>(entry.index) + 1, Section{0, 0, 0, 0, 0});
+            }
+            datasetSections[entry.index] = {entry.type, entry.index, entry.offset, entry.size, entry.hash};
+            continue;
+        }
+        
+        const uchar* section = bytes + entry.offset;
+        const qint64 sectionSize = static_cast<qint64>(entry.size);
+        if (SParamCache::hashBytes(section, sectionSize) != entry.hash) {
+            error = QString("Checksum mismatch in %1").arg(path);
+            return false;
+        }
+        
+        // Raw view of the mapped bytes; the decoders copy what they keep
+        const QByteArray view = QByteArray::fromRawData(reinterpret_cast<const char*>(section),
+                                                        static_cast<qsizetype>(sectionSize));
+        bool ok = true;
+        switch (entry.type) {
+            case TraceSection:
+                ok = decodeTrace(view, state);
+                haveTrace = true;
+                break;
+            case SettingsSection:
+                ok = decodeSettings(view, state);
+                break;
+            case DatasetIndexSection:
+                ok = decodeDatasetIndex(view, state);
+                haveIndex = true;
+                break;
+            default:
+                // Sections from newer writers are skipped
+                break;
+        }
+        if (!ok) {
+            error = QString("Corrupt project section %1 in %2").arg(entry.type).arg(path);
+            return false;
+        }
+    }
+    
+    if (!haveTrace || (haveIndex && datasetSections.size() != state.datasets.size()) ||
+        (!haveIndex && !datasetSections.empty())) {
+        error = QString("Incomplete project file: %1").arg(path);
+        return false;
+    }
+    for (const Section& section : datasetSections) {
+        if (section.type != DatasetSection) {
+            error = QString("Incomplete project file: %1").arg(path);
+            return false;
+        }
+    }
+    
+    m_bytes = bytes;
+    m_size = size;
+    m_state = std::move(state);
+    m_datasetSections = std::move(datasetSections);
+    return true;
+}
+
+std::shared_ptr<const SParamData> ProjectFile::loadDataset(int index, QString& error) const
+{
+    if (index < 0 || index >= datasetCount() || !m_bytes) {
+        error = QString("No dataset %1 in %2").arg(index).arg(m_path);
+        return nullptr;
+    }
+    
+    const Section& section = m_datasetSections[index];
+    auto data = std::make_shared<SParamData>();
+    SParamCacheInfo info;
+    if (!SParamCache::decode(m_bytes + section.offset, static_cast<qint64>(section.size),
+                             m_state.datasets[index].name, *data, info, error)) {
+        return nullptr;
+    }
+    return data;
+}
+
+bool ProjectFile::isProjectFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    char magic[sizeof(MAGIC)];
+    return file.read(magic, sizeof(magic)) == sizeof(magic) &&
+           std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+} // namespace SmithTool
@@ -0,0 +1,135 @@
+/**
+ * @file projectfile.h
+ * @brief Binary project/session file with lazily loaded datasets
+ *
+ * A project holds the matching network, the display settings and any
+ * number of embedded S-parameter datasets. A section table up front lets
+ * a reader restore the network and settings from a few small sections
+ * and decode each dataset only when it is first drawn.
+ */
+
+#ifndef SMITHTOOL_PROJECTFILE_H
+#define SMITHTOOL_PROJECTFILE_H
+
+#include "sparamdata.h"
+#include "../core/edithistory.h"
+#include <QColor>
+#include <QFile>
+#include <QString>
+#include <QVariantMap>
+#include <complex>
+#include <memory>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief Dataset embedded in a project
+ */
+struct ProjectDataset {
+    enum class Role {
+        Current,        // Main S-parameter trace
+        Overlay         // Overlaid on it, e.g. one unit of a lot
+    };
+    
+    QString name;                   // File it was loaded from
+    Role role;
+    QColor color;                   // Overlay color
+    bool visible;
+    int numPorts;
+    qint64 numPoints;
+    
+    // Set when saving; after ProjectFile::open() use loadDataset()
+    std::shared_ptr<const SParamData> data;
+    
+    ProjectDataset() : role(Role::Overlay), visible(true), numPorts(0), numPoints(0) {}
+};
+
+/**
+ * @brief Everything a project restores
+ */
+struct ProjectState {
+    std::complex<double> sourceZ;
+    std::complex<double> loadZ;
+    double z0;
+    double frequency;
+    std::vector<ElementSpec> elements;      // Ordered from the load
+    QVariantMap settings;                   // Display settings by key
+    std::vector<ProjectDataset> datasets;
+    
+    ProjectState() : sourceZ(50.0, 0.0), loadZ(50.0, 0.0), z0(50.0), frequency(1e9) {}
+};
+
+/**
+ * @brief Reads and writes project files
+ *
+ * Layout (version 1): 32-byte header, a table of 32-byte section entries
+ * (type, index, offset, size, checksum), then the sections at 8-byte
+ * aligned offsets. The trace, settings and dataset index sections are
+ * QDataStream records; each dataset is a complete binary S-parameter
+ * block (see SParamCache) with its own payload checksum.
+ *
+ * open() maps the file and reads only the small sections, so opening a
+ * project costs the same however much data it embeds. The file stays
+ * mapped until the object is destroyed.
+ */
+class ProjectFile {
+public:
+    ProjectFile();
+    ~ProjectFile();
+    
+    ProjectFile(const ProjectFile&) = delete;
+    ProjectFile& operator=(const ProjectFile&) = delete;
+    
+    /**
+     * @brief Write a project
+     *
+     * Every dataset needs its data. The file is written under a temporary
+     * name and renamed, so a failed save leaves the old project intact.
+     */
+    static bool write(const QString& path, const ProjectState& state, QString& error);
+    
+    /**
+     * @brief Open a project and read its network, settings and dataset index
+     * @return false if the file is unreadable or its small sections are corrupt
+     */
+    bool open(const QString& path, QString& error);
+    
+    const QString& path() const { return m_path; }
+    
+    // Datasets come without data; see loadDataset()
+    const ProjectState& state() const { return m_state; }
+    int datasetCount() const { return static_cast<int>(m_state.datasets.size()); }
+    
+    /**
+     * @brief Decode one embedded dataset
+     * @return Null (with error set) if the index is invalid or the block is corrupt
+     */
+    std::shared_ptr<const SParamData> loadDataset(int index, QString& error) const;
+    
+    // Whether the file starts with the project magic
+    static bool isProjectFile(const QString& path);
+    
+    static constexpr const char* FILE_SUFFIX = "smtproj";
+
+private:
+    struct Section {
+        quint32 type;
+        quint32 index;
+        quint64 offset;
+        quint64 size;
+        quint64 hash;
+    };
+    
+    QString m_path;
+    QFile m_file;
+    QByteArray m_buffer;            // File contents when it cannot be mapped
+    const uchar* m_bytes;
+    qint64 m_size;
+    ProjectState m_state;
+    std::vector<Section> m_datasetSections;     // By dataset index
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_PROJECTFILE_H
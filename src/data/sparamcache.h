@@ -0,0 +1,127 @@
+/**
+ * @file sparamcache.h
+ * @brief Binary cache/export format for parsed S-parameter data
+ *
+ * A fixed little-endian header followed by the frequency array and one
+ * complex array per Sij, exactly as SParamData stores them, so loading is
+ * a handful of block copies instead of a text parse.
+ */
+
+#ifndef SMITHTOOL_SPARAMCACHE_H
+#define SMITHTOOL_SPARAMCACHE_H
+
+#include "sparamdata.h"
+#include <QIODevice>
+#include <QString>
+
+namespace SmithTool {
+
+/**
+ * @brief Identity of the text file a cache was built from
+ *
+ * The hash covers the file size and its first and last 64 KiB, which
+ * catches edits that keep size and timestamp without reading the whole
+ * (possibly huge) file.
+ */
+struct SParamSourceStamp {
+    qint64 size;
+    qint64 modifiedMs;      // Last modification, ms since the epoch
+    quint64 hash;
+    
+    SParamSourceStamp() : size(0), modifiedMs(0), hash(0) {}
+    
+    bool operator==(const SParamSourceStamp& other) const {
+        return size == other.size && modifiedMs == other.modifiedMs && hash == other.hash;
+    }
+    bool operator!=(const SParamSourceStamp& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Parser state restored together with the data
+ */
+struct SParamCacheInfo {
+    SParamFormat format;
+    double frequencyMultiplier;
+    SParamSourceStamp source;   // All zero for plain exports
+    
+    SParamCacheInfo() : format(SParamFormat::MA), frequencyMultiplier(1e9) {}
+};
+
+/**
+ * @brief Reads and writes the binary S-parameter format
+ *
+ * Layout (version 1): 80-byte header with magic, version, port count,
+ * point count, Z0, source stamp and a payload checksum, then
+ * numPoints doubles of frequency (Hz) and N² arrays of numPoints
+ * (re, im) double pairs in row-major Sij order.
+ */
+class SParamCache {
+public:
+    /**
+     * @brief Size, modification time and sampled hash of a file
+     * @return false if the file cannot be read
+     */
+    static bool stampFile(const QString& path, SParamSourceStamp& stamp);
+    
+    /**
+     * @brief Write data in the binary format
+     *
+     * The file is written under a temporary name and renamed, so a
+     * concurrent reader never sees a partial cache.
+     */
+    static bool write(const QString& path, const SParamData& data,
+                      const SParamCacheInfo& info, QString& error);
+    
+    // Write the same bytes to an open device (e.g. a section of a project file)
+    static bool writeTo(QIODevice& device, const SParamData& data,
+                        const SParamCacheInfo& info, QString& error);
+    
+    // Bytes write() produces for data
+    static qint64 encodedSize(const SParamData& data);
+    
+    /**
+     * @brief Load a binary file
+     *
+     * The header, sizes and payload checksum are validated; data is left
+     * unchanged on failure.
+     */
+    static bool read(const QString& path, SParamData& data,
+                     SParamCacheInfo& info, QString& error);
+    
+    /**
+     * @brief Load from bytes in memory, validated as read() does
+     * @param path Name used in error messages and as the data's filename
+     */
+    static bool decode(const uchar* bytes, qint64 size, const QString& path,
+                       SParamData& data, SParamCacheInfo& info, QString& error);
+    
+    /**
+     * @brief Whether the file starts with the binary format's magic
+     */
+    static bool isCacheFile(const QString& path);
+    
+    /**
+     * @brief Cache file for a Touchstone file, in the user cache directory
+     *
+     * Caches are kept out of the data directories (which may be
+     * read-only or shared) under a name derived from the absolute path.
+     * Empty if no cache directory is available.
+     */
+    static QString cachePathFor(const QString& sourcePath);
+    
+    /**
+     * @brief Word-at-a-time FNV-style hash of the cache and project formats
+     *
+     * Stored in files, so the result must never change. Pass a previous
+     * result as h to hash several blocks as one.
+     */
+    static quint64 hashBytes(const uchar* data, qint64 size, quint64 h = HASH_SEED);
+    static constexpr quint64 HASH_SEED = 0xcbf29ce484222325ULL;
+    
+    // Suggested extension for exported files
+    static constexpr const char* FILE_SUFFIX = "smtsp";
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_SPARAMCACHE_H
@@ -6,161 +6,504 @@
 #include "sparamdata.h"
 #include <algorithm>
 #include <cmath>
+#include <numeric>
 
 namespace SmithTool {
 
+namespace {
+
+// Relative step deviation still treated as a uniform sweep. Frequencies
+// printed with few decimals are not exactly evenly spaced; lookups verify
+// the computed index anyway, so this only needs to be roughly right.
+const double UNIFORM_TOLERANCE = 1e-3;
+
+} // namespace
+
 SParamData::SParamData()
-    : m_z0(50.0)
-    , m_portCount(PortCount::OnePort)
+    : m_frequencies(std::make_shared<std::vector<double>>())
+    , m_params(1)
+    , m_numPorts(1)
+    , m_z0(50.0)
+    , m_uniform(true)
 {
 }
 
-const SParamPoint& SParamData::point(int index) const
+SParamData::SParamData(SParamData&& other)
+    : SParamData()
 {
-    static SParamPoint empty;
-    if (index < 0 || index >= m_points.size()) {
-        return empty;
+    *this = std::move(other);
+}
+
+SParamData& SParamData::operator=(SParamData&& other)
+{
+    if (this == &other) return *this;
+    
+    m_frequencies.swap(other.m_frequencies);
+    m_params.swap(other.m_params);
+    m_numPorts = other.m_numPorts;
+    m_z0 = other.m_z0;
+    m_filename = std::move(other.m_filename);
+    m_uniform = other.m_uniform;
+    m_noise = std::move(other.m_noise);
+    
+    // Leave the source valid (and empty) rather than half-moved
+    other.m_frequencies = std::make_shared<std::vector<double>>();
+    other.m_params.assign(1, std::vector<Complex>());
+    other.m_numPorts = 1;
+    other.m_z0 = 50.0;
+    other.m_filename.clear();
+    other.m_uniform = true;
+    return *this;
+}
+
+SParamPoint SParamData::point(int index) const
+{
+    if (index < 0 || index >= numPoints()) {
+        return SParamPoint();
+    }
+    
+    SParamPoint p;
+    p.frequency = (*m_frequencies)[index];
+    p.s11 = m_params[0][index];
+    if (m_numPorts >= 2) {
+        p.s21 = s(index, 1, 0);
+        p.s12 = s(index, 0, 1);
+        p.s22 = s(index, 1, 1);
+    }
+    return p;
+}
+
+double SParamData::frequency(int index) const
+{
+    if (index < 0 || index >= numPoints()) return 0.0;
+    return (*m_frequencies)[index];
+}
+
+bool SParamData::validPort(int row, int col) const
+{
+    return row >= 0 && row < m_numPorts && col >= 0 && col < m_numPorts;
+}
+
+Complex SParamData::s(int index, int row, int col) const
+{
+    if (index < 0 || index >= numPoints() || !validPort(row, col)) {
+        return Complex(0, 0);
     }
-    return m_points[index];
+    return m_params[row * m_numPorts + col][index];
 }
 
-SParamPoint& SParamData::point(int index)
+const std::vector<Complex>& SParamData::sData(int row, int col) const
 {
-    static SParamPoint empty;
-    if (index < 0 || index >= m_points.size()) {
+    static const std::vector<Complex> empty;
+    if (!validPort(row, col)) {
         return empty;
     }
-    return m_points[index];
+    return m_params[row * m_numPorts + col];
 }
 
 double SParamData::minFrequency() const
 {
-    if (m_points.isEmpty()) return 0.0;
-    
-    double minF = m_points[0].frequency;
-    for (const auto& p : m_points) {
-        if (p.frequency < minF) minF = p.frequency;
-    }
-    return minF;
+    return m_frequencies->empty() ? 0.0 : m_frequencies->front();
 }
 
 double SParamData::maxFrequency() const
 {
-    if (m_points.isEmpty()) return 0.0;
-    
-    double maxF = m_points[0].frequency;
-    for (const auto& p : m_points) {
-        if (p.frequency > maxF) maxF = p.frequency;
-    }
-    return maxF;
+    return m_frequencies->empty() ? 0.0 : m_frequencies->back();
 }
 
-int SParamData::closestIndex(double freq) const
+int SParamData::lowerIndex(double freq) const
 {
-    if (m_points.isEmpty()) return -1;
+    const int n = numPoints();
+    if (n < 2) return 0;
     
-    int closest = 0;
-    double minDiff = std::abs(m_points[0].frequency - freq);
+    const double* f = m_frequencies->data();
+    if (freq <= f[0]) return 0;
+    if (freq >= f[n - 1]) return n - 2;
     
-    for (int i = 1; i < m_points.size(); ++i) {
-        double diff = std::abs(m_points[i].frequency - freq);
-        if (diff < minDiff) {
-            minDiff = diff;
-            closest = i;
+    // Uniform sweep: compute the index directly and verify it
+    if (m_uniform) {
+        double step = (f[n - 1] - f[0]) / (n - 1);
+        int guess = std::clamp(static_cast<int>((freq - f[0]) / step), 0, n - 2);
+        int first = std::max(guess - 1, 0);
+        int last = std::min(guess + 1, n - 2);
+        for (int i = first; i <= last; ++i) {
+            if (f[i] <= freq && freq < f[i + 1]) return i;
         }
     }
-    return closest;
+    
+    auto it = std::upper_bound(m_frequencies->begin(), m_frequencies->end(), freq);
+    return static_cast<int>(it - m_frequencies->begin()) - 1;
 }
 
-Complex SParamData::interpolate(double freq, int idx1, int idx2,
-                                 const Complex& v1, const Complex& v2) const
+int SParamData::closestIndex(double freq) const
 {
-    if (idx1 == idx2) return v1;
+    if (m_frequencies->empty()) return -1;
+    if (m_frequencies->size() == 1) return 0;
     
-    double f1 = m_points[idx1].frequency;
-    double f2 = m_points[idx2].frequency;
+    int i = lowerIndex(freq);
+    double below = freq - (*m_frequencies)[i];
+    double above = (*m_frequencies)[i + 1] - freq;
+    return (below <= above) ? i : i + 1;
+}
+
+Complex SParamData::interpolateAt(double freq, int index,
+                                   const std::vector<Complex>& values) const
+{
+    const int n = numPoints();
+    if (n == 1 || freq <= (*m_frequencies)[0]) return values[0];
+    if (freq >= (*m_frequencies)[n - 1]) return values[n - 1];
     
-    if (std::abs(f2 - f1) < 1e-12) return v1;
+    double f1 = (*m_frequencies)[index];
+    double f2 = (*m_frequencies)[index + 1];
+    
+    if (std::abs(f2 - f1) < 1e-12) return values[index];
     
     double t = (freq - f1) / (f2 - f1);
-    return v1 + t * (v2 - v1);
+    return values[index] + t * (values[index + 1] - values[index]);
+}
+
+Complex SParamData::sAt(int row, int col, double freq) const
+{
+    if (m_frequencies->empty() || !validPort(row, col)) return Complex(0, 0);
+    return interpolateAt(freq, lowerIndex(freq), m_params[row * m_numPorts + col]);
 }
 
 Complex SParamData::s11At(double freq) const
 {
-    if (m_points.isEmpty()) return Complex(0, 0);
-    if (m_points.size() == 1) return m_points[0].s11;
-    
-    // Find surrounding indices
-    int idx = closestIndex(freq);
-    
-    if (m_points[idx].frequency >= freq && idx > 0) {
-        return interpolate(freq, idx - 1, idx,
-                          m_points[idx - 1].s11, m_points[idx].s11);
-    } else if (idx < m_points.size() - 1) {
-        return interpolate(freq, idx, idx + 1,
-                          m_points[idx].s11, m_points[idx + 1].s11);
-    }
-    return m_points[idx].s11;
+    return sAt(0, 0, freq);
 }
 
 Complex SParamData::s21At(double freq) const
 {
-    if (m_points.isEmpty()) return Complex(0, 0);
-    int idx = closestIndex(freq);
-    return m_points[idx].s21;
+    return sAt(1, 0, freq);
 }
 
 Complex SParamData::s12At(double freq) const
 {
-    if (m_points.isEmpty()) return Complex(0, 0);
-    int idx = closestIndex(freq);
-    return m_points[idx].s12;
+    return sAt(0, 1, freq);
 }
 
 Complex SParamData::s22At(double freq) const
 {
-    if (m_points.isEmpty()) return Complex(0, 0);
-    int idx = closestIndex(freq);
-    return m_points[idx].s22;
+    return sAt(1, 1, freq);
+}
+
+std::vector<Complex> SParamData::interpolate(const std::vector<double>& freqs,
+                                                int row, int col) const
+{
+    std::vector<Complex> result(freqs.size(), Complex(0, 0));
+    if (m_frequencies->empty() || !validPort(row, col)) return result;
+    
+    const std::vector<Complex>& values = m_params[row * m_numPorts + col];
+    const int n = numPoints();
+    
+    int index = 0;
+    double previous = freqs.empty() ? 0.0 : freqs[0];
+    for (size_t k = 0; k < freqs.size(); ++k) {
+        double f = freqs[k];
+        if (f >= previous) {
+            // Ascending: continue the walk from the last bracket
+            while (index < n - 2 && (*m_frequencies)[index + 1] <= f) ++index;
+        } else {
+            index = lowerIndex(f);
+        }
+        previous = f;
+        result[k] = interpolateAt(f, index, values);
+    }
+    return result;
+}
+
+SParamData SParamData::resample(const std::vector<double>& freqs) const
+{
+    SParamData result;
+    result.setNumPorts(m_numPorts);
+    result.m_z0 = m_z0;
+    result.m_filename = m_filename;
+    result.m_noise = m_noise;      // On its own axis; unaffected
+    
+    std::vector<double> sorted = freqs;
+    std::sort(sorted.begin(), sorted.end());
+    
+    const int n2 = matrixSize();
+    for (int p = 0; p < n2; ++p) {
+        result.m_params[p] = interpolate(sorted, p / m_numPorts, p % m_numPorts);
+    }
+    result.m_frequencies = std::make_shared<std::vector<double>>(std::move(sorted));
+    
+    result.updateUniform(0);
+    return result;
+}
+
+int SParamData::insertPosition(double freq) const
+{
+    if (m_frequencies->empty() || freq >= m_frequencies->back()) {
+        return numPoints();
+    }
+    auto it = std::upper_bound(m_frequencies->begin(), m_frequencies->end(), freq);
+    return static_cast<int>(it - m_frequencies->begin());
+}
+
+void SParamData::updateUniform(int insertedIndex)
+{
+    const int n = numPoints();
+    const double* f = m_frequencies->data();
+    
+    if (n <= 1) {
+        m_uniform = true;
+        return;
+    }
+    
+    // Appending only needs the new step; an insertion rescans the sweep
+    int first = (insertedIndex == n - 1) ? n - 1 : 1;
+    if (first == 1) m_uniform = true;
+    if (!m_uniform) return;
+    
+    double step = f[1] - f[0];
+    if (step <= 0.0) {
+        m_uniform = false;
+        return;
+    }
+    for (int i = std::max(first, 2); i < n; ++i) {
+        if (std::abs((f[i] - f[i - 1]) - step) > UNIFORM_TOLERANCE * step) {
+            m_uniform = false;
+            return;
+        }
+    }
 }
 
 void SParamData::addPoint(const SParamPoint& point)
 {
-    m_points.append(point);
+    int pos = insertPosition(point.frequency);
+    std::vector<double>& freqs = mutableFrequencies();
+    freqs.insert(freqs.begin() + pos, point.frequency);
+    
+    for (int p = 0; p < matrixSize(); ++p) {
+        Complex value(0, 0);
+        if (p == 0) value = point.s11;
+        else if (m_numPorts >= 2 && p == m_numPorts) value = point.s21;
+        else if (m_numPorts >= 2 && p == 1) value = point.s12;
+        else if (m_numPorts >= 2 && p == m_numPorts + 1) value = point.s22;
+        m_params[p].insert(m_params[p].begin() + pos, value);
+    }
+    
+    updateUniform(pos);
+}
+
+void SParamData::addPoint(double frequency, const Complex* matrix)
+{
+    int pos = insertPosition(frequency);
+    std::vector<double>& freqs = mutableFrequencies();
+    freqs.insert(freqs.begin() + pos, frequency);
+    
+    for (int p = 0; p < matrixSize(); ++p) {
+        m_params[p].insert(m_params[p].begin() + pos, matrix[p]);
+    }
+    
+    updateUniform(pos);
+}
+
+bool SParamData::assignPoints(std::vector<double> frequencies,
+                              std::vector<std::vector<Complex>> params)
+{
+    if (params.size() != static_cast<size_t>(matrixSize())) return false;
+    for (const std::vector<Complex>& values : params) {
+        if (values.size() != frequencies.size()) return false;
+    }
+    if (!std::is_sorted(frequencies.begin(), frequencies.end())) return false;
+    
+    m_frequencies = std::make_shared<std::vector<double>>(std::move(frequencies));
+    m_params = std::move(params);
+    updateUniform(0);
+    return true;
+}
+
+bool SParamData::assignPoints(const std::shared_ptr<const std::vector<double>>& axis,
+                              std::vector<std::vector<Complex>> params)
+{
+    if (!axis || params.size() != static_cast<size_t>(matrixSize())) return false;
+    for (const std::vector<Complex>& values : params) {
+        if (values.size() != axis->size()) return false;
+    }
+    if (!std::is_sorted(axis->begin(), axis->end())) return false;
+    
+    // Shared as in shareFrequencyAxis(); mutableFrequencies() detaches on write
+    m_frequencies = std::const_pointer_cast<std::vector<double>>(axis);
+    m_params = std::move(params);
+    updateUniform(0);
+    return true;
+}
+
+bool SParamData::copyPoints(const double* frequencies, const Complex* const* params, int count)
+{
+    if (count < 0 || !std::is_sorted(frequencies, frequencies + count)) return false;
+    
+    // A live sweep usually keeps its axis; leave it (and any sharing) alone
+    const std::vector<double>& axis = *m_frequencies;
+    if (axis.size() != static_cast<size_t>(count) ||
+        !std::equal(axis.begin(), axis.end(), frequencies)) {
+        if (m_frequencies.use_count() > 1) {
+            m_frequencies = std::make_shared<std::vector<double>>();
+        }
+        m_frequencies->assign(frequencies, frequencies + count);
+        updateUniform(0);
+    }
+    for (int i = 0; i < matrixSize(); ++i) {
+        m_params[i].assign(params[i], params[i] + count);
+    }
+    return true;
+}
+
+void SParamData::reserve(int numPoints)
+{
+    mutableFrequencies().reserve(numPoints);
+    for (auto& values : m_params) {
+        values.reserve(numPoints);
+    }
 }
 
 void SParamData::clear()
 {
-    m_points.clear();
+    // Drop a shared axis instead of clearing it for everyone
+    if (m_frequencies.use_count() > 1) {
+        m_frequencies = std::make_shared<std::vector<double>>();
+    }
+    m_frequencies->clear();
+    for (auto& values : m_params) {
+        values.clear();
+    }
+    m_uniform = true;
+    m_noise.reset();
 }
 
 void SParamData::sortByFrequency()
 {
-    std::sort(m_points.begin(), m_points.end(),
-              [](const SParamPoint& a, const SParamPoint& b) {
-                  return a.frequency < b.frequency;
-              });
+    if (std::is_sorted(m_frequencies->begin(), m_frequencies->end())) {
+        return;
+    }
+    
+    // Only reachable if the invariant was broken; restore it
+    std::vector<int> order(m_frequencies->size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return (*m_frequencies)[a] < (*m_frequencies)[b];
+    });
+    
+    std::vector<double> freqs(order.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+        freqs[k] = (*m_frequencies)[order[k]];
+    }
+    m_frequencies = std::make_shared<std::vector<double>>(std::move(freqs));
+    
+    for (auto& values : m_params) {
+        std::vector<Complex> sorted(order.size());
+        for (size_t k = 0; k < order.size(); ++k) {
+            sorted[k] = values[order[k]];
+        }
+        values.swap(sorted);
+    }
+    updateUniform(0);
+}
+
+std::vector<double>& SParamData::mutableFrequencies()
+{
+    // Copy on write: another dataset may share this axis
+    if (m_frequencies.use_count() > 1) {
+        m_frequencies = std::make_shared<std::vector<double>>(*m_frequencies);
+    }
+    return *m_frequencies;
+}
+
+bool SParamData::shareFrequencyAxis(const std::shared_ptr<const std::vector<double>>& axis)
+{
+    if (!axis || axis == m_frequencies) return axis != nullptr;
+    if (*axis != *m_frequencies) return false;
+    
+    // Identical values, so the (const) shared axis can replace ours; any
+    // later modification detaches again in mutableFrequencies()
+    m_frequencies = std::const_pointer_cast<std::vector<double>>(axis);
+    return true;
+}
+
+PortCount SParamData::portCount() const
+{
+    if (m_numPorts == 1) return PortCount::OnePort;
+    if (m_numPorts == 2) return PortCount::TwoPort;
+    return PortCount::NPort;
+}
+
+void SParamData::setPortCount(PortCount count)
+{
+    // NPort carries no size; use setNumPorts() for that
+    if (count == PortCount::OnePort) setNumPorts(1);
+    else if (count == PortCount::TwoPort) setNumPorts(2);
+}
+
+void SParamData::setNumPorts(int ports)
+{
+    if (ports < 1 || ports == m_numPorts) return;
+    clear();
+    m_numPorts = ports;
+    m_params.assign(static_cast<size_t>(ports) * ports, std::vector<Complex>());
 }
 
 QVector<double> SParamData::frequencies() const
 {
     QVector<double> freqs;
-    freqs.reserve(m_points.size());
-    for (const auto& p : m_points) {
-        freqs.append(p.frequency);
+    freqs.reserve(numPoints());
+    for (double f : *m_frequencies) {
+        freqs.append(f);
     }
     return freqs;
 }
 
 QVector<Complex> SParamData::s11Vector() const
 {
-    QVector<Complex> s11s;
-    s11s.reserve(m_points.size());
-    for (const auto& p : m_points) {
-        s11s.append(p.s11);
+    return sVector(0, 0);
+}
+
+QVector<Complex> SParamData::sVector(int row, int col) const
+{
+    QVector<Complex> values;
+    if (!validPort(row, col)) return values;
+    
+    const std::vector<Complex>& src = m_params[row * m_numPorts + col];
+    values.reserve(numPoints());
+    for (const Complex& v : src) {
+        values.append(v);
+    }
+    return values;
+}
+
+// FrequencyAxisPool implementation
+
+void FrequencyAxisPool::intern(SParamData& data)
+{
+    if (data.isEmpty()) return;
+    
+    m_axes.erase(std::remove_if(m_axes.begin(), m_axes.end(),
+                     [](const std::weak_ptr<const std::vector<double>>& axis) {
+                         return axis.expired();
+                     }),
+                 m_axes.end());
+    
+    const std::vector<double>& freqs = data.frequencyData();
+    for (const auto& weak : m_axes) {
+        std::shared_ptr<const std::vector<double>> axis = weak.lock();
+        if (!axis || axis->size() != freqs.size()) continue;
+        if (axis->front() != freqs.front() || axis->back() != freqs.back()) continue;
+        if (data.shareFrequencyAxis(axis)) return;
+    }
+    
+    m_axes.push_back(data.frequencyAxis());
+}
+
+int FrequencyAxisPool::size() const
+{
+    int count = 0;
+    for (const auto& axis : m_axes) {
+        if (!axis.expired()) ++count;
     }
-    return s11s;
+    return count;
 }
 
 } // namespace SmithTool
@@ -7,6 +7,7 @@
 #define SMITHTOOL_SPARAMDATA_H
 
 #include <complex>
+#include <memory>
 #include <vector>
 #include <QString>
 #include <QVector>
@@ -35,6 +36,22 @@ struct SParamPoint {
         : frequency(f), s11(s11Val), s21(s21Val), s12(s12Val), s22(s22Val) {}
 };
 
+/**
+ * @brief Two-port noise parameters, one entry per noise frequency
+ * 
+ * Noise data is usually measured at fewer frequencies than the
+ * S-parameters, so it keeps its own axis.
+ */
+struct NoiseParameters {
+    std::vector<double> frequencies;    // Hz, ascending
+    std::vector<double> fMinDb;         // Minimum noise figure (dB)
+    std::vector<Complex> gammaOpt;      // Optimum source reflection
+    std::vector<double> rn;             // Effective noise resistance / Z0
+    
+    int size() const { return static_cast<int>(frequencies.size()); }
+    bool isEmpty() const { return frequencies.empty(); }
+};
+
 /**
  * @brief S-parameter data format types
  */
@@ -55,49 +72,194 @@ enum class PortCount {
 
 /**
  * @brief S-parameter data container
+ * 
+ * Storage is structure-of-arrays: one contiguous frequency array plus one
+ * contiguous complex array per Sij, all indexed by point. Points are kept
+ * sorted by frequency at all times, so lookups use binary search (or a
+ * direct index computation for uniformly spaced sweeps).
+ * 
+ * The frequency axis is shared copy-on-write: copies of a dataset, and
+ * datasets measured on the same sweep (see shareFrequencyAxis()), point
+ * at one array until one of them is modified.
  */
 class SParamData {
 public:
     SParamData();
     ~SParamData() = default;
+    SParamData(const SParamData& other) = default;
+    SParamData& operator=(const SParamData& other) = default;
+    
+    // The moved-from object is left as an empty one-port dataset
+    SParamData(SParamData&& other);
+    SParamData& operator=(SParamData&& other);
     
     // Data access
-    int numPoints() const { return m_points.size(); }
-    bool isEmpty() const { return m_points.empty(); }
+    int numPoints() const { return static_cast<int>(m_frequencies->size()); }
+    bool isEmpty() const { return m_frequencies->empty(); }
     
-    const SParamPoint& point(int index) const;
-    SParamPoint& point(int index);
+    /**
+     * @brief Get the two-port view of a point
+     * 
+     * For networks with more than two ports this returns the upper-left
+     * 2×2 block. Use s() or sData() for arbitrary Sij.
+     */
+    SParamPoint point(int index) const;
     
     // Frequency range
     double minFrequency() const;
     double maxFrequency() const;
     
-    // Get S-parameter at specific frequency (interpolated if needed)
+    // Get S-parameter at specific frequency (linearly interpolated,
+    // clamped to the end points outside the measured range)
     Complex s11At(double freq) const;
     Complex s21At(double freq) const;
     Complex s12At(double freq) const;
     Complex s22At(double freq) const;
     
+    /**
+     * @brief Get Sij at a specific frequency (linearly interpolated)
+     * @param row Zero-based output port i
+     * @param col Zero-based input port j
+     * @param freq Frequency in Hz
+     */
+    Complex sAt(int row, int col, double freq) const;
+    
+    /**
+     * @brief Interpolate Sij at many frequencies at once
+     * 
+     * Ascending input is resolved by a single merge walk over the data;
+     * unordered input falls back to one search per frequency.
+     * 
+     * @param freqs Frequencies in Hz
+     * @param row Zero-based output port i
+     * @param col Zero-based input port j
+     * @return One value per input frequency
+     */
+    std::vector<Complex> interpolate(const std::vector<double>& freqs,
+                                     int row = 0, int col = 0) const;
+    
+    /**
+     * @brief Interpolate every Sij onto a new frequency grid
+     * @param freqs Frequencies in Hz
+     * @return Data with the same ports and reference impedance
+     */
+    SParamData resample(const std::vector<double>& freqs) const;
+    
     // Find index of closest frequency
     int closestIndex(double freq) const;
     
+    // N-port access (zero-based port indices, S11 is (0, 0))
+    int numPorts() const { return m_numPorts; }
+    int matrixSize() const { return m_numPorts * m_numPorts; }
+    
+    double frequency(int index) const;
+    Complex s(int index, int row, int col) const;
+    
+    /**
+     * @brief Get the contiguous per-point array of one Sij
+     * @return numPoints() values (empty if the port pair does not exist)
+     */
+    const std::vector<Complex>& sData(int row, int col) const;
+    
     // Data manipulation
     void addPoint(const SParamPoint& point);
+    
+    /**
+     * @brief Add a point from a row-major N×N matrix
+     * @param frequency Frequency in Hz
+     * @param matrix numPorts()² values
+     */
+    void addPoint(double frequency, const Complex* matrix);
+    
+    /**
+     * @brief Replace all points at once
+     * 
+     * Bulk path for loaders that already hold whole arrays, such as the
+     * binary cache. The port count is kept.
+     * 
+     * @param frequencies Ascending frequencies in Hz
+     * @param params matrixSize() arrays of frequencies.size() values,
+     *               row-major Sij order
+     * @return false (data unchanged) on a size mismatch or unsorted axis
+     */
+    bool assignPoints(std::vector<double> frequencies,
+                      std::vector<std::vector<Complex>> params);
+    
+    /**
+     * @brief Replace all points, sharing an existing frequency axis
+     * 
+     * For results computed on the axis of another dataset: the axis is
+     * referenced, not copied. Same rules as the overload above.
+     */
+    bool assignPoints(const std::shared_ptr<const std::vector<double>>& axis,
+                      std::vector<std::vector<Complex>> params);
+    
+    /**
+     * @brief Overwrite all points in place
+     * 
+     * Reuses the existing arrays, so rewriting a dataset with the same
+     * number of points (e.g. every sweep of a live instrument) does not
+     * allocate. A frequency axis shared with another dataset is replaced
+     * instead of being written through. The port count is kept.
+     * 
+     * @param frequencies count ascending frequencies in Hz
+     * @param params matrixSize() arrays of count values, row-major Sij order
+     * @return false (data unchanged) on an unsorted axis
+     */
+    bool copyPoints(const double* frequencies, const Complex* const* params, int count);
+    
+    void reserve(int numPoints);
     void clear();
+    
+    /**
+     * @brief Sort points by frequency
+     * 
+     * addPoint() already keeps the data sorted, so this is only a cheap
+     * check; it is kept for callers that predate the invariant.
+     */
     void sortByFrequency();
     
     // Properties
     double referenceImpedance() const { return m_z0; }
     void setReferenceImpedance(double z0) { m_z0 = z0; }
     
-    PortCount portCount() const { return m_portCount; }
-    void setPortCount(PortCount count) { m_portCount = count; }
+    PortCount portCount() const;
+    void setPortCount(PortCount count);
+    
+    /**
+     * @brief Set the number of ports
+     * 
+     * Changing the port count discards existing points, since the storage
+     * layout depends on it.
+     */
+    void setNumPorts(int ports);
     
     QString filename() const { return m_filename; }
     void setFilename(const QString& name) { m_filename = name; }
     
-    // All points access
-    const QVector<SParamPoint>& points() const { return m_points; }
+    // Noise parameters of a two-port (null if the file had none)
+    std::shared_ptr<const NoiseParameters> noiseParameters() const { return m_noise; }
+    void setNoiseParameters(std::shared_ptr<const NoiseParameters> noise) { m_noise = std::move(noise); }
+    bool hasNoiseParameters() const { return m_noise && !m_noise->isEmpty(); }
+    
+    // Raw storage access
+    const std::vector<double>& frequencyData() const { return *m_frequencies; }
+    
+    /**
+     * @brief The frequency axis, for sharing with other datasets
+     */
+    std::shared_ptr<const std::vector<double>> frequencyAxis() const { return m_frequencies; }
+    
+    /**
+     * @brief Use an existing frequency axis if it holds the same values
+     * 
+     * Lets many datasets taken on one sweep store a single frequency
+     * array. Nothing changes if the values differ.
+     * 
+     * @param axis Axis of another dataset
+     * @return true if this dataset now uses axis
+     */
+    bool shareFrequencyAxis(const std::shared_ptr<const std::vector<double>>& axis);
     
     // Get frequency list
     QVector<double> frequencies() const;
@@ -105,15 +267,50 @@ public:
     // Get S11 as vector
     QVector<Complex> s11Vector() const;
     
+    // Get any Sij as vector
+    QVector<Complex> sVector(int row, int col) const;
+
 private:
-    QVector<SParamPoint> m_points;
+    std::shared_ptr<std::vector<double>> m_frequencies;   // Never null; shared COW
+    std::vector<std::vector<Complex>> m_params;  // [row * N + col][point]
+    int m_numPorts;
     double m_z0;
-    PortCount m_portCount;
     QString m_filename;
+    bool m_uniform;                              // Evenly spaced sweep
+    std::shared_ptr<const NoiseParameters> m_noise;  // Immutable, shared by copies
+    
+    std::vector<double>& mutableFrequencies();
+    bool validPort(int row, int col) const;
+    int insertPosition(double freq) const;
+    void updateUniform(int insertedIndex);
+    
+    // Index i with f[i] <= freq < f[i + 1], clamped to [0, n - 2]
+    int lowerIndex(double freq) const;
     
     // Linear interpolation helper
-    Complex interpolate(double freq, int idx1, int idx2, 
-                        const Complex& v1, const Complex& v2) const;
+    Complex interpolateAt(double freq, int index,
+                          const std::vector<Complex>& values) const;
+};
+
+/**
+ * @brief Deduplicates frequency axes across datasets
+ * 
+ * Datasets measured on the same sweep (e.g. one file per production
+ * unit) end up sharing a single frequency array. Only weak references
+ * are kept, so an axis goes away with the last dataset using it.
+ */
+class FrequencyAxisPool {
+public:
+    /**
+     * @brief Share an identical pooled axis with data, or pool its axis
+     */
+    void intern(SParamData& data);
+    
+    // Number of distinct axes still in use
+    int size() const;
+
+private:
+    std::vector<std::weak_ptr<const std::vector<double>>> m_axes;
 };
 
 } // namespace SmithTool
@@ -0,0 +1,177 @@
+/**
+ * @file sparamstatistics.cpp
+ * @brief Per-frequency statistics across datasets implementation
+ */
+
+#include "sparamstatistics.h"
+#include "../core/parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SmithTool {
+
+namespace {
+
+bool hasPortPair(const std::shared_ptr<const SParamData>& data, int row, int col)
+{
+    return data && !data->isEmpty() && row >= 0 && col >= 0 &&
+           row < data->numPorts() && col < data->numPorts();
+}
+
+} // namespace
+
+Complex SParamEnvelope::atMagnitude(int index, double magnitude) const
+{
+    return std::polar(magnitude, std::arg(mean[index]));
+}
+
+SParamStatistics::SParamStatistics()
+    : m_threadCount(0)
+    , m_percentile(95.0)
+{
+}
+
+void SParamStatistics::setPercentile(double percentile)
+{
+    m_percentile = std::clamp(percentile, 0.0, 100.0);
+}
+
+std::vector<double> SParamStatistics::commonFrequencies(
+    const std::vector<std::shared_ptr<const SParamData>>& datasets)
+{
+    const SParamData* first = nullptr;
+    bool sameAxis = true;
+    double low = 0.0;
+    double high = 0.0;
+    int maxPoints = 0;
+    for (const auto& data : datasets) {
+        if (!data || data->isEmpty()) continue;
+        
+        if (!first) {
+            first = data.get();
+            low = data->minFrequency();
+            high = data->maxFrequency();
+        } else {
+            // Pooled axes (see FrequencyAxisPool) compare by pointer
+            sameAxis = sameAxis && (data->frequencyAxis() == first->frequencyAxis() ||
+                                    data->frequencyData() == first->frequencyData());
+            low = std::max(low, data->minFrequency());
+            high = std::min(high, data->maxFrequency());
+        }
+        maxPoints = std::max(maxPoints, data->numPoints());
+    }
+    
+    if (!first) return {};
+    if (sameAxis) return first->frequencyData();
+    if (low > high) return {};
+    if (low == high || maxPoints < 2) return {low};
+    
+    std::vector<double> frequencies(maxPoints);
+    const double step = (high - low) / (maxPoints - 1);
+    for (int i = 0; i < maxPoints; ++i) {
+        frequencies[i] = low + step * i;
+    }
+    frequencies.back() = high;
+    return frequencies;
+}
+
+SParamEnvelope SParamStatistics::compute(
+    const std::vector<std::shared_ptr<const SParamData>>& datasets, int row, int col) const
+{
+    std::vector<std::shared_ptr<const SParamData>> valid;
+    for (const auto& data : datasets) {
+        if (hasPortPair(data, row, col)) valid.push_back(data);
+    }
+    return compute(valid, row, col, commonFrequencies(valid));
+}
+
+SParamEnvelope SParamStatistics::compute(
+    const std::vector<std::shared_ptr<const SParamData>>& datasets,
+    int row, int col, const std::vector<double>& frequencies) const
+{
+    SParamEnvelope envelope;
+    envelope.percentile = m_percentile;
+    envelope.row = row;
+    envelope.col = col;
+    
+    std::vector<const SParamData*> valid;
+    valid.reserve(datasets.size());
+    for (const auto& data : datasets) {
+        if (hasPortPair(data, row, col)) valid.push_back(data.get());
+    }
+    
+    const int numFreqs = static_cast<int>(frequencies.size());
+    const int numData = static_cast<int>(valid.size());
+    if (numFreqs == 0 || numData == 0) {
+        return envelope;
+    }
+    const long long work = static_cast<long long>(numFreqs) * numData;
+    
+    // Stage 1: resample every dataset onto the grid, [dataset][frequency]
+    std::vector<Complex> values(static_cast<std::size_t>(work));
+    const int threads = Parallel::workerCount(m_threadCount, work, MIN_POINTS_PER_THREAD);
+    Parallel::parallelRanges(numData, threads, [&](int begin, int end) {
+        for (int d = begin; d < end; ++d) {
+            const SParamData& data = *valid[d];
+            Complex* out = values.data() + static_cast<std::size_t>(d) * numFreqs;
+            if (data.frequencyData() == frequencies) {
+                // Already on the grid (files of the same sweep)
+                const std::vector<Complex>& s = data.sData(row, col);
+                std::copy(s.begin(), s.end(), out);
+            } else {
+                const std::vector<Complex> s = data.interpolate(frequencies, row, col);
+                std::copy(s.begin(), s.end(), out);
+            }
+        }
+    });
+    
+    envelope.frequencies = frequencies;
+    envelope.datasetCount = numData;
+    envelope.mean.resize(numFreqs);
+    envelope.meanMagnitude.resize(numFreqs);
+    envelope.minMagnitude.resize(numFreqs);
+    envelope.maxMagnitude.resize(numFreqs);
+    envelope.percentileMagnitude.resize(numFreqs);
+    envelope.worstCase.resize(numFreqs);
+    
+    // Linear interpolation between the two nearest ranks
+    const double rank = m_percentile / 100.0 * (numData - 1);
+    const int lowerRank = static_cast<int>(std::floor(rank));
+    const double fraction = rank - lowerRank;
+    
+    // Stage 2: statistics per frequency
+    Parallel::parallelRanges(numFreqs, threads, [&](int begin, int end) {
+        std::vector<double> magnitudes(numData);
+        for (int f = begin; f < end; ++f) {
+            Complex sum(0, 0);
+            double magnitudeSum = 0.0;
+            int worst = 0;
+            for (int d = 0; d < numData; ++d) {
+                const Complex& s = values[static_cast<std::size_t>(d) * numFreqs + f];
+                magnitudes[d] = std::abs(s);
+                sum += s;
+                magnitudeSum += magnitudes[d];
+                if (magnitudes[d] > magnitudes[worst]) worst = d;
+            }
+            
+            envelope.mean[f] = sum / static_cast<double>(numData);
+            envelope.meanMagnitude[f] = magnitudeSum / numData;
+            envelope.maxMagnitude[f] = magnitudes[worst];
+            envelope.worstCase[f] = values[static_cast<std::size_t>(worst) * numFreqs + f];
+            envelope.minMagnitude[f] = *std::min_element(magnitudes.begin(), magnitudes.end());
+            
+            auto nth = magnitudes.begin() + lowerRank;
+            std::nth_element(magnitudes.begin(), nth, magnitudes.end());
+            double value = *nth;
+            if (fraction > 0.0) {
+                double next = *std::min_element(nth + 1, magnitudes.end());
+                value += fraction * (next - value);
+            }
+            envelope.percentileMagnitude[f] = value;
+        }
+    });
+    
+    return envelope;
+}
+
+} // namespace SmithTool
@@ -0,0 +1,106 @@
+/**
+ * @file sparamstatistics.h
+ * @brief Per-frequency statistics of one Sij across many datasets
+ */
+
+#ifndef SMITHTOOL_SPARAMSTATISTICS_H
+#define SMITHTOOL_SPARAMSTATISTICS_H
+
+#include "sparamdata.h"
+#include <complex>
+#include <memory>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief Statistical envelope of one Sij, e.g. S11 of a production lot
+ *
+ * All arrays have one entry per frequency. Magnitude statistics are of
+ * |Sij| (|Gamma| for reflections); the complex mean gives the phase at
+ * which the envelope is drawn on the chart.
+ */
+struct SParamEnvelope {
+    std::vector<double> frequencies;
+    std::vector<Complex> mean;              // Complex mean over the datasets
+    std::vector<double> meanMagnitude;
+    std::vector<double> minMagnitude;
+    std::vector<double> maxMagnitude;       // Worst case for reflections
+    std::vector<double> percentileMagnitude;
+    std::vector<Complex> worstCase;         // Value with the largest |Sij|
+    double percentile = 95.0;
+    int datasetCount = 0;
+    int row = 0;
+    int col = 0;
+    
+    int size() const { return static_cast<int>(frequencies.size()); }
+    bool isEmpty() const { return frequencies.empty(); }
+    
+    // Point of magnitude |Sij| = magnitude at the phase of the mean
+    Complex atMagnitude(int index, double magnitude) const;
+};
+
+/**
+ * @brief Aggregates many datasets into an SParamEnvelope
+ *
+ * Every dataset is first interpolated onto a common frequency grid
+ * (one batched merge walk per dataset, in parallel across datasets).
+ * The statistics are then computed per frequency, in parallel across
+ * frequency ranges.
+ */
+class SParamStatistics {
+public:
+    SParamStatistics();
+    
+    /**
+     * @brief Limit the number of worker threads
+     * @param count Thread count (0 = one per hardware thread)
+     */
+    void setThreadCount(int count) { m_threadCount = count; }
+    int threadCount() const { return m_threadCount; }
+    
+    /**
+     * @brief Percentile reported in SParamEnvelope::percentileMagnitude
+     * @param percentile 0 to 100 (default 95)
+     */
+    void setPercentile(double percentile);
+    double percentile() const { return m_percentile; }
+    
+    /**
+     * @brief Frequency grid common to all datasets
+     *
+     * The shared axis if every dataset has the same one (as files of one
+     * sweep do), else evenly spaced points over the range covered by all
+     * of them, as many as the densest dataset has.
+     *
+     * @return Empty if the frequency ranges do not overlap
+     */
+    static std::vector<double> commonFrequencies(
+        const std::vector<std::shared_ptr<const SParamData>>& datasets);
+    
+    /**
+     * @brief Compute the envelope of Sij on commonFrequencies()
+     *
+     * Datasets without port pair (row, col) are left out.
+     */
+    SParamEnvelope compute(const std::vector<std::shared_ptr<const SParamData>>& datasets,
+                           int row = 0, int col = 0) const;
+    
+    /**
+     * @brief Compute the envelope of Sij on a given grid
+     * @param frequencies Ascending frequencies in Hz
+     */
+    SParamEnvelope compute(const std::vector<std::shared_ptr<const SParamData>>& datasets,
+                           int row, int col, const std::vector<double>& frequencies) const;
+    
+    static constexpr int MIN_POINTS_PER_THREAD = 16384;
+
+private:
+    int m_threadCount;
+    double m_percentile;
+    
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_SPARAMSTATISTICS_H
@@ -4,12 +4,187 @@
  */
 
 #include "spiceexporter.h"
+#include "../core/parallel.h"
+#include <QDir>
 #include <QFile>
+#include <QSaveFile>
 #include <QTextStream>
+#include <algorithm>
 #include <cmath>
+#include <unordered_set>
 
 namespace SmithTool {
 
+namespace {
+
+void appendInt(std::string& out, long long value)
+{
+    char digits[24];
+    int n = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                             : static_cast<unsigned long long>(value);
+    do {
+        digits[n++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) out += '-';
+    while (n > 0) out += digits[--n];
+}
+
+// Fixed-point text as QString::number(value, 'f', decimals), without the
+// C library (printf follows LC_NUMERIC, which may use a decimal comma)
+void appendFixed(std::string& out, double value, int decimals)
+{
+    static const long long POW10[] = {1, 10, 100, 1000};
+    const long long factor = POW10[decimals];
+    const double scaled = std::abs(value) * static_cast<double>(factor);
+    if (!(scaled < 1e15)) {
+        out += QByteArray::number(value, 'f', decimals).constData();
+        return;
+    }
+    
+    const long long units = std::llround(scaled);
+    if (value < 0) out += '-';
+    appendInt(out, units / factor);
+    if (decimals > 0) {
+        out += '.';
+        long long fraction = units % factor;
+        for (long long digit = factor / 10; digit > 0; digit /= 10) {
+            out += static_cast<char>('0' + fraction / digit);
+            fraction %= digit;
+        }
+    }
+}
+
+// Value with an SI prefix, e.g. 4.700n or 1.000Meg
+void appendEngineering(std::string& out, double value)
+{
+    if (value == 0) {
+        out += '0';
+        return;
+    }
+    
+    // Define SI prefixes
+    static const char* const prefixes[] = {"f", "p", "n", "u", "m", "", "k", "Meg", "G", "T"};
+    const int prefixOffset = 5;  // Index of "" (no prefix)
+    
+    double absValue = std::abs(value);
+    int exp = static_cast<int>(std::floor(std::log10(absValue)));
+    int prefixIndex = prefixOffset + (exp / 3);
+    
+    // Clamp to valid range
+    if (prefixIndex < 0) prefixIndex = 0;
+    if (prefixIndex > 9) prefixIndex = 9;
+    
+    double scale = std::pow(10.0, (prefixIndex - prefixOffset) * 3);
+    double scaledValue = value / scale;
+    
+    int decimals = 3;
+    if (std::abs(scaledValue) >= 100) {
+        decimals = 1;
+    } else if (std::abs(scaledValue) >= 10) {
+        decimals = 2;
+    }
+    appendFixed(out, scaledValue, decimals);
+    out += prefixes[prefixIndex];
+}
+
+// Shortest form with 6 significant digits, as QTextStream writes doubles
+void appendGeneral(std::string& out, double value)
+{
+    out += QByteArray::number(value, 'g', 6).constData();
+}
+
+// "<prefix><index> <node1> <node2> <value>"; index < 0 writes the prefix alone
+void appendElement(std::string& out, const char* prefix, int index, int node1, int node2,
+                   double value)
+{
+    out += prefix;
+    if (index >= 0) appendInt(out, index);
+    out += ' ';
+    appendInt(out, node1);
+    out += ' ';
+    appendInt(out, node2);
+    out += ' ';
+    appendEngineering(out, value);
+    out += '\n';
+}
+
+// SPICE-safe name: [A-Za-z0-9_], never empty
+std::string spiceName(const QString& name, int index)
+{
+    std::string result;
+    result.reserve(name.size());
+    for (QChar c : name) {
+        const char16_t u = c.unicode();
+        const bool safe = (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') ||
+                          (u >= '0' && u <= '9') || u == '_';
+        result += safe ? static_cast<char>(u) : '_';
+    }
+    if (result.empty()) {
+        result = "net";
+        appendInt(result, index + 1);
+    }
+    return result;
+}
+
+// Names for a batch, unique in input order
+std::vector<std::string> batchNames(const std::vector<SpiceNetwork>& networks)
+{
+    std::vector<std::string> names;
+    names.reserve(networks.size());
+    std::unordered_set<std::string> used;
+    used.reserve(networks.size());
+    for (std::size_t i = 0; i < networks.size(); ++i) {
+        std::string name = spiceName(networks[i].name, static_cast<int>(i));
+        if (!used.insert(name).second) {
+            for (int n = 2; ; ++n) {
+                std::string candidate = name + "_";
+                appendInt(candidate, n);
+                if (used.insert(candidate).second) {
+                    name = std::move(candidate);
+                    break;
+                }
+            }
+        }
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+// Room for a formatted network, so buffers rarely grow
+std::size_t estimatedSize(const SpiceNetwork& network)
+{
+    return 640 + 40 * network.elements.size();
+}
+
+} // namespace
+
+SpiceNetwork SpiceNetwork::fromTrace(const MatchingTrace& trace, const QString& name)
+{
+    SpiceNetwork network;
+    network.name = name;
+    network.elements = EditHistory::elementsOf(trace);
+    network.sourceZ = trace.sourceImpedance();
+    network.loadZ = trace.loadImpedance();
+    network.frequency = trace.frequency();
+    return network;
+}
+
+SpiceNetwork SpiceNetwork::fromSolution(const MatchingSolution& solution, const QString& name)
+{
+    SpiceNetwork network;
+    network.name = name;
+    network.elements.reserve(solution.elements.size());
+    for (const MatchingElement& elem : solution.elements) {
+        network.elements.emplace_back(elem.type, elem.connection, elem.value);
+    }
+    network.sourceZ = solution.sourceZ;
+    network.loadZ = solution.loadZ;
+    network.frequency = solution.frequency;
+    return network;
+}
+
 SpiceExporter::SpiceExporter()
     : m_format(SpiceFormat::Standard)
     , m_analysisType(AnalysisType::AC)
@@ -21,6 +196,7 @@ SpiceExporter::SpiceExporter()
     , m_startFreq(100e6)
     , m_stopFreq(10e9)
     , m_numPoints(101)
+    , m_threadCount(0)
 {
 }
 
@@ -31,394 +207,414 @@ void SpiceExporter::setFrequencyRange(double startFreq, double stopFreq, int num
     m_numPoints = numPoints;
 }
 
+SpiceNetwork SpiceExporter::networkOf(const MatchingTrace& trace) const
+{
+    // Single exports use the exporter's terminations, not the trace's
+    SpiceNetwork network;
+    network.elements = EditHistory::elementsOf(trace);
+    network.sourceZ = m_sourceZ;
+    network.loadZ = m_loadZ;
+    network.frequency = m_frequency;
+    return network;
+}
+
 QString SpiceExporter::generateNetlist(const MatchingTrace& trace) const
 {
-    QString netlist;
-    QTextStream out(&netlist);
+    const SpiceNetwork network = networkOf(trace);
+    std::string netlist;
+    netlist.reserve(estimatedSize(network));
+    writeNetlist(netlist, network, formatHeader(), std::string());
+    return QString::fromStdString(netlist);
+}
+
+bool SpiceExporter::exportToFile(const QString& filename, const MatchingTrace& trace) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    
+    QTextStream out(&file);
+    out << generateNetlist(trace);
+    file.close();
+    
+    return true;
+}
+
+QString SpiceExporter::generateSubcircuit(const MatchingTrace& trace, const QString& name) const
+{
+    const SpiceNetwork network = networkOf(trace);
+    std::string subckt;
+    subckt.reserve(estimatedSize(network));
+    writeSubcircuit(subckt, network, name.toStdString());
+    return QString::fromStdString(subckt);
+}
+
+QByteArray SpiceExporter::generateLibrary(const std::vector<SpiceNetwork>& networks) const
+{
+    const std::vector<std::string> names = batchNames(networks);
+    const int count = static_cast<int>(networks.size());
+    
+    // Each network into its own buffer, then one copy into the library
+    std::vector<std::string> parts(networks.size());
+    const int threads = Parallel::workerCount(m_threadCount, count, MIN_NETWORKS_PER_THREAD);
+    Parallel::parallelRanges(count, threads, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            parts[i].reserve(estimatedSize(networks[i]));
+            writeSubcircuit(parts[i], networks[i], names[i]);
+            parts[i] += '\n';
+        }
+    });
+    
+    std::string header = "* SmithTool subcircuit library: ";
+    appendInt(header, count);
+    header += " networks\n\n";
+    
+    std::size_t total = header.size();
+    for (const std::string& part : parts) {
+        total += part.size();
+    }
+    QByteArray library;
+    library.reserve(static_cast<qsizetype>(total));
+    library.append(header.data(), static_cast<qsizetype>(header.size()));
+    for (const std::string& part : parts) {
+        library.append(part.data(), static_cast<qsizetype>(part.size()));
+    }
+    return library;
+}
+
+bool SpiceExporter::exportBatch(const std::vector<SpiceNetwork>& networks, const QString& path,
+                                SpiceBatchLayout layout, QString& error) const
+{
+    if (layout == SpiceBatchLayout::Library) {
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            error = QString("Cannot create file: %1").arg(path);
+            return false;
+        }
+        const QByteArray library = generateLibrary(networks);
+        if (file.write(library) != library.size() || !file.commit()) {
+            error = QString("Cannot write file: %1").arg(path);
+            return false;
+        }
+        return true;
+    }
+    
+    QDir dir(path);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        error = QString("Cannot create directory: %1").arg(path);
+        return false;
+    }
+    
+    const std::vector<std::string> names = batchNames(networks);
+    const std::string header = formatHeader();
+    const int count = static_cast<int>(networks.size());
+    std::vector<char> failed(networks.size(), 0);
+    
+    // One reused buffer per worker; files are independent, so no locking
+    const int threads = Parallel::workerCount(m_threadCount, count, MIN_NETWORKS_PER_THREAD);
+    Parallel::parallelRanges(count, threads, [&](int begin, int end) {
+        std::string netlist;
+        for (int i = begin; i < end; ++i) {
+            netlist.clear();
+            netlist.reserve(estimatedSize(networks[i]));
+            writeNetlist(netlist, networks[i], header, names[i]);
+            
+            QFile file(dir.filePath(QString::fromStdString(names[i]) + ".cir"));
+            const qint64 size = static_cast<qint64>(netlist.size());
+            failed[i] = !file.open(QIODevice::WriteOnly) ||
+                        file.write(netlist.data(), size) != size;
+        }
+    });
+    
+    for (int i = 0; i < count; ++i) {
+        if (failed[i]) {
+            error = QString("Cannot write file: %1")
+                        .arg(dir.filePath(QString::fromStdString(names[i]) + ".cir"));
+            return false;
+        }
+    }
+    
+    std::string driver = "* SmithTool netlist set: ";
+    appendInt(driver, count);
+    driver += " networks\n";
+    for (const std::string& name : names) {
+        driver += ".include ";
+        driver += name;
+        driver += ".cir\n";
+    }
+    
+    QSaveFile file(dir.filePath(DRIVER_FILE));
+    const qint64 size = static_cast<qint64>(driver.size());
+    if (!file.open(QIODevice::WriteOnly) || file.write(driver.data(), size) != size ||
+        !file.commit()) {
+        error = QString("Cannot write file: %1").arg(dir.filePath(DRIVER_FILE));
+        return false;
+    }
+    return true;
+}
+
+std::vector<SpiceNetwork> SpiceExporter::toleranceCorners(const SpiceNetwork& nominal,
+                                                          const std::vector<ToleranceSpec>& tolerances)
+{
+    std::vector<std::size_t> varying;
+    for (std::size_t i = 0; i < nominal.elements.size() && i < tolerances.size(); ++i) {
+        if (!tolerances[i].isZero()) {
+            varying.push_back(i);
+        }
+    }
+    if (varying.size() > static_cast<std::size_t>(MAX_CORNER_ELEMENTS)) {
+        return {};
+    }
     
+    const int count = 1 << varying.size();
+    std::vector<SpiceNetwork> corners;
+    corners.reserve(count);
+    for (int bits = 0; bits < count; ++bits) {
+        SpiceNetwork corner = nominal;
+        for (std::size_t j = 0; j < varying.size(); ++j) {
+            ElementSpec& elem = corner.elements[varying[j]];
+            const ToleranceSpec& tolerance = tolerances[varying[j]];
+            const double delta = tolerance.relative * std::abs(elem.value) + tolerance.absolute;
+            elem.value += ((bits >> j) & 1) ? delta : -delta;
+        }
+        corner.name = QString("%1_c%2").arg(nominal.name).arg(bits);
+        corners.push_back(std::move(corner));
+    }
+    return corners;
+}
+
+void SpiceExporter::writeNetlist(std::string& out, const SpiceNetwork& network,
+                                 const std::string& header, const std::string& name) const
+{
     // Header
-    out << formatHeader();
-    out << "\n";
+    out += header;
+    if (!name.empty()) {
+        out += "* Network: ";
+        out += name;
+        out += '\n';
+    }
+    out += '\n';
     
     // Comments
-    out << "* Source Impedance: " << m_sourceZ.real() << " + j" << m_sourceZ.imag() << " Ohm\n";
-    out << "* Load Impedance: " << m_loadZ.real() << " + j" << m_loadZ.imag() << " Ohm\n";
-    out << "* Center Frequency: " << engineeringNotation(m_frequency) << "Hz\n";
-    out << "\n";
+    out += "* Source Impedance: ";
+    appendGeneral(out, network.sourceZ.real());
+    out += " + j";
+    appendGeneral(out, network.sourceZ.imag());
+    out += " Ohm\n* Load Impedance: ";
+    appendGeneral(out, network.loadZ.real());
+    out += " + j";
+    appendGeneral(out, network.loadZ.imag());
+    out += " Ohm\n* Center Frequency: ";
+    appendEngineering(out, network.frequency);
+    out += "Hz\n\n";
     
     // Node numbering: 0 = GND, 1 = input, N = output (load)
     int currentNode = 1;
     
     // Source impedance (if not pure 50 ohm)
-    out << formatSourceImpedance(currentNode);
+    writeSourceImpedance(out, network, currentNode);
     
     // Matching network elements
-    const auto& segments = trace.segments();
-    for (size_t i = 0; i < segments.size(); ++i) {
-        out << formatElement(segments[i], static_cast<int>(i), currentNode);
+    for (std::size_t i = 0; i < network.elements.size(); ++i) {
+        const ElementSpec& elem = network.elements[i];
+        const int index = static_cast<int>(i) + 1;
+        const char* prefix = nullptr;
+        switch (elem.type) {
+            case ComponentType::Resistor:  prefix = "R"; break;
+            case ComponentType::Inductor:  prefix = "L"; break;
+            case ComponentType::Capacitor: prefix = "C"; break;
+            default: break;
+        }
+        
+        if (elem.connection == ConnectionType::Series) {
+            // Series element connects nodeNum to nodeNum+1
+            if (prefix) appendElement(out, prefix, index, currentNode, currentNode + 1, elem.value);
+            ++currentNode;
+        } else if (prefix) {
+            // Shunt element connects nodeNum to GND (node 0)
+            appendElement(out, prefix, index, currentNode, 0, elem.value);
+        }
     }
     
     // Load impedance
-    out << formatLoadImpedance(currentNode);
-    out << "\n";
+    writeLoadImpedance(out, network, currentNode);
+    out += '\n';
     
     // Analysis commands
-    out << formatAnalysis();
-    out << "\n";
+    writeAnalysis(out, network.frequency);
+    out += '\n';
     
     // Ending
-    out << formatEnding();
-    
-    return netlist;
-}
-
-bool SpiceExporter::exportToFile(const QString& filename, const MatchingTrace& trace) const
-{
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        return false;
+    if (m_format != SpiceFormat::QucsS) {
+        out += ".END\n";
     }
-    
-    QTextStream out(&file);
-    out << generateNetlist(trace);
-    file.close();
-    
-    return true;
 }
 
-QString SpiceExporter::generateSubcircuit(const MatchingTrace& trace, const QString& name) const
+void SpiceExporter::writeSubcircuit(std::string& out, const SpiceNetwork& network,
+                                    const std::string& name) const
 {
-    QString subckt;
-    QTextStream out(&subckt);
-    
     // Subcircuit header
-    out << ".SUBCKT " << name << " IN OUT\n";
-    out << "* Matching Network Subcircuit\n";
-    out << "* Generated by SmithTool\n\n";
+    out += ".SUBCKT ";
+    out += name;
+    out += " IN OUT\n* Matching Network Subcircuit\n* Generated by SmithTool\n\n";
     
     int currentNode = 1;  // Start at node 1 (IN is external)
     
     // Elements
-    const auto& segments = trace.segments();
-    for (size_t i = 0; i < segments.size(); ++i) {
-        const TraceSegment& seg = segments[i];
-        int startNode = (i == 0) ? 1 : currentNode;  // First element connects to IN (node 1)
-        int nextNode = currentNode + 1;
-        
-        QString elemName;
-        double value = seg.componentValue;
+    for (std::size_t i = 0; i < network.elements.size(); ++i) {
+        const ElementSpec& elem = network.elements[i];
+        const int index = static_cast<int>(i) + 1;
+        const bool series = (elem.connection == ConnectionType::Series);
+        const char* prefix = nullptr;
+        switch (elem.type) {
+            case ComponentType::Resistor:  prefix = series ? "RS" : "RP"; break;
+            case ComponentType::Inductor:  prefix = series ? "LS" : "LP"; break;
+            case ComponentType::Capacitor: prefix = series ? "CS" : "CP"; break;
+            default: break;
+        }
         
-        if (seg.connectionType == ConnectionType::Series) {
-            // Series element: connects startNode to nextNode
-            switch (seg.componentType) {
-                case ComponentType::Resistor:
-                    elemName = QString("RS%1").arg(i + 1);
-                    out << formatResistor(elemName, startNode, nextNode, value);
-                    break;
-                case ComponentType::Inductor:
-                    elemName = QString("LS%1").arg(i + 1);
-                    out << formatInductor(elemName, startNode, nextNode, value);
-                    break;
-                case ComponentType::Capacitor:
-                    elemName = QString("CS%1").arg(i + 1);
-                    out << formatCapacitor(elemName, startNode, nextNode, value);
-                    break;
-                default:
-                    break;
-            }
-            currentNode = nextNode;
-        } else {
+        if (series) {
+            // Series element: connects currentNode to the next node
+            if (prefix) appendElement(out, prefix, index, currentNode, currentNode + 1, elem.value);
+            ++currentNode;
+        } else if (prefix) {
             // Shunt element: connects currentNode to GND
-            switch (seg.componentType) {
-                case ComponentType::Resistor:
-                    elemName = QString("RP%1").arg(i + 1);
-                    out << formatResistor(elemName, currentNode, 0, value);
-                    break;
-                case ComponentType::Inductor:
-                    elemName = QString("LP%1").arg(i + 1);
-                    out << formatInductor(elemName, currentNode, 0, value);
-                    break;
-                case ComponentType::Capacitor:
-                    elemName = QString("CP%1").arg(i + 1);
-                    out << formatCapacitor(elemName, currentNode, 0, value);
-                    break;
-                default:
-                    break;
-            }
+            appendElement(out, prefix, index, currentNode, 0, elem.value);
         }
     }
     
     // Connect last node to OUT
-    out << QString("ROUT %1 OUT 0\n").arg(currentNode);  // Zero resistance connection
-    
-    out << ".ENDS " << name << "\n";
+    out += "ROUT ";
+    appendInt(out, currentNode);
+    out += " OUT 0\n";  // Zero resistance connection
     
-    return subckt;
+    out += ".ENDS ";
+    out += name;
+    out += '\n';
 }
 
-QString SpiceExporter::formatHeader() const
+std::string SpiceExporter::formatHeader() const
 {
-    QString header;
+    const std::string title = m_title.toStdString();
     
     switch (m_format) {
         case SpiceFormat::LTspice:
-            header = QString("* %1\n").arg(m_title);
-            header += "* Generated by SmithTool for LTspice\n";
-            break;
+            return "* " + title + "\n* Generated by SmithTool for LTspice\n";
         case SpiceFormat::Ngspice:
-            header = QString(".title %1\n").arg(m_title);
-            header += "* Generated by SmithTool for Ngspice\n";
-            break;
+            return ".title " + title + "\n* Generated by SmithTool for Ngspice\n";
         case SpiceFormat::QucsS:
-            header = QString("# %1\n").arg(m_title);
-            header += "# Generated by SmithTool for Qucs-S\n";
-            break;
+            return "# " + title + "\n# Generated by SmithTool for Qucs-S\n";
         default:
-            header = QString("* %1\n").arg(m_title);
-            header += "* Generated by SmithTool\n";
-            break;
+            return "* " + title + "\n* Generated by SmithTool\n";
     }
-    
-    return header;
 }
 
-QString SpiceExporter::formatSourceImpedance(int& nodeNum) const
+void SpiceExporter::writeSourceImpedance(std::string& out, const SpiceNetwork& network,
+                                         int& nodeNum) const
 {
-    QString source;
-    QTextStream out(&source);
-    
     // AC voltage source
-    out << "* AC Source with impedance\n";
-    out << "V1 " << nodeNum << " 0 AC 1\n";  // 1V AC source
+    out += "* AC Source with impedance\nV1 ";
+    appendInt(out, nodeNum);
+    out += " 0 AC 1\n";  // 1V AC source
     
     // Source resistance (real part)
-    if (std::abs(m_sourceZ.real()) > 1e-9) {
-        out << formatResistor("RS", nodeNum, nodeNum + 1, m_sourceZ.real());
+    if (std::abs(network.sourceZ.real()) > 1e-9) {
+        appendElement(out, "RS", -1, nodeNum, nodeNum + 1, network.sourceZ.real());
         nodeNum++;
     }
     
     // Source reactance (imaginary part)
-    if (std::abs(m_sourceZ.imag()) > 1e-9) {
-        double X = m_sourceZ.imag();
+    if (std::abs(network.sourceZ.imag()) > 1e-9) {
+        double X = network.sourceZ.imag();
         if (X > 0) {
             // Inductive
-            double L = X / (2.0 * M_PI * m_frequency);
-            out << formatInductor("LS", nodeNum, nodeNum + 1, L);
+            double L = X / (2.0 * M_PI * network.frequency);
+            appendElement(out, "LS", -1, nodeNum, nodeNum + 1, L);
         } else {
             // Capacitive
-            double C = -1.0 / (2.0 * M_PI * m_frequency * X);
-            out << formatCapacitor("CS", nodeNum, nodeNum + 1, C);
+            double C = -1.0 / (2.0 * M_PI * network.frequency * X);
+            appendElement(out, "CS", -1, nodeNum, nodeNum + 1, C);
         }
         nodeNum++;
     }
     
-    out << "\n";
-    return source;
+    out += '\n';
 }
 
-QString SpiceExporter::formatLoadImpedance(int nodeNum) const
+void SpiceExporter::writeLoadImpedance(std::string& out, const SpiceNetwork& network,
+                                       int nodeNum) const
 {
-    QString load;
-    QTextStream out(&load);
-    
-    out << "* Load Impedance\n";
-    
-    int loadNode = nodeNum;
+    out += "* Load Impedance\n";
     
     // Load resistance (real part)
-    if (std::abs(m_loadZ.real()) > 1e-9) {
-        out << formatResistor("RL", loadNode, 0, m_loadZ.real());
+    if (std::abs(network.loadZ.real()) > 1e-9) {
+        appendElement(out, "RL", -1, nodeNum, 0, network.loadZ.real());
     }
     
     // Load reactance (imaginary part)
-    if (std::abs(m_loadZ.imag()) > 1e-9) {
-        double X = m_loadZ.imag();
+    if (std::abs(network.loadZ.imag()) > 1e-9) {
+        double X = network.loadZ.imag();
         if (X > 0) {
             // Inductive (series with load R)
-            double L = X / (2.0 * M_PI * m_frequency);
-            out << formatInductor("LL", loadNode, 0, L);
+            double L = X / (2.0 * M_PI * network.frequency);
+            appendElement(out, "LL", -1, nodeNum, 0, L);
         } else {
             // Capacitive
-            double C = -1.0 / (2.0 * M_PI * m_frequency * X);
-            out << formatCapacitor("CL", loadNode, 0, C);
-        }
-    }
-    
-    return load;
-}
-
-QString SpiceExporter::formatElement(const TraceSegment& seg, int index, int& nodeNum) const
-{
-    QString elem;
-    QTextStream out(&elem);
-    
-    double value = seg.componentValue;
-    QString suffix = QString::number(index + 1);
-    
-    if (seg.connectionType == ConnectionType::Series) {
-        // Series element connects nodeNum to nodeNum+1
-        int nextNode = nodeNum + 1;
-        
-        switch (seg.componentType) {
-            case ComponentType::Resistor:
-                out << formatResistor("R" + suffix, nodeNum, nextNode, value);
-                break;
-            case ComponentType::Inductor:
-                out << formatInductor("L" + suffix, nodeNum, nextNode, value);
-                break;
-            case ComponentType::Capacitor:
-                out << formatCapacitor("C" + suffix, nodeNum, nextNode, value);
-                break;
-            default:
-                break;
-        }
-        
-        nodeNum = nextNode;
-    } else {
-        // Shunt element connects nodeNum to GND (node 0)
-        switch (seg.componentType) {
-            case ComponentType::Resistor:
-                out << formatResistor("R" + suffix, nodeNum, 0, value);
-                break;
-            case ComponentType::Inductor:
-                out << formatInductor("L" + suffix, nodeNum, 0, value);
-                break;
-            case ComponentType::Capacitor:
-                out << formatCapacitor("C" + suffix, nodeNum, 0, value);
-                break;
-            default:
-                break;
+            double C = -1.0 / (2.0 * M_PI * network.frequency * X);
+            appendElement(out, "CL", -1, nodeNum, 0, C);
         }
     }
-    
-    return elem;
 }
 
-QString SpiceExporter::formatAnalysis() const
+void SpiceExporter::writeAnalysis(std::string& out, double frequency) const
 {
-    QString analysis;
-    QTextStream out(&analysis);
-    
-    out << "* Analysis Commands\n";
+    out += "* Analysis Commands\n";
+    
+    // Sweep arguments shared by .AC and .SP
+    auto appendSweep = [this, &out]() {
+        appendInt(out, m_numPoints);
+        out += ' ';
+        appendEngineering(out, m_startFreq);
+        out += ' ';
+        appendEngineering(out, m_stopFreq);
+        out += '\n';
+    };
     
     switch (m_analysisType) {
         case AnalysisType::AC:
-            out << QString(".AC DEC %1 %2 %3\n")
-                   .arg(m_numPoints)
-                   .arg(engineeringNotation(m_startFreq))
-                   .arg(engineeringNotation(m_stopFreq));
+            out += ".AC DEC ";
+            appendSweep();
             break;
         case AnalysisType::SP:
             if (m_format == SpiceFormat::Ngspice || m_format == SpiceFormat::QucsS) {
-                out << QString(".SP LIN %1 %2 %3\n")
-                       .arg(m_numPoints)
-                       .arg(engineeringNotation(m_startFreq))
-                       .arg(engineeringNotation(m_stopFreq));
+                out += ".SP LIN ";
             } else {
                 // Fallback to AC for simulators without S-param
-                out << QString(".AC DEC %1 %2 %3\n")
-                       .arg(m_numPoints)
-                       .arg(engineeringNotation(m_startFreq))
-                       .arg(engineeringNotation(m_stopFreq));
+                out += ".AC DEC ";
             }
+            appendSweep();
             break;
         case AnalysisType::Transient:
             {
-                double period = 1.0 / m_frequency;
+                double period = 1.0 / frequency;
                 double stopTime = 10.0 * period;
                 double step = period / 100.0;
-                out << QString(".TRAN %1 %2\n")
-                       .arg(engineeringNotation(step))
-                       .arg(engineeringNotation(stopTime));
+                out += ".TRAN ";
+                appendEngineering(out, step);
+                out += ' ';
+                appendEngineering(out, stopTime);
+                out += '\n';
             }
             break;
     }
     
     // Print/plot commands
     if (m_format == SpiceFormat::LTspice) {
-        out << ".PROBE\n";
+        out += ".PROBE\n";
     } else if (m_format == SpiceFormat::Ngspice) {
-        out << ".CONTROL\n";
-        out << "run\n";
-        out << "plot vdb(out)\n";
-        out << ".ENDC\n";
-    }
-    
-    return analysis;
-}
-
-QString SpiceExporter::formatEnding() const
-{
-    if (m_format == SpiceFormat::QucsS) {
-        return "";
-    }
-    return ".END\n";
-}
-
-QString SpiceExporter::formatResistor(const QString& name, int node1, int node2, double value) const
-{
-    return QString("%1 %2 %3 %4\n")
-           .arg(name)
-           .arg(node1)
-           .arg(node2)
-           .arg(formatValue(value, ""));
-}
-
-QString SpiceExporter::formatCapacitor(const QString& name, int node1, int node2, double value) const
-{
-    return QString("%1 %2 %3 %4\n")
-           .arg(name)
-           .arg(node1)
-           .arg(node2)
-           .arg(formatValue(value, ""));
-}
-
-QString SpiceExporter::formatInductor(const QString& name, int node1, int node2, double value) const
-{
-    return QString("%1 %2 %3 %4\n")
-           .arg(name)
-           .arg(node1)
-           .arg(node2)
-           .arg(formatValue(value, ""));
-}
-
-QString SpiceExporter::formatValue(double value, const QString& unit) const
-{
-    Q_UNUSED(unit);
-    return engineeringNotation(value);
-}
-
-QString SpiceExporter::engineeringNotation(double value) const
-{
-    if (value == 0) return "0";
-    
-    // Define SI prefixes
-    const char* prefixes[] = {"f", "p", "n", "u", "m", "", "k", "Meg", "G", "T"};
-    const int prefixOffset = 5;  // Index of "" (no prefix)
-    
-    double absValue = std::abs(value);
-    int exp = static_cast<int>(std::floor(std::log10(absValue)));
-    int prefixIndex = prefixOffset + (exp / 3);
-    
-    // Clamp to valid range
-    if (prefixIndex < 0) prefixIndex = 0;
-    if (prefixIndex > 9) prefixIndex = 9;
-    
-    // Calculate the scaled value
-    double scale = std::pow(10.0, (prefixIndex - prefixOffset) * 3);
-    double scaledValue = value / scale;
-    
-    // Format with appropriate precision
-    QString result;
-    if (std::abs(scaledValue) >= 100) {
-        result = QString::number(scaledValue, 'f', 1);
-    } else if (std::abs(scaledValue) >= 10) {
-        result = QString::number(scaledValue, 'f', 2);
-    } else {
-        result = QString::number(scaledValue, 'f', 3);
+        out += ".CONTROL\nrun\nplot vdb(out)\n.ENDC\n";
     }
-    
-    return result + prefixes[prefixIndex];
 }
 
 } // namespace SmithTool
@@ -6,11 +6,16 @@
 #ifndef SMITHTOOL_SPICEEXPORTER_H
 #define SMITHTOOL_SPICEEXPORTER_H
 
+#include <QByteArray>
 #include <QString>
 #include <QTextStream>
 #include <complex>
+#include <string>
 #include <vector>
 #include "../core/trace.h"
+#include "../core/matching.h"
+#include "../core/montecarlo.h"
+#include "../core/edithistory.h"
 
 namespace SmithTool {
 
@@ -33,8 +38,36 @@ enum class AnalysisType {
     Transient       // Transient analysis
 };
 
+/**
+ * @brief How a batch of networks is written
+ */
+enum class SpiceBatchLayout {
+    Library,        // One .lib file with a .SUBCKT per network
+    Directory       // One netlist per network plus a driver that .include's them
+};
+
+/**
+ * @brief One network of a batch export
+ */
+struct SpiceNetwork {
+    QString name;                           // Subcircuit / file base name
+    std::vector<ElementSpec> elements;      // In trace segment order
+    std::complex<double> sourceZ;
+    std::complex<double> loadZ;
+    double frequency;                       // Hz, for reactive terminations
+    
+    SpiceNetwork() : sourceZ(50.0, 0.0), loadZ(50.0, 0.0), frequency(1e9) {}
+    
+    static SpiceNetwork fromTrace(const MatchingTrace& trace, const QString& name);
+    static SpiceNetwork fromSolution(const MatchingSolution& solution, const QString& name);
+};
+
 /**
  * @brief SPICE netlist exporter class
+ *
+ * Netlists are formatted straight into byte buffers; batches of networks
+ * (all matching solutions, tolerance corners, Monte Carlo samples) are
+ * formatted and written across worker threads.
  */
 class SpiceExporter {
 public:
@@ -81,6 +114,54 @@ public:
      */
     QString generateSubcircuit(const MatchingTrace& trace, const QString& name) const;
     
+    /**
+     * @brief Limit the number of worker threads of batch exports
+     * @param count Thread count (0 = one per hardware thread)
+     */
+    void setThreadCount(int count) { m_threadCount = count; }
+    int threadCount() const { return m_threadCount; }
+    
+    /**
+     * @brief Subcircuit library with one .SUBCKT per network
+     *
+     * Names are made SPICE-safe and unique (see exportBatch()).
+     */
+    QByteArray generateLibrary(const std::vector<SpiceNetwork>& networks) const;
+    
+    /**
+     * @brief Export many networks at once
+     *
+     * Library: path is the .lib file. Directory: path is created if needed
+     * and receives <name>.cir per network, each a complete netlist with
+     * the network's own terminations, and DRIVER_FILE listing them all.
+     * Names are reduced to [A-Za-z0-9_] and de-duplicated with a numeric
+     * suffix.
+     */
+    bool exportBatch(const std::vector<SpiceNetwork>& networks, const QString& path,
+                     SpiceBatchLayout layout, QString& error) const;
+    
+    /**
+     * @brief Every tolerance corner of a network
+     *
+     * Each element with a non-zero tolerance is set to its low and high
+     * limit (value -/+ (relative * |value| + absolute)), giving 2^k
+     * networks named <name>_c<bits>, where bit j set means the j-th
+     * varying element is high. tolerances is indexed like the elements;
+     * missing entries are zero.
+     *
+     * @return Empty if more than MAX_CORNER_ELEMENTS elements vary
+     */
+    static std::vector<SpiceNetwork> toleranceCorners(const SpiceNetwork& nominal,
+                                                      const std::vector<ToleranceSpec>& tolerances);
+    
+    static constexpr int MAX_CORNER_ELEMENTS = 16;
+    
+    // Driver written by directory exports
+    static constexpr const char* DRIVER_FILE = "corners.inc";
+    
+    // Minimum networks per worker thread; smaller batches run inline
+    static constexpr int MIN_NETWORKS_PER_THREAD = 64;
+
 private:
     SpiceFormat m_format;
     AnalysisType m_analysisType;
@@ -95,20 +176,18 @@ private:
     double m_stopFreq;
     int m_numPoints;
     
-    // Helper methods
-    QString formatHeader() const;
-    QString formatSourceImpedance(int& nodeNum) const;
-    QString formatLoadImpedance(int nodeNum) const;
-    QString formatElement(const TraceSegment& seg, int index, int& nodeNum) const;
-    QString formatAnalysis() const;
-    QString formatEnding() const;
+    int m_threadCount;
     
-    QString formatResistor(const QString& name, int node1, int node2, double value) const;
-    QString formatCapacitor(const QString& name, int node1, int node2, double value) const;
-    QString formatInductor(const QString& name, int node1, int node2, double value) const;
+    // Buffer formatters shared by the single and batch exports
+    std::string formatHeader() const;
+    void writeNetlist(std::string& out, const SpiceNetwork& network, const std::string& header,
+                      const std::string& name) const;
+    void writeSubcircuit(std::string& out, const SpiceNetwork& network, const std::string& name) const;
+    void writeSourceImpedance(std::string& out, const SpiceNetwork& network, int& nodeNum) const;
+    void writeLoadImpedance(std::string& out, const SpiceNetwork& network, int nodeNum) const;
+    void writeAnalysis(std::string& out, double frequency) const;
     
-    QString formatValue(double value, const QString& unit) const;
-    QString engineeringNotation(double value) const;
+    SpiceNetwork networkOf(const MatchingTrace& trace) const;
 };
 
 } // namespace SmithTool
@@ -0,0 +1,151 @@
+/**
+ * @file tdranalyzer.cpp
+ * @brief Low-pass time-domain reflectometry implementation
+ */
+
+#include "tdranalyzer.h"
+#include "../core/fft.h"
+#include "../core/profiler.h"
+#include "../core/smithmath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SmithTool {
+
+namespace {
+
+// Zeroth-order modified Bessel function, for the Kaiser window
+double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    const double q = 0.25 * x * x;
+    for (int k = 1; k < 64; ++k) {
+        term *= q / (static_cast<double>(k) * k);
+        sum += term;
+        if (term < 1e-16 * sum) break;
+    }
+    return sum;
+}
+
+} // namespace
+
+double TdrResult::impedance(int index) const
+{
+    // Clamped so an open reads as a large finite impedance
+    double rho = std::clamp(step[index], -0.999999, 0.999999);
+    return z0 * (1.0 + rho) / (1.0 - rho);
+}
+
+double TdrAnalyzer::windowWeight(TdrWindow window, double kaiserBeta, double x)
+{
+    x = std::clamp(x, 0.0, 1.0);
+    const double c = std::cos(SmithMath::PI * x);
+    
+    switch (window) {
+        case TdrWindow::Hann:
+            return 0.5 + 0.5 * c;
+        case TdrWindow::Hamming:
+            return 0.54 + 0.46 * c;
+        case TdrWindow::Blackman:
+            return 0.42 + 0.5 * c + 0.08 * std::cos(SmithMath::TWO_PI * x);
+        case TdrWindow::Kaiser:
+            return besselI0(kaiserBeta * std::sqrt(1.0 - x * x)) / besselI0(kaiserBeta);
+        default:
+            return 1.0;
+    }
+}
+
+TdrResult TdrAnalyzer::compute(const SParamData& data, const TdrSettings& settings)
+{
+    SMITHTOOL_PROFILE_SCOPE("TdrAnalyzer::compute");
+    
+    TdrResult result;
+    result.settings = settings;
+    result.z0 = data.referenceImpedance();
+    
+    const int port = settings.port;
+    if (data.numPoints() < 2 || port < 0 || port >= data.numPorts() ||
+        !(data.maxFrequency() > 0.0)) {
+        return result;
+    }
+    
+    // As many harmonics as measured points, unless the FFT would get too
+    // big; padding is capped so at least one harmonic remains
+    const int padding = FftPlan::nextPowerOfTwo(std::clamp(settings.padding, 1, MAX_FFT_SIZE / 4));
+    int harmonics = data.numPoints();
+    long long paddedSize = static_cast<long long>(FftPlan::nextPowerOfTwo(2 * harmonics + 1)) * padding;
+    while (paddedSize > MAX_FFT_SIZE) {
+        paddedSize /= 2;
+        harmonics = static_cast<int>(std::min<long long>(harmonics, (paddedSize / padding - 1) / 2));
+    }
+    if (harmonics < 1) return result;
+    const int fftSize = static_cast<int>(paddedSize);
+    const double df = data.maxFrequency() / harmonics;
+    
+    // Harmonic grid in one merge walk; frequencies below the first
+    // measured one take its value
+    std::vector<double> freqs(harmonics);
+    for (int k = 0; k < harmonics; ++k) {
+        freqs[k] = (k + 1) * df;
+    }
+    std::vector<Complex> values = data.interpolate(freqs, port, port);
+    
+    // DC is real; extrapolate it linearly from the two lowest harmonics
+    double dc = harmonics > 1 ? 2.0 * values[0].real() - values[1].real() : values[0].real();
+    dc = std::clamp(dc, -1.0, 1.0);
+    
+    // Hermitian spectrum, so the response is real
+    std::vector<Complex> spectrum(fftSize, Complex(0.0, 0.0));
+    spectrum[0] = Complex(dc, 0.0);
+    double weightSum = 1.0;
+    for (int k = 1; k <= harmonics; ++k) {
+        double w = windowWeight(settings.window, settings.kaiserBeta,
+                                static_cast<double>(k) / (harmonics + 1));
+        Complex v = w * values[k - 1];
+        spectrum[k] = v;
+        spectrum[fftSize - k] = std::conj(v);
+        weightSum += 2.0 * w;
+    }
+    
+    FftPlan::forSize(fftSize)->inverse(spectrum.data());
+    
+    const int half = fftSize / 2;
+    result.impulse.resize(half);
+    result.step.resize(half);
+    
+    // The window's kernel straddles t = 0, so the step starts with the
+    // part of the response at negative times
+    double accumulated = 0.0;
+    for (int n = half; n < fftSize; ++n) {
+        accumulated += spectrum[n].real();
+    }
+    const double impulseScale = fftSize / weightSum;
+    for (int n = 0; n < half; ++n) {
+        const double h = spectrum[n].real();
+        accumulated += h;
+        result.impulse[n] = h * impulseScale;
+        result.step[n] = accumulated;
+    }
+    
+    result.timeStep = 1.0 / (fftSize * df);
+    result.frequencyStep = df;
+    result.harmonics = harmonics;
+    result.fftSize = fftSize;
+    return result;
+}
+
+std::shared_ptr<const TdrResult> TdrAnalyzer::cached(const std::shared_ptr<const SParamData>& data,
+                                                     const TdrSettings& settings) const
+{
+    return m_cache.find(data, settings);
+}
+
+void TdrAnalyzer::insert(const std::shared_ptr<const SParamData>& data,
+                         std::shared_ptr<const TdrResult> result)
+{
+    const TdrSettings settings = result->settings;
+    m_cache.insert(data, settings, std::move(result));
+}
+
+} // namespace SmithTool
@@ -0,0 +1,110 @@
+/**
+ * @file tdranalyzer.h
+ * @brief Low-pass time-domain reflectometry from measured reflections
+ */
+
+#ifndef SMITHTOOL_TDRANALYZER_H
+#define SMITHTOOL_TDRANALYZER_H
+
+#include "datasetcache.h"
+#include "sparamdata.h"
+#include <memory>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief Window applied to the spectrum before the inverse FFT
+ * 
+ * Wider windows trade rise time for lower side lobes (ringing around
+ * each discontinuity).
+ */
+enum class TdrWindow {
+    Rectangular,
+    Hann,
+    Hamming,
+    Blackman,
+    Kaiser
+};
+
+/**
+ * @brief Parameters of one TDR computation
+ */
+struct TdrSettings {
+    TdrWindow window = TdrWindow::Kaiser;
+    double kaiserBeta = 6.0;
+    int port = 0;           // Zero-based port whose Sii is transformed
+    int padding = 2;        // Zero-padding factor (power of two), sets time resolution
+    
+    bool operator==(const TdrSettings& other) const {
+        return window == other.window && kaiserBeta == other.kaiserBeta &&
+               port == other.port && padding == other.padding;
+    }
+    bool operator!=(const TdrSettings& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Impulse and step response of one reflection
+ * 
+ * Sample i is at time i * timeStep (round trip). Only non-negative
+ * times up to the alias-free range 1 / (2 * frequencyStep) are kept.
+ */
+struct TdrResult {
+    std::vector<double> impulse;    // Normalized: a full reflection peaks at 1
+    std::vector<double> step;       // Reflection coefficient rho(t)
+    double timeStep = 0.0;
+    double frequencyStep = 0.0;
+    double z0 = 50.0;
+    int harmonics = 0;              // Resampled frequencies, DC excluded
+    int fftSize = 0;
+    TdrSettings settings;
+    
+    int size() const { return static_cast<int>(step.size()); }
+    bool isEmpty() const { return step.empty(); }
+    double time(int index) const { return index * timeStep; }
+    
+    // Impedance seen at sample index, from the step response
+    double impedance(int index) const;
+};
+
+/**
+ * @brief Computes and caches TDR responses of datasets
+ * 
+ * The reflection is resampled onto the harmonic grid k * fmax / N with one
+ * batched interpolation, extrapolated to DC, windowed, mirrored into a
+ * Hermitian spectrum and transformed with a cached power-of-two FFT plan.
+ * 
+ * compute() is pure and may run on any thread. Results are cached per
+ * dataset object and settings in a DatasetCache, which belongs to one
+ * thread and forgets datasets that have been destroyed.
+ */
+class TdrAnalyzer {
+public:
+    /**
+     * @brief Time-domain response of Sii
+     * @return Empty if the data has fewer than two points or no such port
+     */
+    static TdrResult compute(const SParamData& data, const TdrSettings& settings);
+    
+    /**
+     * @brief Half-window weight at offset x from the center
+     * @param x 0 at DC to 1 just past the highest frequency
+     */
+    static double windowWeight(TdrWindow window, double kaiserBeta, double x);
+    
+    // Cached result for this dataset object and settings, or null
+    std::shared_ptr<const TdrResult> cached(const std::shared_ptr<const SParamData>& data,
+                                            const TdrSettings& settings) const;
+    void insert(const std::shared_ptr<const SParamData>& data,
+                std::shared_ptr<const TdrResult> result);
+    void clear() { m_cache.clear(); }
+    
+    static constexpr int MAX_FFT_SIZE = 1 << 22;
+
+private:
+    DatasetCache<TdrSettings, TdrResult> m_cache;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_TDRANALYZER_H
@@ -4,39 +4,226 @@
  */
 
 #include "touchstone.h"
+#include "../core/profiler.h"
 #include <QFileInfo>
 #include <QRegularExpression>
+#include <algorithm>
+#include <charconv>
 #include <cmath>
+#include <cstring>
 
 namespace SmithTool {
 
 // TouchstoneParser implementation
 
+namespace {
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Parse one whitespace-delimited number starting at p, advancing p past it
+inline bool readNumber(const char*& p, const char* end, double& value)
+{
+    while (p < end && isBlank(*p)) ++p;
+    if (p >= end) return false;
+    
+    // std::from_chars does not accept a leading '+'
+    if (*p == '+') ++p;
+    
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    
+    // The token must end at whitespace, not in the middle of garbage
+    return p == end || isBlank(*p);
+}
+
+} // namespace
+
 TouchstoneParser::TouchstoneParser()
     : m_format(SParamFormat::MA)
     , m_freqMultiplier(1e9)  // Default GHz
+    , m_fastPath(true)
+    , m_cancelled(false)
+    , m_binaryCache(false)
+    , m_fromCache(false)
+    , m_sink(nullptr)
+    , m_numPorts(1)
+    , m_version2(false)
+    , m_optionFound(false)
+    , m_dataEnded(false)
+    , m_twoPortOrder12(false)
+    , m_matrixFormat(MatrixFormat::Full)
+    , m_referencesPending(0)
+    , m_noiseSection(false)
 {
 }
 
-bool TouchstoneParser::parse(const QString& filename)
+void TouchstoneParser::resetState(int numPorts)
 {
+    m_numPorts = numPorts;
+    m_version2 = false;
+    m_optionFound = false;
+    m_dataEnded = false;
+    m_twoPortOrder12 = false;
+    m_matrixFormat = MatrixFormat::Full;
+    m_referencesPending = 0;
+    m_noiseSection = false;
+    m_noise = NoiseParameters();
+    m_record.clear();
+    
     m_data.clear();
+    m_data.setNumPorts(numPorts);
+}
+
+bool TouchstoneParser::reportProgress(qint64 processed, qint64 total)
+{
+    if (!m_progress || m_progress(processed, total)) {
+        return true;
+    }
+    m_cancelled = true;
+    m_lastError = QString("Loading cancelled");
+    return false;
+}
+
+bool TouchstoneParser::parse(const QString& filename)
+{
+    SMITHTOOL_PROFILE_SCOPE("TouchstoneParser::parse");
+    
     m_lastError.clear();
+    m_cancelled = false;
+    m_fromCache = false;
+    
+    // Binary exports load directly
+    if (SParamCache::isCacheFile(filename)) {
+        return loadBinary(filename, filename, nullptr);
+    }
+    
+    // A cache built from this exact file replaces the text parse
+    SParamSourceStamp stamp;
+    QString cachePath;
+    if (m_binaryCache && SParamCache::stampFile(filename, stamp)) {
+        cachePath = SParamCache::cachePathFor(filename);
+        if (!cachePath.isEmpty() && QFile::exists(cachePath) &&
+            loadBinary(cachePath, filename, &stamp)) {
+            return true;
+        }
+        if (m_cancelled) {
+            return false;
+        }
+        m_lastError.clear();
+    }
+    
+    resetState(detectPortCount(filename));
     
     QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    QIODevice::OpenMode mode = QIODevice::ReadOnly;
+    if (!m_fastPath) {
+        mode |= QIODevice::Text;
+    }
+    if (!file.open(mode)) {
         m_lastError = QString("Cannot open file: %1").arg(filename);
         return false;
     }
     
-    PortCount ports = detectPortCount(filename);
-    m_data.setPortCount(ports);
     m_data.setFilename(filename);
     
+    bool ok = m_fastPath ? parseMapped(file) : parseText(file);
+    const qint64 size = file.size();
+    file.close();
+    if (!ok) {
+        return false;
+    }
+    
+    m_data.sortByFrequency();
+    if (!reportProgress(size, size)) {
+        return false;
+    }
+    attachNoise();
+    
+    // Failing to write the cache only costs the next load a parse; the
+    // binary format has no noise section, so such files are not cached
+    if (!cachePath.isEmpty() && m_data.numPoints() >= MIN_CACHED_POINTS &&
+        !m_data.hasNoiseParameters()) {
+        SParamCacheInfo info;
+        info.format = m_format;
+        info.frequencyMultiplier = m_freqMultiplier;
+        info.source = stamp;
+        QString error;
+        SParamCache::write(cachePath, m_data, info, error);
+    }
+    return true;
+}
+
+bool TouchstoneParser::parseStream(const QString& filename, const RecordSink& sink)
+{
+    SMITHTOOL_PROFILE_SCOPE("TouchstoneParser::parseStream");
+    
+    m_lastError.clear();
+    m_cancelled = false;
+    m_fromCache = false;
+    resetState(detectPortCount(filename));
+    
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_lastError = QString("Cannot open file: %1").arg(filename);
+        return false;
+    }
+    m_data.setFilename(filename);
+    
+    m_sink = &sink;
+    bool ok = parseChunked(file);
+    m_sink = nullptr;
+    const qint64 size = file.size();
+    file.close();
+    
+    // A sink that stopped the parse counts as a cancellation
+    if (!ok || m_cancelled) {
+        return false;
+    }
+    return reportProgress(size, size);
+}
+
+bool TouchstoneParser::loadBinary(const QString& filename, const QString& sourceFile,
+                                  const SParamSourceStamp* expected)
+{
+    SParamData data;
+    SParamCacheInfo info;
+    if (!SParamCache::read(filename, data, info, m_lastError)) {
+        return false;
+    }
+    if (expected && info.source != *expected) {
+        m_lastError = QString("Cache is stale: %1").arg(filename);
+        return false;
+    }
+    
+    data.setFilename(sourceFile);
+    m_data = std::move(data);
+    m_format = info.format;
+    m_freqMultiplier = info.frequencyMultiplier;
+    m_fromCache = (expected != nullptr);
+    
+    QFileInfo fileInfo(filename);
+    return reportProgress(fileInfo.size(), fileInfo.size());
+}
+
+bool TouchstoneParser::parseText(QFile& file)
+{
     QTextStream in(&file);
-    bool optionFound = false;
+    const qint64 total = file.size();
+    qint64 nextReport = PROGRESS_INTERVAL;
     
-    while (!in.atEnd()) {
+    while (!in.atEnd() && !m_dataEnded) {
+        // The device position runs ahead of the stream by its buffer only
+        if (file.pos() >= nextReport) {
+            if (!reportProgress(file.pos(), total)) {
+                return false;
+            }
+            nextReport = file.pos() + PROGRESS_INTERVAL;
+        }
+        
         QString line = in.readLine().trimmed();
         
         // Skip empty lines and comments
@@ -46,24 +233,138 @@ bool TouchstoneParser::parse(const QString& filename)
         // Option line
         if (line.startsWith('#')) {
             if (!parseOptionLine(line)) {
-                file.close();
                 return false;
             }
-            optionFound = true;
             continue;
         }
         
-        // Data line
-        if (optionFound) {
-            if (!parseDataLine(line, ports)) {
-                // Non-fatal: might be a comment without !
-                continue;
+        // Touchstone 2.0 keyword
+        if (line.startsWith('[')) {
+            if (!parseKeywordLine(line)) {
+                return false;
             }
+            continue;
         }
+        
+        // Data line; non-fatal, might be a comment without !
+        parseDataLine(line);
+    }
+    
+    return true;
+}
+
+bool TouchstoneParser::parseMapped(QFile& file)
+{
+    qint64 size = file.size();
+    if (size <= 0) {
+        return true;  // Empty file: nothing to parse
+    }
+    
+    uchar* mapped = file.map(0, size);
+    if (mapped) {
+        const char* begin = reinterpret_cast<const char*>(mapped);
+        bool ok = parseBuffer(begin, begin + size, 0, size);
+        file.unmap(mapped);
+        return ok;
+    }
+    
+    // Mapping is not available on every file system; read it instead
+    QByteArray bytes = file.readAll();
+    return parseBuffer(bytes.constData(), bytes.constData() + bytes.size(), 0, bytes.size());
+}
+
+bool TouchstoneParser::parseChunked(QFile& file)
+{
+    const qint64 total = file.size();
+    std::vector<char> buffer(static_cast<size_t>(READ_CHUNK));
+    qint64 carry = 0;       // Bytes of an unfinished line kept from the last read
+    qint64 offset = 0;      // File offset of buffer[0]
+    
+    while (!m_dataEnded) {
+        // A line longer than the buffer: grow it
+        if (carry == static_cast<qint64>(buffer.size())) {
+            buffer.resize(buffer.size() * 2);
+        }
+        
+        const qint64 n = file.read(buffer.data() + carry, static_cast<qint64>(buffer.size()) - carry);
+        if (n < 0) {
+            m_lastError = QString("Cannot read file: %1").arg(file.fileName());
+            return false;
+        }
+        
+        // Parse complete lines only; at end of file, everything left
+        const char* begin = buffer.data();
+        const char* end = begin + carry + n;
+        const char* cut = end;
+        if (n > 0) {
+            const char* p = end;
+            while (p > begin && *(p - 1) != '\n') --p;
+            cut = p;
+        }
+        
+        if (cut > begin && !parseBuffer(begin, cut, offset, total)) {
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        
+        carry = end - cut;
+        offset += cut - begin;
+        std::memmove(buffer.data(), cut, static_cast<size_t>(carry));
+    }
+    
+    return true;
+}
+
+bool TouchstoneParser::parseBuffer(const char* begin, const char* end, qint64 offset, qint64 total)
+{
+    // Rough guess of the record count avoids repeated reallocation
+    if (!m_sink) {
+        const int bytesPerRecord = 12 + 24 * m_data.matrixSize();
+        m_data.reserve(static_cast<int>((end - begin) / bytesPerRecord) + 1);
+    }
+    
+    const char* p = begin;
+    const char* nextReport = begin + std::min<qint64>(PROGRESS_INTERVAL, end - begin);
+    
+    while (p < end && !m_dataEnded) {
+        if (p >= nextReport) {
+            if (!reportProgress(offset + (p - begin), total)) {
+                return false;
+            }
+            nextReport = p + std::min<qint64>(PROGRESS_INTERVAL, end - p);
+        }
+        
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = eol ? eol : end;
+        
+        // Trim
+        const char* lineBegin = p;
+        while (lineBegin < lineEnd && isBlank(*lineBegin)) ++lineBegin;
+        const char* trimmedEnd = lineEnd;
+        while (trimmedEnd > lineBegin && isBlank(*(trimmedEnd - 1))) --trimmedEnd;
+        
+        p = eol ? eol + 1 : end;
+        
+        // Skip empty lines and comments
+        if (lineBegin == trimmedEnd) continue;
+        if (*lineBegin == '!') continue;
+        
+        // Option and keyword lines are rare, so the QString path is fine
+        if (*lineBegin == '#' || *lineBegin == '[') {
+            QString line = QString::fromLatin1(lineBegin, trimmedEnd - lineBegin);
+            bool ok = (*lineBegin == '#') ? parseOptionLine(line) : parseKeywordLine(line);
+            if (!ok) {
+                return false;
+            }
+            continue;
+        }
+        
+        // Data line; failures are non-fatal as in the text path
+        parseDataLine(lineBegin, trimmedEnd);
     }
     
-    file.close();
-    m_data.sortByFrequency();
     return true;
 }
 
@@ -99,39 +400,251 @@ bool TouchstoneParser::parseOptionLine(const QString& line)
         }
     }
     
+    m_optionFound = true;
     return true;
 }
 
-bool TouchstoneParser::parseDataLine(const QString& line, PortCount ports)
+bool TouchstoneParser::parseKeywordLine(const QString& line)
+{
+    // Format: [Keyword] argument ! comment
+    int close = line.indexOf(']');
+    if (close < 0) {
+        return true;  // Not a keyword; ignore like other malformed lines
+    }
+    
+    QString keyword = line.mid(1, close - 1).trimmed().toUpper();
+    QString argument = line.mid(close + 1);
+    int bang = argument.indexOf('!');
+    if (bang >= 0) argument.truncate(bang);
+    argument = argument.trimmed();
+    
+    if (keyword == "VERSION") {
+        m_version2 = true;
+    } else if (keyword == "NUMBER OF PORTS") {
+        bool ok;
+        int ports = argument.toInt(&ok);
+        if (!ok || ports < 1) {
+            m_lastError = QString("Invalid port count: %1").arg(argument);
+            return false;
+        }
+        m_numPorts = ports;
+        m_data.setNumPorts(ports);
+    } else if (keyword == "TWO-PORT DATA ORDER") {
+        m_twoPortOrder12 = (argument == "12_21");
+    } else if (keyword == "NUMBER OF FREQUENCIES") {
+        if (!m_sink) m_data.reserve(argument.toInt());
+    } else if (keyword == "MATRIX FORMAT") {
+        QString fmt = argument.toUpper();
+        if (fmt == "LOWER") m_matrixFormat = MatrixFormat::Lower;
+        else if (fmt == "UPPER") m_matrixFormat = MatrixFormat::Upper;
+        else m_matrixFormat = MatrixFormat::Full;
+    } else if (keyword == "REFERENCE") {
+        // One impedance per port, possibly continued on the next lines
+        m_referencesPending = m_numPorts;
+        if (!argument.isEmpty()) {
+            parseDataLine(argument);
+        }
+    } else if (keyword == "NOISE DATA" && m_numPorts == 2 && !m_sink) {
+        m_noiseSection = true;
+    } else if (keyword == "NOISE DATA" || keyword == "END") {
+        m_dataEnded = true;
+    }
+    // Other keywords ([Network Data], [Mixed-Mode Order], ...) need no action
+    
+    return true;
+}
+
+bool TouchstoneParser::parseDataLine(const QString& line)
+{
+    QString data = line;
+    int bang = data.indexOf('!');
+    if (bang >= 0) data.truncate(bang);
+    
+    QStringList parts = data.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    if (parts.isEmpty()) {
+        return false;
+    }
+    
+    m_lineValues.resize(parts.size());
+    for (int i = 0; i < parts.size(); ++i) {
+        bool ok;
+        m_lineValues[i] = parts[i].toDouble(&ok);
+        if (!ok) return false;
+    }
+    
+    return appendValues(m_lineValues.data(), static_cast<int>(m_lineValues.size()));
+}
+
+bool TouchstoneParser::parseDataLine(const char* begin, const char* end)
 {
-    QStringList parts = line.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    // Drop a trailing comment
+    const char* bang = static_cast<const char*>(std::memchr(begin, '!', end - begin));
+    if (bang) end = bang;
     
-    int expectedParts = (ports == PortCount::OnePort) ? 3 : 9;
-    if (parts.size() < expectedParts) {
+    m_lineValues.clear();
+    const char* p = begin;
+    while (true) {
+        while (p < end && isBlank(*p)) ++p;
+        if (p >= end) break;
+        
+        double value;
+        if (!readNumber(p, end, value)) {
+            return false;
+        }
+        m_lineValues.push_back(value);
+    }
+    if (m_lineValues.empty()) {
         return false;
     }
     
-    bool ok;
-    double freq = parts[0].toDouble(&ok) * m_freqMultiplier;
-    if (!ok) return false;
+    return appendValues(m_lineValues.data(), static_cast<int>(m_lineValues.size()));
+}
+
+bool TouchstoneParser::appendValues(const double* values, int count)
+{
+    // [Reference] impedances come before the network data
+    if (m_referencesPending > 0) {
+        if (m_referencesPending == m_numPorts) {
+            // Only a single reference impedance is stored; use port 1's
+            m_data.setReferenceImpedance(values[0]);
+        }
+        int used = std::min(count, m_referencesPending);
+        m_referencesPending -= used;
+        values += used;
+        count -= used;
+        if (count == 0) return true;
+    }
     
-    SParamPoint point;
-    point.frequency = freq;
+    if (!m_optionFound || m_dataEnded) {
+        return false;
+    }
     
-    if (ports == PortCount::OnePort) {
-        point.s11 = parseValue(parts[1].toDouble(), parts[2].toDouble());
-    } else {
-        // Two port: S11, S21, S12, S22
-        point.s11 = parseValue(parts[1].toDouble(), parts[2].toDouble());
-        point.s21 = parseValue(parts[3].toDouble(), parts[4].toDouble());
-        point.s12 = parseValue(parts[5].toDouble(), parts[6].toDouble());
-        point.s22 = parseValue(parts[7].toDouble(), parts[8].toDouble());
+    // Two-port noise records: the [Noise Data] section of 2.0 files, or
+    // in 1.x the five-value lines after the network data
+    if (m_noiseSection || (lineRecords() && m_numPorts == 2 && count == 5 && !m_sink)) {
+        if (count != 5) return false;
+        m_noiseSection = true;
+        addNoiseRecord(values);
+        return true;
     }
     
-    m_data.addPoint(point);
+    const int expected = valuesPerRecord();
+    
+    // One record per line; extra values are rejected
+    if (lineRecords()) {
+        if (count < expected) return false;
+        addRecord(values);
+        return true;
+    }
+    
+    // Records continue over several lines
+    for (int i = 0; i < count; ++i) {
+        m_record.push_back(values[i]);
+        if (static_cast<int>(m_record.size()) == expected) {
+            addRecord(m_record.data());
+            m_record.clear();
+        }
+    }
     return true;
 }
 
+void TouchstoneParser::addRecord(const double* values)
+{
+    const int n = m_numPorts;
+    m_matrix.assign(static_cast<size_t>(n) * n, Complex(0, 0));
+    
+    const double* v = values + 1;
+    auto next = [&v, this]() {
+        Complex c = parseValue(v[0], v[1]);
+        v += 2;
+        return c;
+    };
+    
+    if (n == 2 && m_matrixFormat == MatrixFormat::Full) {
+        // Two-port data are column-major (S11 S21 S12 S22) unless 12_21
+        m_matrix[0] = next();
+        Complex a = next();
+        Complex b = next();
+        m_matrix[m_twoPortOrder12 ? 1 : 2] = a;
+        m_matrix[m_twoPortOrder12 ? 2 : 1] = b;
+        m_matrix[3] = next();
+    } else if (m_matrixFormat == MatrixFormat::Full) {
+        for (int i = 0; i < n * n; ++i) {
+            m_matrix[i] = next();
+        }
+    } else {
+        // Triangular formats list one half of a reciprocal network
+        for (int i = 0; i < n; ++i) {
+            int jBegin = (m_matrixFormat == MatrixFormat::Lower) ? 0 : i;
+            int jEnd = (m_matrixFormat == MatrixFormat::Lower) ? i + 1 : n;
+            for (int j = jBegin; j < jEnd; ++j) {
+                Complex c = next();
+                m_matrix[i * n + j] = c;
+                m_matrix[j * n + i] = c;
+            }
+        }
+    }
+    
+    if (!m_sink) {
+        m_data.addPoint(values[0] * m_freqMultiplier, m_matrix.data());
+        return;
+    }
+    if (!(*m_sink)(values[0] * m_freqMultiplier, m_matrix.data())) {
+        m_cancelled = true;
+        m_dataEnded = true;
+        m_lastError = QString("Loading cancelled");
+    }
+}
+
+void TouchstoneParser::addNoiseRecord(const double* values)
+{
+    // Frequency, NFmin (dB), |Γopt|, ∠Γopt (degrees), Rn / Z0
+    m_noise.frequencies.push_back(values[0] * m_freqMultiplier);
+    m_noise.fMinDb.push_back(values[1]);
+    m_noise.gammaOpt.push_back(std::polar(values[2], values[3] * 3.14159265358979323846 / 180.0));
+    m_noise.rn.push_back(values[4]);
+}
+
+void TouchstoneParser::attachNoise()
+{
+    if (m_noise.isEmpty()) return;
+    
+    // Records are normally ascending already; sort them if not
+    const int n = m_noise.size();
+    std::vector<int> order(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return m_noise.frequencies[a] < m_noise.frequencies[b];
+    });
+    
+    auto noise = std::make_shared<NoiseParameters>();
+    noise->frequencies.reserve(n);
+    noise->fMinDb.reserve(n);
+    noise->gammaOpt.reserve(n);
+    noise->rn.reserve(n);
+    for (int i : order) {
+        noise->frequencies.push_back(m_noise.frequencies[i]);
+        noise->fMinDb.push_back(m_noise.fMinDb[i]);
+        noise->gammaOpt.push_back(m_noise.gammaOpt[i]);
+        noise->rn.push_back(m_noise.rn[i]);
+    }
+    m_data.setNoiseParameters(std::move(noise));
+    m_noise = NoiseParameters();
+}
+
+int TouchstoneParser::valuesPerRecord() const
+{
+    const int n = m_numPorts;
+    int pairs = (m_matrixFormat == MatrixFormat::Full) ? n * n : n * (n + 1) / 2;
+    return 1 + 2 * pairs;
+}
+
+bool TouchstoneParser::lineRecords() const
+{
+    // Touchstone 1.x one- and two-port records never wrap
+    return !m_version2 && m_numPorts <= 2;
+}
+
 Complex TouchstoneParser::parseValue(double v1, double v2) const
 {
     switch (m_format) {
@@ -154,16 +667,20 @@ Complex TouchstoneParser::parseValue(double v1, double v2) const
     return Complex(0, 0);
 }
 
-PortCount TouchstoneParser::detectPortCount(const QString& filename) const
+int TouchstoneParser::detectPortCount(const QString& filename) const
 {
     QFileInfo fi(filename);
     QString suffix = fi.suffix().toLower();
     
-    if (suffix == "s1p") return PortCount::OnePort;
-    if (suffix == "s2p") return PortCount::TwoPort;
+    // .s<N>p
+    if (suffix.size() >= 3 && suffix.startsWith('s') && suffix.endsWith('p')) {
+        bool ok;
+        int ports = suffix.mid(1, suffix.size() - 2).toInt(&ok);
+        if (ok && ports >= 1) return ports;
+    }
     
     // Default to one port
-    return PortCount::OnePort;
+    return 1;
 }
 
 // TouchstoneWriter implementation
@@ -172,11 +689,40 @@ TouchstoneWriter::TouchstoneWriter()
 {
 }
 
+bool TouchstoneWriter::writeBinary(const QString& filename, const SParamData& data)
+{
+    m_lastError.clear();
+    return SParamCache::write(filename, data, SParamCacheInfo(), m_lastError);
+}
+
 bool TouchstoneWriter::write(const QString& filename, 
                               const SParamData& data,
                               SParamFormat format)
+{
+    const int n = data.numPorts();
+    int k = 0;
+    return writeStream(filename, n, data.referenceImpedance(),
+                       [&data, n, &k](double& frequency, Complex* matrix) {
+        if (k >= data.numPoints()) return false;
+        frequency = data.frequency(k);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                matrix[i * n + j] = data.s(k, i, j);
+            }
+        }
+        ++k;
+        return true;
+    }, format);
+}
+
+bool TouchstoneWriter::writeStream(const QString& filename, int numPorts, double z0,
+                                   const RecordSource& source, SParamFormat format)
 {
     m_lastError.clear();
+    if (numPorts < 1) {
+        m_lastError = QString("Invalid port count: %1").arg(numPorts);
+        return false;
+    }
     
     QFile file(filename);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
@@ -184,68 +730,119 @@ bool TouchstoneWriter::write(const QString& filename,
         return false;
     }
     
-    QTextStream out(&file);
+    std::string out;
+    out.reserve(WRITE_CHUNK + 4096);
+    auto flush = [&file, &out]() {
+        bool ok = file.write(out.data(), static_cast<qint64>(out.size())) ==
+                  static_cast<qint64>(out.size());
+        out.clear();
+        return ok;
+    };
     
     // Write header
-    out << "! Touchstone file generated by SmithTool\n";
-    out << "! Reference impedance: " << data.referenceImpedance() << " ohm\n";
-    
-    // Option line
-    QString formatStr;
+    const char* formatStr = "RI";
     switch (format) {
         case SParamFormat::RI: formatStr = "RI"; break;
         case SParamFormat::MA: formatStr = "MA"; break;
         case SParamFormat::DB: formatStr = "DB"; break;
     }
     
-    out << "# GHz S " << formatStr << " R " << data.referenceImpedance() << "\n";
+    char number[64];
+    auto z0End = std::to_chars(number, number + sizeof(number), z0,
+                               std::chars_format::general, 6).ptr;
+    const std::string z0Str(number, z0End);
+    
+    out += "! Touchstone file generated by SmithTool\n";
+    out += "! Reference impedance: " + z0Str + " ohm\n";
+    out += "# GHz S ";
+    out += formatStr;
+    out += " R " + z0Str + "\n";
     
     // Data lines
-    for (const auto& p : data.points()) {
-        double freq_ghz = p.frequency / 1e9;
-        out << QString::number(freq_ghz, 'f', 6);
+    const int n = numPorts;
+    std::vector<Complex> matrix(static_cast<size_t>(n) * n);
+    double frequency = 0.0;
+    while (source(frequency, matrix.data())) {
+        char* end = std::to_chars(number, number + sizeof(number), frequency / 1e9,
+                                  std::chars_format::fixed, 6).ptr;
+        out.append(number, end);
         
-        if (data.portCount() == PortCount::OnePort) {
-            out << " " << formatValue(p.s11, format);
+        if (n == 2) {
+            // Two-port 1.x order is S11 S21 S12 S22
+            appendValue(out, matrix[0], format);
+            appendValue(out, matrix[2], format);
+            appendValue(out, matrix[1], format);
+            appendValue(out, matrix[3], format);
         } else {
-            out << " " << formatValue(p.s11, format);
-            out << " " << formatValue(p.s21, format);
-            out << " " << formatValue(p.s12, format);
-            out << " " << formatValue(p.s22, format);
+            // Row-major; each row starts a new line, at most 4 pairs per line
+            for (int i = 0; i < n; ++i) {
+                for (int j = 0; j < n; ++j) {
+                    if (j > 0 && j % 4 == 0) {
+                        out += '\n';
+                    }
+                    appendValue(out, matrix[i * n + j], format);
+                }
+                if (i < n - 1) {
+                    out += '\n';
+                }
+            }
+        }
+        out += '\n';
+        
+        if (out.size() >= WRITE_CHUNK && !flush()) {
+            m_lastError = QString("Cannot write file: %1").arg(filename);
+            return false;
         }
-        out << "\n";
     }
     
+    if (!flush()) {
+        m_lastError = QString("Cannot write file: %1").arg(filename);
+        return false;
+    }
     file.close();
     return true;
 }
 
-QString TouchstoneWriter::formatValue(const Complex& s, SParamFormat format) const
+void TouchstoneWriter::appendValue(std::string& out, const Complex& s, SParamFormat format)
 {
+    double first = 0.0, second = 0.0;
+    std::chars_format firstFormat = std::chars_format::scientific;
+    int firstPrecision = 6;
+    int secondPrecision = 6;
+    std::chars_format secondFormat = std::chars_format::scientific;
+    
     switch (format) {
         case SParamFormat::RI:
-            return QString("%1 %2")
-                .arg(s.real(), 0, 'e', 6)
-                .arg(s.imag(), 0, 'e', 6);
-            
-        case SParamFormat::MA: {
-            double mag = std::abs(s);
-            double ang = std::arg(s) * 180.0 / 3.14159265358979323846;
-            return QString("%1 %2")
-                .arg(mag, 0, 'e', 6)
-                .arg(ang, 0, 'f', 2);
-        }
-            
+            first = s.real();
+            second = s.imag();
+            break;
+        
+        case SParamFormat::MA:
+            first = std::abs(s);
+            second = std::arg(s) * 180.0 / 3.14159265358979323846;
+            secondFormat = std::chars_format::fixed;
+            secondPrecision = 2;
+            break;
+        
         case SParamFormat::DB: {
             double mag = std::abs(s);
-            double db = (mag > 1e-12) ? 20.0 * std::log10(mag) : -200.0;
-            double ang = std::arg(s) * 180.0 / 3.14159265358979323846;
-            return QString("%1 %2")
-                .arg(db, 0, 'f', 3)
-                .arg(ang, 0, 'f', 2);
+            first = (mag > 1e-12) ? 20.0 * std::log10(mag) : -200.0;
+            firstFormat = std::chars_format::fixed;
+            firstPrecision = 3;
+            second = std::arg(s) * 180.0 / 3.14159265358979323846;
+            secondFormat = std::chars_format::fixed;
+            secondPrecision = 2;
+            break;
         }
     }
-    return "";
+    
+    char buffer[80];
+    char* p = buffer;
+    *p++ = ' ';
+    p = std::to_chars(p, buffer + sizeof(buffer), first, firstFormat, firstPrecision).ptr;
+    *p++ = ' ';
+    p = std::to_chars(p, buffer + sizeof(buffer), second, secondFormat, secondPrecision).ptr;
+    out.append(buffer, p);
 }
 
 QString TouchstoneWriter::frequencyUnitString(double multiplier) const
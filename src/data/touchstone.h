@@ -1,23 +1,46 @@
 /**
  * @file touchstone.h
- * @brief Touchstone file parser (.s1p, .s2p)
+ * @brief Touchstone file parser and writer (.s1p, .s2p, .snp)
  */
 
 #ifndef SMITHTOOL_TOUCHSTONE_H
 #define SMITHTOOL_TOUCHSTONE_H
 
 #include "sparamdata.h"
+#include "sparamcache.h"
 #include <QString>
 #include <QFile>
 #include <QTextStream>
+#include <functional>
+#include <string>
+#include <vector>
 
 namespace SmithTool {
 
 /**
  * @brief Touchstone file parser
+ * 
+ * Reads Touchstone 1.x and 2.0 files with any number of ports. The port
+ * count comes from the .snp extension or the [Number of Ports] keyword.
+ * One- and two-port 1.x records occupy a single line; all other records
+ * may continue over several lines and are assembled value by value.
  */
 class TouchstoneParser {
 public:
+    /**
+     * @brief Progress callback: bytes parsed so far and file size
+     * @return false to cancel parsing
+     */
+    using ProgressCallback = std::function<bool(qint64 processed, qint64 total)>;
+    
+    /**
+     * @brief Receives each record of parseStream()
+     * @param frequency Frequency in Hz
+     * @param matrix numPorts() values, row-major Sij
+     * @return false to cancel parsing
+     */
+    using RecordSink = std::function<bool(double frequency, const Complex* matrix)>;
+    
     TouchstoneParser();
     ~TouchstoneParser() = default;
     
@@ -28,6 +51,58 @@ public:
      */
     bool parse(const QString& filename);
     
+    /**
+     * @brief Parse a Touchstone file in fixed-size chunks
+     * 
+     * For files too large to hold as SParamData: the file is read
+     * READ_CHUNK bytes at a time and every record goes to the sink
+     * instead of data(), which only receives the port count, reference
+     * impedance and filename. The binary cache is not used. Progress and
+     * cancellation work as in parse().
+     */
+    bool parseStream(const QString& filename, const RecordSink& sink);
+    
+    /**
+     * @brief Port count of the file being (or last) parsed
+     */
+    int numPorts() const { return m_numPorts; }
+    
+    /**
+     * @brief Select the parsing path used by parse()
+     * 
+     * The fast path (default) memory-maps the file and tokenizes the raw
+     * bytes in place with std::from_chars. The text path reads the file
+     * line by line through QTextStream and is kept for comparison.
+     */
+    void setFastPathEnabled(bool enabled) { m_fastPath = enabled; }
+    bool fastPathEnabled() const { return m_fastPath; }
+    
+    /**
+     * @brief Report progress (and allow cancellation) while parsing
+     * 
+     * The callback is invoked from the thread running parse(), roughly
+     * every PROGRESS_INTERVAL bytes. When it returns false parse() stops
+     * and fails with wasCancelled() set.
+     */
+    void setProgressCallback(ProgressCallback callback) { m_progress = std::move(callback); }
+    bool wasCancelled() const { return m_cancelled; }
+    
+    /**
+     * @brief Keep a binary copy of large parsed files (see SParamCache)
+     * 
+     * When enabled, parse() first looks for a cache whose source stamp
+     * (size, mtime, sampled hash) matches the file and loads it instead
+     * of parsing; after a successful parse of at least MIN_CACHED_POINTS
+     * points it writes one. Off by default.
+     */
+    void setBinaryCacheEnabled(bool enabled) { m_binaryCache = enabled; }
+    bool binaryCacheEnabled() const { return m_binaryCache; }
+    
+    /**
+     * @brief Whether the last parse() was served from the binary cache
+     */
+    bool loadedFromCache() const { return m_fromCache; }
+    
     /**
      * @brief Get the parsed data
      * @return S-parameter data
@@ -35,6 +110,11 @@ public:
     const SParamData& data() const { return m_data; }
     SParamData& data() { return m_data; }
     
+    /**
+     * @brief Move the parsed data out of the parser (no copy)
+     */
+    SParamData takeData() { return std::move(m_data); }
+    
     /**
      * @brief Get last error message
      * @return Error message
@@ -46,25 +126,88 @@ public:
      */
     SParamFormat format() const { return m_format; }
     double frequencyMultiplier() const { return m_freqMultiplier; }
-    
+
 private:
+    enum class MatrixFormat {
+        Full,
+        Lower,
+        Upper
+    };
+    
     SParamData m_data;
     SParamFormat m_format;
     double m_freqMultiplier;
     QString m_lastError;
+    bool m_fastPath;
+    ProgressCallback m_progress;
+    bool m_cancelled;
+    bool m_binaryCache;
+    bool m_fromCache;
+    const RecordSink* m_sink;       // Set during parseStream() only
+    
+    static constexpr qint64 PROGRESS_INTERVAL = 256 * 1024;
+    static constexpr qint64 READ_CHUNK = 4 * 1024 * 1024;
+    static constexpr int MIN_CACHED_POINTS = 10000;
+    
+    // Per-file state
+    int m_numPorts;
+    bool m_version2;
+    bool m_optionFound;
+    bool m_dataEnded;
+    bool m_twoPortOrder12;          // [Two-Port Data Order] 12_21
+    MatrixFormat m_matrixFormat;
+    int m_referencesPending;        // [Reference] values still to read
+    bool m_noiseSection;            // Inside [Noise Data]
+    NoiseParameters m_noise;        // Two-port noise records read so far
+    std::vector<double> m_record;   // Values of a record spanning lines
+    std::vector<double> m_lineValues;
+    std::vector<Complex> m_matrix;
+    
+    void resetState(int numPorts);
+    bool reportProgress(qint64 processed, qint64 total);
+    
+    bool loadBinary(const QString& filename, const QString& sourceFile,
+                    const SParamSourceStamp* expected);
+    
+    bool parseText(QFile& file);
+    bool parseMapped(QFile& file);
+    bool parseChunked(QFile& file);
+    
+    // Progress is reported as offset + position within [begin, end) of total
+    bool parseBuffer(const char* begin, const char* end, qint64 offset, qint64 total);
     
     bool parseOptionLine(const QString& line);
-    bool parseDataLine(const QString& line, PortCount ports);
+    bool parseKeywordLine(const QString& line);
+    bool parseDataLine(const QString& line);
+    bool parseDataLine(const char* begin, const char* end);
+    bool appendValues(const double* values, int count);
+    void addRecord(const double* values);
+    void addNoiseRecord(const double* values);
+    void attachNoise();
+    int valuesPerRecord() const;
+    bool lineRecords() const;
     Complex parseValue(double v1, double v2) const;
     
-    PortCount detectPortCount(const QString& filename) const;
+    int detectPortCount(const QString& filename) const;
 };
 
 /**
  * @brief Touchstone file writer
+ * 
+ * Numbers are formatted with std::to_chars into one reused buffer that
+ * goes to the file in WRITE_CHUNK blocks, so memory use does not grow
+ * with the point count.
  */
 class TouchstoneWriter {
 public:
+    /**
+     * @brief Produces the next record for writeStream()
+     * @param frequency Set to the frequency in Hz
+     * @param matrix Filled with numPorts² values, row-major Sij
+     * @return false when there are no more records
+     */
+    using RecordSource = std::function<bool(double& frequency, Complex* matrix)>;
+    
     TouchstoneWriter();
     ~TouchstoneWriter() = default;
     
@@ -79,6 +222,27 @@ public:
                const SParamData& data,
                SParamFormat format = SParamFormat::RI);
     
+    /**
+     * @brief Write records as a source produces them
+     * 
+     * Lets sweep results and other generated data be exported without
+     * building an SParamData first. Frequencies should be ascending.
+     * 
+     * @param numPorts Ports per record
+     * @param z0 Reference impedance for the option line
+     */
+    bool writeStream(const QString& filename, int numPorts, double z0,
+                     const RecordSource& source,
+                     SParamFormat format = SParamFormat::RI);
+    
+    /**
+     * @brief Write data in the binary SParamCache format
+     * 
+     * Exact (no text rounding) and fast to load; TouchstoneParser::parse()
+     * reads such files directly.
+     */
+    bool writeBinary(const QString& filename, const SParamData& data);
+    
     /**
      * @brief Get last error message
      */
@@ -87,7 +251,9 @@ public:
 private:
     QString m_lastError;
     
-    QString formatValue(const Complex& s, SParamFormat format) const;
+    static constexpr std::size_t WRITE_CHUNK = 1 << 20;
+    
+    static void appendValue(std::string& out, const Complex& s, SParamFormat format);
     QString frequencyUnitString(double multiplier) const;
 };
 
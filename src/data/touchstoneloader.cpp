@@ -0,0 +1,219 @@
+/**
+ * @file touchstoneloader.cpp
+ * @brief Background Touchstone file loading implementation
+ */
+
+#include "touchstoneloader.h"
+#include "touchstone.h"
+#include "chunkedsparamstore.h"
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <QPromise>
+#include <algorithm>
+
+namespace SmithTool {
+
+namespace {
+
+// Runs on a pool thread
+void streamFile(QPromise<TouchstoneLoadResult>& promise, const QString& filename,
+                const TouchstoneStreamOptions& options)
+{
+    const ChunkedSParamStore::Precision precision = options.reducedPrecision
+        ? ChunkedSParamStore::Precision::Float : ChunkedSParamStore::Precision::Double;
+    ChunkedSParamStore store(1, precision);
+    
+    TouchstoneParser parser;
+    int nextPreview = TouchstoneStreamOptions::PREVIEW_STEP;
+    parser.setProgressCallback([&](qint64 processed, qint64 total) {
+        if (total <= 0) {
+            return !promise.isCanceled();
+        }
+        const int percent = static_cast<int>(processed * 100 / total);
+        promise.setProgressValue(percent);
+        
+        // Previews cost previewPoints copies each, whatever the file size
+        if (percent >= nextPreview && percent < 100 && !store.isEmpty()) {
+            nextPreview = percent + TouchstoneStreamOptions::PREVIEW_STEP;
+            SParamData preview = store.toSParamData(options.previewPoints);
+            preview.setFilename(filename);
+            
+            TouchstoneLoadResult partial;
+            partial.filename = filename;
+            partial.partial = true;
+            partial.pointsRead = store.numPoints();
+            partial.data = std::make_shared<SParamData>(std::move(preview));
+            promise.addResult(std::move(partial));
+        }
+        return !promise.isCanceled();
+    });
+    
+    TouchstoneLoadResult result;
+    result.filename = filename;
+    result.ok = parser.parseStream(filename, [&](double frequency, const Complex* matrix) {
+        // Header keywords are all read before the first record
+        if (store.isEmpty()) {
+            store.reset(parser.numPorts(), precision);
+            store.setReferenceImpedance(parser.data().referenceImpedance());
+        }
+        store.append(frequency, matrix);
+        return true;
+    });
+    if (parser.wasCancelled()) {
+        return;
+    }
+    
+    if (result.ok) {
+        if (store.isEmpty()) {
+            store.reset(parser.numPorts(), precision);
+        }
+        store.setReferenceImpedance(parser.data().referenceImpedance());
+        result.pointsRead = store.numPoints();
+        result.data = std::make_shared<SParamData>(store.toSParamData(options.maxPoints));
+        result.data->setFilename(filename);
+    } else {
+        result.error = parser.lastError();
+    }
+    promise.addResult(std::move(result));
+}
+
+// Runs on a pool thread
+void parseFile(QPromise<TouchstoneLoadResult>& promise, const QString& filename,
+               const TouchstoneStreamOptions& options)
+{
+    promise.setProgressRange(0, 100);
+    
+    // Binary files are compact already and load with a few block copies
+    if (options.thresholdBytes >= 0 && QFileInfo(filename).size() >= options.thresholdBytes &&
+        !SParamCache::isCacheFile(filename)) {
+        streamFile(promise, filename, options);
+        return;
+    }
+    
+    TouchstoneParser parser;
+    parser.setBinaryCacheEnabled(true);
+    parser.setProgressCallback([&promise](qint64 processed, qint64 total) {
+        if (total > 0) {
+            promise.setProgressValue(static_cast<int>(processed * 100 / total));
+        }
+        return !promise.isCanceled();
+    });
+    
+    TouchstoneLoadResult result;
+    result.filename = filename;
+    result.ok = parser.parse(filename);
+    if (parser.wasCancelled()) {
+        return;
+    }
+    
+    if (result.ok) {
+        result.data = std::make_shared<SParamData>(parser.takeData());
+        result.pointsRead = result.data->numPoints();
+    } else {
+        result.error = parser.lastError();
+    }
+    promise.addResult(std::move(result));
+}
+
+} // namespace
+
+TouchstoneLoader::TouchstoneLoader(QObject* parent)
+    : QObject(parent)
+    , m_finishedCount(0)
+{
+}
+
+TouchstoneLoader::~TouchstoneLoader()
+{
+    // Tasks reference their promise only, but do not leave them running
+    for (Watcher* watcher : m_watchers) {
+        watcher->disconnect(this);
+        watcher->cancel();
+        watcher->waitForFinished();
+    }
+}
+
+void TouchstoneLoader::load(const QStringList& filenames)
+{
+    for (const QString& filename : filenames) {
+        Watcher* watcher = new Watcher(this);
+        connect(watcher, &Watcher::finished, this, [this, watcher]() {
+            onWatcherFinished(watcher);
+        });
+        connect(watcher, &Watcher::resultReadyAt, this, [this, watcher](int index) {
+            onResultReady(watcher, index);
+        });
+        connect(watcher, &Watcher::progressValueChanged, this, &TouchstoneLoader::updateProgress);
+        
+        m_watchers.push_back(watcher);
+        watcher->setFuture(QtConcurrent::run(parseFile, filename, m_streamOptions));
+    }
+    updateProgress();
+}
+
+void TouchstoneLoader::cancel()
+{
+    for (Watcher* watcher : m_watchers) {
+        watcher->cancel();
+    }
+}
+
+void TouchstoneLoader::onWatcherFinished(Watcher* watcher)
+{
+    m_watchers.erase(std::remove(m_watchers.begin(), m_watchers.end(), watcher),
+                     m_watchers.end());
+    watcher->deleteLater();
+    ++m_finishedCount;
+    
+    // The final result comes last, after any previews
+    QFuture<TouchstoneLoadResult> future = watcher->future();
+    QList<TouchstoneLoadResult> results;
+    if (!future.isCanceled() && future.resultCount() > 0) {
+        results = future.takeResults();
+    }
+    if (!results.isEmpty() && !results.last().partial) {
+        TouchstoneLoadResult result = std::move(results.last());
+        if (result.ok) {
+            m_axisPool.intern(*result.data);
+            emit fileLoaded(result.filename, std::move(result.data));
+        } else {
+            emit fileFailed(result.filename, result.error);
+        }
+    }
+    
+    updateProgress();
+    if (m_watchers.empty()) {
+        m_finishedCount = 0;
+        emit finished();
+    }
+}
+
+void TouchstoneLoader::onResultReady(Watcher* watcher, int index)
+{
+    if (watcher->isCanceled()) {
+        return;
+    }
+    
+    // Copies the shared data pointer only
+    TouchstoneLoadResult result = watcher->resultAt(index);
+    if (result.partial && result.data) {
+        emit partialDataAvailable(result.filename, std::move(result.data), result.pointsRead);
+    }
+}
+
+void TouchstoneLoader::updateProgress()
+{
+    if (m_watchers.empty()) {
+        emit progressChanged(100);
+        return;
+    }
+    
+    // Finished files count as complete so the bar never moves backwards
+    int sum = 100 * m_finishedCount;
+    for (const Watcher* watcher : m_watchers) {
+        sum += watcher->progressValue();
+    }
+    emit progressChanged(sum / (m_finishedCount + static_cast<int>(m_watchers.size())));
+}
+
+} // namespace SmithTool
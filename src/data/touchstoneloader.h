@@ -0,0 +1,127 @@
+/**
+ * @file touchstoneloader.h
+ * @brief Background Touchstone file loading
+ */
+
+#ifndef SMITHTOOL_TOUCHSTONELOADER_H
+#define SMITHTOOL_TOUCHSTONELOADER_H
+
+#include "sparamdata.h"
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <memory>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief Outcome of parsing one file on a worker thread
+ */
+struct TouchstoneLoadResult {
+    QString filename;
+    std::shared_ptr<SParamData> data;   // Shared so results copy cheaply
+    QString error;
+    bool ok;
+    
+    // Streamed files also report previews (partial results) while loading
+    bool partial;
+    qint64 pointsRead;      // Records parsed (may exceed data->numPoints())
+    
+    TouchstoneLoadResult() : ok(false), partial(false), pointsRead(0) {}
+};
+
+/**
+ * @brief When and how huge files are streamed instead of parsed whole
+ *
+ * A streamed file is read in chunks into a ChunkedSParamStore, sending
+ * a preview every PREVIEW_STEP percent so the chart draws the trace as
+ * it loads. The final data handed out is capped at maxPoints (evenly
+ * sampled), since a multi-GB file cannot be drawn at full resolution
+ * anyway.
+ */
+struct TouchstoneStreamOptions {
+    qint64 thresholdBytes;      // Stream files at least this large; < 0 never
+    bool reducedPrecision;      // Store values as float32 while loading
+    int maxPoints;              // Point limit of the final data, 0 for none
+    int previewPoints;          // Point limit of each preview
+    
+    static constexpr int PREVIEW_STEP = 10;
+    
+    TouchstoneStreamOptions()
+        : thresholdBytes(256LL * 1024 * 1024)
+        , reducedPrecision(false)
+        , maxPoints(1 << 21)
+        , previewPoints(1 << 13) {}
+};
+
+/**
+ * @brief Parses Touchstone files on the global thread pool
+ *
+ * Every file is parsed by its own task, so several files (e.g. a
+ * multi-file drop) load concurrently. Signals are emitted on the thread
+ * that owns the loader; the parsed data is moved into a shared object
+ * and handed over without copying. Files measured on the same sweep share
+ * one frequency array.
+ */
+class TouchstoneLoader : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TouchstoneLoader(QObject* parent = nullptr);
+    ~TouchstoneLoader() override;
+    
+    /**
+     * @brief Start loading files in the background
+     *
+     * Files may be added while a previous batch is still loading; the
+     * progress then covers all pending files.
+     */
+    void load(const QStringList& filenames);
+    
+    /**
+     * @brief Cancel all pending files
+     *
+     * Cancelled files report neither fileLoaded nor fileFailed.
+     */
+    void cancel();
+    
+    bool isBusy() const { return !m_watchers.empty(); }
+    
+    /**
+     * @brief Streaming policy for files loaded after this call
+     */
+    void setStreamOptions(const TouchstoneStreamOptions& options) { m_streamOptions = options; }
+    const TouchstoneStreamOptions& streamOptions() const { return m_streamOptions; }
+
+signals:
+    void progressChanged(int percent);
+    void fileLoaded(const QString& filename, std::shared_ptr<const SParamData> data);
+    
+    /**
+     * @brief Part of a streamed file is available
+     * @param preview Evenly sampled points read so far
+     * @param pointsRead Records parsed so far
+     */
+    void partialDataAvailable(const QString& filename, std::shared_ptr<const SParamData> preview,
+                              qint64 pointsRead);
+    void fileFailed(const QString& filename, const QString& error);
+    void finished();
+
+private:
+    using Watcher = QFutureWatcher<TouchstoneLoadResult>;
+    
+    std::vector<Watcher*> m_watchers;
+    int m_finishedCount;    // Files of the current batch already done
+    FrequencyAxisPool m_axisPool;
+    TouchstoneStreamOptions m_streamOptions;
+    
+    void onWatcherFinished(Watcher* watcher);
+    void onResultReady(Watcher* watcher, int index);
+    void updateProgress();
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_TOUCHSTONELOADER_H
@@ -0,0 +1,210 @@
+/**
+ * @file twoportanalyzer.cpp
+ * @brief Two-port stability, gain and noise circle implementation
+ */
+
+#include "twoportanalyzer.h"
+#include "../core/profiler.h"
+#include "../core/smithmath.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace SmithTool {
+
+namespace {
+
+inline double dbToLinear(double db)
+{
+    return std::pow(10.0, db / 10.0);
+}
+
+inline double linearToDb(double value)
+{
+    return 10.0 * std::log10(value);
+}
+
+inline SmithCircle circleAt(const std::vector<double>& re, const std::vector<double>& im,
+                            const std::vector<double>& radius, std::size_t index)
+{
+    SmithCircle circle;
+    circle.center = Complex(re[index], im[index]);
+    circle.radius = radius[index];
+    return circle;
+}
+
+// Noise parameters linearly interpolated onto the S-parameter points
+// [first, last), which all lie inside the noise frequency range
+void interpolateNoise(const NoiseParameters& noise, const std::vector<double>& freqs,
+                      int first, int last, std::vector<double>& fMin,
+                      std::vector<double>& optRe, std::vector<double>& optIm,
+                      std::vector<double>& rn)
+{
+    const int n = last - first;
+    fMin.resize(n);
+    optRe.resize(n);
+    optIm.resize(n);
+    rn.resize(n);
+    
+    // Both axes ascend, so one merge walk finds every interval
+    const int m = noise.size();
+    int j = 0;
+    for (int i = 0; i < n; ++i) {
+        const double f = freqs[first + i];
+        while (j + 2 < m && noise.frequencies[j + 1] < f) ++j;
+        
+        const int j1 = std::min(j + 1, m - 1);
+        const double span = noise.frequencies[j1] - noise.frequencies[j];
+        const double t = span > 0.0 ? std::clamp((f - noise.frequencies[j]) / span, 0.0, 1.0) : 0.0;
+        
+        Complex opt = noise.gammaOpt[j] + t * (noise.gammaOpt[j1] - noise.gammaOpt[j]);
+        fMin[i] = noise.fMinDb[j] + t * (noise.fMinDb[j1] - noise.fMinDb[j]);
+        optRe[i] = opt.real();
+        optIm[i] = opt.imag();
+        rn[i] = noise.rn[j] + t * (noise.rn[j1] - noise.rn[j]);
+    }
+}
+
+} // namespace
+
+SmithCircle TwoPortAnalysis::sourceStability(int index) const
+{
+    return circleAt(sourceCenterRe, sourceCenterIm, sourceRadius, index);
+}
+
+SmithCircle TwoPortAnalysis::loadStability(int index) const
+{
+    return circleAt(loadCenterRe, loadCenterIm, loadRadius, index);
+}
+
+SmithCircle TwoPortAnalysis::gainCircle(int level, int index) const
+{
+    return circleAt(gainCenterRe, gainCenterIm, gainRadius,
+                    static_cast<std::size_t>(level) * size() + index);
+}
+
+SmithCircle TwoPortAnalysis::noiseCircle(int level, int index) const
+{
+    return circleAt(noiseCenterRe, noiseCenterIm, noiseRadius,
+                    static_cast<std::size_t>(level) * size() + index);
+}
+
+TwoPortAnalysis TwoPortAnalyzer::compute(const SParamData& data)
+{
+    SMITHTOOL_PROFILE_SCOPE("TwoPortAnalyzer::compute");
+    
+    TwoPortAnalysis result;
+    const int n = data.numPoints();
+    if (data.numPorts() < 2 || n == 0) {
+        return result;
+    }
+    const std::size_t count = static_cast<std::size_t>(n);
+    
+    const Complex* s11 = data.sData(0, 0).data();
+    const Complex* s21 = data.sData(1, 0).data();
+    const Complex* s12 = data.sData(0, 1).data();
+    const Complex* s22 = data.sData(1, 1).data();
+    
+    result.frequencies = data.frequencyData();
+    result.k.resize(count);
+    result.mu.resize(count);
+    result.muSource.resize(count);
+    result.maxGainDb.resize(count);
+    result.sourceCenterRe.resize(count);
+    result.sourceCenterIm.resize(count);
+    result.sourceRadius.resize(count);
+    result.loadCenterRe.resize(count);
+    result.loadCenterIm.resize(count);
+    result.loadRadius.resize(count);
+    
+    SmithMath::TwoPortStabilityArrays out;
+    out.k = result.k.data();
+    out.mu = result.mu.data();
+    out.muSource = result.muSource.data();
+    out.maxGain = result.maxGainDb.data();
+    out.sourceCenterRe = result.sourceCenterRe.data();
+    out.sourceCenterIm = result.sourceCenterIm.data();
+    out.sourceRadius = result.sourceRadius.data();
+    out.loadCenterRe = result.loadCenterRe.data();
+    out.loadCenterIm = result.loadCenterIm.data();
+    out.loadRadius = result.loadRadius.data();
+    SmithMath::twoPortStability(s11, s21, s12, s22, count, out);
+    
+    // Gain circles below the maximum gain; the kernel takes linear gain
+    const std::size_t gainSize = count * TwoPortAnalysis::GAIN_LEVELS;
+    result.gainCenterRe.resize(gainSize);
+    result.gainCenterIm.resize(gainSize);
+    result.gainRadius.resize(gainSize);
+    std::vector<double> level(count);
+    for (int l = 0; l < TwoPortAnalysis::GAIN_LEVELS; ++l) {
+        const double scale = dbToLinear(-TwoPortAnalysis::GAIN_STEPS_DB[l]);
+        for (std::size_t i = 0; i < count; ++i) {
+            level[i] = result.maxGainDb[i] * scale;
+        }
+        const std::size_t offset = l * count;
+        SmithMath::availableGainCircles(s11, s21, s12, s22, level.data(), count,
+                                        result.gainCenterRe.data() + offset,
+                                        result.gainCenterIm.data() + offset,
+                                        result.gainRadius.data() + offset);
+    }
+    for (double& gain : result.maxGainDb) {
+        gain = linearToDb(gain);
+    }
+    
+    // Noise circles where the noise data covers the S-parameter points
+    std::shared_ptr<const NoiseParameters> noise = data.noiseParameters();
+    if (!noise || noise->isEmpty()) {
+        return result;
+    }
+    const std::vector<double>& freqs = result.frequencies;
+    const int first = static_cast<int>(std::lower_bound(freqs.begin(), freqs.end(),
+                                                        noise->frequencies.front()) - freqs.begin());
+    const int last = static_cast<int>(std::upper_bound(freqs.begin(), freqs.end(),
+                                                       noise->frequencies.back()) - freqs.begin());
+    
+    const std::size_t noiseSize = count * TwoPortAnalysis::NOISE_LEVELS;
+    result.fMinDb.assign(count, std::numeric_limits<double>::quiet_NaN());
+    result.noiseCenterRe.assign(noiseSize, 0.0);
+    result.noiseCenterIm.assign(noiseSize, 0.0);
+    result.noiseRadius.assign(noiseSize, -1.0);
+    if (first >= last) {
+        return result;
+    }
+    
+    std::vector<double> fMin, optRe, optIm, rn;
+    interpolateNoise(*noise, freqs, first, last, fMin, optRe, optIm, rn);
+    std::copy(fMin.begin(), fMin.end(), result.fMinDb.begin() + first);
+    
+    const std::size_t span = static_cast<std::size_t>(last - first);
+    std::vector<double> factor(span);
+    for (std::size_t i = 0; i < span; ++i) {
+        fMin[i] = dbToLinear(fMin[i]);
+    }
+    for (int l = 0; l < TwoPortAnalysis::NOISE_LEVELS; ++l) {
+        const double scale = dbToLinear(TwoPortAnalysis::NOISE_STEPS_DB[l]);
+        for (std::size_t i = 0; i < span; ++i) {
+            factor[i] = fMin[i] * scale;
+        }
+        const std::size_t offset = l * count + first;
+        SmithMath::noiseCircles(fMin.data(), optRe.data(), optIm.data(), rn.data(),
+                                factor.data(), span,
+                                result.noiseCenterRe.data() + offset,
+                                result.noiseCenterIm.data() + offset,
+                                result.noiseRadius.data() + offset);
+    }
+    return result;
+}
+
+std::shared_ptr<const TwoPortAnalysis> TwoPortAnalyzer::cached(
+    const std::shared_ptr<const SParamData>& data) const
+{
+    return m_cache.find(data, NoCacheKey());
+}
+
+void TwoPortAnalyzer::insert(const std::shared_ptr<const SParamData>& data,
+                             std::shared_ptr<const TwoPortAnalysis> analysis)
+{
+    m_cache.insert(data, NoCacheKey(), std::move(analysis));
+}
+
+} // namespace SmithTool
@@ -0,0 +1,101 @@
+/**
+ * @file twoportanalyzer.h
+ * @brief Stability, gain and noise circles of measured two-ports
+ */
+
+#ifndef SMITHTOOL_TWOPORTANALYZER_H
+#define SMITHTOOL_TWOPORTANALYZER_H
+
+#include "datasetcache.h"
+#include "sparamdata.h"
+#include <memory>
+#include <vector>
+
+namespace SmithTool {
+
+/**
+ * @brief A circle on the Smith chart (Γ plane)
+ *
+ * For stability circles a negative radius means the stable terminations
+ * lie outside the circle; for gain and noise circles it means the level
+ * cannot be reached at that frequency.
+ */
+struct SmithCircle {
+    Complex center;
+    double radius = -1.0;
+    
+    bool isValid() const { return radius != -1.0; }
+};
+
+/**
+ * @brief Per-frequency two-port figures of merit, structure-of-arrays
+ *
+ * Gain and noise circles are stored level-major: level l at point i is
+ * element l * size() + i.
+ */
+struct TwoPortAnalysis {
+    std::vector<double> frequencies;
+    std::vector<double> k;              // Rollett K
+    std::vector<double> mu;             // Edwards-Sinsky mu (load plane)
+    std::vector<double> muSource;       // mu' (source plane)
+    std::vector<double> maxGainDb;      // MAG if unconditionally stable, else MSG
+    
+    std::vector<double> sourceCenterRe, sourceCenterIm, sourceRadius;
+    std::vector<double> loadCenterRe, loadCenterIm, loadRadius;
+    
+    // Available-gain circles, GAIN_STEPS_DB below maxGainDb
+    std::vector<double> gainCenterRe, gainCenterIm, gainRadius;
+    
+    // Noise circles, NOISE_STEPS_DB above fMinDb (empty without noise data)
+    std::vector<double> fMinDb;         // Interpolated; NaN outside the noise data
+    std::vector<double> noiseCenterRe, noiseCenterIm, noiseRadius;
+    
+    static constexpr int GAIN_LEVELS = 3;
+    static constexpr double GAIN_STEPS_DB[GAIN_LEVELS] = {1.0, 2.0, 3.0};
+    static constexpr int NOISE_LEVELS = 4;
+    static constexpr double NOISE_STEPS_DB[NOISE_LEVELS] = {0.25, 0.5, 1.0, 2.0};
+    
+    int size() const { return static_cast<int>(frequencies.size()); }
+    bool isEmpty() const { return frequencies.empty(); }
+    bool hasNoise() const { return !noiseRadius.empty(); }
+    
+    // Unconditionally stable at point i (mu > 1)
+    bool isStable(int index) const { return mu[index] > 1.0; }
+    
+    SmithCircle sourceStability(int index) const;
+    SmithCircle loadStability(int index) const;
+    SmithCircle gainCircle(int level, int index) const;
+    SmithCircle noiseCircle(int level, int index) const;
+};
+
+/**
+ * @brief Computes and caches two-port analyses of datasets
+ *
+ * All figures come from the batch kernels in SmithMath, one call per
+ * quantity over the whole frequency axis, so selecting another frequency
+ * is a lookup rather than a recomputation.
+ *
+ * compute() is pure and may run on any thread. Analyses are cached per
+ * dataset object in a DatasetCache.
+ */
+class TwoPortAnalyzer {
+public:
+    /**
+     * @brief Analyze the upper-left 2×2 block of the data
+     * @return Empty if the data has fewer than two ports or no points
+     */
+    static TwoPortAnalysis compute(const SParamData& data);
+    
+    // Cached analysis of this dataset object, or null
+    std::shared_ptr<const TwoPortAnalysis> cached(const std::shared_ptr<const SParamData>& data) const;
+    void insert(const std::shared_ptr<const SParamData>& data,
+                std::shared_ptr<const TwoPortAnalysis> analysis);
+    void clear() { m_cache.clear(); }
+
+private:
+    DatasetCache<NoCacheKey, TwoPortAnalysis> m_cache;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_TWOPORTANALYZER_H
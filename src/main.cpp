@@ -4,11 +4,16 @@
  */
 
 #include <QApplication>
+#include <QTimer>
+#include <cstdio>
 #include "ui/mainwindow.h"
+#include "core/startuptimer.h"
 
 int main(int argc, char* argv[])
 {
+    SmithTool::StartupTimer::start();
     QApplication app(argc, argv);
+    SmithTool::StartupTimer::mark("QApplication");
     
     // Set application information
     QApplication::setApplicationName("SmithTool");
@@ -18,6 +23,16 @@ int main(int argc, char* argv[])
     // Create and show main window
     SmithTool::MainWindow mainWindow;
     mainWindow.show();
+    SmithTool::StartupTimer::mark("show");
+    
+    // --startup-report: print the phase times after the first frame and quit
+    if (app.arguments().contains("--startup-report")) {
+        QObject::connect(&mainWindow, &SmithTool::MainWindow::firstFramePainted, &app, []() {
+            std::fputs(SmithTool::StartupTimer::report().toUtf8().constData(), stdout);
+            std::fflush(stdout);
+            QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+        });
+    }
     
     return app.exec();
 }
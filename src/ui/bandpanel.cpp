@@ -0,0 +1,255 @@
+/**
+ * @file bandpanel.cpp
+ * @brief Band analysis panel implementation
+ */
+
+#include "bandpanel.h"
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QSignalBlocker>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace SmithTool {
+
+namespace {
+
+QString formatFrequency(double freq)
+{
+    if (freq >= 1e9) {
+        return QString("%1 GHz").arg(freq / 1e9, 0, 'f', 4);
+    } else if (freq >= 1e6) {
+        return QString("%1 MHz").arg(freq / 1e6, 0, 'f', 3);
+    } else if (freq >= 1e3) {
+        return QString("%1 kHz").arg(freq / 1e3, 0, 'f', 3);
+    }
+    return QString("%1 Hz").arg(freq, 0, 'f', 1);
+}
+
+QString formatExtreme(const BandExtreme& extreme)
+{
+    return QString("%1   %2 dB   VSWR %3")
+        .arg(formatFrequency(extreme.frequency))
+        .arg(extreme.returnLossDb(), 0, 'f', 2)
+        .arg(extreme.vswr(), 0, 'f', 3);
+}
+
+} // namespace
+
+BandPanel::BandPanel(QWidget* parent)
+    : QWidget(parent)
+    , m_bestFrequency(0.0)
+    , m_watcher(new IndexWatcher(this))
+    , m_buildingPort(0)
+    , m_refreshPending(false)
+{
+    m_portCombo = new QComboBox(this);
+    m_portCombo->addItem("S11", 0);
+    
+    auto makeFrequencySpin = [this]() {
+        auto* spin = new QDoubleSpinBox(this);
+        spin->setRange(0.0, 1e6);
+        spin->setDecimals(6);
+        spin->setSuffix(" MHz");
+        spin->setKeyboardTracking(false);
+        return spin;
+    };
+    m_startSpin = makeFrequencySpin();
+    m_stopSpin = makeFrequencySpin();
+    
+    m_thresholdSpin = new QDoubleSpinBox(this);
+    m_thresholdSpin->setRange(-100.0, 0.0);
+    m_thresholdSpin->setDecimals(1);
+    m_thresholdSpin->setSingleStep(0.5);
+    m_thresholdSpin->setValue(-10.0);
+    m_thresholdSpin->setSuffix(" dB");
+    
+    m_bestLabel = new QLabel(this);
+    m_worstLabel = new QLabel(this);
+    m_bandLabel = new QLabel(this);
+    m_crossingsLabel = new QLabel(this);
+    for (QLabel* label : {m_bestLabel, m_worstLabel, m_bandLabel, m_crossingsLabel}) {
+        label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    }
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setStyleSheet("color: gray;");
+    m_markBestButton = new QPushButton(tr("Mark"), this);
+    m_markBestButton->setToolTip(tr("Put the chart marker on the best match"));
+    m_markBestButton->setEnabled(false);
+    
+    auto* bestRow = new QHBoxLayout;
+    bestRow->addWidget(m_bestLabel, 1);
+    bestRow->addWidget(m_markBestButton);
+    
+    auto* form = new QFormLayout;
+    form->addRow(tr("Reflection:"), m_portCombo);
+    form->addRow(tr("Band start:"), m_startSpin);
+    form->addRow(tr("Band stop:"), m_stopSpin);
+    form->addRow(tr("Return loss limit:"), m_thresholdSpin);
+    form->addRow(tr("Best match:"), bestRow);
+    form->addRow(tr("Worst in band:"), m_worstLabel);
+    form->addRow(tr("Bandwidth:"), m_bandLabel);
+    form->addRow(tr("Crossings:"), m_crossingsLabel);
+    
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+    layout->addLayout(form);
+    layout->addWidget(m_statusLabel);
+    layout->addStretch();
+    
+    // Limits and threshold only query the same index
+    connect(m_startSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &BandPanel::updateReadouts);
+    connect(m_stopSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &BandPanel::updateReadouts);
+    connect(m_thresholdSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &BandPanel::updateReadouts);
+    connect(m_portCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &BandPanel::refresh);
+    connect(m_markBestButton, &QPushButton::clicked, this, [this]() {
+        if (m_index) emit markerRequested(m_bestFrequency, m_index->port());
+    });
+    connect(m_watcher, &IndexWatcher::finished, this, &BandPanel::onBuildFinished);
+}
+
+BandPanel::~BandPanel()
+{
+    m_watcher->waitForFinished();
+}
+
+void BandPanel::setData(std::shared_ptr<const SParamData> data)
+{
+    m_data = std::move(data);
+    
+    // One reflection per port
+    const int ports = m_data ? std::max(1, m_data->numPorts()) : 1;
+    if (m_portCombo->count() != ports) {
+        QSignalBlocker blocker(m_portCombo);
+        const int current = m_portCombo->currentIndex();
+        m_portCombo->clear();
+        for (int i = 1; i <= ports; ++i) {
+            m_portCombo->addItem(QString("S%1%1").arg(i), i - 1);
+        }
+        m_portCombo->setCurrentIndex(std::min(std::max(current, 0), ports - 1));
+    }
+    
+    // New data starts with the whole sweep as the band
+    if (m_data && !m_data->isEmpty()) {
+        QSignalBlocker startBlocker(m_startSpin);
+        QSignalBlocker stopBlocker(m_stopSpin);
+        m_startSpin->setValue(m_data->minFrequency() / 1e6);
+        m_stopSpin->setValue(m_data->maxFrequency() / 1e6);
+    }
+    refresh();
+}
+
+void BandPanel::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    refresh();
+}
+
+void BandPanel::refresh()
+{
+    if (!isVisible()) return;
+    
+    if (!m_data || m_data->isEmpty()) {
+        setIndex(nullptr);
+        m_statusLabel->clear();
+        return;
+    }
+    
+    const int port = std::max(0, m_portCombo->currentData().toInt());
+    if (std::shared_ptr<const ReflectionIndex> index = m_analyzer.cached(m_data, port)) {
+        setIndex(std::move(index));
+        m_statusLabel->setText(tr("cached"));
+        return;
+    }
+    
+    if (m_watcher->isRunning()) {
+        m_refreshPending = true;
+        return;
+    }
+    
+    m_buildingData = m_data;
+    m_buildingPort = port;
+    m_buildClock.start();
+    m_statusLabel->setText(tr("indexing..."));
+    std::shared_ptr<const SParamData> data = m_data;
+    m_watcher->setFuture(QtConcurrent::run([data, port]() {
+        return std::make_shared<const ReflectionIndex>(ReflectionIndex::build(*data, port));
+    }));
+}
+
+void BandPanel::onBuildFinished()
+{
+    std::shared_ptr<const ReflectionIndex> index = m_watcher->result();
+    m_analyzer.insert(m_buildingData, index);
+    const bool current = m_buildingData == m_data &&
+                         m_buildingPort == m_portCombo->currentData().toInt();
+    m_buildingData.reset();
+    
+    if (m_refreshPending || !current) {
+        m_refreshPending = false;
+        refresh();
+        return;
+    }
+    setIndex(index);
+    m_statusLabel->setText(tr("Indexed %1 points in %2 ms")
+        .arg(index->size())
+        .arg(m_buildClock.elapsed()));
+}
+
+void BandPanel::setIndex(std::shared_ptr<const ReflectionIndex> index)
+{
+    if (index && index->isEmpty()) index.reset();
+    m_index = std::move(index);
+    updateReadouts();
+}
+
+void BandPanel::updateReadouts()
+{
+    const double start = std::min(bandStart(), bandStop());
+    const double stop = std::max(bandStart(), bandStop());
+    BandExtreme best = m_index ? m_index->minimum(start, stop) : BandExtreme();
+    m_markBestButton->setEnabled(best.isValid());
+    if (!best.isValid()) {
+        for (QLabel* label : {m_bestLabel, m_worstLabel, m_bandLabel, m_crossingsLabel}) {
+            label->setText(m_index ? tr("no points in band") : QString());
+        }
+        return;
+    }
+    
+    m_bestFrequency = best.frequency;
+    m_bestLabel->setText(formatExtreme(best));
+    m_worstLabel->setText(formatExtreme(m_index->maximum(start, stop)));
+    
+    // Contiguous band around the best match
+    const double threshold = m_thresholdSpin->value();
+    BandEdges band = m_index->bandAround(best.frequency, threshold);
+    if (band.valid) {
+        QString text = tr("%1 \u2013 %2   (%3")
+            .arg(formatFrequency(band.low), formatFrequency(band.high), formatFrequency(band.width()));
+        if (band.center() > 0.0) {
+            text += tr(", %1 %").arg(100.0 * band.width() / band.center(), 0, 'f', 2);
+        }
+        text += ")";
+        if (band.lowOpen || band.highOpen) {
+            text += tr("   extends past the data");
+        }
+        m_bandLabel->setText(text);
+    } else {
+        m_bandLabel->setText(tr("limit not met"));
+    }
+    
+    const int maxShown = 4;
+    std::vector<ThresholdCrossing> crossings = m_index->crossings(threshold, start, stop, maxShown + 1);
+    QStringList parts;
+    for (int i = 0; i < std::min<int>(maxShown, static_cast<int>(crossings.size())); ++i) {
+        parts.append(QString("%1 %2").arg(crossings[i].rising ? "\u2191" : "\u2193",
+                                          formatFrequency(crossings[i].frequency)));
+    }
+    if (static_cast<int>(crossings.size()) > maxShown) {
+        parts.append(QString("\u2026"));
+    }
+    m_crossingsLabel->setText(parts.isEmpty() ? tr("none in band") : parts.join("   "));
+}
+
+} // namespace SmithTool
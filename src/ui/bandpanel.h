@@ -0,0 +1,89 @@
+/**
+ * @file bandpanel.h
+ * @brief Band analysis panel: best match, worst VSWR and bandwidth readouts
+ */
+
+#ifndef SMITHTOOL_BANDPANEL_H
+#define SMITHTOOL_BANDPANEL_H
+
+#include <QWidget>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <memory>
+#include "../data/bandanalyzer.h"
+
+namespace SmithTool {
+
+/**
+ * @brief Answers marker and bandwidth questions about the current data
+ *
+ * The reflection index of a dataset is built once in the background and
+ * cached per dataset and port; editing the band limits or the threshold
+ * is then a handful of O(log n) queries, answered before the next frame
+ * even for million-point sweeps.
+ */
+class BandPanel : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit BandPanel(QWidget* parent = nullptr);
+    ~BandPanel() override;
+    
+    /**
+     * @brief Dataset to analyze
+     * @param data Shared with the caller; never copied
+     */
+    void setData(std::shared_ptr<const SParamData> data);
+
+signals:
+    /**
+     * @brief The user asked to put the chart marker on a measured point
+     * @param port Zero-based port of the reflection
+     */
+    void markerRequested(double frequency, int port);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+
+private slots:
+    void refresh();
+    void onBuildFinished();
+    void updateReadouts();
+
+private:
+    void setIndex(std::shared_ptr<const ReflectionIndex> index);
+    double bandStart() const { return m_startSpin->value() * 1e6; }
+    double bandStop() const { return m_stopSpin->value() * 1e6; }
+    
+    QComboBox* m_portCombo;
+    QDoubleSpinBox* m_startSpin;        // MHz
+    QDoubleSpinBox* m_stopSpin;         // MHz
+    QDoubleSpinBox* m_thresholdSpin;    // Return loss, negative dB
+    QLabel* m_bestLabel;
+    QLabel* m_worstLabel;
+    QLabel* m_bandLabel;
+    QLabel* m_crossingsLabel;
+    QLabel* m_statusLabel;
+    QPushButton* m_markBestButton;
+    
+    std::shared_ptr<const SParamData> m_data;
+    std::shared_ptr<const ReflectionIndex> m_index;     // Shown, or null
+    BandAnalyzer m_analyzer;
+    double m_bestFrequency;
+    
+    // One build at a time; the latest request wins
+    using IndexWatcher = QFutureWatcher<std::shared_ptr<const ReflectionIndex>>;
+    IndexWatcher* m_watcher;
+    std::shared_ptr<const SParamData> m_buildingData;
+    int m_buildingPort;
+    QElapsedTimer m_buildClock;
+    bool m_refreshPending;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_BANDPANEL_H
@@ -0,0 +1,189 @@
+/**
+ * @file chartexporter.cpp
+ * @brief Offscreen chart export implementation
+ */
+
+#include "chartexporter.h"
+#include "../core/profiler.h"
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QPageSize>
+#include <QPdfWriter>
+#include <QSvgGenerator>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace SmithTool {
+
+ChartExporter::ChartExporter()
+    : m_cache(std::make_shared<GridCache>())
+{
+}
+
+QImage ChartExporter::renderImage(const ChartScene& scene, const ChartExportSettings& settings) const
+{
+    return render(*m_cache, scene, settings);
+}
+
+bool ChartExporter::exportChart(const ChartScene& scene, const QString& filename,
+                                const ChartExportSettings& settings, QString& error) const
+{
+    return write(*m_cache, scene, filename, settings, error);
+}
+
+QFuture<ChartExportResult> ChartExporter::exportAll(std::vector<ChartExportJob> jobs,
+                                                    const ChartExportSettings& settings) const
+{
+    std::shared_ptr<GridCache> cache = m_cache;
+    return QtConcurrent::mapped(std::move(jobs), [cache, settings](const ChartExportJob& job) {
+        ChartExportResult result;
+        result.filename = job.filename;
+        ChartScene scene = job.scene;
+        if (job.prepare && !job.prepare(scene, result.error)) {
+            return result;
+        }
+        result.ok = write(*cache, scene, job.filename, settings, result.error);
+        return result;
+    });
+}
+
+void ChartExporter::clearCache()
+{
+    std::lock_guard<std::mutex> lock(m_cache->mutex);
+    m_cache->layers.clear();
+}
+
+int ChartExporter::gridRenders() const
+{
+    std::lock_guard<std::mutex> lock(m_cache->mutex);
+    return m_cache->renders;
+}
+
+int ChartExporter::gridReuses() const
+{
+    std::lock_guard<std::mutex> lock(m_cache->mutex);
+    return m_cache->reuses;
+}
+
+QImage ChartExporter::gridLayer(GridCache& cache, const ChartScene& scene,
+                                const ChartExportSettings& settings)
+{
+    ChartRenderer::GridKey key = ChartRenderer::gridKey(scene, settings.pixelSize, settings.scale());
+    std::shared_ptr<GridLayer> layer;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = std::find_if(cache.layers.begin(), cache.layers.end(),
+                               [&key](const std::shared_ptr<GridLayer>& entry) { return entry->key == key; });
+        if (it != cache.layers.end()) {
+            layer = *it;
+            cache.layers.erase(it);
+            ++cache.reuses;
+        } else {
+            layer = std::make_shared<GridLayer>();
+            layer->key = std::move(key);
+            ++cache.renders;
+        }
+        cache.layers.insert(cache.layers.begin(), layer);
+        if (static_cast<int>(cache.layers.size()) > CACHE_ENTRIES) {
+            cache.layers.resize(CACHE_ENTRIES);
+        }
+    }
+    
+    // Drawn outside the lock; other jobs needing this layer wait for it
+    std::call_once(layer->rendered, [&]() {
+        layer->image = ChartRenderer::renderGrid(scene, settings.pixelSize, settings.scale());
+    });
+    return layer->image;
+}
+
+QImage ChartExporter::render(GridCache& cache, const ChartScene& scene,
+                             const ChartExportSettings& settings)
+{
+    SMITHTOOL_PROFILE_SCOPE("ChartExporter::render");
+    if (settings.pixelSize.isEmpty() || settings.dpi <= 0) return QImage();
+    
+    // Painting detaches the copy from the cached layer
+    QImage image = gridLayer(cache, scene, settings);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.scale(settings.scale(), settings.scale());
+    ChartRenderer::drawContent(painter, scene, QSizeF(settings.pixelSize) / settings.scale(),
+                               settings.scale());
+    painter.end();
+    
+    const int dotsPerMeter = qRound(settings.dpi / 0.0254);
+    image.setDotsPerMeterX(dotsPerMeter);
+    image.setDotsPerMeterY(dotsPerMeter);
+    return image;
+}
+
+bool ChartExporter::write(GridCache& cache, const ChartScene& scene, const QString& filename,
+                          const ChartExportSettings& settings, QString& error)
+{
+    if (settings.pixelSize.isEmpty() || settings.dpi <= 0) {
+        error = QString("Invalid export size %1 x %2 at %3 dpi")
+            .arg(settings.pixelSize.width())
+            .arg(settings.pixelSize.height())
+            .arg(settings.dpi);
+        return false;
+    }
+    
+    const QString suffix = QFileInfo(filename).suffix().toLower();
+    const QSizeF logicalSize = QSizeF(settings.pixelSize) / settings.scale();
+    QPainter painter;
+    
+    if (suffix == "svg") {
+        // One SVG unit per logical pixel; decimate as finely as the raster would
+        QSvgGenerator generator;
+        generator.setFileName(filename);
+        generator.setSize(logicalSize.toSize());
+        generator.setViewBox(QRectF(QPointF(0, 0), logicalSize));
+        generator.setResolution(96);
+        generator.setTitle(scene.title);
+        if (!painter.begin(&generator)) {
+            error = QString("Cannot write %1").arg(filename);
+            return false;
+        }
+        painter.setRenderHint(QPainter::Antialiasing);
+        ChartRenderer::drawGrid(painter, scene, logicalSize);
+        ChartRenderer::drawContent(painter, scene, logicalSize, settings.scale());
+        if (!painter.end()) {
+            error = QString("Cannot write %1").arg(filename);
+            return false;
+        }
+        return true;
+    }
+    
+    if (suffix == "pdf") {
+        QPdfWriter writer(filename);
+        writer.setResolution(settings.dpi);
+        writer.setPageSize(QPageSize(QSizeF(settings.pixelSize) / settings.dpi, QPageSize::Inch));
+        writer.setPageMargins(QMarginsF(0, 0, 0, 0));
+        writer.setTitle(scene.title);
+        writer.setCreator("SmithTool");
+        if (!painter.begin(&writer)) {
+            error = QString("Cannot write %1").arg(filename);
+            return false;
+        }
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.scale(settings.scale(), settings.scale());
+        ChartRenderer::drawGrid(painter, scene, logicalSize);
+        ChartRenderer::drawContent(painter, scene, logicalSize, settings.scale());
+        if (!painter.end()) {
+            error = QString("Cannot write %1").arg(filename);
+            return false;
+        }
+        return true;
+    }
+    
+    QImageWriter writer(filename);
+    writer.setQuality(settings.quality);
+    if (!writer.write(render(cache, scene, settings))) {
+        error = QString("Cannot write %1: %2").arg(filename, writer.errorString());
+        return false;
+    }
+    return true;
+}
+
+} // namespace SmithTool
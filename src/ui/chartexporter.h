@@ -0,0 +1,125 @@
+/**
+ * @file chartexporter.h
+ * @brief Offscreen chart export to raster images, SVG and PDF
+ */
+
+#ifndef SMITHTOOL_CHARTEXPORTER_H
+#define SMITHTOOL_CHARTEXPORTER_H
+
+#include <QFuture>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "chartrenderer.h"
+
+namespace SmithTool {
+
+/**
+ * @brief Output size of an export
+ *
+ * The chart is laid out on pixelSize / (dpi / 96) logical pixels, so a
+ * higher dpi gives the same picture with finer detail. Vector files get a
+ * page of pixelSize / dpi inches.
+ */
+struct ChartExportSettings {
+    QSize pixelSize = QSize(2400, 2400);
+    int dpi = 300;
+    int quality = -1;           // JPEG/PNG quality (-1 = format default)
+    
+    double scale() const { return dpi / 96.0; }
+};
+
+/**
+ * @brief One chart of a batch export
+ */
+struct ChartExportJob {
+    ChartScene scene;
+    QString filename;
+    
+    /**
+     * @brief Completes the scene in the worker thread before drawing,
+     *        e.g. by parsing the file to plot (null = draw as is)
+     * @return false with error set to skip the job
+     */
+    std::function<bool(ChartScene& scene, QString& error)> prepare;
+};
+
+struct ChartExportResult {
+    QString filename;
+    bool ok = false;
+    QString error;
+};
+
+/**
+ * @brief Renders charts without a widget, alone or in parallel batches
+ *
+ * The output format follows the file suffix: .svg and .pdf are written as
+ * vector files, anything else through QImage (PNG, JPEG, BMP...). Raster
+ * exports copy a cached grid layer rendered once per size and grid
+ * settings and only draw the data on top, so a batch of report images of
+ * one size renders the grid once. All functions may be called from any
+ * thread.
+ */
+class ChartExporter {
+public:
+    ChartExporter();
+    
+    /**
+     * @brief Draw a scene into a new image of settings.pixelSize
+     */
+    QImage renderImage(const ChartScene& scene, const ChartExportSettings& settings) const;
+    
+    /**
+     * @brief Write one chart
+     * @return false with error set if the file cannot be written
+     */
+    bool exportChart(const ChartScene& scene, const QString& filename,
+                     const ChartExportSettings& settings, QString& error) const;
+    
+    /**
+     * @brief Export all jobs on the global thread pool
+     *
+     * Results are reported in job order. The jobs share this exporter's
+     * grid cache, which stays alive until the last one finishes even if
+     * the exporter is destroyed first.
+     */
+    QFuture<ChartExportResult> exportAll(std::vector<ChartExportJob> jobs,
+                                         const ChartExportSettings& settings) const;
+    
+    void clearCache();
+    
+    // Raster grid layers rendered and reused so far
+    int gridRenders() const;
+    int gridReuses() const;
+    
+    static constexpr int CACHE_ENTRIES = 4;
+
+private:
+    struct GridLayer {
+        ChartRenderer::GridKey key;
+        std::once_flag rendered;
+        QImage image;
+    };
+    struct GridCache {
+        mutable std::mutex mutex;
+        std::vector<std::shared_ptr<GridLayer>> layers;     // Most recently used first
+        int renders = 0;
+        int reuses = 0;
+    };
+    std::shared_ptr<GridCache> m_cache;
+    
+    static QImage gridLayer(GridCache& cache, const ChartScene& scene,
+                            const ChartExportSettings& settings);
+    static QImage render(GridCache& cache, const ChartScene& scene,
+                         const ChartExportSettings& settings);
+    static bool write(GridCache& cache, const ChartScene& scene, const QString& filename,
+                      const ChartExportSettings& settings, QString& error);
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_CHARTEXPORTER_H
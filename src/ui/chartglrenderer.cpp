@@ -0,0 +1,183 @@
+/**
+ * @file chartglrenderer.cpp
+ * @brief OpenGL line renderer implementation
+ */
+
+#include "chartglrenderer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SmithTool {
+
+namespace {
+
+// Gamma plane to NDC: ndc = gamma * u_transform.xy + u_transform.zw
+const char* const VERTEX_SHADER =
+    "attribute highp vec2 a_gamma;\n"
+    "uniform highp vec4 u_transform;\n"
+    "void main() {\n"
+    "    gl_Position = vec4(a_gamma * u_transform.xy + u_transform.zw, 0.0, 1.0);\n"
+    "}\n";
+
+const char* const FRAGMENT_SHADER =
+    "uniform lowp vec4 u_color;\n"
+    "void main() {\n"
+    "    gl_FragColor = u_color;\n"
+    "}\n";
+
+constexpr double MAX_ARC_ERROR_PX = 0.25;
+constexpr int MIN_ARC_SEGMENTS = 8;
+constexpr int MAX_ARC_SEGMENTS = 1024;
+
+} // namespace
+
+void GlLineBuilder::addSegment(const Complex& a, const Complex& b)
+{
+    m_vertices.push_back(static_cast<float>(a.real()));
+    m_vertices.push_back(static_cast<float>(a.imag()));
+    m_vertices.push_back(static_cast<float>(b.real()));
+    m_vertices.push_back(static_cast<float>(b.imag()));
+}
+
+void GlLineBuilder::addArc(const GridArc& arc, double pixelRadius)
+{
+    if (arc.radius <= 0.0 || arc.spanAngle == 0.0) return;
+    
+    // Chord angle whose sagitta stays below MAX_ARC_ERROR_PX
+    const double radiusPx = arc.radius * pixelRadius;
+    double step = 2.0 * M_PI;
+    if (radiusPx > MAX_ARC_ERROR_PX) {
+        step = 2.0 * std::acos(1.0 - MAX_ARC_ERROR_PX / radiusPx);
+    }
+    int segments = static_cast<int>(std::ceil(std::abs(arc.spanAngle) / step));
+    segments = std::clamp(segments, MIN_ARC_SEGMENTS, MAX_ARC_SEGMENTS);
+    
+    m_vertices.reserve(m_vertices.size() + 4 * static_cast<std::size_t>(segments));
+    Complex previous = arc.startPoint();
+    for (int i = 1; i <= segments; ++i) {
+        Complex next = arc.pointAt(arc.startAngle + arc.spanAngle * i / segments);
+        addSegment(previous, next);
+        previous = next;
+    }
+}
+
+void GlLineBuilder::addPolyline(const Complex* points, std::size_t count)
+{
+    bool havePrevious = false;
+    Complex previous;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (std::norm(points[i]) > 1.0) continue;
+        if (havePrevious) {
+            addSegment(previous, points[i]);
+        }
+        previous = points[i];
+        havePrevious = true;
+    }
+}
+
+ChartGlRenderer::~ChartGlRenderer()
+{
+    for (auto& entry : m_batches) {
+        entry.second.buffer.destroy();
+    }
+}
+
+bool ChartGlRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+    
+    if (!m_program.addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER) ||
+        !m_program.addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER)) {
+        return false;
+    }
+    m_program.bindAttributeLocation("a_gamma", 0);
+    if (!m_program.link()) {
+        return false;
+    }
+    
+    m_vertexLocation = m_program.attributeLocation("a_gamma");
+    m_transformLocation = m_program.uniformLocation("u_transform");
+    m_colorLocation = m_program.uniformLocation("u_color");
+    m_initialized = true;
+    return true;
+}
+
+void ChartGlRenderer::beginFrame(const QSize& size, const QColor& background,
+                                 const QPointF& center, double radius, qreal devicePixelRatio)
+{
+    m_devicePixelRatio = devicePixelRatio;
+    glViewport(0, 0, qRound(size.width() * devicePixelRatio),
+               qRound(size.height() * devicePixelRatio));
+    glClearColor(background.redF(), background.greenF(), background.blueF(), 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (!m_initialized || size.isEmpty()) return;
+    
+    // Same mapping as SmithMath::gammaToScreen (screen y grows downwards)
+    const float w = static_cast<float>(size.width());
+    const float h = static_cast<float>(size.height());
+    m_program.bind();
+    m_program.setUniformValue(m_transformLocation,
+                              static_cast<float>(2.0 * radius / w),
+                              static_cast<float>(2.0 * radius / h),
+                              static_cast<float>(2.0 * center.x() / w - 1.0),
+                              static_cast<float>(1.0 - 2.0 * center.y() / h));
+    
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void ChartGlRenderer::upload(int id, const GlLineBuilder& lines)
+{
+    Batch& batch = m_batches[id];
+    if (!batch.buffer.isCreated()) {
+        batch.buffer = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+        batch.buffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+        if (!batch.buffer.create()) {
+            m_batches.erase(id);
+            return;
+        }
+    }
+    
+    batch.buffer.bind();
+    batch.buffer.allocate(lines.vertices().data(),
+                          static_cast<int>(lines.vertices().size() * sizeof(float)));
+    batch.buffer.release();
+    batch.vertexCount = lines.vertexCount();
+}
+
+void ChartGlRenderer::remove(int id)
+{
+    auto it = m_batches.find(id);
+    if (it == m_batches.end()) return;
+    it->second.buffer.destroy();
+    m_batches.erase(it);
+}
+
+void ChartGlRenderer::draw(int id, const QColor& color, float width)
+{
+    auto it = m_batches.find(id);
+    if (!m_initialized || it == m_batches.end() || it->second.vertexCount == 0) return;
+    
+    Batch& batch = it->second;
+    m_program.bind();
+    m_program.setUniformValue(m_colorLocation, color);
+    glLineWidth(width * static_cast<float>(m_devicePixelRatio));
+    
+    batch.buffer.bind();
+    m_program.enableAttributeArray(m_vertexLocation);
+    m_program.setAttributeBuffer(m_vertexLocation, GL_FLOAT, 0, 2);
+    glDrawArrays(GL_LINES, 0, batch.vertexCount);
+    m_program.disableAttributeArray(m_vertexLocation);
+    batch.buffer.release();
+}
+
+qint64 ChartGlRenderer::bufferBytes() const
+{
+    qint64 bytes = 0;
+    for (const auto& entry : m_batches) {
+        bytes += static_cast<qint64>(entry.second.vertexCount) * 2 * sizeof(float);
+    }
+    return bytes;
+}
+
+} // namespace SmithTool
@@ -0,0 +1,122 @@
+/**
+ * @file chartglrenderer.h
+ * @brief OpenGL line renderer for the Smith chart (SMITHTOOL_ENABLE_OPENGL)
+ *
+ * Grid lines and traces live in GPU vertex buffers in Gamma-plane
+ * coordinates; the chart center and radius are a single uniform, so pan
+ * and zoom re-draw the buffers without touching them.
+ */
+
+#ifndef SMITHTOOL_CHARTGLRENDERER_H
+#define SMITHTOOL_CHARTGLRENDERER_H
+
+#include <QColor>
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QPointF>
+#include <QSize>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+#include "../core/gridgeometry.h"
+
+namespace SmithTool {
+
+using Complex = std::complex<double>;
+
+/**
+ * @brief Collects line segments (GL_LINES vertex pairs) in the Gamma plane
+ */
+class GlLineBuilder {
+public:
+    void clear() { m_vertices.clear(); }
+    bool isEmpty() const { return m_vertices.empty(); }
+    int vertexCount() const { return static_cast<int>(m_vertices.size() / 2); }
+    const std::vector<float>& vertices() const { return m_vertices; }
+    
+    void addSegment(const Complex& a, const Complex& b);
+    
+    /**
+     * @brief Tessellate an arc
+     * @param pixelRadius Largest on-screen radius the arc will be drawn
+     *                    at; segments stay within a quarter pixel of it
+     */
+    void addArc(const GridArc& arc, double pixelRadius);
+    
+    /**
+     * @brief Add a trace; points outside the unit circle are skipped and
+     *        their neighbours joined, as on the raster path
+     */
+    void addPolyline(const Complex* points, std::size_t count);
+
+private:
+    std::vector<float> m_vertices;   // x, y per vertex
+};
+
+/**
+ * @brief Draws uploaded line batches with one transform per frame
+ *
+ * Must be created, used and destroyed with the chart's GL context
+ * current.
+ */
+class ChartGlRenderer : protected QOpenGLFunctions {
+public:
+    ChartGlRenderer() = default;
+    ~ChartGlRenderer();
+    
+    ChartGlRenderer(const ChartGlRenderer&) = delete;
+    ChartGlRenderer& operator=(const ChartGlRenderer&) = delete;
+    
+    /**
+     * @brief Compile the shaders
+     * @return false if the context cannot run them (use the raster path)
+     */
+    bool initialize();
+    
+    /**
+     * @brief Clear the frame and set the Gamma-to-screen transform
+     * @param size Widget size (logical pixels)
+     * @param center Chart center (logical pixels)
+     * @param radius Chart radius (logical pixels)
+     * @param devicePixelRatio Device pixels per logical pixel
+     */
+    void beginFrame(const QSize& size, const QColor& background,
+                    const QPointF& center, double radius, qreal devicePixelRatio);
+    
+    /**
+     * @brief Replace the vertices of a batch (created on first use)
+     */
+    void upload(int id, const GlLineBuilder& lines);
+    bool hasBatch(int id) const { return m_batches.count(id) > 0; }
+    void remove(int id);
+    
+    /**
+     * @brief Draw a batch with the current transform
+     * @param width Line width in logical pixels (clamped by the driver)
+     */
+    void draw(int id, const QColor& color, float width = 1.0f);
+    
+    // Bytes held in vertex buffers
+    qint64 bufferBytes() const;
+
+private:
+    struct Batch {
+        QOpenGLBuffer buffer;
+        int vertexCount = 0;
+    };
+    
+    QOpenGLShaderProgram m_program;
+    std::map<int, Batch> m_batches;
+    int m_vertexLocation = -1;
+    int m_transformLocation = -1;
+    int m_colorLocation = -1;
+    qreal m_devicePixelRatio = 1.0;
+    bool m_initialized = false;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_CHARTGLRENDERER_H
@@ -0,0 +1,343 @@
+/**
+ * @file chartrenderer.cpp
+ * @brief Widget-independent Smith chart drawing implementation
+ */
+
+#include "chartrenderer.h"
+#include "../core/decimation.h"
+#include "../core/gridgeometry.h"
+#include "../core/profiler.h"
+#include <QFont>
+#include <QPainterPath>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+namespace SmithTool {
+
+namespace {
+
+// Chart placement at zoom 1, centered in the output
+struct ChartGeometry {
+    QPointF center;
+    double radius;
+    
+    explicit ChartGeometry(const QSizeF& size)
+        : center(size.width() / 2.0, size.height() / 2.0)
+        , radius(std::max(0.0, (std::min(size.width(), size.height()) - 2 * ChartRenderer::MARGIN) / 2.0))
+    {}
+    
+    QPointF toScreen(const Complex& gamma) const
+    {
+        return SmithMath::gammaToScreen(gamma, center, radius);
+    }
+};
+
+QRectF circleRect(const QPointF& center, double radius)
+{
+    return QRectF(center.x() - radius, center.y() - radius, 2 * radius, 2 * radius);
+}
+
+// The widget's point sizes as pixels at 96 dpi, independent of the device
+QFont pixelFont(QFont font, double points)
+{
+    font.setPixelSize(std::max(1, qRound(points * 96.0 / 72.0)));
+    return font;
+}
+
+void addGridArc(QPainterPath& path, const ChartGeometry& chart, const GridArc& arc)
+{
+    // Gamma angles are counterclockwise with Im up, as Qt's arc angles on screen
+    QRectF rect = circleRect(chart.toScreen(arc.center), arc.radius * chart.radius);
+    if (arc.isFullCircle()) {
+        path.addEllipse(rect);
+        return;
+    }
+    const double startDeg = qRadiansToDegrees(arc.startAngle);
+    path.arcMoveTo(rect, startDeg);
+    path.arcTo(rect, startDeg, qRadiansToDegrees(arc.spanAngle));
+}
+
+void addGridArcs(QPainterPath& path, const ChartGeometry& chart, const std::vector<GridArc>& arcs)
+{
+    for (const GridArc& arc : arcs) {
+        addGridArc(path, chart, arc);
+    }
+}
+
+const std::vector<Complex>* plottedSParams(const ChartScene& scene, const SParamData* data)
+{
+    if (!data || data->isEmpty()) return nullptr;
+    
+    // Fall back to S11 if the selected Sij does not exist in this data
+    int row = scene.sparamRow;
+    int col = scene.sparamCol;
+    if (row >= data->numPorts() || col >= data->numPorts()) {
+        row = 0;
+        col = 0;
+    }
+    return &data->sData(row, col);
+}
+
+void drawTrace(QPainter& painter, const ChartGeometry& chart, const std::vector<Complex>& values,
+               const QColor& color, double width, double markerRadius, double pixelRatio)
+{
+    std::vector<QPointF> scratch;
+    std::vector<QPointF> polyline;
+    PolylineDecimator::gammaTrace(values.data(), values.size(), chart.center, chart.radius,
+                                  scratch, polyline, pixelRatio);
+    
+    painter.setPen(QPen(color, width));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawPolyline(polyline.data(), static_cast<int>(polyline.size()));
+    if (markerRadius <= 0.0) return;
+    
+    // Same frequency markers as the widget
+    painter.setBrush(color);
+    const std::size_t count = values.size();
+    for (std::size_t i = 0; i < count; i += count / 10 + 1) {
+        painter.drawEllipse(chart.toScreen(values[i]), markerRadius, markerRadius);
+    }
+}
+
+void drawMatchingTrace(QPainter& painter, const ChartGeometry& chart, const MatchingTrace& trace)
+{
+    painter.setFont(pixelFont(QFont("Arial"), 8));
+    
+    for (const TraceSegment& seg : trace.segments()) {
+        if (seg.isEmpty()) continue;
+        
+        // Constant R/X/G/B and line segments are exact arcs, which vector output keeps
+        QPainterPath path;
+        Complex arcCenter;
+        double arcRadius, startAngle, sweepAngle;
+        if (seg.arcGeometry(trace.z0(), arcCenter, arcRadius, startAngle, sweepAngle)) {
+            const QRectF rect = circleRect(chart.toScreen(arcCenter), arcRadius * chart.radius);
+            const double startDeg = qRadiansToDegrees(startAngle);
+            path.arcMoveTo(rect, startDeg);
+            path.arcTo(rect, startDeg, qRadiansToDegrees(sweepAngle));
+        } else {
+            bool first = true;
+            for (int k = 0; k < seg.points.size(); ++k) {
+                const Complex gamma = seg.points.gamma(k);
+                if (!SmithMath::isInsideUnitCircle(gamma)) continue;
+                if (first) {
+                    path.moveTo(chart.toScreen(gamma));
+                    first = false;
+                } else {
+                    path.lineTo(chart.toScreen(gamma));
+                }
+            }
+        }
+        
+        painter.setPen(QPen(seg.color, 2));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawPath(path);
+        
+        // Start point and label
+        painter.setBrush(seg.color);
+        painter.drawEllipse(chart.toScreen(seg.points.gamma(0)), 4, 4);
+        if (!seg.label.isEmpty()) {
+            const QPointF mid = chart.toScreen(seg.points.gamma(seg.points.size() / 2));
+            painter.drawText(mid + QPointF(5, -5), seg.label);
+        }
+    }
+}
+
+void drawImpedanceMarkers(QPainter& painter, const ChartGeometry& chart, const ChartScene& scene)
+{
+    painter.setFont(pixelFont(QFont("Arial", -1, QFont::Bold), 9));
+    
+    // Source: green square
+    if (scene.sourceVisible) {
+        Complex gammaS = SmithMath::impedanceToGamma(scene.sourceZ, scene.z0);
+        if (SmithMath::isInsideUnitCircle(gammaS)) {
+            QPointF pos = chart.toScreen(gammaS);
+            painter.setPen(QPen(QColor(0, 150, 0), 2));
+            painter.setBrush(QColor(0, 200, 0, 150));
+            painter.drawRect(QRectF(pos.x() - 6, pos.y() - 6, 12, 12));
+            painter.drawText(pos + QPointF(10, -5), "Zs");
+        }
+    }
+    
+    // Load: magenta triangle
+    if (scene.loadVisible) {
+        Complex gammaL = SmithMath::impedanceToGamma(scene.loadZ, scene.z0);
+        if (SmithMath::isInsideUnitCircle(gammaL)) {
+            QPointF pos = chart.toScreen(gammaL);
+            painter.setPen(QPen(QColor(180, 0, 180), 2));
+            painter.setBrush(QColor(220, 0, 220, 150));
+            QPolygonF triangle;
+            triangle << QPointF(pos.x(), pos.y() - 8)
+                     << QPointF(pos.x() - 7, pos.y() + 5)
+                     << QPointF(pos.x() + 7, pos.y() + 5);
+            painter.drawPolygon(triangle);
+            painter.drawText(pos + QPointF(10, -5), "Zl");
+        }
+    }
+}
+
+} // namespace
+
+bool ChartRenderer::GridKey::operator==(const GridKey& other) const
+{
+    return pixelSize == other.pixelSize
+        && scale == other.scale
+        && chartMode == other.chartMode
+        && showAdmittanceGrid == other.showAdmittanceGrid
+        && showVSWRCircles == other.showVSWRCircles
+        && showLabels == other.showLabels
+        && showQCircles == other.showQCircles
+        && vswrCircles == other.vswrCircles
+        && qValues == other.qValues;
+}
+
+ChartRenderer::GridKey ChartRenderer::gridKey(const ChartScene& scene, const QSize& pixelSize,
+                                              double scale)
+{
+    GridKey key;
+    key.pixelSize = pixelSize;
+    key.scale = scale;
+    key.chartMode = scene.chartMode;
+    key.showAdmittanceGrid = scene.showAdmittanceGrid;
+    key.showVSWRCircles = scene.showVSWRCircles;
+    key.showLabels = scene.showLabels;
+    key.showQCircles = scene.showQCircles;
+    key.vswrCircles = scene.vswrCircles;
+    key.qValues = scene.qValues;
+    return key;
+}
+
+void ChartRenderer::drawGrid(QPainter& painter, const ChartScene& scene, const QSizeF& size)
+{
+    SMITHTOOL_PROFILE_SCOPE("ChartRenderer::drawGrid");
+    const ChartGeometry chart(size);
+    
+    painter.fillRect(QRectF(QPointF(0, 0), size), QColor(255, 255, 255));
+    painter.setBrush(Qt::NoBrush);
+    
+    // Resistance circles and reactance arcs with the real axis
+    painter.setPen(QPen(QColor(100, 100, 100), 1));
+    painter.drawLine(QPointF(chart.center.x() - chart.radius, chart.center.y()),
+                     QPointF(chart.center.x() + chart.radius, chart.center.y()));
+    QPainterPath impedancePath;
+    addGridArcs(impedancePath, chart, GridGeometry::resistanceArcs());
+    addGridArcs(impedancePath, chart, GridGeometry::reactanceArcs());
+    painter.drawPath(impedancePath);
+    
+    if (scene.showAdmittanceGrid || scene.chartMode == ChartMode::Admittance ||
+        scene.chartMode == ChartMode::Combined) {
+        painter.setPen(QPen(QColor(150, 150, 200), 1, Qt::DashLine));
+        QPainterPath admittancePath;
+        addGridArcs(admittancePath, chart, GridGeometry::conductanceArcs());
+        painter.drawPath(admittancePath);
+    }
+    
+    painter.setPen(QPen(Qt::black, 2));
+    painter.drawEllipse(circleRect(chart.center, chart.radius));
+    
+    if (scene.showVSWRCircles) {
+        painter.setPen(QPen(QColor(200, 100, 100), 1, Qt::DotLine));
+        std::vector<double> vswrs = scene.vswrCircles;
+        if (vswrs.empty()) {
+            vswrs = {1.5, 2.0, 3.0};
+        }
+        for (double vswr : vswrs) {
+            painter.drawEllipse(circleRect(chart.center, SmithMath::vswrToGamma(vswr) * chart.radius));
+        }
+    }
+    
+    if (scene.showQCircles) {
+        painter.setPen(QPen(QColor(0, 150, 100), 1, Qt::DashDotLine));
+        QPainterPath path;
+        GridArc arc;
+        for (double q : scene.qValues) {
+            if (GridGeometry::qArc(q, true, arc)) addGridArc(path, chart, arc);
+            if (GridGeometry::qArc(q, false, arc)) addGridArc(path, chart, arc);
+        }
+        painter.drawPath(path);
+        
+        painter.setFont(pixelFont(QFont(), 7));
+        painter.setPen(QColor(0, 150, 100));
+        for (double q : scene.qValues) {
+            Complex labelGamma(0.5, 0.5 / q);
+            if (SmithMath::isInsideUnitCircle(labelGamma)) {
+                painter.drawText(chart.toScreen(labelGamma) + QPointF(5, -2),
+                                 QString("Q=%1").arg(q, 0, 'g', 2));
+            }
+        }
+    }
+    
+    if (scene.showLabels) {
+        painter.setFont(pixelFont(QFont(), 8));
+        painter.setPen(Qt::black);
+        for (double r : GridGeometry::resistanceValues()) {
+            QPointF pos = chart.toScreen(SmithMath::normalizedZToGamma(Complex(r, 0)));
+            pos.setY(pos.y() + 12);
+            painter.drawText(pos, r == 0 ? QString("0") : QString::number(r));
+        }
+        for (double x : GridGeometry::reactanceValues()) {
+            Complex gamma = SmithMath::normalizedZToGamma(Complex(0, x));
+            if (SmithMath::isInsideUnitCircle(gamma)) {
+                painter.drawText(chart.toScreen(gamma) + QPointF(5, -5), QString("+j%1").arg(x));
+            }
+            gamma = SmithMath::normalizedZToGamma(Complex(0, -x));
+            if (SmithMath::isInsideUnitCircle(gamma)) {
+                painter.drawText(chart.toScreen(gamma) + QPointF(5, 12), QString("-j%1").arg(x));
+            }
+        }
+    }
+}
+
+void ChartRenderer::drawContent(QPainter& painter, const ChartScene& scene, const QSizeF& size,
+                                double pixelRatio)
+{
+    SMITHTOOL_PROFILE_SCOPE("ChartRenderer::drawContent");
+    const ChartGeometry chart(size);
+    
+    for (const ChartScene::Overlay& overlay : scene.overlays) {
+        if (const std::vector<Complex>* values = plottedSParams(scene, overlay.data.get())) {
+            drawTrace(painter, chart, *values, overlay.color, 1, 0.0, pixelRatio);
+        }
+    }
+    if (const std::vector<Complex>* values = plottedSParams(scene, scene.data.get())) {
+        drawTrace(painter, chart, *values, Qt::blue, 2, 4.0, pixelRatio);
+    }
+    if (scene.sweep && !scene.sweep->isEmpty()) {
+        drawTrace(painter, chart, scene.sweep->gamma, QColor(230, 120, 0), 2, 3.0, pixelRatio);
+    }
+    if (scene.matchingTrace && scene.matchingTrace->numSegments() > 0) {
+        drawMatchingTrace(painter, chart, *scene.matchingTrace);
+    }
+    drawImpedanceMarkers(painter, chart, scene);
+    
+    if (scene.markerVisible) {
+        const QPointF pos = chart.toScreen(scene.markerGamma);
+        painter.setPen(QPen(Qt::red, 2));
+        painter.drawLine(pos + QPointF(-8, 0), pos + QPointF(8, 0));
+        painter.drawLine(pos + QPointF(0, -8), pos + QPointF(0, 8));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawEllipse(pos, 6, 6);
+    }
+    
+    if (!scene.title.isEmpty()) {
+        painter.setFont(pixelFont(QFont("Arial", -1, QFont::Bold), 10));
+        painter.setPen(Qt::black);
+        const double top = chart.center.y() - chart.radius;
+        painter.drawText(QRectF(0, 0, size.width(), top), Qt::AlignCenter, scene.title);
+    }
+}
+
+QImage ChartRenderer::renderGrid(const ChartScene& scene, const QSize& pixelSize, double scale)
+{
+    QImage image(pixelSize, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.scale(scale, scale);
+    drawGrid(painter, scene, QSizeF(pixelSize) / scale);
+    painter.end();
+    return image;
+}
+
+} // namespace SmithTool
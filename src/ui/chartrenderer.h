@@ -0,0 +1,136 @@
+/**
+ * @file chartrenderer.h
+ * @brief Widget-independent Smith chart drawing for offscreen output
+ */
+
+#ifndef SMITHTOOL_CHARTRENDERER_H
+#define SMITHTOOL_CHARTRENDERER_H
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QSize>
+#include <QSizeF>
+#include <QString>
+#include <memory>
+#include <vector>
+
+#include "../core/smithmath.h"
+#include "../core/trace.h"
+#include "../core/sweep.h"
+#include "../data/sparamdata.h"
+
+namespace SmithTool {
+
+/**
+ * @brief Display mode for Smith Chart
+ */
+enum class ChartMode {
+    Impedance,      // Z Smith Chart
+    Admittance,     // Y Smith Chart
+    Combined        // Both overlaid
+};
+
+/**
+ * @brief Everything needed to draw one chart, detached from any widget
+ *
+ * Data is shared, never copied; a scene must only reference objects that
+ * nobody edits while it is drawn (see SmithChartWidget::scene()).
+ */
+struct ChartScene {
+    double z0 = 50.0;
+    ChartMode chartMode = ChartMode::Impedance;
+    bool showAdmittanceGrid = false;
+    bool showVSWRCircles = true;
+    bool showLabels = true;
+    bool showQCircles = false;
+    std::vector<double> vswrCircles;            // Empty = 1.5, 2 and 3
+    std::vector<double> qValues{0.5, 1.0, 2.0, 5.0};
+    
+    // Plotted Sij of the main data and the overlays
+    std::shared_ptr<const SParamData> data;
+    int sparamRow = 0;
+    int sparamCol = 0;
+    struct Overlay {
+        std::shared_ptr<const SParamData> data;
+        QColor color;
+    };
+    std::vector<Overlay> overlays;
+    
+    std::shared_ptr<const SweepResult> sweep;
+    std::shared_ptr<const MatchingTrace> matchingTrace;     // Points already generated
+    
+    Complex sourceZ{50.0, 0.0};
+    Complex loadZ{50.0, 0.0};
+    bool sourceVisible = false;
+    bool loadVisible = false;
+    Complex markerGamma{0.0, 0.0};
+    bool markerVisible = false;
+    
+    QString title;      // Drawn above the chart if not empty
+};
+
+/**
+ * @brief Draws a ChartScene with QPainter on any paint device
+ *
+ * Colors, pens and label placement follow SmithChartWidget at zoom 1.
+ * Coordinates are logical pixels (1/96 inch): callers scale the painter
+ * to the device resolution, and fonts are sized in pixels so the output
+ * looks the same on raster images, SVG and PDF. All functions are
+ * reentrant and keep no state, so worker threads may draw several scenes
+ * at once (on QImage, QSvgGenerator or QPdfWriter, not QPixmap).
+ *
+ * The grid (everything that does not depend on data) is drawn separately
+ * so callers can render it once per size and draw only the content on
+ * copies of it.
+ */
+class ChartRenderer {
+public:
+    /**
+     * @brief Grid settings of a scene at one output size
+     *
+     * Equal keys give pixel-identical grid layers.
+     */
+    struct GridKey {
+        QSize pixelSize;
+        double scale = 1.0;
+        ChartMode chartMode = ChartMode::Impedance;
+        bool showAdmittanceGrid = false;
+        bool showVSWRCircles = true;
+        bool showLabels = true;
+        bool showQCircles = false;
+        std::vector<double> vswrCircles;
+        std::vector<double> qValues;
+        
+        bool operator==(const GridKey& other) const;
+        bool operator!=(const GridKey& other) const { return !(*this == other); }
+    };
+    static GridKey gridKey(const ChartScene& scene, const QSize& pixelSize, double scale);
+    
+    /**
+     * @brief Background, grid, circles and grid labels
+     * @param size Chart area in logical pixels
+     */
+    static void drawGrid(QPainter& painter, const ChartScene& scene, const QSizeF& size);
+    
+    /**
+     * @brief Traces, matching network, markers and title
+     * @param pixelRatio Device pixels per logical pixel, for trace decimation
+     */
+    static void drawContent(QPainter& painter, const ChartScene& scene, const QSizeF& size,
+                            double pixelRatio);
+    
+    /**
+     * @brief Grid layer as an opaque image
+     * @param pixelSize Image size in pixels
+     * @param scale Pixels per logical pixel (dpi / 96)
+     */
+    static QImage renderGrid(const ChartScene& scene, const QSize& pixelSize, double scale);
+    
+    // Chart margin around the unit circle, as in the widget
+    static constexpr double MARGIN = 40.0;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_CHARTRENDERER_H
@@ -5,7 +5,10 @@
 
 #include "circuitview.h"
 #include <QMouseEvent>
+#include <QPaintEvent>
 #include <QPainterPath>
+#include <QFontMetricsF>
+#include <algorithm>
 #include <cmath>
 
 namespace SmithTool {
@@ -18,6 +21,7 @@ CircuitView::CircuitView(QWidget* parent)
     , m_elementHeight(40)
     , m_spacing(20)
     , m_wireY(0)
+    , m_labelFont("Arial", 8)
 {
     setMinimumSize(300, 150);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
@@ -42,6 +46,7 @@ void CircuitView::addElement(ComponentType type, ConnectionType conn, double val
     elem.type = type;
     elem.connection = conn;
     elem.value = value;
+    elem.label = formatValue(type, value);
     elem.highlighted = false;
     m_elements.push_back(elem);
     updateLayout();
@@ -66,11 +71,15 @@ void CircuitView::clearElements()
 
 void CircuitView::updateElementValue(int index, double newValue)
 {
-    if (index >= 0 && index < static_cast<int>(m_elements.size())) {
-        m_elements[index].value = newValue;
-        m_elements[index].label = formatValue(m_elements[index].type, newValue);
-        update();
-    }
+    if (index < 0 || index >= static_cast<int>(m_elements.size())) return;
+    
+    // The symbol and every position stay put; only the label changes
+    CircuitElement& elem = m_elements[index];
+    const QRectF before = elem.labelBounds;
+    elem.value = newValue;
+    elem.label = formatValue(elem.type, newValue);
+    layoutLabel(elem);
+    update(before.united(elem.labelBounds).toAlignedRect());
 }
 
 void CircuitView::updateLayout()
@@ -81,8 +90,9 @@ void CircuitView::updateLayout()
     double availableWidth = width() - 120; // Reserve space for terminals
     double totalElements = static_cast<double>(m_elements.size());
     
-    m_elementWidth = std::min(60.0, (availableWidth - (totalElements - 1) * m_spacing) / totalElements);
-    m_wireY = height() / 2.0;
+    // Whole pixels, so cached symbols line up with the wires
+    m_elementWidth = std::floor(std::min(60.0, (availableWidth - (totalElements - 1) * m_spacing) / totalElements));
+    m_wireY = std::floor(height() / 2.0);
     
     double x = 60.0; // Start after source terminal
     
@@ -95,13 +105,96 @@ void CircuitView::updateLayout()
             elem.bounds = QRectF(x, m_wireY,
                                  m_elementWidth, m_elementHeight);
         }
+        layoutLabel(elem);
         x += m_elementWidth + m_spacing;
     }
 }
 
+void CircuitView::layoutLabel(CircuitElement& elem) const
+{
+    const QRectF& rect = elem.bounds;
+    QRectF box = (elem.connection == ConnectionType::Series)
+        ? rect.adjusted(0, -15, 0, 0)
+        : QRectF(rect.left() - 20, rect.center().y(), rect.width() + 40, 15);
+    
+    // Centered text wider than its box spills out on both sides
+    const double textWidth = QFontMetricsF(m_labelFont).horizontalAdvance(elem.label) + 2.0;
+    if (textWidth > box.width()) {
+        box.adjust(-(textWidth - box.width()) / 2, 0, (textWidth - box.width()) / 2, 0);
+    }
+    elem.labelBounds = box;
+}
+
+QRectF CircuitView::elementExtent(const CircuitElement& elem) const
+{
+    const double below = (elem.connection == ConnectionType::Shunt) ? GROUND_DEPTH : 0.0;
+    return elem.bounds.adjusted(-GLYPH_MARGIN, -GLYPH_MARGIN, GLYPH_MARGIN, GLYPH_MARGIN + below)
+               .united(elem.labelBounds);
+}
+
+const QPixmap& CircuitView::glyph(ComponentType type, bool vertical)
+{
+    const QSizeF size(m_elementWidth, m_elementHeight);
+    const qreal dpr = devicePixelRatioF();
+    for (const Glyph& cached : m_glyphs) {
+        if (cached.type == type && cached.vertical == vertical &&
+            cached.size == size && cached.devicePixelRatio == dpr) {
+            return cached.pixmap;
+        }
+    }
+    
+    // Sizes only change on resize or when elements are added or removed
+    if (m_glyphs.size() >= MAX_GLYPHS) {
+        m_glyphs.clear();
+    }
+    
+    const double below = vertical ? GROUND_DEPTH : 0.0;
+    const QSizeF canvas(size.width() + 2 * GLYPH_MARGIN, size.height() + 2 * GLYPH_MARGIN + below);
+    Glyph entry;
+    entry.type = type;
+    entry.vertical = vertical;
+    entry.size = size;
+    entry.devicePixelRatio = dpr;
+    entry.pixmap = QPixmap(QSize(static_cast<int>(std::ceil(canvas.width() * dpr)),
+                                 static_cast<int>(std::ceil(canvas.height() * dpr))));
+    entry.pixmap.setDevicePixelRatio(dpr);
+    entry.pixmap.fill(Qt::transparent);
+    
+    QPainter painter(&entry.pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const QRectF rect(QPointF(GLYPH_MARGIN, GLYPH_MARGIN), size);
+    switch (type) {
+        case ComponentType::Resistor:
+            drawResistor(painter, rect, vertical);
+            break;
+        case ComponentType::Capacitor:
+            drawCapacitor(painter, rect, vertical);
+            break;
+        case ComponentType::Inductor:
+            drawInductor(painter, rect, vertical);
+            break;
+        default:
+            break;
+    }
+    if (vertical) {
+        drawGround(painter, QPointF(rect.center().x(), rect.bottom()));
+    }
+    painter.end();
+    
+    m_glyphs.push_back(std::move(entry));
+    return m_glyphs.back().pixmap;
+}
+
+void CircuitView::drawGlyph(QPainter& painter, const CircuitElement& elem, bool vertical)
+{
+    painter.drawPixmap(elem.bounds.topLeft() - QPointF(GLYPH_MARGIN, GLYPH_MARGIN),
+                       glyph(elem.type, vertical));
+}
+
 void CircuitView::paintEvent(QPaintEvent* event)
 {
-    Q_UNUSED(event);
+    // Value updates repaint a single label; skip elements outside it
+    const QRectF dirty = event->rect();
     
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
@@ -113,7 +206,7 @@ void CircuitView::paintEvent(QPaintEvent* event)
     painter.setPen(QPen(Qt::gray, 1));
     painter.drawRect(rect().adjusted(0, 0, -1, -1));
     
-    m_wireY = height() / 2.0;
+    m_wireY = std::floor(height() / 2.0);
     
     // Draw source terminal
     QPointF sourcePos(30, m_wireY);
@@ -140,9 +233,13 @@ void CircuitView::paintEvent(QPaintEvent* event)
         for (size_t i = 0; i < m_elements.size(); ++i) {
             const auto& elem = m_elements[i];
             
+            const bool visible = elementExtent(elem).intersects(dirty);
+            
             if (elem.connection == ConnectionType::Series) {
                 // Draw series element
-                drawSeriesElement(painter, elem);
+                if (visible) {
+                    drawSeriesElement(painter, elem);
+                }
                 
                 // Wire to next element or load
                 QPointF elemEnd(elem.bounds.right(), m_wireY);
@@ -155,7 +252,9 @@ void CircuitView::paintEvent(QPaintEvent* event)
                 drawWire(painter, elemEnd, nextStart);
             } else {
                 // Draw shunt element
-                drawShuntElement(painter, elem);
+                if (visible) {
+                    drawShuntElement(painter, elem);
+                }
                 
                 // Wire passes through
                 QPointF wireStart(elem.bounds.left(), m_wireY);
@@ -186,25 +285,12 @@ void CircuitView::drawSeriesElement(QPainter& painter, const CircuitElement& ele
         painter.fillRect(rect.adjusted(-2, -2, 2, 2), QColor(255, 255, 200));
     }
     
-    switch (elem.type) {
-        case ComponentType::Resistor:
-            drawResistor(painter, rect, false);
-            break;
-        case ComponentType::Capacitor:
-            drawCapacitor(painter, rect, false);
-            break;
-        case ComponentType::Inductor:
-            drawInductor(painter, rect, false);
-            break;
-        default:
-            break;
-    }
+    drawGlyph(painter, elem, false);
     
     // Draw value label
     painter.setPen(Qt::black);
-    painter.setFont(QFont("Arial", 8));
-    QString label = formatValue(elem.type, elem.value);
-    painter.drawText(rect.adjusted(0, -15, 0, 0), Qt::AlignCenter, label);
+    painter.setFont(m_labelFont);
+    painter.drawText(elem.labelBounds, Qt::AlignCenter, elem.label);
 }
 
 void CircuitView::drawShuntElement(QPainter& painter, const CircuitElement& elem)
@@ -222,30 +308,13 @@ void CircuitView::drawShuntElement(QPainter& painter, const CircuitElement& elem
     painter.setPen(QPen(Qt::black, 2));
     painter.drawLine(topWire, elemTop);
     
-    switch (elem.type) {
-        case ComponentType::Resistor:
-            drawResistor(painter, rect, true);
-            break;
-        case ComponentType::Capacitor:
-            drawCapacitor(painter, rect, true);
-            break;
-        case ComponentType::Inductor:
-            drawInductor(painter, rect, true);
-            break;
-        default:
-            break;
-    }
-    
-    // Draw ground
-    QPointF groundPos(rect.center().x(), rect.bottom());
-    drawGround(painter, groundPos);
+    // Symbol and ground
+    drawGlyph(painter, elem, true);
     
     // Draw value label
     painter.setPen(Qt::black);
-    painter.setFont(QFont("Arial", 8));
-    QString label = formatValue(elem.type, elem.value);
-    painter.drawText(QRectF(rect.left() - 20, rect.center().y(), 
-                           rect.width() + 40, 15), Qt::AlignCenter, label);
+    painter.setFont(m_labelFont);
+    painter.drawText(elem.labelBounds, Qt::AlignCenter, elem.label);
 }
 
 void CircuitView::drawWire(QPainter& painter, const QPointF& from, const QPointF& to)
@@ -431,7 +500,13 @@ QString CircuitView::formatValue(ComponentType type, double value) const
             else if (absVal >= 1e-12) { scaled = value * 1e12; prefix = "p"; }
             else { scaled = value * 1e15; prefix = "f"; }
             return QString("%1 %2F").arg(scaled, 0, 'g', 3).arg(prefix);
-            
+        
+        case ComponentType::TransmissionLine:
+        case ComponentType::OpenStub:
+        case ComponentType::ShortStub:
+            // Lines and stubs are valued by length
+            return QString("%1 mm").arg(value * 1e3, 0, 'f', 2);
+        
         default:
             return QString::number(value);
     }
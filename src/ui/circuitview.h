@@ -8,6 +8,8 @@
 
 #include <QWidget>
 #include <QPainter>
+#include <QPixmap>
+#include <QFont>
 #include <vector>
 #include "../core/component.h"
 #include "../core/trace.h"
@@ -23,6 +25,7 @@ struct CircuitElement {
     double value;
     QString label;
     QRectF bounds;
+    QRectF labelBounds;     // Painted extent of the value label
     bool highlighted;
     
     CircuitElement()
@@ -35,6 +38,11 @@ struct CircuitElement {
 
 /**
  * @brief Widget displaying the matching network schematic
+ *
+ * Symbols are drawn from pixmaps rendered once per type, orientation,
+ * element size and device pixel ratio. Element positions do not depend
+ * on their values, so a value change (e.g. during a drag) only re-measures
+ * that element's label and repaints the label's area.
  */
 class CircuitView : public QWidget {
     Q_OBJECT
@@ -77,6 +85,10 @@ private:
     void drawTerminal(QPainter& painter, const QPointF& pos, const QString& label);
     void drawSeriesElement(QPainter& painter, const CircuitElement& elem);
     void drawShuntElement(QPainter& painter, const CircuitElement& elem);
+    void drawGlyph(QPainter& painter, const CircuitElement& elem, bool vertical);
+    const QPixmap& glyph(ComponentType type, bool vertical);
+    void layoutLabel(CircuitElement& elem) const;
+    QRectF elementExtent(const CircuitElement& elem) const;
     
     QString formatValue(ComponentType type, double value) const;
     QString formatImpedanceLabel(const std::complex<double>& z, const QString& name) const;
@@ -91,6 +103,21 @@ private:
     double m_elementHeight;
     double m_spacing;
     double m_wireY;
+    
+    // Pre-rendered symbols; stale sizes are dropped when the cache fills
+    struct Glyph {
+        ComponentType type;
+        bool vertical;
+        QSizeF size;
+        qreal devicePixelRatio;
+        QPixmap pixmap;
+    };
+    std::vector<Glyph> m_glyphs;
+    QFont m_labelFont;
+    
+    static constexpr double GLYPH_MARGIN = 4.0;     // Pen overhang around the bounds
+    static constexpr double GROUND_DEPTH = 10.0;    // Ground symbol below shunt elements
+    static constexpr std::size_t MAX_GLYPHS = 24;
 };
 
 } // namespace SmithTool
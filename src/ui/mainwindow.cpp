@@ -5,24 +5,71 @@
 
 #include "mainwindow.h"
 #include "componenteditdialog.h"
+#include "../core/matchingcache.h"
+#include "../core/networkoptimizer.h"
+#include "../core/profiler.h"
+#include "../core/startuptimer.h"
 #include <QMessageBox>
 #include <QApplication>
 #include <QStyle>
 #include <QScreen>
 #include <QInputDialog>
+#include <QActionGroup>
+#include <QDragEnterEvent>
+#include <QDir>
+#include <QDropEvent>
+#include <QMimeData>
+#include <QSignalBlocker>
+#include <QTimer>
+#include <QUrl>
+#include <QRegularExpression>
+#include <QtConcurrent>
 
 namespace SmithTool {
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent)
+    , m_tdrDock(nullptr)
+    , m_tdrPanel(nullptr)
+    , m_twoPortDock(nullptr)
+    , m_twoPortPanel(nullptr)
+    , m_bandDock(nullptr)
+    , m_bandPanel(nullptr)
+    , m_matchingWizard(nullptr)
+    , m_componentEditDialog(nullptr)
+    , m_matchingTrace(std::make_shared<MatchingTrace>())
     , m_sourceZ(50.0, 0.0)
     , m_loadZ(50.0, 0.0)
+    , m_sweepStart(0.0)
+    , m_sweepStop(0.0)
+    , m_sweepPoints(2001)
+    , m_currentData(std::make_shared<SParamData>())
+    , m_loader(new TouchstoneLoader(this))
+    , m_liveSource(new LiveSweepSource(this))
+    , m_liveShown(0)
+    , m_overlayPorts(1)
+    , m_envelopeWatcher(new EnvelopeWatcher(this))
+    , m_envelopePending(false)
+    , m_monteCarloWatcher(new MonteCarloWatcher(this))
+    , m_networkRevision(0)
+    , m_monteCarloRevision(0)
+    , m_reportWatcher(new ReportWatcher(this))
 {
+    setAcceptDrops(true);
+    
     setupUI();
+    StartupTimer::mark("MainWindow::setupUI");
     setupMenus();
     setupToolbar();
     setupStatusBar();
+    StartupTimer::mark("MainWindow::setupMenus");
     connectSignals();
+    StartupTimer::mark("MainWindow::connectSignals");
+    
+    // The first chart paint ends the startup timing
+    if (!StartupTimer::isFinished()) {
+        m_smithChart->installEventFilter(this);
+    }
     
     setWindowTitle(tr("SmithTool - Interactive Smith Chart"));
     resize(1200, 800);
@@ -71,6 +118,8 @@ void MainWindow::setupUI()
     m_impedanceDock->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
     addDockWidget(Qt::RightDockWidgetArea, m_impedanceDock);
     
+    // The TDR, two-port and band docks are built on first use
+    
     // Element toolbar
     m_elementToolbar = new ElementToolbar(this);
     addToolBar(Qt::TopToolBarArea, m_elementToolbar);
@@ -91,24 +140,69 @@ void MainWindow::setupMenus()
     m_saveAction->setIcon(style()->standardIcon(QStyle::SP_DialogSaveButton));
     fileMenu->addAction(m_saveAction);
     
+    m_lowMemoryAction = new QAction(tr("&Low-Memory Loading"), this);
+    m_lowMemoryAction->setCheckable(true);
+    m_lowMemoryAction->setChecked(false);
+    m_lowMemoryAction->setToolTip(tr("Keep huge files in single precision while streaming them in"));
+    fileMenu->addAction(m_lowMemoryAction);
+    
+    fileMenu->addSeparator();
+    
+    m_openProjectAction = new QAction(tr("Open &Project..."), this);
+    m_openProjectAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_O));
+    fileMenu->addAction(m_openProjectAction);
+    
+    m_saveProjectAction = new QAction(tr("Save P&roject..."), this);
+    m_saveProjectAction->setShortcut(QKeySequence::Save);
+    m_saveProjectAction->setToolTip(tr("Save the network, display settings and loaded data in one file"));
+    fileMenu->addAction(m_saveProjectAction);
+    
     fileMenu->addSeparator();
     
     m_exportAction = new QAction(tr("&Export Image..."), this);
     m_exportAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_E));
+    m_exportAction->setToolTip(tr("Write the whole chart as PNG, JPEG, SVG or PDF at 300 dpi"));
     fileMenu->addAction(m_exportAction);
     
+    m_exportReportAction = new QAction(tr("Export &Report Images..."), this);
+    m_exportReportAction->setToolTip(tr("Render one chart image per Touchstone file in the background"));
+    fileMenu->addAction(m_exportReportAction);
+    
     m_exportSpiceAction = new QAction(tr("Export &SPICE Netlist..."), this);
     m_exportSpiceAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_S));
     fileMenu->addAction(m_exportSpiceAction);
     
+    m_exportSpiceCornersAction = new QAction(tr("Export SPICE &Corners..."), this);
+    m_exportSpiceCornersAction->setToolTip(
+        tr("Write every tolerance corner of the network as a .lib or a netlist directory"));
+    fileMenu->addAction(m_exportSpiceCornersAction);
+    
+    m_exportSweepAction = new QAction(tr("Export S&weep as S1P..."), this);
+    m_exportSweepAction->setToolTip(tr("Write the input reflection of the shown sweep"));
+    fileMenu->addAction(m_exportSweepAction);
+    
     fileMenu->addSeparator();
     
     m_exitAction = new QAction(tr("E&xit"), this);
     m_exitAction->setShortcut(QKeySequence::Quit);
     fileMenu->addAction(m_exitAction);
     
+    // Edit menu
+    QMenu* editMenu = menuBar()->addMenu(tr("&Edit"));
+    
+    m_undoAction = new QAction(tr("&Undo"), this);
+    m_undoAction->setShortcut(QKeySequence::Undo);
+    m_undoAction->setEnabled(false);
+    editMenu->addAction(m_undoAction);
+    
+    m_redoAction = new QAction(tr("&Redo"), this);
+    m_redoAction->setShortcut(QKeySequence::Redo);
+    m_redoAction->setEnabled(false);
+    editMenu->addAction(m_redoAction);
+    
     // View menu
     QMenu* viewMenu = menuBar()->addMenu(tr("&View"));
+    m_viewMenu = viewMenu;
     
     m_admittanceAction = new QAction(tr("Show &Admittance Grid"), this);
     m_admittanceAction->setCheckable(true);
@@ -133,10 +227,51 @@ void MainWindow::setupMenus()
     m_configureQCirclesAction = new QAction(tr("Configure Q &Values..."), this);
     viewMenu->addAction(m_configureQCirclesAction);
     
+    viewMenu->addSeparator();
+    m_sparamTraceMenu = viewMenu->addMenu(tr("S-&Parameter Trace"));
+    m_sparamTraceGroup = new QActionGroup(this);
+    m_sparamTraceGroup->setExclusive(true);
+    rebuildSParamTraceMenu();
+    
+    m_clearOverlaysAction = new QAction(tr("Clear &Overlays"), this);
+    m_clearOverlaysAction->setEnabled(false);
+    viewMenu->addAction(m_clearOverlaysAction);
+    
+    m_envelopeAction = new QAction(tr("Lot &Envelope"), this);
+    m_envelopeAction->setCheckable(true);
+    m_envelopeAction->setChecked(false);
+    m_envelopeAction->setEnabled(false);
+    viewMenu->addAction(m_envelopeAction);
+    
+    m_hudAction = new QAction(tr("Performance &HUD"), this);
+    m_hudAction->setCheckable(true);
+    m_hudAction->setChecked(false);
+    m_hudAction->setShortcut(QKeySequence(Qt::Key_F12));
+    viewMenu->addAction(m_hudAction);
+    
+    // Only when built with SMITHTOOL_ENABLE_OPENGL
+    m_gpuRenderingAction = new QAction(tr("&GPU Rendering"), this);
+    m_gpuRenderingAction->setCheckable(true);
+    m_gpuRenderingAction->setEnabled(SmithChartWidget::isGpuRenderingAvailable());
+    m_gpuRenderingAction->setChecked(m_smithChart->gpuRendering());
+    viewMenu->addAction(m_gpuRenderingAction);
+    
     viewMenu->addSeparator();
     viewMenu->addAction(m_componentDock->toggleViewAction());
     viewMenu->addAction(m_impedanceDock->toggleViewAction());
     
+    // Replaced by the dock's own toggle action once the dock exists
+    m_tdrAction = new QAction(tr("Time Domain (TDR)"), this);
+    m_tdrAction->setCheckable(true);
+    m_tdrAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_T));
+    viewMenu->addAction(m_tdrAction);
+    m_twoPortAction = new QAction(tr("Two-Port Stability"), this);
+    m_twoPortAction->setCheckable(true);
+    viewMenu->addAction(m_twoPortAction);
+    m_bandAction = new QAction(tr("Band Analysis"), this);
+    m_bandAction->setCheckable(true);
+    viewMenu->addAction(m_bandAction);
+    
     // Tools menu
     QMenu* toolsMenu = menuBar()->addMenu(tr("&Tools"));
     
@@ -144,6 +279,62 @@ void MainWindow::setupMenus()
     m_matchingWizardAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_M));
     toolsMenu->addAction(m_matchingWizardAction);
     
+    m_optimizeAction = new QAction(tr("&Optimize Network..."), this);
+    m_optimizeAction->setToolTip(tr("Tune all element values for the best match over a band"));
+    toolsMenu->addAction(m_optimizeAction);
+    
+    m_monteCarloAction = new QAction(tr("Monte Carlo &Yield..."), this);
+    m_monteCarloAction->setToolTip(tr("Yield of the network over a band with toleranced parts"));
+    toolsMenu->addAction(m_monteCarloAction);
+    
+    m_simulateAction = new QAction(tr("Simulate &S-Parameters"), this);
+    m_simulateAction->setToolTip(tr("Solve the network over the sweep band and overlay its S-parameters"));
+    toolsMenu->addAction(m_simulateAction);
+    
+    toolsMenu->addSeparator();
+    m_deembedAction = new QAction(tr("&De-embed Fixtures..."), this);
+    m_deembedAction->setToolTip(tr("Remove measured test fixtures (.s2p) from the data"));
+    toolsMenu->addAction(m_deembedAction);
+    
+    m_portExtensionAction = new QAction(tr("&Port Extension..."), this);
+    m_portExtensionAction->setToolTip(tr("Move the reference planes by an electrical delay"));
+    toolsMenu->addAction(m_portExtensionAction);
+    
+    m_renormalizeAction = new QAction(tr("Re&normalize..."), this);
+    m_renormalizeAction->setToolTip(tr("Convert the data to another reference impedance"));
+    toolsMenu->addAction(m_renormalizeAction);
+    
+    toolsMenu->addSeparator();
+    m_sweepAction = new QAction(tr("Show Frequency &Sweep"), this);
+    m_sweepAction->setCheckable(true);
+    m_sweepAction->setChecked(false);
+    toolsMenu->addAction(m_sweepAction);
+    
+    m_configureSweepAction = new QAction(tr("Configure Sweep &Range..."), this);
+    toolsMenu->addAction(m_configureSweepAction);
+    
+    m_measuredLoadAction = new QAction(tr("Use Measured S11 as &Load"), this);
+    m_measuredLoadAction->setCheckable(true);
+    m_measuredLoadAction->setChecked(false);
+    m_measuredLoadAction->setEnabled(false);
+    toolsMenu->addAction(m_measuredLoadAction);
+    
+    m_liveAction = new QAction(tr("&Live VNA Input..."), this);
+    m_liveAction->setCheckable(true);
+    m_liveAction->setChecked(false);
+    m_liveAction->setToolTip(tr("Draw sweeps streamed from a network analyzer over TCP"));
+    toolsMenu->addAction(m_liveAction);
+    
+    toolsMenu->addSeparator();
+    m_profileAction = new QAction(tr("&Record Profile"), this);
+    m_profileAction->setCheckable(true);
+    m_profileAction->setChecked(false);
+    m_profileAction->setToolTip(tr("Time painting, parsing and matching hot paths"));
+    toolsMenu->addAction(m_profileAction);
+    
+    m_exportTraceAction = new QAction(tr("Export Profile &Trace..."), this);
+    toolsMenu->addAction(m_exportTraceAction);
+    
     // Help menu
     QMenu* helpMenu = menuBar()->addMenu(tr("&Help"));
     
@@ -163,6 +354,17 @@ void MainWindow::setupToolbar()
 void MainWindow::setupStatusBar()
 {
     statusBar()->showMessage(tr("Ready"));
+    
+    // Shown only while files load in the background
+    m_loadProgress = new QProgressBar(this);
+    m_loadProgress->setRange(0, 100);
+    m_loadProgress->setMaximumWidth(160);
+    m_loadProgress->hide();
+    statusBar()->addPermanentWidget(m_loadProgress);
+    
+    m_cancelLoadButton = new QPushButton(tr("Cancel"), this);
+    m_cancelLoadButton->hide();
+    statusBar()->addPermanentWidget(m_cancelLoadButton);
 }
 
 void MainWindow::connectSignals()
@@ -170,8 +372,33 @@ void MainWindow::connectSignals()
     // File actions
     connect(m_openAction, &QAction::triggered, this, &MainWindow::onOpenFile);
     connect(m_saveAction, &QAction::triggered, this, &MainWindow::onSaveFile);
+    connect(m_openProjectAction, &QAction::triggered, this, &MainWindow::onOpenProject);
+    connect(m_saveProjectAction, &QAction::triggered, this, &MainWindow::onSaveProject);
     connect(m_exportAction, &QAction::triggered, this, &MainWindow::onExportImage);
+    connect(m_exportReportAction, &QAction::triggered, this, &MainWindow::onExportReportImages);
+    connect(m_reportWatcher, &ReportWatcher::finished, this, &MainWindow::onReportExportFinished);
+    connect(m_reportWatcher, &ReportWatcher::progressValueChanged, this, [this](int done) {
+        statusBar()->showMessage(tr("Exporting report images: %1 of %2")
+            .arg(done)
+            .arg(m_reportWatcher->progressMaximum()));
+    });
     connect(m_exportSpiceAction, &QAction::triggered, this, &MainWindow::onExportSpice);
+    connect(m_exportSpiceCornersAction, &QAction::triggered, this, &MainWindow::onExportSpiceCorners);
+    connect(m_exportSweepAction, &QAction::triggered, this, &MainWindow::onExportSweep);
+    
+    // The first toggle builds the dock
+    connect(m_tdrAction, &QAction::triggered, this, [this]() { tdrDock()->show(); });
+    connect(m_twoPortAction, &QAction::triggered, this, [this]() { twoPortDock()->show(); });
+    connect(m_bandAction, &QAction::triggered, this, [this]() { bandDock()->show(); });
+    
+    // Background loading
+    connect(m_loader, &TouchstoneLoader::fileLoaded, this, &MainWindow::onFileLoaded);
+    connect(m_loader, &TouchstoneLoader::partialDataAvailable, this, &MainWindow::onPartialDataLoaded);
+    connect(m_lowMemoryAction, &QAction::toggled, this, &MainWindow::onToggleLowMemoryLoading);
+    connect(m_loader, &TouchstoneLoader::fileFailed, this, &MainWindow::onFileLoadFailed);
+    connect(m_loader, &TouchstoneLoader::progressChanged, this, &MainWindow::onLoadProgress);
+    connect(m_loader, &TouchstoneLoader::finished, this, &MainWindow::onLoadingFinished);
+    connect(m_cancelLoadButton, &QPushButton::clicked, m_loader, &TouchstoneLoader::cancel);
     connect(m_exitAction, &QAction::triggered, qApp, &QApplication::quit);
     
     // View actions
@@ -180,6 +407,10 @@ void MainWindow::connectSignals()
     connect(m_labelsAction, &QAction::toggled, this, &MainWindow::onToggleLabels);
     connect(m_qCirclesAction, &QAction::toggled, this, &MainWindow::onToggleQCircles);
     connect(m_configureQCirclesAction, &QAction::triggered, this, &MainWindow::onConfigureQCircles);
+    connect(m_sparamTraceGroup, &QActionGroup::triggered, this, &MainWindow::onSelectSParamTrace);
+    connect(m_clearOverlaysAction, &QAction::triggered, this, &MainWindow::onClearOverlays);
+    connect(m_envelopeAction, &QAction::toggled, this, &MainWindow::onToggleEnvelope);
+    connect(m_envelopeWatcher, &EnvelopeWatcher::finished, this, &MainWindow::onEnvelopeFinished);
     
     // Help actions
     connect(m_aboutAction, &QAction::triggered, this, &MainWindow::onAbout);
@@ -212,6 +443,8 @@ void MainWindow::connectSignals()
             this, &MainWindow::onRemoveLastElement);
     connect(m_elementToolbar, &ElementToolbar::clearAllElements, 
             this, &MainWindow::onClearElements);
+    connect(m_undoAction, &QAction::triggered, this, &MainWindow::onUndo);
+    connect(m_redoAction, &QAction::triggered, this, &MainWindow::onRedo);
     
     // Impedance panel signals
     connect(m_impedancePanel, &ImpedanceInputPanel::sourceImpedanceChanged,
@@ -220,8 +453,29 @@ void MainWindow::connectSignals()
             this, &MainWindow::onLoadImpedanceChanged);
     
     // Matching wizard
+    connect(m_sweepAction, &QAction::toggled, this, &MainWindow::onToggleSweep);
+    connect(m_configureSweepAction, &QAction::triggered, this, &MainWindow::onConfigureSweep);
+    connect(m_measuredLoadAction, &QAction::toggled, this, &MainWindow::onToggleMeasuredLoad);
+    connect(m_liveAction, &QAction::toggled, this, &MainWindow::onToggleLiveInput);
+    connect(m_liveSource, &LiveSweepSource::sweepAvailable, this, &MainWindow::onLiveSweep);
+    connect(m_liveSource, &LiveSweepSource::failed, this, &MainWindow::onLiveFailed);
     connect(m_matchingWizardAction, &QAction::triggered, 
             this, &MainWindow::onOpenMatchingWizard);
+    connect(m_optimizeAction, &QAction::triggered, this, &MainWindow::onOptimizeNetwork);
+    connect(m_monteCarloAction, &QAction::triggered, this, &MainWindow::onMonteCarloYield);
+    connect(m_simulateAction, &QAction::triggered, this, &MainWindow::onSimulateSParams);
+    connect(m_deembedAction, &QAction::triggered, this, &MainWindow::onDeembedFixtures);
+    connect(m_portExtensionAction, &QAction::triggered, this, &MainWindow::onPortExtension);
+    connect(m_renormalizeAction, &QAction::triggered, this, &MainWindow::onRenormalize);
+    connect(m_monteCarloWatcher, &MonteCarloWatcher::finished,
+            this, &MainWindow::onMonteCarloFinished);
+    
+    // Instrumentation
+    connect(m_hudAction, &QAction::toggled, m_smithChart, &SmithChartWidget::setHudVisible);
+    connect(m_gpuRenderingAction, &QAction::toggled,
+            m_smithChart, &SmithChartWidget::setGpuRendering);
+    connect(m_profileAction, &QAction::toggled, this, &MainWindow::onToggleProfiling);
+    connect(m_exportTraceAction, &QAction::triggered, this, &MainWindow::onExportProfileTrace);
     
     // Target point selection for adding elements
     connect(m_smithChart, &SmithChartWidget::targetPointSelected,
@@ -255,21 +509,21 @@ void MainWindow::connectSignals()
 
 void MainWindow::onOpenFile()
 {
-    QString filename = QFileDialog::getOpenFileName(
+    QStringList filenames = QFileDialog::getOpenFileNames(
         this,
         tr("Open Touchstone File"),
         QString(),
-        tr("Touchstone Files (*.s1p *.s2p);;All Files (*)")
+        tr("Touchstone Files (*.s*p *.smtsp);;All Files (*)")
     );
     
-    if (!filename.isEmpty()) {
-        loadTouchstoneFile(filename);
+    if (!filenames.isEmpty()) {
+        loadTouchstoneFiles(filenames);
     }
 }
 
 void MainWindow::onSaveFile()
 {
-    if (m_currentData.isEmpty()) {
+    if (m_currentData->isEmpty()) {
         QMessageBox::warning(this, tr("Warning"), 
                             tr("No data to save."));
         return;
@@ -279,32 +533,326 @@ void MainWindow::onSaveFile()
         this,
         tr("Save Touchstone File"),
         QString(),
-        tr("Touchstone 1-Port (*.s1p);;Touchstone 2-Port (*.s2p)")
+        tr("Touchstone %1-Port (*.s%1p);;SmithTool Binary (*.%2)")
+            .arg(m_currentData->numPorts()).arg(SParamCache::FILE_SUFFIX)
     );
     
     if (!filename.isEmpty()) {
         TouchstoneWriter writer;
-        if (!writer.write(filename, m_currentData)) {
+        bool binary = filename.endsWith(QString(".") + SParamCache::FILE_SUFFIX, Qt::CaseInsensitive);
+        bool ok = binary ? writer.writeBinary(filename, *m_currentData)
+                         : writer.write(filename, *m_currentData);
+        if (!ok) {
             QMessageBox::critical(this, tr("Error"),
                                  tr("Failed to save file: %1").arg(writer.lastError()));
         }
     }
 }
 
+void MainWindow::onOpenProject()
+{
+    QString filename = QFileDialog::getOpenFileName(
+        this,
+        tr("Open Project"),
+        QString(),
+        tr("SmithTool Project (*.%1);;All Files (*)").arg(ProjectFile::FILE_SUFFIX)
+    );
+    
+    if (!filename.isEmpty()) {
+        openProject(filename);
+    }
+}
+
+void MainWindow::onSaveProject()
+{
+    QString filename = QFileDialog::getSaveFileName(
+        this,
+        tr("Save Project"),
+        QString(),
+        tr("SmithTool Project (*.%1)").arg(ProjectFile::FILE_SUFFIX)
+    );
+    if (filename.isEmpty()) return;
+    
+    ProjectState state;
+    state.sourceZ = m_sourceZ;
+    state.loadZ = m_loadZ;
+    state.z0 = m_componentPanel->z0();
+    state.frequency = m_componentPanel->frequency();
+    state.elements = EditHistory::elementsOf(*m_matchingTrace);
+    state.settings = projectSettings();
+    
+    if (!m_currentData->isEmpty()) {
+        ProjectDataset current;
+        current.name = m_currentFile;
+        current.role = ProjectDataset::Role::Current;
+        current.data = m_currentData;
+        state.datasets.push_back(current);
+    }
+    for (int i = 0; i < m_smithChart->sparamOverlayCount(); ++i) {
+        // Overlays of an opened project that were never drawn load here
+        std::shared_ptr<const SParamData> data = m_smithChart->sparamOverlayData(i);
+        if (!data) continue;
+        
+        ProjectDataset overlay;
+        overlay.name = data->filename();
+        overlay.color = m_smithChart->sparamOverlayColor(i);
+        overlay.visible = m_smithChart->isSParamOverlayVisible(i);
+        overlay.data = std::move(data);
+        state.datasets.push_back(std::move(overlay));
+    }
+    
+    QString error;
+    if (!ProjectFile::write(filename, state, error)) {
+        QMessageBox::critical(this, tr("Error"), tr("Failed to save project: %1").arg(error));
+        return;
+    }
+    statusBar()->showMessage(tr("Project saved: %1").arg(filename), 5000);
+}
+
+void MainWindow::openProject(const QString& filename)
+{
+    QElapsedTimer clock;
+    clock.start();
+    
+    // Shared with the overlay loaders, which keep the file mapped
+    auto project = std::make_shared<ProjectFile>();
+    QString error;
+    if (!project->open(filename, error)) {
+        QMessageBox::critical(this, tr("Error"), tr("Failed to open project: %1").arg(error));
+        return;
+    }
+    const ProjectState& state = project->state();
+    
+    // Panels are set silently; the trace is rebuilt once below
+    {
+        const QSignalBlocker impedanceBlocker(m_impedancePanel);
+        const QSignalBlocker componentBlocker(m_componentPanel);
+        m_impedancePanel->setSourceImpedance(state.sourceZ);
+        m_impedancePanel->setLoadImpedance(state.loadZ);
+        m_impedancePanel->setZ0(state.z0);
+        m_componentPanel->setFrequency(state.frequency);
+        m_componentPanel->setZ0(state.z0);
+    }
+    m_smithChart->setFrequency(state.frequency);
+    m_smithChart->setZ0(state.z0);
+    
+    m_sourceZ = state.sourceZ;
+    m_loadZ = state.loadZ;
+    m_measuredLoadZ.clear();
+    m_matchingTrace->setSourceImpedance(m_sourceZ);
+    m_matchingTrace->setLoadImpedance(m_loadZ);
+    m_matchingTrace->setZ0(state.z0);
+    m_matchingTrace->setFrequency(state.frequency);
+    m_circuitView->setSourceImpedance(m_sourceZ);
+    m_circuitView->setLoadImpedance(m_loadZ);
+    m_smithChart->setSourceImpedance(m_sourceZ);
+    m_smithChart->setLoadImpedance(m_loadZ);
+    EditHistory::assign(*m_matchingTrace, state.elements);
+    m_history.clear();
+    syncCircuitView();
+    
+    // The main dataset is drawn at once; overlays decode when first drawn
+    m_currentData = std::make_shared<SParamData>();
+    m_currentFile.clear();
+    updateDataPanels();
+    m_smithChart->clearSParamOverlays();
+    m_overlayPorts = 1;
+    QStringList failed;
+    for (int i = 0; i < project->datasetCount(); ++i) {
+        const ProjectDataset& dataset = state.datasets[i];
+        if (dataset.role == ProjectDataset::Role::Current) {
+            std::shared_ptr<const SParamData> data = project->loadDataset(i, error);
+            if (data) {
+                m_currentData = std::move(data);
+                m_currentFile = dataset.name;
+                updateDataPanels();
+            } else {
+                failed.append(error);
+            }
+            continue;
+        }
+        
+        int index = m_smithChart->addLazySParamData([project, i]() {
+            QString loadError;
+            return project->loadDataset(i, loadError);
+        }, dataset.color);
+        m_smithChart->setSParamOverlayVisible(index, dataset.visible);
+        m_overlayPorts = std::max(m_overlayPorts, dataset.numPorts);
+    }
+    m_smithChart->setSParamData(m_currentData);
+    m_clearOverlaysAction->setEnabled(m_smithChart->sparamOverlayCount() > 0);
+    m_envelopeAction->setEnabled(m_smithChart->sparamOverlayCount() > 0);
+    
+    applyProjectSettings(state.settings);
+    rebuildSParamTraceMenu();
+    updateMeasuredLoad();
+    updateTraces();
+    updateEnvelope();
+    
+    if (!failed.isEmpty()) {
+        QMessageBox::warning(this, tr("Warning"),
+            tr("Some data could not be loaded:\n%1").arg(failed.join('\n')));
+    }
+    
+    statusBar()->showMessage(
+        tr("Opened project %1: %2 dataset(s) in %3 ms")
+            .arg(QFileInfo(filename).fileName())
+            .arg(project->datasetCount())
+            .arg(clock.elapsed()),
+        5000
+    );
+    setWindowTitle(tr("SmithTool - %1").arg(QFileInfo(filename).fileName()));
+}
+
+QVariantMap MainWindow::projectSettings() const
+{
+    QVariantList qValues;
+    for (double q : m_smithChart->qValues()) {
+        qValues.append(q);
+    }
+    
+    QVariantMap settings;
+    settings["admittance"] = m_admittanceAction->isChecked();
+    settings["vswr"] = m_vswrAction->isChecked();
+    settings["labels"] = m_labelsAction->isChecked();
+    settings["qCircles"] = m_qCirclesAction->isChecked();
+    settings["qValues"] = qValues;
+    settings["sweep"] = m_sweepAction->isChecked();
+    settings["sweepStart"] = m_sweepStart;
+    settings["sweepStop"] = m_sweepStop;
+    settings["sweepPoints"] = m_sweepPoints;
+    settings["measuredLoad"] = m_measuredLoadAction->isChecked();
+    settings["envelope"] = m_envelopeAction->isChecked();
+    settings["sparamRow"] = m_smithChart->sparamTraceRow();
+    settings["sparamCol"] = m_smithChart->sparamTraceCol();
+    return settings;
+}
+
+void MainWindow::applyProjectSettings(const QVariantMap& settings)
+{
+    // Keys missing from older projects keep the current state
+    std::vector<double> qValues;
+    for (const QVariant& q : settings.value("qValues").toList()) {
+        qValues.push_back(q.toDouble());
+    }
+    if (!qValues.empty()) {
+        m_smithChart->setQValues(qValues);
+    }
+    
+    m_sweepStart = settings.value("sweepStart", m_sweepStart).toDouble();
+    m_sweepStop = settings.value("sweepStop", m_sweepStop).toDouble();
+    m_sweepPoints = std::max(2, settings.value("sweepPoints", m_sweepPoints).toInt());
+    m_smithChart->setSParamTrace(settings.value("sparamRow", 0).toInt(),
+                                 settings.value("sparamCol", 0).toInt());
+    
+    // Toggled actions update the chart through their slots; the sweep,
+    // measured load and envelope are refreshed once by the caller
+    const QSignalBlocker sweepBlocker(m_sweepAction);
+    const QSignalBlocker measuredBlocker(m_measuredLoadAction);
+    const QSignalBlocker envelopeBlocker(m_envelopeAction);
+    m_admittanceAction->setChecked(settings.value("admittance", m_admittanceAction->isChecked()).toBool());
+    m_vswrAction->setChecked(settings.value("vswr", m_vswrAction->isChecked()).toBool());
+    m_labelsAction->setChecked(settings.value("labels", m_labelsAction->isChecked()).toBool());
+    m_qCirclesAction->setChecked(settings.value("qCircles", m_qCirclesAction->isChecked()).toBool());
+    m_sweepAction->setChecked(settings.value("sweep", m_sweepAction->isChecked()).toBool());
+    m_measuredLoadAction->setChecked(settings.value("measuredLoad", false).toBool());
+    m_envelopeAction->setChecked(settings.value("envelope", m_envelopeAction->isChecked()).toBool());
+}
+
 void MainWindow::onExportImage()
 {
     QString filename = QFileDialog::getSaveFileName(
         this,
         tr("Export Image"),
         "smith_chart.png",
-        tr("PNG Image (*.png);;JPEG Image (*.jpg);;SVG Image (*.svg)")
+        tr("PNG Image (*.png);;JPEG Image (*.jpg);;SVG Image (*.svg);;PDF Document (*.pdf)")
     );
+    if (filename.isEmpty()) return;
     
-    if (!filename.isEmpty()) {
-        QPixmap pixmap(m_smithChart->size());
-        m_smithChart->render(&pixmap);
-        pixmap.save(filename);
-        statusBar()->showMessage(tr("Image exported: %1").arg(filename), 3000);
+    // Rendered offscreen, independent of the window size and zoom
+    QString error;
+    if (!m_chartExporter.exportChart(m_smithChart->scene(), filename, ChartExportSettings(), error)) {
+        QMessageBox::warning(this, tr("Export Image"), error);
+        return;
+    }
+    statusBar()->showMessage(tr("Image exported: %1").arg(filename), 3000);
+}
+
+void MainWindow::onExportReportImages()
+{
+    const QString title = tr("Export Report Images");
+    
+    const QStringList files = QFileDialog::getOpenFileNames(
+        this, title, QString(), tr("Touchstone Files (*.s*p);;All Files (*)"));
+    if (files.isEmpty()) return;
+    const QString directory = QFileDialog::getExistingDirectory(
+        this, tr("Output Directory"), QFileInfo(files.first()).absolutePath());
+    if (directory.isEmpty()) return;
+    
+    bool ok;
+    const QStringList formats = {"png", "jpg", "svg", "pdf"};
+    const QString format = QInputDialog::getItem(this, title, tr("Format:"), formats, 0, false, &ok);
+    if (!ok) return;
+    const int dpi = QInputDialog::getInt(this, title, tr("Resolution of the 8 x 8 inch chart (dpi):"),
+                                         300, 72, 600, 1, &ok);
+    if (!ok) return;
+    
+    ChartExportSettings settings;
+    settings.dpi = dpi;
+    settings.pixelSize = QSize(8 * dpi, 8 * dpi);
+    
+    // The chart's grid settings, with only each file's data drawn on it
+    ChartScene base = m_smithChart->scene();
+    base.data.reset();
+    base.overlays.clear();
+    base.sweep.reset();
+    base.matchingTrace.reset();
+    base.sourceVisible = false;
+    base.loadVisible = false;
+    base.markerVisible = false;
+    
+    std::vector<ChartExportJob> jobs;
+    jobs.reserve(files.size());
+    for (const QString& file : files) {
+        ChartExportJob job;
+        job.scene = base;
+        job.scene.title = QFileInfo(file).fileName();
+        job.filename = QDir(directory).filePath(QFileInfo(file).fileName() + "." + format);
+        job.prepare = [file](ChartScene& scene, QString& error) {
+            TouchstoneParser parser;
+            if (!parser.parse(file)) {
+                error = parser.lastError();
+                return false;
+            }
+            scene.data = std::make_shared<const SParamData>(parser.takeData());
+            return true;
+        };
+        jobs.push_back(std::move(job));
+    }
+    
+    m_exportReportAction->setEnabled(false);
+    m_reportClock.start();
+    m_reportWatcher->setFuture(m_chartExporter.exportAll(std::move(jobs), settings));
+}
+
+void MainWindow::onReportExportFinished()
+{
+    m_exportReportAction->setEnabled(true);
+    
+    const QList<ChartExportResult> results = m_reportWatcher->future().results();
+    QStringList errors;
+    for (const ChartExportResult& result : results) {
+        if (!result.ok) {
+            // Input file name: the output name without the image suffix
+            errors.append(QString("%1: %2").arg(QFileInfo(result.filename).completeBaseName(), result.error));
+        }
+    }
+    statusBar()->showMessage(tr("Exported %1 of %2 report images in %3 ms")
+        .arg(results.size() - errors.size())
+        .arg(results.size())
+        .arg(m_reportClock.elapsed()), 5000);
+    if (!errors.isEmpty()) {
+        QMessageBox::warning(this, tr("Export Report Images"), errors.join("\n"));
     }
 }
 
@@ -365,7 +913,7 @@ void MainWindow::onToggleQCircles(bool show)
 void MainWindow::onConfigureQCircles()
 {
     // Get current Q values as string
-    std::vector<double> currentQ = {0.5, 1.0, 2.0, 5.0};  // Default values
+    const std::vector<double>& currentQ = m_smithChart->qValues();
     
     QString currentStr;
     for (size_t i = 0; i < currentQ.size(); ++i) {
@@ -446,8 +994,12 @@ void MainWindow::onAddShuntC()
 
 void MainWindow::onRemoveLastElement()
 {
-    if (m_matchingTrace.numSegments() > 0) {
-        m_matchingTrace.removeLastSegment();
+    int last = m_matchingTrace->numSegments() - 1;
+    if (last >= 0) {
+        const TraceSegment& seg = m_matchingTrace->segment(last);
+        m_history.recordRemove(last, ElementSpec(seg.componentType, seg.connectionType,
+                                                 seg.componentValue, seg.color));
+        m_matchingTrace->removeLastSegment();
         m_circuitView->removeLastElement();
         updateTraces();
     }
@@ -455,15 +1007,46 @@ void MainWindow::onRemoveLastElement()
 
 void MainWindow::onClearElements()
 {
-    m_matchingTrace.clear();
+    m_history.recordReplace(EditHistory::elementsOf(*m_matchingTrace), {});
+    m_matchingTrace->clear();
     m_circuitView->clearElements();
     updateTraces();
 }
 
+void MainWindow::onUndo()
+{
+    // A drag in progress records its own step when it ends
+    if (m_history.isValueEditActive() || !m_history.undo(*m_matchingTrace)) return;
+    syncCircuitView();
+    updateTraces();
+}
+
+void MainWindow::onRedo()
+{
+    if (m_history.isValueEditActive() || !m_history.redo(*m_matchingTrace)) return;
+    syncCircuitView();
+    updateTraces();
+}
+
+void MainWindow::syncCircuitView()
+{
+    m_circuitView->clearElements();
+    for (int i = 0; i < m_matchingTrace->numSegments(); ++i) {
+        const TraceSegment& seg = m_matchingTrace->segment(i);
+        m_circuitView->addElement(seg.componentType, seg.connectionType, seg.componentValue);
+    }
+}
+
+void MainWindow::updateUndoActions()
+{
+    m_undoAction->setEnabled(m_history.canUndo());
+    m_redoAction->setEnabled(m_history.canRedo());
+}
+
 void MainWindow::onSourceImpedanceChanged(std::complex<double> zs)
 {
     m_sourceZ = zs;
-    m_matchingTrace.setSourceImpedance(zs);
+    m_matchingTrace->setSourceImpedance(zs);
     m_circuitView->setSourceImpedance(zs);
     m_smithChart->setSourceImpedance(zs);
     updateTraces();
@@ -472,7 +1055,16 @@ void MainWindow::onSourceImpedanceChanged(std::complex<double> zs)
 void MainWindow::onLoadImpedanceChanged(std::complex<double> zl)
 {
     m_loadZ = zl;
-    m_matchingTrace.setLoadImpedance(zl);
+    
+    // A measured load overrides the panel value until it is switched off
+    if (!m_measuredLoadZ.empty()) return;
+    applyLoadImpedance(zl);
+}
+
+void MainWindow::applyLoadImpedance(const std::complex<double>& zl)
+{
+    m_matchingTrace->setLoadImpedance(zl);
+    m_matchingTrace->recalculate(0);
     m_circuitView->setLoadImpedance(zl);
     m_smithChart->setLoadImpedance(zl);
     updateTraces();
@@ -483,8 +1075,8 @@ void MainWindow::addMatchingElement(ComponentType type, ConnectionType conn)
     double freq = m_componentPanel->frequency();
     double z0 = m_componentPanel->z0();
     
-    m_matchingTrace.setFrequency(freq);
-    m_matchingTrace.setZ0(z0);
+    m_matchingTrace->setFrequency(freq);
+    m_matchingTrace->setZ0(z0);
     
     // Get value from user
     QString typeStr;
@@ -543,11 +1135,13 @@ void MainWindow::addMatchingElement(ComponentType type, ConnectionType conn)
     // Calculate and add trace segment
     TraceSegment segment;
     if (conn == ConnectionType::Series) {
-        segment = m_matchingTrace.calculateSeriesElement(type, baseValue);
+        segment = m_matchingTrace->calculateSeriesElement(type, baseValue);
     } else {
-        segment = m_matchingTrace.calculateShuntElement(type, baseValue);
+        segment = m_matchingTrace->calculateShuntElement(type, baseValue);
     }
-    m_matchingTrace.addSegment(segment);
+    m_matchingTrace->addSegment(segment);
+    m_history.recordAdd(m_matchingTrace->numSegments() - 1,
+                        ElementSpec(type, conn, baseValue, segment.color));
     
     // Add to circuit view
     m_circuitView->addElement(type, conn, baseValue);
@@ -559,31 +1153,536 @@ void MainWindow::updateTraces()
 {
     // Update Smith chart display
     m_smithChart->setMatchingTrace(m_matchingTrace);
+    updateSweep();
     
+    invalidateNetworkResults();
+    updateUndoActions();
     updateStatusBar();
 }
 
-void MainWindow::loadTouchstoneFile(const QString& filename)
+void MainWindow::invalidateNetworkResults()
 {
-    TouchstoneParser parser;
+    // A Monte Carlo cloud describes the network it was run on
+    ++m_networkRevision;
+    m_smithChart->clearMonteCarloResult();
+}
+
+void MainWindow::updateSweep()
+{
+    if (!m_measuredLoadZ.empty()) {
+        // Transform every measured load point through the network; cheap
+        // enough (one ABCD chain per point) to redo on each drag step
+        if (m_matchingTrace->numSegments() == 0) {
+            m_sweepResult.reset();
+            m_smithChart->clearSweepResult();
+            return;
+        }
+        FrequencySweep sweep;
+        sweep.setNetwork(*m_matchingTrace);
+        m_sweepResult = std::make_shared<SweepResult>(
+            sweep.run(m_currentData->frequencyData(), m_measuredLoadZ));
+        m_smithChart->setSweepResult(m_sweepResult);
+        return;
+    }
     
-    if (parser.parse(filename)) {
-        m_currentData = parser.data();
-        m_currentFile = filename;
-        m_smithChart->setSParamData(m_currentData);
+    if (!m_sweepAction->isChecked() || m_matchingTrace->numSegments() == 0) {
+        m_sweepResult.reset();
+        m_smithChart->clearSweepResult();
+        return;
+    }
+    
+    double start = m_sweepStart;
+    double stop = m_sweepStop;
+    if (start <= 0.0 || stop <= start) {
+        // Default: ±50 % around the design frequency
+        start = 0.5 * m_matchingTrace->frequency();
+        stop = 1.5 * m_matchingTrace->frequency();
+    }
+    
+    FrequencySweep sweep;
+    sweep.setNetwork(*m_matchingTrace);
+    m_sweepResult = std::make_shared<SweepResult>(
+        sweep.run(FrequencySweep::linearFrequencies(start, stop, m_sweepPoints)));
+    m_smithChart->setSweepResult(m_sweepResult);
+}
+
+void MainWindow::onToggleSweep(bool /* show */)
+{
+    updateSweep();
+}
+
+void MainWindow::onConfigureSweep()
+{
+    double designGHz = m_matchingTrace->frequency() / 1e9;
+    double startGHz = (m_sweepStart > 0.0) ? m_sweepStart / 1e9 : 0.5 * designGHz;
+    double stopGHz = (m_sweepStop > 0.0) ? m_sweepStop / 1e9 : 1.5 * designGHz;
+    
+    bool ok;
+    startGHz = QInputDialog::getDouble(this, tr("Frequency Sweep"),
+        tr("Start frequency (GHz):"), startGHz, 0.000001, 1000.0, 6, &ok);
+    if (!ok) return;
+    
+    stopGHz = QInputDialog::getDouble(this, tr("Frequency Sweep"),
+        tr("Stop frequency (GHz):"), std::max(stopGHz, startGHz), startGHz, 1000.0, 6, &ok);
+    if (!ok) return;
+    
+    int points = QInputDialog::getInt(this, tr("Frequency Sweep"),
+        tr("Number of points:"), m_sweepPoints, 2, 100000, 1, &ok);
+    if (!ok) return;
+    
+    m_sweepStart = startGHz * 1e9;
+    m_sweepStop = stopGHz * 1e9;
+    m_sweepPoints = points;
+    
+    m_sweepAction->setChecked(true);
+    updateSweep();
+}
+
+void MainWindow::onToggleMeasuredLoad(bool /* enabled */)
+{
+    updateMeasuredLoad();
+}
+
+void MainWindow::onToggleLiveInput(bool enabled)
+{
+    if (!enabled) {
+        m_liveSource->stop();
+        statusBar()->showMessage(tr("Live input stopped after %1 sweeps")
+                                     .arg(m_liveSource->sweepsReceived()), 5000);
+        return;
+    }
+    
+    bool ok;
+    QString address = QInputDialog::getText(this, tr("Live VNA Input"),
+        tr("Instrument address (host:port):"), QLineEdit::Normal, "localhost:5025", &ok);
+    if (ok) {
+        const QStringList protocols = {tr("SCPI (query every sweep)"),
+                                       tr("RI frames (pushed by the instrument)")};
+        QString protocol = QInputDialog::getItem(this, tr("Live VNA Input"),
+            tr("Protocol:"), protocols, 0, false, &ok);
         
-        statusBar()->showMessage(
-            tr("Loaded: %1 (%2 points)")
-                .arg(filename)
-                .arg(m_currentData.numPoints()),
-            5000
-        );
+        LiveSweepSettings settings;
+        settings.protocol = protocol == protocols[1]
+            ? LiveSweepSettings::Protocol::RiFrames : LiveSweepSettings::Protocol::Scpi;
+        const int colon = address.lastIndexOf(':');
+        settings.host = colon > 0 ? address.left(colon).trimmed() : address.trimmed();
+        settings.port = colon > 0 ? address.mid(colon + 1).toUShort() : settings.port;
         
-        setWindowTitle(tr("SmithTool - %1").arg(QFileInfo(filename).fileName()));
-    } else {
+        QString error;
+        if (ok && !m_liveSource->start(settings, error)) {
+            QMessageBox::warning(this, tr("Live VNA Input"), error);
+            ok = false;
+        }
+    }
+    
+    if (!ok) {
+        QSignalBlocker blocker(m_liveAction);
+        m_liveAction->setChecked(false);
+        return;
+    }
+    m_liveShown = 0;
+    m_liveClock.start();
+    statusBar()->showMessage(tr("Live input: connecting..."));
+}
+
+void MainWindow::onLiveSweep()
+{
+    std::shared_ptr<const SParamData> sweep = m_liveSource->takeLatest();
+    if (!sweep) return;
+    m_smithChart->setSParamData(std::move(sweep));
+    
+    // Rate in the status bar about once a second
+    ++m_liveShown;
+    const qint64 elapsed = m_liveClock.elapsed();
+    if (elapsed >= 1000) {
+        statusBar()->showMessage(tr("Live input: %1 sweeps/s shown, %2 received, %3 dropped")
+            .arg(m_liveShown * 1000.0 / elapsed, 0, 'f', 1)
+            .arg(m_liveSource->sweepsReceived())
+            .arg(m_liveSource->sweepsDropped()));
+        m_liveShown = 0;
+        m_liveClock.restart();
+    }
+}
+
+void MainWindow::onLiveFailed(const QString& error)
+{
+    QSignalBlocker blocker(m_liveAction);
+    m_liveAction->setChecked(false);
+    QMessageBox::warning(this, tr("Live VNA Input"), error);
+}
+
+void MainWindow::updateMeasuredLoad()
+{
+    const bool available = !m_currentData->isEmpty();
+    m_measuredLoadAction->setEnabled(available);
+    
+    if (!available || !m_measuredLoadAction->isChecked()) {
+        if (!m_measuredLoadZ.empty()) {
+            m_measuredLoadZ.clear();
+            applyLoadImpedance(m_loadZ);
+        }
+        return;
+    }
+    
+    // Convert S11 to impedance once; drags only re-run the network
+    const std::vector<Complex>& s11 = m_currentData->sData(0, 0);
+    const double dataZ0 = m_currentData->referenceImpedance();
+    m_measuredLoadZ.resize(s11.size());
+    SmithMath::gammaToImpedance(s11.data(), m_measuredLoadZ.data(), s11.size(), dataZ0);
+    
+    // The single-frequency trace follows the measured load at the design frequency
+    double f0 = m_matchingTrace->frequency();
+    applyLoadImpedance(SmithMath::gammaToImpedance(m_currentData->s11At(f0), dataZ0));
+}
+
+void MainWindow::loadTouchstoneFiles(const QStringList& filenames)
+{
+    m_loadProgress->setValue(0);
+    m_loadProgress->show();
+    m_cancelLoadButton->show();
+    statusBar()->showMessage(tr("Loading %n file(s)...", "", filenames.size()));
+    
+    // Several files at once are compared as overlays (e.g. a lot of DUTs)
+    if (filenames.size() > 1) {
+        for (const QString& filename : filenames) {
+            m_pendingOverlays.insert(filename);
+        }
+    }
+    
+    m_loader->load(filenames);
+}
+
+void MainWindow::onFileLoaded(const QString& filename, std::shared_ptr<const SParamData> data)
+{
+    if (m_pendingOverlays.remove(filename)) {
+        m_overlayPorts = std::max(m_overlayPorts, data->numPorts());
+        m_smithChart->addSParamData(std::move(data));
+        m_clearOverlaysAction->setEnabled(true);
+        m_envelopeAction->setEnabled(true);
+        rebuildSParamTraceMenu();
+        statusBar()->showMessage(tr("Overlays: %1").arg(m_smithChart->sparamOverlayCount()), 5000);
+        return;
+    }
+    
+    if (filename == m_previewFile) {
+        m_previewFile.clear();
+    }
+    
+    // The chart shares the parsed object; nothing is copied
+    m_currentData = std::move(data);
+    m_currentFile = filename;
+    m_smithChart->setSParamData(m_currentData);
+    updateDataPanels();
+    m_smithChart->setSParamTrace(0, 0);
+    rebuildSParamTraceMenu();
+    updateMeasuredLoad();
+    
+    statusBar()->showMessage(
+        tr("Loaded: %1 (%2 ports, %3 points)")
+            .arg(filename)
+            .arg(m_currentData->numPorts())
+            .arg(m_currentData->numPoints()),
+        5000
+    );
+    
+    setWindowTitle(tr("SmithTool - %1").arg(QFileInfo(filename).fileName()));
+}
+
+void MainWindow::onPartialDataLoaded(const QString& filename,
+                                     std::shared_ptr<const SParamData> preview, qint64 pointsRead)
+{
+    // Overlays appear complete; the main trace grows while it streams in
+    if (m_pendingOverlays.contains(filename)) {
+        return;
+    }
+    
+    m_previewFile = filename;
+    m_smithChart->setSParamData(std::move(preview));
+    statusBar()->showMessage(tr("Loading %1: %2 points read...")
+                                 .arg(QFileInfo(filename).fileName()).arg(pointsRead));
+}
+
+void MainWindow::onToggleLowMemoryLoading(bool enabled)
+{
+    TouchstoneStreamOptions options = m_loader->streamOptions();
+    options.reducedPrecision = enabled;
+    m_loader->setStreamOptions(options);
+}
+
+void MainWindow::onFileLoadFailed(const QString& filename, const QString& error)
+{
+    m_pendingOverlays.remove(filename);
+    m_loadErrors.append(QString("%1: %2").arg(QFileInfo(filename).fileName(), error));
+}
+
+void MainWindow::onLoadProgress(int percent)
+{
+    m_loadProgress->setValue(percent);
+}
+
+void MainWindow::onLoadingFinished()
+{
+    // Cancelled files never report back
+    m_pendingOverlays.clear();
+    m_loadProgress->hide();
+    
+    // A streamed file that failed or was cancelled leaves its preview
+    if (!m_previewFile.isEmpty()) {
+        m_previewFile.clear();
+        m_smithChart->setSParamData(m_currentData);
+    }
+    m_cancelLoadButton->hide();
+    
+    // Once per load, not per arriving overlay
+    updateEnvelope();
+    
+    if (!m_loadErrors.isEmpty()) {
         QMessageBox::critical(this, tr("Error"),
-            tr("Failed to load file:\n%1").arg(parser.lastError()));
+            tr("Failed to load file:\n%1").arg(m_loadErrors.join('\n')));
+        m_loadErrors.clear();
+    }
+}
+
+void MainWindow::onClearOverlays()
+{
+    m_smithChart->clearSParamOverlays();
+    m_overlayPorts = 1;
+    m_clearOverlaysAction->setEnabled(false);
+    m_envelopeAction->setEnabled(false);
+    rebuildSParamTraceMenu();
+    updateEnvelope();
+}
+
+void MainWindow::onToggleEnvelope(bool show)
+{
+    Q_UNUSED(show);
+    updateEnvelope();
+}
+
+void MainWindow::updateEnvelope()
+{
+    if (!m_envelopeAction->isChecked() || m_smithChart->sparamOverlayCount() < 2) {
+        m_smithChart->clearSParamEnvelope();
+        return;
+    }
+    
+    // One computation at a time; the latest inputs win
+    if (m_envelopeWatcher->isRunning()) {
+        m_envelopePending = true;
+        return;
+    }
+    
+    std::vector<std::shared_ptr<const SParamData>> datasets;
+    for (int i = 0; i < m_smithChart->sparamOverlayCount(); ++i) {
+        datasets.push_back(m_smithChart->sparamOverlayData(i));
+    }
+    const int row = m_smithChart->sparamTraceRow();
+    const int col = m_smithChart->sparamTraceCol();
+    
+    m_envelopeClock.start();
+    m_envelopeWatcher->setFuture(QtConcurrent::run([datasets, row, col]() {
+        return std::make_shared<const SParamEnvelope>(SParamStatistics().compute(datasets, row, col));
+    }));
+}
+
+void MainWindow::onEnvelopeFinished()
+{
+    if (m_envelopePending) {
+        m_envelopePending = false;
+        updateEnvelope();
+        return;
+    }
+    if (!m_envelopeAction->isChecked() || m_smithChart->sparamOverlayCount() < 2) {
+        return;
+    }
+    
+    std::shared_ptr<const SParamEnvelope> envelope = m_envelopeWatcher->result();
+    if (envelope->isEmpty()) {
+        m_smithChart->clearSParamEnvelope();
+        statusBar()->showMessage(tr("Envelope: the files have no common frequency range"), 5000);
+        return;
+    }
+    
+    m_smithChart->setSParamEnvelope(envelope);
+    statusBar()->showMessage(
+        tr("Envelope of %1 files: %2 points, %3 ms")
+            .arg(envelope->datasetCount)
+            .arg(envelope->size())
+            .arg(m_envelopeClock.elapsed()),
+        5000
+    );
+}
+
+void MainWindow::dragEnterEvent(QDragEnterEvent* event)
+{
+    if (event->mimeData()->hasUrls()) {
+        event->acceptProposedAction();
+    }
+}
+
+void MainWindow::dropEvent(QDropEvent* event)
+{
+    // Every dropped Touchstone file is parsed by its own worker
+    static const QRegularExpression touchstoneSuffix("\\.(s\\d+p|smtsp)$",
+        QRegularExpression::CaseInsensitiveOption);
+    
+    QStringList filenames;
+    for (const QUrl& url : event->mimeData()->urls()) {
+        QString path = url.toLocalFile();
+        if (path.endsWith(QString(".") + ProjectFile::FILE_SUFFIX, Qt::CaseInsensitive)) {
+            event->acceptProposedAction();
+            openProject(path);
+            return;
+        }
+        if (!path.isEmpty() && touchstoneSuffix.match(path).hasMatch()) {
+            filenames.append(path);
+        }
+    }
+    
+    if (filenames.isEmpty()) return;
+    event->acceptProposedAction();
+    loadTouchstoneFiles(filenames);
+}
+
+bool MainWindow::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == m_smithChart && event->type() == QEvent::Paint) {
+        // Runs after this paint event has been handled
+        m_smithChart->removeEventFilter(this);
+        QTimer::singleShot(0, this, &MainWindow::onFirstFramePainted);
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::onFirstFramePainted()
+{
+    StartupTimer::finish("first paint");
+    if (StartupTimer::totalMs() > 0.0) {
+        statusBar()->showMessage(tr("Ready in %1 ms").arg(StartupTimer::totalMs(), 0, 'f', 0), 3000);
+    }
+    emit firstFramePainted();
+}
+
+MatchingWizard* MainWindow::matchingWizard()
+{
+    // Built on first use; later openings only refresh its inputs
+    if (!m_matchingWizard) {
+        m_matchingWizard = new MatchingWizard(this);
+        connect(m_matchingWizard, &MatchingWizard::solutionSelected,
+                this, &MainWindow::onApplyMatchingSolution);
+    }
+    return m_matchingWizard;
+}
+
+ComponentEditDialog* MainWindow::componentEditDialog()
+{
+    if (!m_componentEditDialog) {
+        m_componentEditDialog = new ComponentEditDialog(this);
+        
+        // Connect preview signal
+        connect(m_componentEditDialog, &ComponentEditDialog::previewRequested,
+                [this](int idx, double newValue) {
+                    m_matchingTrace->updateSegmentValue(idx, newValue);
+                    m_smithChart->setMatchingTrace(m_matchingTrace);
+                    updateSweep();
+                });
+    }
+    return m_componentEditDialog;
+}
+
+QDockWidget* MainWindow::tdrDock()
+{
+    // The docks are built like the dialogs: on first use, with the current data
+    if (!m_tdrDock) {
+        m_tdrDock = new QDockWidget(tr("Time Domain (TDR)"), this);
+        m_tdrPanel = new TdrPanel(m_tdrDock);
+        m_tdrPanel->setData(m_currentData);
+        m_tdrDock->setWidget(m_tdrPanel);
+        addDockWidget(Qt::BottomDockWidgetArea, m_tdrDock);
+        adoptDockAction(m_tdrAction, m_tdrDock);
+    }
+    return m_tdrDock;
+}
+
+QDockWidget* MainWindow::twoPortDock()
+{
+    if (!m_twoPortDock) {
+        m_twoPortDock = new QDockWidget(tr("Two-Port Stability"), this);
+        m_twoPortPanel = new TwoPortPanel(m_twoPortDock);
+        
+        // Two-port circles go straight to the chart
+        connect(m_twoPortPanel, &TwoPortPanel::circlesChanged, m_smithChart,
+                &SmithChartWidget::setTwoPortCircles);
+        m_twoPortPanel->setData(m_currentData);
+        m_twoPortDock->setWidget(m_twoPortPanel);
+        addDockWidget(Qt::BottomDockWidgetArea, m_twoPortDock);
+        adoptDockAction(m_twoPortAction, m_twoPortDock);
     }
+    return m_twoPortDock;
+}
+
+QDockWidget* MainWindow::bandDock()
+{
+    if (!m_bandDock) {
+        m_bandDock = new QDockWidget(tr("Band Analysis"), this);
+        m_bandPanel = new BandPanel(m_bandDock);
+        connect(m_bandPanel, &BandPanel::markerRequested, this, [this](double frequency, int port) {
+            m_smithChart->setMarkerGamma(m_currentData->sAt(port, port, frequency));
+        });
+        m_bandPanel->setData(m_currentData);
+        m_bandDock->setWidget(m_bandPanel);
+        addDockWidget(Qt::RightDockWidgetArea, m_bandDock);
+        adoptDockAction(m_bandAction, m_bandDock);
+    }
+    return m_bandDock;
+}
+
+void MainWindow::adoptDockAction(QAction* placeholder, QDockWidget* dock)
+{
+    // The dock's toggle action takes the placeholder's menu slot and shortcut
+    QAction* toggle = dock->toggleViewAction();
+    toggle->setShortcut(placeholder->shortcut());
+    m_viewMenu->insertAction(placeholder, toggle);
+    m_viewMenu->removeAction(placeholder);
+    placeholder->setEnabled(false);
+}
+
+void MainWindow::updateDataPanels()
+{
+    // Docks not built yet pick the data up when they are
+    if (m_tdrPanel) m_tdrPanel->setData(m_currentData);
+    if (m_twoPortPanel) m_twoPortPanel->setData(m_currentData);
+    if (m_bandPanel) m_bandPanel->setData(m_currentData);
+}
+
+void MainWindow::rebuildSParamTraceMenu()
+{
+    m_sparamTraceMenu->clear();
+    for (QAction* action : m_sparamTraceGroup->actions()) {
+        m_sparamTraceGroup->removeAction(action);
+        delete action;
+    }
+    
+    // One entry per Sij of the loaded data (main trace or any overlay)
+    const int ports = std::max(m_currentData->isEmpty() ? 1 : m_currentData->numPorts(),
+                               m_overlayPorts);
+    for (int i = 0; i < ports; ++i) {
+        for (int j = 0; j < ports; ++j) {
+            QAction* action = new QAction(tr("S%1%2").arg(i + 1).arg(j + 1), m_sparamTraceGroup);
+            action->setCheckable(true);
+            action->setChecked(i == m_smithChart->sparamTraceRow() &&
+                               j == m_smithChart->sparamTraceCol());
+            action->setData(QPoint(j, i));
+            m_sparamTraceMenu->addAction(action);
+        }
+    }
+}
+
+void MainWindow::onSelectSParamTrace(QAction* action)
+{
+    QPoint rowCol = action->data().toPoint();
+    m_smithChart->setSParamTrace(rowCol.y(), rowCol.x());
+    updateEnvelope();
 }
 
 void MainWindow::updateStatusBar()
@@ -596,52 +1695,384 @@ void MainWindow::updateStatusBar()
 
 void MainWindow::onOpenMatchingWizard()
 {
-    MatchingWizard wizard(this);
-    wizard.setSourceImpedance(m_sourceZ);
-    wizard.setLoadImpedance(m_loadZ);
-    wizard.setFrequency(m_componentPanel->frequency());
-    wizard.setZ0(m_componentPanel->z0());
+    MatchingWizard* wizard = matchingWizard();
+    wizard->setSourceImpedance(m_sourceZ);
+    wizard->setLoadImpedance(m_measuredLoadZ.empty() ? m_loadZ : m_matchingTrace->loadImpedance());
+    wizard->setFrequency(m_componentPanel->frequency());
+    wizard->setZ0(m_componentPanel->z0());
+    wizard->refreshResults();
+    
+    wizard->exec();
+    
+    // Whether repeated designs are being served from the result cache
+    const MatchingCacheStats stats = MatchingResultCache::shared()->stats();
+    if (stats.hits + stats.misses > 0) {
+        statusBar()->showMessage(
+            tr("Matching cache: %1 hits, %2 misses (%3 %), %4 of %5 entries, %6 evicted")
+                .arg(stats.hits)
+                .arg(stats.misses)
+                .arg(100.0 * stats.hitRate(), 0, 'f', 1)
+                .arg(stats.size)
+                .arg(stats.capacity)
+                .arg(stats.evictions),
+            5000);
+    }
+}
+
+void MainWindow::onOptimizeNetwork()
+{
+    std::vector<OptimizerElement> topology = NetworkOptimizer::topologyFromTrace(*m_matchingTrace);
+    if (topology.empty()) {
+        QMessageBox::information(this, tr("Optimize Network"),
+            tr("Add the elements of the network first; their values are the first starting point."));
+        return;
+    }
+    
+    QStringList goals = {tr("Worst-case |Γ| over the band"), tr("Band-average |Γ|²")};
+    bool ok;
+    QString goal = QInputDialog::getItem(this, tr("Optimize Network"), tr("Goal:"),
+                                         goals, 0, false, &ok);
+    if (!ok) return;
+    
+    // Default band: the sweep range if one is set, else ±2 % around the design frequency
+    double designGHz = m_matchingTrace->frequency() / 1e9;
+    double startGHz = (m_sweepStart > 0.0) ? m_sweepStart / 1e9 : 0.98 * designGHz;
+    double stopGHz = (m_sweepStop > 0.0) ? m_sweepStop / 1e9 : 1.02 * designGHz;
+    
+    startGHz = QInputDialog::getDouble(this, tr("Optimize Network"),
+        tr("Band start (GHz):"), startGHz, 0.000001, 1000.0, 6, &ok);
+    if (!ok) return;
+    stopGHz = QInputDialog::getDouble(this, tr("Optimize Network"),
+        tr("Band stop (GHz):"), std::max(stopGHz, startGHz), startGHz, 1000.0, 6, &ok);
+    if (!ok) return;
+    
+    OptimizerSettings settings;
+    settings.goal = (goal == goals[0]) ? OptimizerGoal::WorstCase : OptimizerGoal::Average;
+    settings.startFrequency = startGHz * 1e9;
+    settings.stopFrequency = stopGHz * 1e9;
+    
+    NetworkOptimizer optimizer;
+    optimizer.setTopology(topology);
+    optimizer.setSourceImpedance(m_sourceZ);
+    optimizer.setLoadImpedance(m_matchingTrace->loadImpedance());
+    optimizer.setSettings(settings);
+    
+    if (!m_measuredLoadZ.empty()) {
+        // Optimize against the measured points inside the band
+        const std::vector<double>& freqs = m_currentData->frequencyData();
+        std::vector<double> bandFreqs;
+        std::vector<Complex> bandLoads;
+        for (size_t i = 0; i < freqs.size(); ++i) {
+            if (freqs[i] >= settings.startFrequency && freqs[i] <= settings.stopFrequency) {
+                bandFreqs.push_back(freqs[i]);
+                bandLoads.push_back(m_measuredLoadZ[i]);
+            }
+        }
+        if (bandFreqs.empty()) {
+            QMessageBox::warning(this, tr("Optimize Network"),
+                tr("The measured load has no points inside the band."));
+            return;
+        }
+        optimizer.setMeasuredLoad(bandFreqs, bandLoads);
+    }
+    
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    OptimizerResult result = optimizer.run();
+    QApplication::restoreOverrideCursor();
+    
+    std::vector<ElementSpec> before = EditHistory::elementsOf(*m_matchingTrace);
+    if (!result.valid || !NetworkOptimizer::applyToTrace(result.elements, *m_matchingTrace)) {
+        QMessageBox::warning(this, tr("Optimize Network"), tr("The optimization failed."));
+        return;
+    }
+    m_history.recordReplace(before, EditHistory::elementsOf(*m_matchingTrace));
+    
+    for (int i = 0; i < m_matchingTrace->numSegments(); ++i) {
+        m_circuitView->updateElementValue(i, m_matchingTrace->segment(i).componentValue);
+    }
+    updateTraces();
+    
+    QMessageBox::information(this, tr("Optimize Network"),
+        tr("Worst-case return loss: %1 dB (|Γ| = %2) over %3 - %4 GHz\n"
+           "Best start: %5 iterations, %6\n"
+           "Starts converged: %7 of %8\n"
+           "Evaluations: %9, time: %10 ms")
+            .arg(result.worstReturnLoss, 0, 'f', 2)
+            .arg(result.worstGamma, 0, 'f', 4)
+            .arg(startGHz, 0, 'f', 3)
+            .arg(stopGHz, 0, 'f', 3)
+            .arg(result.iterations)
+            .arg(result.converged ? tr("converged") : tr("iteration limit reached"))
+            .arg(result.startsConverged)
+            .arg(result.startsRun)
+            .arg(result.evaluations)
+            .arg(result.elapsedMs, 0, 'f', 1));
+}
+
+void MainWindow::onDeembedFixtures()
+{
+    if (m_currentData->isEmpty()) {
+        QMessageBox::information(this, tr("De-embed Fixtures"), tr("Open a measurement first."));
+        return;
+    }
+    
+    const QString filter = tr("Two-Port Touchstone Files (*.s2p);;All Files (*)");
+    const QString leftFile = QFileDialog::getOpenFileName(this, tr("Fixture at Port 1"), QString(), filter);
+    if (leftFile.isEmpty()) return;
+    QString rightFile;
+    if (m_currentData->numPorts() == 2) {
+        rightFile = QFileDialog::getOpenFileName(this, tr("Fixture at Port 2 (Cancel for None)"),
+                                                 QString(), filter);
+    }
+    
+    // Fixtures are small next to the measurement; parse them here
+    TouchstoneParser leftParser;
+    TouchstoneParser rightParser;
+    if (!leftParser.parse(leftFile)) {
+        QMessageBox::warning(this, tr("De-embed Fixtures"), leftParser.lastError());
+        return;
+    }
+    if (!rightFile.isEmpty() && !rightParser.parse(rightFile)) {
+        QMessageBox::warning(this, tr("De-embed Fixtures"), rightParser.lastError());
+        return;
+    }
+    
+    Deembedder deembedder;
+    SParamData result;
+    QString error;
+    if (!deembedder.deembed(*m_currentData, &leftParser.data(),
+                            rightFile.isEmpty() ? nullptr : &rightParser.data(), result, error)) {
+        QMessageBox::warning(this, tr("De-embed Fixtures"), error);
+        return;
+    }
+    showCorrectedData(std::move(result), tr("De-embedded %1").arg(QFileInfo(leftFile).fileName()));
+}
+
+void MainWindow::onPortExtension()
+{
+    if (m_currentData->isEmpty()) {
+        QMessageBox::information(this, tr("Port Extension"), tr("Open a measurement first."));
+        return;
+    }
+    
+    const int ports = m_currentData->numPorts();
+    QStringList defaults;
+    for (int i = 0; i < ports; ++i) defaults.append("0");
+    bool ok;
+    const QString input = QInputDialog::getText(this, tr("Port Extension"),
+        tr("One-way delay per port in ps, comma separated:"), QLineEdit::Normal,
+        defaults.join(", "), &ok);
+    if (!ok) return;
+    
+    const QStringList parts = input.split(',', Qt::SkipEmptyParts);
+    std::vector<double> delays;
+    for (const QString& part : parts) {
+        const double ps = part.trimmed().toDouble(&ok);
+        if (!ok) break;
+        delays.push_back(ps * 1e-12);
+    }
+    
+    Deembedder deembedder;
+    SParamData result;
+    QString error;
+    if (!ok || !deembedder.extendPorts(*m_currentData, delays, result, error)) {
+        QMessageBox::warning(this, tr("Invalid Input"),
+            ok ? error : tr("Enter %1 delays in ps.").arg(ports));
+        return;
+    }
+    showCorrectedData(std::move(result), tr("Port extension: %1 ps").arg(input));
+}
+
+void MainWindow::onRenormalize()
+{
+    if (m_currentData->isEmpty()) {
+        QMessageBox::information(this, tr("Renormalize"), tr("Open a measurement first."));
+        return;
+    }
+    
+    bool ok;
+    const double z0 = QInputDialog::getDouble(this, tr("Renormalize"),
+        tr("New reference impedance (\u03a9):"), m_currentData->referenceImpedance(),
+        0.001, 1e6, 3, &ok);
+    if (!ok) return;
+    
+    Deembedder deembedder;
+    SParamData result;
+    QString error;
+    if (!deembedder.renormalize(*m_currentData, z0, result, error)) {
+        QMessageBox::warning(this, tr("Renormalize"), error);
+        return;
+    }
+    showCorrectedData(std::move(result), tr("Renormalized to %1 \u03a9").arg(z0));
+}
+
+void MainWindow::showCorrectedData(SParamData&& data, const QString& message)
+{
+    // Replaces the current dataset; the file on disk is left alone
+    m_currentData = std::make_shared<const SParamData>(std::move(data));
+    m_smithChart->setSParamData(m_currentData);
+    updateDataPanels();
+    rebuildSParamTraceMenu();
+    updateMeasuredLoad();
+    statusBar()->showMessage(message, 5000);
+}
+
+void MainWindow::onMonteCarloYield()
+{
+    if (m_matchingTrace->numSegments() == 0) {
+        QMessageBox::information(this, tr("Monte Carlo Yield"),
+            tr("Add the elements of the network first."));
+        return;
+    }
+    if (m_monteCarloWatcher->isRunning()) {
+        statusBar()->showMessage(tr("Monte Carlo: a run is already in progress"), 3000);
+        return;
+    }
+    
+    bool ok;
+    int samples = QInputDialog::getInt(this, tr("Monte Carlo Yield"),
+        tr("Samples (L ±2 %, C ±0.25 pF, R ±1 %):"), 10000, 100, 1000000, 1000, &ok);
+    if (!ok) return;
+    double mask = QInputDialog::getDouble(this, tr("Monte Carlo Yield"),
+        tr("Required return loss over the band (dB):"), 10.0, 0.1, 60.0, 1, &ok);
+    if (!ok) return;
+    
+    // Band: the sweep range if one is set, else ±50 % around the design frequency
+    double start = m_sweepStart;
+    double stop = m_sweepStop;
+    if (start <= 0.0 || stop <= start) {
+        start = 0.5 * m_matchingTrace->frequency();
+        stop = 1.5 * m_matchingTrace->frequency();
+    }
+    
+    MonteCarloSettings settings;
+    settings.samples = samples;
+    settings.returnLossMask = mask;
+    settings.frequencies = FrequencySweep::linearFrequencies(start, stop, 201);
+    settings.designFrequency = m_matchingTrace->frequency();
+    
+    auto analysis = std::make_shared<MonteCarloAnalysis>();
+    analysis->setNetwork(*m_matchingTrace);
+    
+    m_monteCarloRevision = m_networkRevision;
+    m_monteCarloAction->setEnabled(false);
+    statusBar()->showMessage(tr("Monte Carlo: evaluating %1 samples...").arg(samples));
+    m_monteCarloClock.start();
+    m_monteCarloWatcher->setFuture(QtConcurrent::run([analysis, settings]() {
+        return std::make_shared<const MonteCarloResult>(analysis->run(settings));
+    }));
+}
+
+void MainWindow::onMonteCarloFinished()
+{
+    m_monteCarloAction->setEnabled(true);
+    if (m_monteCarloRevision != m_networkRevision) {
+        statusBar()->showMessage(tr("Monte Carlo: the network changed during the run"), 5000);
+        return;
+    }
+    
+    std::shared_ptr<const MonteCarloResult> result = m_monteCarloWatcher->result();
+    if (result->isEmpty()) {
+        statusBar()->clearMessage();
+        return;
+    }
+    
+    m_smithChart->setMonteCarloResult(result);
+    statusBar()->showMessage(
+        tr("Monte Carlo yield: %1 % (%2 of %3 samples meet %4 dB return loss), %5 ms")
+            .arg(100.0 * result->yield(), 0, 'f', 1)
+            .arg(result->passed)
+            .arg(result->samples)
+            .arg(result->returnLossMask, 0, 'f', 1)
+            .arg(m_monteCarloClock.elapsed()));
+}
+
+void MainWindow::onSimulateSParams()
+{
+    if (m_matchingTrace->numSegments() == 0) {
+        QMessageBox::information(this, tr("Simulate S-Parameters"),
+            tr("Add the elements of the network first."));
+        return;
+    }
     
-    connect(&wizard, &MatchingWizard::solutionSelected,
-            this, &MainWindow::onApplyMatchingSolution);
+    double start = m_sweepStart;
+    double stop = m_sweepStop;
+    if (start <= 0.0 || stop <= start) {
+        start = 0.5 * m_matchingTrace->frequency();
+        stop = 1.5 * m_matchingTrace->frequency();
+    }
     
-    wizard.exec();
+    // Port 1 is the source side, port 2 the load side, both at Z0
+    QElapsedTimer clock;
+    clock.start();
+    AcSolver solver;
+    solver.setZ0(m_matchingTrace->z0());
+    auto data = std::make_shared<SParamData>(
+        solver.solve(*m_matchingTrace, FrequencySweep::linearFrequencies(start, stop, m_sweepPoints)));
+    data->setFilename(tr("Simulated network"));
+    qint64 elapsedUs = clock.nsecsElapsed() / 1000;
+    
+    m_overlayPorts = std::max(m_overlayPorts, data->numPorts());
+    m_smithChart->addSParamData(data);
+    m_clearOverlaysAction->setEnabled(true);
+    m_envelopeAction->setEnabled(true);
+    rebuildSParamTraceMenu();
+    statusBar()->showMessage(
+        tr("Simulated %1 points in %2 us; overlays: %3")
+            .arg(data->numPoints())
+            .arg(elapsedUs)
+            .arg(m_smithChart->sparamOverlayCount()),
+        5000);
 }
 
 void MainWindow::onApplyMatchingSolution(const MatchingSolution& solution)
 {
-    // Clear existing elements
-    onClearElements();
+    // Clear existing elements; the whole change is one undo step
+    std::vector<ElementSpec> before = EditHistory::elementsOf(*m_matchingTrace);
+    m_matchingTrace->clear();
+    m_circuitView->clearElements();
     
     // Apply each element from the solution
+    bool skippedSection = false;
     for (const auto& elem : solution.elements) {
+        // Quarter-wave sections are valued by their impedance, not a z0 length
+        if (solution.topology == MatchingTopology::QuarterWave &&
+            elem.type == ComponentType::TransmissionLine) {
+            skippedSection = true;
+            continue;
+        }
+        
         // Calculate and add trace segment
-        m_matchingTrace.setFrequency(solution.frequency);
-        m_matchingTrace.setZ0(m_componentPanel->z0());
+        m_matchingTrace->setFrequency(solution.frequency);
+        m_matchingTrace->setZ0(m_componentPanel->z0());
         
         TraceSegment segment;
         if (elem.connection == ConnectionType::Series) {
-            segment = m_matchingTrace.calculateSeriesElement(elem.type, elem.value);
+            segment = m_matchingTrace->calculateSeriesElement(elem.type, elem.value);
         } else {
-            segment = m_matchingTrace.calculateShuntElement(elem.type, elem.value);
+            segment = m_matchingTrace->calculateShuntElement(elem.type, elem.value);
         }
-        m_matchingTrace.addSegment(segment);
+        m_matchingTrace->addSegment(segment);
         
         // Add to circuit view
         m_circuitView->addElement(elem.type, elem.connection, elem.value);
     }
+    m_history.recordReplace(before, EditHistory::elementsOf(*m_matchingTrace));
     
     updateTraces();
     
-    statusBar()->showMessage(
-        tr("Applied matching: %1").arg(solution.toDescription()), 5000);
+    QString message = tr("Applied matching: %1").arg(solution.toDescription());
+    if (skippedSection) {
+        message += tr(" (quarter-wave section not added)");
+    }
+    statusBar()->showMessage(message, 5000);
 }
 
 void MainWindow::onTargetPointSelected(std::complex<double> /* gamma */, std::complex<double> z,
                                        ComponentType type, ConnectionType conn)
 {
     // Calculate element value to reach target impedance from current position
-    Complex currentZ = m_matchingTrace.currentImpedance();
+    Complex currentZ = m_matchingTrace->currentImpedance();
     double freq = m_componentPanel->frequency();
     double omega = 2.0 * M_PI * freq;
     
@@ -727,21 +2158,23 @@ void MainWindow::onTargetPointSelected(std::complex<double> /* gamma */, std::co
 
 void MainWindow::onElementValueDragged(int segmentIndex, double newValue)
 {
-    if (segmentIndex < 0 || segmentIndex >= m_matchingTrace.numSegments()) {
+    if (segmentIndex < 0 || segmentIndex >= m_matchingTrace->numSegments()) {
         return;
     }
     
     // Update the trace with the new value
-    m_matchingTrace.updateSegmentValue(segmentIndex, newValue);
+    m_matchingTrace->updateSegmentValue(segmentIndex, newValue);
     
     // Update the circuit view
     m_circuitView->updateElementValue(segmentIndex, newValue);
     
     // Update the Smith chart
     m_smithChart->setMatchingTrace(m_matchingTrace);
+    updateSweep();
+    invalidateNetworkResults();
     
     // Update status bar with current value
-    const auto& seg = m_matchingTrace.segment(segmentIndex);
+    const auto& seg = m_matchingTrace->segment(segmentIndex);
     QString typeStr;
     QString valueStr;
     
@@ -767,56 +2200,71 @@ void MainWindow::onElementValueDragged(int segmentIndex, double newValue)
 
 void MainWindow::onDragEditStarted(int segmentIndex)
 {
-    if (segmentIndex >= 0 && segmentIndex < m_matchingTrace.numSegments()) {
-        const auto& seg = m_matchingTrace.segment(segmentIndex);
+    if (segmentIndex >= 0 && segmentIndex < m_matchingTrace->numSegments()) {
+        const auto& seg = m_matchingTrace->segment(segmentIndex);
         statusBar()->showMessage(
             tr("Drag to modify element value (segment %1)").arg(segmentIndex + 1));
-        Q_UNUSED(seg);
+        
+        // The whole gesture becomes one undo step
+        m_history.beginValueEdit(segmentIndex, seg.componentValue);
     }
 }
 
 void MainWindow::onDragEditEnded()
 {
+    m_history.endValueEdit(*m_matchingTrace);
+    updateUndoActions();
     updateStatusBar();
+    
+    // How much of the mouse traffic actually reached the network update
+    const SmithChartWidget::DragFrameStats& stats = m_smithChart->dragFrameStats();
+    if (stats.frames > 0) {
+        statusBar()->showMessage(
+            tr("Drag: %1 moves, %2 updates, %3 ms avg / %4 ms max per update")
+                .arg(stats.mouseEvents)
+                .arg(stats.frames)
+                .arg(stats.averageFrameMs(), 0, 'f', 2)
+                .arg(stats.maxFrameMs, 0, 'f', 2),
+            5000);
+    }
 }
 
 void MainWindow::onCircuitElementDoubleClicked(int index)
 {
-    if (index < 0 || index >= m_matchingTrace.numSegments()) {
+    if (index < 0 || index >= m_matchingTrace->numSegments()) {
         return;
     }
     
-    const auto& seg = m_matchingTrace.segment(index);
-    
-    ComponentEditDialog dialog(this);
-    dialog.setComponent(seg.componentType, seg.connectionType, seg.componentValue);
-    dialog.setComponentIndex(index);
-    dialog.setFrequency(m_componentPanel->frequency());
-    dialog.setWindowTitle(tr("Edit Element %1").arg(index + 1));
+    const auto& seg = m_matchingTrace->segment(index);
+    const double originalValue = seg.componentValue;  // Preview edits seg in place
     
-    // Connect preview signal
-    connect(&dialog, &ComponentEditDialog::previewRequested,
-            [this](int idx, double newValue) {
-                m_matchingTrace.updateSegmentValue(idx, newValue);
-                m_smithChart->setMatchingTrace(m_matchingTrace);
-            });
+    ComponentEditDialog* dialog = componentEditDialog();
+    dialog->setComponent(seg.componentType, seg.connectionType, seg.componentValue);
+    dialog->setComponentIndex(index);
+    dialog->setFrequency(m_componentPanel->frequency());
+    dialog->setWindowTitle(tr("Edit Element %1").arg(index + 1));
     
-    if (dialog.exec() == QDialog::Accepted) {
-        double newValue = dialog.componentValue();
-        m_matchingTrace.updateSegmentValue(index, newValue);
+    if (dialog->exec() == QDialog::Accepted) {
+        double newValue = dialog->componentValue();
+        m_matchingTrace->updateSegmentValue(index, newValue);
         m_circuitView->updateElementValue(index, newValue);
+        m_history.recordValueChange(index, originalValue, newValue);
         m_smithChart->setMatchingTrace(m_matchingTrace);
+        updateSweep();
+        invalidateNetworkResults();
+        updateUndoActions();
         updateStatusBar();
     } else {
         // Restore original value if cancelled
-        m_matchingTrace.updateSegmentValue(index, seg.componentValue);
+        m_matchingTrace->updateSegmentValue(index, originalValue);
         m_smithChart->setMatchingTrace(m_matchingTrace);
+        updateSweep();
     }
 }
 
 void MainWindow::onDeleteElement(int index)
 {
-    if (index < 0 || index >= m_matchingTrace.numSegments()) {
+    if (index < 0 || index >= m_matchingTrace->numSegments()) {
         return;
     }
     
@@ -828,47 +2276,97 @@ void MainWindow::onDeleteElement(int index)
     );
     
     if (reply == QMessageBox::Yes) {
-        // Remove element from trace
-        // For now, we can only remove the last element easily
-        // To remove from middle, we need to rebuild the trace
-        if (index == m_matchingTrace.numSegments() - 1) {
-            m_matchingTrace.removeLastSegment();
-            m_circuitView->removeLastElement();
-        } else {
-            // Remove element from middle - need to rebuild
-            // Store all segments after the deleted one
-            std::vector<TraceSegment> remaining;
-            for (int i = index + 1; i < m_matchingTrace.numSegments(); ++i) {
-                remaining.push_back(m_matchingTrace.segment(i));
-            }
-            
-            // Clear and rebuild up to deleted index
-            while (m_matchingTrace.numSegments() > index) {
-                m_matchingTrace.removeLastSegment();
-            }
-            m_circuitView->clearElements();
-            
-            // Re-add remaining elements from the remaining segments
-            for (const auto& seg : remaining) {
-                if (seg.connectionType == ConnectionType::Series) {
-                    m_matchingTrace.addSegment(
-                        m_matchingTrace.calculateSeriesElement(seg.componentType, seg.componentValue));
-                } else {
-                    m_matchingTrace.addSegment(
-                        m_matchingTrace.calculateShuntElement(seg.componentType, seg.componentValue));
-                }
-                m_circuitView->addElement(seg.componentType, seg.connectionType, seg.componentValue);
-            }
-        }
-        
-        m_smithChart->setMatchingTrace(m_matchingTrace);
-        updateStatusBar();
+        // Downstream segments are recomputed in place
+        const TraceSegment& seg = m_matchingTrace->segment(index);
+        m_history.recordRemove(index, ElementSpec(seg.componentType, seg.connectionType,
+                                                  seg.componentValue, seg.color));
+        m_matchingTrace->removeSegment(index);
+        syncCircuitView();
+        updateTraces();
     }
 }
 
+void MainWindow::onExportSweep()
+{
+    if (!m_sweepResult || m_sweepResult->isEmpty()) {
+        QMessageBox::information(this, tr("Export Sweep"),
+            tr("No sweep to export. Enable Tools > Show Frequency Sweep first."));
+        return;
+    }
+    
+    QString filename = QFileDialog::getSaveFileName(
+        this,
+        tr("Export Sweep"),
+        QString("sweep.s1p"),
+        tr("Touchstone 1-Port (*.s1p)")
+    );
+    if (filename.isEmpty()) {
+        return;
+    }
+    
+    // Streamed straight from the sweep arrays, no SParamData copy
+    std::shared_ptr<const SweepResult> result = m_sweepResult;
+    int k = 0;
+    TouchstoneWriter writer;
+    bool ok = writer.writeStream(filename, 1, m_componentPanel->z0(),
+                                 [&result, &k](double& frequency, Complex* matrix) {
+        if (k >= result->size()) return false;
+        frequency = result->frequencies[k];
+        matrix[0] = result->gamma[k];
+        ++k;
+        return true;
+    });
+    
+    if (!ok) {
+        QMessageBox::critical(this, tr("Error"),
+                             tr("Failed to save file: %1").arg(writer.lastError()));
+        return;
+    }
+    statusBar()->showMessage(tr("Sweep exported to %1 (%2 points)").arg(filename).arg(k), 5000);
+}
+
+void MainWindow::onToggleProfiling(bool enabled)
+{
+    // A new recording starts from an empty log
+    if (enabled) {
+        Profiler::reset();
+    }
+    Profiler::setEnabled(enabled);
+    statusBar()->showMessage(enabled ? tr("Recording profile...")
+                                     : tr("Profile recording stopped (%1 events)")
+                                           .arg(Profiler::eventCount()), 3000);
+}
+
+void MainWindow::onExportProfileTrace()
+{
+    if (Profiler::eventCount() == 0) {
+        QMessageBox::information(this, tr("Export Profile Trace"),
+            tr("Nothing recorded yet. Enable Tools > Record Profile and use the chart first."));
+        return;
+    }
+    
+    QString filename = QFileDialog::getSaveFileName(
+        this,
+        tr("Export Profile Trace"),
+        QString("smithtool-trace.json"),
+        tr("Chrome Trace (*.json);;All Files (*)")
+    );
+    if (filename.isEmpty()) {
+        return;
+    }
+    
+    if (!Profiler::writeChromeTrace(filename)) {
+        QMessageBox::warning(this, tr("Export Profile Trace"),
+            tr("Failed to write %1").arg(filename));
+        return;
+    }
+    statusBar()->showMessage(tr("Profile trace written to %1 (open in chrome://tracing or Perfetto)")
+                                 .arg(filename), 5000);
+}
+
 void MainWindow::onExportSpice()
 {
-    if (m_matchingTrace.numSegments() == 0) {
+    if (m_matchingTrace->numSegments() == 0) {
         QMessageBox::information(this, tr("Export SPICE Netlist"),
             tr("No matching network to export. Please add some elements first."));
         return;
@@ -906,9 +2404,9 @@ void MainWindow::onExportSpice()
     exporter.setFrequencyRange(centerFreq / 10.0, centerFreq * 10.0, 101);
     
     // Configure matching trace with proper parameters
-    MatchingTrace exportTrace = m_matchingTrace;
+    MatchingTrace exportTrace = *m_matchingTrace;
     exportTrace.setSourceImpedance(m_sourceZ);
-    exportTrace.setLoadImpedance(m_loadZ);
+    exportTrace.setLoadImpedance(m_measuredLoadZ.empty() ? m_loadZ : m_matchingTrace->loadImpedance());
     exportTrace.setZ0(m_componentPanel->z0());
     exportTrace.setFrequency(centerFreq);
     
@@ -921,4 +2419,60 @@ void MainWindow::onExportSpice()
     }
 }
 
+void MainWindow::onExportSpiceCorners()
+{
+    if (m_matchingTrace->numSegments() == 0) {
+        QMessageBox::information(this, tr("Export SPICE Corners"),
+            tr("No matching network to export. Please add some elements first."));
+        return;
+    }
+    
+    QString path = QFileDialog::getSaveFileName(
+        this,
+        tr("Export SPICE Corners"),
+        QString(),
+        tr("Subcircuit Library (*.lib);;Netlist Directory (*)")
+    );
+    
+    if (path.isEmpty()) {
+        return;
+    }
+    
+    // Same tolerances as the Monte Carlo run
+    MonteCarloSettings defaults;
+    SpiceNetwork nominal = SpiceNetwork::fromTrace(*m_matchingTrace, "match");
+    std::vector<ToleranceSpec> tolerances;
+    tolerances.reserve(nominal.elements.size());
+    for (const ElementSpec& elem : nominal.elements) {
+        switch (elem.type) {
+            case ComponentType::Inductor:  tolerances.push_back(defaults.inductor); break;
+            case ComponentType::Capacitor: tolerances.push_back(defaults.capacitor); break;
+            case ComponentType::Resistor:  tolerances.push_back(defaults.resistor); break;
+            default:                       tolerances.push_back(ToleranceSpec()); break;
+        }
+    }
+    
+    std::vector<SpiceNetwork> corners = SpiceExporter::toleranceCorners(nominal, tolerances);
+    if (corners.empty()) {
+        QMessageBox::warning(this, tr("Export SPICE Corners"),
+            tr("Too many toleranced elements (at most %1).").arg(SpiceExporter::MAX_CORNER_ELEMENTS));
+        return;
+    }
+    
+    SpiceExporter exporter;
+    exporter.setZ0(m_componentPanel->z0());
+    exporter.setTitle("SmithTool Matching Network");
+    double centerFreq = m_matchingTrace->frequency();
+    exporter.setFrequencyRange(centerFreq / 10.0, centerFreq * 10.0, 101);
+    
+    SpiceBatchLayout layout = path.endsWith(".lib", Qt::CaseInsensitive)
+        ? SpiceBatchLayout::Library : SpiceBatchLayout::Directory;
+    QString error;
+    if (!exporter.exportBatch(corners, path, layout, error)) {
+        QMessageBox::warning(this, tr("Export Error"), error);
+        return;
+    }
+    statusBar()->showMessage(tr("%1 corners exported to %2").arg(corners.size()).arg(path), 5000);
+}
+
 } // namespace SmithTool
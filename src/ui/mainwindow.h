@@ -13,6 +13,12 @@
 #include <QDockWidget>
 #include <QFileDialog>
 #include <QSplitter>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <memory>
 
 #include "smithchartwidget.h"
 #include "componentpanel.h"
@@ -20,13 +26,27 @@
 #include "elementtoolbar.h"
 #include "circuitview.h"
 #include "matchingwizard.h"
+#include "tdrpanel.h"
+#include "twoportpanel.h"
+#include "bandpanel.h"
+#include "chartexporter.h"
 #include "../data/touchstone.h"
+#include "../data/touchstoneloader.h"
 #include "../core/trace.h"
 #include "../core/matching.h"
+#include "../core/sweep.h"
+#include "../core/montecarlo.h"
+#include "../core/edithistory.h"
 #include "../data/spiceexporter.h"
+#include "../data/acsolver.h"
+#include "../data/projectfile.h"
+#include "../data/livesweepsource.h"
+#include "../data/deembedder.h"
 
 namespace SmithTool {
 
+class ComponentEditDialog;
+
 /**
  * @brief Main application window
  */
@@ -37,12 +57,39 @@ public:
     explicit MainWindow(QWidget* parent = nullptr);
     ~MainWindow() override = default;
 
+signals:
+    /**
+     * @brief Emitted once, after the chart has been painted for the first time
+     */
+    void firstFramePainted();
+
+protected:
+    void dragEnterEvent(QDragEnterEvent* event) override;
+    void dropEvent(QDropEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
 private slots:
     void onOpenFile();
     void onSaveFile();
+    void onOpenProject();
+    void onSaveProject();
     void onExportImage();
+    void onExportReportImages();
+    void onReportExportFinished();
     void onAbout();
     
+    // Background file loading
+    void onFileLoaded(const QString& filename, std::shared_ptr<const SParamData> data);
+    void onPartialDataLoaded(const QString& filename, std::shared_ptr<const SParamData> preview,
+                             qint64 pointsRead);
+    void onToggleLowMemoryLoading(bool enabled);
+    void onFileLoadFailed(const QString& filename, const QString& error);
+    void onLoadProgress(int percent);
+    void onLoadingFinished();
+    void onClearOverlays();
+    void onToggleEnvelope(bool show);
+    void onEnvelopeFinished();
+    
     void onPointClicked(std::complex<double> gamma, std::complex<double> z);
     void onFrequencyChanged(double freq);
     void onZ0Changed(double z0);
@@ -52,6 +99,15 @@ private slots:
     void onToggleLabels(bool show);
     void onToggleQCircles(bool show);
     void onConfigureQCircles();
+    void onSelectSParamTrace(QAction* action);
+    void onToggleSweep(bool show);
+    void onConfigureSweep();
+    void onToggleMeasuredLoad(bool enabled);
+    void onToggleLiveInput(bool enabled);
+    void onLiveSweep();
+    void onLiveFailed(const QString& error);
+    void onToggleProfiling(bool enabled);
+    void onExportProfileTrace();
     
     // Element toolbar slots
     void onAddSeriesR();
@@ -62,6 +118,8 @@ private slots:
     void onAddShuntC();
     void onRemoveLastElement();
     void onClearElements();
+    void onUndo();
+    void onRedo();
     
     // Impedance input slots
     void onSourceImpedanceChanged(std::complex<double> zs);
@@ -69,6 +127,13 @@ private slots:
     
     // Matching wizard
     void onOpenMatchingWizard();
+    void onOptimizeNetwork();
+    void onMonteCarloYield();
+    void onMonteCarloFinished();
+    void onSimulateSParams();
+    void onDeembedFixtures();
+    void onPortExtension();
+    void onRenormalize();
     void onApplyMatchingSolution(const MatchingSolution& solution);
     
     // Target point selection
@@ -86,6 +151,8 @@ private slots:
     
     // Export functions
     void onExportSpice();
+    void onExportSpiceCorners();
+    void onExportSweep();
 
 private:
     void setupUI();
@@ -94,10 +161,30 @@ private:
     void setupStatusBar();
     void connectSignals();
     
-    void loadTouchstoneFile(const QString& filename);
+    void loadTouchstoneFiles(const QStringList& filenames);
+    void openProject(const QString& filename);
+    QVariantMap projectSettings() const;
+    void applyProjectSettings(const QVariantMap& settings);
+    void rebuildSParamTraceMenu();
     void updateStatusBar();
     void addMatchingElement(ComponentType type, ConnectionType conn);
     void updateTraces();
+    void invalidateNetworkResults();    // Bumps m_networkRevision, drops the cloud
+    void syncCircuitView();
+    void updateUndoActions();
+    void updateSweep();
+    void updateMeasuredLoad();
+    void updateEnvelope();
+    void showCorrectedData(SParamData&& data, const QString& message);
+    void applyLoadImpedance(const std::complex<double>& zl);
+    MatchingWizard* matchingWizard();
+    ComponentEditDialog* componentEditDialog();
+    QDockWidget* tdrDock();
+    QDockWidget* twoPortDock();
+    QDockWidget* bandDock();
+    void adoptDockAction(QAction* placeholder, QDockWidget* dock);
+    void updateDataPanels();
+    void onFirstFramePainted();
     
     // Central widget with splitter
     QSplitter* m_splitter;
@@ -110,31 +197,120 @@ private:
     QDockWidget* m_impedanceDock;
     ImpedanceInputPanel* m_impedancePanel;
     
+    // Analysis docks, created on first use (null until then)
+    QDockWidget* m_tdrDock;
+    TdrPanel* m_tdrPanel;
+    QDockWidget* m_twoPortDock;
+    TwoPortPanel* m_twoPortPanel;
+    QDockWidget* m_bandDock;
+    BandPanel* m_bandPanel;
+    
     // Toolbars
     ElementToolbar* m_elementToolbar;
     
-    // Matching network
-    MatchingTrace m_matchingTrace;
+    // Dialogs, created on first use and then reused
+    MatchingWizard* m_matchingWizard;
+    ComponentEditDialog* m_componentEditDialog;
+    
+    // Matching network (shared with the Smith chart, never copied per frame)
+    std::shared_ptr<MatchingTrace> m_matchingTrace;
     std::complex<double> m_sourceZ;
     std::complex<double> m_loadZ;
     
-    // Current data
-    SParamData m_currentData;
+    // Undo/redo of network edits (commands, not trace copies)
+    EditHistory m_history;
+    
+    // Frequency sweep of the matching network (start 0 = around design f)
+    double m_sweepStart;
+    double m_sweepStop;
+    int m_sweepPoints;
+    std::shared_ptr<const SweepResult> m_sweepResult;   // Shown sweep, or null
+    
+    // Measured S11 of the loaded data used as a frequency-dependent load
+    std::vector<std::complex<double>> m_measuredLoadZ;
+    
+    // Current data (shared with the Smith chart, never null)
+    std::shared_ptr<const SParamData> m_currentData;
     QString m_currentFile;
     
+    // Background loading
+    TouchstoneLoader* m_loader;
+    QProgressBar* m_loadProgress;
+    QPushButton* m_cancelLoadButton;
+    QStringList m_loadErrors;
+    
+    // Live VNA sweeps, shown as the S-parameter trace while running
+    LiveSweepSource* m_liveSource;
+    QElapsedTimer m_liveClock;
+    quint64 m_liveShown;        // Sweeps drawn since the last rate update
+    QString m_previewFile;      // Streamed file whose preview the chart shows
+    
+    // Files of a multi-file load, shown as overlays when they arrive
+    QSet<QString> m_pendingOverlays;
+    int m_overlayPorts;
+    
+    // Statistical envelope of the overlays, computed in the background
+    using EnvelopeWatcher = QFutureWatcher<std::shared_ptr<const SParamEnvelope>>;
+    EnvelopeWatcher* m_envelopeWatcher;
+    QElapsedTimer m_envelopeClock;
+    bool m_envelopePending;     // Inputs changed while it was computed
+    
+    // Monte Carlo yield of the matching network, run in the background
+    using MonteCarloWatcher = QFutureWatcher<std::shared_ptr<const MonteCarloResult>>;
+    MonteCarloWatcher* m_monteCarloWatcher;
+    QElapsedTimer m_monteCarloClock;
+    quint64 m_networkRevision;      // Bumped on every network edit
+    quint64 m_monteCarloRevision;   // Network revision the running job evaluates
+    
+    // Offscreen chart export; report batches run on the thread pool
+    ChartExporter m_chartExporter;
+    using ReportWatcher = QFutureWatcher<ChartExportResult>;
+    ReportWatcher* m_reportWatcher;
+    QElapsedTimer m_reportClock;
+    
     // Actions
     QAction* m_openAction;
     QAction* m_saveAction;
+    QAction* m_openProjectAction;
+    QAction* m_saveProjectAction;
+    QAction* m_lowMemoryAction;
     QAction* m_exportAction;
+    QAction* m_exportReportAction;
     QAction* m_exitAction;
+    QAction* m_undoAction;
+    QAction* m_redoAction;
     QAction* m_admittanceAction;
     QAction* m_vswrAction;
     QAction* m_labelsAction;
     QAction* m_qCirclesAction;
     QAction* m_configureQCirclesAction;
     QAction* m_matchingWizardAction;
+    QAction* m_optimizeAction;
+    QAction* m_monteCarloAction;
+    QAction* m_simulateAction;
+    QAction* m_deembedAction;
+    QAction* m_portExtensionAction;
+    QAction* m_renormalizeAction;
+    QAction* m_sweepAction;
+    QAction* m_configureSweepAction;
+    QAction* m_measuredLoadAction;
+    QAction* m_liveAction;
     QAction* m_aboutAction;
     QAction* m_exportSpiceAction;
+    QAction* m_exportSpiceCornersAction;
+    QAction* m_exportSweepAction;
+    QAction* m_hudAction;
+    QAction* m_gpuRenderingAction;
+    QAction* m_profileAction;
+    QAction* m_exportTraceAction;
+    QAction* m_tdrAction;           // Stand in for the lazy docks' toggle actions
+    QAction* m_twoPortAction;
+    QAction* m_bandAction;
+    QMenu* m_viewMenu;
+    QMenu* m_sparamTraceMenu;
+    QActionGroup* m_sparamTraceGroup;
+    QAction* m_clearOverlaysAction;
+    QAction* m_envelopeAction;
 };
 
 } // namespace SmithTool
@@ -6,18 +6,77 @@
 #include "matchingwizard.h"
 #include <QHeaderView>
 #include <QDoubleValidator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileDialog>
 #include <QMessageBox>
+#include <QtConcurrent>
+#include <algorithm>
+#include <tuple>
 
 namespace SmithTool {
 
+namespace {
+
+// Standard-value combo entries after "Ideal"
+const ESeries SERIES_ITEMS[] = {
+    ESeries::E6, ESeries::E12, ESeries::E24, ESeries::E48, ESeries::E96
+};
+const int SERIES_COUNT = sizeof(SERIES_ITEMS) / sizeof(SERIES_ITEMS[0]);
+const int VENDOR_INDEX = SERIES_COUNT + 1;
+
+// Wider windows for the finer series keep a similar tolerance span
+int searchWindow(ESeries series)
+{
+    switch (series) {
+        case ESeries::E48: return 4;
+        case ESeries::E96: return 6;
+        default: return 2;
+    }
+}
+
+} // namespace
+
 MatchingWizard::MatchingWizard(QWidget* parent)
     : QDialog(parent)
+    , m_selectedSource(-1, -1)
+    , m_seriesIndex(0)
+    , m_vendorGeneration(0)
+    , m_generation(0)
 {
+    for (int f = 0; f < FAMILY_COUNT; ++f) {
+        m_requested[f] = false;
+        m_available[f] = false;
+    }
+    
+    m_recalcTimer.setSingleShot(true);
+    m_recalcTimer.setInterval(RECALC_DELAY_MS);
+    connect(&m_recalcTimer, &QTimer::timeout, this, &MatchingWizard::onCalculate);
+    
     setupUI();
     setWindowTitle(tr("Impedance Matching Design"));
     resize(600, 500);
 }
 
+MatchingWizard::~MatchingWizard()
+{
+    // Tasks only touch their own copies, but do not leave them running
+    for (Watcher* watcher : m_watchers) {
+        watcher->disconnect(this);
+        watcher->cancel();
+        watcher->waitForFinished();
+    }
+}
+
+bool MatchingWizard::TaskKey::operator<(const TaskKey& other) const
+{
+    return std::tie(sourceR, sourceX, loadR, loadX, frequency, z0, q,
+                    family, series, bandwidth, vendorGeneration) <
+           std::tie(other.sourceR, other.sourceX, other.loadR, other.loadX, other.frequency,
+                    other.z0, other.q, other.family, other.series, other.bandwidth,
+                    other.vendorGeneration);
+}
+
 void MatchingWizard::setupUI()
 {
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
@@ -71,10 +130,46 @@ void MatchingWizard::setupUI()
         tr("Pi-Network"),
         tr("T-Network")
     });
-    inputLayout->addWidget(m_topologyCombo, 4, 1, 1, 3);
+    connect(m_topologyCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MatchingWizard::onTopologyChanged);
+    inputLayout->addWidget(m_topologyCombo, 4, 1);
+    
+    inputLayout->addWidget(new QLabel(tr("Pi/T Q:")), 4, 2);
+    m_qEdit = new QLineEdit("2");
+    m_qEdit->setValidator(new QDoubleValidator(0.01, 1000, 3, this));
+    m_qEdit->setToolTip(tr("Loaded Q of the Pi and T networks"));
+    inputLayout->addWidget(m_qEdit, 4, 3);
+    
+    // Standard component values
+    inputLayout->addWidget(new QLabel(tr("Component values:")), 5, 0);
+    m_seriesCombo = new QComboBox();
+    m_seriesCombo->addItem(tr("Ideal"));
+    for (ESeries series : SERIES_ITEMS) {
+        m_seriesCombo->addItem(PartCatalog::seriesName(series));
+    }
+    m_seriesCombo->addItem(tr("Vendor List..."));
+    m_seriesCombo->setToolTip(tr("Snap L/C values to a standard series or a part list and pick "
+                                 "the combination with the best worst-case return loss"));
+    connect(m_seriesCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MatchingWizard::onStandardValuesChanged);
+    inputLayout->addWidget(m_seriesCombo, 5, 1);
+    
+    inputLayout->addWidget(new QLabel(tr("Bandwidth (%):")), 5, 2);
+    m_bandwidthEdit = new QLineEdit("10");
+    m_bandwidthEdit->setValidator(new QDoubleValidator(0, 200, 2, this));
+    m_bandwidthEdit->setToolTip(tr("Band for the worst-case return loss, centered on the design frequency"));
+    inputLayout->addWidget(m_bandwidthEdit, 5, 3);
     
     mainLayout->addWidget(inputGroup);
     
+    // Editing any input cancels running work and recalculates after a pause
+    for (QLineEdit* edit : {m_sourceREdit, m_sourceXEdit, m_loadREdit, m_loadXEdit,
+                            m_freqEdit, m_z0Edit, m_qEdit, m_bandwidthEdit}) {
+        connect(edit, &QLineEdit::textEdited, this, &MatchingWizard::onInputEdited);
+    }
+    connect(m_freqUnitCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MatchingWizard::onInputEdited);
+    
     // Calculate button
     m_calculateBtn = new QPushButton(tr("Calculate Matching Networks"));
     connect(m_calculateBtn, &QPushButton::clicked, this, &MatchingWizard::onCalculate);
@@ -85,9 +180,9 @@ void MatchingWizard::setupUI()
     QVBoxLayout* resultsLayout = new QVBoxLayout(resultsGroup);
     
     m_resultsTable = new QTableWidget();
-    m_resultsTable->setColumnCount(4);
+    m_resultsTable->setColumnCount(5);
     m_resultsTable->setHorizontalHeaderLabels({
-        tr("Topology"), tr("Elements"), tr("Q"), tr("Description")
+        tr("Topology"), tr("Elements"), tr("Q"), tr("Worst RL (dB)"), tr("Description")
     });
     m_resultsTable->horizontalHeader()->setStretchLastSection(true);
     m_resultsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -143,8 +238,34 @@ void MatchingWizard::setZ0(double z0)
     m_z0Edit->setText(QString::number(z0, 'f', 1));
 }
 
+void MatchingWizard::refreshResults()
+{
+    if (!m_statusLabel->text().isEmpty() || m_recalcTimer.isActive()) {
+        onCalculate();
+    }
+}
+
+void MatchingWizard::onInputEdited()
+{
+    cancelPending();
+    m_statusLabel->setText(tr("Waiting for input..."));
+    m_recalcTimer.start();
+}
+
+void MatchingWizard::cancelPending()
+{
+    // Cancelled tasks stop between solutions; their watchers clean up
+    for (Watcher* watcher : m_watchers) {
+        watcher->cancel();
+    }
+    ++m_generation;
+}
+
 void MatchingWizard::onCalculate()
 {
+    m_recalcTimer.stop();
+    cancelPending();
+    
     // Parse input values
     double sourceR = m_sourceREdit->text().toDouble();
     double sourceX = m_sourceXEdit->text().toDouble();
@@ -152,6 +273,8 @@ void MatchingWizard::onCalculate()
     double loadX = m_loadXEdit->text().toDouble();
     double freqVal = m_freqEdit->text().toDouble();
     double z0 = m_z0Edit->text().toDouble();
+    double q = m_qEdit->text().toDouble();
+    if (q <= 0.0) q = 2.0;
     
     // Convert frequency to Hz
     double freqMult = 1e9;  // Default GHz
@@ -167,34 +290,202 @@ void MatchingWizard::onCalculate()
     m_calculator.setLoadImpedance(std::complex<double>(loadR, loadX));
     m_calculator.setFrequency(freq);
     m_calculator.setZ0(z0);
+    configureOptimizer();
     
-    // Calculate solutions based on selected topology
-    m_solutions.clear();
-    int topoIndex = m_topologyCombo->currentIndex();
+    // One task per family; cached families are shown right away
+    const int topoIndex = m_topologyCombo->currentIndex();
+    const int generation = m_generation;
+    m_selectedSource = QPoint(-1, -1);
+    m_runTimer.start();
     
-    if (topoIndex == 0 || topoIndex == 1) {
-        auto lsec = m_calculator.calculateLSection();
-        m_solutions.insert(m_solutions.end(), lsec.begin(), lsec.end());
+    for (int family = 0; family < FAMILY_COUNT; ++family) {
+        m_requested[family] = (topoIndex == 0 || topoIndex == family + 1);
+        m_available[family] = false;
+        m_results[family] = FamilyResult();
+        if (!m_requested[family]) continue;
+        
+        TaskKey key = {sourceR, sourceX, loadR, loadX, freq, z0, q, family,
+                       m_seriesCombo->currentIndex(), m_bandwidthEdit->text().toDouble(),
+                       (m_seriesCombo->currentIndex() == VENDOR_INDEX) ? m_vendorGeneration : 0};
+        
+        auto cached = m_cache.find(key);
+        if (cached != m_cache.end()) {
+            m_results[family] = cached->second;
+            m_available[family] = true;
+            continue;
+        }
+        
+        Watcher* watcher = new Watcher(this);
+        connect(watcher, &Watcher::finished, this, [this, watcher, key, generation]() {
+            onFamilyFinished(watcher, key, generation);
+        });
+        m_watchers.push_back(watcher);
+        watcher->setFuture(QtConcurrent::run(&MatchingWizard::computeFamily,
+                                             m_calculator, m_optimizer, family, q));
     }
-    if (topoIndex == 0 || topoIndex == 2) {
-        auto pi = m_calculator.calculatePiNetwork();
-        m_solutions.insert(m_solutions.end(), pi.begin(), pi.end());
+    
+    updateResults();
+}
+
+void MatchingWizard::computeFamily(QPromise<FamilyResult>& promise, MatchingCalculator calculator,
+                                   StandardValueOptimizer optimizer, int family, double q)
+{
+    std::vector<MatchingSolution> ideal;
+    switch (family) {
+        case FamilyL: ideal = calculator.calculateLSection(); break;
+        case FamilyPi: ideal = calculator.calculatePiNetwork(q); break;
+        case FamilyT: ideal = calculator.calculateTNetwork(q); break;
     }
-    if (topoIndex == 0 || topoIndex == 3) {
-        auto t = m_calculator.calculateTNetwork();
-        m_solutions.insert(m_solutions.end(), t.begin(), t.end());
+    
+    // Ideal values are evaluated with empty catalogs (one combination each)
+    FamilyResult result;
+    for (const MatchingSolution& solution : ideal) {
+        if (promise.isCanceled()) return;
+        
+        // The search itself stops as soon as the inputs change
+        StandardValueResult snapped = optimizer.optimize(solution, [&promise]() {
+            return promise.isCanceled();
+        });
+        if (promise.isCanceled()) return;
+        if (!snapped.valid) {
+            result.solutions.push_back(solution);
+            result.worstReturnLoss.push_back(0.0);
+            continue;
+        }
+        result.solutions.push_back(snapped.solution);
+        result.worstReturnLoss.push_back(snapped.worstReturnLoss);
+        result.combinations += snapped.combinations;
+        result.evaluated += snapped.evaluated;
     }
+    promise.addResult(std::move(result));
+}
+
+void MatchingWizard::onFamilyFinished(Watcher* watcher, const TaskKey& key, int generation)
+{
+    m_watchers.erase(std::remove(m_watchers.begin(), m_watchers.end(), watcher),
+                     m_watchers.end());
+    watcher->deleteLater();
     
+    QFuture<FamilyResult> future = watcher->future();
+    if (future.isCanceled() || future.resultCount() == 0) return;
+    
+    // Finished work is cached even if the inputs have moved on since
+    FamilyResult result = future.takeResult();
+    storeInCache(key, result);
+    if (generation != m_generation) return;
+    
+    m_results[key.family] = std::move(result);
+    m_available[key.family] = true;
     updateResults();
 }
 
+void MatchingWizard::storeInCache(const TaskKey& key, const FamilyResult& result)
+{
+    if (m_cache.find(key) != m_cache.end()) return;
+    
+    m_cache.emplace(key, result);
+    m_cacheOrder.push_back(key);
+    while (static_cast<int>(m_cacheOrder.size()) > CACHE_LIMIT) {
+        m_cache.erase(m_cacheOrder.front());
+        m_cacheOrder.pop_front();
+    }
+}
+
+void MatchingWizard::onStandardValuesChanged()
+{
+    if (m_seriesCombo->currentIndex() == VENDOR_INDEX && m_seriesIndex != VENDOR_INDEX) {
+        if (!loadVendorList()) {
+            // Keep the previous choice
+            QSignalBlocker blocker(m_seriesCombo);
+            m_seriesCombo->setCurrentIndex(m_seriesIndex);
+            return;
+        }
+    }
+    m_seriesIndex = m_seriesCombo->currentIndex();
+    onCalculate();
+}
+
+bool MatchingWizard::loadVendorList()
+{
+    QString filename = QFileDialog::getOpenFileName(this, tr("Open Part List"), QString(),
+        tr("Part Lists (*.txt *.csv);;All Files (*)"));
+    if (filename.isEmpty()) return false;
+    
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, tr("Part List"), tr("Cannot open %1").arg(filename));
+        return false;
+    }
+    
+    QString error;
+    PartCatalog inductors, capacitors;
+    if (!PartCatalog::parseVendorList(QString::fromUtf8(file.readAll()),
+                                      inductors, capacitors, error)) {
+        QMessageBox::warning(this, tr("Part List"), error);
+        return false;
+    }
+    if (inductors.isEmpty() && capacitors.isEmpty()) {
+        QMessageBox::warning(this, tr("Part List"), tr("No values found in %1").arg(filename));
+        return false;
+    }
+    
+    m_vendorInductors = inductors;
+    m_vendorCapacitors = capacitors;
+    ++m_vendorGeneration;
+    return true;
+}
+
+void MatchingWizard::configureOptimizer()
+{
+    const int index = m_seriesCombo->currentIndex();
+    if (index >= 1 && index <= SERIES_COUNT) {
+        ESeries series = SERIES_ITEMS[index - 1];
+        m_optimizer.setSeries(series);
+        m_optimizer.setSearchWindow(searchWindow(series));
+    } else if (index == VENDOR_INDEX) {
+        m_optimizer.setInductorCatalog(m_vendorInductors);
+        m_optimizer.setCapacitorCatalog(m_vendorCapacitors);
+        m_optimizer.setSearchWindow(searchWindow(ESeries::E24));
+    } else {
+        m_optimizer.setInductorCatalog(PartCatalog());
+        m_optimizer.setCapacitorCatalog(PartCatalog());
+    }
+    m_optimizer.setBand(m_bandwidthEdit->text().toDouble() / 100.0);
+    m_optimizer.setZ0(m_calculator.z0());
+}
+
 void MatchingWizard::updateResults()
 {
+    // Rows in family order, whatever order the tasks finish in
+    m_solutions.clear();
+    m_rowSource.clear();
+    std::vector<double> worstReturnLoss;
+    int requested = 0, available = 0;
+    long long combinations = 0, evaluated = 0;
+    
+    for (int family = 0; family < FAMILY_COUNT; ++family) {
+        if (!m_requested[family]) continue;
+        ++requested;
+        if (!m_available[family]) continue;
+        ++available;
+        
+        const FamilyResult& result = m_results[family];
+        for (size_t i = 0; i < result.solutions.size(); ++i) {
+            m_solutions.push_back(result.solutions[i]);
+            m_rowSource.push_back(QPoint(family, static_cast<int>(i)));
+            worstReturnLoss.push_back(result.worstReturnLoss[i]);
+        }
+        combinations += result.combinations;
+        evaluated += result.evaluated;
+    }
+    
     m_resultsTable->setRowCount(static_cast<int>(m_solutions.size()));
+    int selectedRow = -1;
     
     for (size_t i = 0; i < m_solutions.size(); ++i) {
         const auto& sol = m_solutions[i];
         int row = static_cast<int>(i);
+        if (m_rowSource[i] == m_selectedSource) selectedRow = row;
         
         // Topology
         m_resultsTable->setItem(row, 0, 
@@ -208,21 +499,43 @@ void MatchingWizard::updateResults()
         m_resultsTable->setItem(row, 2, 
             new QTableWidgetItem(QString::number(sol.networkQ(), 'f', 2)));
         
-        // Description
+        // Worst-case return loss over the band
         m_resultsTable->setItem(row, 3, 
+            new QTableWidgetItem(QString::number(worstReturnLoss[i], 'f', 2)));
+        
+        // Description
+        m_resultsTable->setItem(row, 4, 
             new QTableWidgetItem(sol.toDescription()));
     }
     
     m_resultsTable->resizeColumnsToContents();
     
-    if (m_solutions.empty()) {
-        m_statusLabel->setText(tr("No matching solutions found."));
+    // Keep the selection while later families stream in
+    if (selectedRow >= 0) {
+        m_resultsTable->selectRow(selectedRow);
     } else {
-        m_statusLabel->setText(tr("Found %1 solution(s).").arg(m_solutions.size()));
+        m_resultsTable->clearSelection();
+        m_selectedSource = QPoint(-1, -1);
+        m_selectedSolution = MatchingSolution();
+        m_applyBtn->setEnabled(false);
     }
     
-    m_selectedSolution = MatchingSolution();
-    m_applyBtn->setEnabled(false);
+    if (available < requested) {
+        m_statusLabel->setText(tr("Calculating... %1 of %2 topologies done, %3 solution(s) so far.")
+            .arg(available).arg(requested).arg(m_solutions.size()));
+        return;
+    }
+    
+    QString status = m_solutions.empty()
+        ? tr("No matching solutions found.")
+        : tr("Found %1 solution(s) in %2 ms.").arg(m_solutions.size())
+              .arg(m_runTimer.nsecsElapsed() / 1e6, 0, 'f', 1);
+    if (m_seriesCombo->currentIndex() != 0 && !m_solutions.empty()) {
+        status += tr(" %1 values: %2 of %3 combinations evaluated.")
+            .arg(m_seriesCombo->currentText().remove("..."))
+            .arg(evaluated).arg(combinations);
+    }
+    m_statusLabel->setText(status);
 }
 
 void MatchingWizard::onSolutionSelected(int row, int column)
@@ -231,6 +544,7 @@ void MatchingWizard::onSolutionSelected(int row, int column)
     
     if (row >= 0 && row < static_cast<int>(m_solutions.size())) {
         m_selectedSolution = m_solutions[row];
+        m_selectedSource = m_rowSource[row];
         m_applyBtn->setEnabled(true);
     }
 }
@@ -246,7 +560,7 @@ void MatchingWizard::onApply()
 void MatchingWizard::onTopologyChanged(int index)
 {
     Q_UNUSED(index);
-    // Could trigger recalculation here
+    onCalculate();
 }
 
 QString MatchingWizard::topologyName(MatchingTopology topo) const
@@ -16,28 +16,51 @@
 #include <QPushButton>
 #include <QTableWidget>
 #include <QDialogButtonBox>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QPoint>
+#include <QPromise>
+#include <QTimer>
 #include <complex>
+#include <deque>
+#include <map>
 
 #include "../core/matching.h"
+#include "../core/standardvalues.h"
 
 namespace SmithTool {
 
 /**
  * @brief Dialog for impedance matching network design
+ *
+ * Every topology family (L, Pi, T) is calculated, and optionally snapped
+ * to standard values, by its own task on the global thread pool. Rows
+ * appear as each family finishes. Editing an input cancels the running
+ * tasks, and results are cached per input set so returning to earlier
+ * inputs is instant.
  */
 class MatchingWizard : public QDialog {
     Q_OBJECT
 
 public:
     explicit MatchingWizard(QWidget* parent = nullptr);
-    ~MatchingWizard() override = default;
-
+    ~MatchingWizard() override;
+    
     // Set initial values
     void setSourceImpedance(const std::complex<double>& zs);
     void setLoadImpedance(const std::complex<double>& zl);
     void setFrequency(double freq_hz);
     void setZ0(double z0);
     
+    /**
+     * @brief Recalculate results shown from an earlier opening
+     *
+     * The dialog is reused between openings; call after the setters so
+     * old solutions never show against new inputs. Repeated inputs are
+     * served from the result cache.
+     */
+    void refreshResults();
+    
     // Get selected solution
     MatchingSolution selectedSolution() const { return m_selectedSolution; }
     bool hasValidSelection() const { return m_selectedSolution.valid; }
@@ -50,12 +73,57 @@ private slots:
     void onSolutionSelected(int row, int column);
     void onApply();
     void onTopologyChanged(int index);
+    void onStandardValuesChanged();
+    void onInputEdited();
 
 private:
     void setupUI();
     void updateResults();
+    bool loadVendorList();
+    void configureOptimizer();
+    void cancelPending();
     QString topologyName(MatchingTopology topo) const;
     
+    enum Family {
+        FamilyL,
+        FamilyPi,
+        FamilyT,
+        FAMILY_COUNT
+    };
+    
+    /**
+     * @brief Solutions of one topology family for one set of inputs
+     */
+    struct FamilyResult {
+        std::vector<MatchingSolution> solutions;    // Ideal or snapped
+        std::vector<double> worstReturnLoss;        // Over the band, per solution
+        long long combinations = 0;
+        long long evaluated = 0;
+    };
+    
+    /**
+     * @brief Everything a family result depends on
+     *
+     * (Zs, ZL, f, Z0, Q), plus the standard-value settings, since snapped
+     * values are cached as well.
+     */
+    struct TaskKey {
+        double sourceR, sourceX, loadR, loadX, frequency, z0, q;
+        int family;
+        int series;
+        double bandwidth;
+        int vendorGeneration;
+        
+        bool operator<(const TaskKey& other) const;
+    };
+    
+    using Watcher = QFutureWatcher<FamilyResult>;
+    
+    static void computeFamily(QPromise<FamilyResult>& promise, MatchingCalculator calculator,
+                              StandardValueOptimizer optimizer, int family, double q);
+    void onFamilyFinished(Watcher* watcher, const TaskKey& key, int generation);
+    void storeInCache(const TaskKey& key, const FamilyResult& result);
+    
     // Input widgets
     QLineEdit* m_sourceREdit;
     QLineEdit* m_sourceXEdit;
@@ -65,6 +133,9 @@ private:
     QComboBox* m_freqUnitCombo;
     QLineEdit* m_z0Edit;
     QComboBox* m_topologyCombo;
+    QLineEdit* m_qEdit;
+    QComboBox* m_seriesCombo;
+    QLineEdit* m_bandwidthEdit;
     
     // Results
     QTableWidget* m_resultsTable;
@@ -77,8 +148,32 @@ private:
     
     // Calculator and results
     MatchingCalculator m_calculator;
-    std::vector<MatchingSolution> m_solutions;
+    std::vector<MatchingSolution> m_solutions;      // Table rows, ideal or snapped
+    std::vector<QPoint> m_rowSource;                // (family, index) of each row
     MatchingSolution m_selectedSolution;
+    QPoint m_selectedSource;                        // (-1, -1) = none
+    
+    // Standard-value snapping
+    StandardValueOptimizer m_optimizer;
+    PartCatalog m_vendorInductors;
+    PartCatalog m_vendorCapacitors;
+    int m_seriesIndex;
+    int m_vendorGeneration;
+    
+    // Background calculation of the current inputs
+    std::vector<Watcher*> m_watchers;
+    FamilyResult m_results[FAMILY_COUNT];
+    bool m_requested[FAMILY_COUNT];
+    bool m_available[FAMILY_COUNT];
+    int m_generation;
+    QTimer m_recalcTimer;       // Debounces typing
+    QElapsedTimer m_runTimer;
+    
+    // Results by input set, oldest evicted first
+    std::map<TaskKey, FamilyResult> m_cache;
+    std::deque<TaskKey> m_cacheOrder;
+    static constexpr int CACHE_LIMIT = 64;
+    static constexpr int RECALC_DELAY_MS = 250;
 };
 
 } // namespace SmithTool
@@ -4,21 +4,31 @@
  */
 
 #include "smithchartwidget.h"
+#include "../core/decimation.h"
+#include "../core/gridgeometry.h"
+#include "../core/profiler.h"
+#ifdef SMITHTOOL_ENABLE_OPENGL
+#include "chartglrenderer.h"
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#endif
 #include <QPainterPath>
+#include <QFontMetrics>
+#include <QRegion>
 #include <QToolTip>
 #include <QMenu>
 #include <QAction>
 #include <QIcon>
+#include <QScreen>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <algorithm>
 #include <cmath>
 
 namespace SmithTool {
 
-// Standard grid values
-const std::vector<double> SmithChartWidget::s_resistanceValues = {0, 0.2, 0.5, 1.0, 2.0, 5.0};
-const std::vector<double> SmithChartWidget::s_reactanceValues = {0.2, 0.5, 1.0, 2.0, 5.0};
-
 SmithChartWidget::SmithChartWidget(QWidget* parent)
-    : QWidget(parent)
+    : SmithChartBase(parent)
     , m_margin(40)
     , m_z0(50.0)
     , m_frequency(1e9)
@@ -43,19 +53,67 @@ SmithChartWidget::SmithChartWidget(QWidget* parent)
     , m_dragStartGamma(0, 0)
     , m_previewGamma(0, 0)
     , m_originalValue(0.0)
+    , m_dragPending(false)
+    , m_pendingDragValue(0.0)
     , m_zoomLevel(1.0)
     , m_panOffset(0, 0)
     , m_isPanning(false)
     , m_panStartPos(0, 0)
+    , m_sparamData(std::make_shared<SParamData>())
+    , m_sparamRow(0)
+    , m_sparamCol(0)
+    , m_sparamGeneration(1)
+    , m_matchingTrace(std::make_shared<MatchingTrace>())
+    , m_sweepGeneration(1)
+    , m_envelopeGeneration(1)
+    , m_twoPortIndex(-1)
+    , m_twoPortLayers(0)
+    , m_monteCarloGeneration(1)
+    , m_matchingGeneration(1)
+    , m_traceLabelFont("Arial", 8)
+    , m_hoverDataIndex(-1)
+    , m_layeredRendering(true)
+    , m_gridGeneration(0)
+    , m_hudVisible(false)
+    , m_hudPaintMs(0.0)
+    , m_dragInputNs(-1)
+    , m_dragLatencyMs(0.0)
+    , m_dragLatencyMaxMs(0.0)
+    , m_gpuRendering(isGpuRenderingAvailable())
+#ifdef SMITHTOOL_ENABLE_OPENGL
+    , m_glReady(false)
+    , m_glMinorPixelRadius(0.0)
+#endif
 {
+    std::fill(m_hudLayerMs, m_hudLayerMs + HUD_LAYER_COUNT, 0.0);
+    m_hudClock.start();
+    
     setMinimumSize(400, 400);
     setMouseTracking(true);
+
+#ifdef SMITHTOOL_ENABLE_OPENGL
+    // Multisampling stands in for QPainter's line antialiasing
+    QSurfaceFormat surfaceFormat = format();
+    surfaceFormat.setSamples(4);
+    setFormat(surfaceFormat);
+#endif
+
+    m_dragFrameTimer.setSingleShot(true);
+    m_dragFrameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_dragFrameTimer, &QTimer::timeout, this, &SmithChartWidget::flushPendingDrag);
     updateChartGeometry();
     
     // Default Q values
     m_qValues = {0.5, 1.0, 2.0, 5.0};
 }
 
+SmithChartWidget::~SmithChartWidget()
+{
+#ifdef SMITHTOOL_ENABLE_OPENGL
+    releaseGl();
+#endif
+}
+
 void SmithChartWidget::setZ0(double z0)
 {
     m_z0 = z0;
@@ -76,28 +134,188 @@ void SmithChartWidget::setChartMode(ChartMode mode)
 
 void SmithChartWidget::setSParamData(const SParamData& data)
 {
-    m_sparamData = data;
+    setSParamData(std::make_shared<SParamData>(data));
+}
+
+void SmithChartWidget::setSParamData(SParamData&& data)
+{
+    setSParamData(std::make_shared<SParamData>(std::move(data)));
+}
+
+void SmithChartWidget::setSParamData(std::shared_ptr<const SParamData> data)
+{
+    m_sparamData = data ? std::move(data) : std::make_shared<SParamData>();
+    ++m_sparamGeneration;
+    m_hoverDataIndex = -1;
     update();
 }
 
 void SmithChartWidget::clearSParamData()
 {
-    m_sparamData.clear();
+    m_sparamData = std::make_shared<SParamData>();
+    ++m_sparamGeneration;
+    m_hoverDataIndex = -1;
+    update();
+}
+
+void SmithChartWidget::setSParamTrace(int row, int col)
+{
+    m_sparamRow = row;
+    m_sparamCol = col;
+    ++m_sparamGeneration;
+    for (SParamOverlay& overlay : m_overlays) {
+        ++overlay.generation;
+    }
+    update();
+}
+
+int SmithChartWidget::addSParamData(std::shared_ptr<const SParamData> data, const QColor& color)
+{
+    if (!data) return -1;
+    
+    SParamOverlay overlay;
+    overlay.data = std::move(data);
+    return addOverlay(std::move(overlay), color);
+}
+
+int SmithChartWidget::addLazySParamData(SParamLoader loader, const QColor& color)
+{
+    if (!loader) return -1;
+    
+    SParamOverlay overlay;
+    overlay.loader = std::move(loader);
+    return addOverlay(std::move(overlay), color);
+}
+
+int SmithChartWidget::addOverlay(SParamOverlay overlay, const QColor& color)
+{
+    overlay.color = color;
+    if (!overlay.color.isValid()) {
+        // Golden-angle hue steps keep neighbouring overlays distinguishable
+        int hue = static_cast<int>(m_overlays.size() * 137) % 360;
+        overlay.color = QColor::fromHsv(hue, 160, 210);
+    }
+    m_overlays.push_back(std::move(overlay));
+    update();
+    return static_cast<int>(m_overlays.size()) - 1;
+}
+
+const SParamData* SmithChartWidget::overlayData(const SParamOverlay& overlay) const
+{
+    if (overlay.loader) {
+        // One attempt only: a failed load is not retried on every paint
+        SParamLoader loader = std::move(overlay.loader);
+        overlay.loader = nullptr;
+        overlay.data = loader();
+    }
+    return overlay.data.get();
+}
+
+void SmithChartWidget::removeSParamOverlay(int index)
+{
+    if (index < 0 || index >= sparamOverlayCount()) return;
+    m_overlays.erase(m_overlays.begin() + index);
+#ifdef SMITHTOOL_ENABLE_OPENGL
+    // GPU batches are per index: the overlays after it need re-uploading
+    for (std::size_t i = index; i < m_glOverlayStates.size(); ++i) {
+        m_glOverlayStates[i] = GlTraceState();
+    }
+#endif
+    update();
+}
+
+void SmithChartWidget::clearSParamOverlays()
+{
+    m_overlays.clear();
+#ifdef SMITHTOOL_ENABLE_OPENGL
+    std::fill(m_glOverlayStates.begin(), m_glOverlayStates.end(), GlTraceState());
+#endif
+    update();
+}
+
+std::shared_ptr<const SParamData> SmithChartWidget::sparamOverlayData(int index) const
+{
+    if (index < 0 || index >= sparamOverlayCount()) return nullptr;
+    overlayData(m_overlays[index]);
+    return m_overlays[index].data;
+}
+
+void SmithChartWidget::setSParamEnvelope(std::shared_ptr<const SParamEnvelope> envelope,
+                                         const QColor& color)
+{
+    m_envelope = std::move(envelope);
+    m_envelopeColor = color;
+    ++m_envelopeGeneration;
+    update();
+}
+
+void SmithChartWidget::clearSParamEnvelope()
+{
+    m_envelope.reset();
+    ++m_envelopeGeneration;
+    update();
+}
+
+void SmithChartWidget::setTwoPortCircles(std::shared_ptr<const TwoPortAnalysis> analysis,
+                                         int index, int layers)
+{
+    m_twoPort = std::move(analysis);
+    m_twoPortIndex = index;
+    m_twoPortLayers = layers;
+    update();
+}
+
+void SmithChartWidget::setMonteCarloResult(std::shared_ptr<const MonteCarloResult> result)
+{
+    m_monteCarlo = std::move(result);
+    ++m_monteCarloGeneration;
+    update();
+}
+
+void SmithChartWidget::clearMonteCarloResult()
+{
+    m_monteCarlo.reset();
+    ++m_monteCarloGeneration;
+    update();
+}
+
+void SmithChartWidget::setSParamOverlayColor(int index, const QColor& color)
+{
+    if (index < 0 || index >= sparamOverlayCount()) return;
+    m_overlays[index].color = color;
+    update();
+}
+
+QColor SmithChartWidget::sparamOverlayColor(int index) const
+{
+    if (index < 0 || index >= sparamOverlayCount()) return QColor();
+    return m_overlays[index].color;
+}
+
+void SmithChartWidget::setSParamOverlayVisible(int index, bool visible)
+{
+    if (index < 0 || index >= sparamOverlayCount()) return;
+    m_overlays[index].visible = visible;
     update();
 }
 
+bool SmithChartWidget::isSParamOverlayVisible(int index) const
+{
+    if (index < 0 || index >= sparamOverlayCount()) return false;
+    return m_overlays[index].visible;
+}
+
 void SmithChartWidget::setMarkerGamma(const Complex& gamma)
 {
+    const QRect before = markerBounds();
     m_markerGamma = gamma;
     m_markerVisible = true;
-    update();
+    updateBounds(before, markerBounds());
 }
 
 void SmithChartWidget::setMarkerImpedance(const Complex& z)
 {
-    m_markerGamma = SmithMath::impedanceToGamma(z, m_z0);
-    m_markerVisible = true;
-    update();
+    setMarkerGamma(SmithMath::impedanceToGamma(z, m_z0));
 }
 
 Complex SmithChartWidget::markerImpedance() const
@@ -107,28 +325,32 @@ Complex SmithChartWidget::markerImpedance() const
 
 void SmithChartWidget::setSourceImpedance(const Complex& zs)
 {
+    const QRect before = sourceMarkerBounds();
     m_sourceZ = zs;
     m_sourceVisible = true;
-    update();
+    updateBounds(before, sourceMarkerBounds());
 }
 
 void SmithChartWidget::setLoadImpedance(const Complex& zl)
 {
+    const QRect before = loadMarkerBounds();
     m_loadZ = zl;
     m_loadVisible = true;
-    update();
+    updateBounds(before, loadMarkerBounds());
 }
 
 void SmithChartWidget::clearSourceImpedance()
 {
+    const QRect before = sourceMarkerBounds();
     m_sourceVisible = false;
-    update();
+    updateBounds(before, QRect());
 }
 
 void SmithChartWidget::clearLoadImpedance()
 {
+    const QRect before = loadMarkerBounds();
     m_loadVisible = false;
-    update();
+    updateBounds(before, QRect());
 }
 
 void SmithChartWidget::setShowAdmittanceGrid(bool show)
@@ -158,41 +380,351 @@ void SmithChartWidget::setShowQCircles(bool show)
 void SmithChartWidget::setQValues(const std::vector<double>& qValues)
 {
     m_qValues = qValues;
+    ++m_gridGeneration;
+    update();
+}
+
+void SmithChartWidget::setLayeredRendering(bool enabled)
+{
+    m_layeredRendering = enabled;
+    if (!enabled) {
+        m_gridCache = QPixmap();  // Release the offscreen buffer
+    }
+    update();
+}
+
+void SmithChartWidget::setGpuRendering(bool enabled)
+{
+    m_gpuRendering = enabled && isGpuRenderingAvailable();
     update();
 }
 
+bool SmithChartWidget::isGpuRenderingAvailable()
+{
+#ifdef SMITHTOOL_ENABLE_OPENGL
+    return true;
+#else
+    return false;
+#endif
+}
+
+ChartScene SmithChartWidget::scene() const
+{
+    ChartScene scene;
+    scene.z0 = m_z0;
+    scene.chartMode = m_chartMode;
+    scene.showAdmittanceGrid = m_showAdmittanceGrid;
+    scene.showVSWRCircles = m_showVSWRCircles;
+    scene.showLabels = m_showLabels;
+    scene.showQCircles = m_showQCircles;
+    scene.vswrCircles = m_vswrCircles;
+    scene.qValues = m_qValues;
+    
+    scene.data = m_sparamData;
+    scene.sparamRow = m_sparamRow;
+    scene.sparamCol = m_sparamCol;
+    for (const SParamOverlay& overlay : m_overlays) {
+        if (!overlay.visible || !overlayData(overlay)) continue;
+        scene.overlays.push_back({overlay.data, overlay.color});
+    }
+    scene.sweep = m_sweepResult;
+    
+    // Generate the points now so renderers on other threads only read them
+    if (m_matchingTrace->numSegments() > 0) {
+        auto trace = std::make_shared<MatchingTrace>(*m_matchingTrace);
+        trace->segments();
+        scene.matchingTrace = std::move(trace);
+    }
+    
+    scene.sourceZ = m_sourceZ;
+    scene.loadZ = m_loadZ;
+    scene.sourceVisible = m_sourceVisible;
+    scene.loadVisible = m_loadVisible;
+    scene.markerGamma = m_markerGamma;
+    scene.markerVisible = m_markerVisible;
+    return scene;
+}
+
 void SmithChartWidget::setMatchingTrace(const MatchingTrace& trace)
 {
-    m_matchingTrace = trace;
+    m_matchingTrace = std::make_shared<MatchingTrace>(trace);
+    ++m_matchingGeneration;
+    update();
+}
+
+void SmithChartWidget::setMatchingTrace(std::shared_ptr<const MatchingTrace> trace)
+{
+    m_matchingTrace = trace ? std::move(trace) : std::make_shared<MatchingTrace>();
+    ++m_matchingGeneration;
     update();
 }
 
 void SmithChartWidget::clearMatchingTrace()
 {
-    m_matchingTrace.clear();
+    // Drop our reference rather than clearing a trace that may be shared
+    m_matchingTrace = std::make_shared<MatchingTrace>();
+    ++m_matchingGeneration;
+    update();
+}
+
+void SmithChartWidget::setSweepResult(std::shared_ptr<const SweepResult> result)
+{
+    m_sweepResult = std::move(result);
+    ++m_sweepGeneration;
+    update();
+}
+
+void SmithChartWidget::clearSweepResult()
+{
+    m_sweepResult.reset();
+    ++m_sweepGeneration;
     update();
 }
 
 void SmithChartWidget::addVSWRCircle(double vswr)
 {
     m_vswrCircles.push_back(vswr);
+    ++m_gridGeneration;
     update();
 }
 
 void SmithChartWidget::clearVSWRCircles()
 {
     m_vswrCircles.clear();
+    ++m_gridGeneration;
     update();
 }
 
+#ifdef SMITHTOOL_ENABLE_OPENGL
+void SmithChartWidget::initializeGL()
+{
+    // A new context (e.g. after reparenting) starts with no buffers
+    releaseGl();
+    m_glRenderer = std::make_unique<ChartGlRenderer>();
+    m_glReady = m_glRenderer->initialize();
+    connect(context(), &QOpenGLContext::aboutToBeDestroyed,
+            this, &SmithChartWidget::releaseGl, Qt::UniqueConnection);
+}
+
+void SmithChartWidget::paintGL()
+{
+    paintChart();
+}
+#else
 void SmithChartWidget::paintEvent(QPaintEvent* event)
 {
     Q_UNUSED(event);
+    paintChart();
+}
+#endif
+
+void SmithChartWidget::paintChart()
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::paintEvent");
     
+    // Per-layer times for the HUD (not measured while it is hidden)
+    const qint64 paintStart = m_hudClock.nsecsElapsed();
+    qint64 layerStart = paintStart;
+    std::fill(m_hudLayerMs, m_hudLayerMs + HUD_LAYER_COUNT, 0.0);
+    auto endLayer = [&](HudLayer layer) {
+        if (!m_hudVisible) return;
+        qint64 now = m_hudClock.nsecsElapsed();
+        m_hudLayerMs[layer] += (now - layerStart) / 1e6;
+        layerStart = now;
+    };
+
+#ifdef SMITHTOOL_ENABLE_OPENGL
+    // GPU layers go first; QPainter then draws on top of them
+    const bool gpu = m_gpuRendering && m_glReady;
+    if (gpu) {
+        paintGlGrid();
+        endLayer(HudGrid);
+        paintGlSParamTraces();
+        endLayer(HudSParams);
+        paintGlSweepTrace();
+        endLayer(HudSweep);
+    }
+#else
+    const bool gpu = false;
+#endif
+
     QPainter painter(this);
+    
+    // Static layers: blit the cached grid, or draw it directly
+    if (gpu) {
+        painter.setRenderHint(QPainter::Antialiasing);
+        if (m_showLabels) {
+            drawAdaptiveLabels(painter);
+            drawLabels(painter);
+        }
+        if (m_showQCircles) {
+            drawQLabels(painter);
+        }
+    } else if (m_layeredRendering) {
+        updateGridCache();
+        painter.drawPixmap(0, 0, m_gridCache);
+    } else {
+        painter.setRenderHint(QPainter::Antialiasing);
+        drawGridLayers(painter);
+    }
+    endLayer(HudGrid);
+    
+    // Dynamic layers
     painter.setRenderHint(QPainter::Antialiasing);
+    drawSParamEnvelope(painter);
+    drawTwoPortCircles(painter);
+    drawMonteCarloCloud(painter);
+#ifdef SMITHTOOL_ENABLE_OPENGL
+    if (gpu) {
+        // The lines are on the GPU already; add the frequency markers
+        if (const std::vector<Complex>* values = plottedSParams(*m_sparamData)) {
+            drawFrequencyMarkers(painter, *values, Qt::blue, 4);
+        }
+        endLayer(HudSParams);
+        if (m_sweepResult && !m_sweepResult->isEmpty()) {
+            drawFrequencyMarkers(painter, m_sweepResult->gamma, QColor(230, 120, 0), 3);
+        }
+        endLayer(HudSweep);
+    }
+#endif
+    if (!gpu) {
+        drawSParamOverlays(painter);
+        drawSParamTrace(painter);
+        endLayer(HudSParams);
+        drawSweepTrace(painter);
+        endLayer(HudSweep);
+    }
+    drawMatchingTrace(painter);
+    drawDragHandles(painter);
+    endLayer(HudMatching);
+    drawImpedanceMarkers(painter);
+    drawHoverDataMarker(painter);
+    drawMarker(painter);
+    endLayer(HudMarkers);
+    
+    // The drag move that triggered this frame is now on screen
+    const qint64 paintEnd = m_hudClock.nsecsElapsed();
+    if (m_dragInputNs >= 0) {
+        m_dragLatencyMs = (paintEnd - m_dragInputNs) / 1e6;
+        m_dragLatencyMaxMs = std::max(m_dragLatencyMaxMs, m_dragLatencyMs);
+        m_dragInputNs = -1;
+    }
+    
+    if (m_hudVisible) {
+        m_hudPaintMs = (paintEnd - paintStart) / 1e6;
+        m_hudFrameNs.push_back(paintEnd);
+        while (m_hudFrameNs.front() < paintEnd - 1000000000LL) {
+            m_hudFrameNs.pop_front();
+        }
+        drawHud(painter);
+    }
+}
+
+void SmithChartWidget::setHudVisible(bool visible)
+{
+    m_hudVisible = visible;
+    m_hudFrameNs.clear();
+    update();
+}
+
+void SmithChartWidget::drawHud(QPainter& painter)
+{
+    static const char* const layerNames[HUD_LAYER_COUNT] = {
+        "grid", "s-params", "sweep", "matching", "markers"
+    };
+    
+    QStringList lines;
+    lines << QString("%1 fps   paint %2 ms")
+        .arg(m_hudFrameNs.size())
+        .arg(m_hudPaintMs, 0, 'f', 2);
+    for (int layer = 0; layer < HUD_LAYER_COUNT; ++layer) {
+        lines << QString("%1 %2 ms").arg(QString::fromLatin1(layerNames[layer]), -9)
+            .arg(m_hudLayerMs[layer], 6, 'f', 2);
+    }
+    lines << QString("drag latency %1 ms (max %2)")
+        .arg(m_dragLatencyMs, 0, 'f', 1)
+        .arg(m_dragLatencyMaxMs, 0, 'f', 1);
+    
+    QFont font("monospace");
+    font.setStyleHint(QFont::Monospace);
+    font.setPointSize(8);
+    painter.setFont(font);
+    
+    const QFontMetrics metrics(font);
+    int width = 0;
+    for (const QString& line : lines) {
+        width = std::max(width, metrics.horizontalAdvance(line));
+    }
+    QRect box(6, 6, width + 12, metrics.height() * lines.size() + 8);
+    
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0, 0, 0, 160));
+    painter.drawRoundedRect(box, 4, 4);
+    
+    painter.setPen(Qt::white);
+    int y = box.top() + 4 + metrics.ascent();
+    for (const QString& line : lines) {
+        painter.drawText(box.left() + 6, y, line);
+        y += metrics.height();
+    }
+}
+
+bool SmithChartWidget::GridCacheKey::operator==(const GridCacheKey& other) const
+{
+    return size == other.size
+        && devicePixelRatio == other.devicePixelRatio
+        && zoomLevel == other.zoomLevel
+        && panOffset == other.panOffset
+        && z0 == other.z0
+        && chartMode == other.chartMode
+        && showAdmittanceGrid == other.showAdmittanceGrid
+        && showVSWRCircles == other.showVSWRCircles
+        && showLabels == other.showLabels
+        && showQCircles == other.showQCircles
+        && generation == other.generation;
+}
+
+SmithChartWidget::GridCacheKey SmithChartWidget::currentGridCacheKey() const
+{
+    GridCacheKey key;
+    key.size = size();
+    key.devicePixelRatio = devicePixelRatioF();
+    key.zoomLevel = m_zoomLevel;
+    key.panOffset = m_panOffset;
+    key.z0 = m_z0;
+    key.chartMode = m_chartMode;
+    key.showAdmittanceGrid = m_showAdmittanceGrid;
+    key.showVSWRCircles = m_showVSWRCircles;
+    key.showLabels = m_showLabels;
+    key.showQCircles = m_showQCircles;
+    key.generation = m_gridGeneration;
+    return key;
+}
+
+void SmithChartWidget::updateGridCache()
+{
+    GridCacheKey key = currentGridCacheKey();
+    if (!m_gridCache.isNull() && key == m_gridCacheKey) {
+        return;
+    }
+    
+    // Render at device resolution so the blit is 1:1 on HiDPI screens
+    m_gridCache = QPixmap(key.size * key.devicePixelRatio);
+    m_gridCache.setDevicePixelRatio(key.devicePixelRatio);
+    
+    QPainter cachePainter(&m_gridCache);
+    cachePainter.setRenderHint(QPainter::Antialiasing);
+    drawGridLayers(cachePainter);
+    cachePainter.end();
     
+    m_gridCacheKey = key;
+}
+
+void SmithChartWidget::drawGridLayers(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawGridLayers");
     drawBackground(painter);
+    drawAdaptiveGrid(painter);
     drawResistanceCircles(painter);
     drawReactanceArcs(painter);
     
@@ -214,12 +746,6 @@ void SmithChartWidget::paintEvent(QPaintEvent* event)
     if (m_showLabels) {
         drawLabels(painter);
     }
-    
-    drawSParamTrace(painter);
-    drawMatchingTrace(painter);
-    drawDragHandles(painter);
-    drawImpedanceMarkers(painter);
-    drawMarker(painter);
 }
 
 void SmithChartWidget::mousePressEvent(QMouseEvent* event)
@@ -227,13 +753,15 @@ void SmithChartWidget::mousePressEvent(QMouseEvent* event)
     if (event->button() == Qt::LeftButton) {
         // First check if clicking on a drag handle
         int hitSegment = hitTestTraceEndpoint(event->pos());
-        if (hitSegment >= 0 && m_matchingTrace.numSegments() > 0) {
+        if (hitSegment >= 0 && m_matchingTrace->numSegments() > 0) {
             // Start dragging
             m_isDragging = true;
             m_dragSegmentIndex = hitSegment;
             m_dragStartGamma = screenToGamma(event->pos());
-            const auto& seg = m_matchingTrace.segment(hitSegment);
+            const auto& seg = m_matchingTrace->segment(hitSegment);
             m_originalValue = seg.componentValue;
+            m_dragStats = DragFrameStats();
+            m_dragLatencyMaxMs = 0.0;
             setCursor(Qt::ClosedHandCursor);
             emit dragEditStarted(hitSegment);
             return;
@@ -251,8 +779,7 @@ void SmithChartWidget::mousePressEvent(QMouseEvent* event)
                 cancelPendingElement();
             } else {
                 // Normal mode - show marker and calculate values
-                m_markerGamma = gamma;
-                m_markerVisible = true;
+                setMarkerGamma(gamma);
                 
                 emit pointClicked(gamma, z);
                 
@@ -269,7 +796,6 @@ void SmithChartWidget::mousePressEvent(QMouseEvent* event)
                 
                 emit componentValuesCalculated(m_frequency, r, l, c);
             }
-            update();
         }
     } else if (event->button() == Qt::MiddleButton) {
         // Start panning
@@ -307,12 +833,16 @@ void SmithChartWidget::mouseMoveEvent(QMouseEvent* event)
     // Handle dragging
     if (m_isDragging && m_dragSegmentIndex >= 0) {
         if (SmithMath::isInsideUnitCircle(gamma)) {
+            if (m_dragInputNs < 0) {
+                m_dragInputNs = m_hudClock.nsecsElapsed();
+            }
+            const QRect before = handleBounds(m_dragSegmentIndex);
             m_previewGamma = gamma;
             double newValue = calculateNewValueFromDrag(m_dragSegmentIndex, gamma);
             if (newValue > 0) {
-                emit elementValueDragged(m_dragSegmentIndex, newValue);
+                queueDragValue(newValue);
             }
-            update();
+            updateBounds(before, handleBounds(m_dragSegmentIndex));
         }
         return;
     }
@@ -320,16 +850,40 @@ void SmithChartWidget::mouseMoveEvent(QMouseEvent* event)
     // Check for hover over drag handles
     int hitSegment = hitTestTraceEndpoint(event->pos());
     if (hitSegment != m_hoverSegmentIndex) {
+        const QRect before = handleBounds(m_hoverSegmentIndex);
         m_hoverSegmentIndex = hitSegment;
         if (hitSegment >= 0) {
             setCursor(Qt::OpenHandCursor);
         } else if (!m_hasPendingElement) {
             setCursor(Qt::ArrowCursor);
         }
-        update();
+        updateBounds(before, handleBounds(m_hoverSegmentIndex));
     }
     
-    if (SmithMath::isInsideUnitCircle(gamma)) {
+    // Nearest measured point under the cursor
+    int hitData = (hitSegment < 0) ? hitTestDataPoint(event->pos()) : -1;
+    if (hitData != m_hoverDataIndex) {
+        const QRect before = hoverDataBounds(m_hoverDataIndex);
+        m_hoverDataIndex = hitData;
+        updateBounds(before, hoverDataBounds(m_hoverDataIndex));
+    }
+    
+    if (m_hoverDataIndex >= 0) {
+        int row = (m_sparamRow < m_sparamData->numPorts()) ? m_sparamRow : 0;
+        int col = (m_sparamCol < m_sparamData->numPorts()) ? m_sparamCol : 0;
+        Complex s = m_sparamData->s(m_hoverDataIndex, row, col);
+        Complex z = SmithMath::gammaToImpedance(s, m_z0);
+        
+        QString tip = QString("f = %1 GHz\nZ = %2 %3 j%4 Ω\n|Γ| = %5  ∠%6°")
+            .arg(m_sparamData->frequency(m_hoverDataIndex) / 1e9, 0, 'f', 6)
+            .arg(z.real(), 0, 'f', 1)
+            .arg(z.imag() >= 0 ? "+" : "-")
+            .arg(std::abs(z.imag()), 0, 'f', 1)
+            .arg(std::abs(s), 0, 'f', 3)
+            .arg(SmithMath::gammaPhaseDegrees(s), 0, 'f', 1);
+        QToolTip::showText(event->globalPosition().toPoint(), tip, this);
+        emit pointHovered(s, z);
+    } else if (SmithMath::isInsideUnitCircle(gamma)) {
         Complex z = SmithMath::gammaToImpedance(gamma, m_z0);
         emit pointHovered(gamma, z);
         
@@ -346,15 +900,70 @@ void SmithChartWidget::mouseMoveEvent(QMouseEvent* event)
     }
 }
 
-void SmithChartWidget::resizeEvent(QResizeEvent* event)
+void SmithChartWidget::queueDragValue(double value)
+{
+    ++m_dragStats.mouseEvents;
+    m_pendingDragValue = value;
+    m_dragPending = true;
+    
+    // Leading edge: the first move of a frame is applied at once, later
+    // ones only replace the pending value until the frame timer fires
+    if (!m_dragFrameTimer.isActive()) {
+        flushPendingDrag();
+    }
+}
+
+void SmithChartWidget::flushPendingDrag()
+{
+    if (!m_dragPending || m_dragSegmentIndex < 0) return;
+    m_dragPending = false;
+    
+    QElapsedTimer timer;
+    timer.start();
+    emit elementValueDragged(m_dragSegmentIndex, m_pendingDragValue);
+    double ms = timer.nsecsElapsed() / 1e6;
+    
+    ++m_dragStats.frames;
+    m_dragStats.totalFrameMs += ms;
+    m_dragStats.maxFrameMs = std::max(m_dragStats.maxFrameMs, ms);
+    
+    // Keep ticking while moves keep arriving
+    if (m_isDragging && !m_dragFrameTimer.isActive()) {
+        m_dragFrameTimer.start(frameIntervalMs());
+    }
+}
+
+int SmithChartWidget::frameIntervalMs() const
+{
+    const QScreen* s = screen();
+    double rate = s ? s->refreshRate() : 60.0;
+    if (rate < 1.0) rate = 60.0;
+    return std::max(1, static_cast<int>(1000.0 / rate));
+}
+
+void SmithChartWidget::leaveEvent(QEvent* event)
 {
     Q_UNUSED(event);
+    if (m_hoverDataIndex >= 0) {
+        const QRect before = hoverDataBounds(m_hoverDataIndex);
+        m_hoverDataIndex = -1;
+        updateBounds(before, QRect());
+    }
+}
+
+void SmithChartWidget::resizeEvent(QResizeEvent* event)
+{
+    // QOpenGLWidget resizes its framebuffer here
+    SmithChartBase::resizeEvent(event);
     updateChartGeometry();
 }
 
 void SmithChartWidget::mouseReleaseEvent(QMouseEvent* event)
 {
     if (event->button() == Qt::LeftButton && m_isDragging) {
+        // Apply the final position even if its frame has not come yet
+        flushPendingDrag();
+        m_dragFrameTimer.stop();
         m_isDragging = false;
         m_dragSegmentIndex = -1;
         setCursor(Qt::ArrowCursor);
@@ -380,9 +989,10 @@ void SmithChartWidget::wheelEvent(QWheelEvent* event)
         QPointF mousePos = event->position();
         QPointF centerToMouse = mousePos - m_center;
         
-        // Adjust pan offset to zoom towards mouse position
+        // Keep the point under the mouse fixed, which matters most at
+        // high zoom
         double ratio = newZoom / m_zoomLevel - 1.0;
-        m_panOffset -= centerToMouse * ratio * 0.5;
+        m_panOffset -= centerToMouse * ratio;
         
         m_zoomLevel = newZoom;
         updateChartGeometry();
@@ -392,40 +1002,88 @@ void SmithChartWidget::wheelEvent(QWheelEvent* event)
     event->accept();
 }
 
-int SmithChartWidget::hitTestTraceEndpoint(const QPointF& pos) const
+bool SmithChartWidget::indexIsCurrent(const PointIndexCache& cache, quint64 generation) const
+{
+    return cache.generation == generation && cache.center == m_center &&
+           cache.radius == m_radius;
+}
+
+int SmithChartWidget::hitTestTraceEndpoint(const QPointF& pos)
+{
+    if (m_matchingTrace->numSegments() == 0) return -1;
+    
+    // Index the end point of every segment (each can be dragged)
+    if (!indexIsCurrent(m_handleIndex, m_matchingGeneration)) {
+        const auto& segments = m_matchingTrace->segments();
+        std::vector<QPointF> points;
+        m_handleIndex.sourceIndex.clear();
+        for (size_t i = 0; i < segments.size(); ++i) {
+            if (segments[i].isEmpty()) continue;
+            points.push_back(gammaToScreen(segments[i].endPoint().gamma));
+            m_handleIndex.sourceIndex.push_back(static_cast<int>(i));
+        }
+        m_handleIndex.grid.build(points.data(), points.size(), 2.0 * DRAG_HIT_RADIUS);
+        m_handleIndex.generation = m_matchingGeneration;
+        m_handleIndex.center = m_center;
+        m_handleIndex.radius = m_radius;
+    }
+    
+    // Lowest segment first, as overlapping handles always resolved
+    int hit = m_handleIndex.grid.firstWithin(pos, DRAG_HIT_RADIUS);
+    return (hit >= 0) ? m_handleIndex.sourceIndex[hit] : -1;
+}
+
+int SmithChartWidget::hitTestDataPoint(const QPointF& pos)
 {
-    if (m_matchingTrace.numSegments() == 0) return -1;
+    if (m_sparamData->isEmpty()) return -1;
     
-    const auto& segments = m_matchingTrace.segments();
+    int row = m_sparamRow;
+    int col = m_sparamCol;
+    if (row >= m_sparamData->numPorts() || col >= m_sparamData->numPorts()) {
+        row = 0;
+        col = 0;
+    }
     
-    // Test each segment's endpoint (we allow dragging the last point of each segment)
-    for (size_t i = 0; i < segments.size(); ++i) {
-        const TraceSegment& seg = segments[i];
-        if (seg.isEmpty()) continue;
-        
-        // Check end point of this segment
-        QPointF endPt = gammaToScreen(seg.endPoint().gamma);
-        double dist = std::hypot(pos.x() - endPt.x(), pos.y() - endPt.y());
+    if (!indexIsCurrent(m_dataIndex, m_sparamGeneration)) {
+        // Only the drawn (inside the unit circle) points can be hovered
+        const std::vector<Complex>& values = m_sparamData->sData(row, col);
+        m_lodScratch.resize(values.size());
+        SmithMath::gammaToScreen(values.data(), m_lodScratch.data(), values.size(),
+                                 m_center, m_radius);
         
-        if (dist <= DRAG_HIT_RADIUS) {
-            return static_cast<int>(i);
+        std::size_t visible = 0;
+        m_dataIndex.sourceIndex.clear();
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (!SmithMath::isInsideUnitCircle(values[i])) continue;
+            m_lodScratch[visible++] = m_lodScratch[i];
+            m_dataIndex.sourceIndex.push_back(static_cast<int>(i));
         }
+        m_dataIndex.grid.build(m_lodScratch.data(), visible, DATA_HOVER_RADIUS);
+        m_dataIndex.generation = m_sparamGeneration;
+        m_dataIndex.center = m_center;
+        m_dataIndex.radius = m_radius;
     }
     
-    return -1;
+    int hit = m_dataIndex.grid.nearest(pos, DATA_HOVER_RADIUS);
+    return (hit >= 0) ? m_dataIndex.sourceIndex[hit] : -1;
 }
 
 double SmithChartWidget::calculateNewValueFromDrag(int segmentIndex, const Complex& newGamma) const
 {
-    if (segmentIndex < 0 || segmentIndex >= m_matchingTrace.numSegments()) {
+    if (segmentIndex < 0 || segmentIndex >= m_matchingTrace->numSegments()) {
         return 0;
     }
     
-    const TraceSegment& seg = m_matchingTrace.segment(segmentIndex);
-    Complex startZ = seg.startPoint().impedance;
+    const TraceSegment& seg = m_matchingTrace->segment(segmentIndex);
+    Complex startZ = seg.startImpedance;
     Complex newZ = SmithMath::gammaToImpedance(newGamma, m_z0);
     double omega = 2.0 * SmithMath::PI * m_frequency;
     
+    // Lines and stubs are valued by length, solved by the trace
+    if (MatchingTrace::isDistributed(seg.componentType)) {
+        return m_matchingTrace->lineLengthFor(segmentIndex, newZ);
+    }
+    
     double newValue = 0;
     
     if (seg.connectionType == ConnectionType::Series) {
@@ -505,116 +1163,247 @@ QRectF SmithChartWidget::circleRect(const QPointF& center, double radius) const
                   2 * radius, 2 * radius);
 }
 
-void SmithChartWidget::drawBackground(QPainter& painter)
+void SmithChartWidget::updateBounds(const QRect& before, const QRect& after)
 {
-    painter.fillRect(rect(), QColor(255, 255, 255));
+    // Two separate rectangles, not their bounding box: a marker jumping
+    // across the chart still repaints only around its two positions
+    QRegion region(before);
+    region += after;
+    if (!region.isEmpty()) {
+        update(region);
+    }
 }
 
-void SmithChartWidget::drawUnitCircle(QPainter& painter)
+QRect SmithChartWidget::markerBounds() const
 {
-    QPen pen(Qt::black, 2);
-    painter.setPen(pen);
-    painter.setBrush(Qt::NoBrush);
-    painter.drawEllipse(circleRect(m_center, m_radius));
+    if (!m_markerVisible) return QRect();
+    
+    // Crosshair of ±8 px with a 2 px pen (see drawMarker)
+    return circleRect(gammaToScreen(m_markerGamma), 10).toAlignedRect();
 }
 
-void SmithChartWidget::drawResistanceCircles(QPainter& painter)
+QRect SmithChartWidget::impedanceMarkerBounds(const Complex& z, const QString& label) const
 {
-    QPen pen(QColor(100, 100, 100), 1);
-    painter.setPen(pen);
-    painter.setBrush(Qt::NoBrush);
+    Complex gamma = SmithMath::impedanceToGamma(z, m_z0);
+    if (!SmithMath::isInsideUnitCircle(gamma)) return QRect();
     
-    for (double r : s_resistanceValues) {
-        Complex center = SmithMath::constantRCircleCenter(r);
-        double radius = SmithMath::constantRCircleRadius(r);
-        
-        QPointF screenCenter = gammaToScreen(center);
-        double screenRadius = radius * m_radius;
-        
-        // Clip to unit circle using path intersection
-        QPainterPath circlePath;
-        circlePath.addEllipse(circleRect(screenCenter, screenRadius));
-        
-        QPainterPath unitPath;
-        unitPath.addEllipse(circleRect(m_center, m_radius));
-        
-        painter.drawPath(circlePath.intersected(unitPath));
-    }
+    // Square/triangle of at most ±8 px plus the label (see drawImpedanceMarkers)
+    QPointF pos = gammaToScreen(gamma);
+    QRect bounds = circleRect(pos, 10).toAlignedRect();
+    QFontMetrics metrics(QFont("Arial", 9, QFont::Bold));
+    QRect text = metrics.boundingRect(label).translated((pos + QPointF(10, -5)).toPoint());
+    return bounds.united(text.adjusted(-2, -2, 2, 2));
 }
 
-void SmithChartWidget::drawReactanceArcs(QPainter& painter)
+QRect SmithChartWidget::sourceMarkerBounds() const
 {
-    QPen pen(QColor(100, 100, 100), 1);
+    return m_sourceVisible ? impedanceMarkerBounds(m_sourceZ, "Zs") : QRect();
+}
+
+QRect SmithChartWidget::loadMarkerBounds() const
+{
+    return m_loadVisible ? impedanceMarkerBounds(m_loadZ, "Zl") : QRect();
+}
+
+QRect SmithChartWidget::handleBounds(int segmentIndex) const
+{
+    if (segmentIndex < 0 || segmentIndex >= m_matchingTrace->numSegments()) return QRect();
+    const TraceSegment& seg = m_matchingTrace->segment(segmentIndex);
+    if (seg.isEmpty()) return QRect();
+    
+    // Hover ring of 8 px with a 2 px pen (see drawDragHandles)
+    QPointF endPt = gammaToScreen(seg.endPoint().gamma);
+    QRectF bounds = circleRect(endPt, 10);
+    if (m_isDragging && segmentIndex == m_dragSegmentIndex) {
+        // Preview handle and the line to it
+        bounds = bounds.united(circleRect(gammaToScreen(m_previewGamma), 10));
+    }
+    return bounds.toAlignedRect();
+}
+
+QRect SmithChartWidget::hoverDataBounds(int index) const
+{
+    if (index < 0 || index >= m_sparamData->numPoints()) return QRect();
+    
+    int row = (m_sparamRow < m_sparamData->numPorts()) ? m_sparamRow : 0;
+    int col = (m_sparamCol < m_sparamData->numPorts()) ? m_sparamCol : 0;
+    QPointF pos = gammaToScreen(m_sparamData->s(index, row, col));
+    
+    // Point of 5 px plus the frequency label (see drawHoverDataMarker)
+    QRect bounds = circleRect(pos, 7).toAlignedRect();
+    QFont labelFont = font();
+    labelFont.setPointSize(9);
+    QString label = QString("%1 GHz").arg(m_sparamData->frequency(index) / 1e9, 0, 'f', 4);
+    QRect text = QFontMetrics(labelFont).boundingRect(label).translated((pos + QPointF(8, -8)).toPoint());
+    return bounds.united(text.adjusted(-2, -2, 2, 2));
+}
+
+void SmithChartWidget::drawBackground(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawBackground");
+    painter.fillRect(rect(), QColor(255, 255, 255));
+}
+
+void SmithChartWidget::drawUnitCircle(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawUnitCircle");
+    QPen pen(Qt::black, 2);
     painter.setPen(pen);
     painter.setBrush(Qt::NoBrush);
+    painter.drawEllipse(circleRect(m_center, m_radius));
+}
+
+void SmithChartWidget::addGridArc(QPainterPath& path, const GridArc& arc) const
+{
+    // Gamma angles are counterclockwise with Im up, as Qt's arc angles on screen
+    QRectF rect = circleRect(gammaToScreen(arc.center), arc.radius * m_radius);
+    const double startDeg = qRadiansToDegrees(arc.startAngle);
+    const double spanDeg = qRadiansToDegrees(arc.spanAngle);
+    if (arc.isFullCircle()) {
+        path.addEllipse(rect);
+        return;
+    }
+    path.arcMoveTo(rect, startDeg);
+    path.arcTo(rect, startDeg, spanDeg);
+}
+
+void SmithChartWidget::addGridArcs(QPainterPath& path, const std::vector<GridArc>& arcs) const
+{
+    for (const GridArc& arc : arcs) {
+        addGridArc(path, arc);
+    }
+}
+
+int SmithChartWidget::updateGridLines()
+{
+    const int level = AdaptiveGrid::levelForZoom(m_zoomLevel);
+    if (level == 0) {
+        m_gridLines.clear();
+        return 0;
+    }
+    
+    // Only lines crossing the visible part of the chart are generated
+    const Complex topLeft = screenToGamma(QPointF(0, 0));
+    const Complex bottomRight = screenToGamma(QPointF(width(), height()));
+    const GridViewport viewport(topLeft.real(), bottomRight.real(),
+                                bottomRight.imag(), topLeft.imag());
+    m_adaptiveGrid.linesFor(viewport, level, m_gridLines);
+    return level;
+}
+
+void SmithChartWidget::drawAdaptiveGrid(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawAdaptiveGrid");
+    if (updateGridLines() == 0) return;
+    
+    painter.setBrush(Qt::NoBrush);
+    painter.setPen(QPen(QColor(205, 205, 205), 1));
     
-    // Draw horizontal axis (x=0 line)
-    painter.drawLine(QPointF(m_center.x() - m_radius, m_center.y()),
-                     QPointF(m_center.x() + m_radius, m_center.y()));
+    QPainterPath path;
+    GridArc arc;
+    for (double r : m_gridLines.resistances) {
+        addGridArc(path, GridGeometry::resistanceCircle(r));
+    }
+    for (double x : m_gridLines.reactances) {
+        if (GridGeometry::reactanceArc(x, arc)) addGridArc(path, arc);
+    }
+    painter.drawPath(path);
     
-    for (double x : s_reactanceValues) {
-        // Positive reactance (upper half)
-        Complex arcCenter = SmithMath::constantXArcCenter(x);
-        double arcRadius = SmithMath::constantXArcRadius(x);
-        QPointF screenCenter = gammaToScreen(arcCenter);
-        double screenRadius = arcRadius * m_radius;
-        
-        QPainterPath arcPath;
-        arcPath.addEllipse(circleRect(screenCenter, screenRadius));
-        QPainterPath unitPath;
-        unitPath.addEllipse(circleRect(m_center, m_radius));
-        painter.drawPath(arcPath.intersected(unitPath));
-        
-        // Negative reactance (lower half)
-        arcCenter = SmithMath::constantXArcCenter(-x);
-        screenCenter = gammaToScreen(arcCenter);
-        
-        QPainterPath arcPath2;
-        arcPath2.addEllipse(circleRect(screenCenter, screenRadius));
-        painter.drawPath(arcPath2.intersected(unitPath));
+    const bool admittance = m_showAdmittanceGrid || m_chartMode == ChartMode::Admittance ||
+                            m_chartMode == ChartMode::Combined;
+    if (admittance) {
+        painter.setPen(QPen(QColor(200, 200, 225), 1, Qt::DashLine));
+        QPainterPath admittancePath;
+        for (double g : m_gridLines.conductances) {
+            addGridArc(admittancePath, GridGeometry::conductanceCircle(g));
+        }
+        for (double b : m_gridLines.susceptances) {
+            if (GridGeometry::susceptanceArc(b, arc)) addGridArc(admittancePath, arc);
+        }
+        painter.drawPath(admittancePath);
+    }
+    
+    if (m_showLabels) {
+        drawAdaptiveLabels(painter);
     }
 }
 
-void SmithChartWidget::drawClippedArc(QPainter& painter, const QPointF& center,
-                                       double radius, double startAngle, double spanAngle)
+void SmithChartWidget::drawAdaptiveLabels(QPainter& painter)
 {
-    QPainterPath arcPath;
-    arcPath.arcMoveTo(circleRect(center, radius), startAngle);
-    arcPath.arcTo(circleRect(center, radius), startAngle, spanAngle);
+    if (m_gridLines.size() == 0) return;
     
-    QPainterPath unitPath;
-    unitPath.addEllipse(circleRect(m_center, m_radius));
+    // Label each impedance line where it passes closest to the view center
+    GridArc arc;
+    QFont font = painter.font();
+    font.setPointSize(7);
+    painter.setFont(font);
+    painter.setPen(QColor(120, 120, 120));
     
-    painter.drawPath(arcPath.intersected(unitPath));
+    const Complex viewCenter = screenToGamma(QPointF(width() / 2.0, height() / 2.0));
+    auto label = [&](const GridArc& line, const QString& text) {
+        Complex toCenter = viewCenter - line.center;
+        if (std::abs(toCenter) == 0.0) return;
+        Complex gamma = line.center + toCenter * (line.radius / std::abs(toCenter));
+        QPointF pos = gammaToScreen(gamma);
+        if (SmithMath::isInsideUnitCircle(gamma) && rect().contains(pos.toPoint())) {
+            painter.drawText(pos + QPointF(2, -2), text);
+        }
+    };
+    for (double r : m_gridLines.resistances) {
+        label(GridGeometry::resistanceCircle(r), QString::number(r, 'g', 5));
+    }
+    for (double x : m_gridLines.reactances) {
+        if (GridGeometry::reactanceArc(x, arc)) {
+            label(arc, QString("%1j%2").arg(x < 0 ? "-" : "+").arg(std::abs(x), 0, 'g', 5));
+        }
+    }
+}
+
+void SmithChartWidget::drawResistanceCircles(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawResistanceCircles");
+    QPen pen(QColor(100, 100, 100), 1);
+    painter.setPen(pen);
+    painter.setBrush(Qt::NoBrush);
+    
+    // Already clipped to the unit circle; only the chart transform is applied
+    QPainterPath path;
+    addGridArcs(path, GridGeometry::resistanceArcs());
+    painter.drawPath(path);
+}
+
+void SmithChartWidget::drawReactanceArcs(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawReactanceArcs");
+    QPen pen(QColor(100, 100, 100), 1);
+    painter.setPen(pen);
+    painter.setBrush(Qt::NoBrush);
+    
+    // Draw horizontal axis (x=0 line)
+    painter.drawLine(QPointF(m_center.x() - m_radius, m_center.y()),
+                     QPointF(m_center.x() + m_radius, m_center.y()));
+    
+    QPainterPath path;
+    addGridArcs(path, GridGeometry::reactanceArcs());
+    painter.drawPath(path);
 }
 
 void SmithChartWidget::drawAdmittanceGrid(QPainter& painter)
 {
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawAdmittanceGrid");
     QPen pen(QColor(150, 150, 200), 1, Qt::DashLine);
     painter.setPen(pen);
     painter.setBrush(Qt::NoBrush);
     
     // Admittance circles are rotated 180° from impedance
-    for (double g : s_resistanceValues) {
-        Complex center = SmithMath::constantRCircleCenter(g);
-        center = -center;  // Rotate 180°
-        double radius = SmithMath::constantRCircleRadius(g);
-        
-        QPointF screenCenter = gammaToScreen(center);
-        double screenRadius = radius * m_radius;
-        
-        QPainterPath circlePath;
-        circlePath.addEllipse(circleRect(screenCenter, screenRadius));
-        
-        QPainterPath unitPath;
-        unitPath.addEllipse(circleRect(m_center, m_radius));
-        
-        painter.drawPath(circlePath.intersected(unitPath));
-    }
+    QPainterPath path;
+    addGridArcs(path, GridGeometry::conductanceArcs());
+    painter.drawPath(path);
 }
 
 void SmithChartWidget::drawVSWRCircles(QPainter& painter)
 {
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawVSWRCircles");
     QPen pen(QColor(200, 100, 100), 1, Qt::DotLine);
     painter.setPen(pen);
     painter.setBrush(Qt::NoBrush);
@@ -634,59 +1423,51 @@ void SmithChartWidget::drawVSWRCircles(QPainter& painter)
 
 void SmithChartWidget::drawQCircles(QPainter& painter)
 {
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawQCircles");
     QPen pen(QColor(0, 150, 100), 1, Qt::DashDotLine);
     painter.setPen(pen);
     painter.setBrush(Qt::NoBrush);
     
+    for (double q : m_qValues) {
+        // Upper and lower arcs (positive and negative reactance)
+        QPainterPath path;
+        GridArc arc;
+        if (GridGeometry::qArc(q, true, arc)) addGridArc(path, arc);
+        if (GridGeometry::qArc(q, false, arc)) addGridArc(path, arc);
+        painter.drawPath(path);
+    
+    }
+    
+    drawQLabels(painter);
+}
+
+void SmithChartWidget::drawQLabels(QPainter& painter)
+{
     QFont font = painter.font();
     font.setPointSize(7);
     painter.setFont(font);
+    painter.setPen(QColor(0, 150, 100));
     
     for (double q : m_qValues) {
-        QCircle qCircle(q);
-        
-        // Upper Q-circle (positive reactance region)
-        QPointF screenCenterUpper = gammaToScreen(qCircle.centerUpper);
-        double screenRadius = qCircle.radius * m_radius;
-        
-        QPainterPath upperPath;
-        upperPath.addEllipse(circleRect(screenCenterUpper, screenRadius));
-        
-        QPainterPath unitPath;
-        unitPath.addEllipse(circleRect(m_center, m_radius));
-        
-        painter.drawPath(upperPath.intersected(unitPath));
-        
-        // Lower Q-circle (negative reactance region)
-        QPointF screenCenterLower = gammaToScreen(qCircle.centerLower);
-        
-        QPainterPath lowerPath;
-        lowerPath.addEllipse(circleRect(screenCenterLower, screenRadius));
-        
-        painter.drawPath(lowerPath.intersected(unitPath));
-        
-        // Draw label on upper circle
-        painter.setPen(QColor(0, 150, 100));
-        // Label near the intersection with real axis
+        // Label on the upper circle, near the intersection with real axis
         Complex labelGamma = Complex(0.5, 0.5 / q);  // Approximate intersection point
         if (SmithMath::isInsideUnitCircle(labelGamma)) {
             QPointF labelPos = gammaToScreen(labelGamma);
             painter.drawText(labelPos + QPointF(5, -2), QString("Q=%1").arg(q, 0, 'g', 2));
         }
-        
-        painter.setPen(pen);  // Reset pen for next circle
     }
 }
 
 void SmithChartWidget::drawLabels(QPainter& painter)
 {
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawLabels");
     QFont font = painter.font();
     font.setPointSize(8);
     painter.setFont(font);
     painter.setPen(Qt::black);
     
     // Resistance labels on real axis
-    for (double r : s_resistanceValues) {
+    for (double r : GridGeometry::resistanceValues()) {
         Complex gamma = SmithMath::normalizedZToGamma(Complex(r, 0));
         QPointF pos = gammaToScreen(gamma);
         pos.setY(pos.y() + 12);
@@ -696,7 +1477,7 @@ void SmithChartWidget::drawLabels(QPainter& painter)
     }
     
     // Reactance labels
-    for (double x : s_reactanceValues) {
+    for (double x : GridGeometry::reactanceValues()) {
         // Positive reactance
         Complex gamma = SmithMath::normalizedZToGamma(Complex(0, x));
         if (SmithMath::isInsideUnitCircle(gamma)) {
@@ -713,42 +1494,536 @@ void SmithChartWidget::drawLabels(QPainter& painter)
     }
 }
 
+const std::vector<Complex>* SmithChartWidget::plottedSParams(const SParamData& data) const
+{
+    if (data.isEmpty()) return nullptr;
+    
+    // Fall back to S11 if the selected Sij does not exist in this data
+    int row = m_sparamRow;
+    int col = m_sparamCol;
+    if (row >= data.numPorts() || col >= data.numPorts()) {
+        row = 0;
+        col = 0;
+    }
+    return &data.sData(row, col);
+}
+
 void SmithChartWidget::drawSParamTrace(QPainter& painter)
 {
-    if (m_sparamData.isEmpty()) return;
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawSParamTrace");
+    const std::vector<Complex>* values = plottedSParams(*m_sparamData);
+    if (!values) return;
     
-    QPen pen(Qt::blue, 2);
+    updateTraceLod(m_sparamLod, m_sparamGeneration, *values);
+    drawTraceLod(painter, m_sparamLod, Qt::blue, 4);
+}
+
+void SmithChartWidget::drawSParamOverlays(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawSParamOverlays");
+    if (m_overlays.empty()) return;
+    
+    QPen pen(Qt::gray, 1);
+    bool penSet = false;
+    painter.setBrush(Qt::NoBrush);
+    
+    for (SParamOverlay& overlay : m_overlays) {
+        if (!overlay.visible) continue;
+        const SParamData* data = overlayData(overlay);
+        const std::vector<Complex>* values = data ? plottedSParams(*data) : nullptr;
+        if (!values) continue;
+        updateTraceLod(overlay.lod, overlay.generation, *values);
+        
+        // Lot overlays usually share a color; only switch pens when needed
+        if (!penSet || pen.color() != overlay.color) {
+            pen.setColor(overlay.color);
+            painter.setPen(pen);
+            penSet = true;
+        }
+        painter.drawPolyline(overlay.lod.polyline.data(),
+                             static_cast<int>(overlay.lod.polyline.size()));
+    }
+}
+
+void SmithChartWidget::drawSParamEnvelope(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawSParamEnvelope");
+    if (!m_envelope || m_envelope->isEmpty()) return;
+    
+    EnvelopeCache& cache = m_envelopeCache;
+    if (cache.generation != m_envelopeGeneration || cache.center != m_center ||
+        cache.radius != m_radius) {
+        const SParamEnvelope& envelope = *m_envelope;
+        const int n = envelope.size();
+        cache.band.resize(2 * n);
+        cache.percentile.resize(n);
+        cache.mean.resize(n);
+        for (int i = 0; i < n; ++i) {
+            cache.band[i] = gammaToScreen(envelope.atMagnitude(i, envelope.maxMagnitude[i]));
+            cache.band[2 * n - 1 - i] = gammaToScreen(envelope.atMagnitude(i, envelope.minMagnitude[i]));
+            cache.percentile[i] = gammaToScreen(envelope.atMagnitude(i, envelope.percentileMagnitude[i]));
+            cache.mean[i] = gammaToScreen(envelope.mean[i]);
+        }
+        cache.generation = m_envelopeGeneration;
+        cache.center = m_center;
+        cache.radius = m_radius;
+    }
+    
+    // Winding fill keeps the band solid where it turns over itself
+    QColor fill = m_envelopeColor;
+    fill.setAlpha(60);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(fill);
+    painter.drawPolygon(cache.band, Qt::WindingFill);
+    
+    painter.setBrush(Qt::NoBrush);
+    painter.setPen(QPen(m_envelopeColor, 1.5, Qt::DashLine));
+    painter.drawPolyline(cache.percentile);
+    painter.setPen(QPen(m_envelopeColor.darker(130), 1));
+    painter.drawPolyline(cache.mean);
+}
+
+void SmithChartWidget::drawTwoPortCircles(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawTwoPortCircles");
+    if (!m_twoPort || m_twoPortLayers == 0 || m_twoPortIndex < 0 ||
+        m_twoPortIndex >= m_twoPort->size()) {
+        return;
+    }
+    const TwoPortAnalysis& analysis = *m_twoPort;
+    const int i = m_twoPortIndex;
+    
+    painter.save();
+    QPainterPath chart;
+    chart.addEllipse(circleRect(m_center, m_radius));
+    painter.setClipPath(chart);
+    painter.setBrush(Qt::NoBrush);
+    
+    // An unconditionally stable device has nothing to warn about
+    if (!analysis.isStable(i)) {
+        if (m_twoPortLayers & SourceStabilityLayer) {
+            drawSmithCircle(painter, analysis.sourceStability(i),
+                            QPen(QColor(200, 0, 160), 1.5), QStringLiteral("CS"), true);
+        }
+        if (m_twoPortLayers & LoadStabilityLayer) {
+            drawSmithCircle(painter, analysis.loadStability(i),
+                            QPen(QColor(220, 60, 0), 1.5), QStringLiteral("CL"), true);
+        }
+    }
+    
+    if (m_twoPortLayers & GainCirclesLayer) {
+        QPen pen(QColor(0, 140, 60), 1.2, Qt::DashLine);
+        for (int l = 0; l < TwoPortAnalysis::GAIN_LEVELS; ++l) {
+            double db = analysis.maxGainDb[i] - TwoPortAnalysis::GAIN_STEPS_DB[l];
+            drawSmithCircle(painter, analysis.gainCircle(l, i), pen,
+                            QString("Ga %1 dB").arg(db, 0, 'f', 1));
+        }
+    }
+    
+    if ((m_twoPortLayers & NoiseCirclesLayer) && analysis.hasNoise() &&
+        std::isfinite(analysis.fMinDb[i])) {
+        QPen pen(QColor(0, 90, 200), 1.2, Qt::DashDotLine);
+        for (int l = 0; l < TwoPortAnalysis::NOISE_LEVELS; ++l) {
+            double db = analysis.fMinDb[i] + TwoPortAnalysis::NOISE_STEPS_DB[l];
+            drawSmithCircle(painter, analysis.noiseCircle(l, i), pen,
+                            QString("NF %1 dB").arg(db, 0, 'f', 2));
+        }
+    }
+    painter.restore();
+}
+
+void SmithChartWidget::drawSmithCircle(QPainter& painter, const SmithCircle& circle,
+                                       const QPen& pen, const QString& label,
+                                       bool stability)
+{
+    // Circles through the chart edge can be nearly straight lines; past
+    // this size they are not worth a drawEllipse
+    const double r = std::abs(circle.radius);
+    if (!circle.isValid() || !std::isfinite(r) || !std::isfinite(std::abs(circle.center)) ||
+        r > MAX_CIRCLE_RADIUS) {
+        return;
+    }
+    
+    QPointF center = gammaToScreen(circle.center);
+    QRectF rect = circleRect(center, r * m_radius);
     painter.setPen(pen);
+    painter.drawEllipse(rect);
     
-    QPainterPath path;
-    bool first = true;
+    // Hatch the unstable side: inside for a negative radius, else outside
+    if (stability) {
+        QColor shade = pen.color();
+        shade.setAlpha(60);
+        QPainterPath unstable;
+        unstable.addEllipse(rect);
+        if (circle.radius > 0.0) {
+            QPainterPath chart;
+            chart.addEllipse(circleRect(m_center, m_radius));
+            unstable = chart.subtracted(unstable);
+        }
+        painter.fillPath(unstable, QBrush(shade, Qt::BDiagPattern));
+    }
     
-    for (const auto& point : m_sparamData.points()) {
-        Complex gamma = point.s11;
-        if (SmithMath::isInsideUnitCircle(gamma)) {
-            QPointF screenPoint = gammaToScreen(gamma);
-            if (first) {
-                path.moveTo(screenPoint);
-                first = false;
+    // Label at the point of the circle nearest the chart center
+    Complex towardOrigin = std::abs(circle.center) > 1e-9
+        ? -circle.center / std::abs(circle.center) : Complex(0.0, 1.0);
+    QPointF anchor = gammaToScreen(circle.center + r * towardOrigin);
+    painter.setPen(pen.color());
+    painter.setFont(m_traceLabelFont);
+    painter.drawText(anchor + QPointF(3, -3), label);
+}
+
+void SmithChartWidget::drawMonteCarloCloud(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawMonteCarloCloud");
+    if (!m_monteCarlo || m_monteCarlo->isEmpty()) return;
+    
+    MonteCarloCache& cache = m_monteCarloCache;
+    if (cache.generation != m_monteCarloGeneration || cache.center != m_center ||
+        cache.radius != m_radius || cache.size != size()) {
+        // 100k samples land on far fewer pixels: one dot per pixel, red
+        // if any sample there fails. Sorting (pixel, fail) keys of the
+        // samples keeps the scratch at the sample count, not the pixel count.
+        const int w = std::max(1, width());
+        const int h = std::max(1, height());
+        const MonteCarloResult& result = *m_monteCarlo;
+        std::vector<std::pair<quint64, int>> hits;
+        hits.reserve(result.samples);
+        for (int i = 0; i < result.samples; ++i) {
+            QPointF p = gammaToScreen(result.endGamma[i]);
+            int x = static_cast<int>(p.x());
+            int y = static_cast<int>(p.y());
+            if (x < 0 || y < 0 || x >= w || y >= h) continue;
+            
+            quint64 pixel = static_cast<quint64>(y) * w + x;
+            hits.emplace_back((pixel << 1) | (result.pass[i] ? 0u : 1u), i);
+        }
+        std::sort(hits.begin(), hits.end());
+        
+        cache.passed.clear();
+        cache.failed.clear();
+        for (std::size_t first = 0; first < hits.size();) {
+            // The last key of a pixel run is its worst state; draw its first sample
+            const quint64 pixel = hits[first].first >> 1;
+            std::size_t end = first;
+            while (end < hits.size() && (hits[end].first >> 1) == pixel) ++end;
+            std::size_t pick = end - 1;
+            while (pick > first && hits[pick - 1].first == hits[pick].first) --pick;
+            
+            const QPointF p = gammaToScreen(result.endGamma[hits[pick].second]);
+            if (hits[pick].first & 1u) {
+                cache.failed.append(p);
             } else {
-                path.lineTo(screenPoint);
+                cache.passed.append(p);
             }
+            first = end;
         }
+        cache.generation = m_monteCarloGeneration;
+        cache.center = m_center;
+        cache.radius = m_radius;
+        cache.size = size();
     }
     
-    painter.drawPath(path);
+    painter.setBrush(Qt::NoBrush);
+    painter.setPen(QPen(QColor(0, 160, 60, 160), 2));
+    painter.drawPoints(cache.passed);
+    painter.setPen(QPen(QColor(220, 30, 30, 160), 2));
+    painter.drawPoints(cache.failed);
+}
+
+void SmithChartWidget::drawSweepTrace(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawSweepTrace");
+    if (!m_sweepResult || m_sweepResult->isEmpty()) return;
+    
+    updateTraceLod(m_sweepLod, m_sweepGeneration, m_sweepResult->gamma);
+    drawTraceLod(painter, m_sweepLod, QColor(230, 120, 0), 3);
+}
+
+void SmithChartWidget::updateTraceLod(TraceLodCache& cache, quint64 generation,
+                                      const std::vector<Complex>& values)
+{
+    const qreal dpr = devicePixelRatioF();
+    if (cache.generation == generation && cache.center == m_center &&
+        cache.radius == m_radius && cache.devicePixelRatio == dpr) {
+        return;
+    }
+    
+    PolylineDecimator::gammaTrace(values.data(), values.size(), m_center, m_radius,
+                                  m_lodScratch, cache.polyline, dpr);
+    
+    const std::size_t count = values.size();
+    m_gammaScratch.clear();
+    for (std::size_t i = 0; i < count; i += count / 10 + 1) {
+        m_gammaScratch.push_back(values[i]);
+    }
+    cache.markers.resize(m_gammaScratch.size());
+    SmithMath::gammaToScreen(m_gammaScratch.data(), cache.markers.data(),
+                             m_gammaScratch.size(), m_center, m_radius);
+    
+    // Do not keep a full-resolution copy of huge traces around
+    if (m_lodScratch.capacity() > 4 * cache.polyline.size() + 4096) {
+        std::vector<QPointF>().swap(m_lodScratch);
+    }
+    
+    cache.generation = generation;
+    cache.center = m_center;
+    cache.radius = m_radius;
+    cache.devicePixelRatio = dpr;
+}
+
+void SmithChartWidget::drawTraceLod(QPainter& painter, const TraceLodCache& cache,
+                                    const QColor& color, double markerRadius)
+{
+    QPen pen(color, 2);
+    painter.setPen(pen);
+    painter.setBrush(Qt::NoBrush);
+    painter.drawPolyline(cache.polyline.data(), static_cast<int>(cache.polyline.size()));
     
     // Draw frequency markers
-    painter.setBrush(Qt::blue);
-    for (int i = 0; i < m_sparamData.numPoints(); i += m_sparamData.numPoints() / 10 + 1) {
-        const auto& point = m_sparamData.point(i);
-        QPointF screenPoint = gammaToScreen(point.s11);
-        painter.drawEllipse(screenPoint, 4, 4);
+    painter.setBrush(color);
+    for (const QPointF& marker : cache.markers) {
+        painter.drawEllipse(marker, markerRadius, markerRadius);
+    }
+}
+
+#ifdef SMITHTOOL_ENABLE_OPENGL
+bool SmithChartWidget::GlGridKey::operator==(const GlGridKey& other) const
+{
+    return pixelRadius == other.pixelRadius
+        && admittance == other.admittance
+        && showVSWRCircles == other.showVSWRCircles
+        && showQCircles == other.showQCircles
+        && generation == other.generation;
+}
+
+void SmithChartWidget::releaseGl()
+{
+    if (!m_glRenderer) return;
+    
+    // Buffers must be destroyed with their context current
+    makeCurrent();
+    m_glRenderer.reset();
+    doneCurrent();
+    
+    m_glReady = false;
+    m_glGridKey = GlGridKey();
+    m_glGridLines.clear();
+    m_glMinorPixelRadius = 0.0;
+    m_glSParamState = GlTraceState();
+    m_glSweepState = GlTraceState();
+    m_glOverlayStates.clear();
+}
+
+double SmithChartWidget::glTessellationRadius() const
+{
+    // Fine enough for the largest zoom of the current grid level, so
+    // zooming within a level needs no new vertices
+    const int level = AdaptiveGrid::levelForZoom(m_zoomLevel);
+    const double baseRadius = (qMin(width(), height()) - 2 * m_margin) / 2.0;
+    return std::max(baseRadius, 1.0) * std::ldexp(1.0, level + 1) * devicePixelRatioF();
+}
+
+void SmithChartWidget::paintGlGrid()
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::paintGlGrid");
+    m_glRenderer->beginFrame(size(), QColor(255, 255, 255), m_center, m_radius,
+                             devicePixelRatioF());
+    
+    const bool admittance = m_showAdmittanceGrid || m_chartMode == ChartMode::Admittance ||
+                            m_chartMode == ChartMode::Combined;
+    const double pixelRadius = glTessellationRadius();
+    
+    GlGridKey key;
+    key.pixelRadius = pixelRadius;
+    key.admittance = admittance;
+    key.showVSWRCircles = m_showVSWRCircles;
+    key.showQCircles = m_showQCircles;
+    key.generation = m_gridGeneration;
+    
+    // Standard grid: uploaded in Gamma coordinates, so pan and zoom only
+    // change the transform
+    if (key != m_glGridKey || !m_glRenderer->hasBatch(GlMajorGrid)) {
+        GlLineBuilder lines;
+        for (const GridArc& arc : GridGeometry::resistanceArcs()) lines.addArc(arc, pixelRadius);
+        for (const GridArc& arc : GridGeometry::reactanceArcs()) lines.addArc(arc, pixelRadius);
+        lines.addSegment(Complex(-1, 0), Complex(1, 0));
+        m_glRenderer->upload(GlMajorGrid, lines);
+        
+        lines.clear();
+        if (admittance) {
+            for (const GridArc& arc : GridGeometry::conductanceArcs()) lines.addArc(arc, pixelRadius);
+        }
+        m_glRenderer->upload(GlAdmittanceGrid, lines);
+        
+        GridArc circle;
+        circle.radius = 1.0;
+        circle.spanAngle = 2.0 * M_PI;
+        lines.clear();
+        lines.addArc(circle, pixelRadius);
+        m_glRenderer->upload(GlUnitCircle, lines);
+        
+        lines.clear();
+        if (m_showVSWRCircles) {
+            std::vector<double> vswrs = m_vswrCircles;
+            if (vswrs.empty()) {
+                vswrs = {1.5, 2.0, 3.0};
+            }
+            for (double vswr : vswrs) {
+                circle.radius = SmithMath::vswrToGamma(vswr);
+                lines.addArc(circle, pixelRadius);
+            }
+        }
+        m_glRenderer->upload(GlVswrCircles, lines);
+        
+        lines.clear();
+        if (m_showQCircles) {
+            GridArc arc;
+            for (double q : m_qValues) {
+                if (GridGeometry::qArc(q, true, arc)) lines.addArc(arc, pixelRadius);
+                if (GridGeometry::qArc(q, false, arc)) lines.addArc(arc, pixelRadius);
+            }
+        }
+        m_glRenderer->upload(GlQCircles, lines);
+        
+        m_glGridKey = key;
+    }
+    
+    // Minor lines depend on the viewport; re-upload only when the visible
+    // set changes
+    updateGridLines();
+    if (pixelRadius != m_glMinorPixelRadius ||
+        m_gridLines.resistances != m_glGridLines.resistances ||
+        m_gridLines.reactances != m_glGridLines.reactances ||
+        m_gridLines.conductances != m_glGridLines.conductances ||
+        m_gridLines.susceptances != m_glGridLines.susceptances) {
+        GlLineBuilder lines;
+        GridArc arc;
+        for (double r : m_gridLines.resistances) {
+            lines.addArc(GridGeometry::resistanceCircle(r), pixelRadius);
+        }
+        for (double x : m_gridLines.reactances) {
+            if (GridGeometry::reactanceArc(x, arc)) lines.addArc(arc, pixelRadius);
+        }
+        m_glRenderer->upload(GlMinorGrid, lines);
+        
+        lines.clear();
+        for (double g : m_gridLines.conductances) {
+            lines.addArc(GridGeometry::conductanceCircle(g), pixelRadius);
+        }
+        for (double b : m_gridLines.susceptances) {
+            if (GridGeometry::susceptanceArc(b, arc)) lines.addArc(arc, pixelRadius);
+        }
+        m_glRenderer->upload(GlMinorAdmittance, lines);
+        
+        m_glGridLines = m_gridLines;
+        m_glMinorPixelRadius = pixelRadius;
+    }
+    
+    // Same order and colors as drawGridLayers(); dashed pens are drawn solid
+    m_glRenderer->draw(GlMinorGrid, QColor(205, 205, 205));
+    if (admittance) {
+        m_glRenderer->draw(GlMinorAdmittance, QColor(200, 200, 225));
+    }
+    m_glRenderer->draw(GlMajorGrid, QColor(100, 100, 100));
+    m_glRenderer->draw(GlAdmittanceGrid, QColor(150, 150, 200));
+    m_glRenderer->draw(GlUnitCircle, Qt::black, 2.0f);
+    m_glRenderer->draw(GlVswrCircles, QColor(200, 100, 100));
+    m_glRenderer->draw(GlQCircles, QColor(0, 150, 100));
+}
+
+void SmithChartWidget::uploadGlTrace(int batch, GlTraceState& state, const void* source,
+                                     quint64 generation, const std::vector<Complex>& values)
+{
+    if (state.source == source && state.generation == generation &&
+        m_glRenderer->hasBatch(batch)) {
+        return;
+    }
+    
+    // Full resolution: unlike the raster LOD it stays valid at any zoom
+    GlLineBuilder lines;
+    lines.addPolyline(values.data(), values.size());
+    m_glRenderer->upload(batch, lines);
+    state.source = source;
+    state.generation = generation;
+}
+
+void SmithChartWidget::paintGlSParamTraces()
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::paintGlSParamTraces");
+    
+    // Drop the batches of removed overlays
+    for (std::size_t i = m_overlays.size(); i < m_glOverlayStates.size(); ++i) {
+        m_glRenderer->remove(GlOverlayBase + static_cast<int>(i));
+    }
+    m_glOverlayStates.resize(m_overlays.size());
+    
+    for (std::size_t i = 0; i < m_overlays.size(); ++i) {
+        const SParamOverlay& overlay = m_overlays[i];
+        if (!overlay.visible) continue;
+        const SParamData* data = overlayData(overlay);
+        const std::vector<Complex>* values = data ? plottedSParams(*data) : nullptr;
+        if (!values) continue;
+        
+        const int batch = GlOverlayBase + static_cast<int>(i);
+        uploadGlTrace(batch, m_glOverlayStates[i], data, overlay.generation, *values);
+        m_glRenderer->draw(batch, overlay.color);
+    }
+    
+    if (const std::vector<Complex>* values = plottedSParams(*m_sparamData)) {
+        uploadGlTrace(GlSParamTrace, m_glSParamState, m_sparamData.get(),
+                      m_sparamGeneration, *values);
+        m_glRenderer->draw(GlSParamTrace, Qt::blue, 2.0f);
     }
 }
 
+void SmithChartWidget::paintGlSweepTrace()
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::paintGlSweepTrace");
+    if (!m_sweepResult || m_sweepResult->isEmpty()) return;
+    
+    uploadGlTrace(GlSweepTrace, m_glSweepState, m_sweepResult.get(),
+                  m_sweepGeneration, m_sweepResult->gamma);
+    m_glRenderer->draw(GlSweepTrace, QColor(230, 120, 0), 2.0f);
+}
+
+void SmithChartWidget::drawFrequencyMarkers(QPainter& painter, const std::vector<Complex>& values,
+                                            const QColor& color, double markerRadius)
+{
+    // Same points as TraceLodCache::markers
+    painter.setPen(QPen(color, 2));
+    painter.setBrush(color);
+    const std::size_t count = values.size();
+    for (std::size_t i = 0; i < count; i += count / 10 + 1) {
+        painter.drawEllipse(gammaToScreen(values[i]), markerRadius, markerRadius);
+    }
+}
+#endif
+
+void SmithChartWidget::drawHoverDataMarker(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawHoverDataMarker");
+    if (m_hoverDataIndex < 0 || m_hoverDataIndex >= m_sparamData->numPoints()) return;
+    
+    int row = (m_sparamRow < m_sparamData->numPorts()) ? m_sparamRow : 0;
+    int col = (m_sparamCol < m_sparamData->numPorts()) ? m_sparamCol : 0;
+    QPointF pos = gammaToScreen(m_sparamData->s(m_hoverDataIndex, row, col));
+    
+    painter.setPen(QPen(Qt::blue, 2));
+    painter.setBrush(Qt::white);
+    painter.drawEllipse(pos, 5, 5);
+    
+    // Frequency label next to the point
+    QString label = QString("%1 GHz").arg(m_sparamData->frequency(m_hoverDataIndex) / 1e9, 0, 'f', 4);
+    QFont font = painter.font();
+    font.setPointSize(9);
+    painter.setFont(font);
+    painter.setPen(Qt::darkBlue);
+    painter.drawText(pos + QPointF(8, -8), label);
+}
+
 void SmithChartWidget::drawMarker(QPainter& painter)
 {
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawMarker");
     if (!m_markerVisible) return;
     
     QPointF pos = gammaToScreen(m_markerGamma);
@@ -764,59 +2039,117 @@ void SmithChartWidget::drawMarker(QPainter& painter)
     painter.drawEllipse(pos, 6, 6);
 }
 
-void SmithChartWidget::drawMatchingTrace(QPainter& painter)
+void SmithChartWidget::updateMatchingCache()
 {
-    if (m_matchingTrace.numSegments() == 0) return;
+    MatchingTraceCache& cache = m_matchingCache;
+    const qreal dpr = devicePixelRatioF();
+    const auto& segments = m_matchingTrace->segments();
+    
+    // A count mismatch means the shared trace was edited without a new
+    // generation; rebuild rather than index past the cache
+    if (cache.generation == m_matchingGeneration && cache.center == m_center &&
+        cache.radius == m_radius && cache.devicePixelRatio == dpr &&
+        cache.segments.size() == segments.size()) {
+        return;
+    }
     
-    const auto& segments = m_matchingTrace.segments();
+    cache.points.clear();
+    cache.segments.resize(segments.size());
     
     for (size_t i = 0; i < segments.size(); ++i) {
         const TraceSegment& seg = segments[i];
+        MatchingTraceCache::Segment& shape = cache.segments[i];
+        shape.first = cache.points.size();
+        shape.count = 0;
         if (seg.isEmpty()) continue;
         
-        // Set color for this segment
-        QPen pen(seg.color, 2);
-        painter.setPen(pen);
-        
-        // Draw trace path
-        QPainterPath path;
-        bool first = true;
+        // Constant R/X/G/B and line segments are exact circle arcs: flatten them
+        // from the circle itself instead of the sampled points
+        Complex arcCenter;
+        double arcRadius, startAngle, sweepAngle;
         
-        for (const auto& pt : seg.points) {
-            if (SmithMath::isInsideUnitCircle(pt.gamma)) {
-                QPointF screenPoint = gammaToScreen(pt.gamma);
-                if (first) {
-                    path.moveTo(screenPoint);
-                    first = false;
-                } else {
-                    path.lineTo(screenPoint);
+        if (seg.arcGeometry(m_matchingTrace->z0(), arcCenter, arcRadius,
+                            startAngle, sweepAngle)) {
+            const QPointF c = gammaToScreen(arcCenter);
+            const double r = arcRadius * m_radius;
+            
+            // Chord step whose sagitta stays below a quarter device pixel
+            const double tolerance = 0.25 / dpr;
+            double step = r > tolerance ? 2.0 * std::acos(1.0 - tolerance / r) : std::abs(sweepAngle);
+            int n = step > 0.0 ? static_cast<int>(std::ceil(std::abs(sweepAngle) / step)) : 1;
+            n = std::max(1, std::min(n, MAX_ARC_POINTS));
+            
+            // Angles run counter-clockwise with y pointing down
+            for (int k = 0; k <= n; ++k) {
+                double a = startAngle + sweepAngle * k / n;
+                cache.points.emplace_back(c.x() + r * std::cos(a), c.y() - r * std::sin(a));
+            }
+        } else {
+            m_gammaScratch.clear();
+            for (int k = 0; k < seg.points.size(); ++k) {
+                const Complex gamma = seg.points.gamma(k);
+                if (SmithMath::isInsideUnitCircle(gamma)) {
+                    m_gammaScratch.push_back(gamma);
                 }
             }
+            cache.points.resize(shape.first + m_gammaScratch.size());
+            SmithMath::gammaToScreen(m_gammaScratch.data(), cache.points.data() + shape.first,
+                                     m_gammaScratch.size(), m_center, m_radius);
         }
+        shape.count = cache.points.size() - shape.first;
         
-        painter.drawPath(path);
+        if (!seg.points.empty()) {
+            shape.start = gammaToScreen(seg.points.gamma(0));
+            shape.label = gammaToScreen(seg.points.gamma(seg.points.size() / 2));
+        }
+    }
+    
+    cache.generation = m_matchingGeneration;
+    cache.center = m_center;
+    cache.radius = m_radius;
+    cache.devicePixelRatio = dpr;
+}
+
+void SmithChartWidget::drawMatchingTrace(QPainter& painter)
+{
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawMatchingTrace");
+    if (m_matchingTrace->numSegments() == 0) return;
+    
+    updateMatchingCache();
+    
+    const auto& segments = m_matchingTrace->segments();
+    painter.setFont(m_traceLabelFont);
+    
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const TraceSegment& seg = segments[i];
+        if (seg.isEmpty() || i >= m_matchingCache.segments.size()) continue;
+        const MatchingTraceCache::Segment& shape = m_matchingCache.segments[i];
+        
+        // Set color for this segment
+        QPen pen(seg.color, 2);
+        painter.setPen(pen);
+        painter.drawPolyline(m_matchingCache.points.data() + shape.first,
+                             static_cast<int>(shape.count));
         
         // Draw start point marker
         if (!seg.points.empty()) {
-            QPointF startPt = gammaToScreen(seg.startPoint().gamma);
             painter.setBrush(seg.color);
-            painter.drawEllipse(startPt, 4, 4);
+            painter.drawEllipse(shape.start, 4, 4);
         }
         
         // Draw label
         if (!seg.label.isEmpty() && !seg.points.empty()) {
-            QPointF midPoint = gammaToScreen(seg.points[seg.points.size() / 2].gamma);
-            painter.setFont(QFont("Arial", 8));
-            painter.drawText(midPoint + QPointF(5, -5), seg.label);
+            painter.drawText(shape.label + QPointF(5, -5), seg.label);
         }
     }
 }
 
 void SmithChartWidget::drawDragHandles(QPainter& painter)
 {
-    if (m_matchingTrace.numSegments() == 0) return;
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawDragHandles");
+    if (m_matchingTrace->numSegments() == 0) return;
     
-    const auto& segments = m_matchingTrace.segments();
+    const auto& segments = m_matchingTrace->segments();
     
     for (size_t i = 0; i < segments.size(); ++i) {
         const TraceSegment& seg = segments[i];
@@ -867,6 +2200,7 @@ void SmithChartWidget::drawDragHandles(QPainter& painter)
 
 void SmithChartWidget::drawImpedanceMarkers(QPainter& painter)
 {
+    SMITHTOOL_PROFILE_SCOPE("SmithChartWidget::drawImpedanceMarkers");
     // Draw source impedance marker (Zs) - Green square
     if (m_sourceVisible) {
         Complex gammaS = SmithMath::impedanceToGamma(m_sourceZ, m_z0);
@@ -948,8 +2282,8 @@ void SmithChartWidget::contextMenuEvent(QContextMenuEvent* event)
     // Check if clicking on a trace endpoint
     int hitSegment = hitTestTraceEndpoint(event->pos());
     
-    if (hitSegment >= 0 && m_matchingTrace.numSegments() > 0) {
-        const auto& seg = m_matchingTrace.segment(hitSegment);
+    if (hitSegment >= 0 && m_matchingTrace->numSegments() > 0) {
+        const auto& seg = m_matchingTrace->segment(hitSegment);
         
         QString componentName;
         switch (seg.componentType) {
@@ -7,29 +7,36 @@
 #define SMITHTOOL_SMITHCHARTWIDGET_H
 
 #include <QWidget>
+#ifdef SMITHTOOL_ENABLE_OPENGL
+#include <QOpenGLWidget>
+#endif
 #include <QPainter>
 #include <QMouseEvent>
 #include <QContextMenuEvent>
+#include <QElapsedTimer>
+#include <QPixmap>
+#include <QTimer>
 #include <complex>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "../core/smithmath.h"
 #include "../core/impedance.h"
 #include "../core/component.h"
 #include "../core/trace.h"
+#include "../core/sweep.h"
+#include "../core/montecarlo.h"
+#include "../core/pointgrid.h"
+#include "../core/gridgeometry.h"
 #include "../data/sparamdata.h"
+#include "../data/sparamstatistics.h"
+#include "../data/twoportanalyzer.h"
+#include "chartrenderer.h"
 
 namespace SmithTool {
 
-/**
- * @brief Display mode for Smith Chart
- */
-enum class ChartMode {
-    Impedance,      // Z Smith Chart
-    Admittance,     // Y Smith Chart
-    Combined        // Both overlaid
-};
-
 /**
  * @brief Interaction mode for Smith Chart
  */
@@ -39,16 +46,28 @@ enum class InteractionMode {
     DragEdit        // Drag trace endpoint to modify element
 };
 
+#ifdef SMITHTOOL_ENABLE_OPENGL
+class ChartGlRenderer;
+class GlLineBuilder;
+using SmithChartBase = QOpenGLWidget;
+#else
+using SmithChartBase = QWidget;
+#endif
+
 /**
  * @brief Interactive Smith Chart widget
+ * 
+ * Built with SMITHTOOL_ENABLE_OPENGL, the widget is a QOpenGLWidget and
+ * can draw the grid and traces from GPU vertex buffers (see
+ * setGpuRendering()); the public API is the same in both builds.
  */
-class SmithChartWidget : public QWidget {
+class SmithChartWidget : public SmithChartBase {
     Q_OBJECT
 
 public:
     explicit SmithChartWidget(QWidget* parent = nullptr);
-    ~SmithChartWidget() override = default;
-
+    ~SmithChartWidget() override;
+    
     // Chart settings
     void setZ0(double z0);
     double z0() const { return m_z0; }
@@ -61,8 +80,108 @@ public:
     
     // Data display
     void setSParamData(const SParamData& data);
+    void setSParamData(SParamData&& data);
+    
+    /**
+     * @brief Show S-parameter data without copying it
+     * 
+     * The widget keeps a reference to the data, so the caller can share
+     * the same object (e.g. a freshly loaded file) with other views.
+     */
+    void setSParamData(std::shared_ptr<const SParamData> data);
+    std::shared_ptr<const SParamData> sparamData() const { return m_sparamData; }
     void clearSParamData();
     
+    /**
+     * @brief Overlay another dataset, e.g. one unit of a production lot
+     * 
+     * Overlays plot the same Sij as the main trace, underneath it and
+     * without frequency markers. All overlays are drawn in one pass from
+     * their cached decimated polylines.
+     * 
+     * @param data Dataset (shared, not copied)
+     * @param color Trace color (invalid = pick from a palette)
+     * @return Overlay index
+     */
+    int addSParamData(std::shared_ptr<const SParamData> data, const QColor& color = QColor());
+    
+    /**
+     * @brief Overlay a dataset that is loaded when first needed
+     * 
+     * The loader runs (once, on the GUI thread) the first time the overlay
+     * is drawn while visible or its data is requested; a null result
+     * leaves the overlay empty.
+     */
+    using SParamLoader = std::function<std::shared_ptr<const SParamData>()>;
+    int addLazySParamData(SParamLoader loader, const QColor& color = QColor());
+    void removeSParamOverlay(int index);
+    void clearSParamOverlays();
+    int sparamOverlayCount() const { return static_cast<int>(m_overlays.size()); }
+    
+    void setSParamOverlayColor(int index, const QColor& color);
+    QColor sparamOverlayColor(int index) const;
+    void setSParamOverlayVisible(int index, bool visible);
+    bool isSParamOverlayVisible(int index) const;
+    
+    /**
+     * @brief Show the statistical envelope of a lot (see SParamStatistics)
+     * 
+     * Drawn under the traces as a filled band between the minimum and
+     * maximum |Sij| at the phase of the mean, with the percentile contour
+     * dashed and the mean as a thin line. The envelope is shared, not
+     * copied.
+     */
+    void setSParamEnvelope(std::shared_ptr<const SParamEnvelope> envelope,
+                           const QColor& color = QColor(0, 120, 215));
+    void clearSParamEnvelope();
+    std::shared_ptr<const SParamEnvelope> sparamEnvelope() const { return m_envelope; }
+    
+    // Circles of a two-port analysis that setTwoPortCircles() can show
+    enum TwoPortLayer {
+        SourceStabilityLayer = 1,
+        LoadStabilityLayer = 2,
+        GainCirclesLayer = 4,
+        NoiseCirclesLayer = 8
+    };
+    
+    /**
+     * @brief Show the two-port circles of one analyzed frequency
+     * 
+     * Stability circles are drawn with the unstable side hatched, gain and
+     * noise circles as labelled contours, all clipped to the chart. The
+     * analysis is shared and only looked up per frame, so scrubbing the
+     * frequency costs a repaint.
+     * 
+     * @param analysis Analysis of the shown two-port, or null to hide
+     * @param index Point of the analysis to show
+     * @param layers TwoPortLayer flags
+     */
+    void setTwoPortCircles(std::shared_ptr<const TwoPortAnalysis> analysis,
+                           int index, int layers);
+    void clearTwoPortCircles() { setTwoPortCircles(nullptr, -1, 0); }
+    
+    /**
+     * @brief Show the end points of a Monte Carlo run as a scatter cloud
+     * 
+     * Samples meeting the return-loss mask are drawn green, the others
+     * red, one dot per occupied pixel. The result is shared, not copied.
+     */
+    void setMonteCarloResult(std::shared_ptr<const MonteCarloResult> result);
+    void clearMonteCarloResult();
+    std::shared_ptr<const MonteCarloResult> monteCarloResult() const { return m_monteCarlo; }
+    
+    // Dataset of an overlay, loading it if lazy (null for an invalid index)
+    std::shared_ptr<const SParamData> sparamOverlayData(int index) const;
+    
+    /**
+     * @brief Select which Sij of the loaded data is plotted
+     * @param row Zero-based output port i
+     * @param col Zero-based input port j
+     */
+    void setSParamTrace(int row, int col);
+    int sparamTraceRow() const { return m_sparamRow; }
+    int sparamTraceCol() const { return m_sparamCol; }
+    
     // Marker
     void setMarkerGamma(const Complex& gamma);
     void setMarkerImpedance(const Complex& z);
@@ -83,11 +202,66 @@ public:
     void setShowLabels(bool show);
     void setShowQCircles(bool show);
     void setQValues(const std::vector<double>& qValues);
+    const std::vector<double>& qValues() const { return m_qValues; }
+    
+    /**
+     * @brief Enable layered rendering
+     * 
+     * When enabled (default), the static grid layers are rendered once into
+     * an offscreen pixmap and only traces, handles and markers are painted
+     * on top of it in each paintEvent.
+     */
+    void setLayeredRendering(bool enabled);
+    bool layeredRendering() const { return m_layeredRendering; }
+    
+    /**
+     * @brief Draw the grid and traces with OpenGL
+     * 
+     * Grid lines and full-resolution traces are uploaded to vertex buffers
+     * in Gamma-plane coordinates and only re-uploaded when they change;
+     * pan and zoom just update the transform. Labels, markers, handles and
+     * the HUD are still painted with QPainter on top. Dashed grid lines
+     * are drawn solid. Has no effect unless isGpuRenderingAvailable(), or
+     * if the context cannot compile the shaders.
+     */
+    void setGpuRendering(bool enabled);
+    bool gpuRendering() const { return m_gpuRendering; }
+    
+    // Whether the OpenGL backend was compiled in
+    static bool isGpuRenderingAvailable();
+    
+    /**
+     * @brief Snapshot of what the chart shows, for ChartRenderer
+     * 
+     * Data, overlays and the sweep are shared; the matching trace is
+     * copied, since its owner edits it in place. Hidden overlays, the
+     * envelope, two-port circles and Monte Carlo clouds are left out.
+     * Zoom and pan are not part of it: exports show the whole chart.
+     */
+    ChartScene scene() const;
     
     // Matching trace
     void setMatchingTrace(const MatchingTrace& trace);
+    
+    /**
+     * @brief Share a trace owned elsewhere instead of copying it
+     * 
+     * The widget keeps a reference and repaints from it directly; the
+     * owner must call this again after editing so the cached screen
+     * geometry is rebuilt.
+     */
+    void setMatchingTrace(std::shared_ptr<const MatchingTrace> trace);
     void clearMatchingTrace();
     
+    /**
+     * @brief Show a frequency sweep of the matching network
+     * 
+     * The Gamma values are drawn as a frequency trace like S-parameter
+     * data. The result is shared, not copied.
+     */
+    void setSweepResult(std::shared_ptr<const SweepResult> result);
+    void clearSweepResult();
+    
     // VSWR circles
     void addVSWRCircle(double vswr);
     void clearVSWRCircles();
@@ -97,6 +271,32 @@ public:
     InteractionMode interactionMode() const { return m_interactionMode; }
     void setPendingElementType(ComponentType type, ConnectionType conn);
     void cancelPendingElement();
+    
+    /**
+     * @brief Work done for the last (or current) drag edit
+     * 
+     * Mouse moves are coalesced to one elementValueDragged per display
+     * frame; frameMs is the time spent in the connected handlers.
+     */
+    struct DragFrameStats {
+        int mouseEvents = 0;        // Drag moves received
+        int frames = 0;             // Moves actually emitted
+        double totalFrameMs = 0.0;
+        double maxFrameMs = 0.0;
+        
+        double averageFrameMs() const { return frames > 0 ? totalFrameMs / frames : 0.0; }
+    };
+    const DragFrameStats& dragFrameStats() const { return m_dragStats; }
+    
+    /**
+     * @brief Show the performance HUD
+     * 
+     * Overlays the repaint rate, the paint time of each layer in the last
+     * frame and the drag-to-pixel latency (mouse move received to frame
+     * painted) in the top-left corner.
+     */
+    void setHudVisible(bool visible);
+    bool isHudVisible() const { return m_hudVisible; }
 
 signals:
     /**
@@ -151,13 +351,19 @@ signals:
     void editElementRequested(int segmentIndex);
 
 protected:
+#ifdef SMITHTOOL_ENABLE_OPENGL
+    void initializeGL() override;
+    void paintGL() override;
+#else
     void paintEvent(QPaintEvent* event) override;
+#endif
     void mousePressEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
     void wheelEvent(QWheelEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
     void contextMenuEvent(QContextMenuEvent* event) override;
+    void leaveEvent(QEvent* event) override;
 
 private:
     // Chart geometry
@@ -199,41 +405,295 @@ private:
     double m_originalValue;
     static constexpr double DRAG_HIT_RADIUS = 10.0; // Pixels
     
+    // Drag coalescing: latest value, emitted at most once per frame
+    QTimer m_dragFrameTimer;
+    bool m_dragPending;
+    double m_pendingDragValue;
+    DragFrameStats m_dragStats;
+    
     // Zoom and pan
     double m_zoomLevel;
     QPointF m_panOffset;
     bool m_isPanning;
     QPointF m_panStartPos;
     static constexpr double MIN_ZOOM = 0.5;
-    static constexpr double MAX_ZOOM = 5.0;
+    static constexpr double MAX_ZOOM = 128.0;
+    
+    // Minor grid lines added as the zoom level grows
+    AdaptiveGrid m_adaptiveGrid;
+    GridLines m_gridLines;
     
     // Data
-    SParamData m_sparamData;
+    std::shared_ptr<const SParamData> m_sparamData;   // Never null
+    int m_sparamRow;
+    int m_sparamCol;
+    quint64 m_sparamGeneration;                  // Bumped when the plotted Sij changes
     std::vector<double> m_vswrCircles;
     std::vector<double> m_qValues;
-    MatchingTrace m_matchingTrace;
+    std::shared_ptr<const MatchingTrace> m_matchingTrace;
+    std::shared_ptr<const SweepResult> m_sweepResult;
+    quint64 m_sweepGeneration;
+    
+    /**
+     * @brief Decimated screen polyline of one trace
+     * 
+     * Rebuilt only when the trace data or the chart geometry (size, zoom,
+     * pan) changes, so dense traces cost a few points per pixel column.
+     */
+    struct TraceLodCache {
+        quint64 generation = 0;
+        QPointF center;
+        double radius = 0.0;
+        qreal devicePixelRatio = 0.0;
+        std::vector<QPointF> polyline;
+        std::vector<QPointF> markers;     // Frequency markers (every ~10 %)
+    };
+    
+    TraceLodCache m_sparamLod;
+    TraceLodCache m_sweepLod;
+    
+    struct SParamOverlay {
+        mutable std::shared_ptr<const SParamData> data;
+        mutable SParamLoader loader;      // Pending lazy load
+        QColor color;
+        bool visible = true;
+        quint64 generation = 1;           // Bumped when the plotted Sij changes
+        TraceLodCache lod;
+    };
+    std::vector<SParamOverlay> m_overlays;
+    
+    // Lot envelope, in screen space for the current geometry
+    struct EnvelopeCache {
+        quint64 generation = 0;
+        QPointF center;
+        double radius = 0.0;
+        QPolygonF band;                  // Max forward, then min backward
+        QPolygonF percentile;
+        QPolygonF mean;
+    };
+    std::shared_ptr<const SParamEnvelope> m_envelope;
+    QColor m_envelopeColor;
+    quint64 m_envelopeGeneration;
+    EnvelopeCache m_envelopeCache;
+    
+    // Two-port circles of one frequency
+    std::shared_ptr<const TwoPortAnalysis> m_twoPort;
+    int m_twoPortIndex;
+    int m_twoPortLayers;
+    static constexpr double MAX_CIRCLE_RADIUS = 1e3;    // Γ units; larger ones are skipped
+    
+    // Monte Carlo cloud, deduplicated per pixel for the current geometry
+    struct MonteCarloCache {
+        quint64 generation = 0;
+        QPointF center;
+        double radius = 0.0;
+        QSize size;
+        QPolygonF passed;
+        QPolygonF failed;
+    };
+    std::shared_ptr<const MonteCarloResult> m_monteCarlo;
+    quint64 m_monteCarloGeneration;
+    MonteCarloCache m_monteCarloCache;
+    std::vector<QPointF> m_lodScratch;   // Full-resolution points while rebuilding
+    
+    /**
+     * @brief Screen-space hit-test index, rebuilt lazily
+     * 
+     * Keyed like TraceLodCache; the first query after a data or geometry
+     * change rebuilds it, later mouse moves only query it.
+     */
+    struct PointIndexCache {
+        quint64 generation = 0;
+        QPointF center;
+        double radius = 0.0;
+        PointGrid grid;
+        std::vector<int> sourceIndex;     // Grid point -> segment / data point
+    };
+    
+    PointIndexCache m_handleIndex;
+    PointIndexCache m_dataIndex;
+    quint64 m_matchingGeneration;
+    
+    /**
+     * @brief Screen polyline of the matching trace, one range per segment
+     * 
+     * Keyed like TraceLodCache on m_matchingGeneration. Constant R/X/G/B
+     * arcs are flattened to within a quarter device pixel, so every
+     * segment is drawn with one drawPolyline() and painting allocates
+     * nothing once the cache is built.
+     */
+    struct MatchingTraceCache {
+        struct Segment {
+            std::size_t first = 0;          // Range in points
+            std::size_t count = 0;
+            QPointF start;                  // Start point marker
+            QPointF label;                  // Label anchor (mid point)
+        };
+        
+        quint64 generation = 0;
+        QPointF center;
+        double radius = 0.0;
+        qreal devicePixelRatio = 0.0;
+        std::vector<QPointF> points;
+        std::vector<Segment> segments;      // By trace segment
+    };
+    
+    MatchingTraceCache m_matchingCache;
+    std::vector<Complex> m_gammaScratch;    // Visible Gamma while rebuilding
+    QFont m_traceLabelFont;
+    static constexpr int MAX_ARC_POINTS = 4096;
+    int m_hoverDataIndex;                // Nearest measured point, or -1
+    static constexpr double DATA_HOVER_RADIUS = 12.0; // Pixels
+    
+    /**
+     * @brief Everything the static grid layer depends on
+     */
+    struct GridCacheKey {
+        QSize size;
+        qreal devicePixelRatio = 1.0;
+        double zoomLevel = 0.0;
+        QPointF panOffset;
+        double z0 = 0.0;
+        ChartMode chartMode = ChartMode::Impedance;
+        bool showAdmittanceGrid = false;
+        bool showVSWRCircles = false;
+        bool showLabels = false;
+        bool showQCircles = false;
+        quint64 generation = 0;     // Bumped when VSWR/Q circle lists change
+        
+        bool operator==(const GridCacheKey& other) const;
+        bool operator!=(const GridCacheKey& other) const { return !(*this == other); }
+    };
+    
+    // Cached static grid layer
+    bool m_layeredRendering;
+    QPixmap m_gridCache;
+    GridCacheKey m_gridCacheKey;
+    quint64 m_gridGeneration;
     
-    // Standard grid values
-    static const std::vector<double> s_resistanceValues;
-    static const std::vector<double> s_reactanceValues;
+    // Performance HUD
+    enum HudLayer {
+        HudGrid,
+        HudSParams,
+        HudSweep,
+        HudMatching,
+        HudMarkers,
+        HUD_LAYER_COUNT
+    };
+    bool m_hudVisible;
+    double m_hudLayerMs[HUD_LAYER_COUNT];
+    double m_hudPaintMs;
+    QElapsedTimer m_hudClock;
+    std::deque<qint64> m_hudFrameNs;     // Paint times within the last second
+    qint64 m_dragInputNs;                // First move not yet painted, or -1
+    double m_dragLatencyMs;
+    double m_dragLatencyMaxMs;
+    void drawHud(QPainter& painter);
+    
+    // Paints one frame with QPainter, or OpenGL plus QPainter on top
+    void paintChart();
+    
+    // OpenGL backend
+    bool m_gpuRendering;
+#ifdef SMITHTOOL_ENABLE_OPENGL
+    enum GlBatch {
+        GlMajorGrid,
+        GlAdmittanceGrid,
+        GlUnitCircle,
+        GlVswrCircles,
+        GlQCircles,
+        GlMinorGrid,
+        GlMinorAdmittance,
+        GlSParamTrace,
+        GlSweepTrace,
+        GlOverlayBase           // One batch per overlay from here on
+    };
+    
+    // What the uploaded standard grid was built for
+    struct GlGridKey {
+        double pixelRadius = 0.0;   // Tessellation radius
+        bool admittance = false;
+        bool showVSWRCircles = false;
+        bool showQCircles = false;
+        quint64 generation = 0;
+        
+        bool operator==(const GlGridKey& other) const;
+        bool operator!=(const GlGridKey& other) const { return !(*this == other); }
+    };
+    
+    // What an uploaded trace batch was built from
+    struct GlTraceState {
+        const void* source = nullptr;
+        quint64 generation = 0;
+    };
+    
+    std::unique_ptr<ChartGlRenderer> m_glRenderer;
+    bool m_glReady;
+    GlGridKey m_glGridKey;
+    GridLines m_glGridLines;             // Minor lines in the GlMinor* batches
+    double m_glMinorPixelRadius;
+    GlTraceState m_glSParamState;
+    GlTraceState m_glSweepState;
+    std::vector<GlTraceState> m_glOverlayStates;
+    
+    double glTessellationRadius() const;
+    void releaseGl();
+    void paintGlGrid();
+    void paintGlSParamTraces();
+    void paintGlSweepTrace();
+    void uploadGlTrace(int batch, GlTraceState& state, const void* source,
+                       quint64 generation, const std::vector<Complex>& values);
+    void drawFrequencyMarkers(QPainter& painter, const std::vector<Complex>& values,
+                              const QColor& color, double markerRadius);
+#endif
+
+    // Grid layer caching
+    GridCacheKey currentGridCacheKey() const;
+    void updateGridCache();
+    void drawGridLayers(QPainter& painter);
     
     // Drawing methods
     void drawBackground(QPainter& painter);
     void drawUnitCircle(QPainter& painter);
+    int updateGridLines();
+    void drawAdaptiveGrid(QPainter& painter);
+    void drawAdaptiveLabels(QPainter& painter);
     void drawResistanceCircles(QPainter& painter);
     void drawReactanceArcs(QPainter& painter);
     void drawAdmittanceGrid(QPainter& painter);
     void drawVSWRCircles(QPainter& painter);
     void drawQCircles(QPainter& painter);
+    void drawQLabels(QPainter& painter);
     void drawLabels(QPainter& painter);
+    const std::vector<Complex>* plottedSParams(const SParamData& data) const;
+    const SParamData* overlayData(const SParamOverlay& overlay) const;
+    int addOverlay(SParamOverlay overlay, const QColor& color);
     void drawSParamTrace(QPainter& painter);
+    void drawSParamOverlays(QPainter& painter);
+    void drawSParamEnvelope(QPainter& painter);
+    void drawTwoPortCircles(QPainter& painter);
+    void drawSmithCircle(QPainter& painter, const SmithCircle& circle,
+                         const QPen& pen, const QString& label, bool stability = false);
+    void drawMonteCarloCloud(QPainter& painter);
+    void drawSweepTrace(QPainter& painter);
+    void updateTraceLod(TraceLodCache& cache, quint64 generation,
+                        const std::vector<Complex>& values);
+    void drawTraceLod(QPainter& painter, const TraceLodCache& cache,
+                      const QColor& color, double markerRadius);
     void drawMarker(QPainter& painter);
+    void updateMatchingCache();
     void drawMatchingTrace(QPainter& painter);
     void drawDragHandles(QPainter& painter);
     void drawImpedanceMarkers(QPainter& painter);
     
     // Drag detection
-    int hitTestTraceEndpoint(const QPointF& pos) const;
+    int hitTestTraceEndpoint(const QPointF& pos);
+    void queueDragValue(double value);
+    void flushPendingDrag();
+    int frameIntervalMs() const;
+    int hitTestDataPoint(const QPointF& pos);
+    bool indexIsCurrent(const PointIndexCache& cache, quint64 generation) const;
+    void drawHoverDataMarker(QPainter& painter);
     double calculateNewValueFromDrag(int segmentIndex, const Complex& newGamma) const;
     
     // Coordinate conversion
@@ -244,9 +704,24 @@ private:
     void updateChartGeometry();
     QRectF circleRect(const QPointF& center, double radius) const;
     
-    // Arc clipping (clip to unit circle)
-    void drawClippedArc(QPainter& painter, const QPointF& center, 
-                        double radius, double startAngle, double spanAngle);
+    /**
+     * @brief Screen bounds of the small overlays, for partial repaints
+     * 
+     * Each covers everything its draw method paints (pen width and
+     * labels included); an empty rect if nothing is drawn. Moving one of
+     * them repaints only its old and new bounds.
+     */
+    QRect markerBounds() const;
+    QRect impedanceMarkerBounds(const Complex& z, const QString& label) const;
+    QRect sourceMarkerBounds() const;
+    QRect loadMarkerBounds() const;
+    QRect handleBounds(int segmentIndex) const;
+    QRect hoverDataBounds(int index) const;
+    void updateBounds(const QRect& before, const QRect& after);
+    
+    // Append Gamma-plane grid arcs (see GridGeometry) in screen space
+    void addGridArcs(QPainterPath& path, const std::vector<GridArc>& arcs) const;
+    void addGridArc(QPainterPath& path, const GridArc& arc) const;
 };
 
 } // namespace SmithTool
@@ -0,0 +1,146 @@
+/**
+ * @file tdrpanel.cpp
+ * @brief Time-domain reflectometry panel implementation
+ */
+
+#include "tdrpanel.h"
+#include <QHBoxLayout>
+#include <QSignalBlocker>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace SmithTool {
+
+TdrPanel::TdrPanel(QWidget* parent)
+    : QWidget(parent)
+    , m_watcher(new ResultWatcher(this))
+    , m_refreshPending(false)
+{
+    m_responseCombo = new QComboBox(this);
+    m_responseCombo->addItem(tr("Impedance"), static_cast<int>(TdrResponse::Impedance));
+    m_responseCombo->addItem(tr("Step (\u03c1)"), static_cast<int>(TdrResponse::Step));
+    m_responseCombo->addItem(tr("Impulse"), static_cast<int>(TdrResponse::Impulse));
+    
+    m_windowCombo = new QComboBox(this);
+    m_windowCombo->addItem(tr("Kaiser (\u03b2 = 6)"), static_cast<int>(TdrWindow::Kaiser));
+    m_windowCombo->addItem(tr("Blackman"), static_cast<int>(TdrWindow::Blackman));
+    m_windowCombo->addItem(tr("Hann"), static_cast<int>(TdrWindow::Hann));
+    m_windowCombo->addItem(tr("Hamming"), static_cast<int>(TdrWindow::Hamming));
+    m_windowCombo->addItem(tr("Rectangular"), static_cast<int>(TdrWindow::Rectangular));
+    
+    m_portCombo = new QComboBox(this);
+    m_portCombo->addItem("S11", 0);
+    
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setStyleSheet("color: gray;");
+    
+    m_plot = new TdrPlotWidget(this);
+    m_plot->setResponse(TdrResponse::Impedance);
+    
+    auto* controls = new QHBoxLayout;
+    controls->addWidget(m_portCombo);
+    controls->addWidget(m_responseCombo);
+    controls->addWidget(m_windowCombo);
+    controls->addStretch();
+    controls->addWidget(m_statusLabel);
+    
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+    layout->addLayout(controls);
+    layout->addWidget(m_plot, 1);
+    
+    // The response only changes what is drawn from the same result
+    connect(m_responseCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        m_plot->setResponse(static_cast<TdrResponse>(m_responseCombo->currentData().toInt()));
+    });
+    connect(m_windowCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TdrPanel::refresh);
+    connect(m_portCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TdrPanel::refresh);
+    connect(m_watcher, &ResultWatcher::finished, this, &TdrPanel::onComputeFinished);
+}
+
+TdrPanel::~TdrPanel()
+{
+    m_watcher->waitForFinished();
+}
+
+TdrSettings TdrPanel::settings() const
+{
+    TdrSettings settings;
+    settings.window = static_cast<TdrWindow>(m_windowCombo->currentData().toInt());
+    settings.port = std::max(0, m_portCombo->currentData().toInt());
+    return settings;
+}
+
+void TdrPanel::setData(std::shared_ptr<const SParamData> data)
+{
+    m_data = std::move(data);
+    
+    // One reflection per port
+    const int ports = m_data ? std::max(1, m_data->numPorts()) : 1;
+    if (m_portCombo->count() != ports) {
+        QSignalBlocker blocker(m_portCombo);
+        const int current = m_portCombo->currentIndex();
+        m_portCombo->clear();
+        for (int i = 1; i <= ports; ++i) {
+            m_portCombo->addItem(QString("S%1%1").arg(i), i - 1);
+        }
+        m_portCombo->setCurrentIndex(std::min(std::max(current, 0), ports - 1));
+    }
+    refresh();
+}
+
+void TdrPanel::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    refresh();
+}
+
+void TdrPanel::refresh()
+{
+    if (!isVisible()) return;
+    
+    if (!m_data || m_data->numPoints() < 2) {
+        m_plot->setResult(nullptr);
+        m_statusLabel->clear();
+        return;
+    }
+    
+    const TdrSettings current = settings();
+    if (std::shared_ptr<const TdrResult> result = m_analyzer.cached(m_data, current)) {
+        m_plot->setResult(std::move(result));
+        m_statusLabel->setText(tr("cached"));
+        return;
+    }
+    
+    if (m_watcher->isRunning()) {
+        m_refreshPending = true;
+        return;
+    }
+    
+    m_computingData = m_data;
+    m_computeClock.start();
+    m_statusLabel->setText(tr("computing..."));
+    std::shared_ptr<const SParamData> data = m_data;
+    m_watcher->setFuture(QtConcurrent::run([data, current]() {
+        return std::make_shared<const TdrResult>(TdrAnalyzer::compute(*data, current));
+    }));
+}
+
+void TdrPanel::onComputeFinished()
+{
+    std::shared_ptr<const TdrResult> result = m_watcher->result();
+    m_analyzer.insert(m_computingData, result);
+    const bool current = m_computingData == m_data && result->settings == settings();
+    m_computingData.reset();
+    
+    if (m_refreshPending || !current) {
+        m_refreshPending = false;
+        refresh();
+        return;
+    }
+    m_plot->setResult(result);
+    m_statusLabel->setText(tr("%1 ms").arg(m_computeClock.elapsed()));
+}
+
+} // namespace SmithTool
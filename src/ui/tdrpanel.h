@@ -0,0 +1,70 @@
+/**
+ * @file tdrpanel.h
+ * @brief Time-domain reflectometry panel: response plot and its settings
+ */
+
+#ifndef SMITHTOOL_TDRPANEL_H
+#define SMITHTOOL_TDRPANEL_H
+
+#include <QWidget>
+#include <QComboBox>
+#include <QLabel>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <memory>
+#include "tdrplotwidget.h"
+#include "../data/tdranalyzer.h"
+
+namespace SmithTool {
+
+/**
+ * @brief Shows the TDR response of the current dataset
+ *
+ * Responses are computed in the background and cached per dataset and
+ * window settings, so switching between impulse, step and impedance
+ * (one result holds all three) or back to an earlier window is
+ * immediate. Nothing is computed while the panel is hidden.
+ */
+class TdrPanel : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit TdrPanel(QWidget* parent = nullptr);
+    ~TdrPanel() override;
+    
+    /**
+     * @brief Dataset whose reflection is transformed
+     * @param data Shared with the caller; never copied
+     */
+    void setData(std::shared_ptr<const SParamData> data);
+    
+    TdrSettings settings() const;
+
+protected:
+    void showEvent(QShowEvent* event) override;
+
+private slots:
+    void refresh();
+    void onComputeFinished();
+
+private:
+    TdrPlotWidget* m_plot;
+    QComboBox* m_responseCombo;
+    QComboBox* m_windowCombo;
+    QComboBox* m_portCombo;
+    QLabel* m_statusLabel;
+    
+    std::shared_ptr<const SParamData> m_data;
+    TdrAnalyzer m_analyzer;
+    
+    // One computation at a time; the latest request wins
+    using ResultWatcher = QFutureWatcher<std::shared_ptr<const TdrResult>>;
+    ResultWatcher* m_watcher;
+    std::shared_ptr<const SParamData> m_computingData;
+    QElapsedTimer m_computeClock;
+    bool m_refreshPending;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_TDRPANEL_H
@@ -0,0 +1,267 @@
+/**
+ * @file tdrplotwidget.cpp
+ * @brief Time-domain (TDR) response plot implementation
+ */
+
+#include "tdrplotwidget.h"
+#include "../core/decimation.h"
+#include "../core/profiler.h"
+#include <QFontMetrics>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace SmithTool {
+
+namespace {
+
+// 1, 2 or 5 times a power of ten, giving about `ticks` divisions
+double niceStep(double range, int ticks)
+{
+    if (!(range > 0.0)) return 1.0;
+    double raw = range / ticks;
+    double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+    double fraction = raw / magnitude;
+    if (fraction < 1.5) return magnitude;
+    if (fraction < 3.5) return 2.0 * magnitude;
+    if (fraction < 7.5) return 5.0 * magnitude;
+    return 10.0 * magnitude;
+}
+
+} // namespace
+
+TdrPlotWidget::TdrPlotWidget(QWidget* parent)
+    : QWidget(parent)
+    , m_response(TdrResponse::Impedance)
+    , m_timeSpan(0.0)
+    , m_hoverIndex(-1)
+    , m_font("Arial", 8)
+{
+    setMinimumSize(240, 140);
+    setMouseTracking(true);
+}
+
+void TdrPlotWidget::setResult(std::shared_ptr<const TdrResult> result)
+{
+    // Keep the zoom while the same kind of data is re-windowed
+    if (!result || !m_result || result->timeStep != m_result->timeStep) {
+        m_timeSpan = 0.0;
+    }
+    m_result = std::move(result);
+    m_hoverIndex = -1;
+    update();
+}
+
+void TdrPlotWidget::setResponse(TdrResponse response)
+{
+    if (response != m_response) {
+        m_response = response;
+        update();
+    }
+}
+
+double TdrPlotWidget::valueAt(int index) const
+{
+    switch (m_response) {
+        case TdrResponse::Impulse:
+            return m_result->impulse[index];
+        case TdrResponse::Step:
+            return m_result->step[index];
+        default:
+            return m_result->impedance(index);
+    }
+}
+
+QRectF TdrPlotWidget::plotRect() const
+{
+    return QRectF(MARGIN_LEFT, MARGIN_TOP, std::max(1, width() - MARGIN_LEFT - MARGIN_RIGHT),
+                  std::max(1, height() - MARGIN_TOP - MARGIN_BOTTOM));
+}
+
+int TdrPlotWidget::visibleSamples() const
+{
+    if (!m_result || m_result->isEmpty()) return 0;
+    if (m_timeSpan <= 0.0) return m_result->size();
+    int count = static_cast<int>(std::ceil(m_timeSpan / m_result->timeStep)) + 1;
+    return std::clamp(count, 2, m_result->size());
+}
+
+void TdrPlotWidget::updatePolyline()
+{
+    PolylineCache& cache = m_cache;
+    const QRectF plot = plotRect();
+    const qreal dpr = devicePixelRatioF();
+    if (cache.result == m_result.get() && cache.response == m_response &&
+        cache.timeSpan == m_timeSpan && cache.plot == plot && cache.devicePixelRatio == dpr) {
+        return;
+    }
+    SMITHTOOL_PROFILE_SCOPE("TdrPlotWidget::updatePolyline");
+    
+    const int count = visibleSamples();
+    
+    // Value range of the visible part, with a little headroom
+    double lo = 0.0, hi = 0.0;
+    for (int i = 0; i < count; ++i) {
+        double v = valueAt(i);
+        if (i == 0 || v < lo) lo = v;
+        if (i == 0 || v > hi) hi = v;
+    }
+    if (m_response == TdrResponse::Impedance) {
+        // An open end would squash everything else
+        hi = std::min(hi, 10.0 * m_result->z0);
+        lo = std::max(lo, 0.0);
+    }
+    if (hi - lo < 1e-6) {
+        lo -= 0.5;
+        hi += 0.5;
+    }
+    const double pad = 0.08 * (hi - lo);
+    cache.minValue = lo - pad;
+    cache.maxValue = hi + pad;
+    
+    const double xScale = count > 1 ? plot.width() / (count - 1) : 0.0;
+    const double yScale = plot.height() / (cache.maxValue - cache.minValue);
+    cache.points.resize(count);
+    for (int i = 0; i < count; ++i) {
+        double v = std::clamp(valueAt(i), cache.minValue, cache.maxValue);
+        cache.points[i] = QPointF(plot.left() + i * xScale, plot.bottom() - (v - cache.minValue) * yScale);
+    }
+    PolylineDecimator::minMaxPerColumn(cache.points.data(), cache.points.size(), cache.decimated, dpr);
+    
+    cache.result = m_result.get();
+    cache.response = m_response;
+    cache.timeSpan = m_timeSpan;
+    cache.plot = plot;
+    cache.devicePixelRatio = dpr;
+}
+
+void TdrPlotWidget::paintEvent(QPaintEvent* /* event */)
+{
+    SMITHTOOL_PROFILE_SCOPE("TdrPlotWidget::paintEvent");
+    
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::white);
+    painter.setFont(m_font);
+    
+    const QRectF plot = plotRect();
+    painter.setPen(QPen(Qt::gray, 1));
+    painter.drawRect(plot);
+    
+    if (!m_result || m_result->isEmpty()) {
+        painter.setPen(Qt::darkGray);
+        painter.drawText(rect(), Qt::AlignCenter, tr("No reflection data"));
+        return;
+    }
+    
+    updatePolyline();
+    const int count = visibleSamples();
+    const double span = (count - 1) * m_result->timeStep;
+    
+    // Time grid in ns
+    const QFontMetrics metrics(m_font);
+    const double spanNs = span * 1e9;
+    const double xStep = niceStep(spanNs, std::max(2, static_cast<int>(plot.width() / 80)));
+    for (double t = 0.0; t <= spanNs * (1.0 + 1e-9); t += xStep) {
+        double x = plot.left() + plot.width() * t / spanNs;
+        painter.setPen(QPen(QColor(230, 230, 230), 1));
+        painter.drawLine(QPointF(x, plot.top()), QPointF(x, plot.bottom()));
+        painter.setPen(Qt::darkGray);
+        QString label = QString::number(t, 'g', 4);
+        painter.drawText(QPointF(x - metrics.horizontalAdvance(label) / 2.0, plot.bottom() + 14), label);
+    }
+    painter.drawText(QPointF(plot.right() - metrics.horizontalAdvance("ns"), height() - 4), "ns");
+    
+    // Value grid
+    const double range = m_cache.maxValue - m_cache.minValue;
+    const double yStep = niceStep(range, std::max(2, static_cast<int>(plot.height() / 40)));
+    for (double v = std::ceil(m_cache.minValue / yStep) * yStep; v <= m_cache.maxValue; v += yStep) {
+        double y = plot.bottom() - plot.height() * (v - m_cache.minValue) / range;
+        painter.setPen(QPen(QColor(230, 230, 230), 1));
+        painter.drawLine(QPointF(plot.left(), y), QPointF(plot.right(), y));
+        painter.setPen(Qt::darkGray);
+        QString label = QString::number(std::abs(v) < 1e-9 * range ? 0.0 : v, 'g', 4);
+        painter.drawText(QPointF(plot.left() - 4 - metrics.horizontalAdvance(label), y + 4), label);
+    }
+    
+    // Reference line: Z0 for impedance, zero otherwise
+    const double reference = m_response == TdrResponse::Impedance ? m_result->z0 : 0.0;
+    if (reference > m_cache.minValue && reference < m_cache.maxValue) {
+        double y = plot.bottom() - plot.height() * (reference - m_cache.minValue) / range;
+        painter.setPen(QPen(Qt::gray, 1, Qt::DashLine));
+        painter.drawLine(QPointF(plot.left(), y), QPointF(plot.right(), y));
+    }
+    
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setClipRect(plot);
+    painter.setPen(QPen(QColor(0, 100, 200), 1.5));
+    painter.drawPolyline(m_cache.decimated.data(), static_cast<int>(m_cache.decimated.size()));
+    painter.setClipping(false);
+    
+    // Readout of the sample under the cursor
+    static const char* units[] = {"", "", " \u03a9"};
+    QString readout;
+    if (m_hoverIndex >= 0 && m_hoverIndex < count) {
+        const QPointF& p = m_cache.points[m_hoverIndex];
+        painter.setPen(QPen(Qt::darkGray, 1, Qt::DotLine));
+        painter.drawLine(QPointF(p.x(), plot.top()), QPointF(p.x(), plot.bottom()));
+        readout = QString("t = %1 ns   %2%3")
+            .arg(m_result->time(m_hoverIndex) * 1e9, 0, 'f', 3)
+            .arg(valueAt(m_hoverIndex), 0, 'g', 5)
+            .arg(units[static_cast<int>(m_response)]);
+    } else {
+        readout = tr("%1 harmonics, FFT %2, %3 ps/sample")
+            .arg(m_result->harmonics)
+            .arg(m_result->fftSize)
+            .arg(m_result->timeStep * 1e12, 0, 'f', 2);
+    }
+    painter.setPen(Qt::black);
+    painter.drawText(QPointF(plot.left(), MARGIN_TOP - 6), readout);
+}
+
+void TdrPlotWidget::wheelEvent(QWheelEvent* event)
+{
+    if (!m_result || m_result->isEmpty()) return;
+    
+    const double full = (m_result->size() - 1) * m_result->timeStep;
+    const double current = m_timeSpan > 0.0 ? m_timeSpan : full;
+    const double factor = event->angleDelta().y() > 0 ? 0.8 : 1.25;
+    double span = std::clamp(current * factor, 16 * m_result->timeStep, full);
+    m_timeSpan = span >= full ? 0.0 : span;
+    m_hoverIndex = -1;
+    update();
+    event->accept();
+}
+
+void TdrPlotWidget::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    m_timeSpan = 0.0;
+    update();
+    event->accept();
+}
+
+void TdrPlotWidget::mouseMoveEvent(QMouseEvent* event)
+{
+    const int count = visibleSamples();
+    const QRectF plot = plotRect();
+    int index = -1;
+    if (count > 1 && plot.contains(event->position())) {
+        double x = (event->position().x() - plot.left()) / plot.width();
+        index = static_cast<int>(std::lround(x * (count - 1)));
+    }
+    if (index != m_hoverIndex) {
+        m_hoverIndex = index;
+        update();
+    }
+}
+
+void TdrPlotWidget::leaveEvent(QEvent* /* event */)
+{
+    if (m_hoverIndex >= 0) {
+        m_hoverIndex = -1;
+        update();
+    }
+}
+
+} // namespace SmithTool
@@ -0,0 +1,90 @@
+/**
+ * @file tdrplotwidget.h
+ * @brief Time-domain (TDR) response plot
+ */
+
+#ifndef SMITHTOOL_TDRPLOTWIDGET_H
+#define SMITHTOOL_TDRPLOTWIDGET_H
+
+#include <QWidget>
+#include <QFont>
+#include <memory>
+#include <vector>
+#include "../data/tdranalyzer.h"
+
+namespace SmithTool {
+
+/**
+ * @brief Quantity plotted over round-trip time
+ */
+enum class TdrResponse {
+    Impulse,
+    Step,           // Reflection coefficient
+    Impedance
+};
+
+/**
+ * @brief Plots one TdrResult against time
+ *
+ * The visible samples are mapped to screen once per result, response,
+ * zoom and size, and reduced to the extremes of each pixel column, so
+ * repaints of 64k-point responses draw a few thousand points. The wheel
+ * zooms the time axis about the cursor, a double click shows everything.
+ */
+class TdrPlotWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit TdrPlotWidget(QWidget* parent = nullptr);
+    ~TdrPlotWidget() override = default;
+    
+    void setResult(std::shared_ptr<const TdrResult> result);
+    std::shared_ptr<const TdrResult> result() const { return m_result; }
+    
+    void setResponse(TdrResponse response);
+    TdrResponse response() const { return m_response; }
+    
+    QSize sizeHint() const override { return QSize(480, 220); }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void leaveEvent(QEvent* event) override;
+
+private:
+    double valueAt(int index) const;
+    QRectF plotRect() const;
+    void updatePolyline();
+    int visibleSamples() const;
+    
+    std::shared_ptr<const TdrResult> m_result;
+    TdrResponse m_response;
+    double m_timeSpan;          // Visible time from 0 (s); 0 = whole response
+    int m_hoverIndex;           // Sample under the cursor, -1 = none
+    QFont m_font;
+    
+    // Screen polyline of the visible samples, rebuilt when its inputs change
+    struct PolylineCache {
+        const TdrResult* result = nullptr;
+        TdrResponse response = TdrResponse::Step;
+        double timeSpan = -1.0;
+        QRectF plot;
+        qreal devicePixelRatio = 0.0;
+        double minValue = 0.0;
+        double maxValue = 1.0;
+        std::vector<QPointF> points;
+        std::vector<QPointF> decimated;
+    };
+    PolylineCache m_cache;
+    
+    static constexpr int MARGIN_LEFT = 56;
+    static constexpr int MARGIN_RIGHT = 12;
+    static constexpr int MARGIN_TOP = 22;
+    static constexpr int MARGIN_BOTTOM = 26;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_TDRPLOTWIDGET_H
@@ -0,0 +1,210 @@
+/**
+ * @file twoportpanel.cpp
+ * @brief Two-port stability and gain panel implementation
+ */
+
+#include "twoportpanel.h"
+#include "smithchartwidget.h"
+#include <QHBoxLayout>
+#include <QSignalBlocker>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+
+namespace SmithTool {
+
+namespace {
+
+QString formatFrequency(double freq)
+{
+    if (freq >= 1e9) {
+        return QString("%1 GHz").arg(freq / 1e9, 0, 'f', 3);
+    } else if (freq >= 1e6) {
+        return QString("%1 MHz").arg(freq / 1e6, 0, 'f', 3);
+    } else if (freq >= 1e3) {
+        return QString("%1 kHz").arg(freq / 1e3, 0, 'f', 3);
+    }
+    return QString("%1 Hz").arg(freq, 0, 'f', 1);
+}
+
+} // namespace
+
+TwoPortPanel::TwoPortPanel(QWidget* parent)
+    : QWidget(parent)
+    , m_watcher(new ResultWatcher(this))
+    , m_refreshPending(false)
+{
+    m_frequencySlider = new QSlider(Qt::Horizontal, this);
+    m_frequencySlider->setEnabled(false);
+    
+    m_readoutLabel = new QLabel(this);
+    m_readoutLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setStyleSheet("color: gray;");
+    
+    m_sourceCheck = new QCheckBox(tr("Source stability"), this);
+    m_loadCheck = new QCheckBox(tr("Load stability"), this);
+    m_gainCheck = new QCheckBox(tr("Gain circles"), this);
+    m_noiseCheck = new QCheckBox(tr("Noise circles"), this);
+    m_sourceCheck->setChecked(true);
+    m_loadCheck->setChecked(true);
+    m_gainCheck->setChecked(true);
+    m_noiseCheck->setChecked(true);
+    
+    auto* checks = new QHBoxLayout;
+    checks->addWidget(m_sourceCheck);
+    checks->addWidget(m_loadCheck);
+    checks->addWidget(m_gainCheck);
+    checks->addWidget(m_noiseCheck);
+    checks->addStretch();
+    checks->addWidget(m_statusLabel);
+    
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+    layout->addWidget(m_frequencySlider);
+    layout->addWidget(m_readoutLabel);
+    layout->addLayout(checks);
+    layout->addStretch();
+    
+    // Scrubbing and toggling layers only select from the same analysis
+    connect(m_frequencySlider, &QSlider::valueChanged, this, &TwoPortPanel::updateSelection);
+    for (QCheckBox* check : {m_sourceCheck, m_loadCheck, m_gainCheck, m_noiseCheck}) {
+        connect(check, &QCheckBox::toggled, this, &TwoPortPanel::updateSelection);
+    }
+    connect(m_watcher, &ResultWatcher::finished, this, &TwoPortPanel::onComputeFinished);
+}
+
+TwoPortPanel::~TwoPortPanel()
+{
+    m_watcher->waitForFinished();
+}
+
+int TwoPortPanel::layers() const
+{
+    int layers = 0;
+    if (m_sourceCheck->isChecked()) layers |= SmithChartWidget::SourceStabilityLayer;
+    if (m_loadCheck->isChecked()) layers |= SmithChartWidget::LoadStabilityLayer;
+    if (m_gainCheck->isChecked()) layers |= SmithChartWidget::GainCirclesLayer;
+    if (m_noiseCheck->isChecked()) layers |= SmithChartWidget::NoiseCirclesLayer;
+    return layers;
+}
+
+void TwoPortPanel::setData(std::shared_ptr<const SParamData> data)
+{
+    m_data = std::move(data);
+    refresh();
+}
+
+void TwoPortPanel::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    refresh();
+}
+
+void TwoPortPanel::hideEvent(QHideEvent* event)
+{
+    QWidget::hideEvent(event);
+    emit circlesChanged(nullptr, -1, 0);
+}
+
+void TwoPortPanel::refresh()
+{
+    if (!isVisible()) return;
+    
+    if (!m_data || m_data->numPorts() < 2 || m_data->isEmpty()) {
+        setAnalysis(nullptr);
+        m_statusLabel->setText(m_data && !m_data->isEmpty() ? tr("needs two-port data") : QString());
+        return;
+    }
+    
+    if (std::shared_ptr<const TwoPortAnalysis> analysis = m_analyzer.cached(m_data)) {
+        setAnalysis(std::move(analysis));
+        m_statusLabel->setText(tr("cached"));
+        return;
+    }
+    
+    if (m_watcher->isRunning()) {
+        m_refreshPending = true;
+        return;
+    }
+    
+    m_computingData = m_data;
+    m_computeClock.start();
+    m_statusLabel->setText(tr("computing..."));
+    std::shared_ptr<const SParamData> data = m_data;
+    m_watcher->setFuture(QtConcurrent::run([data]() {
+        return std::make_shared<const TwoPortAnalysis>(TwoPortAnalyzer::compute(*data));
+    }));
+}
+
+void TwoPortPanel::onComputeFinished()
+{
+    std::shared_ptr<const TwoPortAnalysis> analysis = m_watcher->result();
+    m_analyzer.insert(m_computingData, analysis);
+    const bool current = m_computingData == m_data;
+    m_computingData.reset();
+    
+    if (m_refreshPending || !current) {
+        m_refreshPending = false;
+        refresh();
+        return;
+    }
+    setAnalysis(analysis);
+    m_statusLabel->setText(tr("%1 ms").arg(m_computeClock.elapsed()));
+}
+
+void TwoPortPanel::setAnalysis(std::shared_ptr<const TwoPortAnalysis> analysis)
+{
+    if (analysis && analysis->isEmpty()) analysis.reset();
+    
+    // Keep the slider near the same frequency when the data changes
+    const double previous = (m_analysis && m_frequencySlider->isEnabled())
+        ? m_analysis->frequencies[m_frequencySlider->value()] : 0.0;
+    m_analysis = std::move(analysis);
+    
+    {
+        QSignalBlocker blocker(m_frequencySlider);
+        if (m_analysis) {
+            const std::vector<double>& freqs = m_analysis->frequencies;
+            int index = static_cast<int>(std::lower_bound(freqs.begin(), freqs.end(), previous) -
+                                         freqs.begin());
+            m_frequencySlider->setRange(0, m_analysis->size() - 1);
+            m_frequencySlider->setValue(std::min(index, m_analysis->size() - 1));
+        } else {
+            m_frequencySlider->setRange(0, 0);
+        }
+        m_frequencySlider->setEnabled(m_analysis != nullptr);
+    }
+    m_noiseCheck->setEnabled(m_analysis && m_analysis->hasNoise());
+    updateSelection();
+}
+
+void TwoPortPanel::updateSelection()
+{
+    if (!m_analysis) {
+        m_readoutLabel->clear();
+        emit circlesChanged(nullptr, -1, 0);
+        return;
+    }
+    
+    const TwoPortAnalysis& analysis = *m_analysis;
+    const int i = m_frequencySlider->value();
+    QString text = tr("%1   K = %2   \u03bc = %3   %4 = %5 dB")
+        .arg(formatFrequency(analysis.frequencies[i]))
+        .arg(analysis.k[i], 0, 'f', 3)
+        .arg(analysis.mu[i], 0, 'f', 3)
+        .arg(analysis.isStable(i) ? tr("MAG") : tr("MSG"))
+        .arg(analysis.maxGainDb[i], 0, 'f', 2);
+    if (!analysis.isStable(i)) {
+        text += tr("   (potentially unstable)");
+    }
+    if (analysis.hasNoise() && std::isfinite(analysis.fMinDb[i])) {
+        text += tr("   NFmin = %1 dB").arg(analysis.fMinDb[i], 0, 'f', 2);
+    }
+    m_readoutLabel->setText(text);
+    emit circlesChanged(m_analysis, i, layers());
+}
+
+} // namespace SmithTool
@@ -0,0 +1,85 @@
+/**
+ * @file twoportpanel.h
+ * @brief Two-port stability and gain panel: frequency scrubber and layers
+ */
+
+#ifndef SMITHTOOL_TWOPORTPANEL_H
+#define SMITHTOOL_TWOPORTPANEL_H
+
+#include <QWidget>
+#include <QCheckBox>
+#include <QLabel>
+#include <QSlider>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <memory>
+#include "../data/twoportanalyzer.h"
+
+namespace SmithTool {
+
+/**
+ * @brief Scrubs the stability, gain and noise circles of a two-port
+ *
+ * The analysis of the whole frequency axis is computed once per dataset
+ * in the background and cached, so moving the slider only selects a
+ * point of it. Nothing is computed while the panel is hidden, and the
+ * circles are withdrawn when it is hidden.
+ */
+class TwoPortPanel : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit TwoPortPanel(QWidget* parent = nullptr);
+    ~TwoPortPanel() override;
+    
+    /**
+     * @brief Dataset to analyze; one-port data shows nothing
+     * @param data Shared with the caller; never copied
+     */
+    void setData(std::shared_ptr<const SParamData> data);
+    
+    // TwoPortLayer flags of SmithChartWidget
+    int layers() const;
+
+signals:
+    /**
+     * @brief The circles to show changed
+     * @param analysis Null when nothing should be shown
+     */
+    void circlesChanged(std::shared_ptr<const TwoPortAnalysis> analysis, int index, int layers);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private slots:
+    void refresh();
+    void onComputeFinished();
+    void updateSelection();
+
+private:
+    void setAnalysis(std::shared_ptr<const TwoPortAnalysis> analysis);
+    
+    QSlider* m_frequencySlider;
+    QLabel* m_readoutLabel;
+    QLabel* m_statusLabel;
+    QCheckBox* m_sourceCheck;
+    QCheckBox* m_loadCheck;
+    QCheckBox* m_gainCheck;
+    QCheckBox* m_noiseCheck;
+    
+    std::shared_ptr<const SParamData> m_data;
+    std::shared_ptr<const TwoPortAnalysis> m_analysis;     // Shown, or null
+    TwoPortAnalyzer m_analyzer;
+    
+    // One computation at a time; the latest request wins
+    using ResultWatcher = QFutureWatcher<std::shared_ptr<const TwoPortAnalysis>>;
+    ResultWatcher* m_watcher;
+    std::shared_ptr<const SParamData> m_computingData;
+    QElapsedTimer m_computeClock;
+    bool m_refreshPending;
+};
+
+} // namespace SmithTool
+
+#endif // SMITHTOOL_TWOPORTPANEL_H
@@ -0,0 +1,154 @@
+/**
+ * @file test_deembedder.cpp
+ * @brief De-embedding undoes embedding, and the other inverse pairs
+ */
+
+#include "../src/core/smithmath.h"
+#include "../src/data/deembedder.h"
+
+#include <QtTest>
+#include <cmath>
+
+using namespace SmithTool;
+
+namespace {
+
+constexpr double TOLERANCE = 1e-9;
+
+// A lossy, slightly mismatched line on an evenly spaced sweep
+SParamData makeNetwork(int ports, int points, double loss, double delay, double fStop = 10e9)
+{
+    std::vector<double> freqs(points);
+    std::vector<std::vector<Complex>> params(ports * ports, std::vector<Complex>(points));
+    for (int i = 0; i < points; ++i) {
+        const double t = static_cast<double>(i) / (points - 1);
+        freqs[i] = 100e6 + t * (fStop - 100e6);
+        const double phase = -SmithMath::TWO_PI * freqs[i] * delay;
+        params[0][i] = std::polar(0.05 + 0.1 * t, 0.3 + 2.0 * phase);
+        if (ports == 2) {
+            params[1][i] = std::polar(1.0 - loss * t, phase);
+            params[2][i] = std::polar(1.0 - loss * t, phase + 0.01);
+            params[3][i] = std::polar(0.04 + 0.06 * t, -0.2 + 2.0 * phase);
+        }
+    }
+    SParamData data;
+    data.setNumPorts(ports);
+    data.assignPoints(std::move(freqs), std::move(params));
+    return data;
+}
+
+bool samePoints(const SParamData& a, const SParamData& b)
+{
+    if (a.numPorts() != b.numPorts() || a.frequencyData() != b.frequencyData()) {
+        return false;
+    }
+    for (int row = 0; row < a.numPorts(); ++row) {
+        for (int col = 0; col < a.numPorts(); ++col) {
+            const std::vector<Complex>& x = a.sData(row, col);
+            const std::vector<Complex>& y = b.sData(row, col);
+            for (std::size_t i = 0; i < x.size(); ++i) {
+                if (std::abs(x[i] - y[i]) > TOLERANCE) return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+class TestDeembedder : public QObject {
+    Q_OBJECT
+
+private slots:
+    void deembedUndoesEmbed_data();
+    void deembedUndoesEmbed();
+    void deembedOnePort();
+    void extendPortsInverse();
+    void renormalizeInverse();
+};
+
+void TestDeembedder::deembedUndoesEmbed_data()
+{
+    QTest::addColumn<int>("points");
+    QTest::addColumn<int>("fixturePoints");
+    QTest::addColumn<int>("threads");
+    
+    QTest::newRow("same sweep") << 1601 << 1601 << 1;
+    QTest::newRow("interpolated fixtures") << 1601 << 201 << 1;
+    QTest::newRow("threaded") << 4 * Deembedder::MIN_POINTS_PER_THREAD << 201 << 4;
+}
+
+void TestDeembedder::deembedUndoesEmbed()
+{
+    QFETCH(int, points);
+    QFETCH(int, fixturePoints);
+    QFETCH(int, threads);
+    
+    const SParamData device = makeNetwork(2, points, 0.3, 1.2e-9);
+    // The fixtures span a wider sweep so interpolation never extrapolates
+    const SParamData left = makeNetwork(2, fixturePoints, 0.05, 80e-12, 12e9);
+    const SParamData right = makeNetwork(2, fixturePoints, 0.08, 50e-12, 12e9);
+    
+    Deembedder deembedder;
+    deembedder.setThreadCount(threads);
+    SParamData embedded;
+    SParamData restored;
+    QString error;
+    QVERIFY2(deembedder.embed(device, &left, &right, embedded, error), qPrintable(error));
+    QVERIFY(!samePoints(device, embedded));
+    QVERIFY2(deembedder.deembed(embedded, &left, &right, restored, error), qPrintable(error));
+    QVERIFY(samePoints(device, restored));
+    
+    // One side only
+    QVERIFY2(deembedder.embed(device, nullptr, &right, embedded, error), qPrintable(error));
+    QVERIFY2(deembedder.deembed(embedded, nullptr, &right, restored, error), qPrintable(error));
+    QVERIFY(samePoints(device, restored));
+}
+
+void TestDeembedder::deembedOnePort()
+{
+    const SParamData device = makeNetwork(1, 801, 0.0, 0.4e-9);
+    const SParamData fixture = makeNetwork(2, 801, 0.1, 60e-12);
+    
+    Deembedder deembedder;
+    SParamData embedded;
+    SParamData restored;
+    QString error;
+    QVERIFY2(deembedder.embed(device, &fixture, nullptr, embedded, error), qPrintable(error));
+    QVERIFY2(deembedder.deembed(embedded, &fixture, nullptr, restored, error), qPrintable(error));
+    QVERIFY(samePoints(device, restored));
+    
+    // A one-port has no port 2
+    QVERIFY(!deembedder.deembed(device, &fixture, &fixture, restored, error));
+    QVERIFY(!error.isEmpty());
+}
+
+void TestDeembedder::extendPortsInverse()
+{
+    const SParamData data = makeNetwork(2, 1001, 0.2, 1e-9);
+    
+    Deembedder deembedder;
+    SParamData extended;
+    SParamData restored;
+    QString error;
+    QVERIFY2(deembedder.extendPorts(data, {35e-12, -12e-12}, extended, error), qPrintable(error));
+    QVERIFY2(deembedder.extendPorts(extended, {-35e-12, 12e-12}, restored, error), qPrintable(error));
+    QVERIFY(samePoints(data, restored));
+}
+
+void TestDeembedder::renormalizeInverse()
+{
+    const SParamData data = makeNetwork(2, 1001, 0.2, 1e-9);
+    
+    Deembedder deembedder;
+    SParamData converted;
+    SParamData restored;
+    QString error;
+    QVERIFY2(deembedder.renormalize(data, 75.0, converted, error), qPrintable(error));
+    QCOMPARE(converted.referenceImpedance(), 75.0);
+    QVERIFY2(deembedder.renormalize(converted, 50.0, restored, error), qPrintable(error));
+    QVERIFY(samePoints(data, restored));
+}
+
+QTEST_APPLESS_MAIN(TestDeembedder)
+#include "test_deembedder.moc"
@@ -0,0 +1,178 @@
+/**
+ * @file test_fileformats.cpp
+ * @brief Round trips through the binary S-parameter cache and project files
+ */
+
+#include "../src/data/projectfile.h"
+#include "../src/data/sparamcache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <cmath>
+
+using namespace SmithTool;
+
+namespace {
+
+std::shared_ptr<SParamData> makeTwoPort(int points)
+{
+    std::vector<double> freqs(points);
+    std::vector<std::vector<Complex>> params(4, std::vector<Complex>(points));
+    for (int i = 0; i < points; ++i) {
+        freqs[i] = 1e6 + 1e6 * i * i;
+        params[0][i] = std::polar(0.1 + 1e-4 * i, 0.01 * i);
+        params[1][i] = std::polar(0.9, -0.02 * i);
+        params[2][i] = std::polar(0.85, -0.02 * i);
+        params[3][i] = Complex(-0.2, 1e-3 * i);
+    }
+    auto data = std::make_shared<SParamData>();
+    data->setNumPorts(2);
+    data->assignPoints(std::move(freqs), std::move(params));
+    data->setReferenceImpedance(75.0);
+    return data;
+}
+
+// Bit-exact comparison; both formats store the doubles unchanged
+bool samePoints(const SParamData& a, const SParamData& b)
+{
+    if (a.numPorts() != b.numPorts() || a.referenceImpedance() != b.referenceImpedance() ||
+        a.frequencyData() != b.frequencyData()) {
+        return false;
+    }
+    for (int row = 0; row < a.numPorts(); ++row) {
+        for (int col = 0; col < a.numPorts(); ++col) {
+            if (a.sData(row, col) != b.sData(row, col)) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+class TestFileFormats : public QObject {
+    Q_OBJECT
+
+private slots:
+    void sparamCacheRoundTrip();
+    void sparamCacheRejectsCorruption();
+    void projectRoundTrip();
+
+private:
+    QTemporaryDir m_dir;
+};
+
+void TestFileFormats::sparamCacheRoundTrip()
+{
+    QVERIFY(m_dir.isValid());
+    const QString path = m_dir.filePath("data.smtsp");
+    const std::shared_ptr<SParamData> data = makeTwoPort(1001);
+    
+    SParamCacheInfo info;
+    info.format = SParamFormat::DB;
+    info.frequencyMultiplier = 1e6;
+    info.source.size = 12345;
+    info.source.modifiedMs = 1700000000000LL;
+    info.source.hash = 0x0123456789abcdefULL;
+    QString error;
+    QVERIFY2(SParamCache::write(path, *data, info, error), qPrintable(error));
+    QCOMPARE(QFileInfo(path).size(), SParamCache::encodedSize(*data));
+    QVERIFY(SParamCache::isCacheFile(path));
+    
+    SParamData loaded;
+    SParamCacheInfo loadedInfo;
+    QVERIFY2(SParamCache::read(path, loaded, loadedInfo, error), qPrintable(error));
+    QVERIFY(samePoints(*data, loaded));
+    QVERIFY(loadedInfo.format == SParamFormat::DB);
+    QCOMPARE(loadedInfo.frequencyMultiplier, 1e6);
+    QVERIFY(loadedInfo.source == info.source);
+}
+
+void TestFileFormats::sparamCacheRejectsCorruption()
+{
+    QVERIFY(m_dir.isValid());
+    const QString path = m_dir.filePath("corrupt.smtsp");
+    const std::shared_ptr<SParamData> data = makeTwoPort(64);
+    QString error;
+    QVERIFY2(SParamCache::write(path, *data, SParamCacheInfo(), error), qPrintable(error));
+    
+    // Flip one byte of the last S22 value; the payload checksum must catch it
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(file.size() - 1));
+    char byte = 0;
+    QVERIFY(file.getChar(&byte));
+    QVERIFY(file.seek(file.size() - 1));
+    QVERIFY(file.putChar(static_cast<char>(byte ^ 0x01)));
+    file.close();
+    
+    SParamData loaded;
+    SParamCacheInfo loadedInfo;
+    QVERIFY(!SParamCache::read(path, loaded, loadedInfo, error));
+    QVERIFY(!error.isEmpty());
+}
+
+void TestFileFormats::projectRoundTrip()
+{
+    QVERIFY(m_dir.isValid());
+    const QString path = m_dir.filePath("project.smtproj");
+    
+    ProjectState state;
+    state.sourceZ = Complex(25.0, -5.0);
+    state.loadZ = Complex(12.5, 30.0);
+    state.z0 = 75.0;
+    state.frequency = 2.4e9;
+    state.elements.push_back(ElementSpec(ComponentType::Inductor, ConnectionType::Series,
+                                         3.3e-9));
+    state.elements.push_back(ElementSpec(ComponentType::Capacitor, ConnectionType::Shunt,
+                                         1.5e-12));
+    state.settings["showAdmittance"] = true;
+    state.settings["vswrCircle"] = 2.0;
+    
+    ProjectDataset current;
+    current.name = "dut.s2p";
+    current.role = ProjectDataset::Role::Current;
+    current.data = makeTwoPort(501);
+    ProjectDataset overlay;
+    overlay.name = "unit2.s2p";
+    overlay.color = QColor(0, 128, 255);
+    overlay.visible = false;
+    overlay.data = makeTwoPort(33);
+    state.datasets.push_back(current);
+    state.datasets.push_back(overlay);
+    
+    QString error;
+    QVERIFY2(ProjectFile::write(path, state, error), qPrintable(error));
+    QVERIFY(ProjectFile::isProjectFile(path));
+    
+    ProjectFile project;
+    QVERIFY2(project.open(path, error), qPrintable(error));
+    const ProjectState& loaded = project.state();
+    QCOMPARE(loaded.sourceZ, state.sourceZ);
+    QCOMPARE(loaded.loadZ, state.loadZ);
+    QCOMPARE(loaded.z0, state.z0);
+    QCOMPARE(loaded.frequency, state.frequency);
+    QVERIFY(loaded.elements == state.elements);
+    QCOMPARE(loaded.settings, state.settings);
+    
+    QCOMPARE(project.datasetCount(), 2);
+    for (int i = 0; i < project.datasetCount(); ++i) {
+        const ProjectDataset& expected = state.datasets[i];
+        const ProjectDataset& entry = loaded.datasets[i];
+        QCOMPARE(entry.name, expected.name);
+        QVERIFY(entry.role == expected.role);
+        QCOMPARE(entry.visible, expected.visible);
+        QCOMPARE(entry.numPoints, static_cast<qint64>(expected.data->numPoints()));
+        if (expected.role == ProjectDataset::Role::Overlay) {
+            QCOMPARE(entry.color, expected.color);
+        }
+        
+        std::shared_ptr<const SParamData> data = project.loadDataset(i, error);
+        QVERIFY2(data, qPrintable(error));
+        QVERIFY(samePoints(*expected.data, *data));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestFileFormats)
+#include "test_fileformats.moc"
@@ -0,0 +1,128 @@
+/**
+ * @file test_smithmath.cpp
+ * @brief The SIMD batch conversions against their scalar counterparts
+ */
+
+#include "../src/core/smithmath.h"
+
+#include <QtTest>
+#include <cmath>
+#include <vector>
+
+using namespace SmithTool;
+
+namespace {
+
+// Odd count so the scalar remainder loop runs after the SIMD blocks
+constexpr int COUNT = 1027;
+constexpr double TOLERANCE = 1e-12;
+
+bool near(const Complex& a, const Complex& b)
+{
+    return std::abs(a - b) <= TOLERANCE * std::max(1.0, std::abs(b));
+}
+
+bool near(double a, double b)
+{
+    return std::abs(a - b) <= TOLERANCE * std::max(1.0, std::abs(b));
+}
+
+// Impedances from near short to near open, both signs of reactance
+std::vector<Complex> makeImpedances()
+{
+    std::vector<Complex> z(COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        const double t = static_cast<double>(i) / (COUNT - 1);
+        z[i] = Complex(0.5 + 500.0 * t * t, 300.0 * std::sin(7.0 * t));
+    }
+    return z;
+}
+
+} // namespace
+
+class TestSmithMath : public QObject {
+    Q_OBJECT
+
+private slots:
+    void impedanceToGamma();
+    void impedanceToGammaSplit();
+    void gammaToImpedance();
+    void gammaMagnitudeAndVswr();
+    void multiplyComplex();
+};
+
+void TestSmithMath::impedanceToGamma()
+{
+    const std::vector<Complex> z = makeImpedances();
+    std::vector<Complex> gamma(COUNT);
+    SmithMath::impedanceToGamma(z.data(), gamma.data(), COUNT, 75.0);
+    for (int i = 0; i < COUNT; ++i) {
+        QVERIFY2(near(gamma[i], SmithMath::impedanceToGamma(z[i], 75.0)),
+                 qPrintable(QString("index %1 (%2)").arg(i).arg(SmithMath::simdBackend())));
+    }
+    
+    // In place
+    std::vector<Complex> inPlace = z;
+    SmithMath::impedanceToGamma(inPlace.data(), inPlace.data(), COUNT, 75.0);
+    QVERIFY(inPlace == gamma);
+}
+
+void TestSmithMath::impedanceToGammaSplit()
+{
+    const std::vector<Complex> z = makeImpedances();
+    std::vector<double> zRe(COUNT), zIm(COUNT), gammaRe(COUNT), gammaIm(COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        zRe[i] = z[i].real();
+        zIm[i] = z[i].imag();
+    }
+    SmithMath::impedanceToGamma(zRe.data(), zIm.data(), gammaRe.data(), gammaIm.data(), COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        QVERIFY2(near(Complex(gammaRe[i], gammaIm[i]), SmithMath::impedanceToGamma(z[i])),
+                 qPrintable(QString("index %1").arg(i)));
+    }
+}
+
+void TestSmithMath::gammaToImpedance()
+{
+    const std::vector<Complex> z = makeImpedances();
+    std::vector<Complex> gamma(COUNT), back(COUNT);
+    SmithMath::impedanceToGamma(z.data(), gamma.data(), COUNT);
+    SmithMath::gammaToImpedance(gamma.data(), back.data(), COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        QVERIFY2(near(back[i], SmithMath::gammaToImpedance(gamma[i])),
+                 qPrintable(QString("index %1").arg(i)));
+        QVERIFY2(std::abs(back[i] - z[i]) <= 1e-9 * std::abs(z[i]),
+                 qPrintable(QString("round trip, index %1").arg(i)));
+    }
+}
+
+void TestSmithMath::gammaMagnitudeAndVswr()
+{
+    const std::vector<Complex> z = makeImpedances();
+    std::vector<Complex> gamma(COUNT);
+    std::vector<double> magnitude(COUNT), vswr(COUNT);
+    SmithMath::impedanceToGamma(z.data(), gamma.data(), COUNT);
+    SmithMath::gammaMagnitude(gamma.data(), magnitude.data(), COUNT);
+    SmithMath::gammaToVSWR(gamma.data(), vswr.data(), COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        QVERIFY2(near(magnitude[i], std::abs(gamma[i])), qPrintable(QString("index %1").arg(i)));
+        QVERIFY2(near(vswr[i], SmithMath::gammaToVSWR(std::abs(gamma[i]))),
+                 qPrintable(QString("index %1").arg(i)));
+    }
+}
+
+void TestSmithMath::multiplyComplex()
+{
+    const std::vector<Complex> a = makeImpedances();
+    std::vector<Complex> b(COUNT), product(COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        b[i] = std::polar(0.9, 0.01 * i);
+    }
+    SmithMath::multiplyComplex(a.data(), b.data(), product.data(), COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        QVERIFY2(near(product[i], a[i] * b[i]), qPrintable(QString("index %1").arg(i)));
+    }
+}
+
+QTEST_APPLESS_MAIN(TestSmithMath)
+#include "test_smithmath.moc"
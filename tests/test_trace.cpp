@@ -0,0 +1,223 @@
+/**
+ * @file test_trace.cpp
+ * @brief Incremental trace edits against a trace built from scratch
+ */
+
+#include "../src/core/trace.h"
+
+#include <QtTest>
+#include <algorithm>
+#include <cmath>
+
+using namespace SmithTool;
+
+namespace {
+
+constexpr double TOLERANCE = 1e-9;
+
+struct Element {
+    ComponentType type;
+    ConnectionType connection;
+    double value;
+};
+
+// Lumped series and shunt elements, a line and a stub, from the load
+std::vector<Element> mixedNetwork()
+{
+    return {
+        {ComponentType::Inductor, ConnectionType::Series, 4.7e-9},
+        {ComponentType::Capacitor, ConnectionType::Shunt, 1.8e-12},
+        {ComponentType::TransmissionLine, ConnectionType::Series, 0.012},
+        {ComponentType::Resistor, ConnectionType::Series, 5.0},
+        {ComponentType::OpenStub, ConnectionType::Shunt, 0.007},
+        {ComponentType::Capacitor, ConnectionType::Series, 3.3e-12},
+        {ComponentType::ShortStub, ConnectionType::Series, 0.004},
+        {ComponentType::Inductor, ConnectionType::Shunt, 12e-9},
+    };
+}
+
+// Every element appended with the full per-element calculation
+void buildFresh(MatchingTrace& trace, const std::vector<Element>& elements,
+                double z0 = 50.0, double frequency = 1e9)
+{
+    trace.clear();
+    trace.setLoadImpedance(Complex(18.0, -25.0));
+    trace.setZ0(z0);
+    trace.setFrequency(frequency);
+    for (const Element& element : elements) {
+        trace.addSegment(element.connection == ConnectionType::Series
+                             ? trace.calculateSeriesElement(element.type, element.value)
+                             : trace.calculateShuntElement(element.type, element.value));
+    }
+}
+
+bool near(const Complex& a, const Complex& b)
+{
+    return std::abs(a - b) <= TOLERANCE * std::max(1.0, std::abs(b));
+}
+
+// Same cached impedances, labels and points, point by point
+QString compareTraces(const MatchingTrace& actual, const MatchingTrace& expected)
+{
+    if (actual.numSegments() != expected.numSegments()) {
+        return QString("%1 segments, expected %2").arg(actual.numSegments()).arg(expected.numSegments());
+    }
+    const std::vector<TraceSegment>& a = actual.segments();
+    const std::vector<TraceSegment>& b = expected.segments();
+    for (int i = 0; i < actual.numSegments(); ++i) {
+        if (a[i].componentType != b[i].componentType || a[i].componentValue != b[i].componentValue) {
+            return QString("segment %1: different element").arg(i);
+        }
+        if (!near(a[i].startImpedance, b[i].startImpedance) ||
+            !near(a[i].endImpedance, b[i].endImpedance)) {
+            return QString("segment %1: cached impedances differ").arg(i);
+        }
+        if (std::abs(a[i].electricalLength - b[i].electricalLength) > TOLERANCE) {
+            return QString("segment %1: electrical length differs").arg(i);
+        }
+        if (a[i].label != b[i].label) {
+            return QString("segment %1: label differs").arg(i);
+        }
+        if (a[i].points.size() != b[i].points.size()) {
+            return QString("segment %1: %2 points, expected %3")
+                .arg(i).arg(a[i].points.size()).arg(b[i].points.size());
+        }
+        for (int k = 0; k < a[i].points.size(); ++k) {
+            if (!near(a[i].points[k].gamma, b[i].points[k].gamma)) {
+                return QString("segment %1, point %2 differs").arg(i).arg(k);
+            }
+        }
+    }
+    if (!near(actual.currentImpedance(), expected.currentImpedance())) {
+        return QString("input impedance differs");
+    }
+    return QString();
+}
+
+} // namespace
+
+class TestTrace : public QObject {
+    Q_OBJECT
+
+private slots:
+    void updateSegmentValue();
+    void insertElement();
+    void removeSegment();
+    void setZ0();
+    void setFrequency();
+    void copy();
+};
+
+void TestTrace::updateSegmentValue()
+{
+    std::vector<Element> elements = mixedNetwork();
+    MatchingTrace trace;
+    buildFresh(trace, elements);
+    
+    // Edit from the load end, the middle and the source end; read in between
+    for (int index : {0, 4, 2, 7}) {
+        trace.segments();
+        elements[index].value *= 1.37;
+        trace.updateSegmentValue(index, elements[index].value);
+        
+        MatchingTrace expected;
+        buildFresh(expected, elements);
+        const QString difference = compareTraces(trace, expected);
+        QVERIFY2(difference.isEmpty(), qPrintable(QString("edit %1: %2").arg(index).arg(difference)));
+    }
+}
+
+void TestTrace::insertElement()
+{
+    const std::vector<Element> elements = mixedNetwork();
+    std::vector<int> placed;    // Indices into elements, in trace order
+    MatchingTrace trace;
+    buildFresh(trace, {});
+    
+    // Insert out of order so most inserts land in front of existing segments
+    for (int source : {3, 0, 7, 5, 1, 6, 2, 4}) {
+        const int index = static_cast<int>(
+            std::lower_bound(placed.begin(), placed.end(), source) - placed.begin());
+        placed.insert(placed.begin() + index, source);
+        trace.segments();
+        trace.insertElement(index, elements[source].type, elements[source].connection,
+                            elements[source].value);
+        
+        std::vector<Element> built;
+        for (int i : placed) {
+            built.push_back(elements[i]);
+        }
+        MatchingTrace expected;
+        buildFresh(expected, built);
+        const QString difference = compareTraces(trace, expected);
+        QVERIFY2(difference.isEmpty(), qPrintable(QString("insert %1: %2").arg(index).arg(difference)));
+    }
+}
+
+void TestTrace::removeSegment()
+{
+    std::vector<Element> elements = mixedNetwork();
+    MatchingTrace trace;
+    buildFresh(trace, elements);
+    
+    for (int index : {2, 0, 5, 4, 1}) {
+        trace.segments();
+        elements.erase(elements.begin() + index);
+        trace.removeSegment(index);
+        
+        MatchingTrace expected;
+        buildFresh(expected, elements);
+        const QString difference = compareTraces(trace, expected);
+        QVERIFY2(difference.isEmpty(), qPrintable(QString("remove %1: %2").arg(index).arg(difference)));
+    }
+}
+
+void TestTrace::setZ0()
+{
+    const std::vector<Element> elements = mixedNetwork();
+    MatchingTrace trace;
+    buildFresh(trace, elements);
+    trace.segments();
+    trace.setZ0(75.0);
+    
+    MatchingTrace expected;
+    buildFresh(expected, elements, 75.0);
+    const QString difference = compareTraces(trace, expected);
+    QVERIFY2(difference.isEmpty(), qPrintable(difference));
+}
+
+void TestTrace::setFrequency()
+{
+    const std::vector<Element> elements = mixedNetwork();
+    MatchingTrace trace;
+    buildFresh(trace, elements);
+    trace.segments();
+    trace.setFrequency(2.45e9);
+    
+    MatchingTrace expected;
+    buildFresh(expected, elements, 50.0, 2.45e9);
+    const QString difference = compareTraces(trace, expected);
+    QVERIFY2(difference.isEmpty(), qPrintable(difference));
+}
+
+void TestTrace::copy()
+{
+    // A copy owns its own points: editing the original leaves it alone
+    const std::vector<Element> elements = mixedNetwork();
+    MatchingTrace trace;
+    buildFresh(trace, elements);
+    MatchingTrace copied(trace);
+    trace.updateSegmentValue(1, 2.2e-12);
+    MatchingTrace assigned;
+    assigned = copied;
+    
+    MatchingTrace expected;
+    buildFresh(expected, elements);
+    QString difference = compareTraces(copied, expected);
+    QVERIFY2(difference.isEmpty(), qPrintable(difference));
+    difference = compareTraces(assigned, expected);
+    QVERIFY2(difference.isEmpty(), qPrintable(difference));
+}
+
+QTEST_APPLESS_MAIN(TestTrace)
+#include "test_trace.moc"